@@ -14,27 +14,27 @@ struct VS_Input
     float4 pos : POSITION;
     float2 uv : TEXCOORD;
     float4 color : COLOR;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
+    float2 normal : NORMAL; // 八面体に展開した法線
     uint4 skinIndex : SKININDEX;
     float4 skinWeight : SKINWEIGHT;
     row_major float4x4 mInstanceWorld : INSTANCE_WORLD;
     float4 tillingOffset : INSTANCE_TILING_OFFSET;
     float4 iColor : INSTANCE_COLOR;
+    uint boneOffset : INSTANCE_BONE_OFFSET;
 };
 
-VS_Output main(VS_Input input, uint instanceID : SV_InstanceID)
+VS_Output main(VS_Input input)
 {
     VS_Output o;
 
     // スキンメッシュの計算
     float4 pos = input.pos;
-    float3 normal = input.normal;
+    float3 normal = OctDecode(input.normal);
 
     if (g_IsSkin)
     {
-        uint bonesPerInstance = g_BonePerInstance; // 1インスタンスあたりのボーン数
-        uint boneStartIndex = instanceID * bonesPerInstance;
+        // パレット内のこのインスタンスのボーン行列の先頭
+        uint boneStartIndex = input.boneOffset;
 
         row_major float4x4 skinMatrix =
         {
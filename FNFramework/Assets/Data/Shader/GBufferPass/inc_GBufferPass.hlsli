@@ -12,7 +12,5 @@ struct VS_Output
 //------------------------------
 cbuffer cbObject : register(b1)
 {
-    float g_BonePerInstance;
-    
     bool g_IsSkin;
 }
@@ -15,6 +15,18 @@ cbuffer CousticsData : register(b4)
     float Intencity;
 };
 
+//------------------------------
+// ライトのクラスター : LightCluster と合わせる
+//------------------------------
+cbuffer cbLightCluster : register(b5)
+{
+    row_major matrix g_mClusterView; // クラスターを分けたカメラのビュー行列
+
+    uint3 g_ClusterTileNum; // .xy = 画面のタイルの数 / .z = 奥行きの数
+    float g_ClusterSliceScale; // 奥行きの番号 = log(z) * Scale + Bias
+    float g_ClusterSliceBias;
+};
+
 Texture2D g_albedMap : register(t0);
 Texture2D<float3> g_normalMap : register(t1);
 Texture2D<float> g_depthMap : register(t2);
@@ -22,33 +34,54 @@ Texture2D g_shadowMap : register(t3);
 
 Texture2D<float> g_cousticsTex : register(t4);
 
+struct ClusterPointLight
+{
+    float3 Position; // 座標
+    float Range; // 影響範囲
+    float3 Color; // カラー
+    float Intensity; // 強度
+};
+StructuredBuffer<ClusterPointLight> g_ClusterPointLights : register(t5);
+StructuredBuffer<uint2> g_ClusterRanges : register(t6); // .x = 先頭 / .y = 数
+StructuredBuffer<uint> g_ClusterLightIndices : register(t7);
+
 SamplerState g_ss : register(s0);
 SamplerComparisonState g_ssCmp : register(s10); // 比較機能付き
 
+// カスケードの数とシャドウマップの1辺に並べる数 : ShadowCascade と合わせる
+#define SHADOW_CASCADE_NUM 4
+#define SHADOW_ATLAS_TILE_NUM 2
+
 // シャドウの計算
 float CalculateShadow(float3 worldPos)
 {    
-    float shadow = 1.0f;
+    // シャドウマップのテクセルサイズ
+    float w, h;
+    g_shadowMap.GetDimensions(w, h);
+    float tw = 1.0 / w;
+    float th = 1.0 / h;
+
+    // PCF で隣のカスケードを読まないように、カスケードの端から2テクセル内側だけを使う
+    float2 border = float2(tw, th) * SHADOW_ATLAS_TILE_NUM * 4.0;
+
+    // 近いカスケードから順に、範囲内に入る最初のカスケードを使う
+    [loop]
+    for (int cascadeIdx = 0; cascadeIdx < SHADOW_CASCADE_NUM; cascadeIdx++)
+    {
+        // ワールド空間座標をライト空間座標に変換
+        float4 posInLightSpace = mul(float4(worldPos, 1), g_mCascadeViewProj[cascadeIdx]);
+        float3 liPos = posInLightSpace.xyz / posInLightSpace.w;
 
-    // ワールド空間座標をライト空間座標に変換
-    float4 posInLightSpace = mul(float4(worldPos, 1), g_mLigViewProj);
-    float3 liPos = posInLightSpace.xyz / posInLightSpace.w;
+        // 深度マップの範囲内か確認
+        if (any(abs(liPos.xy) > 1.0 - border) || liPos.z > 1) { continue; }
 
-    // 深度マップの範囲内か確認
-    if (abs(liPos.x) <= 1 && abs(liPos.y) <= 1 && liPos.z <= 1)
-    {
-		// 射影座標 -> UV座標へ変換
-        float2 uv = liPos.xy * float2(1, -1) * 0.5 + 0.5;
+        // 射影座標 -> UV座標へ変換 : シャドウマップ内のカスケードの位置に移す
+        float2 tile = float2(cascadeIdx % SHADOW_ATLAS_TILE_NUM, cascadeIdx / SHADOW_ATLAS_TILE_NUM);
+        float2 uv = (liPos.xy * float2(1, -1) * 0.5 + 0.5 + tile) / SHADOW_ATLAS_TILE_NUM;
         float z = liPos.z - 0.0005; // シャドウアクネ対策
 
-        // シャドウマップのテクセルサイズ
-        float w, h;
-        g_shadowMap.GetDimensions(w, h);
-        float tw = 1.0 / w;
-        float th = 1.0 / h;
-
         // PCF (3x3サンプリングでソフトシャドウを計算)
-        shadow = 0.0f;
+        float shadow = 0.0f;
         for (int y = -1; y <= 1; y++)
         {
             for (int x = -1; x <= 1; x++)
@@ -59,10 +92,10 @@ float CalculateShadow(float3 worldPos)
         }
 
         // 平均化
-        shadow /= 9.0f;
+        return shadow / 9.0f;
     }
 
-    return shadow;
+    return 1.0f;
 }
 
 //====================//
@@ -140,6 +173,18 @@ float3 CalculateCaustics(float3 normal, float3 worldPos)
     return color * d;
 }
 
+// ピクセルが入るクラスターの番号
+uint CalculateClusterIndex(float2 uv, float3 worldPos)
+{
+    float viewZ = mul(float4(worldPos, 1.0f), g_mClusterView).z;
+
+    uint2 tile = min(uint2(uv * g_ClusterTileNum.xy), g_ClusterTileNum.xy - 1);
+    float slice = floor(log(max(viewZ, 1e-4)) * g_ClusterSliceScale + g_ClusterSliceBias);
+    uint sliceIdx = (uint) clamp(slice, 0.0f, (float) (g_ClusterTileNum.z - 1));
+
+    return (sliceIdx * g_ClusterTileNum.y + tile.y) * g_ClusterTileNum.x + tile.x;
+}
+
 float4 main(VSOutput input) : SV_TARGET
 {
     // アルベドと法線マップのサンプリング
@@ -159,18 +204,20 @@ float4 main(VSOutput input) : SV_TARGET
     worldPos = mul(float4(screenPos, 1.0f), g_mViewProjInv);
     worldPos.xyz /= worldPos.w;
 
-    // ポイントライトの計算
+    // ポイントライトの計算 : ピクセルが入るクラスターに振り分けたライトだけを見る
     float3 lambertDiffuse = float3(0.0f, 0.0f, 0.0f);
-    for (int i = 0; i < g_FramePointLightNum.x; i++)
+    uint2 clusterRange = g_ClusterRanges[CalculateClusterIndex(input.uv, worldPos.xyz)];
+    for (uint i = 0; i < clusterRange.y; i++)
     {
-        float dist = length(worldPos.xyz - g_PointLights[i].PLPosition);
+        ClusterPointLight light = g_ClusterPointLights[g_ClusterLightIndices[clusterRange.x + i]];
+        float dist = length(worldPos.xyz - light.Position);
 
-        if (dist < g_PointLights[i].PLRange)
+        if (dist < light.Range)
         {
-            float3 ligPointDir = normalize(g_PointLights[i].PLPosition - worldPos.xyz);
+            float3 ligPointDir = normalize(light.Position - worldPos.xyz);
             float NdotL = saturate(dot(normal, ligPointDir));
-            float affect = pow(saturate(1.0f - (dist / g_PointLights[i].PLRange)), 5.0f);
-            lambertDiffuse += g_PointLights[i].PLColor * g_PointLights[i].PLIntensity * NdotL * affect;
+            float affect = pow(saturate(1.0f - (dist / light.Range)), 5.0f);
+            lambertDiffuse += light.Color * light.Intensity * NdotL * affect;
         }
     }
 
@@ -33,6 +33,7 @@ cbuffer cbDirectionLight : register(b2)
     float3 g_ligDirection; // ライトの方向
     float3 g_ligColor; // ライトの色
     row_major matrix g_mLigViewProj; // ライトのビュー行列とプロジェクション行列
+    row_major matrix g_mCascadeViewProj[4]; // カスケードごとのライトのビュー行列とプロジェクション行列
     //--------------------------------//
 
     //-----------ポイントライト---------------//
@@ -5,10 +5,13 @@ VSOutput main(
     float4 pos : POSITION, // 座標
     float2 uv : TEXCOORD, // テクスチャ座標
     float4 color : COLOR, // 色
-    float3 normal : NORMAL, // 法線
-    float3 tangent : TANGENT // 接ベクトル
+    float2 octNormal : NORMAL, // 法線 : 八面体に展開したもの
+    float2 octTangent : TANGENT // 接ベクトル : 八面体に展開したもの
 )
 {
+    float3 normal = OctDecode(octNormal);
+    float3 tangent = OctDecode(octTangent);
+
     VSOutput Out;
 
     // モデル
@@ -16,8 +16,6 @@ cbuffer cbCamera : register(b0)
 //------------------------------
 cbuffer cbObject : register(b1)
 {
-    float g_BonePerInstance;
-    
     bool g_IsSkin;
 }
 
@@ -32,17 +30,14 @@ StructuredBuffer<BoneBuffer> g_BoneBuffer : register(t1);
 struct VS_Input
 {
     float4 pos : POSITION;
-    float2 uv : TEXCOORD;
-    float4 color : COLOR;
-    float3 normal : NORMAL;
-    float3 tangent : TANGENT;
     uint4 skinIndex : SKININDEX;
     float4 skinWeight : SKINWEIGHT;
     row_major float4x4 mInstanceWorld : INSTANCE_WORLD;
     float4 tillingOffset : INSTANCE_TILING_OFFSET;
+    uint boneOffset : INSTANCE_BONE_OFFSET;
 };
 
-VS_Output main(VS_Input input, uint instanceID : SV_InstanceID)
+VS_Output main(VS_Input input)
 {
     VS_Output o;
 
@@ -51,8 +46,8 @@ VS_Output main(VS_Input input, uint instanceID : SV_InstanceID)
 
     if (g_IsSkin)
     {
-        uint bonesPerInstance = g_BonePerInstance; // 1インスタンスあたりのボーン数
-        uint boneStartIndex = instanceID * bonesPerInstance;
+        // パレット内のこのインスタンスのボーン行列の先頭
+        uint boneStartIndex = input.boneOffset;
 
         row_major float4x4 skinMatrix =
         {
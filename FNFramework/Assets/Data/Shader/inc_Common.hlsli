@@ -6,6 +6,18 @@
 
 #define PI 3.14159265359
 
+// 八面体に展開して snorm16 x 2 で送った単位ベクトルを戻す : MeshOptimizer::EncodeOctahedral の逆
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+
+    // 下半分は対角線で折り返してある
+    float t = saturate(-n.z);
+    n.xy += n.xy >= 0.0 ? -t : t;
+
+    return normalize(n);
+}
+
 //---------------------------------
 // カメラ定数バッファ
 //---------------------------------
@@ -30,6 +42,7 @@ cbuffer cbDirectionLight : register(b3)
     float3 g_ligDirection; // ライトの方向
     float3 g_ligColor; // ライトの色
     row_major matrix g_mLigViewProj; // ライトのビュー行列とプロジェクション行列
+    row_major matrix g_mCascadeViewProj[4]; // カスケードごとのライトのビュー行列とプロジェクション行列
     //--------------------------------//
 
     //-----------ポイントライト---------------//
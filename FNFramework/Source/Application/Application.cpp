@@ -53,6 +53,17 @@ bool Application::Initialize()
         return false;
     }
 
+    //------------------
+    // JobSystem
+    //------------------
+    JobSystem::Instance().Init();
+
+    //------------------
+    // FrameAllocator
+    //------------------
+    // スレッドごとの領域を作るため、JobSystem の後に初期化する
+    FrameAllocator::Instance().Init();
+
     //======================================
     // Applicationで利用するデータの初期化
     //======================================
@@ -84,9 +95,17 @@ bool Application::Initialize()
 
 void Application::Release()
 {
+    // 送ったフレームが GPU で終わるまで待つ : 描画中のリソースを解放しないようにする
+    GraphicsDevice::Instance().WaitForCommandQueue();
+
     // ImGui解放
     ImGuiDevice::Instance().Release();
-    
+
+    // ワーカースレッドの終了
+    JobSystem::Instance().Release();
+
+    // 1フレーム用のメモリの解放
+    FrameAllocator::Instance().Release();
 }
 
 void Application::Execute()
@@ -163,6 +182,9 @@ void Application::SetDirectoryAndLoadDll()
 /*================================*/
 void Application::PreUpdate()
 {
+    // 前のフレームで確保した一時メモリをまとめて巻き戻す
+    FrameAllocator::Instance().Reset();
+
     // ImGui
     ImGuiDevice::Instance().NewFrame();
 
@@ -215,4 +237,7 @@ void Application::PostDraw()
     ImGuiDevice::Instance().SetHeap();
 
     GraphicsDevice::Instance().ScreenFlip();
+
+    // Scene : フレームの終わりに、取り除いたオブジェクトをまとめて破棄する
+    SceneManager::Instance().PostDraw();
 }
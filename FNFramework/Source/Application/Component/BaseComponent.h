@@ -2,6 +2,11 @@
 
 class GameObject;
 
+#include "ComponentTypeID.h"
+#include "ComponentAccess.h"
+#include "ComponentTick.h"
+#include "Application/Object/GameObjectHandle.h"
+
 /**
 * @class BaseComponent
 * @brief コンポーネントの基底クラス
@@ -9,6 +14,9 @@ class GameObject;
 class BaseComponent
     : public std::enable_shared_from_this<BaseComponent>
 {
+    // 型IDとアクセス宣言、更新のフェーズの設定は AddComponent でのみ行う
+    friend class GameObject;
+
 public:
     // コンポーネントの更新順設定用 : 定義されていないコンポーネントは、eDefaultになる
     enum class ComponentType
@@ -33,6 +41,7 @@ public:
         bool _enableSerialize = false,
         ComponentType order = ComponentType::eDefault)
         : m_wpOwnerObj(owner)
+        , m_pOwnerObj(owner.get())
         , m_compName(name)
         , m_enableSerialize(_enableSerialize)
         , m_updateOrder(order)
@@ -52,12 +61,43 @@ public:
     */
     const std::string& GetComponentName() const { return m_compName; }
 
+    /**
+    * @brief コンポーネントの型IDの取得
+    * @return コンポーネントの型ID : AddComponent 前は InvalidID
+    */
+    ComponentTypeID::IDType GetComponentTypeID() const { return m_typeID; }
+
+    /**
+    * @brief Update で読み書きするコンポーネントの型の取得
+    * @return AddComponent 時に DeclareUpdateAccess から取得した宣言
+    */
+    const ComponentAccess& GetUpdateAccess() const { return m_updateAccess; }
+
+    /**
+    * @brief 更新を行うフェーズの取得
+    * @return AddComponent 時に型から判定した、オーバーライドしているフェーズ
+    */
+    const ComponentTick::Mask& GetTickMask() const { return m_tickMask; }
+
+    /**
+    * @brief RemoveComponent で外されたか
+    * @details 外されたコンポーネントはフレームの終わりまで破棄されずに残るので、それまでの更新ではこれを見て飛ばす
+    */
+    bool IsRemoved() const { return m_isRemoved; }
+
     /*
     * @brief オーナーオブジェクトのポインタ取得
     * @return オーナーオブジェクトのポインタ
     */
     const std::shared_ptr<GameObject> GetOwner() const { return m_wpOwnerObj.lock(); }
 
+    /*
+    * @brief オーナーオブジェクトの生ポインタ取得 : 参照カウントを操作しないので毎フレームの処理ではこちらを使う
+    * @details コンポーネントはオーナーが所有しているため、オーナーの更新中は常に有効
+    * @return オーナーオブジェクトのポインタ
+    */
+    GameObject* GetOwnerPtr() const { return m_pOwnerObj; }
+
     /**
     * @brief コンポーネントの更新順取得
     * @return コンポーネントの更新順
@@ -114,6 +154,16 @@ public:
 
     /* @brief 更新 */
     virtual void Update() {}
+
+    /**
+    * @brief Update で読み書きするコンポーネントの型の宣言
+    * @details
+    *   並列に更新しても良いコンポーネントは、オーバーライドして IsParallel を立てる
+    *   並列更新フェーズはシーン内の TransformComponent の行列が確定した後に行われるため、
+    *   TransformComponent へ書き込むコンポーネントは並列にできない
+    * @return 宣言 : 既定値は並列にしない
+    */
+    virtual ComponentAccess DeclareUpdateAccess() const { return {}; }
     virtual void UpdateWorldTransform() {}
 
     virtual void PreUpdate() {}
@@ -190,6 +240,8 @@ protected:
 
     // オーナーオブジェクトの弱参照用
     std::weak_ptr<GameObject> m_wpOwnerObj;
+    // オーナーオブジェクトの生ポインタ : ハンドルの解決など、参照カウントが不要な場面で使う
+    GameObject* m_pOwnerObj = nullptr;
 
 private:
 
@@ -197,12 +249,20 @@ private:
     bool m_isEnable = true;
     // Start()が呼ばれたかどうか
     bool m_isStart = false;
+    // RemoveComponent で外されたかどうか : GameObject::RemoveComponent で設定される
+    bool m_isRemoved = false;
     // シリアライズ / デシリアライズを行うかどうか
     // - コンポーネント内で行われる AddComponent される場合は false にしてシリアライズを行わない
     bool m_enableSerialize = false;
 
     // コンポーネントの名前
     std::string m_compName = "";
+    // コンポーネントの型ID : GameObject::AddComponent で設定される
+    ComponentTypeID::IDType m_typeID = ComponentTypeID::InvalidID;
+    // Update で読み書きするコンポーネントの型 : GameObject::AddComponent で設定される
+    ComponentAccess m_updateAccess;
+    // 更新を行うフェーズ : GameObject::AddComponent で設定される
+    ComponentTick::Mask m_tickMask;
     // コンポーネントの更新順
     ComponentType m_updateOrder = ComponentType::eDefault;
 };
@@ -38,14 +38,6 @@ void CollisionComponent::PreUpdate()
     m_upCollisionHelper->Update();
 }
 
-void CollisionComponent::Update()
-{
-}
-
-void CollisionComponent::PostUpdate()
-{
-}
-
 void CollisionComponent::Release()
 {
 }
@@ -73,10 +73,8 @@ public:
     */
     void Start() override;
 
-    /* @fn void Update() @brief 更新 */
+    /* @fn void PreUpdate() @brief 更新 : 当たり判定は更新の前に行うので、Update / PostUpdate は持たない */
     void PreUpdate() override;
-    void Update() override;
-    void PostUpdate() override;
 
     /* @fn Release() @brief 終了 */
     void Release() override;
@@ -0,0 +1,74 @@
+﻿#pragma once
+
+#include "ComponentTypeID.h"
+
+/**
+* @struct ComponentAccess
+* @brief コンポーネントの Update が読み書きするコンポーネントの型の宣言
+* @details
+*   - BaseComponent::DeclareUpdateAccess でコンポーネントごとに宣言する
+*   - IsParallel が立っているコンポーネントは、Scene の並列更新フェーズで型ごとにまとめて並列に更新される
+*   - 同じ型のコンポーネントは自分自身にのみ書き込む前提で、同時に更新される
+*   - 書き込む型が重なる型同士は、同時には更新されない
+*
+*   例 : ComponentAccess{}.Parallel().Reads<TransformComponent>().Writes<ModelComponent>()
+*/
+struct ComponentAccess
+{
+    using Mask = std::bitset<ComponentTypeID::MaxTypeNum>;
+
+    // Update で読み込むコンポーネントの型
+    Mask ReadMask;
+    // Update で書き込むコンポーネントの型
+    Mask WriteMask;
+
+    // 並列更新フェーズで更新するかどうか
+    bool IsParallel = false;
+
+    // MaxTypeNum 以上の型IDを読み書きするか : ビットで表せないので、どの型とも衝突する扱いにする
+    bool HasUnindexedType = false;
+
+    /* @brief 並列更新フェーズで更新する */
+    ComponentAccess& Parallel()
+    {
+        IsParallel = true;
+        return *this;
+    }
+
+    /* @brief 読み込む型を追加する */
+    template <typename... CompTypes>
+    ComponentAccess& Reads()
+    {
+        (AddType(ReadMask, ComponentTypeID::Get<CompTypes>()), ...);
+        return *this;
+    }
+
+    /* @brief 書き込む型を追加する */
+    template <typename... CompTypes>
+    ComponentAccess& Writes()
+    {
+        (AddType(WriteMask, ComponentTypeID::Get<CompTypes>()), ...);
+        return *this;
+    }
+
+    /* @brief 同時に更新できない組み合わせか : どちらかが書き込む型を、もう片方が読み書きしている */
+    bool IsConflict(const ComponentAccess& other) const
+    {
+        if (HasUnindexedType || other.HasUnindexedType) { return true; }
+
+        return (WriteMask & (other.ReadMask | other.WriteMask)).any() ||
+            (other.WriteMask & ReadMask).any();
+    }
+
+private:
+    void AddType(Mask& mask, ComponentTypeID::IDType typeID)
+    {
+        if (typeID < ComponentTypeID::MaxTypeNum)
+        {
+            mask.set(typeID);
+            return;
+        }
+
+        HasUnindexedType = true;
+    }
+};
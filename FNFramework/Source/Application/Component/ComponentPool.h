@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "ComponentTypeID.h"
+
+/**
+* @brief シーンごとのプールから確保するコンポーネントの型の登録
+* @details
+*   - SceneManager::RegisterComponent で登録された型は、GameObject::AddComponent でシーンの PoolArena から確保される
+*   - PoolArena のプールの番号には型IDをそのまま使うため、同じ型のコンポーネントは同じチャンクに並ぶ
+*   - 登録されていない型は、これまで通り make_shared で確保する
+*/
+namespace ComponentPool
+{
+    // GameObject 用のプールの番号 : コンポーネントの型IDと被らないようにする
+    constexpr UINT32 GameObjectPoolIndex = ComponentTypeID::MaxTypeNum;
+
+    namespace detail
+    {
+        /* @brief 登録された型IDのマスク */
+        inline std::bitset<ComponentTypeID::MaxTypeNum>& WorkRegisteredMask()
+        {
+            static std::bitset<ComponentTypeID::MaxTypeNum> s_registeredMask;
+            return s_registeredMask;
+        }
+    }
+
+    /* @brief プールから確保する型として登録する */
+    template <typename CompType>
+    void Register()
+    {
+        const ComponentTypeID::IDType typeID = ComponentTypeID::Get<CompType>();
+
+        if (typeID >= ComponentTypeID::MaxTypeNum) { return; }
+
+        detail::WorkRegisteredMask().set(typeID);
+    }
+
+    /* @brief プールから確保する型か */
+    inline bool IsRegistered(ComponentTypeID::IDType typeID)
+    {
+        return typeID < ComponentTypeID::MaxTypeNum && detail::WorkRegisteredMask().test(typeID);
+    }
+}
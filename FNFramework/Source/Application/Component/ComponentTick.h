@@ -0,0 +1,45 @@
+﻿#pragma once
+
+class BaseComponent;
+
+/**
+* @brief コンポーネントが更新を行うフェーズの判定
+* @details
+*   - GameObject::AddComponent で、型が PreUpdate / Update / UpdateWorldTransform / PostUpdate を
+*     オーバーライドしているかをコンパイル時に調べ、オーバーライドしているフェーズだけを登録する
+*   - Scene はフェーズごとに、登録されたコンポーネントだけを並べた配列を持つ
+*     オーバーライドしていないフェーズでは、空の仮想関数の呼び出しもコンポーネントへのアクセスも起こらない
+*   ※ 何もしないオーバーライドを残すと毎フレーム呼ばれるので、不要なオーバーライドは消しておく
+*   ※ 判定で型のメンバ関数を参照するため、これらのオーバーライドは public にする
+*/
+namespace ComponentTick
+{
+    // 更新のフェーズ : Scene はこの順に、フェーズごとにまとめて更新する
+    enum Phase : UINT8
+    {
+        ePreUpdate,
+        eUpdate,
+        eUpdateWorldTransform,
+        ePostUpdate,
+
+        ePhaseNum
+    };
+
+    using Mask = std::bitset<ePhaseNum>;
+
+    /* @brief 型がオーバーライドしているフェーズの取得 */
+    template <typename CompType>
+    Mask Detect()
+    {
+        // オーバーライドしていなければ、メンバ関数ポインタの型は BaseComponent のものになる
+        using BaseFunc = void (BaseComponent::*)();
+
+        Mask mask;
+        mask.set(ePreUpdate, !std::is_same_v<decltype(&CompType::PreUpdate), BaseFunc>);
+        mask.set(eUpdate, !std::is_same_v<decltype(&CompType::Update), BaseFunc>);
+        mask.set(eUpdateWorldTransform, !std::is_same_v<decltype(&CompType::UpdateWorldTransform), BaseFunc>);
+        mask.set(ePostUpdate, !std::is_same_v<decltype(&CompType::PostUpdate), BaseFunc>);
+
+        return mask;
+    }
+}
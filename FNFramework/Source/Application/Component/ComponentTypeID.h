@@ -0,0 +1,42 @@
+﻿#pragma once
+
+/**
+* @brief コンポーネントの型ごとに割り振られる整数ID
+* @details
+*   - 型ごとに 0 から連番で割り振られるため、bitset や配列の添え字としてそのまま利用できる
+*   - IDは型ごとに1度だけ発行され、以降は文字列比較を行わずに取得できる
+*   - GameObject::GetComponent / HasComponent の検索キーとして利用する
+*/
+namespace ComponentTypeID
+{
+    using IDType = UINT;
+
+    // bitset / 配列の索引で扱う型の数 : 超えた型は GameObject が m_spComponents を走査して探す
+    constexpr IDType MaxTypeNum = 64;
+
+    // 無効なID
+    constexpr IDType InvalidID = static_cast<IDType>(-1);
+
+    namespace detail
+    {
+        /* @brief 新しいIDを発行する @return 発行したID */
+        inline IDType IssueID()
+        {
+            static std::atomic<IDType> s_nextID = 0;
+            return s_nextID.fetch_add(1);
+        }
+    }
+
+    /**
+    * @brief 型に対応するIDの取得
+    * @tparam CompType - IDを取得したいコンポーネントの型
+    * @return 型に対応するID
+    */
+    template <typename CompType>
+    IDType Get()
+    {
+        // 関数内の static 変数なので、型ごとに1度だけ発行される
+        static const IDType s_id = detail::IssueID();
+        return s_id;
+    }
+}
@@ -45,14 +45,15 @@ public:
     void Serialize(Json& _json) const override;
     void Deserialize(const Json& _json) override;
 
+    /* @brief 更新 : 更新のフェーズの判定で型から参照するので public にしておく */
+    void Update() override;
+
 private:
     //--------------------------------
     // その他関数
     //--------------------------------
     /* @brief ImGui更新 */
     void ImGuiUpdate() override;
-    /* @brief 更新 */
-    void Update() override;
 
     //--------------------------------
     // 変数
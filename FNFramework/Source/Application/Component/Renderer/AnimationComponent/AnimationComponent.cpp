@@ -71,6 +71,11 @@ void AnimationComponent::Update()
     ModelComponent::Update();
 }
 
+ComponentAccess AnimationComponent::DeclareUpdateAccess() const
+{
+    return ComponentAccess{}.Parallel().Reads<TransformComponent>().Writes<AnimationComponent>();
+}
+
 void AnimationComponent::Serialize(Json& _json) const
 {
     ModelComponent::Serialize(_json);
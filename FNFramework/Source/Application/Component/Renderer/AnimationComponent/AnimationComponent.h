@@ -122,6 +122,9 @@ public:
     /* @fn void Update() @brief 更新 */
     void Update() override;
 
+    /* @brief アニメーションは自分のノードにのみ書き込むので、並列に更新する */
+    ComponentAccess DeclareUpdateAccess() const override;
+
     // シリアライズ / デシリアライズ
     void Serialize(Json& _json) const override;
     void Deserialize(const Json& _json) override;
@@ -22,17 +22,41 @@ void ModelComponent::Update()
     if (!OwnerValid() || !m_spModelData) { return; }
 
     UINT renderType;
+    UINT shadowCascadeMask = ShadowCascade::AllCascadeMask;
+    UINT staticShadowCascadeMask = 0;
 
     // 陰影計算なしのモデルの場合はカリングを行わない
-    renderType = CullingCheck();
+    renderType = CullingCheck(shadowCascadeMask, staticShadowCascadeMask);
 
-    // 試錐台カリングで描画対象外の場合は描画しない
-    if (!m_insideFrustum && m_cullingType == CullingType::eFrustum) { return; }
+    // 試錐台カリングで描画対象外の場合は描画しない : 影のキャッシュを描き直す場合と、遮蔽物に隠れているだけの場合は送る
+    if (!m_insideFrustum && !m_isOccluded && m_cullingType == CullingType::eFrustum && staticShadowCascadeMask == 0) { return; }
 
-    const Math::Matrix& mWorld = m_wpOwnerObj.lock()->GetTransformComponent()->GetWorldMatrix();
+    const Math::Matrix& mWorld = GetOwnerPtr()->GetTransformComponent()->GetWorldMatrix();
 
-    // モデルデータの更新
-    Renderer::Instance().AddRenderingModelData(m_spModelData, mWorld, renderType, m_color, m_tilling, m_offset);
+    const UINT lod = UpdateLOD();
+
+    // モデルデータの更新 : ワーカースレッドから呼ばれた場合はスレッドごとのリストに追加される
+    Renderer::Instance().AddRenderingModelData(m_spModelData, mWorld, renderType, m_color, m_tilling, m_offset,
+        shadowCascadeMask, staticShadowCascadeMask, lod);
+}
+
+UINT ModelComponent::UpdateLOD()
+{
+    // 誤差はモデル空間の距離なので、一番大きい軸の拡大率を掛ける
+    const Math::Vector3& scale = GetOwnerPtr()->GetTransformComponent()->GetScale();
+    const float worldScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+
+    // ワールド空間の描画ボックスを包む球で距離を測る
+    const AABB<Math::Vector3>& drawAABB = m_drawMeshBox.AABB;
+    const float pixelPerError = ModelLOD::CalcPixelPerError(CullingSystem::Instance().GetLODView(),
+        drawAABB.GetCenter(), drawAABB.GetSize().Length() * 0.5f, worldScale);
+
+    return m_spModelData->UpdateLOD(pixelPerError);
+}
+
+ComponentAccess ModelComponent::DeclareUpdateAccess() const
+{
+    return ComponentAccess{}.Parallel().Reads<TransformComponent>().Writes<ModelComponent>();
 }
 
 void ModelComponent::UpdateWorldTransform()
@@ -43,7 +67,23 @@ void ModelComponent::UpdateWorldTransform()
     TransformAABB(m_colMeshBox.SrcAABB, m_colMeshBox.AABB);
 
     // m_drawAABBのワールド変換
+    const AABB<Math::Vector3> prevDrawAABB = m_drawMeshBox.AABB;
     TransformAABB(m_drawMeshBox.SrcAABB, m_drawMeshBox.AABB);
+
+    // カリング用のボックスは動いた時だけ更新する
+    if (!m_isCullingBoundsSet ||
+        prevDrawAABB.GetMin() != m_drawMeshBox.AABB.GetMin() ||
+        prevDrawAABB.GetMax() != m_drawMeshBox.AABB.GetMax())
+    {
+        CullingSystem::Instance().SetBounds(m_cullingHandle, m_drawMeshBox.AABB);
+        m_isCullingBoundsSet = m_cullingHandle != CullingSystem::InvalidHandle;
+    }
+
+    // 回転だけではボックスが変わらないことがあるので、遮蔽物の行列は毎回書き込む
+    if (CullingSystem::Instance().IsOccluder(m_cullingHandle))
+    {
+        CullingSystem::Instance().SetOccluderMatrix(m_cullingHandle, GetOwnerPtr()->GetTransformComponent()->GetWorldMatrix());
+    }
 }
 
 void ModelComponent::LoadModelData()
@@ -61,6 +101,27 @@ void ModelComponent::LoadModelData()
 
     m_spModelData->SetModelData(m_modelName);
 
+    // 視錐台カリングの登録 : 判定は CullingSystem がまとめて行う
+    // モデルを差し替えた場合は影の形も変わるので登録し直す
+    if (m_cullingHandle != CullingSystem::InvalidHandle)
+    {
+        CullingSystem::Instance().Unregister(m_cullingHandle);
+    }
+
+    // アニメーションするモデルはボックスが動かなくても形が変わるので、影をキャッシュに描かない
+    const std::shared_ptr<ModelData> spOriginalData = m_spModelData->GetModelData();
+    const bool canBeStaticCaster = spOriginalData && !spOriginalData->IsSkinMesh() && !spOriginalData->IsAnimation();
+
+    m_cullingHandle = CullingSystem::Instance().Register(m_wpOwnerObj, canBeStaticCaster);
+    m_isCullingBoundsSet = false;
+
+    // "Col" ノードを持つ動かないモデルは、コリジョンメッシュで後ろのモデルを隠す
+    // "Col" ノードがなく描画ノードで代用しているモデルは、面が多いので遮蔽物にしない
+    if (canBeStaticCaster && spOriginalData->GetCollisionMeshNodeIdxLists() != spOriginalData->GetDrawMeshNodeIdxList())
+    {
+        CullingSystem::Instance().SetOccluder(m_cullingHandle, spOriginalData);
+    }
+
     UpdateModelAABB();
 
     // 初期段階のボックスを作成
@@ -142,6 +203,13 @@ void ModelComponent::Deserialize(const Json& _json)
 
 void ModelComponent::Release()
 {
+    if (m_cullingHandle != CullingSystem::InvalidHandle)
+    {
+        CullingSystem::Instance().Unregister(m_cullingHandle);
+        m_cullingHandle = CullingSystem::InvalidHandle;
+        m_isCullingBoundsSet = false;
+    }
+
     if(m_spModelData)
     {
         m_spModelData.reset();
@@ -191,6 +259,8 @@ void ModelComponent::ImGuiUpdate()
     // カリング関係
     //--------------------------------
     ImGui::Text(U8_TEXT("カリングされているかどうか: %s"), m_insideFrustum ? "true" : "false");
+    ImGui::Text(U8_TEXT("遮蔽物に隠れているか: %s / 遮蔽物か: %s"), m_isOccluded ? "true" : "false",
+        CullingSystem::Instance().IsOccluder(m_cullingHandle) ? "true" : "false");
     utl::ImGuiHelper::RadioButtonWithLabel(U8_TEXT("カリングしない"), m_cullingType, CullingType::eNotCulling);
     utl::ImGuiHelper::RadioButtonWithLabel(U8_TEXT("試錐代カリング"), m_cullingType, CullingType::eFrustum);
     utl::ImGuiHelper::RadioButtonWithLabel(U8_TEXT("影だけ除外する"), m_cullingType, CullingType::eIgnoreShadowCulling);
@@ -305,6 +375,9 @@ void ModelComponent::ChangeRenderType()
             m_renderType = 1 << currentItem;
         }
         m_guiAddRenderType = eNone;
+
+        // 影を描くかが変わるので、キャッシュに描いた影を描き直す
+        CullingSystem::Instance().ResetStaticCaster(m_cullingHandle);
     }
 }
 
@@ -393,12 +466,21 @@ void ModelComponent::UpdateModelAABB()
     m_drawMeshBox.SrcAABB = m_drawMeshBox.AABB;
 }
 
-UINT ModelComponent::CullingCheck()
+UINT ModelComponent::CullingCheck(UINT& shadowCascadeMask, UINT& staticShadowCascadeMask)
 {
     // デフォルトの場合は普通に返す
     UINT renderType = m_renderType;
 
     m_insideFrustum = CheckFrustumCulling();
+    m_isOccluded = !m_insideFrustum && CullingSystem::Instance().IsOccluded(m_cullingHandle);
+
+    const UINT shadowType = static_cast<UINT>(RenderingData::Model::RenderType::eShadow);
+
+    // 遮蔽物に隠れているだけなら、視界の中に影を落とすことがあるので影のみの描画にする
+    if (m_isOccluded && m_cullingType == CullingType::eFrustum)
+    {
+        renderType &= shadowType;
+    }
 
     if (m_cullingType == CullingType::eIgnoreShadowCulling)
     {
@@ -413,31 +495,48 @@ UINT ModelComponent::CullingCheck()
         }
     }
 
-    return renderType;
-}
-
-bool ModelComponent::CheckFrustumCulling()
-{
-    // カリングに必要なカメラ情報の取得
-    const auto& cameraData = ShaderManager::Instance().FindCameraData(RenderingData::MainCameraName);
+    // 影を描画する場合は、どのカスケードに入っているかを別に判定する
+    const bool isSubmit = m_insideFrustum || m_isOccluded || m_cullingType != CullingType::eFrustum;
 
-    if (!cameraData)
+    // 動かないモデルの影は、キャッシュを描き直すカスケードにだけ描く
+    // 視界の外でもキャッシュには描いておく : 描き直すまで使い続けるので、後から視界に入っても影が欠けない
+    if ((renderType & shadowType) != 0 && CullingSystem::Instance().IsStaticShadowCaster(m_cullingHandle))
     {
-        return true; // カメラ情報がない場合はカリングしない
-    }
+        staticShadowCascadeMask = CullingSystem::Instance().GetShadowCascadeMask(m_cullingHandle) &
+            CullingSystem::Instance().GetStaticShadowDirtyMask();
+        shadowCascadeMask = 0;
+
+        if (staticShadowCascadeMask == 0)
+        {
+            renderType &= ~shadowType;
+        }
+        else if (!isSubmit)
+        {
+            // 視界の外なら影だけを描画する
+            renderType = shadowType;
+        }
 
-    // フラスタム情報の作成
-    DirectX::BoundingFrustum frustum(cameraData->GetProjMat());
+        CullingSystem::Instance().AddShadowCasterStats(1, static_cast<UINT32>(std::popcount(staticShadowCascadeMask)));
 
-    // フラスタムをビュー行列の逆行列で変換（ワールド空間へ）
-    Math::Matrix viewInv = cameraData->GetViewMat().Invert();
-    frustum.Transform(frustum, viewInv);
+        return renderType;
+    }
 
-    // フラスタムとAABBの交差判定
-    if (!frustum.Intersects(m_drawMeshBox.AABB.ToDirectXBoundingBox()))
+    if (isSubmit && (renderType & shadowType) != 0)
     {
-        return false;  // 交差していなければ描画をスキップ
+        shadowCascadeMask = CullingSystem::Instance().GetShadowCascadeMask(m_cullingHandle);
+        if (shadowCascadeMask == 0)
+        {
+            renderType &= ~shadowType;
+        }
+
+        CullingSystem::Instance().AddShadowCasterStats(1, static_cast<UINT32>(std::popcount(shadowCascadeMask)));
     }
 
-    return true;
+    return renderType;
+}
+
+bool ModelComponent::CheckFrustumCulling() const
+{
+    // 並列更新の前に CullingSystem::Execute でまとめて判定した結果を読むだけ
+    return CullingSystem::Instance().IsVisible(m_cullingHandle);
 }
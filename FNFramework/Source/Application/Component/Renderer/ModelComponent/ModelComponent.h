@@ -83,12 +83,20 @@ public:
     * @fn void SetRenderType(RenderingData::Model::RenderType renderType)
     * @param[in] renderType - 描画タイプ
     */
-    void SetRenderType(RenderingData::Model::RenderType renderType) { m_renderType = static_cast<UINT>(renderType); }
+    void SetRenderType(RenderingData::Model::RenderType renderType)
+    {
+        m_renderType = static_cast<UINT>(renderType);
+        CullingSystem::Instance().ResetStaticCaster(m_cullingHandle);
+    }
     /**
     * @fn void SetRenderType(RenderingData::Model::RenderType renderType)
     * @param[in] renderType - 描画タイプ
     */
-    void AddRenderType(RenderingData::Model::RenderType renderType) { m_renderType |= static_cast<UINT>(renderType); }
+    void AddRenderType(RenderingData::Model::RenderType renderType)
+    {
+        m_renderType |= static_cast<UINT>(renderType);
+        CullingSystem::Instance().ResetStaticCaster(m_cullingHandle);
+    }
 
     //--------------------------------
     // その他関数
@@ -109,6 +117,10 @@ public:
 
     void Release() override;
 
+    /* @brief 更新 : 更新のフェーズの判定で型から参照するので public にしておく */
+    void Update() override;
+    void UpdateWorldTransform() override;
+
 protected:
     //--------------------------------
     // その他関数
@@ -116,23 +128,27 @@ protected:
     /* @brief ImGui更新 */
     void ImGuiUpdate() override;
 
-    /* @brief 更新 */
-    void Update() override;
-    void UpdateWorldTransform() override;
+    /* @brief 行列を読み込んで Renderer へ送るだけなので、並列に更新する */
+    ComponentAccess DeclareUpdateAccess() const override;
 
     //-----------
     // カリング関係
     //-----------
     /**
-     * @fn UINT CullingCheck()
+     * @fn UINT CullingCheck(UINT& shadowCascadeMask, UINT& staticShadowCascadeMask)
      * @brief カリングチェックを行い、描画タイプを返す
+     * @param[out] shadowCascadeMask       - 影を描画するカスケード : 1bit = 1カスケード
+     * @param[out] staticShadowCascadeMask - 動かないモデルとして、影をキャッシュに描き直すカスケード
      * @return 描画タイプ
      */
-    UINT CullingCheck();
-    /* 試錐台カリングのチェック */
-    bool CheckFrustumCulling();
+    UINT CullingCheck(UINT& shadowCascadeMask, UINT& staticShadowCascadeMask);
+    /* 試錐台カリングのチェック : CullingSystem の判定結果を返す */
+    bool CheckFrustumCulling() const;
     void UpdateModelAABB();
 
+    /* @brief 描画ボックスを包む球の画面上の大きさから、LOD を選び直す */
+    UINT UpdateLOD();
+
     //--------------------------------
     // 変数
     //--------------------------------
@@ -161,6 +177,12 @@ protected:
     ModelBoundingData m_colMeshBox;
 
     bool m_insideFrustum = true;
+    // 視錐台の中にあるが遮蔽物に隠れている : 影だけを描画する
+    bool m_isOccluded = false;
+    // CullingSystem に登録したボックスの番号
+    CullingSystem::Handle m_cullingHandle = CullingSystem::InvalidHandle;
+    // 登録後に一度でもボックスを書き込んだか
+    bool m_isCullingBoundsSet = false;
     CullingType m_cullingType = CullingType::eFrustum;
 
 private:
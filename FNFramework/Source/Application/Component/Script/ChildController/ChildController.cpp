@@ -25,7 +25,7 @@ void ChildController::Start()
         auto playerObj = spOwner->GetScene()->FindObject(m_playerName);
         if (playerObj)
         {
-            m_wpPlayerScript = playerObj->GetComponent<PlayerScript>();
+            m_hPlayerScript = playerObj->GetComponentHandle<PlayerScript>();
         }
     }
 
@@ -76,7 +76,7 @@ void ChildController::Serialize(Json& _json) const
     };
 
     // プレイヤーオブジェクトの名前を保存
-    if (auto playerScript = m_wpPlayerScript.lock())
+    if (const PlayerScript* playerScript = GetPlayerScript())
     {
         _json[jsonKey::Comp::ChildController::PlayerObject.data()] = playerScript->GetOwner()->GetName();
     }
@@ -111,3 +111,9 @@ void ChildController::ImGuiUpdate()
     ImGui::Text(U8_TEXT("現在のステート: %s"), m_childController.GetNowStateName().data());
     m_childController.ImGui();
 }
+
+PlayerScript* ChildController::GetPlayerScript() const
+{
+    // ハンドルから解決するので、プレイヤーが削除されていれば nullptr になる
+    return GetOwnerPtr()->ResolveComponent(m_hPlayerScript);
+}
@@ -39,7 +39,7 @@ public:
     // ゲッター / セッター
     //--------------------------------
     // プレイヤオブジェクトの設定 / 取得(State側でアクセスされることを想定)
-    std::shared_ptr<PlayerScript> GetPlayerScript() const { return m_wpPlayerScript.lock(); }
+    PlayerScript* GetPlayerScript() const;
 
     // ステートマシンの取得
     utl::StateMachine<ChildController>& GetChildController() { return m_childController; }
@@ -95,7 +95,7 @@ private:
 
     utl::StateMachine<ChildController> m_childController;
 
-    std::weak_ptr<PlayerScript> m_wpPlayerScript;
+    ComponentHandle<PlayerScript> m_hPlayerScript;
     std::string m_playerName;
 
     std::weak_ptr<KurageMoveScript> m_wpKurageMoveScript;
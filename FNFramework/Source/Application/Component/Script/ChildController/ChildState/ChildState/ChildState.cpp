@@ -23,9 +23,9 @@ void ChildState::Enter(ChildController* _pOwner)
     m_basePosOffset = GenerateBasePositionOffset();
 
     // プレイヤーの位置を基準位置として設定
-    if (const std::shared_ptr<PlayerScript>& spPlayerScript = _pOwner->GetPlayerScript())
+    if (PlayerScript* pPlayerScript = _pOwner->GetPlayerScript())
     {
-        const std::shared_ptr<TransformComponent>& spPlayerTrans = spPlayerScript->GetOwner()->GetTransformComponent();
+        const std::shared_ptr<TransformComponent>& spPlayerTrans = pPlayerScript->GetOwner()->GetTransformComponent();
 
         // 基準点を設定 //
         if (spPlayerTrans)
@@ -36,7 +36,7 @@ void ChildState::Enter(ChildController* _pOwner)
         }
 
         // 子どもを追加する //
-        spPlayerScript->AddChild(PlayerScript::ChildData{ _pOwner->GetOwner(), _pOwner->GetKurageMoveScript() });
+        pPlayerScript->AddChild(PlayerScript::ChildData{ _pOwner->GetOwner(), _pOwner->GetKurageMoveScript() });
     }
     else
     {
@@ -78,9 +78,9 @@ void ChildState::Update(ChildController* _pOwner)
     }
 
     // 基準位置をプレイヤーの位置にオフセットを加えた位置に更新
-    if (const std::shared_ptr<PlayerScript>& spPlayerScript = _pOwner->GetPlayerScript())
+    if (PlayerScript* pPlayerScript = _pOwner->GetPlayerScript())
     {
-        const std::shared_ptr<TransformComponent>& spPlayerTrans = spPlayerScript->GetOwner()->GetTransformComponent();
+        const std::shared_ptr<TransformComponent>& spPlayerTrans = pPlayerScript->GetOwner()->GetTransformComponent();
         if (spPlayerTrans)
         {
             Math::Vector3 playerPos = spPlayerTrans->GetWorldPos();
@@ -158,12 +158,12 @@ void ChildState::Update(ChildController* _pOwner)
 
 void ChildState::Exit(ChildController* _pOwner)
 {
-    const std::shared_ptr<PlayerScript>& spPlayerScript = _pOwner->GetPlayerScript();
+    PlayerScript* pPlayerScript = _pOwner->GetPlayerScript();
 
-    if (!spPlayerScript) { return; }
+    if (!pPlayerScript) { return; }
 
     _pOwner->GetKurageMoveScript()->SetKurageState(KurageMoveScript::KurageState::eDefault);
-    spPlayerScript->RemoveChild(_pOwner->GetOwner());
+    pPlayerScript->RemoveChild(_pOwner->GetOwner());
 }
 
 void ChildState::ImGui(ChildController* _pOwner)
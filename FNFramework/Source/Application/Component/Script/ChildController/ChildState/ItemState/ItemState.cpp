@@ -24,15 +24,15 @@ void ItemState::Enter(ChildController* _pOwner)
 
 void ItemState::Update(ChildController* _pOwner)
 {
-    const std::shared_ptr<PlayerScript>& spPlayerScript = _pOwner->GetPlayerScript();
+    PlayerScript* pPlayerScript = _pOwner->GetPlayerScript();
 
-    if (!spPlayerScript)
+    if (!pPlayerScript)
     {
         // プレイヤーが存在しない場合は何もしない
         return;
     }
 
-    const std::shared_ptr<GameObject>& spPlayerObj = spPlayerScript->GetOwner();
+    const std::shared_ptr<GameObject>& spPlayerObj = pPlayerScript->GetOwner();
     const std::shared_ptr<TransformComponent>& spPlayerTransform = spPlayerObj->GetTransformComponent();
 
     if (!spPlayerTransform)
@@ -46,7 +46,7 @@ void ItemState::Update(ChildController* _pOwner)
     SceneManager::Instance().GetDebugWire()->AddDebugSphere(childPos, Color::Blue, m_contactDistance);
 
     // プレイヤーの子オブジェクトリストを取得
-    const std::list<PlayerScript::ChildData>& childList = spPlayerScript->GetChildList();
+    const std::list<PlayerScript::ChildData>& childList = pPlayerScript->GetChildList();
 
     // プレイヤーとその子オブジェクト全体で最も近い距離を探す
     float minDistance = (childPos - playerPos).Length();  // 初期値としてプレイヤーとの距離を設定
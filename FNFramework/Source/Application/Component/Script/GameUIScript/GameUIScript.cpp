@@ -51,6 +51,25 @@ std::weak_ptr<T> FindObjectByNameAndGetComponent(const std::string& objectName)
     return std::weak_ptr<T>();
 }
 
+// 名前でオブジェクトを検索し、検索したいコンポーネントのハンドルを返す //
+template <typename T>
+ComponentHandle<T> FindObjectByNameAndGetComponentHandle(const std::string& objectName)
+{
+    if (objectName.empty())
+    {
+        return ComponentHandle<T>(); // 空の名前なら何もしない
+    }
+
+    const auto& obj = SceneManager::Instance().GetNowScene()->FindObject(objectName);
+    if (obj)
+    {
+        return obj->GetComponentHandle<T>();
+    }
+
+    // 見つからなかった場合
+    return ComponentHandle<T>();
+}
+
 // 再帰的に名前で子オブジェクトを検索する
 std::weak_ptr<GameObject> FindChildByNameRecursive(const std::string& objectName, const std::shared_ptr<GameObject>& parent)
 {
@@ -60,14 +79,15 @@ std::weak_ptr<GameObject> FindChildByNameRecursive(const std::string& objectName
     }
 
     // 現在の親オブジェクトの子を探索
-    for (const auto& child : parent->GetChildren())
+    for (const GameObjectHandle& hChild : parent->GetChildren())
     {
-        if (child.expired()) { continue; }
+        const std::shared_ptr<GameObject> childPtr = parent->ResolveObject(hChild);
+
+        if (!childPtr) { continue; }
 
-        auto childPtr = child.lock();
         if (childPtr->GetName() == objectName)
         {
-            return child; // 名前が一致するオブジェクトを発見
+            return childPtr; // 名前が一致するオブジェクトを発見
         }
 
         // 子オブジェクトに対して再帰的に探索
@@ -106,7 +126,7 @@ void GameUIScript::Start()
 
     //x----- コンポーネントの検索 / 復元 -----x//
     m_wpStageScript = FindObjectByNameAndGetComponent<StageScript>(m_stageScriptObjectName);
-    m_wpPlayerScript = FindObjectByNameAndGetComponent<PlayerScript>(m_playerScriptObjectName);
+    m_hPlayerScript = FindObjectByNameAndGetComponentHandle<PlayerScript>(m_playerScriptObjectName);
 
     // 時間UIオブジェクトの検索
     {
@@ -167,7 +187,9 @@ void GameUIScript::PreUpdate()
 
 void GameUIScript::Update()
 {
-    if (m_wpPlayerScript.expired() ||
+    const PlayerScript* pPlayerScript = GetOwnerPtr()->ResolveComponent(m_hPlayerScript);
+
+    if (!pPlayerScript ||
         m_wpScoreUIHasSpriteComp.expired() ||
         m_wpTimeUIObjHasSpriteComps.empty() ||
         m_wpStageScript.expired())
@@ -175,7 +197,7 @@ void GameUIScript::Update()
         return;
     }
 
-    int nowChildCnt = m_wpPlayerScript.lock()->GetChildCount();
+    int nowChildCnt = pPlayerScript->GetChildCount();
     m_wpScoreUIHasSpriteComp.lock()->SetMainTexture(m_spNumberTextures[nowChildCnt]);
 
     // 秒数を[分, 秒]に変換
@@ -221,7 +243,7 @@ void GameUIScript::ImGuiUpdate()
 {
     if (ImGui::Button(U8_TEXT("PlayerScriptをセットする")))
     {
-        m_wpPlayerScript = FindObjectByNameAndGetComponent<PlayerScript>(m_playerScriptObjectName);
+        m_hPlayerScript = FindObjectByNameAndGetComponentHandle<PlayerScript>(m_playerScriptObjectName);
     }
     ImGui::Text(U8_TEXT("PlayerScriptを持っているオブジェクトの名前: %s"), m_playerScriptObjectName.c_str());
     utl::ImGuiHelper::InputTextWithString("##PlayerScriptObjName", m_playerScriptObjectName);
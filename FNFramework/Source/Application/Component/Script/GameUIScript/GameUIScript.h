@@ -86,7 +86,7 @@ private:
     std::weak_ptr<StageScript> m_wpStageScript;     // ステージスクリプト
 
     std::string m_playerScriptObjectName = "";      // プレイヤースクリプト名
-    std::weak_ptr<PlayerScript> m_wpPlayerScript;   // プレイヤースクリプト
+    ComponentHandle<PlayerScript> m_hPlayerScript;  // プレイヤースクリプト
 
     std::string m_timeUIObjectName = "";        // 時間UIオブジェクト名
     // 時間(〇 : 〇〇)を操作するためのコンポーネント
@@ -157,10 +157,12 @@ bool ResultState::ResultUIUpdateBackImage(GoalScript* _pOwner)
                 {
                     obj->SetState(GameObject::State::eActive);
 
-                    for (auto&& spChild : obj->GetChildren())
+                    for (const GameObjectHandle& hChild : obj->GetChildren())
                     {
-                        if (spChild.expired()) { continue; }
-                        setStateRecursively(spChild.lock()); // 再帰的に孫以降のオブジェクトにも伝える
+                        const std::shared_ptr<GameObject> spChild = obj->ResolveObject(hChild);
+
+                        if (!spChild) { continue; }
+                        setStateRecursively(spChild); // 再帰的に孫以降のオブジェクトにも伝える
                     }
                 };
 
@@ -66,11 +66,11 @@ void ResultUIAnimation::SetClearTextSpriteDataFromTargetTime(const std::shared_p
     }
 
     // _spObj の子要素の TargetTimeObject / ClearTimeObject を取得
-    for (auto&& wpChild : _spObj->GetChildren())
+    for (const GameObjectHandle& hChild : _spObj->GetChildren())
     {
-        if (wpChild.expired()) { continue; }
+        const std::shared_ptr<GameObject> spChild = _spObj->ResolveObject(hChild);
 
-        const std::shared_ptr<GameObject>& spChild = wpChild.lock();
+        if (!spChild) { continue; }
 
         if (spChild->GetName() == "TargetTimeObject")
         {
@@ -13,9 +13,9 @@ void ParticleScript::Awake()
 void ParticleScript::Start()
 {
     // 子オブジェクトに対するパーティクルデータを初期化
-    for (const auto& childWeak : m_wpOwnerObj.lock()->GetChildren())
+    for (const GameObjectHandle& hChild : GetOwnerPtr()->GetChildren())
     {
-        InitializeParticle(childWeak);
+        InitializeParticle(hChild);
     }
 }
 
@@ -24,43 +24,45 @@ void ParticleScript::Update()
     if (!OwnerValid()) { return; }
 
     // 子オブジェクトの数をチェックしてパーティクルデータを更新
-    auto children = m_wpOwnerObj.lock()->GetChildren();
+    const GameObject* pOwner = GetOwnerPtr();
+    const std::vector<GameObjectHandle>& children = pOwner->GetChildren();
 
     // パーティクルデータマップを更新
     if (m_particleDataMap.size() != children.size())
     {
         // 子オブジェクトが増えた場合、新たにパーティクルデータを追加
-        for (const auto& childWeak : children)
+        for (const GameObjectHandle& hChild : children)
         {
-            if (m_particleDataMap.find(childWeak.lock()->GetName()) == m_particleDataMap.end())
+            const std::shared_ptr<GameObject> spChild = pOwner->ResolveObject(hChild);
+
+            if (!spChild) { continue; }
+
+            auto it = m_particleDataMap.find(spChild->GetName());
+
+            if (it == m_particleDataMap.end())
             {
-                InitializeParticle(childWeak);
+                InitializeParticle(hChild);
+            }
+            else
+            {
+                // デシリアライズしたデータは名前しか持っていないのでここで結びつける
+                it->second.hChild = hChild;
             }
         }
 
         // 子オブジェクトが減った場合、パーティクルデータを削除
         for (auto it = m_particleDataMap.begin(); it != m_particleDataMap.end(); )
         {
-            auto spChildObj = m_wpOwnerObj.lock()->GetScene()->FindObject(it->first);
+            const std::shared_ptr<GameObject> spChildObj = pOwner->ResolveObject(it->second.hChild);
 
-            if (!spChildObj)
+            // 子オブジェクトが存在しない場合、パーティクルデータを削除
+            if (!spChildObj || spChildObj->GetParentHandle() != pOwner->GetHandle())
             {
                 it = m_particleDataMap.erase(it);
             }
             else
             {
-                // 子オブジェクトが存在しない場合、パーティクルデータを削除
-                if (std::find_if(children.begin(), children.end(),
-                    [&](const std::weak_ptr<GameObject>& child) {
-                        return child.lock()->GetName() == it->first;
-                    }) == children.end())
-                {
-                    it = m_particleDataMap.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
+                ++it;
             }
         }
     }
@@ -181,17 +183,28 @@ void ParticleScript::UpdateParticleData(float deltaTime)
             RespawnParticle(data);
         }
 
+        const std::shared_ptr<GameObject> spChild = GetOwnerPtr()->ResolveObject(data.hChild);
+
+        if (!spChild) { continue; }
+
         // TransformComponentを更新
-        if (!data.wpTransformComp.expired())
+        if (TransformComponent* pTransformComp = spChild->GetComponentPtr<TransformComponent>())
         {
-            data.wpTransformComp.lock()->SetPosition(data.position);
-            data.wpTransformComp.lock()->SetScale(data.scale);
+            pTransformComp->SetPosition(data.position);
+            pTransformComp->SetScale(data.scale);
         }
 
         // ModelComponentの色を更新
-        if (!data.wpModelComp.expired())
+        ModelComponent* pModelComp = spChild->GetComponentPtr<ModelComponent>();
+
+        if (!pModelComp)
         {
-            data.wpModelComp.lock()->SetColor(data.color);
+            pModelComp = spChild->GetComponentPtr<AnimationComponent>();
+        }
+
+        if (pModelComp)
+        {
+            pModelComp->SetColor(data.color);
         }
 
         // ライフタイムの更新（今回は無限ループなので不要）
@@ -203,13 +216,13 @@ void ParticleScript::UpdateParticleData(float deltaTime)
     }
 }
 
-void ParticleScript::InitializeParticle(std::weak_ptr<GameObject> childWeak)
+void ParticleScript::InitializeParticle(const GameObjectHandle& hChild)
 {
-    const auto& Pos = m_wpOwnerObj.lock()->GetTransformComponent()->GetWorldPos();
+    const auto& Pos = GetOwnerPtr()->GetTransformComponent()->GetWorldPos();
 
-    auto spChild = childWeak.lock();
+    const std::shared_ptr<GameObject> spChild = GetOwnerPtr()->ResolveObject(hChild);
 
-    if (spChild) { return; }
+    if (!spChild) { return; }
 
     ParticleData data;
     // 初期位置をランダムに設定
@@ -228,16 +241,8 @@ void ParticleScript::InitializeParticle(std::weak_ptr<GameObject> childWeak)
     // ライフタイムを設定
     data.lifeTime = FLT_MAX;
 
-    data.wpTransformComp = spChild->GetTransformComponent();
-
-    auto spModelComp = spChild->GetComponent<ModelComponent>();
-
-    if(!spModelComp)
-    {
-        spModelComp = spChild->GetComponent<AnimationComponent>();
-    }
-
-    data.wpModelComp = spModelComp;
+    // Transform / Model は更新時にハンドルから解決する
+    data.hChild = hChild;
 
     m_particleDataMap[spChild->GetName().data()] = data;
 }
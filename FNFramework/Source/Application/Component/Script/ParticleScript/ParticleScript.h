@@ -35,8 +35,8 @@ public:
         Math::Vector3 acceleration;
         float lifeTime;
 
-        std::weak_ptr<TransformComponent> wpTransformComp;
-        std::weak_ptr<ModelComponent> wpModelComp;
+        // 子オブジェクトのハンドル : Transform / Model はここから解決する
+        GameObjectHandle hChild;
     };
 
     //--------------------------------
@@ -105,7 +105,7 @@ private:
     void UpdateParticleData(float deltaTime);
 
     // パーティクルを初期化する関数
-    void InitializeParticle(std::weak_ptr<GameObject> child);
+    void InitializeParticle(const GameObjectHandle& hChild);
 
     // パーティクルを再生成する関数
     void RespawnParticle(ParticleData& data);
@@ -13,12 +13,14 @@ void SeaWeedWallScript::Start()
     m_wpCollisionComponent = GetOwner()->GetComponent<CollisionComponent>();
 
     const auto& wpPlayerObj= GetOwner()->GetScene()->FindObject("Player");
-    m_wpPlayerScript = wpPlayerObj->GetComponent<PlayerScript>();
+    m_hPlayerScript = wpPlayerObj->GetComponentHandle<PlayerScript>();
 }
 
 void SeaWeedWallScript::Update()
 { 
-    if (m_wpPlayerScript.expired() || m_wpCollisionComponent.expired())
+    const PlayerScript* pPlayerScript = GetOwnerPtr()->ResolveComponent(m_hPlayerScript);
+
+    if (!pPlayerScript || m_wpCollisionComponent.expired())
     {
         return;
     }
@@ -26,7 +28,7 @@ void SeaWeedWallScript::Update()
     const auto& spColComp = m_wpCollisionComponent.lock();
 
     // 自身を含めた合計人数（自身 + 子どもたちの数）
-    int totalPushers = 1 + m_wpPlayerScript.lock()->GetChildCount(); // 自身を1人として加算
+    int totalPushers = 1 + pPlayerScript->GetChildCount(); // 自身を1人として加算
 
     m_canOpen = totalPushers >= m_requiredPusherCount;
 
@@ -70,7 +70,7 @@ private:
     void ImGuiUpdate() override;
 
     int m_requiredPusherCount = 0;
-    std::weak_ptr<PlayerScript> m_wpPlayerScript;
+    ComponentHandle<PlayerScript> m_hPlayerScript;
     std::weak_ptr<CollisionComponent> m_wpCollisionComponent;
 
     bool m_openTrigger = false; 
@@ -133,11 +133,30 @@ void SeaweedRenderingScript::Update()
         CalcRenderingPos();
     }
 
+    //--------------------------------
+    // 視錐台カリング
+    //--------------------------------
+    // インスタンスごとに視錐台を作らず、同じ平面でまとめて判定する
+    UpdateCullingBoxes(spTransform->GetQuaternion());
+    CullingSystem::Instance().TestBoxes(m_cullingBoxes, m_visibleBits);
+    CullingSystem::Instance().TestShadowBoxes(m_cullingBoxes, m_cascadeCasterBits);
+
+    UINT32 shadowRequestNum = 0;
+    UINT32 shadowDrawNum = 0;
+
+    // LOD はインスタンスごとに選ぶ : 包む球の大きさと拡大率は全インスタンスで同じ
+    const ModelLOD::View& lodView = CullingSystem::Instance().GetLODView();
+    const float lodSphereRadius = m_colMeshBox.AABB.GetSize().Length() * 0.5f;
+    const Math::Vector3& scale = spTransform->GetScale();
+    const float worldScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+
     //--------------------------------
     // レンダラへのデータ送信
     //--------------------------------
-    for (const auto& renderMatData : m_seaweedInstanceRenderData)
+    for (UINT32 instanceIdx = 0; instanceIdx < static_cast<UINT32>(m_seaweedInstanceRenderData.size()); ++instanceIdx)
     {
+        SeaweedInstanceData& renderMatData = m_seaweedInstanceRenderData[instanceIdx];
+
         int idx = renderMatData.UseAnimatorIdx;
 
         if (idx < 0 || idx >= static_cast<int>(m_spAnimationInfo.size()))
@@ -149,13 +168,7 @@ void SeaweedRenderingScript::Update()
 
         UINT renderType = m_renderType;
 
-        CullingCheck(
-            {
-                renderMatData.PosAndRotZ.x,
-                renderMatData.PosAndRotZ.y,
-                renderMatData.PosAndRotZ.z
-            },
-            renderType);
+        CullingCheck(FrustumCulling::IsVisible(m_visibleBits.data(), instanceIdx), renderType);
 
         // hack : ここが何かおかしいので見直しする
         renderType = static_cast<UINT>(RenderingData::Model::RenderType::eLit);
@@ -167,19 +180,48 @@ void SeaweedRenderingScript::Update()
             continue;
         }
 
+        // 影は入っているカスケードにだけ描画する : どのカスケードにも入らなければ描画しない
+        UINT shadowCascadeMask = 0;
+        for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+        {
+            if (FrustumCulling::IsVisible(m_cascadeCasterBits[cascadeIdx].data(), instanceIdx))
+            {
+                shadowCascadeMask |= 1u << cascadeIdx;
+            }
+        }
+
+        ++shadowRequestNum;
+        shadowDrawNum += static_cast<UINT32>(std::popcount(shadowCascadeMask));
+
+        if (shadowCascadeMask == 0)
+        {
+            renderType &= ~static_cast<UINT>(RenderingData::Model::RenderType::eShadow);
+        }
+
         Math::Matrix m =
             Math::Matrix::CreateScale(spTransform->GetScale()) *
             spTransform->GetRotationMatrix() *
             //Math::Matrix::CreateRotationY(renderMatData.PosAndRotZ.w) *
             Math::Matrix::CreateTranslation({ renderMatData.PosAndRotZ.x, renderMatData.PosAndRotZ.y, renderMatData.PosAndRotZ.z });
 
-        Renderer::Instance().AddRenderingModelData(spModelData, m, renderType, m_color, m_tilling, m_offset);
+        const std::shared_ptr<ModelData> spOriginalData = spModelData->GetModelData();
+        if (spOriginalData)
+        {
+            const Math::Vector3 pos = { renderMatData.PosAndRotZ.x, renderMatData.PosAndRotZ.y, renderMatData.PosAndRotZ.z };
+            renderMatData.LOD = ModelLOD::SelectLOD(spOriginalData->GetLODErrors(),
+                ModelLOD::CalcPixelPerError(lodView, pos, lodSphereRadius, worldScale), renderMatData.LOD);
+        }
+
+        Renderer::Instance().AddRenderingModelData(spModelData, m, renderType, m_color, m_tilling, m_offset, shadowCascadeMask,
+            0, renderMatData.LOD);
     }
+
+    CullingSystem::Instance().AddShadowCasterStats(shadowRequestNum, shadowDrawNum);
 }
 
-void SeaweedRenderingScript::CullingCheck(const Math::Vector3& worldPos, UINT& renderType)
+void SeaweedRenderingScript::CullingCheck(bool isVisible, UINT& renderType)
 {
-    m_insideFrustum = CheckFrustumCulling(worldPos);
+    m_insideFrustum = isVisible;
 
     if (m_cullingType == CullingType::eIgnoreShadowCulling)
     {
@@ -195,33 +237,29 @@ void SeaweedRenderingScript::CullingCheck(const Math::Vector3& worldPos, UINT& r
     }
 }
 
-bool SeaweedRenderingScript::CheckFrustumCulling(const Math::Vector3& worldPos)
+void SeaweedRenderingScript::UpdateCullingBoxes(const Math::Quaternion& orientation)
 {
-    // カメラのフラスタム情報を取得
-    const auto& cameraData = ShaderManager::Instance().FindCameraData(RenderingData::MainCameraName);
-    if (!cameraData)
+    const UINT32 instanceNum = static_cast<UINT32>(m_seaweedInstanceRenderData.size());
+    if (m_cullingBoxes.GetNum() != instanceNum)
     {
-        return true; // カメラ情報がない場合はカリングしない
+        m_cullingBoxes.Resize(instanceNum);
     }
 
-    // フラスタムをワールド空間に変換
-    DirectX::BoundingFrustum frustum(cameraData->GetProjMat());
-    Math::Matrix viewInv = cameraData->GetViewMat().Invert();
-    frustum.Transform(frustum, viewInv);
+    // 回転した OBB を包む AABB の半分のサイズ : 全インスタンスで同じ回転なので1回だけ計算する
+    const Math::Vector3 extents = m_colMeshBox.AABB.GetSize() / 2.0f;
+    const Math::Matrix mRot = Math::Matrix::CreateFromQuaternion(orientation);
 
-    OBB obb;
-    obb.Center = worldPos;
-    const Math::Vector3& extents = m_colMeshBox.AABB.GetSize() / 2.0f;
-    obb.Extents = extents;
-    obb.Orientation = m_wpOwnerObj.lock()->GetTransformComponent()->GetQuaternion();
+    const Math::Vector3 aabbExtents = {
+        std::abs(mRot._11) * extents.x + std::abs(mRot._21) * extents.y + std::abs(mRot._31) * extents.z,
+        std::abs(mRot._12) * extents.x + std::abs(mRot._22) * extents.y + std::abs(mRot._32) * extents.z,
+        std::abs(mRot._13) * extents.x + std::abs(mRot._23) * extents.y + std::abs(mRot._33) * extents.z
+    };
 
-    // ワールド座標がフラスタム内か判定
-    if (!frustum.Intersects(obb.ToDirectXOBB()))
+    for (UINT32 i = 0; i < instanceNum; ++i)
     {
-        return false;
+        const Math::Vector4& posAndRotZ = m_seaweedInstanceRenderData[i].PosAndRotZ;
+        m_cullingBoxes.Set(i, { posAndRotZ.x, posAndRotZ.y, posAndRotZ.z }, aabbExtents);
     }
-
-    return true;
 }
 
 void SeaweedRenderingScript::CalcRenderingPos()
@@ -79,8 +79,9 @@ private:
     void ImGuiUpdate() override;
     void ImGuiChangeAnimData();
 
-    void CullingCheck(const Math::Vector3& worldPos, UINT& renderType);
-    bool CheckFrustumCulling(const Math::Vector3& pos);
+    void CullingCheck(bool isVisible, UINT& renderType);
+    /* @brief インスタンスごとのカリング用のボックスの更新 : OBB を包む AABB にする */
+    void UpdateCullingBoxes(const Math::Quaternion& orientation);
 
     void CalcRenderingPos();
 
@@ -112,9 +113,15 @@ private:
     {
         Math::Vector4 PosAndRotZ;
         int UseAnimatorIdx = 0;
+        UINT LOD = 0; // 前回選んだ LOD
     };
     std::vector<SeaweedInstanceData> m_seaweedInstanceRenderData;
     int m_currentSeaweedIdx = 0;
+
+    // 視錐台カリング用 : インスタンスのボックスをまとめて判定する //
+    FrustumCulling::AABBArrays m_cullingBoxes;
+    std::vector<UINT32> m_visibleBits;
+    std::array<std::vector<UINT32>, ShadowCascade::CascadeNum> m_cascadeCasterBits;
 };
 
 // Jsonで利用するキー
@@ -15,10 +15,7 @@ void TitleScript::Start()
 
         for(auto&& obj : scene->GetObjectList())
         {
-            for(auto&& comp : obj->GetComponents())
-            {
-                comp->DownStartFlg();
-            }
+            obj->DownStartFlg();
         }
     }
 }
@@ -32,18 +32,18 @@ void WallEventScript::Start()
     if (!spEventObj) { return; }
 
     m_wpEventObject = spEventObj;
-    m_wpPlayerScript = spEventObj->GetComponent<PlayerScript>();
+    m_hPlayerScript = spEventObj->GetComponentHandle<PlayerScript>();
     m_wpPlayerKurageMoveScript = spEventObj->GetComponent<KurageMoveScript>();
 }
 
 void WallEventScript::Update()
 {
-    if (!OwnerValid() || m_wpEventObject.expired() || m_wpPlayerScript.expired())
+    if (!OwnerValid() || m_wpEventObject.expired() || !GetPlayerScript())
     {
         return;
     }
 
-    const auto& spPlayerObj = m_wpPlayerScript.lock()->GetOwner();
+    const auto& spPlayerObj = GetPlayerScript()->GetOwner();
     const Math::Vector3& playerPos = spPlayerObj->GetTransformComponent()->GetWorldPos();
 
     Math::Color areaColor = Color::Blue;
@@ -85,7 +85,7 @@ void WallEventScript::Update()
             m_eventActiveFrame = false;
         }
 
-        m_wpPlayerScript.lock()->SetIsEventActive(true);
+        GetPlayerScript()->SetIsEventActive(true);
         Event();
         areaColor = Color::Red;
     }
@@ -95,7 +95,7 @@ void WallEventScript::Update()
 
         m_eventPhase = EventPhase::MovingToInitialPositions;
 
-        m_wpPlayerScript.lock()->SetIsEventActive(false);
+        GetPlayerScript()->SetIsEventActive(false);
     }
 
     // デバッグ用の表示
@@ -108,6 +108,11 @@ void WallEventScript::Update()
     SceneManager::Instance().GetDebugWire()->AddDebugBox(m_eventData.EventArea, areaColor);
 }
 
+PlayerScript* WallEventScript::GetPlayerScript() const
+{
+    return GetOwnerPtr()->ResolveComponent(m_hPlayerScript);
+}
+
 void WallEventScript::ConstructAABB(const Math::Vector3& size)
 {
     // AABBを基準座標を中心に構築
@@ -151,7 +156,7 @@ void WallEventScript::ImGuiUpdate()
         }
 
         m_wpEventObject = spEventObj;
-        m_wpPlayerScript = spEventObj->GetComponent<PlayerScript>();
+        m_hPlayerScript = spEventObj->GetComponentHandle<PlayerScript>();
         m_wpPlayerKurageMoveScript = spEventObj->GetComponent<KurageMoveScript>();
     }
 }
@@ -204,7 +209,7 @@ void WallEventScript::Event()
     {
         // イベントが終了したらプレイヤーのアニメーションスピードを元に戻す
         m_wpPlayerKurageMoveScript.lock()->SetChargeAnimSpeed(m_beforePlayerChargeAnimSpeed);
-        m_wpPlayerScript.lock()->SetIsEventActive(false);
+        GetPlayerScript()->SetIsEventActive(false);
         m_requestTime = 0.0f;
     }
     break;
@@ -223,7 +228,7 @@ void WallEventScript::HandleInitialPositioning()
     float childChargeAnimSpeed = 0.0f;
 
     // 子どもたちの移動処理 //
-    for (const auto& childData : m_wpPlayerScript.lock()->GetChildList())
+    for (const auto& childData : GetPlayerScript()->GetChildList())
     {
         if (childData.wpChildObj.expired() || childData.wpKurageMoveScript.expired())
         {
@@ -274,7 +279,7 @@ void WallEventScript::HandleInitialPositioning()
         m_beforePlayerChargeAnimSpeed = spPlayerKurageMoveScript->GetChargeAnimSpeed();
 
         // 子どものアニメーションと同期する
-        if (!m_wpPlayerScript.lock()->GetChildList().empty())
+        if (!GetPlayerScript()->GetChildList().empty())
         {
             spPlayerKurageMoveScript->SetChargeAnimSpeed(childChargeAnimSpeed);
         }
@@ -294,7 +299,7 @@ void WallEventScript::HandleMovingToLatePosition()
     constexpr float eventActiveArea = 3.0f;
 
     // 子どもの移動処理
-    for (const auto& childData : m_wpPlayerScript.lock()->GetChildList())
+    for (const auto& childData : GetPlayerScript()->GetChildList())
     {
         if (childData.wpChildObj.expired() || childData.wpKurageMoveScript.expired())
         {
@@ -374,7 +379,7 @@ void WallEventScript::HandleMovingToLatePosition()
 void WallEventScript::CalcTargetPosition()
 {
     // プレイヤースクリプトから子どものリストを取得
-    const std::list<PlayerScript::ChildData>& childList = m_wpPlayerScript.lock()->GetChildList();
+    const std::list<PlayerScript::ChildData>& childList = GetPlayerScript()->GetChildList();
     UINT eventObjectCount = childList.size();
 
     eventObjectCount += 1; // プレイヤーも含める
@@ -426,7 +431,7 @@ void WallEventScript::CalcTargetPosition()
             break;
         }
 
-        position.y = m_wpPlayerScript.lock()->GetOwner()->GetTransformComponent()->GetWorldPos().y;
+        position.y = GetPlayerScript()->GetOwner()->GetTransformComponent()->GetWorldPos().y;
 
         // 計算した位置をターゲット座標リストに設定
         m_eventData.TargetPositions[i] = position;
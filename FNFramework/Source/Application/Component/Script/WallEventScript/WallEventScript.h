@@ -76,7 +76,8 @@ private:
 
     // イベント対象のオブジェクト / 操作用コンポーネント
     std::weak_ptr<GameObject> m_wpEventObject;
-    std::weak_ptr<PlayerScript> m_wpPlayerScript;
+    ComponentHandle<PlayerScript> m_hPlayerScript;
+    PlayerScript* GetPlayerScript() const;
     std::weak_ptr<KurageMoveScript> m_wpPlayerKurageMoveScript;
 
     float m_beforePlayerChargeAnimSpeed = 0.0f;
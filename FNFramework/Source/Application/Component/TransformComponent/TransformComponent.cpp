@@ -1,47 +1,76 @@
 ﻿#include "TransformComponent.h"
 
-Math::Vector3 TransformComponent::GetWorldPos() const
+TransformComponent::TransformComponent(const std::shared_ptr<GameObject>& owner, const std::string& name, bool _enableSerialize)
+    : BaseComponent(owner, name, _enableSerialize, ComponentType::eTranform)
 {
-    Math::Vector3 worldPos = m_position;
-
-    // 自身が無効な場合は、ローカル座標を返す
-    if(!OwnerValid())
+    // シーンの TransformHierarchy に登録して、行列の管理を任せる
+    if (Scene* pScene = GetOwnerPtr() ? GetOwnerPtr()->GetScenePtr() : nullptr)
     {
-        return m_position;
+        m_pHierarchy = &pScene->WorkTransformHierarchy();
+        m_nodeIndex = m_pHierarchy->Register(this);
     }
-
-    // 親がいる場合は親のワールド行列を適用してワールド座標を計算
-    if (auto parent = m_wpOwnerObj.lock()->GetParent())
+    else
     {
-        // 親のワールド行列を取得
-        const Math::Matrix& parentWorldMatrix = parent->GetTransformComponent()->GetWorldMatrix();
+        FNENG_ASSERT_ERROR("シーンに所属していないオブジェクトにTransformComponentが追加されました");
+    }
+}
 
-        // ワールド行列を使ってワールド座標を計算
-        worldPos = Math::Vector3::Transform(m_position, parentWorldMatrix);
+TransformComponent::~TransformComponent()
+{
+    if (m_pHierarchy)
+    {
+        m_pHierarchy->Unregister(m_nodeIndex);
     }
+}
+
+const Math::Matrix& TransformComponent::GetWorldMatrix() const
+{
+    if (!m_pHierarchy) { return Math::Matrix::Identity; }
+    return m_pHierarchy->GetWorldMatrix(m_nodeIndex);
+}
+
+const Math::Matrix& TransformComponent::GetLocalMatrix() const
+{
+    if (!m_pHierarchy) { return Math::Matrix::Identity; }
+    return m_pHierarchy->GetLocalMatrix(m_nodeIndex);
+}
 
-    return worldPos;
+const Math::Matrix& TransformComponent::GetInvWorldMatrix() const
+{
+    if (!m_pHierarchy) { return Math::Matrix::Identity; }
+    return m_pHierarchy->GetInvWorldMatrix(m_nodeIndex);
+}
+
+Math::Vector3 TransformComponent::GetWorldPos() const
+{
+    // ワールド行列 = ローカル行列 * 親のワールド行列 なので、平行移動成分がそのままワールド座標になる
+    return GetWorldMatrix().Translation();
 }
 
 void TransformComponent::SetPosition(const Math::Vector3& worldPos)
 {
-    m_isCalcMatrix = true;
-    // 自身が無効な場合は、ローカル座標を設定
-    if(!OwnerValid())
+    // 親のワールド行列の逆行列を使ってローカル座標に変換 : 親がいない場合は単位行列
+    // 親の行列を計算する前に自身のダーティを立てると親の計算に巻き込まれるので、通知は変換の後に行う
+    if (m_pHierarchy)
     {
-        m_position = worldPos;
-        return;
+        m_position = Math::Vector3::Transform(worldPos, m_pHierarchy->GetParentInvWorldMatrix(m_nodeIndex));
     }
-
-    if (auto parent = m_wpOwnerObj.lock()->GetParent())
+    else
     {
-        // 親のワールド行列の逆行列を使ってローカル座標に変換
-        Math::Matrix invParentWorldMatrix = parent->GetTransformComponent()->GetWorldMatrix().Invert();
-        m_position = Math::Vector3::Transform(worldPos, invParentWorldMatrix);  // ローカル座標に変換
+        // 自身が無効な場合は、ローカル座標を設定
+        m_position = worldPos;
     }
-    else
+
+    MarkDirty();
+}
+
+void TransformComponent::MarkDirty()
+{
+    m_isCalcMatrix = true;
+
+    if (m_pHierarchy)
     {
-        m_position = worldPos;  // 親がいない場合はそのままワールド座標を設定
+        m_pHierarchy->MarkDirty(m_nodeIndex);
     }
 }
 
@@ -51,23 +80,23 @@ void TransformComponent::Awake()
     m_scale = Math::Vector3{1.0f, 1.0f, 1.0f};
     m_rotate = Math::Vector3::Zero;
 
-    m_isCalcMatrix = false;
+    MarkDirty();
 }
 
 void TransformComponent::Start()
 {
-    // 初期化段階で設定された座標に更新しておく
+    // 初期化段階で設定された回転を整えておく : 行列は参照された時に計算される
     Update();
-    PostUpdate();
 }
 
 void TransformComponent::ImGuiUpdate()
 {
-    ImGui::Text("WorldPosition : %.2f, %.2f, %.2f", m_mWorld._41, m_mWorld._42, m_mWorld._43);
-    if (ImGui::DragFloat3("LocalPosition", &m_position.x, 0.1f)) { m_isCalcMatrix = true; }
+    const Math::Matrix& mWorld = GetWorldMatrix();
+    ImGui::Text("WorldPosition : %.2f, %.2f, %.2f", mWorld._41, mWorld._42, mWorld._43);
+    if (ImGui::DragFloat3("LocalPosition", &m_position.x, 0.1f)) { MarkDirty(); }
 
-    if (ImGui::DragFloat3("Scale", &m_scale.x, 0.1f)) { m_isCalcMatrix = true; }
-    if (ImGui::DragFloat3("Rotation", &m_rotate.x, 0.1f)) { m_isUpdateQuaternion = true; }
+    if (ImGui::DragFloat3("Scale", &m_scale.x, 0.1f)) { MarkDirty(); }
+    if (ImGui::DragFloat3("Rotation", &m_rotate.x, 0.1f)) { m_isUpdateQuaternion = true; MarkDirty(); }
 }
 
 void TransformComponent::Update()
@@ -81,74 +110,27 @@ void TransformComponent::Update()
     if (m_rotate.x < 0) { m_rotate.x += 360.0f; }
     if (m_rotate.y < 0) { m_rotate.y += 360.0f; }
     if (m_rotate.z < 0) { m_rotate.z += 360.0f; }
+}
 
-    if(m_isUpdateQuaternion)
+Math::Matrix TransformComponent::CalcLocalMatrix()
+{
+    if (m_isUpdateQuaternion)
     {
         m_quaternion = Math::Quaternion::CreateFromYawPitchRoll(MathHelper::ConvertToRadians(m_rotate));
         m_quaternion.Normalize();
         m_isUpdateQuaternion = false;
-
-        // 行列の更新を行う
-        m_isCalcMatrix = true;
     }
 
+    m_isCalcMatrix = false;
+
     //---------------------------
     // ローカルの行列合成
     //---------------------------
-    if (m_isCalcMatrix)
-    {
-        m_isCalcMatrix = false;
-
-        Math::Matrix mScale = Math::Matrix::CreateScale(m_scale);
-        Math::Matrix mRot = Math::Matrix::CreateFromQuaternion(m_quaternion);
-        Math::Matrix mTrans = Math::Matrix::CreateTranslation(m_position);
-
-        m_mLocal = mScale * mRot * mTrans;
-    }
-}
-
-void TransformComponent::PostUpdate()
-{
-    if (!OwnerValid()) { return; }
+    Math::Matrix mScale = Math::Matrix::CreateScale(m_scale);
+    Math::Matrix mRot = Math::Matrix::CreateFromQuaternion(m_quaternion);
+    Math::Matrix mTrans = Math::Matrix::CreateTranslation(m_position);
 
-    const std::shared_ptr<GameObject>& spOwnerObj = m_wpOwnerObj.lock();
-
-    //x----- 子オブジェクトのTransformComponentも更新 -----x//
-    for (const auto& wpChild : spOwnerObj->GetChildren())
-    {
-        if(wpChild.expired()) { continue; }
-
-        const auto& spChild = wpChild.lock();
-        const auto& spChildTrans = spChild->GetTransformComponent();
-
-        if (!PreClassValid(spChildTrans)) { continue; }
-
-        spChildTrans->PostUpdate();  // 子オブジェクトのTransformを更新
-    }
-
-    //---------------------------
-    // ワールドの行列合成
-    //---------------------------
-    if (const auto& spParent = spOwnerObj->GetParent())
-    {
-        const auto& spParentTrans = spParent->GetTransformComponent();
-
-        // なんらかの状態で 親のTransformComponentが取得できない場合は、 m_mWorld = m_mLocal とする
-        if (!spParentTrans)
-        {
-            m_mWorld = m_mLocal;
-        }
-        else
-        {
-            // 親のワールド行列と自身のローカル行列を掛け合わせる
-            m_mWorld = m_mLocal * spParentTrans->GetWorldMatrix();
-        }
-    }
-    else
-    {
-        // 親がいない場合、自身のローカル行列がそのままワールド行列
-        m_mWorld = m_mLocal;
-    }
+    return mScale * mRot * mTrans;
 }
 
 void TransformComponent::Serialize(Json& _json) const
@@ -8,10 +8,14 @@
 * @details
 *	座標、回転、拡大率を持つコンポーネント
 *	このコンポーネントはあくまで変数を持っているのみで、移動などは別コンポーネントで行う
+*	行列はシーンの TransformHierarchy で親子順にまとめて管理され、参照時に必要な分だけ計算される
 */
 class TransformComponent
     : public BaseComponent
 {
+    // 行列の計算とノード番号の更新を行う
+    friend class TransformHierarchy;
+
 public:
     //--------------------------------
     // コンストラクタ / デストラクタ
@@ -22,24 +26,20 @@ public:
     * @param[in] name - コンポーネントの名前
     * @param[in] _enableSerialize - シリアライズをするかどうか
     */
-    TransformComponent(const std::shared_ptr<GameObject>& owner, const std::string& name, bool _enableSerialize)
-        : BaseComponent(owner, name, _enableSerialize, ComponentType::eTranform)
-    {
-    }
+    TransformComponent(const std::shared_ptr<GameObject>& owner, const std::string& name, bool _enableSerialize);
+
+    ~TransformComponent() override;
 
     //--------------------------------
     // ゲッター / セッター
     //--------------------------------
 
-    const Math::Matrix& GetWorldMatrix() const
-    {
-        return m_mWorld;
-    }
+    const Math::Matrix& GetWorldMatrix() const;
 
-    const Math::Matrix& GetLocalMatrix() const
-    {
-        return m_mLocal;
-    }
+    const Math::Matrix& GetLocalMatrix() const;
+
+    /* @brief ワールド行列の逆行列を取得 : 毎回逆行列を計算しないようにキャッシュされている */
+    const Math::Matrix& GetInvWorldMatrix() const;
 
     const Math::Quaternion& GetQuaternion() const
     {
@@ -51,7 +51,7 @@ public:
         return Math::Matrix::CreateFromQuaternion(m_quaternion);
     }
 
-    // 親がいる場合は親のワールド行列を適用してワールド座標を計算
+    // ワールド行列の平行移動成分
     Math::Vector3 GetWorldPos() const;
 
     const Math::Vector3& GetLocalPos() const
@@ -72,7 +72,7 @@ public:
     /* @brief 正面ベクトルを取得 @正面ベクトル */
     Math::Vector3 GetForward() const
     {
-        return m_mWorld.Backward();
+        return GetWorldMatrix().Backward();
     }
 
     /* @brief 座標の設定 @param[in] position - 設定する座標 */
@@ -80,26 +80,26 @@ public:
 
     void SetPositionX(float x)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_position.x = x;
     }
 
     void SetPositionY(float y)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_position.y = y;
     }
 
     void SetPositionZ(float z)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_position.z = z;
     }
 
     /* @brief 回転率の設定 @param[in] rotation - 設定する回転率 */
     void SetRotation(const Math::Vector3& rotation)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_rotate = rotation;
 
         m_quaternion = Math::Quaternion::CreateFromYawPitchRoll(MathHelper::ConvertToRadians(m_rotate));
@@ -108,7 +108,7 @@ public:
 
     void SetQuarternion(const Math::Quaternion& quarternion)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         // クォータニオンは直接変更されているのでフラグは立てない
         m_quaternion = quarternion;
         m_rotate = m_quaternion.ToEuler();
@@ -117,18 +117,21 @@ public:
     void SetRotationX(float x)
     {
         m_isUpdateQuaternion = true;
+        MarkDirty();
         m_rotate.x = x;
     }
 
     void SetRotationY(float y)
     {
         m_isUpdateQuaternion = true;
+        MarkDirty();
         m_rotate.y = y;
     }
 
     void SetRotationZ(float z)
     {
         m_isUpdateQuaternion = true;
+        MarkDirty();
         m_rotate.z = z;
     }
 
@@ -140,25 +143,25 @@ public:
 
     void SetScale(const Math::Vector3& scale)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_scale = scale;
     }
 
     void SetScaleX(float x)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_scale.x = x;
     }
 
     void SetScaleY(float y)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_scale.y = y;
     }
 
     void SetScaleZ(float z)
     {
-        m_isCalcMatrix = true;
+        MarkDirty();
         m_scale.z = z;
     }
 
@@ -174,7 +177,6 @@ public:
 
     /* @brief 更新 */
     void Update() override;
-    void PostUpdate() override;
 
     void Serialize(Json& _json) const override;
     void Deserialize(const Json& _json) override;
@@ -186,6 +188,12 @@ private:
     /* @brief 更新 */
     void ImGuiUpdate() override;
 
+    /* @brief 行列の再計算が必要なことを TransformHierarchy に通知する */
+    void MarkDirty();
+
+    /* @brief 座標 / 回転 / 拡大率 からローカル行列を作成する : TransformHierarchy から呼ばれる */
+    Math::Matrix CalcLocalMatrix();
+
     // 更新フラグ
     // 行列の計算をおこなうかどうか
     bool m_isCalcMatrix = false;
@@ -200,8 +208,9 @@ private:
 
     Math::Quaternion m_quaternion = Math::Quaternion::Identity; // 回転
 
-    Math::Matrix m_mLocal; // ローカル行列
-    Math::Matrix m_mWorld; // ワールド行列
+    // 行列を管理しているシーンの TransformHierarchy と、その中での番号
+    TransformHierarchy* m_pHierarchy = nullptr;
+    UINT32 m_nodeIndex = 0;
 };
 
 namespace jsonKey::Comp
@@ -26,7 +26,7 @@ void GameObject::Serialize(Json& _json) const
     _json[jsonKey::Object::Key_Components.data()] = componentsData;
 
     // 親オブジェクトの名前をシリアライズ
-    if (auto parent = m_wpParent.lock())
+    if (const std::shared_ptr<GameObject> parent = GetParent())
     {
         _json[jsonKey::Object::Key_ParentName.data()] = parent->GetName();
     }
@@ -38,8 +38,7 @@ void GameObject::Serialize(Json& _json) const
 
 void GameObject::Deserialize(const Json& _json)
 {
-    // オブジェクト名を復元
-    m_objName = _json.at(jsonKey::Object::Key_Name.data()).get<std::string>();
+    // オブジェクト名は Scene::AddObject で重複しない名前が設定され、名前の索引にも登録済みなので復元しない
 
     // 親オブジェクトの名前を保存
     {
@@ -90,126 +89,131 @@ void GameObject::AddChild(const std::shared_ptr<GameObject>& child)
     if (!child) { return; }
 
     // 子供がすでに他の親を持っている場合、親から削除する
-    if (auto oldParent = child->GetParent())
+    if (const std::shared_ptr<GameObject> oldParent = child->GetParent())
     {
         oldParent->RemoveParentChildRelation(child);
     }
 
-    // 親オブジェクトとして自分を設定し、親子関係を確立
-    child->m_wpParent = shared_from_this();
-    m_wpChildren.emplace_back(child);
-
-    // 子供のワールド座標を取得
-    const Math::Vector3& childWorldPos = child->GetTransformComponent()->GetWorldPos();
+    // 親子関係を結ぶ前の子供のワールド座標を取得
+    const Math::Vector3 childWorldPos = child->GetTransformComponent()->GetWorldPos();
 
-    // 親のワールド行列の逆行列を取得
-    const Math::Matrix& parentWorldMatrixInv = GetTransformComponent()->GetWorldMatrix().Invert();
+    // 親オブジェクトとして自分を設定し、親子関係を確立
+    child->m_parent = m_handle;
+    child->m_indexInParent = static_cast<UINT32>(m_children.size());
+    m_children.emplace_back(child->m_handle);
+    m_pScene->WorkTransformHierarchy().MarkOrderDirty();
 
-    // 子オブジェクトのワールド座標を親のローカル座標に変換
-    const Math::Vector3 localPos = Math::Vector3::Transform(childWorldPos, parentWorldMatrixInv);
-    child->GetTransformComponent()->SetPosition(localPos);
+    // ワールド座標が変わらないように、親のワールドの逆行列でローカル座標に変換して設定
+    child->GetTransformComponent()->SetPosition(childWorldPos);
 }
 
-std::list<std::weak_ptr<GameObject>>::iterator GameObject::RemoveParentChildRelation(
-    const std::shared_ptr<GameObject>& child)
+std::vector<GameObjectHandle>::iterator GameObject::RemoveParentChildRelation(
+    const std::shared_ptr<GameObject>& child, bool isKeepWorldPos)
 {
-    if (auto parent = child->m_wpParent.lock())
+    if (const std::shared_ptr<GameObject> parent = child->GetParent())
     {
-        auto it = parent->m_wpChildren.begin();
-        while (it != parent->m_wpChildren.end())
+        const UINT32 index = child->m_indexInParent;
+
+        // 保持している位置が親のリストと食い違っている場合は、親子関係が壊れている
+        if (index < parent->m_children.size() && parent->m_children[index] == child->m_handle)
         {
-            if (it->lock() == child)
-            {
-                // 子供のローカル座標をワールド座標に変換するため、親のワールド行列を使用
-                const Math::Vector3& childLocalPos = child->GetTransformComponent()->GetWorldPos();
-                const Math::Matrix& parentWorldMatrix = parent->GetTransformComponent()->GetWorldMatrix();
+            // 親子関係を解消する前の子供のワールド座標を取得 : 保たない場合は行列を計算しない
+            const Math::Vector3 childWorldPos = isKeepWorldPos ?
+                child->GetTransformComponent()->GetWorldPos() : Math::Vector3::Zero;
 
-                // ローカル座標をワールド座標に変換
-                Math::Vector3 childWorldPos = Math::Vector3::Transform(childLocalPos, parentWorldMatrix);
+            // 親子関係を解消
+            child->m_parent.Reset();
+            m_pScene->WorkTransformHierarchy().MarkOrderDirty();
 
-                // 子供のワールド座標をセット
+            // 親がいなくなるので、ワールド座標をそのままローカル座標として設定
+            if (isKeepWorldPos)
+            {
                 child->GetTransformComponent()->SetPosition(childWorldPos);
-
-                // 親子関係を解消
-                child->m_wpParent.reset();
-                it = parent->m_wpChildren.erase(it);
-
-                return it; // 削除後の次の要素を返す
             }
-            ++it;
+
+            return parent->EraseChildAt(index); // 詰めた後の同じ位置を返す
         }
+
+        FNENG_ASSERT_LOG("親の子供リストに自身が見つかりません", false);
     }
 
-    return m_wpChildren.end(); // 削除されなかった場合、end()を返す
+    return m_children.end(); // 削除されなかった場合、end()を返す
 }
 
-void GameObject::Init()
+std::vector<GameObjectHandle>::iterator GameObject::EraseChildAt(size_t index)
 {
-    if (m_spTransformComponent.expired())
+    // 外す子供の位置を無効にしておく : 既に破棄されている場合は解決できないので何もしない
+    if (GameObject* pChild = ResolveObjectPtr(m_children[index]))
     {
-        m_spTransformComponent = AddComponent<TransformComponent>(true);
+        pChild->m_indexInParent = InvalidChildIndex;
     }
-}
 
-void GameObject::Start()
-{
-    for (int i = 0; i < m_spComponents.size(); ++i)
+    // 末尾の子供を空いた位置に移し、移した子供の位置を更新する
+    const size_t lastIndex = m_children.size() - 1;
+    if (index != lastIndex)
     {
-        m_spComponents[i]->StartComponent();
+        m_children[index] = m_children[lastIndex];
+
+        if (GameObject* pMoved = ResolveObjectPtr(m_children[index]))
+        {
+            pMoved->m_indexInParent = static_cast<UINT32>(index);
+        }
     }
+
+    m_children.pop_back();
+
+    return m_children.begin() + index;
 }
 
-void GameObject::Update()
+std::shared_ptr<GameObject> GameObject::ResolveObject(const GameObjectHandle& handle) const
 {
-    //--------------------------------
-    // 更新処理
-    //--------------------------------
+    return m_pScene->ResolveObject(handle);
+}
 
-    if (m_state != State::eActive) { return; }
+GameObject* GameObject::ResolveObjectPtr(const GameObjectHandle& handle) const
+{
+    return m_pScene->ResolveObjectPtr(handle);
+}
 
+void GameObject::Init()
+{
     if (m_spTransformComponent.expired())
     {
-        FNENG_ASSERT_ERROR("Transformコンポーネントがありません");
-        return;
+        m_spTransformComponent = AddComponent<TransformComponent>(true);
     }
+}
 
-    // コンポーネントの更新
-    for (auto&& comp : m_spComponents)
-    {
-        if (!comp->IsEnable()) { continue; }
-
-        comp->PreUpdate();
-    }
+void GameObject::Start()
+{
+    if (!m_hasUnstartedComp) { return; }
 
-    // ワールド行列の更新
-    UpdateWorldTransform();
+    // Start の中で追加されたコンポーネントは、フラグが立ち直るので次のフレームで Start される
+    m_hasUnstartedComp = false;
 
-    // コンポーネントの更新
-    for (UINT i = 0; i < m_spComponents.size(); ++i)
+    for (int i = 0; i < m_spComponents.size(); ++i)
     {
-        if (!m_spComponents[i]->IsEnable()) { continue; }
-
-        m_spComponents[i]->Update();
+        m_spComponents[i]->StartComponent();
     }
+}
 
-    // ワールド行列の更新
-    UpdateWorldTransform();
-
-    // コンポーネントの更新
+void GameObject::DownStartFlg()
+{
     for (auto&& comp : m_spComponents)
     {
-        if (!comp->IsEnable()) { continue; }
-
-        comp->PostUpdate();
+        comp->DownStartFlg();
     }
+
+    m_hasUnstartedComp = true;
 }
 
 void GameObject::ImGuiUpdate()
 {
     //x--- オブジェクトの名前を変更 ---x//
-    if (utl::ImGuiHelper::InputTextWithString(U8_TEXT("オブジェクト名"), m_objName))
+    // 名前の索引を更新するため、直接書き換えずにシーン経由で変更する
+    std::string editName = m_objName;
+    if (utl::ImGuiHelper::InputTextWithString(U8_TEXT("オブジェクト名"), editName))
     {
-        m_objName = Scene::GenerateUniqueName(m_wpScene.lock()->GetObjectList(), m_objName);
+        m_wpScene.lock()->ChangeObjectName(m_objName, editName, true);
     }
 
     //---------------------------------------------------------
@@ -268,11 +272,14 @@ void GameObject::ImGuiUpdate()
         ImGuiTreeNodeFlags_OpenOnArrow;
 
     // 子オブジェクトのみ表示
-    for (auto it = m_wpChildren.begin(); it != m_wpChildren.end();)
+    for (auto it = m_children.begin(); it != m_children.end();)
     {
-        if (it->expired())
+        // 無効なハンドルは削除して次の要素へ : 解決結果はコピーして保持する
+        const std::shared_ptr<GameObject> spChild = ResolveObject(*it);
+
+        if (!spChild)
         {
-            it = m_wpChildren.erase(it); // 無効なポインタは削除して次の要素へ
+            it = EraseChildAt(it - m_children.begin());
             continue;
         }
 
@@ -280,15 +287,15 @@ void GameObject::ImGuiUpdate()
         ImGui::Separator();
 
         //x-------- 親子の解消 --------x//
-        ImGui::PushID(&it);
+        ImGui::PushID(&(*it));
         if (ImGui::Button(U8_TEXT("親子の解消")))
         {
-            it = RemoveParentChildRelation(it->lock()); // イテレータを更新
+            ImGui::PopID();
+            it = RemoveParentChildRelation(spChild); // イテレータを更新
             continue;
         }
 
         //x-------- 子オブジェクトのGUI表示 --------x//
-        const std::shared_ptr<GameObject>& spChild = it->lock();
 
         // 有効フラグ更新
         bool isActiveState = spChild->GetState() == State::eActive;
@@ -318,23 +325,35 @@ void GameObject::ImGuiUpdate()
     }
 }
 
-void GameObject::UpdateWorldTransform()
+void GameObject::RebuildComponentIndex()
 {
-    if (m_spTransformComponent.expired())
-    {
-        FNENG_ASSERT_ERROR("TransformComponentが設定されていません");
-        return;
-    }
+    m_compTypeMask.reset();
 
-    // コンポーネントの更新
-    for (auto&& comp : m_spComponents)
+    for (UINT i = 0; i < m_spComponents.size(); ++i)
     {
-        if (!comp->IsEnable()) { continue; }
+        const ComponentTypeID::IDType typeID = m_spComponents[i]->GetComponentTypeID();
+
+        // 上限を超えた型IDは FindComponentSlot で走査して探す
+        if (typeID >= ComponentTypeID::MaxTypeNum) { continue; }
 
-        comp->UpdateWorldTransform();
+        // 同じ型がある場合は先に見つかった方を優先する
+        if (m_compTypeMask.test(typeID)) { continue; }
+
+        m_compTypeMask.set(typeID);
+        m_compSlots[typeID] = static_cast<UINT16>(i);
     }
 }
 
+void GameObject::MarkTickListDirty()
+{
+    m_pScene->MarkTickListDirty();
+}
+
+void GameObject::DeferDestroyComponent(std::shared_ptr<BaseComponent>&& spComp)
+{
+    m_pScene->DeferDestroyComponent(std::move(spComp));
+}
+
 void GameObject::Release()
 {
     for (auto& comp : m_spComponents)
@@ -5,6 +5,7 @@ class TransformComponent;
 class ModelComponent;
 
 #include "../Component/BaseComponent.h"
+#include "../Component/ComponentPool.h"
 
 /**
 * @class GameObject
@@ -13,6 +14,9 @@ class ModelComponent;
 class GameObject final
     : public std::enable_shared_from_this<GameObject>
 {
+    // ハンドルの設定は Scene::AddObject でのみ行う
+    friend class Scene;
+
 public:
     // 状態管理用
     enum class State
@@ -37,6 +41,7 @@ public:
     GameObject(const std::shared_ptr<Scene>& baseScene, State eState)
         : m_state(eState)
         , m_wpScene(baseScene)
+        , m_pScene(baseScene.get())
     {
     }
 
@@ -81,9 +86,9 @@ public:
         }
 
         // 再帰的に子オブジェクトに対して状態を伝播
-        for (auto&& wpChild : m_wpChildren)
+        for (const GameObjectHandle& hChild : m_children)
         {
-            const std::shared_ptr<GameObject>& spChild = wpChild.lock();
+            const std::shared_ptr<GameObject> spChild = ResolveObject(hChild);
 
             if (!spChild) { continue; }
 
@@ -98,9 +103,9 @@ public:
         SetState(_state);
 
         // 再帰的に子オブジェクトに対して状態を伝播
-        for (auto&& wpChild : m_wpChildren)
+        for (const GameObjectHandle& hChild : m_children)
         {
-            const std::shared_ptr<GameObject>& spChild = wpChild.lock();
+            const std::shared_ptr<GameObject> spChild = ResolveObject(hChild);
 
             if (!spChild) { continue; }
 
@@ -111,7 +116,7 @@ public:
 
     // オブジェクトの名前の設定 / 取得
     void SetName(const std::string& name) { m_objName = name; }
-    std::string GetName() const { return m_objName; }
+    const std::string& GetName() const { return m_objName; }
 
     // 親オブジェクトの設定 / 取得
     const std::string& GetParentName() { return m_parentName; }
@@ -119,6 +124,41 @@ public:
 
     std::shared_ptr<Scene> GetScene() const { return m_wpScene.lock(); }
 
+    /* @brief 所属するシーンの生ポインタ取得 : シーンがオブジェクトを所有しているため、オブジェクトが有効な間は常に有効 */
+    Scene* GetScenePtr() const { return m_pScene; }
+
+    /* @brief シーン内で自身を指すハンドルの取得 */
+    const GameObjectHandle& GetHandle() const { return m_handle; }
+
+    /**
+    * @brief 所属するシーンでハンドルを解決する
+    * @param[in] handle - 解決したいハンドル
+    * @return ハンドルが指すオブジェクト : 無効なハンドルの場合は空のポインタ
+    */
+    std::shared_ptr<GameObject> ResolveObject(const GameObjectHandle& handle) const;
+
+    /**
+    * @brief 所属するシーンでハンドルを解決する : 参照カウントを操作しないので毎フレームの処理ではこちらを使う
+    * @param[in] handle - 解決したいハンドル
+    * @return ハンドルが指すオブジェクト : 無効なハンドルの場合は nullptr
+    */
+    GameObject* ResolveObjectPtr(const GameObjectHandle& handle) const;
+
+    /**
+    * @brief 所属するシーンでコンポーネントのハンドルを解決する
+    * @param[in] handle - 解決したいハンドル
+    * @return ハンドルが指すコンポーネント : 無効なハンドルの場合は nullptr
+    */
+    template <typename CompType>
+    CompType* ResolveComponent(const ComponentHandle<CompType>& handle) const
+    {
+        const GameObject* pOwner = ResolveObjectPtr(handle.Owner);
+
+        if (!pOwner) { return nullptr; }
+
+        return pOwner->GetComponentPtr<CompType>();
+    }
+
     /**
     * @brief コンポーネントのコンテナを取得する
     * @return コンポーネントのコンテナ
@@ -135,11 +175,24 @@ public:
     // 親子関係
     //--------------------------------
     // 親オブジェクトの設定 / 取得
-    std::shared_ptr<GameObject> GetParent() const { return m_wpParent.lock(); }
+    std::shared_ptr<GameObject> GetParent() const { return ResolveObject(m_parent); }
+    GameObject* GetParentPtr() const { return ResolveObjectPtr(m_parent); }
+    const GameObjectHandle& GetParentHandle() const { return m_parent; }
+
+    void ClearChildren()
+    {
+        for (const GameObjectHandle& hChild : m_children)
+        {
+            if (GameObject* pChild = ResolveObjectPtr(hChild))
+            {
+                pChild->m_indexInParent = InvalidChildIndex;
+            }
+        }
 
-    void ClearChildren() { m_wpChildren.clear(); }
-    // 子オブジェクトの追加 / 取得
-    const std::list<std::weak_ptr<GameObject>>& GetChildren() const { return m_wpChildren; }
+        m_children.clear();
+    }
+    // 子オブジェクトの追加 / 取得 : 子どもは ResolveObject で解決する
+    const std::vector<GameObjectHandle>& GetChildren() const { return m_children; }
 
     /**
      * @fn void AddChild(const std::shared_ptr<BaseObject>& child)
@@ -153,12 +206,16 @@ public:
      * @brief 親子関係を解消する関数
      * @details
      *  - 親側からでも子側からでも呼び出せる
-     *      - 親側 : 子供のリストの中から for で回して、自分を見つけたら削除する
-     *      - 子側 : 親の子供リストから削除し、ポインタをリセットする
-     * @param initiator : 親子関係を解除するオブジェクト
-     * @return 削除した子オブジェクトの次のイテレータ
+     *      - 子供が保持している親のリストでの位置から直接削除するので、リストの走査は行わない
+     *      - 末尾の子供を空いた位置に移して詰めるため、子供の並び順は保たれない
+     *  - 通常は子供のワールド座標が変わらないようにローカル座標を設定し直す
+     *      - 破棄するオブジェクトは座標を保つ必要がないので、isKeepWorldPos に false を渡して行列の計算を省く
+     * @param initiator      : 親子関係を解除するオブジェクト
+     * @param isKeepWorldPos : 子供のワールド座標を保つか
+     * @return 削除した位置のイテレータ : 末尾から移した子供を指すので、そのまま走査を続けられる
      */
-    std::list<std::weak_ptr<GameObject>>::iterator  RemoveParentChildRelation(const std::shared_ptr<GameObject>& initiator);
+    std::vector<GameObjectHandle>::iterator RemoveParentChildRelation(const std::shared_ptr<GameObject>& initiator,
+                                                                      bool isKeepWorldPos = true);
 
     //--------------------------------
     // その他関数
@@ -166,11 +223,13 @@ public:
     /* @brief 初期化 */
     void Init();
 
-    /* @brief 開始 */
+    /* @brief 開始 : Start が済んでいないコンポーネントがある場合のみ走査する */
     void Start();
 
-    /* @brief 更新 */
-    void Update();
+    /* @brief すべてのコンポーネントの Start のフラグを下げる : 次の Start でもう一度呼ばれる */
+    void DownStartFlg();
+
+    // 更新はオブジェクトごとには行わず、Scene がフェーズごとにコンポーネントをまとめて更新する
 
     /* @brief ImGui更新 */
     void ImGuiUpdate();
@@ -186,13 +245,42 @@ public:
     template <typename CompType>
     std::shared_ptr<CompType> AddComponent(bool _enableSelia = false)
     {
-        // コンポーネントの生成
-        std::shared_ptr<CompType> spComp =
-            std::make_shared<CompType>(shared_from_this(), typeid(CompType).name(), _enableSelia);
+        // コンポーネントの生成 : 登録された型はシーンのプールから確保し、同じ型同士を連続したメモリに並べる
+        std::shared_ptr<CompType> spComp;
+
+        const ComponentTypeID::IDType compTypeID = ComponentTypeID::Get<CompType>();
+
+        if (m_spPoolArena && ComponentPool::IsRegistered(compTypeID))
+        {
+            spComp = std::allocate_shared<CompType>(
+                utl::PoolAllocator<CompType>(m_spPoolArena, compTypeID),
+                shared_from_this(), typeid(CompType).name(), _enableSelia);
+        }
+        else
+        {
+            spComp = std::make_shared<CompType>(shared_from_this(), typeid(CompType).name(), _enableSelia);
+        }
+
+        // 型IDを設定しておく : GetComponent / HasComponent の検索に利用する
+        spComp->m_typeID = compTypeID;
 
         // 初期化をしておく
         spComp->Awake();
 
+        // 並列更新の判定に毎フレーム使うので、宣言を取得しておく
+        spComp->m_updateAccess = spComp->DeclareUpdateAccess();
+
+        // オーバーライドしているフェーズだけ、シーンの更新の配列に並べる
+        spComp->m_tickMask = ComponentTick::Detect<CompType>();
+
+        // 並列更新フェーズは行列の確定後に行うため、TransformComponent へ書き込むコンポーネントは並列にできない
+        if (spComp->m_updateAccess.IsParallel &&
+            spComp->m_updateAccess.WriteMask.test(ComponentTypeID::Get<TransformComponent>()))
+        {
+            FNENG_ASSERT_ERROR("TransformComponent へ書き込むコンポーネントは並列に更新できません");
+            spComp->m_updateAccess.IsParallel = false;
+        }
+
         // 以前に追加されたコンポーネントの更新順が早い場合のソートを行う
         auto it = m_spComponents.begin();
         UINT myOrder = static_cast<UINT>(spComp->GetUpdateOrder());
@@ -203,6 +291,13 @@ public:
 
         m_spComponents.insert(it, spComp);
 
+        // 挿入位置より後ろの添え字がずれるので索引を作り直す
+        RebuildComponentIndex();
+
+        // 次のフレームから Start と更新の対象にする
+        m_hasUnstartedComp = true;
+        MarkTickListDirty();
+
         return spComp;
     }
 
@@ -215,52 +310,55 @@ public:
     template <typename CompType>
     std::shared_ptr<CompType> GetComponent(bool assertLog = true, std::source_location _locate = std::source_location::current())
     {
-        std::shared_ptr<BaseComponent> spBaseComp = nullptr;
-
-        const std::string& compName = typeid(CompType).name();
+        const ComponentTypeID::IDType typeID = ComponentTypeID::Get<CompType>();
 
-        for (auto&& comp : m_spComponents)
-        {
-            // 型名が一致したらダウンキャスト用に値を保存する
-            if (comp->GetComponentName() == compName)
-            {
-                spBaseComp = comp;
-                break;
-            }
-        }
+        const size_t slot = FindComponentSlot(typeID);
 
         // 見つからなければ警告
-        if (!spBaseComp)
+        if (slot == InvalidComponentSlot)
         {
             if (assertLog)
             {
+                const std::string& compName = typeid(CompType).name();
                 Assert::WarningLog("指定したコンポーネント(" + compName + ")は存在しません", false, _locate);
             }
             return nullptr;
         }
 
-        // ダウンキャストして返す
-        std::shared_ptr<CompType> spComp = std::dynamic_pointer_cast<CompType>(spBaseComp);
+        // 型IDが一致しているので、ダウンキャストは static_pointer_cast で行える
+        return std::static_pointer_cast<CompType>(m_spComponents[slot]);
+    }
 
-        return spComp;
+    template <typename CompType>
+    bool HasComponent() const
+    {
+        return FindComponentSlot(ComponentTypeID::Get<CompType>()) != InvalidComponentSlot;
     }
 
+    /**
+    * @brief コンポーネントの生ポインタ取得 : 参照カウントを操作せず、見つからなくても警告を出さない
+    * @return 取得したいコンポーネントのポインタ : 見つからなければ nullptr
+    */
     template <typename CompType>
-    bool HasComponent()
+    CompType* GetComponentPtr() const
     {
-        const std::string& compName = typeid(CompType).name();
+        const size_t slot = FindComponentSlot(ComponentTypeID::Get<CompType>());
 
-        for (auto&& comp : m_spComponents)
-        {
-            // 探しているコンポーネントの名前が一致 = 見つかったのでtrueを返す
-            if (comp->GetComponentName() == compName)
-            {
-                return true;
-            }
-        }
+        if (slot == InvalidComponentSlot) { return nullptr; }
+
+        return static_cast<CompType*>(m_spComponents[slot].get());
+    }
+
+    /**
+    * @brief コンポーネントを参照するハンドルの取得
+    * @return コンポーネントのハンドル : コンポーネントがなければ空のハンドル
+    */
+    template <typename CompType>
+    ComponentHandle<CompType> GetComponentHandle() const
+    {
+        if (!HasComponent<CompType>()) { return {}; }
 
-        // 見つからなかった
-        return false;
+        return ComponentHandle<CompType>{ m_handle };
     }
 
     /**
@@ -290,7 +388,11 @@ public:
         {
             if ((*it)->GetComponentName() == removeCompName)
             {
+                (*it)->m_isRemoved = true;
                 (*it)->Release();
+
+                // 更新の途中で外されても配列のポインタが残っているので、破棄はフレームの終わりまで遅らせる
+                DeferDestroyComponent(std::move(*it));
                 it = m_spComponents.erase(it);
             }
             else
@@ -298,6 +400,12 @@ public:
                 ++it;
             }
         }
+
+        // 添え字がずれるので索引を作り直す
+        RebuildComponentIndex();
+
+        // 削除したコンポーネントをシーンの更新の配列から外す
+        MarkTickListDirty();
     }
 
 protected:
@@ -312,15 +420,35 @@ protected:
     // 各コンポーネントのポインタを格納するコンテナ
     std::vector<std::shared_ptr<BaseComponent>> m_spComponents;
 
+    // コンポーネントの索引 : 型IDごとに保持しているかどうか / m_spComponents の添え字
+    // - 同じ型が複数ある場合は m_spComponents の先頭側のものを指す
+    // - MaxTypeNum 以上の型IDは索引に入らないので、FindComponentSlot で m_spComponents を走査する
+    std::bitset<ComponentTypeID::MaxTypeNum> m_compTypeMask;
+    std::array<UINT16, ComponentTypeID::MaxTypeNum> m_compSlots = {};
+
     std::weak_ptr<TransformComponent> m_spTransformComponent;
 
     // シーンのポインタ
     std::weak_ptr<Scene> m_wpScene;
+    Scene* m_pScene = nullptr;
 
-    // 親子関係
-    std::weak_ptr<GameObject> m_wpParent;
+    // コンポーネントを確保するシーンのプール : Scene::AddObject で設定される
+    std::shared_ptr<utl::PoolArena> m_spPoolArena;
+
+    // シーン内で自身を指すハンドル
+    GameObjectHandle m_handle;
+
+    // 親子関係 : ハンドルで保持し、参照時に ResolveObject で解決する
+    GameObjectHandle m_parent;
     std::string m_parentName;
-    std::list<std::weak_ptr<GameObject>> m_wpChildren;
+    std::vector<GameObjectHandle> m_children;
+
+    // 親の m_children の中での自分の位置 : 親子関係の解消時に走査せずに削除するために使う
+    static constexpr UINT32 InvalidChildIndex = UINT32_MAX;
+    UINT32 m_indexInParent = InvalidChildIndex;
+
+    /* @brief m_children から指定した位置の子供を外す : 末尾の子供を移して詰める @return 外した位置のイテレータ */
+    std::vector<GameObjectHandle>::iterator EraseChildAt(size_t index);
 
     // ImGuiで利用する子ども追加用の名前
     std::string m_imguiSerchChildName;
@@ -337,10 +465,41 @@ private:
     void ComponentImGuiUpdate();
 
     //----------------
-    // 更新
+    // コンポーネント索引
     //----------------
-    // ワールド行列の更新
-    void UpdateWorldTransform();
+    static constexpr size_t InvalidComponentSlot = SIZE_MAX;
+
+    /**
+    * @brief 型IDのコンポーネントの m_spComponents の添え字
+    * @param typeID - 調べたい型ID
+    * @return 添え字 : 保持していなければ InvalidComponentSlot
+    */
+    size_t FindComponentSlot(ComponentTypeID::IDType typeID) const
+    {
+        if (typeID < ComponentTypeID::MaxTypeNum)
+        {
+            return m_compTypeMask.test(typeID) ? m_compSlots[typeID] : InvalidComponentSlot;
+        }
+
+        // 型の数が上限を超えた分は索引に入らないので、先頭から探す
+        for (size_t i = 0; i < m_spComponents.size(); ++i)
+        {
+            if (m_spComponents[i]->GetComponentTypeID() == typeID) { return i; }
+        }
+        return InvalidComponentSlot;
+    }
+
+    /* @brief m_spComponents の並びから索引を作り直す : 追加 / 削除時のみ呼び出す */
+    void RebuildComponentIndex();
+
+    /* @brief コンポーネントの構成が変わったので、シーンの更新の配列を作り直させる */
+    void MarkTickListDirty();
+
+    /* @brief 外したコンポーネントをシーンの破棄待ちのリストへ移す */
+    void DeferDestroyComponent(std::shared_ptr<BaseComponent>&& spComp);
+
+    // Start が済んでいないコンポーネントがあるか : 追加時と DownStartFlg で立てる
+    bool m_hasUnstartedComp = false;
 };
 
 namespace jsonKey::Object
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+class GameObject;
+
+/**
+* @brief ゲームオブジェクトを参照するためのハンドル
+* @details
+*   - Scene が持つ SlotMap のスロット番号と世代番号の組
+*   - weak_ptr と違い参照カウントの操作がないため、毎フレーム解決しても安価
+*   - 解決は Scene::ResolveObject / GameObject::ResolveObject で行う
+*   - シリアライズは今まで通りオブジェクトの名前で行う
+*/
+using GameObjectHandle = utl::SlotHandle<GameObject>;
+
+/**
+* @struct ComponentHandle
+* @brief コンポーネントを参照するためのハンドル
+* @details
+*   オーナーオブジェクトのハンドルと型IDの組で表す
+*   解決時はオーナーを解決した後、型IDの索引からコンポーネントを取得する
+*
+* @tparam CompType - 参照するコンポーネントの型
+*/
+template <typename CompType>
+struct ComponentHandle
+{
+    GameObjectHandle Owner;
+
+    /* @brief 何も指していないハンドルかどうか */
+    bool IsNull() const { return Owner.IsNull(); }
+
+    /* @brief 何も指していない状態にする */
+    void Reset() { Owner.Reset(); }
+
+    bool operator==(const ComponentHandle&) const = default;
+};
@@ -0,0 +1,522 @@
+﻿#include "CullingSystem.h"
+
+CullingSystem::Handle CullingSystem::Register(const std::weak_ptr<GameObject>& wpOwner, bool canBeStaticCaster)
+{
+    // 解除された番号があれば使い回す
+    Handle handle = 0;
+    if (!m_freeHandles.empty())
+    {
+        handle = m_freeHandles.back();
+        m_freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(m_entries.size());
+        m_entries.emplace_back();
+    }
+
+    // 木には最初の SetBounds で入れる
+    m_entries[handle] = Entry{};
+    m_entries[handle].wpOwner = wpOwner;
+    m_entries[handle].CanBeStaticCaster = canBeStaticCaster;
+
+    return handle;
+}
+
+void CullingSystem::Unregister(Handle handle)
+{
+    if (handle >= m_entries.size()) { return; }
+
+    Entry& entry = m_entries[handle];
+    DemoteStaticCaster(entry);
+
+    if (entry.ProxyID != DynamicAABBTree::NullNode)
+    {
+        m_tree.DestroyProxy(entry.ProxyID);
+        ++m_treeUpdateNum;
+    }
+
+    entry = Entry{};
+    m_freeHandles.push_back(handle);
+}
+
+void CullingSystem::SetBounds(Handle handle, const AABB<Math::Vector3>& aabb)
+{
+    if (handle >= m_entries.size()) { return; }
+
+    Entry& entry = m_entries[handle];
+
+    // 動いたので動くモデルに戻し、もう一度止まってから数え直す
+    DemoteStaticCaster(entry);
+    entry.StillFrameNum = 0;
+
+    entry.Bounds = ToTreeBox(aabb);
+
+    // 描画メッシュがなく AABB が作られていない場合は、木から外して見えない扱いにする
+    const bool isValid = entry.Bounds.Min.x <= entry.Bounds.Max.x &&
+                         entry.Bounds.Min.y <= entry.Bounds.Max.y &&
+                         entry.Bounds.Min.z <= entry.Bounds.Max.z;
+    if (!isValid)
+    {
+        if (entry.ProxyID != DynamicAABBTree::NullNode)
+        {
+            m_tree.DestroyProxy(entry.ProxyID);
+            entry.ProxyID = DynamicAABBTree::NullNode;
+            ++m_treeUpdateNum;
+        }
+        return;
+    }
+
+    if (entry.ProxyID == DynamicAABBTree::NullNode)
+    {
+        entry.ProxyID = m_tree.CreateProxy(entry.Bounds, handle);
+        ++m_treeUpdateNum;
+        return;
+    }
+
+    if (m_tree.MoveProxy(entry.ProxyID, entry.Bounds))
+    {
+        ++m_treeUpdateNum;
+    }
+}
+
+void CullingSystem::SetOccluder(Handle handle, const std::shared_ptr<const ModelData>& spModel)
+{
+    if (handle >= m_entries.size()) { return; }
+
+    Entry& entry = m_entries[handle];
+    entry.spOccluder.reset();
+    entry.OccluderFaceNum = 0;
+
+    if (!spModel) { return; }
+
+    // 描画と同じく、メッシュの座標はモデル空間として扱う
+    UINT32 faceNum = 0;
+    for (int nodeIdx : spModel->GetCollisionMeshNodeIdxLists())
+    {
+        const std::shared_ptr<Mesh>& spMesh = spModel->GetNodes()[nodeIdx].spMesh;
+        if (!spMesh) { continue; }
+
+        faceNum += static_cast<UINT32>(spMesh->GetFaces().size());
+    }
+
+    // 細かいメッシュは描く手間の割に隠す量が変わらないので、遮蔽物にしない
+    if (faceNum == 0 || faceNum > MaxOccluderFaceNum) { return; }
+
+    entry.spOccluder = spModel;
+    entry.OccluderFaceNum = faceNum;
+}
+
+void CullingSystem::SetOccluderMatrix(Handle handle, const Math::Matrix& mWorld)
+{
+    if (!IsOccluder(handle)) { return; }
+
+    m_entries[handle].mOccluderWorld = mWorld;
+}
+
+void CullingSystem::ResetStaticCaster(Handle handle)
+{
+    if (handle >= m_entries.size()) { return; }
+
+    Entry& entry = m_entries[handle];
+    DemoteStaticCaster(entry);
+    entry.StillFrameNum = 0;
+}
+
+void CullingSystem::DemoteStaticCaster(Entry& entry)
+{
+    if (!entry.IsStaticCaster) { return; }
+
+    // キャッシュに残っている影を消すため、描いた時のボックスの範囲を描き直す
+    m_staticDirtyBoxes.push_back(entry.Bounds);
+
+    entry.IsStaticCaster = false;
+    --m_staticCasterNum;
+}
+
+void CullingSystem::UpdateStaticCasters()
+{
+    for (Entry& entry : m_entries)
+    {
+        if (!entry.CanBeStaticCaster || entry.IsStaticCaster || entry.ProxyID == DynamicAABBTree::NullNode) { continue; }
+
+        if (++entry.StillFrameNum < StaticCasterFrameNum) { continue; }
+
+        // 止まったモデルの影をキャッシュに描くため、ボックスの範囲を描き直す
+        m_staticDirtyBoxes.push_back(entry.Bounds);
+
+        entry.IsStaticCaster = true;
+        ++m_staticCasterNum;
+    }
+
+    // カスケードが作れなかった場合は、シャドウマップの側ですべて描き直す扱いになっている
+    const std::unique_ptr<Shadow>& upShadow = ShaderManager::Instance().WorkShadowShader();
+    if (m_hasCascades)
+    {
+        for (const DynamicAABBTree::Box& box : m_staticDirtyBoxes)
+        {
+            upShadow->InvalidateStaticCache(box.Min, box.Max);
+        }
+    }
+    m_staticDirtyBoxes.clear();
+
+    m_staticShadowDirtyMask = upShadow ? upShadow->GetStaticCache().GetDirtyMask() : 0;
+}
+
+void CullingSystem::Execute()
+{
+    m_lastVisibleNum = 0;
+    m_lastVisitNodeNum = 0;
+    m_lastLeafTestNum = 0;
+
+    m_lastTreeUpdateNum = m_treeUpdateNum;
+    m_treeUpdateNum = 0;
+
+    m_lastShadowRequestNum = m_shadowRequestNum.exchange(0, std::memory_order_relaxed);
+    m_lastShadowDrawNum = m_shadowDrawNum.exchange(0, std::memory_order_relaxed);
+
+    m_lastOccluderNum = 0;
+    m_lastOccluderTriangleNum = 0;
+    m_lastOcclusionTestNum = 0;
+    m_lastOccludedNum = 0;
+
+    // カメラ情報がない場合はカリングしない
+    const std::shared_ptr<Camera> spCamera = ShaderManager::Instance().FindCameraData(RenderingData::MainCameraName);
+    m_hasFrustum = spCamera != nullptr;
+
+    // シェーダーの初期化前 (描画を行わないテストなど) はカスケードを作らない
+    const std::unique_ptr<Shadow>& upShadow = ShaderManager::Instance().WorkShadowShader();
+
+    if (!m_hasFrustum)
+    {
+        m_lodView = ModelLOD::View{};
+
+        // カスケードも作れないので、前回のカスケードで影を描画しないようにしておく
+        m_hasCascades = upShadow && upShadow->UpdateCascades(nullptr);
+        UpdateStaticCasters();
+        return;
+    }
+
+    // 視錐台の平面はカメラごとに1回だけ取り出す
+    const Math::Matrix mViewProj = spCamera->GetViewMat() * spCamera->GetProjMat();
+    m_planes = FrustumCulling::ExtractPlanes(mViewProj);
+    m_lodView = ModelLOD::CreateView(spCamera->GetPos(), spCamera->GetProjMat(), static_cast<float>(Screen::Height));
+
+    m_lastVisitNodeNum = CullView(m_planes, m_visibleBits, &m_lastLeafTestNum);
+
+    // 遮蔽の判定はワーカーに任せ、その間にカスケードごとの判定を進める
+    // どちらも木とボックスを読むだけで、書き込むビット配列は別なので同時に進めて良い
+    m_occludedBits.assign(m_visibleBits.size(), 0);
+
+    JobCounter occlusionCounter;
+    if (m_isOcclusionEnable)
+    {
+        JobSystem::Instance().Run([this, mViewProj]() { ExecuteOcclusion(mViewProj); }, &occlusionCounter);
+    }
+
+    // 影を落とすモデルは、カスケードの行列ごとに判定する : 描画でも同じ行列を使う
+    m_hasCascades = upShadow && upShadow->UpdateCascades(spCamera);
+    if (m_hasCascades)
+    {
+        const std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum>& cascades = upShadow->GetCascades();
+
+        for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+        {
+            m_cascadePlanes[cascadeIdx] = FrustumCulling::ExtractPlanes(cascades[cascadeIdx].mViewProj);
+            CullView(m_cascadePlanes[cascadeIdx], m_cascadeCasterBits[cascadeIdx]);
+        }
+    }
+
+    // 行列が変わったカスケードが決まってから、動かないモデルの影を描き直す範囲を伝える
+    UpdateStaticCasters();
+
+    JobSystem::Instance().Wait(occlusionCounter);
+
+    for (UINT32 bits : m_visibleBits)
+    {
+        m_lastVisibleNum += static_cast<UINT32>(std::bitset<FrustumCulling::BitWordSize>(bits).count());
+    }
+}
+
+void CullingSystem::ExecuteOcclusion(const Math::Matrix& mViewProj)
+{
+    //===============================
+    // 視錐台の中の遮蔽物を集める
+    //===============================
+    m_occluderHandles.clear();
+    m_occluderTriangleStarts.clear();
+
+    UINT32 triangleNum = 0;
+    for (Handle handle = 0; handle < static_cast<Handle>(m_entries.size()); ++handle)
+    {
+        const Entry& entry = m_entries[handle];
+        if (!entry.spOccluder || !FrustumCulling::IsVisible(m_visibleBits.data(), handle)) { continue; }
+
+        // 上限を超える分は遮蔽物にしない : 隠れるモデルが減るだけで、見えているモデルは消えない
+        if (triangleNum + entry.OccluderFaceNum > MaxTotalOccluderFaceNum) { continue; }
+
+        m_occluderHandles.push_back(handle);
+        m_occluderTriangleStarts.push_back(triangleNum);
+        triangleNum += entry.OccluderFaceNum;
+    }
+
+    if (m_occluderHandles.empty()) { return; }
+
+    //===============================
+    // 三角形を作って深度バッファに描く
+    //===============================
+    m_occluderTriangles.resize(triangleNum);
+
+    std::atomic<UINT32> drawTriangleNum = 0;
+    JobSystem::Instance().ParallelFor(static_cast<UINT32>(m_occluderHandles.size()), 1,
+        [this, &mViewProj, &drawTriangleNum](UINT32 begin, UINT32 end)
+        {
+            UINT32 num = 0;
+            for (UINT32 i = begin; i < end; ++i)
+            {
+                num += SetupOccluderTriangles(m_entries[m_occluderHandles[i]], mViewProj,
+                    m_occluderTriangles.data() + m_occluderTriangleStarts[i]);
+            }
+            drawTriangleNum.fetch_add(num, std::memory_order_relaxed);
+        });
+
+    m_lastOccluderNum = static_cast<UINT32>(m_occluderHandles.size());
+    m_lastOccluderTriangleNum = drawTriangleNum.load(std::memory_order_relaxed);
+    m_lastOccludedNum = CullOccluded(mViewProj, m_occluderTriangles, m_visibleBits, m_occludedBits, &m_lastOcclusionTestNum);
+}
+
+UINT32 CullingSystem::CullOccluded(const Math::Matrix& mViewProj, std::span<const OcclusionCulling::ScreenTriangle> triangles,
+    std::vector<UINT32>& visibleBits, std::vector<UINT32>& occludedBits, UINT32* pTestNum)
+{
+    occludedBits.assign(visibleBits.size(), 0);
+
+    // 帯ごとに描く行が分かれているので、同じピクセルを別のスレッドが書き換えない
+    m_occlusionBuffer.SetViewProj(mViewProj);
+    JobSystem::Instance().ParallelFor(OcclusionCulling::BandNum, 1,
+        [this, triangles](UINT32 begin, UINT32 end)
+        {
+            for (UINT32 bandIdx = begin; bandIdx < end; ++bandIdx)
+            {
+                m_occlusionBuffer.RenderBand(bandIdx, triangles);
+            }
+        });
+
+    m_occlusionBuffer.BuildHiZ();
+
+    //===============================
+    // 視錐台の中のボックスを判定する
+    //===============================
+    // ビット配列の要素ごとに分けるので、同じ要素を別のスレッドが書き換えない
+    std::atomic<UINT32> testNum = 0;
+    std::atomic<UINT32> occludedNum = 0;
+    JobSystem::Instance().ParallelFor(static_cast<UINT32>(visibleBits.size()), OcclusionTestGrainSize,
+        [this, &visibleBits, &occludedBits, &testNum, &occludedNum](UINT32 begin, UINT32 end)
+        {
+            UINT32 localTestNum = 0;
+            UINT32 localOccludedNum = 0;
+
+            for (UINT32 wordIdx = begin; wordIdx < end; ++wordIdx)
+            {
+                UINT32 bits = visibleBits[wordIdx];
+                UINT32 wordOccludedBits = 0;
+                for (UINT32 remain = bits; remain != 0; remain &= remain - 1)
+                {
+                    const UINT32 bitIdx = static_cast<UINT32>(std::countr_zero(remain));
+                    const DynamicAABBTree::Box& bounds = m_entries[wordIdx * FrustumCulling::BitWordSize + bitIdx].Bounds;
+
+                    ++localTestNum;
+                    if (!m_occlusionBuffer.IsOccluded(bounds.GetCenter(), bounds.GetExtents())) { continue; }
+
+                    bits &= ~(1u << bitIdx);
+                    wordOccludedBits |= 1u << bitIdx;
+                    ++localOccludedNum;
+                }
+                visibleBits[wordIdx] = bits;
+                occludedBits[wordIdx] = wordOccludedBits;
+            }
+
+            testNum.fetch_add(localTestNum, std::memory_order_relaxed);
+            occludedNum.fetch_add(localOccludedNum, std::memory_order_relaxed);
+        });
+
+    if (pTestNum) { *pTestNum = testNum.load(std::memory_order_relaxed); }
+    return occludedNum.load(std::memory_order_relaxed);
+}
+
+UINT32 CullingSystem::SetupOccluderTriangles(const Entry& entry, const Math::Matrix& mViewProj, OcclusionCulling::ScreenTriangle* pDst)
+{
+    // 頂点は面ごとではなく1回だけ変換する : 作業用の配列はスレッドごとに使い回す
+    thread_local std::vector<Math::Vector4> clipPositions;
+
+    const Math::Matrix mWorldViewProj = entry.mOccluderWorld * mViewProj;
+    const std::vector<ModelData::Node>& nodes = entry.spOccluder->GetNodes();
+
+    UINT32 drawNum = 0;
+    for (int nodeIdx : entry.spOccluder->GetCollisionMeshNodeIdxLists())
+    {
+        const std::shared_ptr<Mesh>& spMesh = nodes[nodeIdx].spMesh;
+        if (!spMesh) { continue; }
+
+        const std::vector<Math::Vector3>& positions = spMesh->GetPositions();
+        clipPositions.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            clipPositions[i] = Math::Vector4::Transform(Math::Vector4(positions[i].x, positions[i].y, positions[i].z, 1.0f), mWorldViewProj);
+        }
+
+        for (const MeshFace& face : spMesh->GetFaces())
+        {
+            if (OcclusionCulling::SetupTriangle(clipPositions[face.Idx[0]], clipPositions[face.Idx[1]], clipPositions[face.Idx[2]], *pDst))
+            {
+                ++drawNum;
+            }
+            ++pDst;
+        }
+    }
+
+    return drawNum;
+}
+
+UINT32 CullingSystem::CullView(const FrustumCulling::Planes& planes, std::vector<UINT32>& visibleBits, UINT32* pLeafTestNum) const
+{
+    // 木に届かなかった番号は見えていない
+    visibleBits.assign((m_entries.size() + FrustumCulling::BitWordSize - 1) / FrustumCulling::BitWordSize, 0);
+
+    // 作業用の配列はスレッドごとに使い回す
+    thread_local LeafBatch batch;
+    batch.Handles.clear();
+
+    const UINT32 visitNum = m_tree.QueryFrustum(planes,
+        [&visibleBits](UINT32 handle, UINT32 planeMask)
+        {
+            // 太らせた AABB が一部だけ内側なら、元の AABB を後でまとめて判定し直す
+            if (planeMask != 0)
+            {
+                batch.Handles.push_back(handle);
+                return;
+            }
+
+            visibleBits[handle / FrustumCulling::BitWordSize] |= 1u << (handle % FrustumCulling::BitWordSize);
+        });
+
+    TestLeafBatch(planes, batch, visibleBits);
+
+    if (pLeafTestNum) { *pLeafTestNum = static_cast<UINT32>(batch.Handles.size()); }
+
+    return visitNum;
+}
+
+void CullingSystem::TestLeafBatch(const FrustumCulling::Planes& planes, LeafBatch& batch, std::vector<UINT32>& visibleBits) const
+{
+    const UINT32 leafNum = static_cast<UINT32>(batch.Handles.size());
+    if (leafNum == 0) { return; }
+
+    batch.Boxes.Resize(leafNum);
+    batch.Bits.resize(batch.Boxes.GetBitWordNum());
+
+    // ビット配列の要素ごとに分けるので、同じ要素を別のスレッドが書き換えない
+    JobSystem::Instance().ParallelFor(batch.Boxes.GetBitWordNum(), LeafTestGrainSize,
+        [this, &planes, &batch, leafNum](UINT32 beginWord, UINT32 endWord)
+        {
+            const UINT32 begin = beginWord * FrustumCulling::BitWordSize;
+            const UINT32 end = endWord * FrustumCulling::BitWordSize;
+
+            for (UINT32 i = begin; i < std::min(end, leafNum); ++i)
+            {
+                const DynamicAABBTree::Box& bounds = m_entries[batch.Handles[i]].Bounds;
+                batch.Boxes.Set(i, bounds.GetCenter(), bounds.GetExtents());
+            }
+
+            FrustumCulling::TestAABBs(planes, batch.Boxes, begin, end, batch.Bits.data());
+        });
+
+    // 見えていた葉の番号のビットを立てる : 別の葉が同じ要素に入るので、ここは1つのスレッドで行う
+    for (UINT32 wordIdx = 0; wordIdx < static_cast<UINT32>(batch.Bits.size()); ++wordIdx)
+    {
+        for (UINT32 remain = batch.Bits[wordIdx]; remain != 0; remain &= remain - 1)
+        {
+            const Handle handle = batch.Handles[wordIdx * FrustumCulling::BitWordSize + static_cast<UINT32>(std::countr_zero(remain))];
+            visibleBits[handle / FrustumCulling::BitWordSize] |= 1u << (handle % FrustumCulling::BitWordSize);
+        }
+    }
+}
+
+void CullingSystem::TestBoxes(const FrustumCulling::AABBArrays& boxes, std::vector<UINT32>& visibleBits) const
+{
+    visibleBits.resize(boxes.GetBitWordNum());
+
+    if (!m_hasFrustum)
+    {
+        std::fill(visibleBits.begin(), visibleBits.end(), ~0u);
+        return;
+    }
+
+    FrustumCulling::TestAABBs(m_planes, boxes, 0, boxes.GetPaddedNum(), visibleBits.data());
+}
+
+void CullingSystem::TestShadowBoxes(const FrustumCulling::AABBArrays& boxes,
+    std::array<std::vector<UINT32>, ShadowCascade::CascadeNum>& cascadeBits) const
+{
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        std::vector<UINT32>& visibleBits = cascadeBits[cascadeIdx];
+        visibleBits.resize(boxes.GetBitWordNum());
+
+        if (!m_hasCascades)
+        {
+            std::fill(visibleBits.begin(), visibleBits.end(), ~0u);
+            continue;
+        }
+
+        FrustumCulling::TestAABBs(m_cascadePlanes[cascadeIdx], boxes, 0, boxes.GetPaddedNum(), visibleBits.data());
+    }
+}
+
+void CullingSystem::QueryBox(const AABB<Math::Vector3>& aabb, std::vector<std::shared_ptr<GameObject>>& result) const
+{
+    const size_t resultBegin = result.size();
+    const DynamicAABBTree::Box box = ToTreeBox(aabb);
+
+    m_tree.QueryBox(box,
+        [this, &box, resultBegin, &result](UINT32 handle)
+        {
+            if (!m_entries[handle].Bounds.Intersects(box)) { return; }
+            AddQueryResult(handle, resultBegin, result);
+        });
+}
+
+void CullingSystem::QuerySphere(const Math::Vector3& center, float radius, std::vector<std::shared_ptr<GameObject>>& result) const
+{
+    const size_t resultBegin = result.size();
+
+    m_tree.QuerySphere(center, radius,
+        [this, &center, radius, resultBegin, &result](UINT32 handle)
+        {
+            if (!DynamicAABBTree::IntersectsSphere(m_entries[handle].Bounds, center, radius)) { return; }
+            AddQueryResult(handle, resultBegin, result);
+        });
+}
+
+void CullingSystem::QueryRay(const Math::Vector3& origin, const Math::Vector3& dir, float maxDist, std::vector<std::shared_ptr<GameObject>>& result) const
+{
+    const size_t resultBegin = result.size();
+    const Math::Vector3 invDir = { 1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z };
+
+    m_tree.QueryRay(origin, dir, maxDist,
+        [this, &origin, &invDir, maxDist, resultBegin, &result](UINT32 handle)
+        {
+            if (!DynamicAABBTree::IntersectsRay(m_entries[handle].Bounds, origin, invDir, maxDist)) { return; }
+            AddQueryResult(handle, resultBegin, result);
+        });
+}
+
+void CullingSystem::AddQueryResult(Handle handle, size_t resultBegin, std::vector<std::shared_ptr<GameObject>>& result) const
+{
+    std::shared_ptr<GameObject> spOwner = m_entries[handle].wpOwner.lock();
+    if (!spOwner) { return; }
+
+    // 1つのオブジェクトが複数のモデルを持つことがあるので、今回追加した分から重複を探す
+    if (std::find(result.begin() + resultBegin, result.end(), spOwner) != result.end()) { return; }
+
+    result.push_back(std::move(spOwner));
+}
@@ -0,0 +1,367 @@
+﻿#pragma once
+
+class GameObject;
+
+/**
+* @class CullingSystem
+* @brief 描画するモデルの空間分割と視錐台カリングを、1フレームに1回まとめて行うクラス
+* @details
+*   - ModelComponent は Register で番号を受け取り、ワールド空間の AABB が動いた時だけ SetBounds で書き込む
+*   - ボックスは DynamicAABBTree に登録し、少しの移動では木を変更しない
+*   - Execute でメインカメラの視錐台の平面を1回だけ取り出し、木をたどって判定する
+*     視錐台の外の節は子をたどらず、完全に内側の節は子を判定しないので、画面外のモデルが多いほど速くなる
+*     平面にかかった葉は木をたどる間には判定せずに集めておき、最後に FrustumCulling::TestAABBs でまとめて判定する
+*     集めた葉はビット配列の要素の境目で分けて、JobSystem のワーカーで判定する
+*   - 判定結果は 1bit = 1モデルのビット配列に書き込み、ModelComponent::Update は IsVisible でビットを読むだけ
+*   - 影を落とすモデルは、カスケードシャドウマップのカスケードごとに同じ木で判定する
+*     カスケードの行列はライト側に広げてあるので、視界の外からでも視界の中に影を落とすモデルは残る
+*   - 動かないモデルの影はシャドウマップのキャッシュに描いておく
+*     StaticCasterFrameNum フレームの間ボックスが動かなかったモデルを動かないモデルとして扱い、動いたら動くモデルに戻す
+*     動かないモデルが増えた / 動いた / 消えた時は、そのボックスに重なるカスケードのキャッシュだけを描き直す
+*   - その他の視点は CullView で同じ木を使って判定できる
+*   - ゲーム側からはボックス / 球 / レイでモデルを持つオブジェクトを検索できる
+*   - 海藻のように1つのコンポーネントが多数のインスタンスを持つ場合は、TestBoxes で同じ平面を使ってまとめて判定する
+*   - LOD を選ぶカメラも Execute で1回だけ作り、並列更新中は GetLODView で読むだけにする
+*   - 遮蔽物(コリジョンメッシュ)を登録したモデルは、OcclusionCulling の小さな深度バッファに描いて隠れたモデルを外す
+*     視錐台カリングの後にワーカーで描いて判定し、その間にメインスレッドでカスケードごとの判定を進める
+*     遮蔽物の三角形を直接渡して、CullOccluded で同じ判定だけを行うこともできる
+*/
+class CullingSystem
+    : public utl::Singleton<CullingSystem>
+{
+    friend class utl::Singleton<CullingSystem>;
+
+public:
+    using Handle = UINT32;
+    static constexpr Handle InvalidHandle = std::numeric_limits<Handle>::max();
+
+    // このフレーム数の間ボックスが動かなければ、影をキャッシュに描く動かないモデルにする
+    static constexpr UINT32 StaticCasterFrameNum = 60;
+
+    // 1つのモデルの遮蔽物の三角形の上限 : これより多いメッシュは遮蔽物にしない
+    static constexpr UINT32 MaxOccluderFaceNum = 1024;
+
+    // 1フレームに描く遮蔽物の三角形の上限 : 超えた分のモデルは遮蔽物にしない
+    static constexpr UINT32 MaxTotalOccluderFaceNum = 16384;
+
+    // 遮蔽の判定で1つのジョブが受け持つ、ビット配列の要素数
+    static constexpr UINT32 OcclusionTestGrainSize = 4;
+
+    // 平面にかかった葉の判定で1つのジョブが受け持つ、ビット配列の要素数
+    static constexpr UINT32 LeafTestGrainSize = 16;
+
+    //--------------------------------
+    // 登録
+    //--------------------------------
+    /**
+    * @brief 判定するボックスの登録 : メインスレッドから呼ぶ
+    * @param[in] wpOwner            - 検索結果として返すオブジェクト
+    * @param[in] canBeStaticCaster  - 動かない間は影をキャッシュに描いて良いか : ボックスが変わらなくても形が変わるモデルは false
+    */
+    Handle Register(const std::weak_ptr<GameObject>& wpOwner, bool canBeStaticCaster = false);
+
+    /* @brief 登録の解除 : 解除した番号は次の Register で使い回す */
+    void Unregister(Handle handle);
+
+    /* @brief ワールド空間の AABB の設定 : 木に入っていなければここで入れる */
+    void SetBounds(Handle handle, const AABB<Math::Vector3>& aabb);
+
+    /* @brief 動かないモデルから動くモデルに戻す : 描画タイプを変えた場合など、キャッシュの影を描き直す時に呼ぶ */
+    void ResetStaticCaster(Handle handle);
+
+    /**
+    * @brief 遮蔽物の設定 : コリジョンメッシュを深度バッファに描いて、後ろのモデルを隠す
+    * @param[in] spModel - コリジョンメッシュを持つモデル : nullptr なら遮蔽物にしない
+    * @details 三角形が MaxOccluderFaceNum より多い場合は遮蔽物にしない
+    */
+    void SetOccluder(Handle handle, const std::shared_ptr<const ModelData>& spModel);
+
+    /* @brief 遮蔽物のワールド行列の設定 : 遮蔽物でなければ何もしない */
+    void SetOccluderMatrix(Handle handle, const Math::Matrix& mWorld);
+
+    /* @brief 遮蔽物として登録されているか */
+    bool IsOccluder(Handle handle) const
+    {
+        return handle < m_entries.size() && m_entries[handle].spOccluder != nullptr;
+    }
+
+    /* @brief 遮蔽による判定を行うか : デバッグ表示で切り替えて効果を比べる */
+    void SetOcclusionEnable(bool enable) { m_isOcclusionEnable = enable; }
+    bool IsOcclusionEnable() const { return m_isOcclusionEnable; }
+
+    /* @brief 影をキャッシュに描く動かないモデルか */
+    bool IsStaticShadowCaster(Handle handle) const
+    {
+        return handle < m_entries.size() && m_entries[handle].IsStaticCaster;
+    }
+
+    /* @brief 前回の Execute で、動かないモデルの影を描き直すと決まったカスケード : 1bit = 1カスケード */
+    UINT32 GetStaticShadowDirtyMask() const { return m_staticShadowDirtyMask; }
+
+    //--------------------------------
+    // 判定
+    //--------------------------------
+    /**
+    * @brief メインカメラから見えるボックスを判定する
+    * @details 並列更新の前に、メインスレッドから1フレームに1回呼ぶ : メインカメラがなければすべて見えている扱いにする
+    */
+    void Execute();
+
+    /* @brief 前回の Execute で見えていたか : 視錐台の外か遮蔽物に隠れていれば false / 未登録の番号は見えている扱いにする */
+    bool IsVisible(Handle handle) const
+    {
+        // Execute の後に登録された番号は、まだ判定していない
+        if (!m_hasFrustum || handle / FrustumCulling::BitWordSize >= m_visibleBits.size()) { return true; }
+
+        return FrustumCulling::IsVisible(m_visibleBits.data(), handle);
+    }
+
+    /**
+    * @brief 前回の Execute で、視錐台の中にあるが遮蔽物に隠れていたか
+    * @details 隠れていても視界の中に影を落とすことがあるので、影は描画する
+    */
+    bool IsOccluded(Handle handle) const
+    {
+        if (!m_hasFrustum || handle / FrustumCulling::BitWordSize >= m_occludedBits.size()) { return false; }
+
+        return FrustumCulling::IsVisible(m_occludedBits.data(), handle);
+    }
+
+    /**
+    * @brief 前回の Execute で、影を描画するカスケードを取得する
+    * @return 1bit = 1カスケード : 未登録の番号はすべてのカスケードに描画する扱いにする
+    */
+    UINT32 GetShadowCascadeMask(Handle handle) const
+    {
+        if (!m_hasCascades || handle / FrustumCulling::BitWordSize >= m_cascadeCasterBits[0].size()) { return ShadowCascade::AllCascadeMask; }
+
+        UINT32 mask = 0;
+        for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+        {
+            if (FrustumCulling::IsVisible(m_cascadeCasterBits[cascadeIdx].data(), handle))
+            {
+                mask |= 1u << cascadeIdx;
+            }
+        }
+
+        return mask;
+    }
+
+    /**
+    * @brief 任意の視錐台から見えるボックスを判定する
+    * @param[in]  planes      - 視錐台の平面
+    * @param[out] visibleBits  - 判定結果 : 番号ごとに FrustumCulling::IsVisible で取り出す
+    * @param[out] pLeafTestNum - 平面にかかっていて、まとめて判定した葉の数 : nullptr なら数えない
+    * @return 判定した木の節の数
+    */
+    UINT32 CullView(const FrustumCulling::Planes& planes, std::vector<UINT32>& visibleBits, UINT32* pLeafTestNum = nullptr) const;
+
+    /**
+    * @brief 前回の Execute と同じ視錐台で、ボックスの配列をまとめて判定する
+    * @param[in]  boxes       - 判定するボックス
+    * @param[out] visibleBits - 判定結果 : FrustumCulling::IsVisible で取り出す
+    * @details ワーカースレッドからも呼べる : メインカメラがなければすべて見えている扱いにする
+    */
+    void TestBoxes(const FrustumCulling::AABBArrays& boxes, std::vector<UINT32>& visibleBits) const;
+
+    /**
+    * @brief 三角形を遮蔽物の深度バッファに描き、見えているボックスのうち隠れたものを外す
+    * @param[in]     mViewProj     - 三角形を作ったカメラ
+    * @param[in]     triangles     - OcclusionCulling::SetupTriangle で作った三角形
+    * @param[in,out] visibleBits   - CullView の判定結果 : 隠れていたボックスのビットを落とす
+    * @param[out]    occludedBits  - 隠れていたボックス : visibleBits と同じ並び
+    * @param[out]    pTestNum      - 判定したボックスの数 : nullptr なら数えない
+    * @return 隠れていたボックスの数
+    * @details 深度バッファは Execute と共用なので、Execute と同時には呼ばない
+    */
+    UINT32 CullOccluded(const Math::Matrix& mViewProj, std::span<const OcclusionCulling::ScreenTriangle> triangles,
+        std::vector<UINT32>& visibleBits, std::vector<UINT32>& occludedBits, UINT32* pTestNum = nullptr);
+
+    /* @brief TestBoxes の影を落とすモデル用 : 前回の Execute で作ったカスケードごとに判定する */
+    void TestShadowBoxes(const FrustumCulling::AABBArrays& boxes,
+        std::array<std::vector<UINT32>, ShadowCascade::CascadeNum>& cascadeBits) const;
+
+    /* @brief 前回の Execute で作った、LOD を選ぶカメラ : メインカメラがなければ無効で、LOD 0 が選ばれる */
+    const ModelLOD::View& GetLODView() const { return m_lodView; }
+
+    /**
+    * @brief 影の描画要求の数を数える : 並列更新中に呼んで良い
+    * @param[in] requestNum - カリング前に影を描画しようとした数
+    * @param[in] drawNum    - カリング後に影を描画する数 : カスケードごとに数える
+    */
+    void AddShadowCasterStats(UINT32 requestNum, UINT32 drawNum)
+    {
+        m_shadowRequestNum.fetch_add(requestNum, std::memory_order_relaxed);
+        m_shadowDrawNum.fetch_add(drawNum, std::memory_order_relaxed);
+    }
+
+    //--------------------------------
+    // 検索 : ゲーム側から使う
+    //--------------------------------
+    // 見つかったオブジェクトを result の後ろに追加する : 同じオブジェクトは1回だけ追加する
+    void QueryBox(const AABB<Math::Vector3>& aabb, std::vector<std::shared_ptr<GameObject>>& result) const;
+    void QuerySphere(const Math::Vector3& center, float radius, std::vector<std::shared_ptr<GameObject>>& result) const;
+    /* @param[in] dir - 正規化した向き */
+    void QueryRay(const Math::Vector3& origin, const Math::Vector3& dir, float maxDist, std::vector<std::shared_ptr<GameObject>>& result) const;
+
+    //--------------------------------
+    // ゲッター : デバッグ表示用
+    //--------------------------------
+    /* @brief 登録されているボックスの数 */
+    UINT32 GetBoxNum() const { return static_cast<UINT32>(m_entries.size() - m_freeHandles.size()); }
+
+    /* @brief 前回の Execute で見えていたボックスの数 */
+    UINT32 GetLastVisibleNum() const { return m_lastVisibleNum; }
+
+    /* @brief 前回の Execute で遮蔽物として描いたモデルの数 / 描いた三角形の数 */
+    UINT32 GetLastOccluderNum() const { return m_lastOccluderNum; }
+    UINT32 GetLastOccluderTriangleNum() const { return m_lastOccluderTriangleNum; }
+
+    /* @brief 前回の Execute で遮蔽を判定したボックスの数 / 隠れていたボックスの数 */
+    UINT32 GetLastOcclusionTestNum() const { return m_lastOcclusionTestNum; }
+    UINT32 GetLastOccludedNum() const { return m_lastOccludedNum; }
+
+    /* @brief 前回の Execute で判定した木の節の数 */
+    UINT32 GetLastVisitNodeNum() const { return m_lastVisitNodeNum; }
+
+    /* @brief 前回の Execute で、平面にかかっていてまとめて判定した葉の数 */
+    UINT32 GetLastLeafTestNum() const { return m_lastLeafTestNum; }
+
+    /* @brief 前のフレームの影の描画要求の数 : カリング前 / カリング後のカスケードごとの描画の合計 */
+    UINT32 GetLastShadowRequestNum() const { return m_lastShadowRequestNum; }
+    UINT32 GetLastShadowDrawNum() const { return m_lastShadowDrawNum; }
+
+    /* @brief 影をキャッシュに描く動かないモデルの数 */
+    UINT32 GetStaticCasterNum() const { return m_staticCasterNum; }
+
+    /* @brief 前のフレームで木を変更した回数 */
+    UINT32 GetLastTreeUpdateNum() const { return m_lastTreeUpdateNum; }
+
+    const DynamicAABBTree& GetTree() const { return m_tree; }
+
+private:
+    // 登録されたボックス
+    struct Entry
+    {
+        DynamicAABBTree::ProxyID ProxyID = DynamicAABBTree::NullNode;
+
+        // 太らせる前の AABB : 木の葉に届いた時の最後の判定に使う
+        DynamicAABBTree::Box Bounds = {};
+
+        std::weak_ptr<GameObject> wpOwner;
+
+        // 動かないモデルの判定
+        bool CanBeStaticCaster = false;
+        bool IsStaticCaster = false;
+        UINT32 StillFrameNum = 0;
+
+        // 遮蔽物 : コリジョンメッシュをワールド行列で深度バッファに描く
+        std::shared_ptr<const ModelData> spOccluder;
+        Math::Matrix mOccluderWorld;
+        UINT32 OccluderFaceNum = 0;
+    };
+
+    /* @brief 動くモデルに戻す : 動かないモデルだった場合は、キャッシュに描いた範囲を描き直す */
+    void DemoteStaticCaster(Entry& entry);
+
+    /* @brief 動かないモデルの判定を進めて、描き直す範囲をシャドウマップのキャッシュに伝える */
+    void UpdateStaticCasters();
+
+    /**
+    * @brief 視錐台の中の遮蔽物を深度バッファに描き、隠れたボックスのビットを m_visibleBits から m_occludedBits に移す
+    * @details ワーカースレッドから呼ぶ : 中でさらに帯 / ボックスごとに分けて並列に処理する
+    */
+    void ExecuteOcclusion(const Math::Matrix& mViewProj);
+
+    /**
+    * @brief 1つの遮蔽物の三角形を作る
+    * @param[out] pDst - OccluderFaceNum 個の三角形を書き込む : 描かない三角形も詰めずに書く
+    * @return 描く三角形の数
+    */
+    static UINT32 SetupOccluderTriangles(const Entry& entry, const Math::Matrix& mViewProj, OcclusionCulling::ScreenTriangle* pDst);
+
+    // 平面にかかった葉をまとめて判定するための作業領域
+    struct LeafBatch
+    {
+        std::vector<Handle> Handles;
+        FrustumCulling::AABBArrays Boxes;
+        std::vector<UINT32> Bits;
+    };
+
+    /**
+    * @brief 集めた葉の元の AABB を成分ごとの配列に詰めて判定し、見えている番号のビットを立てる
+    * @details ビット配列の要素の境目で分けてワーカーで判定し、番号への書き戻しは呼んだスレッドで行う
+    */
+    void TestLeafBatch(const FrustumCulling::Planes& planes, LeafBatch& batch, std::vector<UINT32>& visibleBits) const;
+
+    /* @brief 見つかった番号のオブジェクトを追加する : 同じオブジェクトは1回だけ */
+    void AddQueryResult(Handle handle, size_t resultBegin, std::vector<std::shared_ptr<GameObject>>& result) const;
+
+    static DynamicAABBTree::Box ToTreeBox(const AABB<Math::Vector3>& aabb)
+    {
+        return { aabb.GetMin(), aabb.GetMax() };
+    }
+
+    DynamicAABBTree m_tree;
+
+    std::vector<Entry> m_entries;
+    std::vector<Handle> m_freeHandles;
+
+    // 判定結果
+    std::vector<UINT32> m_visibleBits;
+
+    // Execute で取り出した視錐台
+    FrustumCulling::Planes m_planes = {};
+    bool m_hasFrustum = false;
+
+    // Execute で作った LOD を選ぶカメラ
+    ModelLOD::View m_lodView;
+
+    // カスケードごとの視錐台と影を落とすモデルの判定結果
+    std::array<FrustumCulling::Planes, ShadowCascade::CascadeNum> m_cascadePlanes = {};
+    std::array<std::vector<UINT32>, ShadowCascade::CascadeNum> m_cascadeCasterBits;
+    bool m_hasCascades = false;
+
+    // 遮蔽の判定
+    OcclusionCulling::DepthBuffer m_occlusionBuffer;
+    std::vector<Handle> m_occluderHandles;
+    std::vector<UINT32> m_occluderTriangleStarts;
+    std::vector<OcclusionCulling::ScreenTriangle> m_occluderTriangles;
+    // 視錐台の中にあるが遮蔽物に隠れていたボックス : m_visibleBits と同じ並び
+    std::vector<UINT32> m_occludedBits;
+    bool m_isOcclusionEnable = true;
+
+    UINT32 m_lastOccluderNum = 0;
+    UINT32 m_lastOccluderTriangleNum = 0;
+    UINT32 m_lastOcclusionTestNum = 0;
+    UINT32 m_lastOccludedNum = 0;
+
+    // 動かないモデルの影のキャッシュを描き直す範囲 : 次の Execute でまとめて伝える
+    std::vector<DynamicAABBTree::Box> m_staticDirtyBoxes;
+    UINT32 m_staticShadowDirtyMask = ShadowCascade::AllCascadeMask;
+    UINT32 m_staticCasterNum = 0;
+
+    // 影の描画要求の数 : 並列更新中に数える
+    std::atomic<UINT32> m_shadowRequestNum = 0;
+    std::atomic<UINT32> m_shadowDrawNum = 0;
+    UINT32 m_lastShadowRequestNum = 0;
+    UINT32 m_lastShadowDrawNum = 0;
+
+    UINT32 m_lastVisibleNum = 0;
+    UINT32 m_lastVisitNodeNum = 0;
+    UINT32 m_lastLeafTestNum = 0;
+
+    UINT32 m_treeUpdateNum = 0;
+    UINT32 m_lastTreeUpdateNum = 0;
+
+    //--------------------------------
+    // コンストラクタ / デストラクタ
+    //--------------------------------
+    CullingSystem()
+    {
+    }
+
+    ~CullingSystem() override
+    {
+    }
+};
@@ -0,0 +1,191 @@
+﻿#include "RenderQueue.h"
+
+namespace
+{
+    //x--- ソートキーのビット位置 ---x//
+    constexpr UINT PassShift = 60;
+    constexpr UINT PipelineShift = 56;
+    constexpr UINT ModelShift = 32;
+    constexpr UINT LODShift = 28;
+    constexpr UINT DepthShift = 12;
+
+    constexpr UINT64 ModelMask = (1ull << 24) - 1;
+    constexpr UINT64 LODMask = (1ull << 4) - 1;
+    constexpr UINT64 DepthMask = (1ull << 16) - 1;
+
+    // 基数ソートの1桁のビット数
+    constexpr UINT RadixBits = 8;
+    constexpr UINT RadixSize = 1 << RadixBits;
+    constexpr UINT RadixDigitNum = 64 / RadixBits;
+}
+
+void RenderQueue::Push(Pass pass, ModelWork* pModelWork, ModelData* pModelData, UINT lod, const InstanceData& instance)
+{
+    if (!pModelWork || !pModelData) { return; }
+
+    // モデルの持っていない LOD は一番粗い LOD にそろえて、同じメッシュを描くインスタンスをまとめる
+    lod = std::min(lod, std::max(pModelData->GetLODNum(), 1u) - 1);
+
+    DrawPacket packet;
+    packet.SortKey = MakeSortKey(pass, *pModelData, lod);
+    packet.pModelWork = pModelWork;
+    packet.pModelData = pModelData;
+    packet.LOD = lod;
+    packet.Instance = instance;
+
+    // ワーカースレッドからは共有の配列を直接触らずに、スレッドごとの配列に積んでおく
+    if (JobSystem::IsWorkerThread())
+    {
+        m_threadPackets.Work().push_back(packet);
+        return;
+    }
+
+    m_packets.push_back(packet);
+}
+
+void RenderQueue::MergeThreadBuffers()
+{
+    // スレッド番号順にまとめるので、同じスレッドに積まれたデータの順番は保たれる
+    m_threadPackets.ForEach([this](std::vector<DrawPacket>& packets)
+        {
+            m_packets.insert(m_packets.end(), packets.begin(), packets.end());
+
+            // 確保した領域は次のフレームでも使うので、要素だけ消す
+            packets.clear();
+        });
+}
+
+void RenderQueue::Sort(const Math::Vector3& viewPos, const Math::Vector3& viewForward)
+{
+    const size_t packetNum = m_packets.size();
+
+    //--------------------------------
+    // キーの作成
+    //--------------------------------
+    m_sortEntries.resize(packetNum);
+
+    for (size_t i = 0; i < packetNum; ++i)
+    {
+        const DrawPacket& packet = m_packets[i];
+        UINT64 key = packet.SortKey;
+
+        // GBuffer はカメラから近い順に並べる : シャドウマップはライトから見るので深度を入れない
+        if (static_cast<Pass>(key >> PassShift) == Pass::eGBuffer)
+        {
+            float depth = (packet.Instance.mWorld.Translation() - viewPos).Dot(viewForward);
+            depth = std::clamp(depth, 0.0f, DepthSortRange);
+
+            UINT64 depthBucket = static_cast<UINT64>(depth / DepthSortRange * static_cast<float>(DepthMask));
+            key |= (depthBucket & DepthMask) << DepthShift;
+        }
+
+        m_sortEntries[i] = { key, static_cast<UINT>(i) };
+    }
+
+    RadixSort();
+
+    //--------------------------------
+    // 並べ替えと DrawBatch の作成
+    //--------------------------------
+    m_sortedInstances.resize(packetNum);
+    m_sortedModelWorks.resize(packetNum);
+    m_batches.clear();
+
+    m_lastTriangleNum = 0;
+    m_lastLODInstanceNums.fill(0);
+
+    for (size_t i = 0; i < packetNum; ++i)
+    {
+        const SortEntry& entry = m_sortEntries[i];
+        const DrawPacket& packet = m_packets[entry.Index];
+        const Pass pass = static_cast<Pass>(entry.Key >> PassShift);
+
+        m_sortedInstances[i] = packet.Instance;
+        m_sortedModelWorks[i] = packet.pModelWork;
+
+        // モデルの番号が重なってもまとめないように、境目はモデルデータで判定する
+        if (m_batches.empty() || m_batches.back().DrawPass != pass || m_batches.back().pModelData != packet.pModelData ||
+            m_batches.back().LOD != packet.LOD)
+        {
+            m_batches.push_back({ pass, packet.pModelData, packet.LOD, static_cast<UINT>(i), 0 });
+        }
+
+        ++m_batches.back().Count;
+    }
+
+    for (const DrawBatch& batch : m_batches)
+    {
+        m_lastTriangleNum += static_cast<UINT64>(batch.pModelData->GetLODFaceNum(batch.LOD)) * batch.Count;
+        m_lastLODInstanceNums[std::min<size_t>(batch.LOD, ModelLOD::MaxLODNum - 1)] += batch.Count;
+    }
+
+    m_lastPacketNum = packetNum;
+    m_lastBatchNum = m_batches.size();
+}
+
+void RenderQueue::Clear()
+{
+    m_packets.clear();
+    m_sortEntries.clear();
+    m_batches.clear();
+}
+
+UINT64 RenderQueue::MakeSortKey(Pass pass, const ModelData& modelData, UINT lod)
+{
+    UINT64 key = 0;
+    key |= static_cast<UINT64>(pass) << PassShift;
+    key |= static_cast<UINT64>(modelData.IsSkinMesh() ? 1 : 0) << PipelineShift;
+    key |= (static_cast<UINT64>(modelData.GetRenderID()) & ModelMask) << ModelShift;
+    key |= (static_cast<UINT64>(lod) & LODMask) << LODShift;
+
+    return key;
+}
+
+void RenderQueue::RadixSort()
+{
+    const size_t entryNum = m_sortEntries.size();
+    m_lastSortPassNum = 0;
+
+    if (entryNum < 2) { return; }
+
+    // すべての桁の出現数を1回の走査で数える
+    std::array<std::array<UINT, RadixSize>, RadixDigitNum> counts = {};
+
+    for (const SortEntry& entry : m_sortEntries)
+    {
+        for (UINT digit = 0; digit < RadixDigitNum; ++digit)
+        {
+            ++counts[digit][(entry.Key >> (digit * RadixBits)) & (RadixSize - 1)];
+        }
+    }
+
+    m_sortScratch.resize(entryNum);
+
+    // 下の桁から安定に並べ替える : 同じキーの間では積んだ順が保たれる
+    for (UINT digit = 0; digit < RadixDigitNum; ++digit)
+    {
+        std::array<UINT, RadixSize>& count = counts[digit];
+        const UINT shift = digit * RadixBits;
+
+        // 全部同じ値の桁は並びが変わらないので飛ばす
+        const UINT firstValue = static_cast<UINT>((m_sortEntries.front().Key >> shift) & (RadixSize - 1));
+        if (count[firstValue] == entryNum) { continue; }
+
+        // 出現数を書き込み先の位置に変える
+        UINT offset = 0;
+        for (UINT& c : count)
+        {
+            UINT num = c;
+            c = offset;
+            offset += num;
+        }
+
+        for (const SortEntry& entry : m_sortEntries)
+        {
+            m_sortScratch[count[(entry.Key >> shift) & (RadixSize - 1)]++] = entry;
+        }
+
+        m_sortEntries.swap(m_sortScratch);
+        ++m_lastSortPassNum;
+    }
+}
@@ -0,0 +1,172 @@
+﻿#pragma once
+
+/**
+* @class RenderQueue
+* @brief ソートキーで並べ替えて、インスタンス描画の単位にまとめる描画キュー
+* @details
+*   - 描画要求は固定サイズの DrawPacket として配列に積むだけで、フレームごとにマップを作り直さない
+*   - 64bit のソートキーを基数ソートして、同じパス / パイプライン / モデル / LOD の描画要求を連続させる
+*   - 連続した区間をそのまま1回のインスタンス描画(DrawBatch)にする
+*   - 配列はフレームをまたいで使い回すので、描画数が落ち着けば確保は発生しない
+*   - ワーカースレッドからはスレッドごとの配列に積み、MergeThreadBuffers でまとめる
+*
+*   ソートキーのビット配置(上位から)
+*   - [63-60] パス         : 描画するパスの順 : 動かないモデルの影 -> 動くモデルの影 -> GBuffer
+*   - [59-56] パイプライン : スキンメッシュかどうか
+*   - [55-32] モデル       : メッシュとマテリアルはモデル単位で持つので、モデルの番号でまとめる
+*   - [31-28] LOD          : LOD ごとにメッシュが違うので、同じモデルでも LOD ごとに分ける
+*   - [27-12] 深度         : GBuffer はカメラから近い順に並べて、深度テストで早く弾かれるようにする
+*   - [11- 0] 未使用
+*/
+class RenderQueue
+{
+public:
+    // 描画パス : ソートキーの最上位に置くので、値の小さい順に並ぶ
+    enum class Pass : UINT8
+    {
+        eStaticShadowCascade0 = 0, // 動かないモデルのシャドウマップ描画 : カスケードの数だけ続く
+        eShadowCascade0 = static_cast<UINT8>(eStaticShadowCascade0 + ShadowCascade::CascadeNum), // シャドウマップ描画 : カスケードの数だけ続く
+        eGBuffer = static_cast<UINT8>(eShadowCascade0 + ShadowCascade::CascadeNum), // GBuffer 描画
+    };
+
+    /* @brief カスケードのシャドウマップ描画のパス */
+    static constexpr Pass ToShadowPass(UINT32 cascadeIdx)
+    {
+        return static_cast<Pass>(static_cast<UINT32>(Pass::eShadowCascade0) + cascadeIdx);
+    }
+
+    /* @brief カスケードの動かないモデルのシャドウマップ描画のパス */
+    static constexpr Pass ToStaticShadowPass(UINT32 cascadeIdx)
+    {
+        return static_cast<Pass>(static_cast<UINT32>(Pass::eStaticShadowCascade0) + cascadeIdx);
+    }
+
+    // 深度をソートキーにする範囲 : これより遠いものは同じ深度として扱う
+    static constexpr float DepthSortRange = 1000.0f;
+
+    // 1つの描画要求
+    struct DrawPacket
+    {
+        UINT64 SortKey = 0;
+        ModelWork* pModelWork = nullptr;
+        ModelData* pModelData = nullptr;
+        UINT LOD = 0;
+        InstanceData Instance;
+    };
+
+    // 同じパス / モデル / LOD が連続した区間 : 1回のインスタンス描画になる
+    struct DrawBatch
+    {
+        Pass DrawPass = Pass::eStaticShadowCascade0;
+        ModelData* pModelData = nullptr;
+        UINT LOD = 0;
+        UINT First = 0; // ソート後の配列の先頭
+        UINT Count = 0;
+    };
+
+    //--------------------------------
+    // 描画要求の追加
+    //--------------------------------
+    /**
+    * @brief 描画要求を積む : ワーカースレッドから呼ばれた場合は、スレッドごとの配列に積む
+    * @param[in] pass       - 描画パス
+    * @param[in] pModelWork - 描画するモデル : 描画が終わるまで生存させる
+    * @param[in] pModelData - pModelWork の元のモデルデータ
+    * @param[in] lod        - 描画する LOD : モデルの LOD の数を超える場合は一番粗い LOD になる
+    * @param[in] instance   - インスタンスデータ
+    */
+    void Push(Pass pass, ModelWork* pModelWork, ModelData* pModelData, UINT lod, const InstanceData& instance);
+
+    /* @brief 並列更新の前に、スレッドごとの配列を JobSystem のスレッド数に合わせて確保する */
+    void PrepareThreadBuffers() { m_threadPackets.Prepare(); }
+
+    /* @brief スレッドごとの配列に積まれた描画要求を、キューへまとめる : メインスレッドから呼ぶ */
+    void MergeThreadBuffers();
+
+    //--------------------------------
+    // ソート
+    //--------------------------------
+    /**
+    * @brief 描画要求をソートして、DrawBatch を作る
+    * @param[in] viewPos     - 深度の基準にするカメラの座標
+    * @param[in] viewForward - カメラの前方向
+    */
+    void Sort(const Math::Vector3& viewPos, const Math::Vector3& viewForward);
+
+    /* @brief 描画要求を消す : 確保した領域は次のフレームでも使う */
+    void Clear();
+
+    //--------------------------------
+    // ゲッター
+    //--------------------------------
+    bool IsEmpty() const { return m_packets.empty(); }
+
+    /* @brief ソート前の描画要求 : SkinningPalette がボーン行列の位置を書き込む */
+    std::span<DrawPacket> WorkPackets() { return m_packets; }
+
+    const std::vector<DrawBatch>& GetBatches() const { return m_batches; }
+
+    /* @brief ソート後のインスタンスデータ : DrawBatch の First / Count で参照する */
+    std::span<const InstanceData> GetInstances(const DrawBatch& batch) const
+    {
+        return std::span<const InstanceData>(m_sortedInstances).subspan(batch.First, batch.Count);
+    }
+
+    /* @brief ソート後のモデル : DrawBatch の First / Count で参照する */
+    std::span<ModelWork* const> GetModelWorks(const DrawBatch& batch) const
+    {
+        return std::span<ModelWork* const>(m_sortedModelWorks).subspan(batch.First, batch.Count);
+    }
+
+    //x--- デバッグ表示用 ---x//
+    /* @brief 前のフレームの描画要求の数 */
+    size_t GetLastPacketNum() const { return m_lastPacketNum; }
+
+    /* @brief 前のフレームの DrawBatch の数 */
+    size_t GetLastBatchNum() const { return m_lastBatchNum; }
+
+    /* @brief 前のフレームの基数ソートで、実際に並べ替えた桁の数 : 全部同じ値の桁は飛ばす */
+    UINT GetLastSortPassNum() const { return m_lastSortPassNum; }
+
+    /* @brief 前のフレームに描画した三角形の数 : すべてのパスの合計 */
+    UINT64 GetLastTriangleNum() const { return m_lastTriangleNum; }
+
+    /* @brief 前のフレームに LOD ごとに描画したインスタンスの数 : すべてのパスの合計 */
+    const std::array<size_t, ModelLOD::MaxLODNum>& GetLastLODInstanceNums() const { return m_lastLODInstanceNums; }
+
+private:
+    // 並べ替えるのはキーと番号だけにして、パケット本体は動かさない
+    struct SortEntry
+    {
+        UINT64 Key = 0;
+        UINT Index = 0;
+    };
+
+    /* @brief ソートキーの作成 : 深度は Sort で入れる */
+    static UINT64 MakeSortKey(Pass pass, const ModelData& modelData, UINT lod);
+
+    /* @brief 8bit ずつの LSD 基数ソート : m_sortEntries を並べ替える */
+    void RadixSort();
+
+    // 描画要求
+    std::vector<DrawPacket> m_packets;
+    // スレッドごとの描画要求
+    utl::PerThread<std::vector<DrawPacket>> m_threadPackets;
+
+    // ソート用の作業領域
+    std::vector<SortEntry> m_sortEntries;
+    std::vector<SortEntry> m_sortScratch;
+
+    // ソート後に並べたインスタンスとモデル
+    std::vector<InstanceData> m_sortedInstances;
+    std::vector<ModelWork*> m_sortedModelWorks;
+
+    std::vector<DrawBatch> m_batches;
+
+    //x--- 統計 ---x//
+    size_t m_lastPacketNum = 0;
+    size_t m_lastBatchNum = 0;
+    UINT m_lastSortPassNum = 0;
+    UINT64 m_lastTriangleNum = 0;
+    std::array<size_t, ModelLOD::MaxLODNum> m_lastLODInstanceNums = {};
+};
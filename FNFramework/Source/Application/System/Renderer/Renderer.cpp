@@ -5,8 +5,11 @@ void Renderer::Render()
     // todo : レイトレ用のパイプラインを作成する : 今は非対応のため描画をスキップ
     // if (GraphicsDevice::Instance().IsDXRSupport()) { return; }
 
-    // モデルリストが空じゃなければ、描画処理を行う
-    if (!m_GBufferRenderData.empty() || !m_ShadowMapRenderData.empty())
+    // まとめ忘れた描画データがあれば、ここで描画対象に加える
+    MergeThreadBuffers();
+
+    // 描画キューが空じゃなければ、描画処理を行う
+    if (!m_renderQueue.IsEmpty())
     {
         DrawModel();
     }
@@ -24,44 +27,110 @@ void Renderer::Render()
 
 void Renderer::DrawModel()
 {
-    if (ShaderManager::Instance().WorkShadowShader()->Begin())
+    // GBuffer の深度の基準にするカメラ
+    Math::Vector3 viewPos = Math::Vector3::Zero;
+    Math::Vector3 viewForward = Math::Vector3::UnitZ;
+
+    if (const std::shared_ptr<Camera> spCamera = ShaderManager::Instance().FindCameraData(RenderingData::MainCameraName))
     {
+        viewPos = spCamera->GetPos();
+        viewForward = spCamera->GetForward();
+
+        // ポイントライトのクラスターへの振り分けは、影と GBuffer の描画を記録している間に済ませる
+        const LightCluster::Grid grid = LightCluster::Grid::Create(spCamera->GetViewMat(), spCamera->GetProjMat(),
+            spCamera->GetProjMatInfo().Near, spCamera->GetProjMatInfo().Far);
+        ShaderManager::Instance().GetAmbientManager()->BeginBuildLightClusters(grid);
+    }
+
+    // アニメーションの更新はすべて終わっているので、ボーン行列をここで1回だけ計算する
+    m_skinningPalette.Build(m_renderQueue.WorkPackets());
+
+    m_renderQueue.Sort(viewPos, viewForward);
+
+    // パスがソートキーの最上位なので、動かないモデルの影 -> 動くモデルの影の順にシャドウマップのバッチが先に並ぶ
+    const std::vector<RenderQueue::DrawBatch>& batches = m_renderQueue.GetBatches();
+    auto itDynamicShadowBegin = std::partition_point(batches.begin(), batches.end(),
+        [](const RenderQueue::DrawBatch& batch) { return batch.DrawPass < RenderQueue::Pass::eShadowCascade0; });
+    auto itGBufferBegin = std::partition_point(itDynamicShadowBegin, batches.end(),
+        [](const RenderQueue::DrawBatch& batch) { return batch.DrawPass < RenderQueue::Pass::eGBuffer; });
 
-        for (auto& [modelData, instanceList] : m_ShadowMapRenderData)
+    ShaderManager::Instance().WorkShadowShader()->SetBonePalette(m_skinningPalette.GetAllocation());
+    ShaderManager::Instance().WorkGBufferPass()->SetBonePalette(m_skinningPalette.GetAllocation());
+
+    if (ShaderManager::Instance().WorkShadowShader()->Begin())
+    {
+        // 動かないモデルの影は、描き直すカスケードがある時だけ描画する
+        if (ShaderManager::Instance().WorkShadowShader()->BeginStaticCache())
         {
-            if (!modelData || instanceList.InstanceDataList.empty()) { continue; }
+            DrawShadowCascades(batches.begin(), itDynamicShadowBegin, &RenderQueue::ToStaticShadowPass);
 
-            // GBufferPass を使用して描画
-            ShaderManager::Instance().WorkShadowShader()->DrawModelInstanced(
-                modelData,
-                instanceList.InstanceDataList,
-                instanceList.ModelWorkList);
+            ShaderManager::Instance().WorkShadowShader()->EndStaticCache();
         }
 
+        ShaderManager::Instance().WorkShadowShader()->BeginDynamic();
+
+        DrawShadowCascades(itDynamicShadowBegin, itGBufferBegin, &RenderQueue::ToShadowPass);
+
         ShaderManager::Instance().WorkShadowShader()->End();
     }
 
     if (ShaderManager::Instance().WorkGBufferPass()->Begin())
     {
-        for (auto& [modelData, instanceList] : m_GBufferRenderData)
+        for (auto it = itGBufferBegin; it != batches.end(); ++it)
         {
-            if (!modelData || instanceList.InstanceDataList.empty()) { continue; }
+            std::span<ModelWork* const> modelWorks = m_renderQueue.GetModelWorks(*it);
 
             // GBufferPass を使用して描画
             ShaderManager::Instance().WorkGBufferPass()->DrawModelInstanced(
-                modelData,
-                instanceList);
+                modelWorks.front()->GetModelData(),
+                it->LOD,
+                m_renderQueue.GetInstances(*it),
+                modelWorks);
         }
 
         ShaderManager::Instance().WorkGBufferPass()->End();
     }
 
-    // ライティングパスの描画
+    // ライティングパスの描画 : クラスターの振り分けの結果を読むので、先に待つ
+    ShaderManager::Instance().GetAmbientManager()->WaitLightClusters();
     ShaderManager::Instance().GetLightingPass()->Rendering();
 
     ShaderManager::Instance().GetBloomShader()->Rendering();
 }
 
+void Renderer::DrawShadowCascades(
+    std::vector<RenderQueue::DrawBatch>::const_iterator itBegin,
+    std::vector<RenderQueue::DrawBatch>::const_iterator itEnd,
+    RenderQueue::Pass(*toPass)(UINT32))
+{
+    auto itCascadeBegin = itBegin;
+
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        const RenderQueue::Pass pass = toPass(cascadeIdx);
+        auto itCascadeEnd = std::partition_point(itCascadeBegin, itEnd,
+            [pass](const RenderQueue::DrawBatch& batch) { return batch.DrawPass <= pass; });
+
+        if (itCascadeBegin == itCascadeEnd) { continue; }
+
+        ShaderManager::Instance().WorkShadowShader()->BeginCascade(cascadeIdx);
+
+        for (auto it = itCascadeBegin; it != itCascadeEnd; ++it)
+        {
+            std::span<ModelWork* const> modelWorks = m_renderQueue.GetModelWorks(*it);
+
+            // Shadow を使用して描画
+            ShaderManager::Instance().WorkShadowShader()->DrawModelInstanced(
+                modelWorks.front()->GetModelData(),
+                it->LOD,
+                m_renderQueue.GetInstances(*it),
+                modelWorks);
+        }
+
+        itCascadeBegin = itCascadeEnd;
+    }
+}
+
 void Renderer::DrawSprite()
 {
     //==============================
@@ -89,6 +158,5 @@ void Renderer::DrawSprite()
 void Renderer::ClearList()
 {
     m_spriteList.clear();
-    m_GBufferRenderData.clear();
-    m_ShadowMapRenderData.clear();
+    m_renderQueue.Clear();
 }
@@ -90,16 +90,14 @@ class Renderer
 
 public:
 
-    struct InstancedRenderEntry
-    {
-        // モデル一つずつのデータ
-        std::vector<InstanceData> InstanceDataList;
-        std::vector<ModelWork*> ModelWorkList;
-    };
-
     //--------------------------------
     // ゲッター / セッター
     //--------------------------------
+    /* @brief モデルの描画キュー : デバッグ表示用 */
+    const RenderQueue& GetRenderQueue() const { return m_renderQueue; }
+
+    /* @brief スキンメッシュのボーン行列 : デバッグ表示用 */
+    const SkinningPalette& GetSkinningPalette() const { return m_skinningPalette; }
 
     //-----------------------
     // 描画用データの追加
@@ -111,13 +109,22 @@ public:
         UINT renderType,
         const Math::Vector4& color,
         const Math::Vector2& tilling,
-        const Math::Vector2& offset)
+        const Math::Vector2& offset,
+        UINT shadowCascadeMask = ShadowCascade::AllCascadeMask,
+        UINT staticShadowCascadeMask = 0,
+        UINT lod = 0)
     {
         if (!spModelWork)
         {
             return;
         }
 
+        const std::shared_ptr<ModelData>& spModelData = spModelWork->GetModelData();
+        if (!spModelData)
+        {
+            return;
+        }
+
         // インスタンスデータを作成
         InstanceData instanceData = {};
         instanceData.mWorld = worldMatrix;
@@ -128,20 +135,30 @@ public:
             offset.y };
         instanceData.Color = color;
 
+        // 描画タイプごとのパスに積む : ワーカースレッドからの場合はスレッドごとの配列に積まれる
+        // 影も同じ LOD で描く : キャッシュに描く影は、描き直した時の LOD のまま使い続ける
         if (IsRenderTypeLit(renderType))
         {
-            // GBuffer描画用データを追加
-            auto& instancedRenderEntry = m_GBufferRenderData[spModelWork->GetModelData()];
-            instancedRenderEntry.InstanceDataList.emplace_back(instanceData);
-            instancedRenderEntry.ModelWorkList.emplace_back(spModelWork.get());
+            m_renderQueue.Push(RenderQueue::Pass::eGBuffer, spModelWork.get(), spModelData.get(), lod, instanceData);
         }
 
+        // 影は範囲に入っているカスケードにだけ積む : 動かないモデルは描き直すカスケードにだけ積む
         if (IsRenderTypeShadow(renderType))
         {
-            // シャドウマップ描画用データを追加
-            auto& instancedRenderEntry = m_ShadowMapRenderData[spModelWork->GetModelData()];
-            instancedRenderEntry.InstanceDataList.emplace_back(instanceData);
-            instancedRenderEntry.ModelWorkList.emplace_back(spModelWork.get());
+            for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+            {
+                const UINT cascadeBit = 1u << cascadeIdx;
+
+                if ((shadowCascadeMask & cascadeBit) != 0)
+                {
+                    m_renderQueue.Push(RenderQueue::ToShadowPass(cascadeIdx), spModelWork.get(), spModelData.get(), lod, instanceData);
+                }
+
+                if ((staticShadowCascadeMask & cascadeBit) != 0)
+                {
+                    m_renderQueue.Push(RenderQueue::ToStaticShadowPass(cascadeIdx), spModelWork.get(), spModelData.get(), lod, instanceData);
+                }
+            }
         }
     }
 
@@ -169,19 +186,37 @@ public:
     */
     void Render();
 
+    /* @brief 並列更新の前に、スレッドごとの配列を JobSystem のスレッド数に合わせて確保する */
+    void PrepareThreadBuffers() { m_renderQueue.PrepareThreadBuffers(); }
+
+    /* @brief スレッドごとの配列に積まれた描画データを、描画キューへまとめる : メインスレッドから呼ぶ */
+    void MergeThreadBuffers() { m_renderQueue.MergeThreadBuffers(); }
+
 private:
     /* @brief モデル描画 */
     void DrawModel();
 
+    /**
+    * @brief カスケードごとにシャドウマップを描画する
+    * @param[in] itBegin, itEnd - 描画するバッチの範囲 : パスの順に並んでいる
+    * @param[in] toPass         - カスケードの番号からパスを作る関数
+    */
+    void DrawShadowCascades(
+        std::vector<RenderQueue::DrawBatch>::const_iterator itBegin,
+        std::vector<RenderQueue::DrawBatch>::const_iterator itEnd,
+        RenderQueue::Pass(*toPass)(UINT32));
+
     /* @brief スプライト描画 */
     void DrawSprite();
 
     /* @brief リストのデータを削除する */
     void ClearList();
 
-    // キーを ModelData にし、値に InstancedRenderEntry を持つマップ
-    std::unordered_map<std::shared_ptr<ModelData>, InstancedRenderEntry> m_GBufferRenderData;
-    std::unordered_map<std::shared_ptr<ModelData>, InstancedRenderEntry> m_ShadowMapRenderData;
+    // モデルの描画キュー : フレームをまたいで領域を使い回す
+    RenderQueue m_renderQueue;
+
+    // 描画するスキンメッシュのボーン行列 : シャドウマップと GBuffer で共有する
+    SkinningPalette m_skinningPalette;
 
     // スプライトリスト
     std::list<RenderingData::Sprite::Sprite> m_spriteList;
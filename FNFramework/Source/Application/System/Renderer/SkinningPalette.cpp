@@ -0,0 +1,78 @@
+﻿#include "SkinningPalette.h"
+
+void SkinningPalette::Build(std::span<RenderQueue::DrawPacket> packets)
+{
+    ++m_buildID;
+    m_entries.clear();
+    m_allocation = {};
+    m_boneNum = 0;
+
+    //--------------------------------
+    // ModelWork ごとにパレット内の位置を割り当てる
+    //--------------------------------
+    for (RenderQueue::DrawPacket& packet : packets)
+    {
+        if (!packet.pModelData->IsSkinMesh()) { continue; }
+
+        const UINT bonesPerInstance = static_cast<UINT>(packet.pModelData->GetBoneNodeIdxList().size());
+        if (bonesPerInstance == 0) { continue; }
+
+        // 同じ ModelWork の別のインスタンスやパスは、割り当て済みの行列を共有する
+        UINT offset = 0;
+        if (!packet.pModelWork->FindPaletteOffset(m_buildID, offset))
+        {
+            offset = m_boneNum;
+            m_boneNum += bonesPerInstance;
+
+            packet.pModelWork->SetPaletteOffset(m_buildID, offset);
+            m_entries.push_back({ packet.pModelWork, offset });
+        }
+
+        packet.Instance.BoneOffset = offset;
+    }
+
+    if (m_entries.empty()) { return; }
+
+    //--------------------------------
+    // ボーン行列の計算
+    //--------------------------------
+    m_allocation = GraphicsDevice::Instance().GetUploadAllocator()->Allocate(
+        static_cast<UINT64>(m_boneNum) * sizeof(Math::Matrix), sizeof(Math::Matrix));
+
+    if (!m_allocation.IsValid()) { return; }
+
+    Math::Matrix* pPalette = reinterpret_cast<Math::Matrix*>(m_allocation.pCPU);
+
+    // ModelWork ごとに書き込む範囲が分かれているので、そのまま並列に計算できる
+    JobSystem::Instance().ParallelFor(static_cast<UINT32>(m_entries.size()), ParallelGrainSize,
+        [this, pPalette](UINT32 begin, UINT32 end)
+        {
+            for (UINT32 i = begin; i < end; ++i)
+            {
+                WriteBoneMatrices(*m_entries[i].pModelWork, pPalette + m_entries[i].Offset);
+            }
+        });
+}
+
+void SkinningPalette::WriteBoneMatrices(ModelWork& modelWork, Math::Matrix* pDst)
+{
+    if (modelWork.NeedCalcNodeMatrices())
+    {
+        modelWork.CalcNodeMatrices();
+    }
+
+    const std::vector<ModelData::Node>& dataNodes = modelWork.GetDataNodes();
+    const std::vector<ModelWork::Node>& workNodes = modelWork.GetNodes();
+    const std::vector<int>& boneNodeIndices = modelWork.GetModelData()->GetBoneNodeIdxList();
+
+    for (size_t boneIdx = 0; boneIdx < boneNodeIndices.size(); ++boneIdx)
+    {
+        const int nodeIdx = boneNodeIndices[boneIdx];
+
+        // ボーン行列 = ボーンの逆行列 * ノードのワールド行列
+        // アップロード用のページは書き込み専用なので、一時変数を作らずに直接書き込む
+        DirectX::XMStoreFloat4x4(&pDst[boneIdx], DirectX::XMMatrixMultiply(
+            DirectX::XMLoadFloat4x4(&dataNodes[nodeIdx].Bone.OffsetMatrix),
+            DirectX::XMLoadFloat4x4(&workNodes[nodeIdx].mWorldTransform)));
+    }
+}
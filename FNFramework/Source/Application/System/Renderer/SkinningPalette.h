@@ -0,0 +1,54 @@
+﻿#pragma once
+
+/**
+* @class SkinningPalette
+* @brief 描画するスキンメッシュのボーン行列を、1フレームに1回だけまとめて計算するクラス
+* @details
+*   - 描画キューに積まれたスキンメッシュの ModelWork ごとに、ボーン行列を1つの連続した配列(パレット)に並べる
+*   - 同じ ModelWork がシャドウマップと GBuffer の両方に積まれていても、計算とアップロードは1回だけ
+*   - 各インスタンスの InstanceData::BoneOffset にパレット内の先頭を書き込み、シェーダーはそこから読む
+*   - パレットはアップロード用のページへ直接書き込むので、CPU 側の作業用の配列は作らない
+*   - ModelWork ごとの計算は JobSystem で並列に行う
+*/
+class SkinningPalette
+{
+public:
+    // 1つのジョブで計算する ModelWork の数
+    static constexpr UINT32 ParallelGrainSize = 8;
+
+    /**
+    * @brief パレットの作成 : アニメーションの更新が終わった後、描画キューをソートする前に呼ぶ
+    * @param[in,out] packets - 描画キューの描画要求 : スキンメッシュのインスタンスに BoneOffset を書き込む
+    */
+    void Build(std::span<RenderQueue::DrawPacket> packets);
+
+    /* @brief 作成したパレット : スキンメッシュがなければ IsValid が false */
+    const UploadAllocation& GetAllocation() const { return m_allocation; }
+
+    //x--- デバッグ表示用 ---x//
+    /* @brief 前のフレームでボーン行列を計算した ModelWork の数 */
+    size_t GetLastModelNum() const { return m_entries.size(); }
+
+    /* @brief 前のフレームのパレットのボーン行列の数 */
+    UINT GetLastBoneNum() const { return m_boneNum; }
+
+private:
+    // パレットに書き込む ModelWork と、その先頭
+    struct Entry
+    {
+        ModelWork* pModelWork = nullptr;
+        UINT Offset = 0;
+    };
+
+    /* @brief ModelWork のボーン行列をパレットに書き込む */
+    static void WriteBoneMatrices(ModelWork& modelWork, Math::Matrix* pDst);
+
+    std::vector<Entry> m_entries;
+
+    UploadAllocation m_allocation;
+
+    // Build のたびに増やす : ModelWork に割り当て済みかの判定に使う
+    UINT64 m_buildID = 0;
+
+    UINT m_boneNum = 0;
+};
@@ -4,36 +4,50 @@
 
 void Scene::PreUpdate()
 {
-    // シーンのライト情報をクリア
-    ShaderManager::Instance().GetAmbientManager()->ClearLight();
+    // シーンのライト情報をクリア : シェーダーの初期化前 (描画を行わないテストなど) は何もない
+    if (const auto& upAmbientManager = ShaderManager::Instance().GetAmbientManager())
+    {
+        upAmbientManager->ClearLight();
+    }
 
     //----------------------
     // オブジェクトの削除
     //----------------------
-    // ループ中に削除するとイテレータが無効になるため、効率は多少悪いが一時的に保存しておく方式を採用
-    std::list<std::shared_ptr<GameObject>> objectsToDelete;
-
-    // 削除対象のオブジェクトを検索
-    for (const auto& obj : m_spObjectList)
+    // 削除対象のオブジェクトの親子関係と名前の索引を先に解消しておく
+    for (const auto& obj : m_objects)
     {
         // オブジェクトが死亡予定かどうかを確認
         if (obj->GetState() != GameObject::State::eDead) { continue; }
 
         // 親が設定されている場合、親のリストから削除
-        if (auto parent = obj->GetParent())
+        // 破棄するのでワールド座標は保たない : 行列の計算を省き、親子付けの数だけ親を辿らないようにする
+        if (const std::shared_ptr<GameObject> parent = obj->GetParent())
         {
-            parent->RemoveParentChildRelation(obj); // 死亡予定のオブジェクトのみ親のリストから削除
+            parent->RemoveParentChildRelation(obj, false); // 死亡予定のオブジェクトのみ親のリストから削除
         }
 
-        // 削除予定のオブジェクトを一時リストに追加
-        objectsToDelete.push_back(obj);
+        // 名前の索引からも外しておく
+        EraseNameIndex(obj);
     }
 
-    // リストから削除する
-    for (const auto& obj : objectsToDelete)
-    {
-        m_spObjectList.remove(obj); // 死亡予定のオブジェクトをリストから削除
-    }
+    // 死亡予定のオブジェクトを1回の走査でまとめて詰める : 削除したオブジェクトを指すハンドルは無効になる
+    // 取り出したオブジェクトは破棄待ちのリストへ移し、フレームの終わりにまとめて破棄する
+    const size_t removedNum = m_objects.EraseIf([](const std::shared_ptr<GameObject>& obj)
+        {
+            return obj->GetState() == GameObject::State::eDead;
+        }, &m_pendingDestroyObjects);
+
+    // 取り除いたオブジェクトのコンポーネントを更新の配列から外す
+    if (removedNum > 0) { MarkTickListDirty(); }
+}
+
+void Scene::FlushDestroyedObjects()
+{
+    m_lastDestroyedObjectNum = static_cast<UINT32>(m_pendingDestroyObjects.size());
+
+    // 参照を手放し、デストラクタで Release とメモリの返却を行う : 確保した領域は次のフレームで使い回す
+    m_pendingDestroyObjects.clear();
+    m_pendingDestroyComps.clear();
 }
 
 void Scene::Init()
@@ -42,13 +56,13 @@ void Scene::Init()
 
 void Scene::Release()
 {
+    // 破棄待ちのオブジェクトはここでは破棄しない : 更新中の ChangeScene から呼ばれるため、
+    // このフレームの更新の配列が指すコンポーネントを SceneManager::PostDraw まで残しておく
+
     // Start のフラグを下げておく
-    for (auto&& obj : m_spObjectList)
+    for (auto&& obj : m_objects)
     {
-        for (auto&& comp : obj->GetComponents())
-        {
-            comp->DownStartFlg();
-        }
+        obj->DownStartFlg();
     }
 
     // デバッグビルドの場合シーンを保存するか確認
@@ -62,14 +76,17 @@ void Scene::Release()
 
 void Scene::Serialize(Json& json) const
 {
-    // シーンのライト情報をシリアライズ
-    ShaderManager::Instance().GetAmbientManager()->Serialize(json);
+    // シーンのライト情報をシリアライズ : シェーダーの初期化前 (描画を行わないテストなど) は省略する
+    if (const auto& upAmbientManager = ShaderManager::Instance().GetAmbientManager())
+    {
+        upAmbientManager->Serialize(json);
+    }
 
     Json& objectsJson = json[jsonKey::Key_Objects.data()];
     objectsJson = Json::array();  // JSON配列として初期化
 
     // オブジェクトを順番に配列に追加
-    for (auto&& obj : m_spObjectList)
+    for (auto&& obj : m_objects)
     {
         Json objJson;
         obj->Serialize(objJson);  // 各オブジェクトをシリアライズ
@@ -79,8 +96,11 @@ void Scene::Serialize(Json& json) const
 
 void Scene::Deserialize(const Json& json)
 {
-    // シーンのライト情報をシリアライズ
-    ShaderManager::Instance().GetAmbientManager()->Deserialize(json);
+    // シーンのライト情報をデシリアライズ : シェーダーの初期化前 (描画を行わないテストなど) は省略する
+    if (const auto& upAmbientManager = ShaderManager::Instance().GetAmbientManager())
+    {
+        upAmbientManager->Deserialize(json);
+    }
 
     const Json& objectsJson = json.at(jsonKey::Key_Objects.data());
 
@@ -91,14 +111,14 @@ void Scene::Deserialize(const Json& json)
         std::string objName = objJson.at(jsonKey::Object::Key_Name.data()).get<std::string>();
 
         // 新しいオブジェクトを作成し、名前を設定
-        const std::shared_ptr<GameObject>& obj = AddObject(GameObject::State::eActive, objName);
+        const std::shared_ptr<GameObject> obj = AddObject(GameObject::State::eActive, objName);
 
         // オブジェクトのデシリアライズ
         obj->Deserialize(objJson);
     }
 
     // Scene::Deserialize で、オブジェクトを全て復元した後に親子関係を設定
-    for (auto&& obj : m_spObjectList)
+    for (auto&& obj : m_objects)
     {
         const std::string& parentName = obj->GetParentName();
         if (!parentName.empty())
@@ -118,63 +138,223 @@ void Scene::Update()
     //----------------------
     // オブジェクトの更新
     //----------------------
-    m_isUpdatingObject = true;
+    // 更新中に追加されたオブジェクトは次のフレームから更新するため、ここで数を確定しておく
+    // 追加によって配列が再確保されても良いように、添え字で走査する
+    // Start の中で ClearObjList が呼ばれると数が減るので、毎回確認する
+    const size_t objectNum = m_objects.Size();
 
-    for (auto&& obj : m_spObjectList)
+    for (size_t i = 0; i < objectNum && i < m_objects.Size(); ++i)
     {
-        obj->Start();
+        m_objects[i]->Start();
     }
 
-    static int i = 0;
+    // Start で追加されたコンポーネントも含めて、更新の配列を確定する
+    if (m_isTickListDirty)
+    {
+        RebuildTickLists(objectNum);
+    }
 
-    // オブジェクトごとの更新
-    for (auto&& obj : m_spObjectList)
+    // フェーズごとにまとめて更新する : 並列に更新できるコンポーネントの Update は後でまとめて行う
+    for (UINT32 phase = 0; phase < ComponentTick::ePhaseNum; ++phase)
     {
-        obj->Update();
+        UpdateTickPhase(static_cast<ComponentTick::Phase>(phase));
     }
 
+    // 更新中に参照されずに残った行列を、親子順に1回の走査でまとめて計算する
+    // 以降は行列が変わらないので、並列更新中の行列の参照は読み込みだけになる
+    m_transformHierarchy.Update();
+
+    // ボックスの更新が終わったので、並列更新で読む視錐台カリングの結果をまとめて作る
+    CullingSystem::Instance().Execute();
+
+    UpdateParallelComponents();
+
     if (m_spImGuiUpdate)
     {
         m_spImGuiUpdate->Update();
     }
+}
 
-    m_isUpdatingObject = false;
+void Scene::RebuildTickLists(size_t objectNum)
+{
+    for (std::vector<BaseComponent*>& comps : m_tickComps)
+    {
+        comps.clear();
+    }
+    m_parallelComps.clear();
+
+    // Start で追加されたオブジェクトは Start が済んでいないので、このフレームの配列には並べない
+    const size_t tickObjectNum = std::min(objectNum, m_objects.Size());
 
-    // 保留中のオブジェクトがあれば、実際のオブジェクトリストに追加する
-    if (!m_spPendingObjectList.empty())
+    // オブジェクトの並び順 → オブジェクト内のコンポーネントの更新順に並べる
+    for (size_t i = 0; i < tickObjectNum; ++i)
     {
-        for (auto&& pending : m_spPendingObjectList)
+        const std::shared_ptr<GameObject>& spObj = m_objects[i];
+
+        for (const std::shared_ptr<BaseComponent>& spComp : spObj->GetComponents())
         {
-            const std::string& objName = GenerateUniqueName(m_spObjectList, pending->GetName());
-            pending->SetName(objName);
-            m_spObjectList.emplace_back(pending);
+            const ComponentTick::Mask& tickMask = spComp->GetTickMask();
+
+            for (UINT32 phase = 0; phase < ComponentTick::ePhaseNum; ++phase)
+            {
+                if (!tickMask.test(phase)) { continue; }
+
+                // 並列に更新できるコンポーネントの Update は、並列更新フェーズの配列に並べる
+                if (phase == ComponentTick::eUpdate && m_isParallelUpdate && spComp->GetUpdateAccess().IsParallel)
+                {
+                    m_parallelComps.push_back(spComp.get());
+                    continue;
+                }
+
+                m_tickComps[phase].push_back(spComp.get());
+            }
         }
-        m_spPendingObjectList.clear();
     }
+
+    // 並べなかったオブジェクトがある場合は、次のフレームでもう一度作り直す
+    m_isTickListDirty = tickObjectNum < m_objects.Size();
 }
 
-std::shared_ptr<GameObject> Scene::AddObject(GameObject::State eState, std::string_view name)
+void Scene::UpdateTickPhase(ComponentTick::Phase phase)
 {
-    // オブジェクトを生成
-    auto obj = std::make_shared<GameObject>(shared_from_this(), eState);
+    // フェーズごとに呼び出す関数
+    static constexpr void (BaseComponent::*PhaseFuncs[ComponentTick::ePhaseNum])() =
+    {
+        &BaseComponent::PreUpdate,
+        &BaseComponent::Update,
+        &BaseComponent::UpdateWorldTransform,
+        &BaseComponent::PostUpdate,
+    };
 
-    // 初期化をして置く
-    obj->Init();
+    const auto phaseFunc = PhaseFuncs[phase];
 
-    // オブジェクトが更新中なら待機リストの方に追加する
-    if (m_isUpdatingObject)
+    // 有効 / 無効や状態は更新中にも切り替わるので、配列には含めたまま呼び出す直前に確認する
+    // 更新中に外されたコンポーネントや取り除かれたオブジェクトは、フレームの終わりまで破棄されないので指す先は有効
+    for (BaseComponent* pComp : m_tickComps[phase])
     {
-        const std::string& objName = GenerateUniqueName(m_spObjectList, name);
-        obj->SetName(objName);
-        m_spPendingObjectList.emplace_back(obj);
+        if (pComp->IsRemoved()) { continue; }
+        if (!pComp->IsEnable()) { continue; }
+        if (pComp->GetOwnerPtr()->GetState() != GameObject::State::eActive) { continue; }
+
+        (pComp->*phaseFunc)();
     }
-    else
+}
+
+void Scene::UpdateParallelComponents()
+{
+    m_parallelComponentNum = 0;
+    m_parallelLevelNum = 0;
+
+    if (m_parallelComps.empty()) { return; }
+
+    //x--- 型IDごとに分ける ---x//
+    for (BaseComponent* pComp : m_parallelComps)
+    {
+        if (pComp->IsRemoved()) { continue; }
+        if (!pComp->IsEnable()) { continue; }
+        if (pComp->GetOwnerPtr()->GetState() != GameObject::State::eActive) { continue; }
+
+        ++m_parallelComponentNum;
+
+        const ComponentTypeID::IDType typeID = pComp->GetComponentTypeID();
+
+        // 型IDの上限を超えたコンポーネントはまとめられないので、その場で更新する
+        if (typeID >= ComponentTypeID::MaxTypeNum)
+        {
+            pComp->Update();
+            continue;
+        }
+
+        m_parallelCompsByType[typeID].push_back(pComp);
+    }
+
+    //x--- 衝突しない型同士が同じ段になるように、型ごとの段を決める ---x//
+    // 段が早い型から順に割り当てるので、衝突する型のうち最も遅い段の次になる
+    std::array<UINT32, ComponentTypeID::MaxTypeNum> typeLevels = {};
+    std::vector<ComponentTypeID::IDType> usedTypeIDs;
+
+    for (ComponentTypeID::IDType typeID = 0; typeID < ComponentTypeID::MaxTypeNum; ++typeID)
+    {
+        if (m_parallelCompsByType[typeID].empty()) { continue; }
+
+        // 同じ型は同じ宣言なので、先頭のコンポーネントの宣言を代表にする
+        const ComponentAccess& access = m_parallelCompsByType[typeID].front()->GetUpdateAccess();
+
+        UINT32 level = 0;
+        for (ComponentTypeID::IDType otherID : usedTypeIDs)
+        {
+            const ComponentAccess& otherAccess = m_parallelCompsByType[otherID].front()->GetUpdateAccess();
+
+            if (access.IsConflict(otherAccess))
+            {
+                level = std::max(level, typeLevels[otherID] + 1);
+            }
+        }
+
+        typeLevels[typeID] = level;
+        usedTypeIDs.push_back(typeID);
+
+        m_parallelLevelNum = std::max(m_parallelLevelNum, level + 1);
+    }
+
+    //x--- 段ごとに並列に更新する ---x//
+    // ワーカースレッドから書き込まれるバッファを、スレッド数に合わせて確保しておく
+    Renderer::Instance().PrepareThreadBuffers();
+    const std::unique_ptr<DebugWire>& upDebugWire = SceneManager::Instance().GetDebugWire();
+    if (upDebugWire) { upDebugWire->PrepareThreadVertices(); }
+
+    for (UINT32 level = 0; level < m_parallelLevelNum; ++level)
     {
-        const std::string& objName = GenerateUniqueName(m_spObjectList, name);
-        obj->SetName(objName);
-        m_spObjectList.emplace_back(obj);
+        m_parallelLevelComps.clear();
+
+        for (ComponentTypeID::IDType typeID : usedTypeIDs)
+        {
+            if (typeLevels[typeID] != level) { continue; }
+
+            std::vector<BaseComponent*>& comps = m_parallelCompsByType[typeID];
+            m_parallelLevelComps.insert(m_parallelLevelComps.end(), comps.begin(), comps.end());
+        }
+
+        JobSystem::Instance().ParallelFor(static_cast<UINT32>(m_parallelLevelComps.size()), 0,
+            [this](UINT32 begin, UINT32 end)
+            {
+                for (UINT32 i = begin; i < end; ++i)
+                {
+                    m_parallelLevelComps[i]->Update();
+                }
+            });
+    }
+
+    for (ComponentTypeID::IDType typeID : usedTypeIDs)
+    {
+        m_parallelCompsByType[typeID].clear();
     }
 
+    //x--- スレッドごとのバッファをまとめる ---x//
+    Renderer::Instance().MergeThreadBuffers();
+    if (upDebugWire) { upDebugWire->MergeThreadVertices(); }
+}
+
+std::shared_ptr<GameObject> Scene::AddObject(GameObject::State eState, std::string_view name)
+{
+    // オブジェクトを生成 : シーンのプールから確保し、オブジェクト同士を連続したメモリに並べる
+    auto obj = std::allocate_shared<GameObject>(
+        utl::PoolAllocator<GameObject>(m_spPoolArena, ComponentPool::GameObjectPoolIndex),
+        shared_from_this(), eState);
+
+    // Init で追加されるコンポーネントもプールから確保するので、先に設定しておく
+    obj->m_spPoolArena = m_spPoolArena;
+
+    // 初期化をして置く
+    obj->Init();
+
+    // 名前の索引とオブジェクトの SlotMap に登録する
+    const std::string& objName = GenerateUniqueName(name);
+    obj->SetName(objName);
+    m_umNameToObject.emplace(objName, obj);
+
+    obj->m_handle = m_objects.Insert(obj);
+
     return obj;
 }
 
@@ -197,92 +377,109 @@ void Scene::AddObjectImGui()
     utl::ImGuiHelper::InputTextWithString("###ObjectName", m_generateObjectName);
 }
 
+std::shared_ptr<GameObject> Scene::ResolveObject(const GameObjectHandle& handle) const
+{
+    const std::shared_ptr<GameObject>* pObj = m_objects.Get(handle);
+
+    return pObj ? *pObj : nullptr;
+}
+
+GameObject* Scene::ResolveObjectPtr(const GameObjectHandle& handle) const
+{
+    const std::shared_ptr<GameObject>* pObj = m_objects.Get(handle);
+
+    return pObj ? pObj->get() : nullptr;
+}
+
 std::shared_ptr<GameObject> Scene::FindObject(std::string_view name)
 {
     // オブジェクトの名前に基づいて検索をする
-    auto it = std::find_if(m_spObjectList.begin(), m_spObjectList.end(),
-        [&](const std::shared_ptr<GameObject>& obj)
-        {
-            return obj->GetName() == name;
-        });
+    auto it = m_umNameToObject.find(std::string(name));
 
     // 見つからなかった場合はnullptrを返す
-    if (it == m_spObjectList.end())
+    if (it == m_umNameToObject.end())
     {
         FNENG_ASSERT_LOG("オブジェクトが見つかりませんでした", false)
             return nullptr;
     }
 
-    return *it;
+    return it->second;
 }
 
-std::string Scene::GenerateUniqueName(
-    const std::list<std::shared_ptr<GameObject>>& container,
-    std::string_view baseName)
+std::string Scene::GenerateUniqueName(std::string_view baseName)
 {
-    std::string name = baseName.data(); // 基本となる名前
-    int num = 0;
+    std::string name(baseName); // 基本となる名前
 
-    // todo | hack : 線形探索によるチェックなので、コンテナが大きくなると遅くなるため注意
-    // 名前が重複していたら番号をずらす
-    for (const auto& obj : container)
-    {
-        if (obj->GetName() != name) { continue; }
+    // 重複していなければそのまま利用する
+    if (!m_umNameToObject.contains(name)) { return name; }
 
-        name = baseName.data() + std::to_string(num);
+    // 基本名ごとの連番から重複しない番号を探す
+    // 連番は戻さないので、同じ基本名で何度生成しても探索は償却 O(1) になる
+    int& num = m_umBaseNameToCount[name];
+    do
+    {
+        name = std::string(baseName) + std::to_string(num);
         num++;
-    }
+    } while (m_umNameToObject.contains(name));
 
     return name;
 }
 
 bool Scene::ChangeObjectName(
-    std::list<std::shared_ptr<GameObject>>& container,
     std::string_view oldName,
     std::string_view newName,
     bool isRename)
 {
     // 名前を基にオブジェクトを検索
-    auto it = std::find_if(container.begin(), container.end(),
-        [&](const std::shared_ptr<GameObject>& obj)
-        {
-            return obj->GetName() == oldName; // BaseObjectのGetNameを使用
-        });
+    auto it = m_umNameToObject.find(std::string(oldName));
 
     // 未登録の場合は失敗
-    if (it == container.end())
+    if (it == m_umNameToObject.end())
     {
         FNENG_ASSERT_LOG("コンテナ内に登録されていません", false)
             return false;
     }
 
+    // 同じ名前への変更は何もしない
+    if (oldName == newName) { return true; }
+
     std::string uniqueNewName;
 
     if (isRename)
     {
         // 名前が重複していたら番号をずらす
-        uniqueNewName = GenerateUniqueName(container, newName);
+        uniqueNewName = GenerateUniqueName(newName);
     }
     else
     {
         // 新しい名前が既に存在するか確認
-        auto newIt = std::find_if(container.begin(), container.end(),
-            [&](const std::shared_ptr<GameObject>& obj)
-            {
-                return obj->GetName() == newName;
-            });
-
-        if (newIt != container.end())
+        if (m_umNameToObject.contains(std::string(newName)))
         {
             FNENG_ASSERT_LOG("新しい名前が既に存在します\n追加したい場合は引数 : isRenameをtrueにしてください", false)
                 return false;
         }
 
-        uniqueNewName = newName.data(); // 重複していなければそのまま新しい名前を使用
+        uniqueNewName = newName; // 重複していなければそのまま新しい名前を使用
     }
 
-    // オブジェクトの名前を新しい名前に変更
-    (*it)->SetName(uniqueNewName);
+    // 索引を付け替えてからオブジェクトの名前を新しい名前に変更
+    std::shared_ptr<GameObject> spObj = std::move(it->second);
+    m_umNameToObject.erase(it);
+
+    spObj->SetName(uniqueNewName);
+    m_umNameToObject.emplace(uniqueNewName, std::move(spObj));
 
     return true;
 }
+
+void Scene::EraseNameIndex(const std::shared_ptr<GameObject>& spObj)
+{
+    auto it = m_umNameToObject.find(spObj->GetName());
+
+    if (it == m_umNameToObject.end()) { return; }
+
+    // 同名の別オブジェクトを消さないように、ポインタが一致する場合のみ外す
+    if (it->second != spObj) { return; }
+
+    m_umNameToObject.erase(it);
+}
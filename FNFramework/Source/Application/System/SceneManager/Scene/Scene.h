@@ -12,6 +12,8 @@ class Camera;
 
 #include "Framework/System/ImGui/ImGuiUpdate/ImGuiUpdate.h"
 
+#include "TransformHierarchy/TransformHierarchy.h"
+
 /**
 * @class Scene
 * @brief シーン基底クラス
@@ -56,6 +58,23 @@ public:
     /* @brief 解放 */
     void Release();
 
+    /**
+    * @brief 破棄待ちのオブジェクトをまとめて破棄する
+    * @details
+    *   PreUpdate で取り除いたオブジェクトは描画が終わるまで残し、フレームの終わりにここで破棄する
+    *   更新中に外されたコンポーネントや、ClearObjList で取り除いたオブジェクトもここで破棄する
+    */
+    void FlushDestroyedObjects();
+
+    /**
+    * @brief 外したコンポーネントを、フレームの終わりまで破棄せずに残す
+    * @details 更新の配列はコンポーネントの生ポインタを持つので、更新中に外されても同じフレームの間は指す先を残しておく
+    */
+    void DeferDestroyComponent(std::shared_ptr<BaseComponent>&& spComp)
+    {
+        m_pendingDestroyComps.push_back(std::move(spComp));
+    }
+
     /**
      * @fn virtual void Serialize(JsonWrapper& json) const
      * @brief シリアライズ
@@ -76,7 +95,76 @@ public:
     void Deserialize(const Json& json);
 
 
-    std::list<std::shared_ptr<GameObject>>& GetObjectList() { return m_spObjectList; }
+    /* @brief オブジェクトの一覧取得 : 追加順に隙間なく並んでいる */
+    const std::vector<std::shared_ptr<GameObject>>& GetObjectList() const { return m_objects.GetDense(); }
+
+    /**
+    * @brief ハンドルからオブジェクトを取得する
+    * @details SlotMap の中身は AddObject で再確保されるため、中身への参照ではなく値で返す
+    * @param[in] handle - 解決したいハンドル
+    * @return ハンドルが指すオブジェクト : 削除済みなど無効なハンドルの場合は空のポインタ
+    */
+    std::shared_ptr<GameObject> ResolveObject(const GameObjectHandle& handle) const;
+
+    /**
+    * @brief ハンドルからオブジェクトの生ポインタを取得する : 参照カウントを操作しないので毎フレームの処理ではこちらを使う
+    * @details オブジェクトは削除されるまで同じ場所にあるので、ポインタは AddObject をまたいでも有効
+    * @param[in] handle - 解決したいハンドル
+    * @return ハンドルが指すオブジェクト : 無効なハンドルの場合は nullptr
+    */
+    GameObject* ResolveObjectPtr(const GameObjectHandle& handle) const;
+
+    /* @brief シーン内の TransformComponent の行列をまとめて管理するクラスの取得 */
+    TransformHierarchy& WorkTransformHierarchy() { return m_transformHierarchy; }
+    const TransformHierarchy& GetTransformHierarchy() const { return m_transformHierarchy; }
+
+    //x--- 並列更新 ---x//
+    /* @brief 並列に更新できるコンポーネントを JobSystem でまとめて更新するか */
+    bool IsParallelUpdate() const { return m_isParallelUpdate; }
+    void SetParallelUpdate(bool isParallel)
+    {
+        if (m_isParallelUpdate == isParallel) { return; }
+
+        m_isParallelUpdate = isParallel;
+        // 並列更新フェーズに回すかどうかが変わるので、更新の配列を作り直す
+        MarkTickListDirty();
+    }
+
+    /* @brief 前回の並列更新フェーズで更新したコンポーネント数 */
+    UINT32 GetParallelComponentNum() const { return m_parallelComponentNum; }
+    /* @brief 前回の並列更新フェーズの段数 : 同時に更新できない型の組み合わせがあると増える */
+    UINT32 GetParallelLevelNum() const { return m_parallelLevelNum; }
+
+    //x--- フェーズごとの更新 ---x//
+    /* @brief コンポーネントの構成が変わった時に呼び、次の更新の前に更新の配列を作り直させる */
+    void MarkTickListDirty() { m_isTickListDirty = true; }
+
+    /* @brief フェーズごとに更新するコンポーネント数 : 並列更新フェーズに回す Update は含まない */
+    UINT32 GetTickComponentNum(ComponentTick::Phase phase) const { return static_cast<UINT32>(m_tickComps[phase].size()); }
+
+    /* @brief 前のフレームの終わりに破棄したオブジェクトの数 */
+    UINT32 GetLastDestroyedObjectNum() const { return m_lastDestroyedObjectNum; }
+
+    /* @brief オブジェクトとコンポーネントを確保するプールの取得 */
+    const utl::PoolArena& GetPoolArena() const { return *m_spPoolArena; }
+
+    /* @brief ハンドルが有効なオブジェクトを指しているか */
+    bool IsValidObject(const GameObjectHandle& handle) const { return m_objects.IsValid(handle); }
+
+    /**
+    * @brief ハンドルからコンポーネントを取得する
+    * @param[in] handle - 解決したいハンドル
+    * @return ハンドルが指すコンポーネント : 無効なハンドルの場合は nullptr
+    */
+    template <typename CompType>
+    CompType* ResolveComponent(const ComponentHandle<CompType>& handle) const
+    {
+        const GameObject* pOwner = ResolveObjectPtr(handle.Owner);
+
+        if (!pOwner) { return nullptr; }
+
+        return pOwner->GetComponentPtr<CompType>();
+    }
 
     /**
     * @brief オブジェクトの追加
@@ -87,10 +175,23 @@ public:
     std::shared_ptr<GameObject> AddObject(GameObject::State eState = GameObject::State::eActive,
                                           std::string_view name = "BaseObj");
 
+    /**
+    * @brief すべてのオブジェクトを取り除く
+    * @details 更新中 (ChangeScene で同じシーンを読み直す場合など) に呼ばれても良いように、破棄はフレームの終わりまで遅らせる
+    */
     void ClearObjList()
     {
-        m_spObjectList.clear();
-        m_spPendingObjectList.clear();
+        // 残りの更新で呼び出されないように、死亡状態にしてから取り除く
+        for (const auto& obj : m_objects)
+        {
+            obj->SetState(GameObject::State::eDead);
+        }
+        m_objects.EraseIf([](const std::shared_ptr<GameObject>&) { return true; }, &m_pendingDestroyObjects);
+
+        m_umNameToObject.clear();
+        m_umBaseNameToCount.clear();
+
+        MarkTickListDirty();
     }
 
     void AddObjectImGui();
@@ -103,24 +204,22 @@ public:
     std::shared_ptr<GameObject> FindObject(std::string_view name);
 
     /**
-      * @brief コンテナ内にすでにある名前と被らない名前を生成する
-      * @param[in] container - 名前が被らないか確認したいコンテナ
+      * @brief シーン内にすでにある名前と被らない名前を生成する
+      * @details
+      *     名前の索引と基本名ごとの連番を利用するため、オブジェクト数に依存せずに生成できる
       * @param[in] baseName  - 基本となる名前
       * @return 生成した名前
       */
-    static std::string GenerateUniqueName(const std::list<std::shared_ptr<GameObject>>& container, std::string_view baseName);
+    std::string GenerateUniqueName(std::string_view baseName);
 
     /**
-      * @brief コンテナ内のオブジェクトの名前を変更する
-      * @brief ※新しくメモリ確保するので、更新頻度が高い場合は注意が必要
-      * @param[in] container  - 名前を変更したいコンテナ
+      * @brief シーン内のオブジェクトの名前を変更する
       * @param[in] oldName    - 変更前の名前
       * @param[in] newName    - 変更後の名前
+      * @param[in] isRename   - 名前が重複していた場合に番号をずらすかどうか
       * @return 名前の変更に成功したらtrue
-      *
       */
-    static bool ChangeObjectName(
-        std::list<std::shared_ptr<GameObject>>& container,
+    bool ChangeObjectName(
         std::string_view oldName,
         std::string_view newName,
         bool isRename);
@@ -133,14 +232,83 @@ private:
     //------------------
     // オブジェクト管理
     //------------------
-    // 実際にメインフレームで処理を行うオブジェクトリスト
-    // key : オブジェクトの名前 - value : オブジェクトのポインタ
-    std::list<std::shared_ptr<GameObject>> m_spObjectList;
-    // 変更などがあった場合の変更を保存するためのオブジェクトリスト
+    // オブジェクトとコンポーネントを確保するプール
+    // - 種類ごとにチャンクを分けるので、同じ型同士が連続したメモリに並ぶ
+    // - 確保したブロックが参照しているため、シーンが破棄されてもブロックがすべて返却されるまでは残る
+    //   返却後はチャンク単位でまとめて解放される
+    std::shared_ptr<utl::PoolArena> m_spPoolArena = std::make_shared<utl::PoolArena>();
+
+    // TransformComponent の行列を親子順にまとめて管理する
+    // オブジェクトの破棄時に登録解除されるので、オブジェクトより先に宣言して後に破棄されるようにする
+    TransformHierarchy m_transformHierarchy;
+
+    // 実際にメインフレームで処理を行うオブジェクト
+    // - 追加順に隙間なく並んでいるため、走査はキャッシュ効率が良い
+    // - ほかのオブジェクトからは GameObjectHandle で参照する
+    utl::SlotMap<std::shared_ptr<GameObject>, GameObject> m_objects;
+
+    // 名前からオブジェクトを引くための索引
     // key : オブジェクトの名前 - value : オブジェクトのポインタ
-    std::list<std::shared_ptr<GameObject>> m_spPendingObjectList;
-    // 更新中かどうか
-    bool m_isUpdatingObject = false;
+    std::unordered_map<std::string, std::shared_ptr<GameObject>> m_umNameToObject;
+    // 基本名ごとに次に試す連番 : GenerateUniqueName で利用する
+    // key : 基本となる名前 - value : 次に付ける番号
+    std::unordered_map<std::string, int> m_umBaseNameToCount;
+
+    /* @brief 索引からオブジェクトを外す : 同名の別オブジェクトが登録されている場合は何もしない */
+    void EraseNameIndex(const std::shared_ptr<GameObject>& spObj);
+
+    // 取り除いた後、フレームの終わりに破棄するオブジェクト
+    // 確保した領域はフレームをまたいで使い回すので、生成と破棄が続いてもヒープからの確保は起こらない
+    std::vector<std::shared_ptr<GameObject>> m_pendingDestroyObjects;
+    UINT32 m_lastDestroyedObjectNum = 0;
+    // 更新中に外され、フレームの終わりに破棄するコンポーネント
+    std::vector<std::shared_ptr<BaseComponent>> m_pendingDestroyComps;
+
+    //------------------
+    // フェーズごとの更新
+    //------------------
+    /**
+    * @brief フェーズごとに更新するコンポーネントの配列を作り直す
+    * @details
+    *   - オブジェクトの並び順、オブジェクト内のコンポーネントの更新順に並べる
+    *   - オーバーライドしていないフェーズには並べないので、何もしないコンポーネントは走査されない
+    *   - 構成が変わったフレームの次の更新の前にだけ行う
+    * @param[in] objectNum - 並べるオブジェクト数 : このフレームで更新する先頭からの数で、以降に追加されたものは次のフレームに回す
+    */
+    void RebuildTickLists(size_t objectNum);
+
+    /* @brief 1つのフェーズのコンポーネントをまとめて更新する */
+    void UpdateTickPhase(ComponentTick::Phase phase);
+
+    // フェーズごとに更新するコンポーネント : 無効なコンポーネントや、アクティブでないオブジェクトのものも含む
+    std::array<std::vector<BaseComponent*>, ComponentTick::ePhaseNum> m_tickComps;
+    bool m_isTickListDirty = true;
+
+    //------------------
+    // 並列更新
+    //------------------
+    /**
+    * @brief 並列に更新できるコンポーネントの更新
+    * @details
+    *   - 型ごとにまとめ、アクセス宣言が衝突しない型同士を同じ段にする
+    *   - 段ごとに JobSystem で並列に更新し、すべて終わってから次の段へ進む
+    *   - Renderer / DebugWire へはスレッドごとのバッファに書き込み、最後にまとめる
+    */
+    void UpdateParallelComponents();
+
+    // 並列に更新できるコンポーネントを、型IDごとにまとめて更新する
+    bool m_isParallelUpdate = true;
+
+    // 並列に更新するコンポーネント : RebuildTickLists で Update の配列の代わりに並べる
+    std::vector<BaseComponent*> m_parallelComps;
+    // 型IDごとに分けたコンポーネント : 確保した領域はフレームをまたいで使い回す
+    std::array<std::vector<BaseComponent*>, ComponentTypeID::MaxTypeNum> m_parallelCompsByType;
+    // 1つの段で同時に更新するコンポーネント
+    std::vector<BaseComponent*> m_parallelLevelComps;
+
+    //x--- デバッグ表示用 ---x//
+    UINT32 m_parallelComponentNum = 0;
+    UINT32 m_parallelLevelNum = 0;
 
     std::string m_generateObjectName;
 
@@ -0,0 +1,332 @@
+﻿#include "TransformHierarchy.h"
+
+#include "Application/Component/TransformComponent/TransformComponent.h"
+
+UINT32 TransformHierarchy::Register(TransformComponent* pNode)
+{
+    // 親を持たないノードは末尾に追加しても親子順が崩れないので、並び替えは不要
+    const UINT32 nodeIndex = static_cast<UINT32>(m_nodes.size());
+
+    m_nodes.push_back(pNode);
+    m_parents.push_back(InvalidIndex);
+    m_subtreeSizes.push_back(1);
+
+    m_mLocals.emplace_back(Math::Matrix::Identity);
+    m_mWorlds.emplace_back(Math::Matrix::Identity);
+    m_mInvWorlds.emplace_back(Math::Matrix::Identity);
+
+    m_dirtyFlags.push_back(1);
+
+    return nodeIndex;
+}
+
+void TransformHierarchy::Unregister(UINT32 nodeIndex)
+{
+    if (nodeIndex >= m_nodes.size()) { return; }
+
+    m_nodes[nodeIndex] = nullptr;
+
+    // 子孫の親子関係と配列の詰め直しは並び替えの時にまとめて行う
+    m_isOrderDirty = true;
+}
+
+void TransformHierarchy::MarkDirty(UINT32 nodeIndex)
+{
+    // すでにダーティなら子孫もダーティになっている
+    if (m_dirtyFlags[nodeIndex]) { return; }
+
+    // 並び替え前は子孫の範囲が信用できないので、自身だけ立てて並び替え時に伝播させる
+    if (m_isOrderDirty)
+    {
+        m_dirtyFlags[nodeIndex] = 1;
+        return;
+    }
+
+    // 子孫は直後に連続して並んでいるので、範囲をまとめて立てる
+    std::fill_n(m_dirtyFlags.begin() + nodeIndex, m_subtreeSizes[nodeIndex], static_cast<UINT8>(1));
+}
+
+const Math::Matrix& TransformHierarchy::GetLocalMatrix(UINT32 nodeIndex)
+{
+    nodeIndex = ResolveNode(nodeIndex);
+    return m_mLocals[nodeIndex];
+}
+
+const Math::Matrix& TransformHierarchy::GetWorldMatrix(UINT32 nodeIndex)
+{
+    nodeIndex = ResolveNode(nodeIndex);
+    return m_mWorlds[nodeIndex];
+}
+
+const Math::Matrix& TransformHierarchy::GetInvWorldMatrix(UINT32 nodeIndex)
+{
+    nodeIndex = ResolveNode(nodeIndex);
+    return m_mInvWorlds[nodeIndex];
+}
+
+const Math::Matrix& TransformHierarchy::GetParentInvWorldMatrix(UINT32 nodeIndex)
+{
+    // 自身は計算せず、親の番号だけ取る : 並び替え前は配列上の親が古いので GameObject から取る
+    const UINT32 parentIndex = m_isOrderDirty ? FindParentIndex(nodeIndex) : m_parents[nodeIndex];
+
+    if (parentIndex == InvalidIndex) { return Math::Matrix::Identity; }
+
+    return m_mInvWorlds[ResolveNode(parentIndex)];
+}
+
+void TransformHierarchy::Update()
+{
+    if (m_isOrderDirty)
+    {
+        RebuildOrder();
+    }
+
+    // 親は必ず前にあるので、先頭から順に計算すれば親はすでに計算済み
+    for (UINT32 i = 0; i < m_nodes.size(); ++i)
+    {
+        if (!m_dirtyFlags[i]) { continue; }
+
+        CalcNode(i);
+    }
+
+    m_lastUpdatedNodeNum = m_updatedNodeNum;
+    m_updatedNodeNum = 0;
+}
+
+void TransformHierarchy::RebuildOrder()
+{
+    m_isOrderDirty = false;
+    ++m_rebuildOrderNum;
+
+    const UINT32 oldNum = static_cast<UINT32>(m_nodes.size());
+
+    //x--- 現在の親子関係を読み直す ---x//
+    // 親のノード番号 : 古い番号で表す
+    std::vector<UINT32> oldParents(oldNum, InvalidIndex);
+
+    for (UINT32 i = 0; i < oldNum; ++i)
+    {
+        oldParents[i] = FindParentIndex(i);
+    }
+
+    //x--- 子の一覧を作成 : 親ごとに子を連続して並べる ---x//
+    std::vector<UINT32> childBegins(oldNum + 1, 0);
+    for (UINT32 i = 0; i < oldNum; ++i)
+    {
+        if (oldParents[i] != InvalidIndex) { ++childBegins[oldParents[i] + 1]; }
+    }
+    for (UINT32 i = 0; i < oldNum; ++i)
+    {
+        childBegins[i + 1] += childBegins[i];
+    }
+
+    std::vector<UINT32> children(childBegins[oldNum]);
+    {
+        std::vector<UINT32> writePos(childBegins.begin(), childBegins.end() - 1);
+        for (UINT32 i = 0; i < oldNum; ++i)
+        {
+            if (oldParents[i] != InvalidIndex) { children[writePos[oldParents[i]]++] = i; }
+        }
+    }
+
+    //x--- 深さ優先順に並べる ---x//
+    std::vector<UINT32> order;
+    order.reserve(oldNum);
+
+    std::vector<UINT8> visited(oldNum, 0);
+    std::vector<UINT32> stack;
+
+    auto visitTree = [&](UINT32 rootIndex)
+        {
+            stack.push_back(rootIndex);
+
+            while (!stack.empty())
+            {
+                const UINT32 index = stack.back();
+                stack.pop_back();
+
+                if (visited[index]) { continue; }
+                visited[index] = 1;
+
+                if (m_nodes[index]) { order.push_back(index); }
+
+                // 元の順番で取り出されるように逆順に積む
+                for (UINT32 c = childBegins[index + 1]; c > childBegins[index]; --c)
+                {
+                    stack.push_back(children[c - 1]);
+                }
+            }
+        };
+
+    for (UINT32 i = 0; i < oldNum; ++i)
+    {
+        if (oldParents[i] == InvalidIndex) { visitTree(i); }
+    }
+
+    // 親子関係が循環している場合などで辿れなかったノードは、親を持たないノードとして扱う
+    for (UINT32 i = 0; i < oldNum; ++i)
+    {
+        if (visited[i]) { continue; }
+
+        oldParents[i] = InvalidIndex;
+        visitTree(i);
+    }
+
+    //x--- 新しい順番で詰め直す ---x//
+    std::vector<UINT32> oldToNew(oldNum, InvalidIndex);
+    for (UINT32 newIndex = 0; newIndex < order.size(); ++newIndex)
+    {
+        oldToNew[order[newIndex]] = newIndex;
+    }
+
+    const UINT32 newNum = static_cast<UINT32>(order.size());
+
+    std::vector<TransformComponent*> nodes(newNum);
+    std::vector<UINT32> parents(newNum, InvalidIndex);
+    std::vector<UINT32> subtreeSizes(newNum, 1);
+    std::vector<Math::Matrix> mLocals(newNum);
+    std::vector<Math::Matrix> mWorlds(newNum);
+    std::vector<Math::Matrix> mInvWorlds(newNum);
+    std::vector<UINT8> dirtyFlags(newNum, 0);
+
+    for (UINT32 newIndex = 0; newIndex < newNum; ++newIndex)
+    {
+        const UINT32 oldIndex = order[newIndex];
+        const UINT32 oldParent = oldParents[oldIndex];
+        const UINT32 newParent = oldParent != InvalidIndex ? oldToNew[oldParent] : InvalidIndex;
+
+        nodes[newIndex] = m_nodes[oldIndex];
+        parents[newIndex] = newParent;
+        mLocals[newIndex] = m_mLocals[oldIndex];
+        mWorlds[newIndex] = m_mWorlds[oldIndex];
+        mInvWorlds[newIndex] = m_mInvWorlds[oldIndex];
+
+        // 親が変わったノードはワールド行列を計算し直す
+        const bool isParentChanged = m_parents[oldIndex] == InvalidIndex ?
+            newParent != InvalidIndex :
+            newParent == InvalidIndex || m_nodes[m_parents[oldIndex]] != m_nodes[oldParent];
+
+        dirtyFlags[newIndex] = m_dirtyFlags[oldIndex] || isParentChanged;
+
+        // 親がダーティなら子孫もダーティにする : 親は必ず前にあるので順に伝播できる
+        if (newParent != InvalidIndex && dirtyFlags[newParent]) { dirtyFlags[newIndex] = 1; }
+
+        nodes[newIndex]->m_nodeIndex = newIndex;
+    }
+
+    // 子孫の数を後ろから親へ足し込む
+    for (UINT32 newIndex = newNum; newIndex > 0; --newIndex)
+    {
+        const UINT32 parentIndex = parents[newIndex - 1];
+
+        if (parentIndex != InvalidIndex) { subtreeSizes[parentIndex] += subtreeSizes[newIndex - 1]; }
+    }
+
+    m_nodes = std::move(nodes);
+    m_parents = std::move(parents);
+    m_subtreeSizes = std::move(subtreeSizes);
+    m_mLocals = std::move(mLocals);
+    m_mWorlds = std::move(mWorlds);
+    m_mInvWorlds = std::move(mInvWorlds);
+    m_dirtyFlags = std::move(dirtyFlags);
+}
+
+UINT32 TransformHierarchy::FindParentIndex(UINT32 nodeIndex) const
+{
+    const TransformComponent* pNode = m_nodes[nodeIndex];
+
+    if (!pNode) { return InvalidIndex; }
+
+    const GameObject* pParent = pNode->GetOwnerPtr()->GetParentPtr();
+
+    if (!pParent) { return InvalidIndex; }
+
+    const TransformComponent* pParentNode = pParent->GetComponentPtr<TransformComponent>();
+
+    if (!pParentNode || pParentNode->m_pHierarchy != this) { return InvalidIndex; }
+
+    return pParentNode->m_nodeIndex;
+}
+
+UINT32 TransformHierarchy::ResolveNode(UINT32 nodeIndex)
+{
+    // 親子関係の変更のたびに並び替えると読み込み時などに O(親子付けの数 × ノード数) になるので、
+    // 並び替えは Update に任せて、ここでは祖先を辿って計算する
+    if (m_isOrderDirty)
+    {
+        CalcNodeWithoutOrder(nodeIndex);
+        return nodeIndex;
+    }
+
+    if (!m_dirtyFlags[nodeIndex]) { return nodeIndex; }
+
+    // 祖先から順に計算する : ダーティでないノードの祖先はダーティではない
+    const UINT32 parentIndex = m_parents[nodeIndex];
+
+    if (parentIndex != InvalidIndex)
+    {
+        ResolveNode(parentIndex);
+    }
+
+    CalcNode(nodeIndex);
+
+    return nodeIndex;
+}
+
+void TransformHierarchy::CalcNode(UINT32 nodeIndex)
+{
+    TransformComponent* pNode = m_nodes[nodeIndex];
+
+    // TRS が変わっている場合のみローカル行列を作り直す
+    if (pNode->m_isCalcMatrix)
+    {
+        m_mLocals[nodeIndex] = pNode->CalcLocalMatrix();
+    }
+
+    const UINT32 parentIndex = m_parents[nodeIndex];
+
+    if (parentIndex != InvalidIndex)
+    {
+        m_mWorlds[nodeIndex] = m_mLocals[nodeIndex] * m_mWorlds[parentIndex];
+    }
+    else
+    {
+        m_mWorlds[nodeIndex] = m_mLocals[nodeIndex];
+    }
+
+    m_mInvWorlds[nodeIndex] = m_mWorlds[nodeIndex].Invert();
+
+    m_dirtyFlags[nodeIndex] = 0;
+    ++m_updatedNodeNum;
+}
+
+void TransformHierarchy::CalcNodeWithoutOrder(UINT32 nodeIndex)
+{
+    //x--- 根までの祖先を集める : 循環していても止まるようにノード数で打ち切る ---x//
+    m_chainIndices.clear();
+
+    for (UINT32 index = nodeIndex; index != InvalidIndex && m_chainIndices.size() < m_nodes.size();
+        index = FindParentIndex(index))
+    {
+        m_chainIndices.push_back(index);
+    }
+
+    //x--- 根から順に計算する ---x//
+    const Math::Matrix* pParentWorld = nullptr;
+
+    for (auto it = m_chainIndices.rbegin(); it != m_chainIndices.rend(); ++it)
+    {
+        const UINT32 index = *it;
+        TransformComponent* pNode = m_nodes[index];
+
+        if (pNode->m_isCalcMatrix)
+        {
+            m_mLocals[index] = pNode->CalcLocalMatrix();
+        }
+
+        m_mWorlds[index] = pParentWorld ? m_mLocals[index] * *pParentWorld : m_mLocals[index];
+        pParentWorld = &m_mWorlds[index];
+    }
+
+    m_mInvWorlds[nodeIndex] = m_mWorlds[nodeIndex].Invert();
+}
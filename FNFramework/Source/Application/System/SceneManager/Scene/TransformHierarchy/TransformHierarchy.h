@@ -0,0 +1,132 @@
+﻿#pragma once
+
+class TransformComponent;
+
+/**
+* @class TransformHierarchy
+* @brief シーン内の TransformComponent の行列を親子順に並べて管理するクラス
+* @details
+*   - ローカル / ワールド / ワールドの逆行列 を隙間なく並んだ配列で保持する
+*   - 配列は親が必ず子より前に来る深さ優先順に並んでおり、子孫は自身の直後に連続して並ぶ
+*   - 行列の変更はダーティフラグで管理し、1フレームに1回 先頭から順に走査するだけで全ノードを更新できる
+*   - フレームの途中で参照された場合は、そのノードと祖先だけを必要に応じて更新する
+*   - 親子関係の変更では並び替えを行わず、Update でまとめて1回だけ並び替える
+*     並び替え前に参照された場合は、GameObject の親を辿って祖先の行列から計算する
+*/
+class TransformHierarchy
+{
+public:
+    static constexpr UINT32 InvalidIndex = UINT32_MAX;
+
+    //--------------------------------
+    // 登録 / 解除
+    //--------------------------------
+    /**
+    * @brief ノードの登録 : 親を持たないノードとして末尾に追加される
+    * @param[in] pNode - 登録する TransformComponent
+    * @return 登録したノードの番号
+    */
+    UINT32 Register(TransformComponent* pNode);
+
+    /* @brief ノードの登録解除 : 配列は次に並び替える時に詰める */
+    void Unregister(UINT32 nodeIndex);
+
+    //--------------------------------
+    // 変更通知
+    //--------------------------------
+    /* @brief 親子関係が変わったことを通知する : 次の Update で並び替える */
+    void MarkOrderDirty() { m_isOrderDirty = true; }
+
+    /* @brief ノードの行列が変わったことを通知する : 子孫もまとめて更新対象にする */
+    void MarkDirty(UINT32 nodeIndex);
+
+    //--------------------------------
+    // 行列の取得 : 更新が必要な場合はここで計算する
+    //--------------------------------
+    const Math::Matrix& GetLocalMatrix(UINT32 nodeIndex);
+    const Math::Matrix& GetWorldMatrix(UINT32 nodeIndex);
+    const Math::Matrix& GetInvWorldMatrix(UINT32 nodeIndex);
+
+    /**
+    * @brief 親のワールドの逆行列の取得 : 計算するのは親と祖先だけで、自身の行列は計算しない
+    * @details
+    *   - 自身の TRS を書き換える前に呼ばれるため、ここで自身を計算するとダーティフラグが下がってしまう
+    *   - 親子関係の変更直後でも並び替えは行わず、現在の親から計算する
+    * @return 親がいない場合は単位行列
+    */
+    const Math::Matrix& GetParentInvWorldMatrix(UINT32 nodeIndex);
+
+    //--------------------------------
+    // 更新
+    //--------------------------------
+    /* @brief 更新が必要なノードを先頭から順に1回だけ計算する */
+    void Update();
+
+    //--------------------------------
+    // デバッグ用
+    //--------------------------------
+    /* @brief 登録されているノード数 */
+    size_t GetNodeNum() const { return m_nodes.size(); }
+
+    /* @brief 前のフレームで行列を計算したノード数 */
+    UINT32 GetUpdatedNodeNum() const { return m_lastUpdatedNodeNum; }
+
+    /* @brief これまでに並び替えを行った回数 */
+    UINT32 GetRebuildOrderNum() const { return m_rebuildOrderNum; }
+
+private:
+    /* @brief 親子関係を読み直して、深さ優先順に並び替える */
+    void RebuildOrder();
+
+    /**
+    * @brief GameObject の親子関係から、現在の親のノード番号を取得する
+    * @return 親がいない場合や別の階層に属する場合は InvalidIndex
+    */
+    UINT32 FindParentIndex(UINT32 nodeIndex) const;
+
+    /**
+    * @brief 祖先を含めて、更新が必要なら計算する
+    * @param[in] nodeIndex - 計算したいノードの番号
+    * @return 計算後のノードの番号
+    */
+    UINT32 ResolveNode(UINT32 nodeIndex);
+
+    /**
+    * @brief 並び替え前のノードを、現在の親を根まで辿って計算する
+    * @details
+    *   - 並び替え前は配列上の親子関係が古いので、ダーティフラグを信用せずに根から計算し直す
+    *   - ダーティフラグは下ろさない : 子孫への伝播は並び替え時に行われるため
+    */
+    void CalcNodeWithoutOrder(UINT32 nodeIndex);
+
+    /* @brief 1ノード分の行列を計算する : 親は計算済みであること */
+    void CalcNode(UINT32 nodeIndex);
+
+    //--------------------------------
+    // ノードごとのデータ : 添え字がノードの番号
+    //--------------------------------
+    std::vector<TransformComponent*> m_nodes;       // 登録解除されたノードは nullptr
+    std::vector<UINT32> m_parents;                  // 親のノード番号 : 親がいない場合は InvalidIndex
+    std::vector<UINT32> m_subtreeSizes;             // 自身を含めた子孫の数 : [自身, 自身 + 数) が子孫の範囲
+
+    std::vector<Math::Matrix> m_mLocals;            // ローカル行列
+    std::vector<Math::Matrix> m_mWorlds;            // ワールド行列
+    std::vector<Math::Matrix> m_mInvWorlds;         // ワールド行列の逆行列
+
+    // ワールド行列の再計算が必要か
+    // 親がダーティなら子孫も必ずダーティになっている
+    std::vector<UINT8> m_dirtyFlags;
+
+    // 親子関係が変わって並び替えが必要か
+    bool m_isOrderDirty = false;
+
+    // 並び替え前の計算で辿った祖先 : 毎回確保しないように使い回す
+    std::vector<UINT32> m_chainIndices;
+
+    // 行列を計算したノード数
+    UINT32 m_updatedNodeNum = 0;
+    UINT32 m_lastUpdatedNodeNum = 0;
+
+    // 並び替えを行った回数
+    UINT32 m_rebuildOrderNum = 0;
+};
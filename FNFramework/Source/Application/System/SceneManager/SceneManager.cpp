@@ -39,6 +39,9 @@
 
 void SceneManager::RegisterComponent()
 {
+    // ImGui から追加しないが、すべてのオブジェクトが持つのでプールから確保する
+    ComponentPool::Register<TransformComponent>();
+
     RegisterComponent<AnimationComponent>();
     RegisterComponent<BillboardScript>();
     RegisterComponent<CameraShakeEventScript>();
@@ -83,7 +86,6 @@ void SceneManager::Init()
 
     // デバッグワイヤーフレームの初期化
     m_upDebugWire = std::make_unique<DebugWire>();
-    m_upDebugWire->Init();
 
     // Fadeの初期化
     m_spFade = std::make_shared<Fade>(/* blackOutTime */ 1.5f, /* progress = */ 0.5f);
@@ -127,6 +129,9 @@ void SceneManager::RemoveComponentToObject(std::string_view _compName, std::shar
 
 void SceneManager::Release()
 {
+    // 初期化前に破棄される場合 (描画を行わないテストなど) は、設定ファイルを上書きしない
+    if (m_firstLoadSceneName.empty()) { return; }
+
     // 設定ファイルの保存 //
     Json setting;
     setting[FirstLoadSceneName.data()] = m_firstLoadSceneName;
@@ -190,6 +195,16 @@ void SceneManager::PostUpdate()
     m_spFade->Update();
 }
 
+void SceneManager::PostDraw()
+{
+    // 描画が終わってから破棄するので、このフレームで使ったオブジェクトは描画中に消えない
+    // シーンを切り替えた直後でも残らないように、読み込み済みのシーンすべてを対象にする
+    for (auto& [name, spScene] : m_umNameToScene)
+    {
+        spScene->FlushDestroyedObjects();
+    }
+}
+
 bool SceneManager::IsLoadedScene(std::string_view _sceneName)
 {
     auto itr = m_umNameToScene.find(_sceneName.data());
@@ -244,6 +259,9 @@ void SceneManager::ChangeScene(std::string_view _sceneName)
 {
     auto itr = m_umNameToScene.find(_sceneName.data());
 
+    // 送ったフレームが GPU で終わるまで待つ : 今のシーンのリソースを、描画中に解放しないようにする
+    GraphicsDevice::Instance().WaitForCommandQueue();
+
     // シーンの変更前に Release() を読んでおく
     if (auto&& spNowScene = GetScene(m_nowSceneName))
     {
@@ -66,12 +66,17 @@ public:
     void Update();
     /* @brief 更新後処理 */
     void PostUpdate();
+    /* @brief 描画後処理 : 破棄待ちのオブジェクトをまとめて破棄する */
+    void PostDraw();
 
     template <typename CompType>
     void RegisterComponent(bool _isGui = true)
     {
         const std::string_view compName = typeid(CompType).name();
 
+        // シーンのプールから確保する型として登録する
+        ComponentPool::Register<CompType>();
+
         if (_isGui)
         {
             m_vCompNames.push_back(compName.data());
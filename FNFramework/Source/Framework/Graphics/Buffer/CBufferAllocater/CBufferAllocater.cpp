@@ -4,55 +4,86 @@ void CBufferAllocater::Create(CBVSRVUAVHeap* pHeap)
 {
     m_pCbvHeap = pHeap;
 
-    if (!CreateBufferResource())
-    {
-        FNENG_ASSERT_ERROR("CBuffer作成失敗");
-        return;
-    }
-
-    m_pBuffer->Map(0, nullptr, (void**)&m_pMappedBuffer);
+    ResetCurrentUseNumber();
 }
 
 void CBufferAllocater::ResetCurrentUseNumber()
 {
-    m_currentUseNumber = 0;
+    // ヒープのCBVの領域をフレーム数で等分して、記録中のフレームの領域を使う
+    const int frameUseCount = static_cast<int>(m_pCbvHeap->GetUseCount().x) / GraphicsDevice::FrameInFlightNum;
+    const int frameIndex = static_cast<int>(GraphicsDevice::Instance().GetFrameIndex());
+
+    m_currentUseNumber = frameUseCount * frameIndex;
+    m_currentEndNumber = m_currentUseNumber + frameUseCount;
+
+    // 前のフレームでコピーした定数バッファは使い回さない
+    const ConstantUploadCache::Stats& constantStats = m_constantCache.GetStats();
+    m_frameStats.DedupNum = constantStats.DedupNum;
+    m_frameStats.UploadSize = constantStats.UploadSize;
+
+    m_constantCache.Reset();
+
+    m_lastFrameStats = m_frameStats;
+    m_frameStats = {};
 }
 
-bool CBufferAllocater::CreateBufferResource()
+void CBufferAllocater::BindStructuredAllocation(int descIndex, const UploadAllocation& allocation, UINT stride)
 {
-    D3D12_HEAP_PROPERTIES heapProp;
-    CreateHeapProperties(heapProp);
-
-    D3D12_RESOURCE_DESC resDesc;
-    CreateResourceDescription(resDesc);
-
-    HRESULT hr = GraphicsDevice::Instance().GetDevice()->CreateCommittedResource
-    (
-        &heapProp,
-        D3D12_HEAP_FLAG_NONE,
-        &resDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&m_pBuffer)
-    );
-
-    return SUCCEEDED(hr);
+    if (!m_pCbvHeap)return;
+    if (!allocation.IsValid() || stride == 0) { return; }
+
+    const int viewNumber = AllocateView();
+    if (viewNumber < 0) { return; }
+
+    // ページは GraphicsDevice が D3D12UploadPageFactory で作成している
+    ID3D12Resource* pBuffer = static_cast<D3D12UploadPage*>(allocation.pPage)->GetResource();
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Buffer.FirstElement = allocation.Offset / stride;
+    srvDesc.Buffer.NumElements = static_cast<UINT>(allocation.Size / stride);
+    srvDesc.Buffer.StructureByteStride = stride;
+    srvDesc.Buffer.Flags = D3D12_BUFFER_SRV_FLAG_NONE;
+
+    GraphicsDevice::Instance().GetDevice()->CreateShaderResourceView(pBuffer, &srvDesc, GetCPUHandle(viewNumber));
+
+    GraphicsDevice::Instance().GetCmdList()->SetGraphicsRootDescriptorTable(descIndex, GetGPUHandle(viewNumber));
 }
 
-void CBufferAllocater::CreateHeapProperties(D3D12_HEAP_PROPERTIES& heapProp)
+int CBufferAllocater::AllocateView()
 {
-    heapProp = {};
-    heapProp.Type = D3D12_HEAP_TYPE_UPLOAD;
+    // 記録中のフレームの領域を使い切っている場合は確保しない
+    if (m_currentUseNumber >= m_currentEndNumber)
+    {
+        FNENG_ASSERT_ERROR("使用できるヒープ容量を超えました");
+        return -1;
+    }
+
+    ++m_frameStats.ViewNum;
+
+    return m_currentUseNumber++;
 }
 
-void CBufferAllocater::CreateResourceDescription(D3D12_RESOURCE_DESC& resDesc)
+D3D12_CPU_DESCRIPTOR_HANDLE CBufferAllocater::GetCPUHandle(int number) const
 {
-    resDesc = {};
-    resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    resDesc.Height = 1;
-    resDesc.DepthOrArraySize = 1;
-    resDesc.MipLevels = 1;
-    resDesc.SampleDesc.Count = 1;
-    resDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-    resDesc.Width = static_cast<UINT64>((1 + 0xff) & ~0xff) * static_cast<int>(m_pCbvHeap->GetUseCount().x);
+    const auto& pDevice = GraphicsDevice::Instance().GetDevice();
+
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = m_pCbvHeap->GetCurrentHeapData().pHeap->GetCPUDescriptorHandleForHeapStart();
+    cpuHandle.ptr += static_cast<UINT64>(pDevice->GetDescriptorHandleIncrementSize
+        (D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)) * number;
+
+    return cpuHandle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE CBufferAllocater::GetGPUHandle(int number) const
+{
+    const auto& pDevice = GraphicsDevice::Instance().GetDevice();
+
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_pCbvHeap->GetCurrentHeapData().pHeap->GetGPUDescriptorHandleForHeapStart();
+    gpuHandle.ptr += static_cast<UINT64>(pDevice->GetDescriptorHandleIncrementSize
+        (D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)) * number;
+
+    return gpuHandle;
 }
@@ -1,5 +1,15 @@
 ﻿#pragma once
 
+/**
+* @class CBufferAllocater
+* @brief 描画ごとのデータを GPU に送り、ルートパラメーターにバインドする
+* @details
+*   - データは GraphicsDevice の FrameUploadAllocator から切り出した領域にコピーする
+*   - 定数バッファはルートCBVとして GPU アドレスを直接バインドするので、ビューは作らない
+*   - 同じフレームで同じ内容の定数バッファがバインドされた場合は、前にコピーした領域を使い回す
+*     (カメラ / ライト / フォグなど、複数のパスで同じデータをバインドする場合) : ConstantUploadCache
+*   - StructuredBuffer のビューはヒープの CBV の領域に作る : この領域はフレーム(GraphicsDevice::FrameInFlightNum)ごとに分けてある
+*/
 class CBufferAllocater
 {
 public:
@@ -11,7 +21,10 @@ public:
     void Create(CBVSRVUAVHeap* pHeap);
 
     /**
-     * @brief 使用しているバッファの番号を初期化
+     * @brief 使用しているビューの番号を初期化
+     * @details
+     *   記録中のフレームの領域の先頭に戻す : GPU が読んでいる前のフレームの領域は書き換えない
+     *   使い回し用に覚えている定数バッファも、前のフレームのものなので忘れる
      * */
     void ResetCurrentUseNumber();
 
@@ -26,26 +39,63 @@ public:
     template <typename T>
     void BindAttachData(int descIndex, const T& data);
 
+    /**
+    * @brief 配列を StructuredBuffer としてバインドする
+    *
+    * @param descIndex - ルートパラメーターの番号
+    * @param datas	   - バインドする配列
+    */
+    template <typename T>
+    void BindStructuredData(int descIndex, std::span<const T> datas);
+
+    /**
+    * @brief FrameUploadAllocator から切り出し済みの領域を StructuredBuffer としてバインドする
+    *
+    * @param descIndex  - ルートパラメーターの番号
+    * @param allocation - 切り出した領域 : 要素のサイズでアラインメントしておく
+    * @param stride     - 要素のサイズ
+    */
+    void BindStructuredAllocation(int descIndex, const UploadAllocation& allocation, UINT stride);
+
+    //--------------------------------
+    // デバッグ
+    //--------------------------------
+    /* @brief 1フレームの統計 */
+    struct FrameStats
+    {
+        UINT64 BindNum = 0;     // 定数バッファをバインドした回数
+        UINT64 DedupNum = 0;    // 同じ内容を使い回した回数
+        UINT64 UploadSize = 0;  // 定数バッファのためにコピーしたサイズ
+        UINT64 ViewNum = 0;     // 作成したビューの数
+    };
+
+    /* @brief 前のフレームの統計 */
+    const FrameStats& GetLastFrameStats() const { return m_lastFrameStats; }
+
+    /* @brief 同じ内容の定数バッファを使い回すか : 無効にすると毎回コピーする */
+    bool IsDedupEnable() const { return m_constantCache.IsDedupEnable(); }
+    void SetDedupEnable(bool enable) { m_constantCache.SetDedupEnable(enable); }
+
 private:
-    /* @brief バッファリソースの作成 */
-    bool CreateBufferResource();
-    /* @brief ヒープのプロパティ設定 */
-    void CreateHeapProperties(D3D12_HEAP_PROPERTIES& heapProp);
-    /* @brief リソースデスクの作成 */
-    void CreateResourceDescription(D3D12_RESOURCE_DESC& resDesc);
 
-    CBVSRVUAVHeap* m_pCbvHeap = nullptr;
+    /* @brief 記録中のフレームの領域からビューを1つ確保する : 足りなければ -1 */
+    int AllocateView();
 
-    // GPUに転送するためのバッファ
-    ComPtr<ID3D12Resource> m_pBuffer = nullptr;
+    /* @brief ビューの CPU / GPU ハンドル */
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCPUHandle(int number) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGPUHandle(int number) const;
 
-    // CPUで操作するための作業用バッファ
-    struct
-    {
-        char buf[256];
-    }* m_pMappedBuffer = nullptr;
+    CBVSRVUAVHeap* m_pCbvHeap = nullptr;
 
     int m_currentUseNumber = 0;
+    // 記録中のフレームが使える領域の終わり
+    int m_currentEndNumber = 0;
+
+    // 記録中のフレームでコピーした定数バッファ : 同じ内容を使い回す
+    ConstantUploadCache m_constantCache;
+
+    FrameStats m_frameStats;
+    FrameStats m_lastFrameStats;
 };
 
 /**
@@ -56,42 +106,25 @@ void CBufferAllocater::BindAttachData(int descIndex, const T& data)
 {
     if (!m_pCbvHeap)return;
 
-    const auto& pDevice = GraphicsDevice::Instance().GetDevice();
-
-    // dataサイズを256アラインメントして計算
-    int sizeAligned = (sizeof(T) + 0xff) & ~0xff;
-
-    // 256byteをいくつ使用するかアラインメントした結果を256で割って計算
-    int useValue = sizeAligned / 0x100;
-
-    // 現在使い終わっている番号と今から使う容量がヒープの容量を超えている場合はリターン
-    if (m_currentUseNumber + useValue > static_cast<int>(m_pCbvHeap->GetUseCount().x))
-    {
-        FNENG_ASSERT_ERROR("使用できるヒープ容量を超えました");
-        return;
-    }
+    const D3D12_GPU_VIRTUAL_ADDRESS gpuAddress =
+        m_constantCache.Upload(*GraphicsDevice::Instance().GetUploadAllocator(), &data, sizeof(T));
+    if (gpuAddress == 0) { return; }
 
-    int top = m_currentUseNumber;
+    // ルートCBVに GPU アドレスを直接バインドする
+    GraphicsDevice::Instance().GetCmdList()->SetGraphicsRootConstantBufferView(descIndex, gpuAddress);
 
-    // 先頭アドレスに使う分のポインタを足してから、メモリをコピー
-    std::memcpy(m_pMappedBuffer + top, &data, sizeof(T));
-
-    // ビューを使って値をシェーダーにアタッチ
-    D3D12_CONSTANT_BUFFER_VIEW_DESC cbDesc = {};
-    cbDesc.BufferLocation = m_pBuffer->GetGPUVirtualAddress() + static_cast<UINT64>(top) * 0x100;
-    cbDesc.SizeInBytes = sizeAligned;
-
-    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = m_pCbvHeap->GetCurrentHeapData().pHeap->GetCPUDescriptorHandleForHeapStart();
-    cpuHandle.ptr += static_cast<UINT64>(pDevice->GetDescriptorHandleIncrementSize
-        (D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)) * m_currentUseNumber;
-
-    pDevice->CreateConstantBufferView(&cbDesc, cpuHandle);
+    ++m_frameStats.BindNum;
+}
 
-    D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = m_pCbvHeap->GetCurrentHeapData().pHeap->GetGPUDescriptorHandleForHeapStart();
-    gpuHandle.ptr += static_cast<UINT64>(pDevice->GetDescriptorHandleIncrementSize
-        (D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV)) * m_currentUseNumber;
+template <typename T>
+void CBufferAllocater::BindStructuredData(int descIndex, std::span<const T> datas)
+{
+    if (!m_pCbvHeap)return;
+    if (datas.empty()) { return; }
 
-    GraphicsDevice::Instance().GetCmdList()->SetGraphicsRootDescriptorTable(descIndex, gpuHandle);
+    // 要素のサイズでアラインメントして、ページの先頭からの位置を要素の番号で表せるようにする
+    UploadAllocation allocation = GraphicsDevice::Instance().GetUploadAllocator()->Upload(datas, sizeof(T));
+    if (!allocation.IsValid()) { return; }
 
-    m_currentUseNumber += useValue;
+    BindStructuredAllocation(descIndex, allocation, sizeof(T));
 }
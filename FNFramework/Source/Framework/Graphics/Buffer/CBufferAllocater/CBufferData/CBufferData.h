@@ -65,15 +65,13 @@ namespace CBufferData
         {
         }
 
-        cbDeferredObject(UINT _bonePerInstance, bool _isSkin)
-            : BonePerInstance(_bonePerInstance), IsSkin(_isSkin)
+        cbDeferredObject(bool _isSkin)
+            : IsSkin(_isSkin)
         {
         }
 
-        float BonePerInstance = 0.0f;
-
         bool IsSkin = false;
-        float pad[2] = {};
+        float pad[3] = {};
     };
     struct cbSpriteObject
     {
@@ -121,6 +119,21 @@ namespace CBufferData
         float Intencity = 1.0f;
     };
 
+    // ライトのクラスター用定数バッファ : ピクセルが入るクラスターを求める
+    struct cbLightCluster
+    {
+        Math::Matrix mView; // クラスターを分けたカメラのビュー行列
+
+        UINT TileNumX = LightCluster::TileNumX;
+        UINT TileNumY = LightCluster::TileNumY;
+        UINT SliceNum = LightCluster::SliceNum;
+
+        // 奥行きの番号 = log(ビュー空間の z) * SliceScale + SliceBias
+        float SliceScale = 0.0f;
+        float SliceBias = 0.0f;
+        float _pad[3] = {};
+    };
+
     // 基本的なライト用定数バッファ
     struct Light
     {
@@ -137,6 +150,9 @@ namespace CBufferData
         float pad1 = 0.0f;
 
         Math::Matrix DirLight_mVP; // ビュー行列と正射影行列の合成行列
+
+        // カスケードごとのビュー行列と正射影行列の合成行列
+        std::array<Math::Matrix, ShadowCascade::CascadeNum> DirLight_mCascadeVP;
         //--------------------------------//
 
         //-----------ポイントライト---------------//
@@ -0,0 +1,54 @@
+﻿#include "ConstantUploadCache.h"
+
+void ConstantUploadCache::Reset()
+{
+    m_ummHashToConstant.clear();
+    m_uploadedBytes.clear();
+
+    m_stats = {};
+}
+
+UINT64 ConstantUploadCache::Upload(FrameUploadAllocator& allocator, const void* pData, size_t size)
+{
+    ++m_stats.RequestNum;
+
+    UINT64 hash = 0;
+
+    // 同じ内容をコピー済みなら、その領域を使い回す
+    if (m_isDedupEnable)
+    {
+        hash = utl::HashBytes(pData, size);
+
+        auto [itBegin, itEnd] = m_ummHashToConstant.equal_range(hash);
+        for (auto it = itBegin; it != itEnd; ++it)
+        {
+            const UploadedConstant& uploaded = it->second;
+
+            if (uploaded.Size != size) { continue; }
+            if (std::memcmp(m_uploadedBytes.data() + uploaded.ByteOffset, pData, size) != 0) { continue; }
+
+            ++m_stats.DedupNum;
+            return uploaded.GPUAddress;
+        }
+    }
+
+    // DirectX12ではConstantsBufferは256アラインメント
+    const UINT64 sizeAligned = (size + 0xff) & ~static_cast<UINT64>(0xff);
+
+    UploadAllocation allocation = allocator.Allocate(sizeAligned, D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+    if (!allocation.IsValid()) { return 0; }
+
+    std::memcpy(allocation.pCPU, pData, size);
+    m_stats.UploadSize += sizeAligned;
+
+    if (m_isDedupEnable)
+    {
+        const size_t byteOffset = m_uploadedBytes.size();
+        const std::byte* pBytes = static_cast<const std::byte*>(pData);
+        m_uploadedBytes.insert(m_uploadedBytes.end(), pBytes, pBytes + size);
+
+        m_ummHashToConstant.emplace(hash, UploadedConstant{ allocation.GPUAddress, size, byteOffset });
+    }
+
+    return allocation.GPUAddress;
+}
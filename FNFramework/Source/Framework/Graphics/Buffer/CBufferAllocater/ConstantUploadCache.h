@@ -0,0 +1,57 @@
+﻿#pragma once
+
+/**
+* @class ConstantUploadCache
+* @brief 定数バッファのデータを FrameUploadAllocator にコピーし、同じフレームで同じ内容のものを使い回す
+* @details
+*   - 内容のハッシュ値で探し、見つかった場合は CPU 側に控えた内容と比べてから前の領域を返す
+*     アップロード領域は書き込み結合のメモリなので、CPU から読み返さない
+*   - D3D12 に依存しないので、CBufferAllocater を介さずに使い回しの効果を計測できる
+*/
+class ConstantUploadCache
+{
+public:
+    /* @brief 1フレームの統計 */
+    struct Stats
+    {
+        UINT64 RequestNum = 0;  // 定数バッファを要求された回数
+        UINT64 DedupNum = 0;    // 同じ内容を使い回した回数
+        UINT64 UploadSize = 0;  // コピーしたサイズ : 256 バイトに切り上げたもの
+    };
+
+    /* @brief 覚えている定数バッファを忘れる : フレームの始めに呼ぶ */
+    void Reset();
+
+    /**
+    * @brief 定数バッファのデータをアップロード領域にコピーする
+    * @details 同じフレームで同じ内容をコピー済みの場合は、その領域を返す
+    * @param[in] allocator - 記録中のフレームのアロケーター
+    * @return GPU アドレス : 失敗した場合は 0
+    */
+    UINT64 Upload(FrameUploadAllocator& allocator, const void* pData, size_t size);
+
+    /* @brief Reset してからの統計 */
+    const Stats& GetStats() const { return m_stats; }
+
+    /* @brief 同じ内容の定数バッファを使い回すか : 無効にすると毎回コピーする */
+    bool IsDedupEnable() const { return m_isDedupEnable; }
+    void SetDedupEnable(bool enable) { m_isDedupEnable = enable; }
+
+private:
+    struct UploadedConstant
+    {
+        UINT64 GPUAddress = 0;
+        size_t Size = 0;
+        // m_uploadedBytes の中の位置 : ハッシュ値が同じ場合に内容を比べる
+        size_t ByteOffset = 0;
+    };
+
+    // 内容のハッシュ値 -> このフレームでコピーした定数バッファ
+    std::unordered_multimap<UINT64, UploadedConstant> m_ummHashToConstant;
+    // このフレームでコピーした内容の控え : アップロード領域は CPU から読むと遅いので、比較はこちらで行う
+    std::vector<std::byte> m_uploadedBytes;
+
+    bool m_isDedupEnable = true;
+
+    Stats m_stats;
+};
@@ -62,8 +62,23 @@ bool DepthStencil::Create(int w, int h, DXGI_FORMAT format, bool constantData)
     return true;
 }
 
-void DepthStencil::ClearDSV()
+void DepthStencil::ClearDSV(const D3D12_RECT* pRect)
 {
     const D3D12_CPU_DESCRIPTOR_HANDLE& dsvH = GraphicsDevice::Instance().GetDSVHeap()->GetCPUHandle(m_dsvNumber);
-    GraphicsDevice::Instance().ClearDSV(dsvH, 1.0f);
+    GraphicsDevice::Instance().ClearDSV(dsvH, 1.0f, 0, pRect);
+}
+
+void DepthStencil::CopyFrom(const DepthStencil& src)
+{
+    if (!m_pBuffer || !src.m_pBuffer) { return; }
+
+    GraphicsDevice& device = GraphicsDevice::Instance();
+
+    device.SetResourceBarrier(src.m_pBuffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    device.SetResourceBarrier(m_pBuffer.Get(), D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    device.GetCmdList()->CopyResource(m_pBuffer.Get(), src.m_pBuffer.Get());
+
+    device.SetResourceBarrier(m_pBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_DEPTH_WRITE);
+    device.SetResourceBarrier(src.m_pBuffer.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_DEPTH_WRITE);
 }
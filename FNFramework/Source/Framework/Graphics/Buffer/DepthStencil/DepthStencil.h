@@ -22,8 +22,17 @@ public:
     */
     bool Create(int w, int h, DXGI_FORMAT format = DXGI_FORMAT_R32_TYPELESS, bool constantData = false);
 
-    /* @brief 深度バッファのデータを初期化 */
-    void ClearDSV();
+    /**
+    * @brief 深度バッファのデータを初期化
+    * @param pRect - 初期化する範囲 : nullptr で全体
+    */
+    void ClearDSV(const D3D12_RECT* pRect = nullptr);
+
+    /**
+    * @brief 同じ大きさとフォーマットの深度バッファの内容をコピーする
+    * @param src - コピー元 : 深度の書き込み状態のまま渡す
+    */
+    void CopyFrom(const DepthStencil& src);
 
     /**
     * @brief DSV番号を取得
@@ -37,10 +37,31 @@ bool RenderTarget::Create(int w, int h,
     return true;
 }
 
-void RenderTarget::ClearRTV()
+void RenderTarget::ClearRTV(const D3D12_RECT* pRect)
 {
     const D3D12_CPU_DESCRIPTOR_HANDLE& rtvH = GraphicsDevice::Instance().GetRTVHeap()->GetCPUHandle(m_rtvNumber);
-    GraphicsDevice::Instance().ClearRTV(rtvH, m_rtvClearColor);
+    GraphicsDevice::Instance().ClearRTV(rtvH, m_rtvClearColor, pRect);
+}
+
+void RenderTarget::CopyFrom(const RenderTarget& src)
+{
+    if (!m_pRenderTargetResource || !src.m_pRenderTargetResource) { return; }
+
+    GraphicsDevice& device = GraphicsDevice::Instance();
+
+    // 描画していない間のレンダリングターゲットは PRESENT(COMMON) の状態にある
+    device.SetResourceBarrier(src.m_pRenderTargetResource.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    device.SetResourceBarrier(m_pRenderTargetResource.Get(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_COPY_DEST);
+
+    device.GetCmdList()->CopyResource(m_pRenderTargetResource.Get(), src.m_pRenderTargetResource.Get());
+
+    device.SetResourceBarrier(m_pRenderTargetResource.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PRESENT);
+    device.SetResourceBarrier(src.m_pRenderTargetResource.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_PRESENT);
+
+    if (m_depthStencil.IsCreate() && src.m_depthStencil.IsCreate())
+    {
+        m_depthStencil.CopyFrom(src.m_depthStencil);
+    }
 }
 
 bool RenderTarget::CreateRTTex(int w, int h, int mipLevel, int arraySize, DXGI_FORMAT format,
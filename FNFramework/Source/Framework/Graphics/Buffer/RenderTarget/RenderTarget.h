@@ -90,18 +90,26 @@ public:
         const Math::Color& clearCol = Color::Red,
         bool constantData = false);
 
-    void ClearDSV()
+    /* @param pRect - クリアする範囲 : nullptr で全体 */
+    void ClearDSV(const D3D12_RECT* pRect = nullptr)
     {
         if (!m_depthStencil.IsCreate()) { return; }
 
-        m_depthStencil.ClearDSV();
+        m_depthStencil.ClearDSV(pRect);
     }
 
     /**
     * @brief レンダリングターゲットのクリア
     * @brief 設定された初期化カラーでクリアする
+    * @param pRect - クリアする範囲 : nullptr で全体
     */
-    void ClearRTV();
+    void ClearRTV(const D3D12_RECT* pRect = nullptr);
+
+    /**
+    * @brief 同じ大きさとフォーマットのレンダリングターゲットの内容を、深度バッファごとコピーする
+    * @details どちらもレンダリングターゲットとして使っていない状態で呼ぶ
+    */
+    void CopyFrom(const RenderTarget& src);
 
 private:
     /**
@@ -0,0 +1,60 @@
+﻿#include "FrameContextRing.h"
+
+void FrameContextRing::Init(BaseQueueFence* pFence, UINT frameNum)
+{
+    FNENG_ASSERT_LOG("フレーム数が範囲外です", frameNum == 0 || frameNum > MaxFrameNum);
+
+    m_pFence = pFence;
+    m_frameNum = std::clamp<UINT>(frameNum, 1, MaxFrameNum);
+    m_frameIndex = 0;
+
+    m_frameFenceValues.fill(0);
+    m_nextFenceValue = 1;
+    m_waitNum = 0;
+}
+
+void FrameContextRing::BeginFrame()
+{
+    if (!m_pFence) { return; }
+
+    const UINT64 fenceValue = m_frameFenceValues[m_frameIndex];
+
+    // このスロットを前に使ったフレームが GPU で終わっていなければ待つ
+    if (!IsCompleted(fenceValue))
+    {
+        m_pFence->WaitForValue(fenceValue);
+        ++m_waitNum;
+    }
+}
+
+void FrameContextRing::EndFrame()
+{
+    if (!m_pFence) { return; }
+
+    const UINT64 fenceValue = m_nextFenceValue++;
+    m_pFence->Signal(fenceValue);
+
+    m_frameFenceValues[m_frameIndex] = fenceValue;
+    m_frameIndex = (m_frameIndex + 1) % m_frameNum;
+}
+
+void FrameContextRing::WaitIdle()
+{
+    if (!m_pFence) { return; }
+
+    const UINT64 fenceValue = m_nextFenceValue++;
+    m_pFence->Signal(fenceValue);
+
+    if (!IsCompleted(fenceValue))
+    {
+        m_pFence->WaitForValue(fenceValue);
+    }
+}
+
+bool FrameContextRing::IsCompleted(UINT64 fenceValue) const
+{
+    if (fenceValue == 0) { return true; }
+    if (!m_pFence) { return true; }
+
+    return m_pFence->GetCompletedValue() >= fenceValue;
+}
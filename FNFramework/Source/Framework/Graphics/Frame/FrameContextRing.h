@@ -0,0 +1,91 @@
+﻿#pragma once
+
+/**
+* @class BaseQueueFence
+* @brief コマンドキューとフェンスの操作をまとめたインターフェース
+* @details
+*   FrameContextRing はこのインターフェースだけを使うので、実際のキューを使わずに順序の確認ができる
+*   D3D12 のキューを使う実装は D3D12QueueFence
+*/
+class BaseQueueFence
+{
+public:
+    virtual ~BaseQueueFence() = default;
+
+    /* @brief キューの処理がここまで終わったらフェンスを value にする命令を積む */
+    virtual void Signal(UINT64 value) = 0;
+
+    /* @brief GPU が完了したフェンスの値 */
+    virtual UINT64 GetCompletedValue() const = 0;
+
+    /* @brief フェンスが value になるまで CPU を待たせる */
+    virtual void WaitForValue(UINT64 value) = 0;
+};
+
+/**
+* @class FrameContextRing
+* @brief 同時に GPU へ送っておけるフレーム(フレームコンテキスト)の順番を管理するリング
+* @details
+*   - フレームごとに、そのフレームの最後に Signal したフェンスの値を覚えておく
+*   - 次のフレームを始める時は、そのスロットを前に使ったフレームが GPU で終わっていなければ待つ
+*     そのため CPU が待つのは、GPU より フレーム数 だけ先に進んでしまった時だけになる
+*   - フレームごとのコマンドアロケーター / アップロード用のバッファは、GetFrameIndex の番号で使い分ける
+*     BeginFrame の後は、その番号のリソースを GPU が使い終わっているので書き換えて良い
+*/
+class FrameContextRing
+{
+public:
+    // 同時に送っておけるフレーム数の上限
+    static constexpr UINT MaxFrameNum = 3;
+
+    /**
+    * @brief 初期化
+    * @param[in] pFence   - フェンスの操作 : リングより長く生存させる
+    * @param[in] frameNum - 同時に送っておけるフレーム数 : 1 ~ MaxFrameNum
+    */
+    void Init(BaseQueueFence* pFence, UINT frameNum);
+
+    /* @brief フレームの記録を始める : 今のスロットを前に使ったフレームが終わるまで待つ */
+    void BeginFrame();
+
+    /* @brief フレームのコマンドを送った後に呼ぶ : フェンスの値を Signal して次のスロットに進む */
+    void EndFrame();
+
+    /* @brief これまでに送ったすべてのフレームが終わるまで待つ */
+    void WaitIdle();
+
+    //--------------------------------
+    // ゲッター
+    //--------------------------------
+    /* @brief 記録中のフレームのスロット番号 */
+    UINT GetFrameIndex() const { return m_frameIndex; }
+
+    /* @brief 同時に送っておけるフレーム数 */
+    UINT GetFrameNum() const { return m_frameNum; }
+
+    /* @brief フェンスの値まで GPU が終わっているか */
+    bool IsCompleted(UINT64 fenceValue) const;
+
+    /* @brief 最後に Signal したフェンスの値 */
+    UINT64 GetLastSignaledValue() const { return m_nextFenceValue - 1; }
+
+    /* @brief スロットのフレームの最後に Signal したフェンスの値 : 0 は未使用 */
+    UINT64 GetFrameFenceValue(UINT frameIndex) const { return m_frameFenceValues[frameIndex]; }
+
+    //x--- デバッグ表示用 ---x//
+    /* @brief BeginFrame で GPU を待った回数 */
+    UINT64 GetWaitNum() const { return m_waitNum; }
+
+private:
+    BaseQueueFence* m_pFence = nullptr;
+
+    UINT m_frameNum = 1;
+    UINT m_frameIndex = 0;
+
+    // スロットごとの、最後に Signal したフェンスの値
+    std::array<UINT64, MaxFrameNum> m_frameFenceValues = {};
+    // 次に Signal する値 : フェンスは 0 から始まるので 1 から使う
+    UINT64 m_nextFenceValue = 1;
+
+    UINT64 m_waitNum = 0;
+};
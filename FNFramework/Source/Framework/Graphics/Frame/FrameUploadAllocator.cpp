@@ -0,0 +1,120 @@
+﻿#include "FrameUploadAllocator.h"
+
+void FrameUploadAllocator::Init(BaseUploadPageFactory* pFactory, UINT64 pageSize)
+{
+    Release();
+
+    m_pFactory = pFactory;
+    m_pageSize = std::max<UINT64>(1, pageSize);
+}
+
+void FrameUploadAllocator::Release()
+{
+    m_upCurrentPage = nullptr;
+    m_currentOffset = 0;
+
+    m_upFullPages.clear();
+    m_retiredPages.clear();
+    m_upFreePages.clear();
+
+    m_frameUsedSize = 0;
+}
+
+UploadAllocation FrameUploadAllocator::Allocate(UINT64 size, UINT64 align)
+{
+    if (size == 0) { return {}; }
+
+    align = std::max<UINT64>(1, align);
+
+    // 今のページに収まらなければ次のページに移る
+    UINT64 offset = m_upCurrentPage ? (m_currentOffset + align - 1) / align * align : 0;
+
+    if (!m_upCurrentPage || offset + size > m_upCurrentPage->GetSize())
+    {
+        if (!StartNewPage(size))
+        {
+            FNENG_ASSERT_ERROR("アップロード用のページの作成に失敗しました");
+            return {};
+        }
+
+        offset = 0;
+    }
+
+    m_currentOffset = offset + size;
+    m_frameUsedSize += size;
+
+    UploadAllocation allocation;
+    allocation.pCPU = m_upCurrentPage->GetCPUAddress() + offset;
+    allocation.GPUAddress = m_upCurrentPage->GetGPUAddress() + offset;
+    allocation.Size = size;
+    allocation.pPage = m_upCurrentPage.get();
+    allocation.Offset = offset;
+
+    return allocation;
+}
+
+void FrameUploadAllocator::FinishFrame(UINT64 fenceValue)
+{
+    if (m_upCurrentPage)
+    {
+        m_upFullPages.emplace_back(std::move(m_upCurrentPage));
+        m_currentOffset = 0;
+    }
+
+    // このフレームで使ったページは、GPU がこのフレームを終えるまで返却待ちにする
+    for (std::unique_ptr<BaseUploadPage>& upPage : m_upFullPages)
+    {
+        m_retiredPages.push_back({ std::move(upPage), fenceValue });
+    }
+    m_upFullPages.clear();
+
+    m_lastFrameUsedSize = m_frameUsedSize;
+    m_frameUsedSize = 0;
+}
+
+void FrameUploadAllocator::Recycle(UINT64 completedFenceValue)
+{
+    while (!m_retiredPages.empty() && m_retiredPages.front().FenceValue <= completedFenceValue)
+    {
+        std::unique_ptr<BaseUploadPage>& upPage = m_retiredPages.front().upPage;
+
+        // 大きさが違う専用のページは使い回さずに破棄する
+        if (upPage->GetSize() == m_pageSize)
+        {
+            m_upFreePages.emplace_back(std::move(upPage));
+        }
+
+        m_retiredPages.pop_front();
+    }
+}
+
+size_t FrameUploadAllocator::GetPageNum() const
+{
+    return (m_upCurrentPage ? 1 : 0) + m_upFullPages.size() + m_retiredPages.size() + m_upFreePages.size();
+}
+
+bool FrameUploadAllocator::StartNewPage(UINT64 size)
+{
+    if (!m_pFactory) { return false; }
+
+    if (m_upCurrentPage)
+    {
+        m_upFullPages.emplace_back(std::move(m_upCurrentPage));
+    }
+    m_currentOffset = 0;
+
+    // 1ページに収まるなら空きのページを使う
+    if (size <= m_pageSize && !m_upFreePages.empty())
+    {
+        m_upCurrentPage = std::move(m_upFreePages.back());
+        m_upFreePages.pop_back();
+        return true;
+    }
+
+    m_upCurrentPage = m_pFactory->CreatePage(std::max(size, m_pageSize));
+    if (!m_upCurrentPage) { return false; }
+
+    ++m_createPageNum;
+
+    return true;
+}
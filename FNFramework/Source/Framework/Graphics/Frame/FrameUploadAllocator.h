@@ -0,0 +1,169 @@
+﻿#pragma once
+
+/**
+* @class BaseUploadPage
+* @brief FrameUploadAllocator が切り出すページ
+* @details 作成から破棄まで CPU から書き込めるようにマップしたままにする
+*/
+class BaseUploadPage
+{
+public:
+    virtual ~BaseUploadPage() = default;
+
+    /* @brief CPU から書き込む先頭アドレス */
+    virtual std::byte* GetCPUAddress() const = 0;
+
+    /* @brief GPU から読む先頭アドレス */
+    virtual UINT64 GetGPUAddress() const = 0;
+
+    /* @brief ページのサイズ */
+    virtual UINT64 GetSize() const = 0;
+};
+
+/**
+* @class BaseUploadPageFactory
+* @brief FrameUploadAllocator のページを作成するインターフェース
+* @details D3D12 のリソースを使う実装は D3D12UploadPageFactory
+*/
+class BaseUploadPageFactory
+{
+public:
+    virtual ~BaseUploadPageFactory() = default;
+
+    /* @brief ページの作成 : 失敗したら nullptr */
+    virtual std::unique_ptr<BaseUploadPage> CreatePage(UINT64 size) = 0;
+};
+
+/* @brief FrameUploadAllocator から切り出した領域 */
+struct UploadAllocation
+{
+    std::byte* pCPU = nullptr;  // CPU から書き込むアドレス
+    UINT64 GPUAddress = 0;      // GPU から読むアドレス
+    UINT64 Size = 0;
+
+    // 切り出したページと、ページの先頭からの位置 : SRV の作成などでリソースが必要な場合に使う
+    BaseUploadPage* pPage = nullptr;
+    UINT64 Offset = 0;
+
+    bool IsValid() const { return pCPU != nullptr; }
+};
+
+/**
+* @class FrameUploadAllocator
+* @brief 1フレームだけ GPU に読ませるデータ(定数 / インスタンス / ボーン行列など)を置くアロケーター
+* @details
+*   - マップしたままの大きなページの先頭から順に切り出すだけなので、確保のたびにリソースを作らない
+*   - ページが足りなくなったら次のページに移る : 空いているページがなければ作成する
+*   - フレームの終わりに FinishFrame で、そのフレームで使ったページにフェンスの値を付けて返却待ちにする
+*     Recycle で GPU がフェンスの値まで終わったページだけを空きに戻すので、GPU が読んでいる間は上書きしない
+*   - 1ページに収まらない大きさは専用のページを作り、返却時に破棄する
+*   - ページの作成は BaseUploadPageFactory に任せるので、D3D12 に依存しない
+*
+*   ※ ロックしないので、メインスレッドから使う
+*   ※ 切り出した領域は、そのフレームのコマンドからだけ参照する
+*/
+class FrameUploadAllocator
+{
+public:
+    // 1ページの既定のサイズ
+    static constexpr UINT64 DefaultPageSize = 2 * 1024 * 1024;
+
+    ~FrameUploadAllocator()
+    {
+        Release();
+    }
+
+    //--------------------------------
+    // 初期化 / 解放
+    //--------------------------------
+    /**
+    * @brief 初期化
+    * @param[in] pFactory - ページの作成 : アロケーターより長く生存させる
+    * @param[in] pageSize - 1ページのサイズ
+    */
+    void Init(BaseUploadPageFactory* pFactory, UINT64 pageSize = DefaultPageSize);
+
+    /* @brief 解放 : すべてのページを破棄するので、GPU が使い終わってから呼ぶ */
+    void Release();
+
+    //--------------------------------
+    // 確保
+    //--------------------------------
+    /**
+    * @brief 領域の切り出し
+    * @param[in] size  - サイズ
+    * @param[in] align - ページの先頭からの位置のアライメント : 2のべき乗でなくても良い
+    * @return 切り出した領域 : 失敗した場合は IsValid が false
+    */
+    UploadAllocation Allocate(UINT64 size, UINT64 align);
+
+    /* @brief 配列を切り出した領域にコピーする */
+    template <typename T>
+    UploadAllocation Upload(std::span<const T> datas, UINT64 align = alignof(T))
+    {
+        UploadAllocation allocation = Allocate(datas.size_bytes(), align);
+
+        if (allocation.IsValid())
+        {
+            std::memcpy(allocation.pCPU, datas.data(), datas.size_bytes());
+        }
+
+        return allocation;
+    }
+
+    //--------------------------------
+    // フレームの区切り
+    //--------------------------------
+    /* @brief フレームのコマンドを送った後に呼ぶ : 使ったページを fenceValue の完了待ちにする */
+    void FinishFrame(UINT64 fenceValue);
+
+    /* @brief GPU が completedFenceValue まで終わっていれば、そのページを空きに戻す */
+    void Recycle(UINT64 completedFenceValue);
+
+    //--------------------------------
+    // ゲッター : デバッグ表示用
+    //--------------------------------
+    /* @brief 前のフレームで切り出したサイズ */
+    UINT64 GetLastFrameUsedSize() const { return m_lastFrameUsedSize; }
+
+    /* @brief 持っているページの数 : 使用中 / 返却待ち / 空きの合計 */
+    size_t GetPageNum() const;
+
+    /* @brief 返却待ちのページの数 */
+    size_t GetRetiredPageNum() const { return m_retiredPages.size(); }
+
+    /* @brief 空きのページの数 */
+    size_t GetFreePageNum() const { return m_upFreePages.size(); }
+
+    /* @brief ページを作成した総数 : 使用量が落ち着いていれば増えなくなる */
+    UINT64 GetCreatePageNum() const { return m_createPageNum; }
+
+private:
+    struct RetiredPage
+    {
+        std::unique_ptr<BaseUploadPage> upPage;
+        UINT64 FenceValue = 0;
+    };
+
+    /* @brief 今のページを使い終わりにして、size が収まる次のページに移る */
+    bool StartNewPage(UINT64 size);
+
+    BaseUploadPageFactory* m_pFactory = nullptr;
+    UINT64 m_pageSize = DefaultPageSize;
+
+    // 切り出し中のページと、その中の位置
+    std::unique_ptr<BaseUploadPage> m_upCurrentPage = nullptr;
+    UINT64 m_currentOffset = 0;
+
+    // このフレームで使い終わったページ
+    std::vector<std::unique_ptr<BaseUploadPage>> m_upFullPages;
+    // GPU の完了待ちのページ : フェンスの値の小さい順に並ぶ
+    std::deque<RetiredPage> m_retiredPages;
+    // 空きのページ
+    std::vector<std::unique_ptr<BaseUploadPage>> m_upFreePages;
+
+    //x--- 統計 ---x//
+    UINT64 m_frameUsedSize = 0;
+    UINT64 m_lastFrameUsedSize = 0;
+    UINT64 m_createPageNum = 0;
+};
@@ -0,0 +1,47 @@
+﻿#include "QueueFence.h"
+
+D3D12QueueFence::~D3D12QueueFence()
+{
+    if (m_hEvent)
+    {
+        CloseHandle(m_hEvent);
+        m_hEvent = nullptr;
+    }
+}
+
+bool D3D12QueueFence::Create(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue)
+{
+    m_pCmdQueue = pQueue;
+
+    auto hr = pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(m_pFence.GetAddressOf()));
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    m_hEvent = CreateEvent(nullptr, false, false, nullptr); // イベントハンドルの取得
+    if (!m_hEvent)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+void D3D12QueueFence::Signal(UINT64 value)
+{
+    m_pCmdQueue->Signal(m_pFence.Get(), value);
+}
+
+UINT64 D3D12QueueFence::GetCompletedValue() const
+{
+    return m_pFence->GetCompletedValue();
+}
+
+void D3D12QueueFence::WaitForValue(UINT64 value)
+{
+    if (m_pFence->GetCompletedValue() >= value) { return; }
+
+    m_pFence->SetEventOnCompletion(value, m_hEvent);
+    WaitForSingleObject(m_hEvent, INFINITE); // イベントが発生するまで待ち続ける
+}
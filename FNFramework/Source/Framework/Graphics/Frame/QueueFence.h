@@ -0,0 +1,31 @@
+﻿#pragma once
+
+/**
+* @class D3D12QueueFence
+* @brief D3D12 のコマンドキューとフェンスを使った BaseQueueFence
+* @details 待機用のイベントは作成時に1つだけ作り、待つたびに使い回す
+*/
+class D3D12QueueFence
+    : public BaseQueueFence
+{
+public:
+    ~D3D12QueueFence() override;
+
+    /**
+    * @brief 作成
+    * @param[in] pDevice - デバイス
+    * @param[in] pQueue  - Signal を積むコマンドキュー
+    * @result 作成できたらtrue
+    */
+    bool Create(ID3D12Device* pDevice, ID3D12CommandQueue* pQueue);
+
+    void Signal(UINT64 value) override;
+    UINT64 GetCompletedValue() const override;
+    void WaitForValue(UINT64 value) override;
+
+private:
+    ID3D12CommandQueue* m_pCmdQueue = nullptr;
+    ComPtr<ID3D12Fence> m_pFence = nullptr;
+
+    HANDLE m_hEvent = nullptr;
+};
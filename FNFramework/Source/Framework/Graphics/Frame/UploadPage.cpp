@@ -0,0 +1,56 @@
+﻿#include "UploadPage.h"
+
+D3D12UploadPage::~D3D12UploadPage()
+{
+    if (m_pBuffer && m_pMapped)
+    {
+        m_pBuffer->Unmap(0, nullptr);
+        m_pMapped = nullptr;
+    }
+}
+
+bool D3D12UploadPage::Create(ID3D12Device* pDevice, UINT64 size)
+{
+    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+    CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(size);
+
+    HRESULT hr = pDevice->CreateCommittedResource(
+        &heapProps,
+        D3D12_HEAP_FLAG_NONE,
+        &bufferDesc,
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(m_pBuffer.GetAddressOf()));
+
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // CPU からは読まないので、読み込みの範囲は空にする
+    D3D12_RANGE readRange = { 0, 0 };
+    hr = m_pBuffer->Map(0, &readRange, reinterpret_cast<void**>(&m_pMapped));
+
+    if (FAILED(hr))
+    {
+        m_pMapped = nullptr;
+        return false;
+    }
+
+    m_gpuAddress = m_pBuffer->GetGPUVirtualAddress();
+    m_size = size;
+
+    return true;
+}
+
+std::unique_ptr<BaseUploadPage> D3D12UploadPageFactory::CreatePage(UINT64 size)
+{
+    auto upPage = std::make_unique<D3D12UploadPage>();
+
+    if (!upPage->Create(m_pDevice, size))
+    {
+        return nullptr;
+    }
+
+    return upPage;
+}
@@ -0,0 +1,54 @@
+﻿#pragma once
+
+/**
+* @class D3D12UploadPage
+* @brief UPLOAD ヒープのバッファを使った BaseUploadPage
+* @details 作成時にマップし、破棄するまでアンマップしない
+*/
+class D3D12UploadPage
+    : public BaseUploadPage
+{
+public:
+    ~D3D12UploadPage() override;
+
+    /**
+    * @brief 作成
+    * @param[in] pDevice - デバイス
+    * @param[in] size    - バッファのサイズ
+    * @result 作成できたらtrue
+    */
+    bool Create(ID3D12Device* pDevice, UINT64 size);
+
+    std::byte* GetCPUAddress() const override { return m_pMapped; }
+    UINT64 GetGPUAddress() const override { return m_gpuAddress; }
+    UINT64 GetSize() const override { return m_size; }
+
+    /* @brief バッファの取得 : SRV の作成などに使う */
+    ID3D12Resource* GetResource() const { return m_pBuffer.Get(); }
+
+private:
+    ComPtr<ID3D12Resource> m_pBuffer = nullptr;
+
+    std::byte* m_pMapped = nullptr;
+    UINT64 m_gpuAddress = 0;
+    UINT64 m_size = 0;
+};
+
+/**
+* @class D3D12UploadPageFactory
+* @brief D3D12UploadPage を作成する BaseUploadPageFactory
+*/
+class D3D12UploadPageFactory
+    : public BaseUploadPageFactory
+{
+public:
+    explicit D3D12UploadPageFactory(ID3D12Device* pDevice)
+        : m_pDevice(pDevice)
+    {
+    }
+
+    std::unique_ptr<BaseUploadPage> CreatePage(UINT64 size) override;
+
+private:
+    ID3D12Device* m_pDevice = nullptr;
+};
@@ -69,7 +69,8 @@ bool GraphicsDevice::Init(HWND hWnd, int w, int h)
     }
 
     // CBVSRVUAVHeap
-    constexpr Math::Vector3 CBVSRVUAVHeapUseMaxCount = { 5000, 5000, 100 };
+    // CBV はフレームごとに領域を分けて使うので、フレーム数の分だけ確保する
+    constexpr Math::Vector3 CBVSRVUAVHeapUseMaxCount = { 5000 * FrameInFlightNum, 5000, 100 };
     m_upCBVSRVUAVHeap = std::make_unique<CBVSRVUAVHeap>();
     if (!m_upCBVSRVUAVHeap->Create(HeapType::CBVSRVUAV, CBVSRVUAVHeapUseMaxCount))
     {
@@ -77,6 +78,11 @@ bool GraphicsDevice::Init(HWND hWnd, int w, int h)
         return false;
     }
 
+    // FrameUploadAllocator
+    m_upUploadPageFactory = std::make_unique<D3D12UploadPageFactory>(m_pGraphicsDevice.Get());
+    m_upUploadAllocator = std::make_unique<FrameUploadAllocator>();
+    m_upUploadAllocator->Init(m_upUploadPageFactory.get());
+
     // CBufferAllocater
     m_upCBufferAllocater = std::make_unique<CBufferAllocater>();
     m_upCBufferAllocater->Create(m_upCBVSRVUAVHeap.get());
@@ -213,6 +219,8 @@ void GraphicsDevice::CopyToBackBuffer(const ShaderResourceTexture& srcTexture)
 
 void GraphicsDevice::Release()
 {
+    if (!m_upQueueFence) { return; }
+
     WaitForCommandQueue();
 }
 
@@ -248,13 +256,6 @@ void GraphicsDevice::ScreenFlip()
     ID3D12CommandList* cmdLists[] = { m_pCmdList.Get() };
     m_pCmdQueue->ExecuteCommandLists(1, cmdLists);
 
-    // コマンドリストの同期を待つ
-    WaitForCommandQueue();
-
-    // コマンドアロケーターとコマンドリストを初期化
-    m_pCmdAllocator->Reset(); // コマンドアロケーターの初期化
-    m_pCmdList->Reset(m_pCmdAllocator.Get(), nullptr); // コマンドリストの初期化
-
 #ifdef _DEBUG
     HRESULT hr =
         // スワップチェインに送る
@@ -268,24 +269,34 @@ void GraphicsDevice::ScreenFlip()
     //m_pSwapChain->Present(0, 0);	// 垂直同期 : OFF
     m_pSwapChain->Present(TRUE, 0); // 垂直同期 : ON
 #endif
+
+    // このフレームの終わりを Signal して、次のフレームのスロットに進む
+    m_frameRing.EndFrame();
+
+    // このフレームで使ったアップロード用のページは、GPU がこのフレームを終えるまで使わない
+    m_upUploadAllocator->FinishFrame(m_frameRing.GetLastSignaledValue());
+
+    // 次のスロットを前に使ったフレームが GPU で終わるまで待つ
+    // GPU が FrameInFlightNum フレーム遅れている時だけ待つことになる
+    m_frameRing.BeginFrame();
+
+    // GPU が終えたフレームのページを空きに戻す
+    m_upUploadAllocator->Recycle(m_upQueueFence->GetCompletedValue());
+
+    // 使い終わったスロットのコマンドアロケーターとコマンドリストを初期化
+    const auto& pCmdAllocator = m_pCmdAllocators[m_frameRing.GetFrameIndex()];
+    pCmdAllocator->Reset(); // コマンドアロケーターの初期化
+    m_pCmdList->Reset(pCmdAllocator.Get(), nullptr); // コマンドリストの初期化
 }
 
 void GraphicsDevice::WaitForCommandQueue()
 {
-    m_pCmdQueue->Signal(m_pFence.Get(), ++m_fenceVal);
+    m_frameRing.WaitIdle();
 
-    if (m_pFence->GetCompletedValue() != m_fenceVal)
+    // すべて終わっているので、返却待ちのページは空きに戻せる
+    if (m_upUploadAllocator && m_upQueueFence)
     {
-        auto event = CreateEvent(nullptr, false, false, nullptr); // イベントハンドルの取得
-        if (!event)
-        {
-            FNENG_ASSERT_ERROR("イベントエラー、アプリケーションを終了します");
-            return;
-        }
-        m_pFence->SetEventOnCompletion(m_fenceVal, event);
-
-        WaitForSingleObject(event, INFINITE); // イベントが発生するまで待ち続ける
-        CloseHandle(event); // イベントハンドルを閉じる
+        m_upUploadAllocator->Recycle(m_upQueueFence->GetCompletedValue());
     }
 }
 
@@ -391,16 +402,21 @@ bool GraphicsDevice::CreateDevice()
 
 bool GraphicsDevice::CreateCommandList()
 {
-    // コマンドアロケーター作成
-    auto hr = m_pGraphicsDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
-        IID_PPV_ARGS(m_pCmdAllocator.GetAddressOf()));
-    if (FAILED(hr))
+    HRESULT hr = S_OK;
+
+    // コマンドアロケーター作成 : フレームごとに1つ
+    for (auto& pCmdAllocator : m_pCmdAllocators)
     {
-        return false;
+        hr = m_pGraphicsDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT,
+            IID_PPV_ARGS(pCmdAllocator.GetAddressOf()));
+        if (FAILED(hr))
+        {
+            return false;
+        }
     }
 
-    // コマンドリスト作成
-    hr = m_pGraphicsDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_pCmdAllocator.Get(), nullptr,
+    // コマンドリスト作成 : 最初のフレームのアロケーターで記録を始める
+    hr = m_pGraphicsDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_pCmdAllocators[0].Get(), nullptr,
         IID_PPV_ARGS(m_pCmdList.GetAddressOf()));
     if (FAILED(hr))
     {
@@ -507,14 +523,16 @@ void GraphicsDevice::SetMonitorInfo(int width, int height, UINT refreshRate)
 
 bool GraphicsDevice::CreateFence()
 {
-    auto result = m_pGraphicsDevice->CreateFence(m_fenceVal, D3D12_FENCE_FLAG_NONE,
-        IID_PPV_ARGS(m_pFence.GetAddressOf()));
-    if (FAILED(result))
+    m_upQueueFence = std::make_unique<D3D12QueueFence>();
+    if (!m_upQueueFence->Create(m_pGraphicsDevice.Get(), m_pCmdQueue.Get()))
     {
         FNENG_ASSERT_ERROR("フェンス作成失敗");
+        m_upQueueFence = nullptr;
         return false;
     }
 
+    m_frameRing.Init(m_upQueueFence.get(), FrameInFlightNum);
+
     return true;
 }
 
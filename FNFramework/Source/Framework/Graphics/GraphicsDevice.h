@@ -43,9 +43,27 @@ public:
     /* @brief 画面(スワップチェイン)の切り替え */
     void ScreenFlip();
 
-    /** @brief コマンドキューの同期待ち	*/
+    /** @brief コマンドキューの同期待ち : これまでに送ったすべてのフレームが終わるまで待つ	*/
     void WaitForCommandQueue();
 
+    // 同時に GPU へ送っておけるフレーム数 : フレームごとのリソースはこの数だけ用意する
+    static constexpr UINT FrameInFlightNum = 2;
+
+    /**
+    * @brief 記録中のフレームの番号の取得
+    * @result 0 ~ FrameInFlightNum - 1 : フレームごとに持つリソースの添え字に使う
+    */
+    UINT GetFrameIndex() const
+    {
+        return m_frameRing.GetFrameIndex();
+    }
+
+    /* @brief フレームの管理の取得 */
+    const FrameContextRing& GetFrameRing() const
+    {
+        return m_frameRing;
+    }
+
     /**
     * @brief  デバイス取得
     * @result デバイスのポインタ
@@ -116,6 +134,15 @@ public:
         return m_upCBufferAllocater.get();
     }
 
+    /**
+    * @brief  1フレームだけ GPU に読ませるデータのアロケーターの取得
+    * @result FrameUploadAllocatorのポインタ
+    */
+    FrameUploadAllocator* GetUploadAllocator() const
+    {
+        return m_upUploadAllocator.get();
+    }
+
     /**
     * @brief  DSVヒープの取得
     * @result DSVヒープのポインタ
@@ -166,10 +193,11 @@ public:
     * @brief  レンダーターゲットビューを特定色で塗りつぶす
     * @param rtvHandle - レンダーターゲットビューのハンドル
     * @param clearColor - 塗りつぶす色
+    * @param pRect - 塗りつぶす範囲 : nullptr で全体
     */
-    void ClearRTV(D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle, const Math::Color& clearColor)
+    void ClearRTV(D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle, const Math::Color& clearColor, const D3D12_RECT* pRect = nullptr)
     {
-        m_pCmdList->ClearRenderTargetView(rtvHandle, &clearColor.x, 0, nullptr);
+        m_pCmdList->ClearRenderTargetView(rtvHandle, &clearColor.x, pRect ? 1 : 0, pRect);
     }
 
     /**
@@ -177,13 +205,14 @@ public:
     * @param dsvHandle - デプスステンシルビューのハンドル
     * @param depth - 塗りつぶす深度
     * @param stencil - 塗りつぶすステンシル
+    * @param pRect - 塗りつぶす範囲 : nullptr で全体
     */
-    void ClearDSV(D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle, float depth, UINT8 stencil = 0.0f)
+    void ClearDSV(D3D12_CPU_DESCRIPTOR_HANDLE dsvHandle, float depth, UINT8 stencil = 0.0f, const D3D12_RECT* pRect = nullptr)
     {
         m_pCmdList->ClearDepthStencilView(
             dsvHandle,
             D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL,
-            depth, stencil, 0, nullptr);
+            depth, stencil, pRect ? 1 : 0, pRect);
     }
 
     /**
@@ -351,12 +380,19 @@ private:
     //--------------------
     // コマンド関連
     //--------------------
-    ComPtr<ID3D12CommandAllocator> m_pCmdAllocator = nullptr;
+    // フレームごとのコマンドアロケーター : GPU が使い終わったフレームの分だけリセットする
+    std::array<ComPtr<ID3D12CommandAllocator>, FrameInFlightNum> m_pCmdAllocators;
     ComPtr<ID3D12GraphicsCommandList6> m_pCmdList = nullptr;
     ComPtr<ID3D12CommandQueue> m_pCmdQueue = nullptr;
 
-    ComPtr<ID3D12Fence> m_pFence = nullptr;
-    UINT64 m_fenceVal = 0;
+    std::unique_ptr<D3D12QueueFence> m_upQueueFence = nullptr;
+    FrameContextRing m_frameRing;
+
+    //--------------------
+    // アップロード関連
+    //--------------------
+    std::unique_ptr<D3D12UploadPageFactory> m_upUploadPageFactory = nullptr;
+    std::unique_ptr<FrameUploadAllocator> m_upUploadAllocator = nullptr;
 
     //--------------------
     // スワップチェイン
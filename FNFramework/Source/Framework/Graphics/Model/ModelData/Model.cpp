@@ -21,6 +21,30 @@
 
 #include "Framework/KDFramework/KdGLTFLoader.h"
 
+namespace
+{
+    /**
+    * @brief "名前_LOD1" のような LOD のノード名を、元のノード名と LOD に分ける
+    * @return LOD のノード名なら true : LOD が 1 から ModelLOD::MaxLODNum - 1 の範囲にない場合は false
+    */
+    bool ParseLODNodeName(const std::string& nodeName, std::string& baseName, UINT& lod)
+    {
+        static constexpr std::string_view Suffix = "_LOD";
+
+        const size_t pos = nodeName.rfind(Suffix);
+        if (pos == std::string::npos || pos == 0 || pos + Suffix.size() + 1 != nodeName.size()) { return false; }
+
+        const char number = nodeName.back();
+        if (number < '1' || number > '9') { return false; }
+
+        lod = static_cast<UINT>(number - '0');
+        if (lod >= ModelLOD::MaxLODNum) { return false; }
+
+        baseName = nodeName.substr(0, pos);
+        return true;
+    }
+}
+
 const std::shared_ptr<AnimationData> ModelData::GetAnimation(std::string_view _animName) const
 {
     for (auto&& anim : m_spAnimations)
@@ -49,16 +73,6 @@ std::vector<std::shared_ptr<AnimationData>>& ModelData::WorkAnimationList()
     return m_spAnimations;
 }
 
-bool ModelData::IsSkinMesh()
-{
-    for(const auto& node: m_nodes)
-    {
-        if (node.IsSkinMesh) { return true; }
-    }
-
-    return false;
-}
-
 bool ModelData::Load(const std::string& _modelName)
 {
     Release();
@@ -91,6 +105,9 @@ void ModelData::CreateNodes(const std::shared_ptr<KDFramework::KdGLTFModel>& spG
 {
     m_nodes.resize(spGltfModel->Nodes.size());
 
+    // "_LOD1" / "_LOD2" のノード : 元のノードに付けるので、描画 / 当たり判定には使わない
+    std::vector<int> lodNodeIdxList;
+
     for (UINT i = 0; i < spGltfModel->Nodes.size(); i++)
     {
         // 入力元ノード
@@ -122,14 +139,22 @@ void ModelData::CreateNodes(const std::shared_ptr<KDFramework::KdGLTFModel>& spG
         rDstNode.Bone.OffsetMatrix = rSrcNode.InverseBindMatrix;
 
         rDstNode.IsSkinMesh = rSrcNode.Mesh.IsSkinMesh;
+        m_isSkinMesh |= rDstNode.IsSkinMesh;
 
         rDstNode.Bone.Index = rSrcNode.BoneNodeIndex;
 
         rDstNode.ParentIdx = rSrcNode.Parent;
         rDstNode.Children = rSrcNode.Children;
 
+        std::string lodBaseName;
+        UINT lod = 0;
+
+        if (rSrcNode.IsMesh && ParseLODNodeName(rDstNode.NodeName, lodBaseName, lod))
+        {
+            lodNodeIdxList.push_back(i);
+        }
         // 当たり判定用ノード検索
-        if (rDstNode.NodeName.find("Col") != std::string::npos)
+        else if (rDstNode.NodeName.find("Col") != std::string::npos)
         {
             // 判定用ノードに割り当て
             m_collisionMeshNodeIdx.push_back(i);
@@ -163,6 +188,119 @@ void ModelData::CreateNodes(const std::shared_ptr<KDFramework::KdGLTFModel>& spG
         m_collisionMeshNodeIdx = m_drawMeshNodeIdx;
     }
 
+    CreateLODs(spGltfModel, lodNodeIdxList);
+}
+
+void ModelData::CreateLODs(const std::shared_ptr<KDFramework::KdGLTFModel>& spGltfModel, const std::vector<int>& lodNodeIdxList)
+{
+    //--------------------------------
+    // 作成済みの LOD を元のノードに付ける
+    //--------------------------------
+    for (int lodNodeIdx : lodNodeIdxList)
+    {
+        const Node& rLODNode = m_nodes[lodNodeIdx];
+
+        std::string baseName;
+        UINT lod = 0;
+        ParseLODNodeName(rLODNode.NodeName, baseName, lod);
+
+        // 元のノードが "名前_LOD0" の場合もある
+        Node* pBaseNode = FindNode(baseName);
+        if (!pBaseNode) { pBaseNode = FindNode(baseName + "_LOD0"); }
+
+        if (!pBaseNode || !pBaseNode->spMesh || !rLODNode.spMesh)
+        {
+            FNENG_ASSERT_LOG("LOD の元のノードが見つかりません", false);
+            continue;
+        }
+
+        if (pBaseNode->LODMeshes.size() < lod) { pBaseNode->LODMeshes.resize(lod); }
+
+        // 作られた LOD は誤差が分からないので、面の減り方から見積もる
+        const float faceRate = static_cast<float>(rLODNode.spMesh->GetFaces().size()) /
+            static_cast<float>(std::max<size_t>(pBaseNode->spMesh->GetFaces().size(), 1));
+
+        Node::LODMesh& rDstLOD = pBaseNode->LODMeshes[lod - 1];
+        rDstLOD.spMesh = rLODNode.spMesh;
+        rDstLOD.GeometricError = pBaseNode->spMesh->GetBoundingSphere().Radius *
+            (1.0f - std::sqrt(std::clamp(faceRate, 0.0f, 1.0f))) * ModelLOD::AuthoredErrorRate;
+    }
+
+    // "_LOD2" だけがある場合など、抜けている LOD は詰める
+    for (Node& rNode : m_nodes)
+    {
+        std::erase_if(rNode.LODMeshes, [](const Node::LODMesh& lodMesh) { return !lodMesh.spMesh; });
+    }
+
+    //--------------------------------
+    // 作成済みの LOD がない描画ノードは、面を減らして作る
+    //--------------------------------
+    for (int nodeIdx : m_drawMeshNodeIdx)
+    {
+        Node& rNode = m_nodes[nodeIdx];
+        if (!rNode.spMesh || !rNode.LODMeshes.empty()) { continue; }
+
+        const auto& rSrcMesh = spGltfModel->Nodes[nodeIdx].Mesh;
+        if (rSrcMesh.Faces.size() < ModelLOD::MinSimplifyFaceNum) { continue; }
+
+        size_t prevFaceNum = rSrcMesh.Faces.size();
+
+        for (float simplifyRate : ModelLOD::SimplifyRates)
+        {
+            // 粗い LOD も元のメッシュから作る : 誤差を元のメッシュから測るため
+            const UINT targetFaceNum = static_cast<UINT>(static_cast<float>(rSrcMesh.Faces.size()) * simplifyRate);
+
+            MeshSimplifier::Result result;
+            if (!MeshSimplifier::Simplify(rSrcMesh.Vertices, rSrcMesh.Faces, rSrcMesh.Subsets, targetFaceNum, result)) { break; }
+
+            // 動かさない頂点が多く面が減らないメッシュは、LOD にしても軽くならない
+            if (static_cast<float>(result.Faces.size()) > static_cast<float>(prevFaceNum) * ModelLOD::MaxKeepRate) { break; }
+            prevFaceNum = result.Faces.size();
+
+            Node::LODMesh lodMesh;
+            lodMesh.spMesh = std::make_shared<Mesh>();
+            lodMesh.spMesh->Create(result.Vertices, result.Faces, result.Subsets, rSrcMesh.IsSkinMesh);
+            lodMesh.GeometricError = result.GeometricError;
+
+            rNode.LODMeshes.push_back(std::move(lodMesh));
+        }
+    }
+
+    //--------------------------------
+    // モデル全体の LOD ごとの誤差と面の数
+    //--------------------------------
+    // LOD の少ないノードは、一番粗いメッシュを使い続ける
+    size_t lodNum = 1;
+    for (int nodeIdx : m_drawMeshNodeIdx)
+    {
+        lodNum = std::max(lodNum, m_nodes[nodeIdx].LODMeshes.size() + 1);
+    }
+
+    m_lodErrors.assign(lodNum, 0.0f);
+    m_lodFaceNums.assign(lodNum, 0);
+
+    for (UINT lod = 0; lod < lodNum; ++lod)
+    {
+        for (int nodeIdx : m_drawMeshNodeIdx)
+        {
+            const Node& rNode = m_nodes[nodeIdx];
+            if (!rNode.spMesh) { continue; }
+
+            m_lodFaceNums[lod] += static_cast<UINT>(rNode.GetMesh(lod)->GetFaces().size());
+
+            if (lod > 0 && !rNode.LODMeshes.empty())
+            {
+                const float error = rNode.LODMeshes[std::min<size_t>(lod, rNode.LODMeshes.size()) - 1].GeometricError;
+                m_lodErrors[lod] = std::max(m_lodErrors[lod], error);
+            }
+        }
+
+        // SelectLOD は粗い LOD ほど誤差が大きい前提で選ぶ
+        if (lod > 0)
+        {
+            m_lodErrors[lod] = std::max(m_lodErrors[lod], m_lodErrors[lod - 1]);
+        }
+    }
 }
 
 void ModelData::CreateMaterials(const std::shared_ptr<KDFramework::KdGLTFModel>& spGltfModel, const std::string& fileDir)
@@ -230,10 +368,14 @@ void ModelData::Release()
     m_materials.clear();
 
     m_nodes.clear();
+    m_isSkinMesh = false;
 
     m_rootNodeIdx.clear();
     m_boneNodeIdx.clear();
     m_meshNodeIdx.clear();
+
+    m_lodErrors.clear();
+    m_lodFaceNums.clear();
 }
 
 //============================================================
@@ -305,6 +447,9 @@ void ModelWork::SetModelData(const std::shared_ptr<ModelData>& _rModel)
     }
 
     m_needCalcNode = true;
+
+    // LOD の数が変わるので選び直す
+    m_lod = 0;
 }
 
 void ModelWork::SetModelData(std::string_view _fileName)
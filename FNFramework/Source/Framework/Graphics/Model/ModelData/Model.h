@@ -32,6 +32,21 @@ public:
 
         std::shared_ptr<Mesh>	spMesh;	// メッシュ
 
+        // LOD 1 以降のメッシュ : [0] が LOD 1
+        struct LODMesh
+        {
+            std::shared_ptr<Mesh> spMesh;
+            float GeometricError = 0.0f; // 元のメッシュからのずれ : モデル空間の距離
+        };
+        std::vector<LODMesh>    LODMeshes;
+
+        /* @brief LOD のメッシュ : 持っていない LOD は一番粗いメッシュを返す */
+        const std::shared_ptr<Mesh>& GetMesh(UINT lod) const
+        {
+            if (lod == 0 || LODMeshes.empty()) { return spMesh; }
+            return LODMeshes[std::min<size_t>(lod, LODMeshes.size()) - 1].spMesh;
+        }
+
         int                     ParentIdx = -1; // 親ノードのインデックス
         std::vector<int>        Children; // 子ノードのインデックス
 
@@ -104,7 +119,26 @@ public:
     // アニメーションするかどうか
     bool IsAnimation() const { return !m_spAnimations.empty(); }
 
-    bool IsSkinMesh();
+    // スキンメッシュのノードを持っているか : ノード作成時に調べておく
+    bool IsSkinMesh() const { return m_isSkinMesh; }
+
+    /* @brief 描画キューのソートキーに使う番号 : 作成順に振られ、破棄するまで変わらない */
+    UINT GetRenderID() const { return m_renderID; }
+
+    //----------------------
+    // LOD
+    /* @brief LOD の数 : 0 が元のメッシュで、LOD を持たないモデルは 1 */
+    UINT GetLODNum() const { return static_cast<UINT>(m_lodErrors.size()); }
+
+    /* @brief LOD ごとの誤差 : 描画ノードの中で一番大きいずれ。ModelLOD::SelectLOD に渡す */
+    std::span<const float> GetLODErrors() const { return m_lodErrors; }
+
+    /* @brief LOD ごとの描画ノードの面の数の合計 */
+    UINT GetLODFaceNum(UINT lod) const
+    {
+        if (m_lodFaceNums.empty()) { return 0; }
+        return m_lodFaceNums[std::min<size_t>(lod, m_lodFaceNums.size() - 1)];
+    }
 
     /**
     * @brief  マテリアルの取得
@@ -125,6 +159,15 @@ public:
     void CreateMaterials(const std::shared_ptr<KDFramework::KdGLTFModel>& spGltfModel, const  std::string& fileDir);	// マテリアル作成
     void CreateAnimations(const std::shared_ptr<KDFramework::KdGLTFModel>& spGltfModel);								// アニメーション作成
 
+    /**
+    * @brief LOD の作成 : CreateNodes から呼ぶ
+    * @details
+    *   "_LOD1" / "_LOD2" のノードがあれば元のノードに付け、なければ描画ノードのメッシュの面を減らして作る
+    * @param[in] spGltfModel     - 読み込んだモデル : 面を減らす元の頂点と面を使う
+    * @param[in] lodNodeIdxList - "_LOD1" / "_LOD2" のノードのインデックス
+    */
+    void CreateLODs(const std::shared_ptr<KDFramework::KdGLTFModel>& spGltfModel, const std::vector<int>& lodNodeIdxList);
+
     // 各種インデックスの取得 //
     const std::vector<int>& GetRootNodeIdxList() const { return m_rootNodeIdx; }
     const std::vector<int>& GetBoneNodeIdxList() const { return m_boneNodeIdx; }
@@ -167,6 +210,16 @@ private:
     std::vector<int>		m_collisionMeshNodeIdx;
     // 全ノード中、描画するノードのみのIndexn配列
     std::vector<int>		m_drawMeshNodeIdx;
+
+    bool m_isSkinMesh = false;
+
+    // LOD ごとの誤差と面の数 : [0] が元のメッシュ
+    std::vector<float>      m_lodErrors;
+    std::vector<UINT>       m_lodFaceNums;
+
+    // 描画キューで使う番号
+    inline static std::atomic<UINT> s_nextRenderID = 0;
+    UINT m_renderID = s_nextRenderID.fetch_add(1);
 };
 
 /**
@@ -269,6 +322,39 @@ public:
 
     bool NeedCalcNodeMatrices() const { return m_needCalcNode; }
 
+    //----------------------
+    // LOD
+    /* @brief 前回選んだ LOD */
+    UINT GetLOD() const { return m_lod; }
+
+    /**
+    * @brief LOD の選択 : 前回の LOD から閾値に幅を持たせて選び直す
+    * @param[in] pixelPerError - ModelLOD::CalcPixelPerError の値
+    * @return 選んだ LOD
+    */
+    UINT UpdateLOD(float pixelPerError)
+    {
+        m_lod = m_spData ? ModelLOD::SelectLOD(m_spData->GetLODErrors(), pixelPerError, m_lod) : 0;
+        return m_lod;
+    }
+
+    //----------------------
+    // スキニング用のボーン行列
+    /* @brief SkinningPalette で割り当てられたボーン行列の先頭 : buildID が違えば未割り当て */
+    bool FindPaletteOffset(UINT64 buildID, UINT& offset) const
+    {
+        if (m_paletteBuildID != buildID) { return false; }
+
+        offset = m_paletteOffset;
+        return true;
+    }
+
+    void SetPaletteOffset(UINT64 buildID, UINT offset)
+    {
+        m_paletteBuildID = buildID;
+        m_paletteOffset = offset;
+    }
+
     //--------------------------------
     // その他関数
     //--------------------------------
@@ -290,4 +376,11 @@ private:
 
     // Dirtyフラグ
     bool m_needCalcNode = false;
+
+    // SkinningPalette で割り当てられたボーン行列の先頭
+    UINT64 m_paletteBuildID = 0;
+    UINT m_paletteOffset = 0;
+
+    // 前回選んだ LOD
+    UINT m_lod = 0;
 };
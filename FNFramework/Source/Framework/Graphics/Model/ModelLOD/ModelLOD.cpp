@@ -0,0 +1,50 @@
+﻿#include "ModelLOD.h"
+
+namespace ModelLOD
+{
+    View CreateView(const Math::Vector3& pos, const Math::Matrix& mProj, float screenHeight)
+    {
+        View view;
+        view.Pos = pos;
+
+        // 射影行列の _22 は 1 / tan(fovY / 2) : 距離 1 で画面の縦幅の半分が長さ 1 / _22 になる
+        view.PixelScale = std::max(mProj._22 * screenHeight * 0.5f, 0.0f);
+
+        return view;
+    }
+
+    float CalcPixelPerError(const View& view, const Math::Vector3& sphereCenter, float sphereRadius, float worldScale)
+    {
+        if (!view.IsValid()) { return 0.0f; }
+
+        // 球の一番近い点で測る : 大きなモデルの手前側が粗くならないようにする
+        const float distance = std::max(Math::Vector3::Distance(view.Pos, sphereCenter) - sphereRadius, MinDistance);
+
+        return view.PixelScale * worldScale / distance;
+    }
+
+    UINT SelectLOD(std::span<const float> lodErrors, float pixelPerError, UINT currentLOD,
+        float errorPixel, float hysteresisRate)
+    {
+        if (lodErrors.size() <= 1 || pixelPerError <= 0.0f) { return 0; }
+
+        const UINT lodNum = static_cast<UINT>(lodErrors.size());
+        UINT lod = std::min(currentLOD, lodNum - 1);
+
+        // 今の LOD の誤差が閾値を少し超えたら細かくする
+        const float refineError = errorPixel * (1.0f + hysteresisRate);
+        while (lod > 0 && lodErrors[lod] * pixelPerError > refineError)
+        {
+            --lod;
+        }
+
+        // 次の LOD の誤差が閾値を十分下回ったら粗くする
+        const float coarsenError = errorPixel * (1.0f - hysteresisRate);
+        while (lod + 1 < lodNum && lodErrors[lod + 1] * pixelPerError <= coarsenError)
+        {
+            ++lod;
+        }
+
+        return lod;
+    }
+}
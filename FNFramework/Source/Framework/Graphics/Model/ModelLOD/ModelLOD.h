@@ -0,0 +1,80 @@
+﻿#pragma once
+
+/**
+* @namespace ModelLOD
+* @brief 画面上の誤差でモデルの LOD を選ぶ
+* @details
+*   - LOD ごとに、元のメッシュからどれだけ形がずれているか(モデル空間の距離)を持っておく
+*   - 包む球の一番カメラに近い点までの距離で、その距離を画面上のピクセル数に直す
+*   - ピクセル数が閾値を超えない中で一番粗い LOD を選ぶ
+*   - 閾値の前後で毎フレーム切り替わらないように、前回の LOD から離れる時だけ閾値に幅を持たせる
+*   - LOD のメッシュは読み込み時に MeshSimplifier で作るか、モデルに入っている "_LOD1" / "_LOD2" のノードを使う
+*   - GPU は使わない
+*/
+namespace ModelLOD
+{
+    // LOD の数の上限 : 0 が元のメッシュ
+    static constexpr UINT MaxLODNum = 3;
+
+    // 許容する画面上の誤差 : ピクセル
+    static constexpr float DefaultErrorPixel = 1.0f;
+
+    // 閾値の幅の割合 : 細かくする時は閾値を上げ、粗くする時は下げる
+    static constexpr float HysteresisRate = 0.25f;
+
+    // 球の中にカメラが入った場合の距離 : 0 で割らないようにする
+    static constexpr float MinDistance = 0.01f;
+
+    //x--- 読み込み時の LOD の作成 ---x//
+    // 面を減らして LOD を作るメッシュの最小の面の数 : 面が少ないメッシュは LOD にしても軽くならない
+    static constexpr UINT MinSimplifyFaceNum = 256;
+
+    // 元のメッシュに対する面の数の割合 : [0] が LOD 1
+    static constexpr std::array<float, MaxLODNum - 1> SimplifyRates = { 0.5f, 0.25f };
+
+    // 1つ前の LOD からこれより面が減らなかった場合は、それ以降の LOD を作らない
+    static constexpr float MaxKeepRate = 0.9f;
+
+    // 作成済みの LOD の誤差の見積もり : 包む球の半径に対する割合
+    static constexpr float AuthoredErrorRate = 0.05f;
+
+    /* @brief LOD を選ぶカメラ : 1フレームに1回作る */
+    struct View
+    {
+        Math::Vector3 Pos;
+
+        // 距離 1 にある長さ 1 が、画面上で何ピクセルになるか : 0 なら LOD を下げない
+        float PixelScale = 0.0f;
+
+        bool IsValid() const { return PixelScale > 0.0f; }
+    };
+
+    /**
+    * @brief カメラの作成
+    * @param[in] pos          - カメラの座標
+    * @param[in] mProj        - 射影行列
+    * @param[in] screenHeight - 画面の縦幅 : ピクセル
+    */
+    View CreateView(const Math::Vector3& pos, const Math::Matrix& mProj, float screenHeight);
+
+    /**
+    * @brief 距離 1 の誤差が画面上で何ピクセルになるか
+    * @param[in] view         - カメラ
+    * @param[in] sphereCenter - 包む球の中心 : ワールド空間
+    * @param[in] sphereRadius - 包む球の半径
+    * @param[in] worldScale   - モデル空間の誤差に掛ける拡大率
+    * @return カメラが無効なら 0
+    */
+    float CalcPixelPerError(const View& view, const Math::Vector3& sphereCenter, float sphereRadius, float worldScale);
+
+    /**
+    * @brief LOD の選択
+    * @param[in] lodErrors      - LOD ごとの誤差 : 0 番は 0 で、粗い LOD ほど大きい
+    * @param[in] pixelPerError  - CalcPixelPerError の値 : 0 以下なら LOD 0 を返す
+    * @param[in] currentLOD     - 前回の LOD
+    * @param[in] errorPixel     - 許容する画面上の誤差
+    * @param[in] hysteresisRate - 閾値の幅の割合
+    */
+    UINT SelectLOD(std::span<const float> lodErrors, float pixelPerError, UINT currentLOD,
+        float errorPixel = DefaultErrorPixel, float hysteresisRate = HysteresisRate);
+}
@@ -135,8 +135,16 @@ void PipeLine::Create(std::vector<ID3DBlob*> pBlobs, const std::vector<DXGI_FORM
 void PipeLine::SetInputLayout(std::vector<D3D12_INPUT_ELEMENT_DESC>& inputElements,
                               const std::vector<InputLayout>& inputLayouts, bool useInstanceData)
 {
+    // Mesh の頂点はストリームが分かれているので、インスタンスデータはその後ろのスロットになる
+    UINT instanceSlot = 1;
+
     for (int i = 0; i < static_cast<int>(inputLayouts.size()); ++i)
     {
+        if (inputLayouts[i] >= InputLayout::MESH_POSITION)
+        {
+            instanceSlot = MeshStream::InstanceSlot;
+        }
+
         if (inputLayouts[i] == InputLayout::POSITION)
         {
             inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
@@ -186,37 +194,93 @@ void PipeLine::SetInputLayout(std::vector<D3D12_INPUT_ELEMENT_DESC>& inputElemen
                 D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
             });
         }
+        //x--- Mesh の頂点 : 使わない要素を飛ばせるように、オフセットは構造体から取る ---x//
+        else if (inputLayouts[i] == InputLayout::MESH_POSITION)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, MeshStream::PositionSlot,
+                0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
+        else if (inputLayouts[i] == InputLayout::MESH_TEXCOORD)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, MeshStream::AttributeSlot,
+                offsetof(MeshAttributeVertex, UV), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
+        else if (inputLayouts[i] == InputLayout::MESH_COLOR)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, MeshStream::AttributeSlot,
+                offsetof(MeshAttributeVertex, Color), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
+        else if (inputLayouts[i] == InputLayout::MESH_NORMAL)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, MeshStream::AttributeSlot,
+                offsetof(MeshAttributeVertex, Normal), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
+        else if (inputLayouts[i] == InputLayout::MESH_TANGENT)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "TANGENT", 0, DXGI_FORMAT_R16G16_SNORM, MeshStream::AttributeSlot,
+                offsetof(MeshAttributeVertex, Tangent), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
+        else if (inputLayouts[i] == InputLayout::MESH_SKININDEX)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "SKININDEX", 0, DXGI_FORMAT_R16G16B16A16_UINT, MeshStream::SkinSlot,
+                offsetof(MeshSkinVertex, BoneIDs), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
+        else if (inputLayouts[i] == InputLayout::MESH_SKINWEIGHT)
+        {
+            inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+                "SKINWEIGHT", 0, DXGI_FORMAT_R8G8B8A8_UNORM, MeshStream::SkinSlot,
+                offsetof(MeshSkinVertex, BoneWeights), D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0
+            });
+        }
     }
 
     if(useInstanceData)
     {
 
         inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
-            "INSTANCE_WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,
+            "INSTANCE_WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, instanceSlot,
             0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
             });
         inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
-            "INSTANCE_WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,
+            "INSTANCE_WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, instanceSlot,
             D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
             });
         inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
-            "INSTANCE_WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,
+            "INSTANCE_WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, instanceSlot,
             D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
             });
         inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
-            "INSTANCE_WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,
+            "INSTANCE_WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, instanceSlot,
             D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
             });
 
         // タイリング / オフセット (float4)
         inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
-            "INSTANCE_TILING_OFFSET", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,
+            "INSTANCE_TILING_OFFSET", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, instanceSlot,
             D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
             });
 
         // カラー情報 (float4)
         inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
-            "INSTANCE_COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1,
+            "INSTANCE_COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, instanceSlot,
+            D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
+            });
+
+        // ボーン行列の先頭 (uint)
+        inputElements.emplace_back(D3D12_INPUT_ELEMENT_DESC{
+            "INSTANCE_BONE_OFFSET", 0, DXGI_FORMAT_R32_UINT, instanceSlot,
             D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1
             });
     }
@@ -25,6 +25,16 @@ enum class InputLayout
     COLOR, // 頂点の色
     SKININDEX, // スキニング用のボーンインデックス
     SKINWEIGHT, // スキニング用のボーンの重み
+
+    // Mesh の頂点 : MeshStream のスロットに分かれていて、量子化されている
+    // 1つでも使う場合、インスタンスデータは MeshStream::InstanceSlot から読む
+    MESH_POSITION, // float3
+    MESH_TEXCOORD, // half2
+    MESH_COLOR, // unorm8 x 4
+    MESH_NORMAL, // 八面体に展開した snorm16 x 2 : シェーダーで OctDecode する
+    MESH_TANGENT, // 八面体に展開した snorm16 x 2 : シェーダーで OctDecode する
+    MESH_SKININDEX, // uint16 x 4
+    MESH_SKINWEIGHT, // unorm8 x 4
 };
 
 // プリミティブトポロジー
@@ -19,10 +19,10 @@ void RootSignature::Create(const std::vector<RangeType>& rangeTypes, UINT& cbvCo
         switch (rangeTypes[i])
         {
         case RangeType::CBV:
-            CreateRange(ranges[i], RangeType::CBV, cbvCount);
-            rootParams[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-            rootParams[i].DescriptorTable.pDescriptorRanges = &ranges[i];
-            rootParams[i].DescriptorTable.NumDescriptorRanges = 1;
+            // 定数バッファはルートCBVにして、GPUアドレスを直接バインドする : ビューを作らなくて良い
+            rootParams[i].ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
+            rootParams[i].Descriptor.ShaderRegister = cbvCount;
+            rootParams[i].Descriptor.RegisterSpace = 0;
             rootParams[i].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
             ++cbvCount;
             break;
@@ -1,5 +1,30 @@
 ﻿#include "Mesh.h"
 
+namespace
+{
+    // アップロードヒープのバッファに書き込む
+    template<class T>
+    bool WriteBuffer(ID3D12Resource* pBuffer, const std::vector<T>& srcDatas)
+    {
+        T* pMap = nullptr;
+        if (FAILED(pBuffer->Map(0, nullptr, reinterpret_cast<void**>(&pMap))))
+        {
+            FNENG_ASSERT_ERROR("頂点バッファのマップに失敗しました");
+            return false;
+        }
+
+        std::copy(srcDatas.begin(), srcDatas.end(), pMap);
+        pBuffer->Unmap(0, nullptr);
+        return true;
+    }
+
+    // 1頂点あたりの GPU に送るサイズ
+    UINT GetStreamVertexSize(bool isSkinMesh)
+    {
+        return sizeof(Math::Vector3) + sizeof(MeshAttributeVertex) + (isSkinMesh ? sizeof(MeshSkinVertex) : 0);
+    }
+}
+
 void Material::SetTextures(const std::shared_ptr<ShaderResourceTexture>& spBaseColTex,
     const std::shared_ptr<ShaderResourceTexture>& spMtRfColTex,
     const std::shared_ptr<ShaderResourceTexture>& spEmiColTex,
@@ -66,15 +91,30 @@ void Mesh::Create(const std::vector<MeshVertex>& vertices,
         return;
     }
 
+    // スキンメッシュかどうか : スキンのストリームを作るかどうかに使う
+    m_isSkinMesh = isSkinMesh;
+
     //===============================
     // サブセットの作成
     //===============================
     m_subsets = subsets;
 
+    //===============================
+    // 面 / 頂点の並べ替え
+    //===============================
+    std::vector<MeshVertex> optimizedVertices = vertices;
+    std::vector<MeshFace> optimizedFaces = faces;
+    MeshOptimizer::Optimize(optimizedVertices, optimizedFaces, m_subsets);
+
+    // 元の MeshVertex のままだった場合と比べる
+    MeshOptimizer::AddTotalStats(
+        MeshOptimizer::MeasureStats(faces, static_cast<UINT>(vertices.size()), sizeof(MeshVertex)),
+        MeshOptimizer::MeasureStats(optimizedFaces, static_cast<UINT>(optimizedVertices.size()), GetStreamVertexSize(m_isSkinMesh)));
+
     //===============================
     // バッファ / 頂点の作成
     //===============================
-    CreateVertexBuffers(vertices);
+    CreateVertexBuffers(optimizedVertices);
 
     // 作成されたバッファを元に境界データを作成する
     DirectX::BoundingBox::CreateFromPoints(m_boundingBox, m_positions.size(), m_positions.data(), sizeof(Math::Vector3));
@@ -83,27 +123,49 @@ void Mesh::Create(const std::vector<MeshVertex>& vertices,
     //===============================
     // バッファ / インデックスの作成
     //===============================
-    CreateIndexBufferAndFaceData(faces);
-
-    // スキンメッシュかどうか
-    m_isSkinMesh = isSkinMesh;
+    CreateIndexBufferAndFaceData(optimizedFaces);
 
     //===============================
-    // インスタンスバッファの初期化
+    // クラスターの作成
     //===============================
-    // 初期インスタンス数を設定（必要に応じて調整）
-    UINT initialInstanceCount = 100; // 初期で100インスタンス分のバッファを確保
-    if (!InitializeInstanceBuffer(initialInstanceCount))
+    CreateClusters();
+}
+
+void Mesh::CreateClusters()
+{
+    m_clusters.clear();
+    m_subsetClusterStarts.clear();
+    m_subsetClusterStarts.reserve(m_subsets.size() + 1);
+
+    const UINT faceNum = static_cast<UINT>(m_faces.size());
+    for (const MeshSubset& subset : m_subsets)
     {
-        FNENG_ASSERT_ERROR("インスタンスバッファの初期化に失敗しました");
-        return;
+        m_subsetClusterStarts.push_back(static_cast<UINT>(m_clusters.size()));
+
+        const UINT faceStart = std::min(subset.FaceStart, faceNum);
+        const UINT faceCount = std::min(subset.FaceCount, faceNum - faceStart);
+        MeshCluster::Build(std::span<const MeshFace>(m_faces).subspan(faceStart, faceCount), faceStart, m_positions, m_clusters);
     }
+    m_subsetClusterStarts.push_back(static_cast<UINT>(m_clusters.size()));
 }
 
 void Mesh::CreateVertexBuffers(const std::vector<MeshVertex>& _vertices)
 {
+    const UINT vertexNum = static_cast<UINT>(_vertices.size());
+
     // バッファ / ビューの作成
-    CreateVertexBuffer(sizeof(MeshVertex), static_cast<UINT>(_vertices.size()));
+    CreateVertexBuffer(sizeof(Math::Vector3), vertexNum);
+    CreateUploadVertexBuffer(sizeof(MeshAttributeVertex), vertexNum, m_pAttributeBuffer, m_attributeView);
+
+    if (m_isSkinMesh)
+    {
+        CreateUploadVertexBuffer(sizeof(MeshSkinVertex), vertexNum, m_pSkinBuffer, m_skinView);
+    }
+    else
+    {
+        m_pSkinBuffer.Reset();
+        m_skinView = {};
+    }
 
     // 頂点情報格納
     UpdateBuffer(_vertices);
@@ -119,10 +181,10 @@ void Mesh::UpdateBuffer(const std::vector<MeshVertex>& srcDatas)
         m_positions[i] = srcDatas[i].Position;
     }
     // 頂点バッファのサイズを超えている場合はエラーを出して終了
-    if (sizeof(MeshVertex) * srcDatas.size() > m_vbView.SizeInBytes)
+    if (sizeof(Math::Vector3) * srcDatas.size() > m_vbView.SizeInBytes)
     {
         // バッファを再確保
-        Vertices::CreateVertexBuffer(sizeof(MeshVertex), static_cast<UINT>(srcDatas.size()));
+        CreateVertexBuffers(srcDatas);
 
         FNENG_ASSERT_ERROR("更新データが頂点バッファのサイズを超えています");
         return;
@@ -130,127 +192,72 @@ void Mesh::UpdateBuffer(const std::vector<MeshVertex>& srcDatas)
 
     m_vertexCount = static_cast<UINT>(srcDatas.size());
 
-    // 頂点バッファに情報を描き込む
-    MeshVertex* vbMap = nullptr;
+    //===============================
+    // 量子化
+    //===============================
+    std::vector<MeshAttributeVertex> attributes(srcDatas.size());
+    for (size_t i = 0; i < srcDatas.size(); ++i)
     {
-        auto hr = m_pVBuffer->Map(0, nullptr, (void**)&vbMap);
+        const MeshVertex& src = srcDatas[i];
+        MeshAttributeVertex& dst = attributes[i];
 
-        if (FAILED(hr))
+        dst.UV = MeshOptimizer::EncodeHalf2(src.UV);
+        dst.Color = src.Color;
+        dst.Normal = MeshOptimizer::EncodeOctahedral(src.Normal);
+        dst.Tangent = MeshOptimizer::EncodeOctahedral(src.Tangent);
+    }
+
+    // 頂点バッファに情報を描き込む
+    if (!WriteBuffer(m_pVBuffer.Get(), m_positions)) { return; }
+    if (!WriteBuffer(m_pAttributeBuffer.Get(), attributes)) { return; }
+
+    if (m_pSkinBuffer)
+    {
+        std::vector<MeshSkinVertex> skins(srcDatas.size());
+        for (size_t i = 0; i < srcDatas.size(); ++i)
         {
-            FNENG_ASSERT_ERROR("頂点バッファのマップに失敗しました");
-            return;
+            for (size_t boneIdx = 0; boneIdx < skins[i].BoneIDs.size(); ++boneIdx)
+            {
+                skins[i].BoneIDs[boneIdx] = static_cast<UINT16>(srcDatas[i].BoneIDs[boneIdx]);
+            }
+            skins[i].BoneWeights = MeshOptimizer::QuantizeWeights(srcDatas[i].BoneWeights);
         }
 
-        std::copy(std::begin(srcDatas), std::end(srcDatas), vbMap); // m_verticesの中身をvbMapにコピーする
-        m_pVBuffer->Unmap(0, nullptr);
+        WriteBuffer(m_pSkinBuffer.Get(), skins);
     }
 }
 
-bool Mesh::InitializeInstanceBuffer(UINT initialInstanceCount)
+void Mesh::UpdateInstanceBuffer(std::span<const InstanceData> instanceDataList)
 {
-    UINT bufferSize = initialInstanceCount * sizeof(InstanceData);
-    m_currentInstanceCapacity = initialInstanceCount;
-
-    CreateInstanceBufferResource(bufferSize);
+    // 記録中のフレームのアップロード領域にコピー
+    UploadAllocation allocation = GraphicsDevice::Instance().GetUploadAllocator()->Upload(instanceDataList, sizeof(InstanceData));
 
-    // 初期化データをゼロクリア
-    InstanceData* pMappedData = nullptr;
-    HRESULT hr = m_pInstanceBuffer->Map(0, nullptr, reinterpret_cast<void**>(&pMappedData));
-    if (FAILED(hr))
+    if (!allocation.IsValid())
     {
-        FNENG_ASSERT_ERROR("インスタンスバッファのマップに失敗しました");
-        return false;
+        m_instanceBufferView = {};
+        return;
     }
-    memset(pMappedData, 0, bufferSize);
-    m_pInstanceBuffer->Unmap(0, nullptr);
 
-    // インスタンスバッファビューの設定
-    m_instanceBufferView.BufferLocation = m_pInstanceBuffer->GetGPUVirtualAddress();
-    m_instanceBufferView.SizeInBytes = bufferSize;
+    // インスタンスバッファビューを設定
+    m_instanceBufferView.BufferLocation = allocation.GPUAddress;
+    m_instanceBufferView.SizeInBytes = static_cast<UINT>(allocation.Size);
     m_instanceBufferView.StrideInBytes = sizeof(InstanceData);
-
-    return true;
 }
 
-void Mesh::CreateInstanceBufferResource(UINT bufferSize)
+void Mesh::SetVertexBuffers() const
 {
-    // ヒーププロパティの設定（UPLOADヒープ）
-    CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-
-    // リソースディスクリプタの設定
-    CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-
-    // デバイスの取得
-    auto device = GraphicsDevice::Instance().GetDevice();
-
-    // バッファの作成
-    HRESULT hr = device->CreateCommittedResource(
-        &heapProps,
-        D3D12_HEAP_FLAG_NONE,
-        &bufferDesc,
-        D3D12_RESOURCE_STATE_GENERIC_READ,
-        nullptr,
-        IID_PPV_ARGS(&m_pInstanceBuffer)
-    );
-    if (FAILED(hr))
-    {
-        FNENG_ASSERT_ERROR("インスタンスバッファの作成に失敗しました");
-        return;
-    }
-}
-
-void Mesh::UpdateInstanceBuffer(const std::vector<InstanceData>& instanceDataList)
-{
-    UINT instanceCount = static_cast<UINT>(instanceDataList.size());
-    UINT bufferSize = sizeof(InstanceData) * instanceCount;
-
-    // バッファの容量チェックとリサイズ
-    if (m_pInstanceBuffer == nullptr || m_currentInstanceCapacity < instanceCount)
-    {
-        // 古いバッファを解放
-        m_pInstanceBuffer.Reset();
-
-        // 新しいバッファを作成
-        m_currentInstanceCapacity = instanceCount;
+    // MeshStream のスロットの順 : 頂点の各ストリームとインスタンスバッファ
+    const D3D12_VERTEX_BUFFER_VIEW vbViews[] = { m_vbView, m_attributeView, m_skinView, m_instanceBufferView };
+    static_assert(_countof(vbViews) == MeshStream::InstanceSlot + 1);
 
-        auto device = GraphicsDevice::Instance().GetDevice();
-        CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-        CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-
-        HRESULT hr = device->CreateCommittedResource(
-            &heapProps,
-            D3D12_HEAP_FLAG_NONE,
-            &bufferDesc,
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&m_pInstanceBuffer));
-
-        if (FAILED(hr))
-        {
-            FNENG_ASSERT_ERROR("インスタンスバッファの作成に失敗しました");
-            return;
-        }
-
-        // インスタンスバッファビューを設定
-        m_instanceBufferView.BufferLocation = m_pInstanceBuffer->GetGPUVirtualAddress();
-        m_instanceBufferView.SizeInBytes = bufferSize;
-        m_instanceBufferView.StrideInBytes = sizeof(InstanceData);
-    }
-
-    // データのコピー
-    void* pData = nullptr;
-    m_pInstanceBuffer->Map(0, nullptr, &pData);
-    memcpy(pData, instanceDataList.data(), bufferSize);
-    m_pInstanceBuffer->Unmap(0, nullptr);
+    GraphicsDevice::Instance().GetCmdList()->IASetVertexBuffers(MeshStream::PositionSlot, _countof(vbViews), vbViews);
 }
 
 void Mesh::DrawInstanced(UINT instanceCount) const
 {
     const auto& pCmdList = GraphicsDevice::Instance().GetCmdList();
 
-    // 頂点バッファビューの配列を設定（頂点バッファとインスタンスバッファ）
-    D3D12_VERTEX_BUFFER_VIEW vbViews[] = { m_vbView, m_instanceBufferView };
-    pCmdList->IASetVertexBuffers(0, _countof(vbViews), vbViews);
+    SetVertexBuffers();
 
     // インデックスバッファの設定（存在する場合）
     if (m_ibView.SizeInBytes > 0)
@@ -273,9 +280,7 @@ void Mesh::DrawSubset(UINT subsetNo) const
 
     const auto& pCmdList = GraphicsDevice::Instance().GetCmdList();
 
-    // 頂点バッファビューの配列を設定（頂点バッファとインスタンスバッファ）
-    D3D12_VERTEX_BUFFER_VIEW vbViews[] = { m_vbView, m_instanceBufferView };
-    pCmdList->IASetVertexBuffers(0, _countof(vbViews), vbViews);
+    SetVertexBuffers();
 
     // インデックスバッファの設定（存在する場合）
     if (m_ibView.SizeInBytes > 0)
@@ -292,10 +297,8 @@ void Mesh::DrawSubset(UINT subsetNo) const
 void Mesh::DrawSubsetInstanced(UINT subsetIndex, UINT instanceCount) const
 {
     const auto& pCmdList = GraphicsDevice::Instance().GetCmdList();
-    
-    // 頂点バッファビューの配列を設定（頂点バッファとインスタンスバッファ）
-    D3D12_VERTEX_BUFFER_VIEW vbViews[] = { m_vbView, m_instanceBufferView };
-    pCmdList->IASetVertexBuffers(0, _countof(vbViews), vbViews);
+
+    SetVertexBuffers();
 
     // インデックスバッファの設定
     pCmdList->IASetIndexBuffer(&m_ibView);
@@ -304,3 +307,18 @@ void Mesh::DrawSubsetInstanced(UINT subsetIndex, UINT instanceCount) const
     const MeshSubset& subset = m_subsets[subsetIndex];
     pCmdList->DrawIndexedInstanced(subset.FaceCount * 3, instanceCount, subset.FaceStart * 3, 0, 0);
 }
+
+void Mesh::DrawFaceRanges(std::span<const MeshCluster::FaceRange> faceRanges, UINT instanceCount) const
+{
+    if (faceRanges.empty()) { return; }
+
+    const auto& pCmdList = GraphicsDevice::Instance().GetCmdList();
+
+    SetVertexBuffers();
+    pCmdList->IASetIndexBuffer(&m_ibView);
+
+    for (const MeshCluster::FaceRange& range : faceRanges)
+    {
+        pCmdList->DrawIndexedInstanced(range.FaceCount * 3, instanceCount, range.FaceStart * 3, 0, 0);
+    }
+}
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "../Vertices/Vertices.h"
+#include "MeshCluster.h"
 
 //--------------------------------
 // メッシュの頂点情報
@@ -18,6 +19,32 @@ struct MeshVertex
     std::array<float, 4>	BoneWeights;		// スキニングウェイトリスト
 };
 
+//--------------------------------
+// GPU に送るメッシュの頂点 : 読み込み時に MeshVertex を量子化し、用途ごとのストリームに分ける
+//--------------------------------
+namespace MeshStream
+{
+    static constexpr UINT PositionSlot = 0;  // 座標 : float3 のまま送る
+    static constexpr UINT AttributeSlot = 1; // MeshAttributeVertex
+    static constexpr UINT SkinSlot = 2;      // MeshSkinVertex : スキンメッシュだけが持つ
+    static constexpr UINT InstanceSlot = 3;  // InstanceData
+}
+
+// シャドウマップなど座標しか使わないパスは読まない
+struct MeshAttributeVertex
+{
+    std::array<UINT16, 2> UV = {};      // half
+    UINT Color = 0xFFFFFFFF;            // unorm8 x 4
+    std::array<INT16, 2> Normal = {};   // 八面体に展開した snorm16
+    std::array<INT16, 2> Tangent = {};  // 八面体に展開した snorm16
+};
+
+struct MeshSkinVertex
+{
+    std::array<UINT16, 4> BoneIDs = {};
+    std::array<UINT8, 4> BoneWeights = {}; // unorm8 : 合計が 255 になるように丸める
+};
+
 //==========================================================
 // メッシュ用 サブセット情報
 //==========================================================
@@ -58,6 +85,7 @@ struct InstanceData
     Math::Matrix mWorld;
     Math::Vector4 TilingOffset = { 1.0f, 1.0f, 0.0f, 0.0f };
     Math::Vector4 Color = Color::White;
+    UINT BoneOffset = 0; // スキンメッシュの場合、SkinningPalette 内のボーン行列の先頭
 };
 
 /**
@@ -116,6 +144,24 @@ public:
 
     const std::vector<MeshSubset>&	GetSubsets() const { return m_subsets; }
 
+    /* @brief サブセットのクラスター : 面の番号の順に並んでいる */
+    std::span<const MeshCluster::Cluster> GetSubsetClusters(UINT subsetIndex) const
+    {
+        if (subsetIndex + 1 >= m_subsetClusterStarts.size()) { return {}; }
+
+        const UINT start = m_subsetClusterStarts[subsetIndex];
+        return std::span<const MeshCluster::Cluster>(m_clusters).subspan(start, m_subsetClusterStarts[subsetIndex + 1] - start);
+    }
+
+    /**
+    * @brief クラスター単位でカリングするか
+    * @details スキンメッシュは頂点が動いて包む球から外れるのでカリングしない
+    */
+    bool CanCullClusters() const
+    {
+        return !m_isSkinMesh && m_clusters.size() >= MeshCluster::MinCullClusterNum;
+    }
+
 
     //--------------------------------
     // その他関数
@@ -135,21 +181,26 @@ public:
 
     /**
      * @brief 頂点バッファ生成
+     * @details 座標 / 属性 / スキンのストリームを作る : スキンはスキンメッシュの場合だけ
      * @param[in] vertices - 頂点データ
      */
     void CreateVertexBuffers(const std::vector<MeshVertex>& vertices);
 
     /**
      * @brief バッファの更新
+     * @details 量子化してストリームごとのバッファに書き込む
      * @param[in] srcDatas - 更新するデータ
      */
     void UpdateBuffer(const std::vector<MeshVertex>& srcDatas);
 
-    // インスタンスバッファの初期化
-    bool InitializeInstanceBuffer(UINT initialInstanceCount = 100);
-
-    // インスタンスバッファの更新（自動リサイズ対応）
-    void UpdateInstanceBuffer(const std::vector<InstanceData>& instanceData);
+    /**
+     * @brief インスタンスバッファの更新
+     * @details
+     *   FrameUploadAllocator から切り出した領域にコピーし、次の描画からその領域を使う
+     *   描画のたびに新しい領域を使うので、同じフレームの別のパスで更新しても前の描画のデータは上書きされない
+     * @param[in] instanceData - インスタンスごとのデータ
+     */
+    void UpdateInstanceBuffer(std::span<const InstanceData> instanceData);
 
     // インスタンス描画
     void DrawInstanced(UINT instanceCount) const override;
@@ -161,28 +212,45 @@ public:
     void DrawSubset(UINT subsetNo) const;
     void DrawSubsetInstanced(UINT subsetIndex, UINT instanceCount) const;
 
+    /**
+    * @brief 面の範囲ごとに描画
+    * @details MeshCluster::Cull で残った範囲を描画する : 頂点 / インデックスバッファの設定は1回だけ行う
+    * @param[in] faceRanges    - 描画する面の範囲
+    * @param[in] instanceCount - インスタンス数
+    */
+    void DrawFaceRanges(std::span<const MeshCluster::FaceRange> faceRanges, UINT instanceCount) const;
+
 private:
 
     // サブセット情報
     std::vector<MeshSubset>	m_subsets;
 
+    // クラスター : サブセットの順に並んでいて、サブセット i のクラスターは [starts[i], starts[i + 1])
+    std::vector<MeshCluster::Cluster> m_clusters;
+    std::vector<UINT> m_subsetClusterStarts;
+
     std::vector<Math::Vector3> m_positions; // 頂点座標(copy)
 
     UINT m_instanceCount = 0; // インスタンス数
 
+    // 座標以外の頂点ストリーム : 座標は Vertices の頂点バッファに入れる
+    ComPtr<ID3D12Resource> m_pAttributeBuffer = nullptr;
+    D3D12_VERTEX_BUFFER_VIEW m_attributeView = {};
+    ComPtr<ID3D12Resource> m_pSkinBuffer = nullptr;
+    D3D12_VERTEX_BUFFER_VIEW m_skinView = {}; // スキンメッシュでなければ空 : 読むと 0 になる
+
     // 境界データ
     DirectX::BoundingBox m_boundingBox; // バウンディングボックス
     DirectX::BoundingSphere m_boundingSphere; // バウンディングスフィア
 
     bool						m_isSkinMesh = false;
 
-    // インスタンスバッファ関連
-    ComPtr<ID3D12Resource> m_pInstanceBuffer = nullptr;
+    // インスタンスバッファビュー : 最後に UpdateInstanceBuffer で切り出した領域を指す
     D3D12_VERTEX_BUFFER_VIEW m_instanceBufferView = {};
 
-    // 現在のバッファ容量
-    UINT m_currentInstanceCapacity = 0;
+    // 描画時に設定する頂点バッファビュー : MeshStream のスロットの順
+    void SetVertexBuffers() const;
 
-    // インスタンスバッファのリソースを作成
-    void CreateInstanceBufferResource(UINT bufferSize);
+    // 並べ替えた後の面からクラスターを作る
+    void CreateClusters();
 };
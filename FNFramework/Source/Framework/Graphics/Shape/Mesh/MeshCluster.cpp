@@ -0,0 +1,216 @@
+﻿#include "MeshCluster.h"
+
+namespace
+{
+    // 包む球とコーンを計算する
+    void CalcBounds(std::span<const MeshFace> faces, const std::vector<UINT>& vertexIndices,
+        const std::vector<Math::Vector3>& positions, MeshCluster::Cluster& cluster)
+    {
+        //===============================
+        // 包む球 : AABB の中心から一番遠い頂点まで
+        //===============================
+        Math::Vector3 minPos = positions[vertexIndices.front()];
+        Math::Vector3 maxPos = minPos;
+        for (UINT idx : vertexIndices)
+        {
+            minPos = Math::Vector3::Min(minPos, positions[idx]);
+            maxPos = Math::Vector3::Max(maxPos, positions[idx]);
+        }
+
+        cluster.Center = (minPos + maxPos) * 0.5f;
+
+        float radiusSq = 0.0f;
+        for (UINT idx : vertexIndices)
+        {
+            radiusSq = std::max(radiusSq, Math::Vector3::DistanceSquared(cluster.Center, positions[idx]));
+        }
+        cluster.Radius = std::sqrt(radiusSq);
+
+        //===============================
+        // コーン : 面の法線の平均と、そこから一番離れた法線
+        //===============================
+        // 法線は巻き順から求める : 頂点の法線ではなく、ラスタライザが表裏を決める向きで判定する
+        std::vector<Math::Vector3> normals;
+        normals.reserve(faces.size());
+
+        Math::Vector3 axis = Math::Vector3::Zero;
+        for (const MeshFace& face : faces)
+        {
+            const Math::Vector3& p0 = positions[face.Idx[0]];
+            Math::Vector3 normal = (positions[face.Idx[1]] - p0).Cross(positions[face.Idx[2]] - p0);
+
+            // 潰れた面は向きがないので含めない
+            const float length = normal.Length();
+            if (length <= 0.0f) { continue; }
+
+            normal /= length;
+            normals.push_back(normal);
+            axis += normal;
+        }
+
+        cluster.ConeCutoff = 1.0f;
+
+        const float axisLength = axis.Length();
+        if (normals.empty() || axisLength <= 0.0f) { return; }
+
+        cluster.ConeAxis = axis / axisLength;
+
+        float minDot = 1.0f;
+        for (const Math::Vector3& normal : normals)
+        {
+            minDot = std::min(minDot, normal.Dot(cluster.ConeAxis));
+        }
+
+        if (minDot < MeshCluster::MinConeDot) { return; }
+
+        cluster.ConeCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+namespace MeshCluster
+{
+    Stats& Stats::operator+=(const Stats& other)
+    {
+        ClusterNum += other.ClusterNum;
+        VisibleClusterNum += other.VisibleClusterNum;
+        FaceNum += other.FaceNum;
+        VisibleFaceNum += other.VisibleFaceNum;
+        RangeNum += other.RangeNum;
+        return *this;
+    }
+
+    void Build(std::span<const MeshFace> faces, UINT faceStart,
+        const std::vector<Math::Vector3>& positions, std::vector<Cluster>& clusters)
+    {
+        if (faces.empty() || positions.empty()) { return; }
+
+        // 頂点が今のクラスターに入っているか : 入れたクラスターの番号 + 1 を持つ
+        std::vector<UINT> vertexMarks(positions.size(), 0);
+        UINT mark = 0;
+
+        std::vector<UINT> vertexIndices;
+        vertexIndices.reserve(MaxVertexNum);
+
+        UINT clusterBegin = 0;
+
+        const auto flush = [&](UINT clusterEnd)
+        {
+            Cluster cluster;
+            cluster.FaceStart = faceStart + clusterBegin;
+            cluster.FaceCount = clusterEnd - clusterBegin;
+            CalcBounds(faces.subspan(clusterBegin, cluster.FaceCount), vertexIndices, positions, cluster);
+            clusters.push_back(cluster);
+
+            clusterBegin = clusterEnd;
+            vertexIndices.clear();
+            ++mark;
+        };
+
+        ++mark;
+        for (UINT faceIdx = 0; faceIdx < faces.size(); ++faceIdx)
+        {
+            const MeshFace& face = faces[faceIdx];
+
+            // この面で増える頂点の数 : 潰れた面は同じ頂点を2回数えないようにする
+            UINT newVertexNum = 0;
+            for (UINT i = 0; i < 3; ++i)
+            {
+                const UINT idx = face.Idx[i];
+                const bool isDuplicated = (i > 0 && face.Idx[0] == idx) || (i > 1 && face.Idx[1] == idx);
+                if (vertexMarks[idx] != mark && !isDuplicated) { ++newVertexNum; }
+            }
+
+            const bool isFull = vertexIndices.size() + newVertexNum > MaxVertexNum ||
+                                faceIdx - clusterBegin >= MaxFaceNum;
+            if (isFull && faceIdx > clusterBegin)
+            {
+                flush(faceIdx);
+            }
+
+            for (UINT idx : face.Idx)
+            {
+                if (vertexMarks[idx] == mark) { continue; }
+
+                vertexMarks[idx] = mark;
+                vertexIndices.push_back(idx);
+            }
+        }
+
+        flush(static_cast<UINT>(faces.size()));
+    }
+
+    CullView CreateCullView(const Math::Matrix& mWorld, const Math::Matrix& mViewProj, const Math::Vector3& cameraPos)
+    {
+        CullView view;
+
+        // ワールド行列を掛けた行列から取り出すと、モデル空間の平面になる
+        view.Planes = FrustumCulling::ExtractPlanes(mWorld * mViewProj);
+
+        Math::Matrix mInvWorld;
+        mWorld.Invert(mInvWorld);
+        view.CameraPos = Math::Vector3::Transform(cameraPos, mInvWorld);
+
+        // 回転と一様な拡大だけなら、モデル空間でも面の表裏の判定は変わらない
+        const float scaleX = Math::Vector3(mWorld._11, mWorld._12, mWorld._13).Length();
+        const float scaleY = Math::Vector3(mWorld._21, mWorld._22, mWorld._23).Length();
+        const float scaleZ = Math::Vector3(mWorld._31, mWorld._32, mWorld._33).Length();
+        const float minScale = std::min({ scaleX, scaleY, scaleZ });
+        const float maxScale = std::max({ scaleX, scaleY, scaleZ });
+
+        view.UseCone = mWorld.Determinant() > 0.0f && minScale > 0.0f &&
+                       maxScale - minScale <= minScale * UniformScaleTolerance;
+
+        return view;
+    }
+
+    bool IsVisible(const Cluster& cluster, const CullView& view)
+    {
+        for (const Math::Vector4& plane : view.Planes.Plane)
+        {
+            const float distance = plane.x * cluster.Center.x + plane.y * cluster.Center.y + plane.z * cluster.Center.z + plane.w;
+            if (distance < -cluster.Radius) { return false; }
+        }
+
+        if (!view.UseCone || cluster.ConeCutoff >= 1.0f) { return true; }
+
+        // 球の中のどの点から見ても、コーンの中のどの法線もカメラの反対を向いていれば裏向き
+        //   点 p への向きとコーンの軸の角度が (90度 - 広がりの角度) より小さければよい
+        //   球の中の点では、軸方向の距離は半径だけ縮み、点までの距離は半径だけ伸びる
+        const Math::Vector3 toCenter = cluster.Center - view.CameraPos;
+        const float distance = toCenter.Length();
+        const float axisDistance = toCenter.Dot(cluster.ConeAxis);
+
+        return axisDistance - cluster.Radius <= cluster.ConeCutoff * (distance + cluster.Radius);
+    }
+
+    void Cull(std::span<const Cluster> clusters, const CullView& view, std::vector<FaceRange>& ranges, Stats& stats)
+    {
+        const size_t rangeBegin = ranges.size();
+
+        for (const Cluster& cluster : clusters)
+        {
+            ++stats.ClusterNum;
+            stats.FaceNum += cluster.FaceCount;
+
+            if (!IsVisible(cluster, view)) { continue; }
+
+            ++stats.VisibleClusterNum;
+            stats.VisibleFaceNum += cluster.FaceCount;
+
+            // 前のクラスターと続いていれば、同じ描画にまとめる
+            if (ranges.size() > rangeBegin)
+            {
+                FaceRange& last = ranges.back();
+                if (last.FaceStart + last.FaceCount == cluster.FaceStart)
+                {
+                    last.FaceCount += cluster.FaceCount;
+                    continue;
+                }
+            }
+
+            ranges.push_back({ cluster.FaceStart, cluster.FaceCount });
+        }
+
+        stats.RangeNum += ranges.size() - rangeBegin;
+    }
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "../Vertices/Vertices.h"
+
+/**
+* @namespace MeshCluster
+* @brief メッシュを小さなまとまり(クラスター)に分け、CPU で見えないクラスターの面を描画しない
+* @details
+*   - 読み込み時に、サブセットの面を並び順のまま前から詰めてクラスターにする
+*     - MeshOptimizer で頂点キャッシュに合わせて並べた後なので、並び順のままでも近くの面がまとまる
+*     - 面の並びを変えないので、クラスターはインデックスバッファの連続した範囲になる
+*   - クラスターごとに、包む球と法線の広がり(コーン)を持つ
+*   - 描画時に、視錐台の外のクラスターと、全部の面が裏を向いているクラスターを外す
+*   - 残ったクラスターの隣り合う範囲はつなげて、描画する面の範囲の一覧にする
+*   - 判定はモデル空間で行う : カメラと視錐台の平面をワールド行列の逆でモデル空間に移す
+*/
+namespace MeshCluster
+{
+    // 1つのクラスターに入れる頂点の数の上限
+    static constexpr UINT MaxVertexNum = 64;
+
+    // 1つのクラスターに入れる面の数の上限
+    static constexpr UINT MaxFaceNum = 124;
+
+    // 法線の広がりがこれより大きいクラスターは、裏向きの判定をしない : 軸と面の法線の内積の最小値
+    static constexpr float MinConeDot = 0.1f;
+
+    // クラスターがこれより少ないメッシュはカリングしない : 判定と描画の回数が増える方が重い
+    static constexpr UINT MinCullClusterNum = 8;
+
+    // ワールド行列の軸ごとの拡大率の差がこれより大きい場合は、裏向きの判定をしない
+    static constexpr float UniformScaleTolerance = 0.01f;
+
+    /* @brief クラスター : 座標はすべてモデル空間 */
+    struct Cluster
+    {
+        UINT FaceStart = 0; // メッシュの面の番号
+        UINT FaceCount = 0;
+
+        Math::Vector3 Center;
+        float Radius = 0.0f;
+
+        Math::Vector3 ConeAxis;   // 面の法線の平均
+        float ConeCutoff = 1.0f;  // 法線の広がりの角度の sin : 1 なら裏向きの判定をしない
+    };
+
+    /* @brief 描画する面の範囲 */
+    struct FaceRange
+    {
+        UINT FaceStart = 0;
+        UINT FaceCount = 0;
+    };
+
+    /* @brief モデル空間に移したカメラ : 描画するインスタンスごとに作る */
+    struct CullView
+    {
+        FrustumCulling::Planes Planes;
+        Math::Vector3 CameraPos;
+
+        // 拡大率が軸ごとに違う / 裏返っている場合は法線の向きが変わるので、裏向きの判定をしない
+        bool UseCone = false;
+    };
+
+    /* @brief カリングの結果 : デバッグ表示用 */
+    struct Stats
+    {
+        UINT64 ClusterNum = 0;
+        UINT64 VisibleClusterNum = 0;
+        UINT64 FaceNum = 0;
+        UINT64 VisibleFaceNum = 0;
+        UINT64 RangeNum = 0; // 描画の回数
+
+        Stats& operator+=(const Stats& other);
+    };
+
+    /**
+    * @brief クラスターの作成
+    * @param[in]  faces     - サブセット1つ分の面
+    * @param[in]  faceStart - faces の先頭の、メッシュの面の番号
+    * @param[in]  positions - メッシュの頂点の座標
+    * @param[out] clusters  - 作ったクラスターを末尾に追加する
+    */
+    void Build(std::span<const MeshFace> faces, UINT faceStart,
+        const std::vector<Math::Vector3>& positions, std::vector<Cluster>& clusters);
+
+    /**
+    * @brief モデル空間のカメラの作成
+    * @param[in] mWorld    - インスタンスのワールド行列
+    * @param[in] mViewProj - ビュー行列 * 射影行列
+    * @param[in] cameraPos - カメラの座標 : ワールド空間
+    */
+    CullView CreateCullView(const Math::Matrix& mWorld, const Math::Matrix& mViewProj, const Math::Vector3& cameraPos);
+
+    /* @brief 1つのクラスターの判定 : 見えなければ false */
+    bool IsVisible(const Cluster& cluster, const CullView& view);
+
+    /**
+    * @brief 見えるクラスターの面を、連続した範囲にまとめる
+    * @param[in]     clusters - 判定するクラスター : 面の番号の順に並んでいる
+    * @param[in]     view     - モデル空間のカメラ
+    * @param[out]    ranges   - 描画する面の範囲を末尾に追加する
+    * @param[in,out] stats    - 判定した数を足す
+    */
+    void Cull(std::span<const Cluster> clusters, const CullView& view, std::vector<FaceRange>& ranges, Stats& stats);
+}
@@ -0,0 +1,481 @@
+﻿#include "MeshOptimizer.h"
+
+namespace
+{
+    // 挿入した回数で古さを測る FIFO キャッシュ : 頂点ごとに入れた時の回数だけを持つ
+    class FIFOCache
+    {
+    public:
+        FIFOCache(UINT vertexNum, UINT cacheSize)
+            : m_insertTimes(vertexNum, 0), m_cacheSize(cacheSize), m_time(cacheSize + 1)
+        {
+        }
+
+        // キャッシュになければ入れて true を返す
+        bool Access(UINT vertexIdx)
+        {
+            if (m_time - m_insertTimes[vertexIdx] <= m_cacheSize) { return false; }
+
+            m_insertTimes[vertexIdx] = m_time++;
+            return true;
+        }
+
+    private:
+        std::vector<UINT> m_insertTimes;
+        UINT m_cacheSize = 0;
+        UINT m_time = 0;
+    };
+
+    // Forsyth の頂点のスコア : キャッシュの前にあるほど、残りの面が少ないほど高い
+    float CalcVertexScore(int cachePos, UINT remainFaceNum)
+    {
+        // 使い終わった頂点は面のスコアに入れない
+        if (remainFaceNum == 0) { return -1.0f; }
+
+        constexpr float LastFaceScore = 0.75f;
+        constexpr float CacheDecayPower = 1.5f;
+        constexpr float ValenceBoostScale = 2.0f;
+        constexpr float ValenceBoostPower = 0.5f;
+
+        float score = 0.0f;
+        if (cachePos >= 0)
+        {
+            // 直前の面の頂点は、同じ向きに帯が伸びすぎないよう少し下げる
+            if (cachePos < 3)
+            {
+                score = LastFaceScore;
+            }
+            else
+            {
+                const float rate = 1.0f - static_cast<float>(cachePos - 3) / (MeshOptimizer::OptimizeCacheSize - 3);
+                score = std::pow(rate, CacheDecayPower);
+            }
+        }
+
+        // 残りの面が少ない頂点を先に使い切り、孤立した面を残さない
+        score += ValenceBoostScale * std::pow(static_cast<float>(remainFaceNum), -ValenceBoostPower);
+
+        return score;
+    }
+
+    UINT CountCacheMiss(std::span<const MeshFace> faces, UINT vertexNum, UINT cacheSize)
+    {
+        FIFOCache cache(vertexNum, cacheSize);
+
+        UINT missNum = 0;
+        for (const MeshFace& face : faces)
+        {
+            for (UINT idx : face.Idx)
+            {
+                if (idx >= vertexNum) { continue; }
+                if (cache.Access(idx)) { ++missNum; }
+            }
+        }
+
+        return missNum;
+    }
+
+    // 統計のために読み込んだメッシュの合計 : 読み込みは複数のスレッドから行われることがある
+    std::mutex g_totalStatsMutex;
+    MeshOptimizer::Stats g_totalBefore;
+    MeshOptimizer::Stats g_totalAfter;
+}
+
+namespace MeshOptimizer
+{
+    Stats& Stats::operator+=(const Stats& other)
+    {
+        VertexNum += other.VertexNum;
+        VertexByteNum += other.VertexByteNum;
+        FaceNum += other.FaceNum;
+        CacheMissNum += other.CacheMissNum;
+        return *this;
+    }
+
+    float Stats::GetBytesPerVertex() const
+    {
+        if (VertexNum == 0) { return 0.0f; }
+        return static_cast<float>(static_cast<double>(VertexByteNum) / VertexNum);
+    }
+
+    float Stats::GetACMR() const
+    {
+        if (FaceNum == 0) { return 0.0f; }
+        return static_cast<float>(static_cast<double>(CacheMissNum) / FaceNum);
+    }
+
+    Stats MeasureStats(std::span<const MeshFace> faces, UINT vertexNum, UINT vertexSize)
+    {
+        Stats stats;
+        stats.VertexNum = vertexNum;
+        stats.VertexByteNum = static_cast<UINT64>(vertexNum) * vertexSize;
+        stats.FaceNum = faces.size();
+        stats.CacheMissNum = CountCacheMiss(faces, vertexNum, MeasureCacheSize);
+        return stats;
+    }
+
+    void OptimizeVertexCache(std::span<MeshFace> faces, UINT vertexNum)
+    {
+        const UINT faceNum = static_cast<UINT>(faces.size());
+        if (faceNum == 0) { return; }
+
+        //===============================
+        // 頂点ごとの、まだ描いていない面の一覧
+        //===============================
+        std::vector<UINT> remainFaceNums(vertexNum, 0);
+        for (const MeshFace& face : faces)
+        {
+            for (UINT idx : face.Idx) { ++remainFaceNums[idx]; }
+        }
+
+        std::vector<UINT> faceOffsets(vertexNum + 1, 0);
+        for (UINT vertexIdx = 0; vertexIdx < vertexNum; ++vertexIdx)
+        {
+            faceOffsets[vertexIdx + 1] = faceOffsets[vertexIdx] + remainFaceNums[vertexIdx];
+        }
+
+        std::vector<UINT> vertexFaces(faceOffsets.back());
+        {
+            std::vector<UINT> cursors(faceOffsets.begin(), faceOffsets.end() - 1);
+            for (UINT faceIdx = 0; faceIdx < faceNum; ++faceIdx)
+            {
+                for (UINT idx : faces[faceIdx].Idx) { vertexFaces[cursors[idx]++] = faceIdx; }
+            }
+        }
+
+        //===============================
+        // スコアの初期値
+        //===============================
+        std::vector<int> cachePositions(vertexNum, -1);
+        std::vector<float> vertexScores(vertexNum, 0.0f);
+        for (UINT vertexIdx = 0; vertexIdx < vertexNum; ++vertexIdx)
+        {
+            vertexScores[vertexIdx] = CalcVertexScore(-1, remainFaceNums[vertexIdx]);
+        }
+
+        std::vector<float> faceScores(faceNum, 0.0f);
+        std::vector<bool> isEmitted(faceNum, false);
+        UINT bestFace = 0;
+        for (UINT faceIdx = 0; faceIdx < faceNum; ++faceIdx)
+        {
+            const MeshFace& face = faces[faceIdx];
+            faceScores[faceIdx] = vertexScores[face.Idx[0]] + vertexScores[face.Idx[1]] + vertexScores[face.Idx[2]];
+            if (faceScores[faceIdx] > faceScores[bestFace]) { bestFace = faceIdx; }
+        }
+
+        //===============================
+        // スコアが一番高い面から描く
+        //===============================
+        std::vector<MeshFace> result;
+        result.reserve(faceNum);
+
+        std::vector<UINT> cache;
+        std::vector<UINT> nextCache;
+        cache.reserve(OptimizeCacheSize + 3);
+        nextCache.reserve(OptimizeCacheSize + 3);
+
+        UINT scanCursor = 0;
+        while (result.size() < faceNum)
+        {
+            // キャッシュの頂点を使う面が残っていない場合は、まだ描いていない面を前から探す
+            if (bestFace == UINT_MAX)
+            {
+                while (isEmitted[scanCursor]) { ++scanCursor; }
+                bestFace = scanCursor;
+            }
+
+            const MeshFace& face = faces[bestFace];
+            result.push_back(face);
+            isEmitted[bestFace] = true;
+
+            // 描いた面を頂点の一覧から外す : 順番は使わないので末尾と入れ替える
+            for (UINT idx : face.Idx)
+            {
+                const auto begin = vertexFaces.begin() + faceOffsets[idx];
+                const auto end = begin + remainFaceNums[idx];
+                const auto it = std::find(begin, end, bestFace);
+                if (it == end) { continue; } // 同じ頂点を2回使う潰れた面
+
+                std::iter_swap(it, end - 1);
+                --remainFaceNums[idx];
+            }
+
+            // 描いた面の頂点をキャッシュの先頭に入れる
+            nextCache.clear();
+            for (UINT idx : face.Idx)
+            {
+                if (std::find(nextCache.begin(), nextCache.end(), idx) == nextCache.end()) { nextCache.push_back(idx); }
+            }
+            for (UINT idx : cache)
+            {
+                if (std::find(nextCache.begin(), nextCache.end(), idx) == nextCache.end()) { nextCache.push_back(idx); }
+            }
+
+            // 押し出された頂点も含めて、キャッシュの位置が変わった頂点のスコアを計算し直す
+            for (UINT cacheIdx = 0; cacheIdx < nextCache.size(); ++cacheIdx)
+            {
+                const UINT idx = nextCache[cacheIdx];
+                cachePositions[idx] = cacheIdx < OptimizeCacheSize ? static_cast<int>(cacheIdx) : -1;
+                vertexScores[idx] = CalcVertexScore(cachePositions[idx], remainFaceNums[idx]);
+            }
+
+            // スコアが変わった頂点の面から、次に描く面を選ぶ
+            bestFace = UINT_MAX;
+            float bestScore = -1.0f;
+            for (UINT idx : nextCache)
+            {
+                const UINT offset = faceOffsets[idx];
+                for (UINT i = 0; i < remainFaceNums[idx]; ++i)
+                {
+                    const UINT faceIdx = vertexFaces[offset + i];
+                    const MeshFace& remainFace = faces[faceIdx];
+                    faceScores[faceIdx] = vertexScores[remainFace.Idx[0]] + vertexScores[remainFace.Idx[1]] +
+                                          vertexScores[remainFace.Idx[2]];
+
+                    if (faceScores[faceIdx] > bestScore)
+                    {
+                        bestScore = faceScores[faceIdx];
+                        bestFace = faceIdx;
+                    }
+                }
+            }
+
+            if (nextCache.size() > OptimizeCacheSize) { nextCache.resize(OptimizeCacheSize); }
+            cache.swap(nextCache);
+        }
+
+        std::copy(result.begin(), result.end(), faces.begin());
+    }
+
+    void OptimizeOverdraw(std::span<MeshFace> faces, const std::vector<MeshVertex>& vertices)
+    {
+        const UINT faceNum = static_cast<UINT>(faces.size());
+        if (faceNum < MinClusterFaceNum * 2) { return; }
+
+        //===============================
+        // キャッシュが切れる所で分ける
+        //===============================
+        // 3頂点ともキャッシュにない面は、前の面と繋がっていないので並べ替えてもキャッシュが悪くならない
+        std::vector<UINT> clusterStarts = { 0 };
+        {
+            FIFOCache cache(static_cast<UINT>(vertices.size()), MeasureCacheSize);
+            for (UINT faceIdx = 0; faceIdx < faceNum; ++faceIdx)
+            {
+                UINT missNum = 0;
+                for (UINT idx : faces[faceIdx].Idx)
+                {
+                    if (cache.Access(idx)) { ++missNum; }
+                }
+
+                if (missNum == 3 && faceIdx - clusterStarts.back() >= MinClusterFaceNum)
+                {
+                    clusterStarts.push_back(faceIdx);
+                }
+            }
+        }
+
+        const UINT clusterNum = static_cast<UINT>(clusterStarts.size());
+        if (clusterNum <= 1) { return; }
+        clusterStarts.push_back(faceNum);
+
+        //===============================
+        // まとまりごとの向き
+        //===============================
+        // 面積で重みを付けた中心と法線 : 法線は外積のまま足せば面積の重みになる
+        std::vector<Math::Vector3> clusterCenters(clusterNum);
+        std::vector<Math::Vector3> clusterNormals(clusterNum);
+        std::vector<float> clusterAreas(clusterNum, 0.0f);
+        Math::Vector3 meshCenter = Math::Vector3::Zero;
+        float meshArea = 0.0f;
+
+        for (UINT clusterIdx = 0; clusterIdx < clusterNum; ++clusterIdx)
+        {
+            for (UINT faceIdx = clusterStarts[clusterIdx]; faceIdx < clusterStarts[clusterIdx + 1]; ++faceIdx)
+            {
+                const MeshFace& face = faces[faceIdx];
+                const Math::Vector3& p0 = vertices[face.Idx[0]].Position;
+                const Math::Vector3& p1 = vertices[face.Idx[1]].Position;
+                const Math::Vector3& p2 = vertices[face.Idx[2]].Position;
+
+                const Math::Vector3 cross = (p1 - p0).Cross(p2 - p0);
+                const float area = cross.Length() * 0.5f;
+
+                clusterCenters[clusterIdx] += (p0 + p1 + p2) * (area / 3.0f);
+                clusterNormals[clusterIdx] += cross;
+                clusterAreas[clusterIdx] += area;
+            }
+
+            meshCenter += clusterCenters[clusterIdx];
+            meshArea += clusterAreas[clusterIdx];
+        }
+
+        if (meshArea <= 0.0f) { return; }
+        meshCenter /= meshArea;
+
+        // メッシュの中心から見て外を向いているほど、手前に見えやすいので先に描く
+        std::vector<float> clusterKeys(clusterNum, 0.0f);
+        for (UINT clusterIdx = 0; clusterIdx < clusterNum; ++clusterIdx)
+        {
+            if (clusterAreas[clusterIdx] <= 0.0f) { continue; }
+
+            const float normalLength = clusterNormals[clusterIdx].Length();
+            if (normalLength <= 0.0f) { continue; }
+
+            const Math::Vector3 center = clusterCenters[clusterIdx] / clusterAreas[clusterIdx];
+            clusterKeys[clusterIdx] = (center - meshCenter).Dot(clusterNormals[clusterIdx]) / normalLength;
+        }
+
+        std::vector<UINT> clusterOrder(clusterNum);
+        for (UINT clusterIdx = 0; clusterIdx < clusterNum; ++clusterIdx) { clusterOrder[clusterIdx] = clusterIdx; }
+        std::stable_sort(clusterOrder.begin(), clusterOrder.end(),
+            [&clusterKeys](UINT a, UINT b) { return clusterKeys[a] > clusterKeys[b]; });
+
+        std::vector<MeshFace> result;
+        result.reserve(faceNum);
+        for (UINT clusterIdx : clusterOrder)
+        {
+            result.insert(result.end(), faces.begin() + clusterStarts[clusterIdx], faces.begin() + clusterStarts[clusterIdx + 1]);
+        }
+
+        std::copy(result.begin(), result.end(), faces.begin());
+    }
+
+    void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<MeshFace>& faces)
+    {
+        std::vector<UINT> remap(vertices.size(), UINT_MAX);
+
+        std::vector<MeshVertex> result;
+        result.reserve(vertices.size());
+
+        for (MeshFace& face : faces)
+        {
+            for (UINT& idx : face.Idx)
+            {
+                if (remap[idx] == UINT_MAX)
+                {
+                    remap[idx] = static_cast<UINT>(result.size());
+                    result.push_back(vertices[idx]);
+                }
+                idx = remap[idx];
+            }
+        }
+
+        vertices.swap(result);
+    }
+
+    void Optimize(std::vector<MeshVertex>& vertices, std::vector<MeshFace>& faces, const std::vector<MeshSubset>& subsets)
+    {
+        const UINT vertexNum = static_cast<UINT>(vertices.size());
+
+        for (const MeshFace& face : faces)
+        {
+            for (UINT idx : face.Idx)
+            {
+                if (idx >= vertexNum)
+                {
+                    FNENG_ASSERT_LOG("範囲外の頂点を指す面があるため、メッシュを並べ替えません", true);
+                    return;
+                }
+            }
+        }
+
+        const UINT faceNum = static_cast<UINT>(faces.size());
+        for (const MeshSubset& subset : subsets)
+        {
+            const UINT faceStart = std::min(subset.FaceStart, faceNum);
+            const UINT faceCount = std::min(subset.FaceCount, faceNum - faceStart);
+            const std::span<MeshFace> subsetFaces(faces.data() + faceStart, faceCount);
+
+            OptimizeVertexCache(subsetFaces, vertexNum);
+            OptimizeOverdraw(subsetFaces, vertices);
+        }
+
+        OptimizeVertexFetch(vertices, faces);
+    }
+
+    std::array<INT16, 2> EncodeOctahedral(const Math::Vector3& dir)
+    {
+        const float sum = std::abs(dir.x) + std::abs(dir.y) + std::abs(dir.z);
+        if (sum <= 0.0f) { return { 0, 0 }; }
+
+        float x = dir.x / sum;
+        float y = dir.y / sum;
+
+        // 下半分は対角線で折り返して外側の三角形に入れる
+        if (dir.z < 0.0f)
+        {
+            const float foldX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+            const float foldY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+            x = foldX;
+            y = foldY;
+        }
+
+        const auto toSnorm16 = [](float value)
+        {
+            return static_cast<INT16>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+        };
+
+        return { toSnorm16(x), toSnorm16(y) };
+    }
+
+    Math::Vector3 DecodeOctahedral(const std::array<INT16, 2>& oct)
+    {
+        // snorm16 の -32768 は -1 として扱う
+        const float x = std::max(oct[0] / 32767.0f, -1.0f);
+        const float y = std::max(oct[1] / 32767.0f, -1.0f);
+
+        Math::Vector3 dir = { x, y, 1.0f - std::abs(x) - std::abs(y) };
+
+        // 下半分は対角線で折り返してある
+        const float t = std::clamp(-dir.z, 0.0f, 1.0f);
+        dir.x += dir.x >= 0.0f ? -t : t;
+        dir.y += dir.y >= 0.0f ? -t : t;
+
+        dir.Normalize();
+        return dir;
+    }
+
+    std::array<UINT16, 2> EncodeHalf2(const Math::Vector2& value)
+    {
+        return { DirectX::PackedVector::XMConvertFloatToHalf(value.x), DirectX::PackedVector::XMConvertFloatToHalf(value.y) };
+    }
+
+    std::array<UINT8, 4> QuantizeWeights(const std::array<float, 4>& weights)
+    {
+        float sum = 0.0f;
+        for (float weight : weights) { sum += std::max(weight, 0.0f); }
+
+        std::array<UINT8, 4> result = {};
+        if (sum <= 0.0f) { return result; }
+
+        // 丸めた後の合計がずれた分は、一番重いボーンで吸収する
+        int total = 0;
+        size_t heaviest = 0;
+        for (size_t i = 0; i < weights.size(); ++i)
+        {
+            const int value = static_cast<int>(std::lround(std::max(weights[i], 0.0f) / sum * 255.0f));
+            result[i] = static_cast<UINT8>(value);
+            total += value;
+
+            if (weights[i] > weights[heaviest]) { heaviest = i; }
+        }
+
+        result[heaviest] = static_cast<UINT8>(std::clamp(result[heaviest] + 255 - total, 0, 255));
+
+        return result;
+    }
+
+    void AddTotalStats(const Stats& before, const Stats& after)
+    {
+        std::lock_guard<std::mutex> lock(g_totalStatsMutex);
+        g_totalBefore += before;
+        g_totalAfter += after;
+    }
+
+    void GetTotalStats(Stats& before, Stats& after)
+    {
+        std::lock_guard<std::mutex> lock(g_totalStatsMutex);
+        before = g_totalBefore;
+        after = g_totalAfter;
+    }
+}
@@ -0,0 +1,98 @@
+﻿#pragma once
+
+/**
+* @namespace MeshOptimizer
+* @brief 読み込み時の面 / 頂点の並べ替え
+* @details
+*   - 次の順に並べ替える : 後の処理は前の処理で作った並びをなるべく崩さない
+*     1. 頂点キャッシュ : キャッシュに残っている頂点を使う面から描く(Forsyth のスコア)
+*     2. オーバードロー : キャッシュが切れる所で面をまとまりに分け、外側を向いたまとまりから描く
+*     3. 頂点フェッチ   : 面で初めて使われる順に頂点を並べ、使われていない頂点を捨てる
+*   - 面はサブセットの中だけで並べ替えるので、サブセットの範囲は変わらない
+*   - 効果は FIFO の頂点キャッシュで数えた ACMR(1面あたりのキャッシュミス数)で見る
+*   - GPU は使わない
+*/
+namespace MeshOptimizer
+{
+    // 並べ替えで想定するキャッシュの大きさ : Forsyth のスコアの計算に使う
+    static constexpr UINT OptimizeCacheSize = 32;
+
+    // ACMR を数える FIFO キャッシュの大きさ
+    static constexpr UINT MeasureCacheSize = 16;
+
+    // オーバードローのまとまりの最小の面の数 : 細かく分けすぎると ACMR が悪くなる
+    static constexpr UINT MinClusterFaceNum = 32;
+
+    /* @brief 頂点の量と並びの良さ : メッシュごとに測って足し合わせる */
+    struct Stats
+    {
+        UINT64 VertexNum = 0;
+        UINT64 VertexByteNum = 0; // GPU に送る頂点のサイズの合計
+        UINT64 FaceNum = 0;
+        UINT64 CacheMissNum = 0;
+
+        Stats& operator+=(const Stats& other);
+
+        float GetBytesPerVertex() const;
+        float GetACMR() const;
+    };
+
+    /**
+    * @brief 測る
+    * @param[in] faces      - 面
+    * @param[in] vertexNum  - 頂点の数
+    * @param[in] vertexSize - 1頂点のサイズ : 複数のストリームに分けている場合はその合計
+    */
+    Stats MeasureStats(std::span<const MeshFace> faces, UINT vertexNum, UINT vertexSize);
+
+    /**
+    * @brief 頂点キャッシュに合わせて面を並べ替える
+    * @param[in,out] faces     - 並べ替える面 : サブセット1つ分
+    * @param[in]     vertexNum - 頂点の数
+    */
+    void OptimizeVertexCache(std::span<MeshFace> faces, UINT vertexNum);
+
+    /**
+    * @brief 外側を向いた面から描くように、まとまりごとに並べ替える
+    * @details OptimizeVertexCache の後に呼ぶ
+    * @param[in,out] faces    - 並べ替える面 : サブセット1つ分
+    * @param[in]     vertices - 頂点
+    */
+    void OptimizeOverdraw(std::span<MeshFace> faces, const std::vector<MeshVertex>& vertices);
+
+    /**
+    * @brief 面で使われる順に頂点を並べ替え、使われていない頂点を捨てる
+    * @param[in,out] vertices - 頂点
+    * @param[in,out] faces    - 面 : 新しい頂点の番号に書き換える
+    */
+    void OptimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<MeshFace>& faces);
+
+    /**
+    * @brief すべての並べ替えを行う
+    * @details 範囲外の頂点を指す面がある場合は何もしない
+    * @param[in,out] vertices - 頂点
+    * @param[in,out] faces    - 面 : サブセットの順に並んでいる
+    * @param[in]     subsets  - サブセット
+    */
+    void Optimize(std::vector<MeshVertex>& vertices, std::vector<MeshFace>& faces, const std::vector<MeshSubset>& subsets);
+
+    //x--- 量子化 ---x//
+    /**
+    * @brief 単位ベクトルを八面体に展開して、2つの snorm16 にする
+    * @details シェーダーの OctDecode で戻す
+    */
+    std::array<INT16, 2> EncodeOctahedral(const Math::Vector3& dir);
+
+    /* @brief EncodeOctahedral の逆変換 : シェーダーの OctDecode と同じ計算 */
+    Math::Vector3 DecodeOctahedral(const std::array<INT16, 2>& oct);
+
+    /* @brief UV などの2要素を half にする : 絶対値に対して 2^-11 以内の誤差で戻せる */
+    std::array<UINT16, 2> EncodeHalf2(const Math::Vector2& value);
+
+    /* @brief ボーンの重みを、合計が 255 になる unorm8 にする */
+    std::array<UINT8, 4> QuantizeWeights(const std::array<float, 4>& weights);
+
+    //x--- 読み込んだメッシュの合計 ---x//
+    void AddTotalStats(const Stats& before, const Stats& after);
+    void GetTotalStats(Stats& before, Stats& after);
+}
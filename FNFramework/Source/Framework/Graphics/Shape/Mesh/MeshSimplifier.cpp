@@ -0,0 +1,405 @@
+﻿#include "MeshSimplifier.h"
+
+namespace
+{
+    // 平面からの距離の二乗 (ax + by + cz + d)^2 を表す対称な 4x4 行列 : 上半分の10要素だけを持つ
+    struct Quadric
+    {
+        // aa, ab, ac, ad, bb, bc, bd, cc, cd, dd
+        std::array<double, 10> Elements = {};
+
+        static Quadric FromPlane(double a, double b, double c, double d)
+        {
+            return { { a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d } };
+        }
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            for (size_t i = 0; i < Elements.size(); ++i)
+            {
+                Elements[i] += other.Elements[i];
+            }
+            return *this;
+        }
+
+        double Evaluate(const Math::Vector3& pos) const
+        {
+            const double x = pos.x;
+            const double y = pos.y;
+            const double z = pos.z;
+            const std::array<double, 10>& e = Elements;
+
+            return e[0] * x * x + 2.0 * e[1] * x * y + 2.0 * e[2] * x * z + 2.0 * e[3] * x +
+                   e[4] * y * y + 2.0 * e[5] * y * z + 2.0 * e[6] * y +
+                   e[7] * z * z + 2.0 * e[8] * z +
+                   e[9];
+        }
+    };
+
+    // 潰す辺の候補 : 頂点が変わった候補は Version で見分けて捨てる
+    struct Collapse
+    {
+        double Cost = 0.0;
+        UINT From = 0; // 消える頂点
+        UINT To = 0;   // 寄せる先の頂点
+        UINT FromVersion = 0;
+        UINT ToVersion = 0;
+
+        bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+    };
+
+    // 潰した後の面の向きが、元の向きからこれ以上変わる辺は潰さない : 法線の内積
+    constexpr float MinNormalDot = 0.2f;
+
+    // -0 と +0 が同じ値になるように、0 を足してからビット列にする
+    struct PositionHash
+    {
+        size_t operator()(const Math::Vector3& pos) const
+        {
+            size_t hash = std::bit_cast<UINT32>(pos.x + 0.0f);
+            hash = hash * 31 + std::bit_cast<UINT32>(pos.y + 0.0f);
+            hash = hash * 31 + std::bit_cast<UINT32>(pos.z + 0.0f);
+            return hash;
+        }
+    };
+
+    Math::Vector3 CalcFaceNormal(const Math::Vector3& p0, const Math::Vector3& p1, const Math::Vector3& p2)
+    {
+        return (p1 - p0).Cross(p2 - p0);
+    }
+}
+
+namespace MeshSimplifier
+{
+    bool Simplify(const std::vector<MeshVertex>& vertices, const std::vector<MeshFace>& faces,
+        const std::vector<MeshSubset>& subsets, UINT targetFaceNum, Result& result)
+    {
+        result = Result{};
+
+        const UINT vertexNum = static_cast<UINT>(vertices.size());
+        const UINT faceNum = static_cast<UINT>(faces.size());
+
+        if (vertexNum == 0 || faceNum <= targetFaceNum) { return false; }
+
+        //--------------------------------
+        // 同じ座標の頂点をまとめる
+        //--------------------------------
+        std::vector<UINT> posIds(vertexNum);
+        std::vector<UINT> posVertexNums;
+        {
+            std::unordered_map<Math::Vector3, UINT, PositionHash> posToId;
+            posToId.reserve(vertexNum);
+
+            for (UINT vertexIdx = 0; vertexIdx < vertexNum; ++vertexIdx)
+            {
+                auto [it, isInserted] = posToId.try_emplace(vertices[vertexIdx].Position, static_cast<UINT>(posVertexNums.size()));
+                if (isInserted) { posVertexNums.push_back(0); }
+
+                posIds[vertexIdx] = it->second;
+                ++posVertexNums[it->second];
+            }
+        }
+        const UINT posNum = static_cast<UINT>(posVertexNums.size());
+
+        //--------------------------------
+        // 動かさない頂点を決める
+        //--------------------------------
+        std::vector<UINT> faceSubsets(faceNum, UINT_MAX);
+        for (UINT subsetIdx = 0; subsetIdx < static_cast<UINT>(subsets.size()); ++subsetIdx)
+        {
+            const MeshSubset& subset = subsets[subsetIdx];
+            const UINT faceEnd = std::min(subset.FaceStart + subset.FaceCount, faceNum);
+
+            for (UINT faceIdx = subset.FaceStart; faceIdx < faceEnd; ++faceIdx)
+            {
+                faceSubsets[faceIdx] = subsetIdx;
+            }
+        }
+
+        // UV や法線の境目は、同じ座標に複数の頂点がある
+        std::vector<bool> isPosLocked(posNum, false);
+        for (UINT posId = 0; posId < posNum; ++posId)
+        {
+            isPosLocked[posId] = posVertexNums[posId] > 1;
+        }
+
+        // 辺を共有する面の数 : 2枚でなければ穴の縁か、3枚以上で共有している
+        std::unordered_map<UINT64, UINT> edgeFaceNums;
+        edgeFaceNums.reserve(static_cast<size_t>(faceNum) * 3);
+
+        std::vector<UINT> vertexSubsets(vertexNum, UINT_MAX);
+        std::vector<std::vector<UINT>> vertexFaces(vertexNum);
+        std::vector<Quadric> posQuadrics(posNum);
+
+        for (UINT faceIdx = 0; faceIdx < faceNum; ++faceIdx)
+        {
+            const MeshFace& face = faces[faceIdx];
+
+            for (UINT corner = 0; corner < 3; ++corner)
+            {
+                const UINT vertexIdx = face.Idx[corner];
+                vertexFaces[vertexIdx].push_back(faceIdx);
+
+                // 複数のサブセットで使われる頂点は、マテリアルの境目
+                if (vertexSubsets[vertexIdx] == UINT_MAX)
+                {
+                    vertexSubsets[vertexIdx] = faceSubsets[faceIdx];
+                }
+                else if (vertexSubsets[vertexIdx] != faceSubsets[faceIdx])
+                {
+                    isPosLocked[posIds[vertexIdx]] = true;
+                }
+
+                const UINT posA = posIds[face.Idx[corner]];
+                const UINT posB = posIds[face.Idx[(corner + 1) % 3]];
+                if (posA == posB) { continue; }
+
+                const UINT64 edgeKey = (static_cast<UINT64>(std::min(posA, posB)) << 32) | std::max(posA, posB);
+                ++edgeFaceNums[edgeKey];
+            }
+
+            // 面の平面を3つの頂点の行列に足す
+            const Math::Vector3& p0 = vertices[face.Idx[0]].Position;
+            Math::Vector3 normal = CalcFaceNormal(p0, vertices[face.Idx[1]].Position, vertices[face.Idx[2]].Position);
+            if (normal.LengthSquared() <= 0.0f) { continue; }
+            normal.Normalize();
+
+            const Quadric quadric = Quadric::FromPlane(normal.x, normal.y, normal.z, -normal.Dot(p0));
+            for (UINT corner = 0; corner < 3; ++corner)
+            {
+                posQuadrics[posIds[face.Idx[corner]]] += quadric;
+            }
+        }
+
+        for (const auto& [edgeKey, edgeFaceNum] : edgeFaceNums)
+        {
+            if (edgeFaceNum == 2) { continue; }
+
+            isPosLocked[static_cast<UINT>(edgeKey >> 32)] = true;
+            isPosLocked[static_cast<UINT>(edgeKey & 0xFFFFFFFF)] = true;
+        }
+
+        //--------------------------------
+        // 潰す辺の候補
+        //--------------------------------
+        std::vector<MeshFace> workFaces = faces;
+        std::vector<bool> isFaceRemoved(faceNum, false);
+        std::vector<bool> isVertexRemoved(vertexNum, false);
+        std::vector<UINT> versions(vertexNum, 0);
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> candidates;
+
+        const auto pushCollapse = [&](UINT from, UINT to)
+        {
+            if (isPosLocked[posIds[from]] || posIds[from] == posIds[to]) { return; }
+
+            Quadric quadric = posQuadrics[posIds[from]];
+            quadric += posQuadrics[posIds[to]];
+
+            const double cost = std::max(quadric.Evaluate(vertices[to].Position), 0.0);
+            candidates.push({ cost, from, to, versions[from], versions[to] });
+        };
+
+        // 頂点を含む辺を、両方の向きで候補にする
+        const auto pushVertexCollapses = [&](UINT vertexIdx)
+        {
+            for (UINT faceIdx : vertexFaces[vertexIdx])
+            {
+                if (isFaceRemoved[faceIdx]) { continue; }
+
+                const MeshFace& face = workFaces[faceIdx];
+                for (UINT corner = 0; corner < 3; ++corner)
+                {
+                    const UINT a = face.Idx[corner];
+                    const UINT b = face.Idx[(corner + 1) % 3];
+                    if (a != vertexIdx && b != vertexIdx) { continue; }
+
+                    pushCollapse(a, b);
+                    pushCollapse(b, a);
+                }
+            }
+        };
+
+        for (const MeshFace& face : workFaces)
+        {
+            for (UINT corner = 0; corner < 3; ++corner)
+            {
+                pushCollapse(face.Idx[corner], face.Idx[(corner + 1) % 3]);
+                pushCollapse(face.Idx[(corner + 1) % 3], face.Idx[corner]);
+            }
+        }
+
+        //--------------------------------
+        // 潰せるかの判定
+        //--------------------------------
+        std::vector<UINT> fromRing;
+        std::vector<UINT> toRing;
+
+        // 周りの頂点の座標の番号 : 重複は除く
+        const auto collectRing = [&](UINT vertexIdx, std::vector<UINT>& ring)
+        {
+            ring.clear();
+            for (UINT faceIdx : vertexFaces[vertexIdx])
+            {
+                if (isFaceRemoved[faceIdx]) { continue; }
+
+                for (UINT idx : workFaces[faceIdx].Idx)
+                {
+                    if (posIds[idx] != posIds[vertexIdx]) { ring.push_back(posIds[idx]); }
+                }
+            }
+            std::sort(ring.begin(), ring.end());
+            ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+        };
+
+        const auto canCollapse = [&](UINT from, UINT to)
+        {
+            const UINT toPosId = posIds[to];
+            const Math::Vector3& toPos = vertices[to].Position;
+
+            for (UINT faceIdx : vertexFaces[from])
+            {
+                if (isFaceRemoved[faceIdx]) { continue; }
+
+                const MeshFace& face = workFaces[faceIdx];
+
+                // 辺を含む面は消える
+                if (posIds[face.Idx[0]] == toPosId || posIds[face.Idx[1]] == toPosId || posIds[face.Idx[2]] == toPosId) { continue; }
+
+                std::array<Math::Vector3, 3> positions;
+                for (UINT corner = 0; corner < 3; ++corner)
+                {
+                    positions[corner] = vertices[face.Idx[corner]].Position;
+                }
+                const Math::Vector3 oldNormal = CalcFaceNormal(positions[0], positions[1], positions[2]);
+
+                for (UINT corner = 0; corner < 3; ++corner)
+                {
+                    if (face.Idx[corner] == from) { positions[corner] = toPos; }
+                }
+                const Math::Vector3 newNormal = CalcFaceNormal(positions[0], positions[1], positions[2]);
+
+                // 面が潰れる / 裏返る
+                const float newLengthSq = newNormal.LengthSquared();
+                if (newLengthSq <= 0.0f) { return false; }
+
+                if (oldNormal.Dot(newNormal) < MinNormalDot * std::sqrt(oldNormal.LengthSquared() * newLengthSq)) { return false; }
+            }
+
+            // 両端の周りで共有する頂点が、辺を挟む2つより多いと、潰した後に3枚以上で共有する辺ができる
+            collectRing(from, fromRing);
+            collectRing(to, toRing);
+
+            UINT sharedNum = 0;
+            auto itTo = toRing.begin();
+            for (UINT posId : fromRing)
+            {
+                itTo = std::lower_bound(itTo, toRing.end(), posId);
+                if (itTo != toRing.end() && *itTo == posId) { ++sharedNum; }
+            }
+
+            return sharedNum <= 2;
+        };
+
+        //--------------------------------
+        // 誤差の小さい辺から潰す
+        //--------------------------------
+        UINT liveFaceNum = faceNum;
+        double maxCost = 0.0;
+
+        while (liveFaceNum > targetFaceNum && !candidates.empty())
+        {
+            const Collapse collapse = candidates.top();
+            candidates.pop();
+
+            const UINT from = collapse.From;
+            const UINT to = collapse.To;
+
+            // 候補を積んだ後に変わった頂点
+            if (isVertexRemoved[from] || isVertexRemoved[to] ||
+                versions[from] != collapse.FromVersion || versions[to] != collapse.ToVersion)
+            {
+                continue;
+            }
+
+            if (!canCollapse(from, to)) { continue; }
+
+            const UINT toPosId = posIds[to];
+
+            for (UINT faceIdx : vertexFaces[from])
+            {
+                if (isFaceRemoved[faceIdx]) { continue; }
+
+                MeshFace& face = workFaces[faceIdx];
+
+                if (posIds[face.Idx[0]] == toPosId || posIds[face.Idx[1]] == toPosId || posIds[face.Idx[2]] == toPosId)
+                {
+                    isFaceRemoved[faceIdx] = true;
+                    --liveFaceNum;
+                    continue;
+                }
+
+                for (UINT& idx : face.Idx)
+                {
+                    if (idx == from) { idx = to; }
+                }
+                vertexFaces[to].push_back(faceIdx);
+            }
+
+            vertexFaces[from].clear();
+            isVertexRemoved[from] = true;
+
+            posQuadrics[toPosId] += posQuadrics[posIds[from]];
+            ++versions[to];
+
+            maxCost = std::max(maxCost, collapse.Cost);
+
+            // 寄せた先の頂点の行列が変わったので、周りの辺を積み直す
+            pushVertexCollapses(to);
+        }
+
+        if (liveFaceNum == faceNum) { return false; }
+
+        //--------------------------------
+        // サブセットの順に残った面を並べ、使われている頂点だけを詰める
+        //--------------------------------
+        std::vector<UINT> remap(vertexNum, UINT_MAX);
+        result.Faces.reserve(liveFaceNum);
+
+        for (const MeshSubset& subset : subsets)
+        {
+            MeshSubset dstSubset;
+            dstSubset.MaterialNo = subset.MaterialNo;
+            dstSubset.FaceStart = static_cast<UINT>(result.Faces.size());
+
+            const UINT faceEnd = std::min(subset.FaceStart + subset.FaceCount, faceNum);
+            for (UINT faceIdx = subset.FaceStart; faceIdx < faceEnd; ++faceIdx)
+            {
+                if (isFaceRemoved[faceIdx]) { continue; }
+
+                MeshFace dstFace;
+                for (UINT corner = 0; corner < 3; ++corner)
+                {
+                    const UINT srcIdx = workFaces[faceIdx].Idx[corner];
+                    if (remap[srcIdx] == UINT_MAX)
+                    {
+                        remap[srcIdx] = static_cast<UINT>(result.Vertices.size());
+                        result.Vertices.push_back(vertices[srcIdx]);
+                    }
+                    dstFace.Idx[corner] = remap[srcIdx];
+                }
+                result.Faces.push_back(dstFace);
+            }
+
+            dstSubset.FaceCount = static_cast<UINT>(result.Faces.size()) - dstSubset.FaceStart;
+            if (dstSubset.FaceCount > 0)
+            {
+                result.Subsets.push_back(dstSubset);
+            }
+        }
+
+        result.GeometricError = static_cast<float>(std::sqrt(maxCost));
+
+        return !result.Faces.empty();
+    }
+}
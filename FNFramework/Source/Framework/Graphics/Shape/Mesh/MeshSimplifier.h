@@ -0,0 +1,40 @@
+﻿#pragma once
+
+/**
+* @namespace MeshSimplifier
+* @brief 二次誤差(Quadric Error Metrics)で面を減らした、LOD 用のメッシュの作成
+* @details
+*   - 辺を片方の頂点に寄せて潰す(half-edge collapse)ので、新しい頂点は作らず元の頂点の属性をそのまま使う
+*   - 頂点ごとに、周りの面の平面までの距離の二乗和を表す行列を持ち、潰した時に増える誤差が小さい辺から潰す
+*   - 次の頂点は動かさない : 輪郭やマテリアル、UV の境目が崩れないようにする
+*     - 穴の縁の頂点 / 3枚以上の面で共有する辺の頂点
+*     - 同じ座標に複数の頂点がある頂点 : UV や法線の境目
+*     - 複数のサブセットの面で使われる頂点
+*   - 潰すと面の向きが裏返る辺は潰さない
+*   - GPU は使わない : モデルの読み込み時に1回だけ呼ぶ
+*/
+namespace MeshSimplifier
+{
+    // 作成したメッシュ
+    struct Result
+    {
+        std::vector<MeshVertex> Vertices; // 使われている頂点だけを詰めたもの
+        std::vector<MeshFace> Faces;
+        std::vector<MeshSubset> Subsets; // 面が残らなかったサブセットは入らない
+
+        // 潰した辺の誤差の最大値 : 元のメッシュの面からのおおよその距離
+        float GeometricError = 0.0f;
+    };
+
+    /**
+    * @brief 面を減らす
+    * @param[in]  vertices      - 元の頂点
+    * @param[in]  faces         - 元の面 : サブセットの順に並んでいる
+    * @param[in]  subsets       - 元のサブセット
+    * @param[in]  targetFaceNum - 目標の面の数 : 動かさない頂点が多い場合は届かないことがある
+    * @param[out] result        - 作成したメッシュ
+    * @return 1枚でも面を減らせたら true
+    */
+    bool Simplify(const std::vector<MeshVertex>& vertices, const std::vector<MeshFace>& faces,
+        const std::vector<MeshSubset>& subsets, UINT targetFaceNum, Result& result);
+}
@@ -1,9 +1,15 @@
 ﻿#include "Vertices.h"
 
 void Vertices::CreateVertexBuffer(UINT _structSize, UINT _bufSize)
+{
+    CreateUploadVertexBuffer(_structSize, _bufSize, m_pVBuffer, m_vbView);
+}
+
+bool Vertices::CreateUploadVertexBuffer(UINT structSize, UINT num,
+    ComPtr<ID3D12Resource>& pBuffer, D3D12_VERTEX_BUFFER_VIEW& view)
 {
     // すでにバッファがある場合は解放して、新たに生成する
-    if (m_pVBuffer) { m_pVBuffer->Release(); FNENG_ASSERT_LOG("中身のある頂点バッファを上書きします",/* isOutput = */ true) }
+    if (pBuffer) { pBuffer.Reset(); FNENG_ASSERT_LOG("中身のある頂点バッファを上書きします",/* isOutput = */ true) }
 
     D3D12_HEAP_PROPERTIES heapProp = {};
     heapProp.Type = D3D12_HEAP_TYPE_UPLOAD;
@@ -15,7 +21,7 @@ void Vertices::CreateVertexBuffer(UINT _structSize, UINT _bufSize)
     //--------------
     D3D12_RESOURCE_DESC resDesc = {};
     resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-    resDesc.Width = static_cast<UINT64>(_structSize * _bufSize);
+    resDesc.Width = static_cast<UINT64>(structSize) * num;
     resDesc.Height = 1;
     resDesc.DepthOrArraySize = 1;
     resDesc.MipLevels = 1;
@@ -28,18 +34,21 @@ void Vertices::CreateVertexBuffer(UINT _structSize, UINT _bufSize)
     // 頂点バッファ作成
     hr = GraphicsDevice::Instance().GetDevice()->CreateCommittedResource(&heapProp, D3D12_HEAP_FLAG_NONE,
                                                                  &resDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr,
-                                                                 IID_PPV_ARGS(&m_pVBuffer));
+                                                                 IID_PPV_ARGS(&pBuffer));
 
     if (FAILED(hr))
     {
         FNENG_ASSERT_ERROR("頂点バッファ作成失敗");
-        return;
+        view = {};
+        return false;
     }
 
     // バッファの情報をビューに書き込む
-    m_vbView.BufferLocation = m_pVBuffer->GetGPUVirtualAddress(); // 頂点バッファの開始アドレスを設定
-    m_vbView.SizeInBytes = static_cast<UINT>(resDesc.Width); // バッファのサイズ(byte)を指定する
-    m_vbView.StrideInBytes = _structSize; // バッファの1つのデータのサイズ(byte)をしている
+    view.BufferLocation = pBuffer->GetGPUVirtualAddress(); // 頂点バッファの開始アドレスを設定
+    view.SizeInBytes = static_cast<UINT>(resDesc.Width); // バッファのサイズ(byte)を指定する
+    view.StrideInBytes = structSize; // バッファの1つのデータのサイズ(byte)をしている
+
+    return true;
 }
 
 void Vertices::CreateIndexBufferAndFaceData(const std::vector<MeshFace>& _faces)
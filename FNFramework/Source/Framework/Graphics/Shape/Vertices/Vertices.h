@@ -82,6 +82,18 @@ public:
 
 protected:
 
+    /**
+     * @brief アップロードヒープに頂点バッファを作成してビューを設定する
+     * @details 複数の頂点ストリームを持つ派生クラスが、2本目以降のバッファの作成に使う
+     * @param[in]  structSize - 1頂点のサイズ
+     * @param[in]  num        - 頂点数
+     * @param[out] pBuffer    - 作成したバッファ : 中身がある場合は解放して作り直す
+     * @param[out] view       - 作成したバッファのビュー
+     * @return 作成できたら true
+     */
+    static bool CreateUploadVertexBuffer(UINT structSize, UINT num,
+        ComPtr<ID3D12Resource>& pBuffer, D3D12_VERTEX_BUFFER_VIEW& view);
+
     //--------------------------------
     // 頂点バッファ / 頂点情報
     //--------------------------------
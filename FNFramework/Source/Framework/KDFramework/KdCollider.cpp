@@ -56,7 +56,7 @@ void KdCollider::RegisterCollisionShape(std::string_view name, class Polygon* po
 // 第3引数に詳細結果の受け取る機能が付いている
 // ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// /////
 bool KdCollider::Intersects(const SphereInfo& targetShape, const Math::Matrix& ownerMatrix,
-                            std::list<KdCollider::CollisionResult>* pResults) const
+                            CollisionResultList* pResults) const
 {
     // 当たり判定無効のタイプの場合は返る
     if (targetShape.m_type & m_disableType) { return false; }
@@ -81,7 +81,7 @@ bool KdCollider::Intersects(const SphereInfo& targetShape, const Math::Matrix& o
             tmpRes.m_collidedObjName = collisionShape.first;
             tmpRes.m_type = targetShape.m_type & collisionShape.second->GetType();
 
-            pResults->push_back(tmpRes);
+            pResults->push_back(std::move(tmpRes));
         }
     }
 
@@ -94,7 +94,7 @@ bool KdCollider::Intersects(const SphereInfo& targetShape, const Math::Matrix& o
 // 第3引数に詳細結果の受け取る機能が付いている
 // ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// ///// /////
 bool KdCollider::Intersects(const RayInfo& targetShape, const Math::Matrix& ownerMatrix,
-                            std::list<KdCollider::CollisionResult>* pResults) const
+                            CollisionResultList* pResults) const
 {
     // 当たり判定無効のタイプの場合は返る
     if (targetShape.m_type & m_disableType) { return false; }
@@ -127,7 +127,7 @@ bool KdCollider::Intersects(const RayInfo& targetShape, const Math::Matrix& owne
             tmpRes.m_collidedObjName = collisionShape.first;
             tmpRes.m_type = targetShape.m_type;
 
-            pResults->push_back(tmpRes);
+            pResults->push_back(std::move(tmpRes));
         }
     }
 
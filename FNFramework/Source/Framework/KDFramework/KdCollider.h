@@ -88,6 +88,9 @@ public:
 	    UINT m_type = 0;				// 衝突したオブジェクトタイプ
 	};
 
+	// 詳細な衝突結果のリスト：判定した直後に使い捨てるので、フレームアロケーターから確保する
+	using CollisionResultList = utl::FrameVector<CollisionResult>;
+
 	KdCollider() {}
 
 	~KdCollider() {}
@@ -102,8 +105,8 @@ public:
 	void RegisterCollisionShape(std::string_view name, class Polygon* polygon, UINT type);
 
 	// 当たり判定実行
-	bool Intersects(const SphereInfo& targetShape, const Math::Matrix& ownerMatrix, std::list<KdCollider::CollisionResult>* pResults) const;
-	bool Intersects(const RayInfo& targetShape, const Math::Matrix& ownerMatrix, std::list<KdCollider::CollisionResult>* pResults) const;
+	bool Intersects(const SphereInfo& targetShape, const Math::Matrix& ownerMatrix, CollisionResultList* pResults) const;
+	bool Intersects(const RayInfo& targetShape, const Math::Matrix& ownerMatrix, CollisionResultList* pResults) const;
 
 	// 登録した当たり判定の有効/無効の設定
 	void SetEnable(std::string_view name, bool flag);
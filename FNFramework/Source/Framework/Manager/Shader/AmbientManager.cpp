@@ -96,14 +96,44 @@ void AmbientManager::Deserialize(const Json& _json)
 void AmbientManager::AddLight(const PointLight& _light)
 {
     // 最大数に達していないか確認
-    if (m_lightData.FramePointLightNum >= CBufferData::Light::MaxPointLightNum)
+    if (m_pointLights.size() >= LightCluster::MaxLightNum)
     {
         return;
     }
 
-    // ポイントライトを追加
-    m_lightData.PointLights[m_lightData.FramePointLightNum] = _light;
+    m_pointLights.push_back(_light);
 
-    // カウンタを更新
-    ++m_lightData.FramePointLightNum;
+    // 定数バッファは前方描画のシェーダーが読むので、入る分だけ入れておく
+    if (m_lightData.FramePointLightNum < CBufferData::Light::MaxPointLightNum)
+    {
+        m_lightData.PointLights[m_lightData.FramePointLightNum] = _light;
+        ++m_lightData.FramePointLightNum;
+    }
+}
+
+void AmbientManager::BeginBuildLightClusters(const LightCluster::Grid& grid)
+{
+    // 前のフレームの振り分けが残っていれば終わらせてから書き換える
+    WaitLightClusters();
+
+    m_lightClusterData.mView = grid.mView;
+    m_lightClusterData.SliceScale = grid.SliceScale;
+    m_lightClusterData.SliceBias = grid.SliceBias;
+
+    // ジョブの中でライトの配列を読まないように、球だけを写しておく
+    m_lightSpheres.resize(m_pointLights.size());
+    for (size_t i = 0; i < m_pointLights.size(); ++i)
+    {
+        const PointLight& light = m_pointLights[i];
+        m_lightSpheres[i] = { light.Position.x, light.Position.y, light.Position.z, light.Range };
+    }
+
+    JobSystem::Instance().Run([this, grid]() { m_lightClusterBuilder.Build(grid, m_lightSpheres); }, &m_lightClusterCounter);
+}
+
+void AmbientManager::WaitLightClusters()
+{
+    JobSystem::Instance().Wait(m_lightClusterCounter);
+
+    m_lastLightClusterStats = m_lightClusterBuilder.GetStats();
 }
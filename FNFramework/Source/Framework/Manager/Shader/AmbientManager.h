@@ -31,11 +31,42 @@ public:
     const CBufferData::Light& GetLightCBData() const { return m_lightData; }
     CBufferData::Light& WorkLightCBData() { return m_lightData; }
 
-    void ClearLight() { m_lightData.FramePointLightNum = 0; }
-
-    // ポイントライトの追加
+    void ClearLight()
+    {
+        m_lightData.FramePointLightNum = 0;
+        m_pointLights.clear();
+    }
+
+    /**
+    * @brief ポイントライトの追加
+    * @details
+    *   LightCluster::MaxLightNum まで追加できる : ライティングパスはクラスターに振り分けた番号で読む
+    *   定数バッファには先頭の CBufferData::Light::MaxPointLightNum 個だけを入れる (前方描画のシェーダー用)
+    */
     void AddLight(const PointLight& _light);
 
+    /* @brief このフレームに追加されたすべてのポイントライト */
+    const std::vector<PointLight>& GetPointLights() const { return m_pointLights; }
+
+    //x--------- ライトのクラスター関連 ---------x//
+    /**
+    * @brief ポイントライトのクラスターへの振り分けをジョブで始める
+    * @details ライトの追加が終わった後、描画の記録を始める前に呼ぶ : 記録と並行して振り分ける
+    */
+    void BeginBuildLightClusters(const LightCluster::Grid& grid);
+
+    /* @brief 振り分けの完了を待つ : 振り分けの結果を GPU に送る前に呼ぶ */
+    void WaitLightClusters();
+
+    /* @brief シェーダーに送るクラスターの分け方 */
+    const CBufferData::cbLightCluster& GetLightClusterCBData() const { return m_lightClusterData; }
+
+    /* @brief 振り分けの結果 : WaitLightClusters の後に読む */
+    const LightCluster::Builder& GetLightClusterBuilder() const { return m_lightClusterBuilder; }
+
+    /* @brief 最後に待った振り分けの結果の数 : 振り分けの途中でも読める */
+    const LightCluster::Stats& GetLastLightClusterStats() const { return m_lastLightClusterStats; }
+
 private:
 
     struct CousticsData
@@ -47,6 +78,16 @@ private:
 
     CBufferData::Light m_lightData;
 
+    // 定数バッファに入りきらない分も含めた、このフレームのポイントライト
+    std::vector<PointLight> m_pointLights;
+
+    // クラスターへの振り分け : m_lightSpheres は振り分けるジョブに渡すライトの球
+    LightCluster::Builder m_lightClusterBuilder;
+    std::vector<Math::Vector4> m_lightSpheres;
+    CBufferData::cbLightCluster m_lightClusterData;
+    LightCluster::Stats m_lastLightClusterStats;
+    JobCounter m_lightClusterCounter;
+
     CBufferData::cbFog m_fogData;
 };
 
@@ -49,13 +49,12 @@ void GBufferPass::Init()
 
     renderingSetting.InputLayouts =
     {
-        InputLayout::POSITION,
-        InputLayout::TEXCOORD,
-        InputLayout::COLOR,
-        InputLayout::NORMAL,
-        InputLayout::TANGENT,
-        InputLayout::SKININDEX,
-        InputLayout::SKINWEIGHT
+        InputLayout::MESH_POSITION,
+        InputLayout::MESH_TEXCOORD,
+        InputLayout::MESH_COLOR,
+        InputLayout::MESH_NORMAL,
+        InputLayout::MESH_SKININDEX,
+        InputLayout::MESH_SKINWEIGHT
     };
 
     renderingSetting.Formats =
@@ -73,6 +72,8 @@ void GBufferPass::Init()
 
 bool GBufferPass::Begin()
 {
+    m_isBonePaletteBound = false;
+
     RenderTarget* renderTargets[] =
     {
         m_spAlbedoGB.get(),
@@ -97,11 +98,23 @@ bool GBufferPass::Begin()
     //---------------------
     if (!ShaderManager::Instance().SetCBCameraData(0, RenderingData::MainCameraName)) { return false; }
 
+    // クラスターカリングは描画と同じカメラで判定する
+    m_clusterStats = MeshCluster::Stats{};
+    const std::shared_ptr<Camera> spCamera = ShaderManager::Instance().FindCameraData(RenderingData::MainCameraName);
+    m_hasClusterCamera = spCamera != nullptr;
+    if (m_hasClusterCamera)
+    {
+        m_mClusterViewProj = spCamera->GetViewMat() * spCamera->GetProjMat();
+        m_clusterCameraPos = spCamera->GetPos();
+    }
+
     return true;
 }
 
 void GBufferPass::End()
 {
+    m_lastClusterStats = m_clusterStats;
+
     RenderTarget* renderTargets[] =
     {
         m_spAlbedoGB.get(),
@@ -121,12 +134,11 @@ void GBufferPass::End()
 
 void GBufferPass::DrawModelInstanced(
     const std::shared_ptr<ModelData>& modelData,
-    const Renderer::InstancedRenderEntry& instanceDataEntry
+    UINT lod,
+    std::span<const InstanceData> instanceData,
+    std::span<ModelWork* const> modelWorkData
     )
 {
-    const auto& instanceData = instanceDataEntry.InstanceDataList;
-    const auto& modelWorkData = instanceDataEntry.ModelWorkList;
-
     if (!modelData || instanceData.empty() || modelWorkData.size() != instanceData.size())
     {
         return;
@@ -135,66 +147,27 @@ void GBufferPass::DrawModelInstanced(
     // 全てのメッシュノードを取得
     const auto& dataNodes = modelData->GetNodes();
 
-    // スキンメッシュかどうかの判定
-    bool isSkinMesh = modelData->IsSkinMesh();
-
-    // インスタンスごとのボーンデータを収集
-    std::vector<Math::Matrix> allBoneMatrices;
-    UINT bonesPerInstance = static_cast<UINT>(modelData->GetBoneNodeIdxList().size()); // 1インスタンスあたりのボーン数
+    // スキンメッシュの場合は、SkinningPalette に計算済みのボーン行列を使う
+    // 各インスタンスは InstanceData::BoneOffset でパレット内の位置を持っている
+    const bool isSkinMesh = modelData->IsSkinMesh() && m_bonePalette.IsValid();
 
-    if (isSkinMesh && bonesPerInstance > 0)
+    if (isSkinMesh)
     {
-        // 各インスタンスのボーンデータを収集
-        for (size_t instanceIdx = 0; instanceIdx < instanceData.size(); ++instanceIdx)
-        {
-            ModelWork* pModelWork = modelWorkData[instanceIdx];
-
-            if(pModelWork->NeedCalcNodeMatrices())
-            {
-                pModelWork->CalcNodeMatrices();
-            }
-
-            const auto& workNodes = pModelWork->WorkNodes();
+        BindBonePalette();
+    }
 
-            // 各インスタンスのボーンデータを計算
-            for (auto&& nodeIdx : modelData->GetBoneNodeIdxList())
-            {
-                if (nodeIdx >= RenderingData::MaxBoneNum)
-                {
-                    break;
-                }
-
-                const auto& dataNode = pModelWork->GetDataNodes()[nodeIdx];
-                const auto& workNode = workNodes[nodeIdx];
-
-                // ボーン行列を計算
-                Math::Matrix boneMatrix = dataNode.Bone.OffsetMatrix * workNode.mWorldTransform;
-                
-                allBoneMatrices.push_back(boneMatrix);
-            }
-        }
+    m_cbObject.Work().IsSkin = isSkinMesh;
+    m_cbObject.Bind();
 
-        // ボーン行列をGPUにアップロード
-        UploadBoneMatrices(
-            allBoneMatrices,
-            bonesPerInstance,
-            m_umModelDataToBoneData[modelData]
-        );
-        
-        // SRVをシェーダーにバインド
-        BindBoneMatricesSRV(m_umModelDataToBoneData[modelData].BoneMatrixSRVIndex);
-
-        m_cbObject.Work().IsSkin = true;
-        m_cbObject.Work().BonePerInstance = static_cast<float>(bonesPerInstance);
-    }
-    else
+    // 1つだけ描く場合は、そのワールド行列でクラスターを判定する
+    // インスタンスが複数ある場合は、インスタンスごとに見えるクラスターが違うのでまとめて描く
+    const bool useClusterCulling = m_hasClusterCamera && instanceData.size() == 1 && !isSkinMesh;
+    MeshCluster::CullView clusterView;
+    if (useClusterCulling)
     {
-        m_cbObject.Work().BonePerInstance = 0.0f;
-        m_cbObject.Work().IsSkin = false;
+        clusterView = MeshCluster::CreateCullView(instanceData.front().mWorld, m_mClusterViewProj, m_clusterCameraPos);
     }
 
-    m_cbObject.Bind();
-
     // 描画対象のメッシュノードのインデックスを取得
     const auto& meshNodeIndices = modelData->GetDrawMeshNodeIdxList();
     // const auto& meshNodeIndices = modelData->GetMeshNodeIdxList();
@@ -206,8 +179,8 @@ void GBufferPass::DrawModelInstanced(
 
         if (!dataNode.spMesh) { continue; }
 
-        // メッシュへのポインタを取得
-        const auto& mesh = dataNode.spMesh;
+        // LOD のメッシュへのポインタを取得
+        const auto& mesh = dataNode.GetMesh(lod);
 
         // インスタンスバッファを更新
         //auto instanceList = InstanceDataList;
@@ -221,9 +194,23 @@ void GBufferPass::DrawModelInstanced(
         // マテリアルの設定
         const auto& materials = modelData->GetMaterials();
 
+        const bool cullClusters = useClusterCulling && mesh->CanCullClusters();
+
         // サブセットごとに描画
         for (UINT subi = 0; subi < mesh->GetSubsets().size(); ++subi)
         {
+            // 見えるクラスターの面の範囲だけを描く : 全部見えなければマテリアルも設定しない
+            if (cullClusters)
+            {
+                m_faceRanges.clear();
+                MeshCluster::Cull(mesh->GetSubsetClusters(subi), clusterView, m_faceRanges, m_clusterStats);
+                if (m_faceRanges.empty()) { continue; }
+
+                SetMaterial(materials[mesh->GetSubsets()[subi].MaterialNo]);
+                mesh->DrawFaceRanges(m_faceRanges, 1);
+                continue;
+            }
+
             // マテリアルの設定
             SetMaterial(materials[mesh->GetSubsets()[subi].MaterialNo]);
 
@@ -233,77 +220,17 @@ void GBufferPass::DrawModelInstanced(
     }
 }
 
-void GBufferPass::UploadBoneMatrices(
-    const std::vector<Math::Matrix>& allBoneMatrices,
-    UINT numBonesPerInstance,
-    GPUBoneData& _boneData)
+void GBufferPass::BindBonePalette()
 {
-    // バッファのサイズを計算
-    UINT bufferSize = static_cast<UINT>(allBoneMatrices.size() * sizeof(Math::Matrix));
-
-    // バッファサイズが変更された場合のみ再作成
-    if (bufferSize > _boneData.BoneMatrixBufferSize)
-    {
-        // 古いバッファを解放
-        _boneData.pBoneMatrixBuffer.Reset();
-
-        // ボーン行列用のバッファリソースを作成
-        auto device = GraphicsDevice::Instance().GetDevice();
-        CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-        CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-
-        HRESULT hr = device->CreateCommittedResource(
-            &heapProps,
-            D3D12_HEAP_FLAG_NONE,
-            &bufferDesc,
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&_boneData.pBoneMatrixBuffer));
-
-        if (FAILED(hr))
-        {
-            FNENG_ASSERT_ERROR("ボーン行列バッファの作成に失敗しました");
-            return;
-        }
-
-        _boneData.BoneMatrixBufferSize = bufferSize;
-
-        // ヒープに SRV を作成
-        UINT numElements = static_cast<UINT>(allBoneMatrices.size());
-        UINT structureByteStride = sizeof(Math::Matrix);
-        _boneData.BoneMatrixSRVIndex = GraphicsDevice::Instance().GetCBVSRVUAVHeap()->CreateStructuredBufferSRV(
-            _boneData.pBoneMatrixBuffer.Get(),
-            numElements,
-            structureByteStride,
-            true);
-    }
-
-    // データをコピー
-    void* pData = nullptr;
-    HRESULT hr = _boneData.pBoneMatrixBuffer->Map(0, nullptr, &pData);
-    if (FAILED(hr))
-    {
-        FNENG_ASSERT_ERROR("ボーン行列バッファのマッピングに失敗しました");
-        return;
-    }
-    memcpy(pData, allBoneMatrices.data(), bufferSize);
-    _boneData.pBoneMatrixBuffer->Unmap(0, nullptr);
-}
-
-void GBufferPass::BindBoneMatricesSRV(UINT _srvIdx)
-{
-
-    // SRVのGPUハンドルを取得
-    D3D12_GPU_DESCRIPTOR_HANDLE srvHandle = GraphicsDevice::Instance().GetCBVSRVUAVHeap()->GetGPUHandle(_srvIdx);
-
-    // コマンドリストにSRVをセット
-    auto pCmdList = GraphicsDevice::Instance().GetCmdList();
+    // パス内で同じパレットを使うので、最初のスキンメッシュの描画時に1回だけバインドする
+    if (m_isBonePaletteBound) { return; }
 
     UINT rootParameterIndex = m_cbvCount + 1;
 
-    pCmdList->SetGraphicsRootDescriptorTable(rootParameterIndex,
-        GraphicsDevice::Instance().GetCBVSRVUAVHeap()->GetGPUHandle(_srvIdx));
+    GraphicsDevice::Instance().GetCBufferAllocater()->BindStructuredAllocation(
+        rootParameterIndex, m_bonePalette, sizeof(Math::Matrix));
 
+    m_isBonePaletteBound = true;
 }
 
 void GBufferPass::SetMaterial(const Material& _material)
@@ -371,11 +298,15 @@ void LightingPass::Init()
         RangeType::CBV, // 2 : ライト
         RangeType::CBV, // 3 : フォグ
         RangeType::CBV, // 4 : コースティクス
+        RangeType::CBV, // 5 : ライトのクラスター
         RangeType::SRV, // 0 : アルベドテクスチャ
         RangeType::SRV, // 1 : ノーマルテクスチャ
         RangeType::SRV, // 2 : 深度テクスチャ
         RangeType::SRV, // 3 : シャドウマップ
-        RangeType::SRV  // 4 : コースティクステクスチャ
+        RangeType::SRV, // 4 : コースティクステクスチャ
+        RangeType::SRV, // 5 : ポイントライト
+        RangeType::SRV, // 6 : クラスターごとのライトの範囲
+        RangeType::SRV  // 7 : クラスターの順に詰めたライトの番号
     };
 
     // 描画設定
@@ -454,9 +385,35 @@ bool LightingPass::Begin()
     GraphicsDevice::Instance().GetCBufferAllocater()->BindAttachData(3, fogData);
     GraphicsDevice::Instance().GetCBufferAllocater()->BindAttachData(4, cousticsData);
 
+    BindLightClusters();
+
     return true;
 }
 
+void LightingPass::BindLightClusters()
+{
+    const std::unique_ptr<AmbientManager>& upAmbientManager = ShaderManager::Instance().GetAmbientManager();
+    const LightCluster::Builder& builder = upAmbientManager->GetLightClusterBuilder();
+
+    GraphicsDevice::Instance().GetCBufferAllocater()->BindAttachData(5, upAmbientManager->GetLightClusterCBData());
+
+    // 空の配列はバインドされないので、ライトがなければ読まれないダミーを1つ送る
+    static const PointLight DummyLight = {};
+    static const UINT32 DummyIndex = 0;
+
+    std::span<const PointLight> pointLights = upAmbientManager->GetPointLights();
+    std::span<const UINT32> lightIndices = builder.GetLightIndices();
+    if (pointLights.empty()) { pointLights = { &DummyLight, 1 }; }
+    if (lightIndices.empty()) { lightIndices = { &DummyIndex, 1 }; }
+
+    // 範囲はクラスターの数だけ常にある : ライトがなければすべて 0 個
+    std::span<const LightCluster::Range> ranges = builder.GetRanges();
+
+    GraphicsDevice::Instance().GetCBufferAllocater()->BindStructuredData(m_cbvCount + 5, pointLights);
+    GraphicsDevice::Instance().GetCBufferAllocater()->BindStructuredData(m_cbvCount + 6, ranges);
+    GraphicsDevice::Instance().GetCBufferAllocater()->BindStructuredData(m_cbvCount + 7, lightIndices);
+}
+
 void LightingPass::End()
 {
     // レンダリングターゲットの書き込みを待つ
@@ -35,21 +35,23 @@ public:
     const ShaderResourceTexture& GetDepthGB() const { return m_spDepthGB->GetTexture(); }
     const std::shared_ptr<RenderTarget>& GetDepthRT() const { return m_spDepthGB; }
 
+    /**
+    * @brief モデルのインスタンス描画
+    * @param[in] lod - 描画する LOD : ノードの持っていない LOD は一番粗いメッシュを描く
+    */
     void DrawModelInstanced(
         const std::shared_ptr<ModelData>& modelData,
-        const Renderer::InstancedRenderEntry& instanceDataEntry);
+        UINT lod,
+        std::span<const InstanceData> instanceData,
+        std::span<ModelWork* const> modelWorkData);
 
-private:
-    struct GPUBoneData
-    {
-        // ボーン行列バッファ関連
-        ComPtr<ID3D12Resource> pBoneMatrixBuffer;
-        UINT BoneMatrixBufferSize = 0;
+    /* @brief SkinningPalette で計算したボーン行列を使う : Begin の前に呼ぶ */
+    void SetBonePalette(const UploadAllocation& bonePalette) { m_bonePalette = bonePalette; }
 
-        // SRVの登録番号
-        int BoneMatrixSRVIndex = -1;
-    };
+    /* @brief 前回のパスのクラスターカリングの結果 : デバッグ表示用 */
+    const MeshCluster::Stats& GetLastClusterStats() const { return m_lastClusterStats; }
 
+private:
     //--------------------------------
     // その他関数
     //--------------------------------
@@ -62,20 +64,27 @@ private:
      */
     void SetMaterial(const Material& _material);
 
-    void UploadBoneMatrices(
-        const std::vector<Math::Matrix>& allBoneMatrices,
-        UINT numBonesPerInstance,
-        GPUBoneData& _boneData);
-    void BindBoneMatricesSRV(UINT _srvIdx);
+    /* @brief SkinningPalette のボーン行列を StructuredBuffer としてバインドする */
+    void BindBonePalette();
+
+    // SkinningPalette で計算したボーン行列
+    UploadAllocation m_bonePalette;
+    bool m_isBonePaletteBound = false;
+
+    //x--- クラスターカリング : 1つだけ描くモデル(ステージなど)のメッシュに使う ---x//
+    bool m_hasClusterCamera = false;
+    Math::Matrix m_mClusterViewProj;
+    Math::Vector3 m_clusterCameraPos;
+
+    std::vector<MeshCluster::FaceRange> m_faceRanges; // 使い回す
+    MeshCluster::Stats m_clusterStats;
+    MeshCluster::Stats m_lastClusterStats;
     
     std::shared_ptr<RenderTarget> m_spAlbedoGB = nullptr;
     std::shared_ptr<RenderTarget> m_spNormalGB = nullptr;
     std::shared_ptr<RenderTarget> m_spDepthGB = nullptr;
 
     ConstantBuffer<CBufferData::cbDeferredObject> m_cbObject;
-
-    // メッシュ単位でのボーン情報
-    std::unordered_map<std::shared_ptr<ModelData>, GPUBoneData> m_umModelDataToBoneData;
 };
 
 /**
@@ -107,6 +116,9 @@ private:
     bool Begin() override;
     void End() override;
 
+    /* @brief ポイントライトと、クラスターごとのライトの番号をバインドする */
+    void BindLightClusters();
+
     std::shared_ptr<SpriteMesh> m_spSpriteMesh; // 全画面クアッド用のSpriteMesh
     std::shared_ptr<RenderTarget> m_spMainRenderTarget = nullptr;
 };
@@ -117,7 +117,7 @@ void ModelShader::Init()
     // 描画設定
     RenderingSetting renderingSetting = {};
     renderingSetting.InputLayouts =
-    { InputLayout::POSITION, InputLayout::TEXCOORD, InputLayout::COLOR, InputLayout::NORMAL, InputLayout::TANGENT };
+    { InputLayout::MESH_POSITION, InputLayout::MESH_TEXCOORD, InputLayout::MESH_COLOR, InputLayout::MESH_NORMAL, InputLayout::MESH_TANGENT };
     renderingSetting.Formats = { DXGI_FORMAT_R8G8B8A8_UNORM };
 
     Create(L"ModelShader", renderingSetting, rangeTypes);
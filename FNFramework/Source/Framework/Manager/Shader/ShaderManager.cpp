@@ -111,5 +111,7 @@ void ShaderManager::Init()
 void ShaderManager::Release()
 {
     m_cbCameraList.clear();
-    m_upAmbientManager->ClearLight();
+
+    // 初期化前に破棄される場合 (描画を行わないテストなど) は何もない
+    if (m_upAmbientManager) { m_upAmbientManager->ClearLight(); }
 }
@@ -1,31 +1,171 @@
 ﻿#include "Shadow.h"
 
+bool Shadow::UpdateCascades(const std::shared_ptr<Camera>& spMainCamera)
+{
+    m_hasCascades = false;
+
+    // 前回の行列が使えるかわからないので、動かないモデルの影はすべて描き直す
+    if (!spMainCamera)
+    {
+        m_staticCache.InvalidateAll();
+        return false;
+    }
+
+    const std::shared_ptr<Camera> spLightCamera = ShaderManager::Instance().FindCameraData(RenderingData::LightCameraName);
+    if (!spLightCamera)
+    {
+        m_staticCache.InvalidateAll();
+        return false;
+    }
+
+    const CameraProjMatInfo& projInfo = spMainCamera->GetProjMatInfo();
+    const Math::Matrix& mProj = spMainCamera->GetProjMat();
+    const Math::Matrix& mViewInv = spMainCamera->GetViewMatInv();
+
+    const Math::Vector3& ligDir = ShaderManager::Instance().GetAmbientManager()->GetLightCBData().LigDirection;
+    const Math::Matrix mLightRotation = ShadowCascade::CalcLightRotation(ligDir);
+
+    // 視界の外から影を落とすモデルを含めるため、ライト側に広げる距離 : 以前の影のビュー行列と同じ高さ
+    const float ligHeight = spLightCamera->GetCBData().Height;
+
+    // ライトが変わった場合は、球に収まっていてもすべて作り直す
+    const bool isLightChanged = ligDir != m_cascadeLigDir || ligHeight != m_dirLigHeight;
+    m_cascadeLigDir = ligDir;
+    m_dirLigHeight = ligHeight;
+
+    const UINT32 resolution = m_spShadowMap->GetTexWidth() / ShadowCascade::AtlasTileNum;
+
+    const std::array<float, ShadowCascade::CascadeNum + 1> splits = ShadowCascade::CalcSplitDistances(
+        projInfo.Near, std::min(projInfo.Far, m_cascadeMaxDistance), m_cascadeSplitLambda);
+
+    for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+    {
+        ShadowCascade::Cascade& cascade = m_cascades[i];
+        cascade.SplitNear = splits[i];
+        cascade.SplitFar = splits[i + 1];
+
+        float centerDist = 0.0f;
+        float radius = 0.0f;
+        ShadowCascade::CalcSliceSphere(mProj, cascade.SplitNear, cascade.SplitFar, centerDist, radius);
+
+        const Math::Vector3 center = Math::Vector3::Transform({ 0.0f, 0.0f, centerDist }, mViewInv);
+
+        // 前回の球に収まっている間は行列を変えない : 動かないモデルの影を描き直さずに済む
+        if (!isLightChanged && ShadowCascade::IsSphereCovered(cascade, center, radius)) { continue; }
+
+        cascade.SphereCenter = center;
+        cascade.SphereRadius = ShadowCascade::CalcSlackRadius(radius);
+
+        cascade.mViewProj = ShadowCascade::CalcViewProj(
+            cascade.SphereCenter, cascade.SphereRadius, mLightRotation, resolution, m_dirLigHeight);
+    }
+
+    m_hasCascades = true;
+
+    // 行列が変わったカスケードは動かないモデルの影を描き直す
+    m_staticCache.SetCascades(m_cascades);
+
+    return true;
+}
+
 bool Shadow::Begin()
 {
+    m_isBonePaletteBound = false;
+
+    if (!m_hasCascades) { return false; }
+
+    Shader::Begin(static_cast<float>(m_spShadowMap->GetTexWidth()),
+        static_cast<float>(m_spShadowMap->GetTexHeight()));
+
+    //---------------------
+    // ライティングで使う行列
+    //---------------------
+    auto& cbLightData = ShaderManager::Instance().GetAmbientManager()->WorkLightCBData();
+
+    for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+    {
+        cbLightData.DirLight_mCascadeVP[i] = m_cascades[i].mViewProj;
+    }
+
+    // 1枚のシャドウマップとして読むシェーダー向けに、最も広いカスケードをシャドウマップ内の位置に合わせて入れておく
+    constexpr UINT32 lastCascadeIdx = ShadowCascade::CascadeNum - 1;
+    cbLightData.DirLight_mVP = m_cascades[lastCascadeIdx].mViewProj * ShadowCascade::CalcAtlasTileMatrix(lastCascadeIdx);
+
+    return true;
+}
+
+bool Shadow::BeginStaticCache()
+{
+    m_staticRedrawMask = m_staticCache.GetDirtyMask();
+    if (m_staticRedrawMask == 0) { return false; }
+
+    GraphicsDevice::Instance().SetRenderTargetResourceBarrier(*m_spStaticShadowMap);
+    GraphicsDevice::Instance().SetRenderTarget(*m_spStaticShadowMap);
+
+    // 描き直すカスケードの範囲だけをクリアする
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        if ((m_staticRedrawMask & (1u << cascadeIdx)) == 0) { continue; }
+
+        const D3D12_RECT rect = CalcCascadeRect(cascadeIdx);
+        m_spStaticShadowMap->ClearDSV(&rect);
+        m_spStaticShadowMap->ClearRTV(&rect);
+    }
+
+    return true;
+}
+
+void Shadow::EndStaticCache()
+{
+    GraphicsDevice::Instance().FinishDrawingToRenderTargetResourceBarrier(*m_spStaticShadowMap);
+
+    m_staticCache.ClearDirty(m_staticRedrawMask);
+    m_staticRedrawMask = 0;
+}
+
+void Shadow::BeginDynamic()
+{
+    // 動かないモデルの影を深度ごとコピーして、動くモデルの影は深度テストで重ねる
+    m_spShadowMap->CopyFrom(*m_spStaticShadowMap);
+
     // レンダリングターゲットとして利用できるようにバリアを張る
     GraphicsDevice::Instance().SetRenderTargetResourceBarrier(*m_spShadowMap);
 
     // レンダーターゲットを0番目に設定
     GraphicsDevice::Instance().SetRenderTarget(*m_spShadowMap);
+}
 
-    m_spShadowMap->ClearDSV();
-    m_spShadowMap->ClearRTV();
+D3D12_RECT Shadow::CalcCascadeRect(UINT32 cascadeIdx) const
+{
+    const LONG tileSize = static_cast<LONG>(m_spShadowMap->GetTexWidth() / ShadowCascade::AtlasTileNum);
+    const LONG left = static_cast<LONG>(cascadeIdx % ShadowCascade::AtlasTileNum) * tileSize;
+    const LONG top = static_cast<LONG>(cascadeIdx / ShadowCascade::AtlasTileNum) * tileSize;
 
-    Shader::Begin(static_cast<float>(m_spShadowMap->GetTexWidth()),
-        static_cast<float>(m_spShadowMap->GetTexHeight()));
+    return { left, top, left + tileSize, top + tileSize };
+}
 
+void Shadow::BeginCascade(UINT32 cascadeIdx)
+{
     //---------------------
-    // 定数バッファセット
+    // カスケードの位置にビューポートを合わせる
     //---------------------
-    auto ligCam = ShaderManager::Instance().FindCameraData(RenderingData::LightCameraName);
-    SetCBShadowArea(ligCam->GetProjMat(), ligCam->GetCBData().Height);
+    m_rect = CalcCascadeRect(cascadeIdx);
 
+    m_viewPort.TopLeftX = static_cast<float>(m_rect.left);
+    m_viewPort.TopLeftY = static_cast<float>(m_rect.top);
+    m_viewPort.Width = static_cast<float>(m_rect.right - m_rect.left);
+    m_viewPort.Height = static_cast<float>(m_rect.bottom - m_rect.top);
+
+    GraphicsDevice::Instance().GetCmdList()->RSSetViewports(1, &m_viewPort);
+    GraphicsDevice::Instance().GetCmdList()->RSSetScissorRects(1, &m_rect);
+
+    //---------------------
+    // 定数バッファセット
+    //---------------------
     CBufferData::Camera camDat;
-    camDat.mViewProj = ShaderManager::Instance().GetAmbientManager()->GetLightCBData().DirLight_mVP;
+    camDat.mViewProj = m_cascades[cascadeIdx].mViewProj;
 
     GraphicsDevice::Instance().GetCBufferAllocater()->BindAttachData(0, camDat);
-
-    return true;
 }
 
 void Shadow::End()
@@ -66,15 +206,12 @@ void Shadow::Init()
 
 	// 描画設定
 	RenderingSetting renderingSetting = {};
+    // 深度だけを書くので、座標とスキンのストリームだけを読む
     renderingSetting.InputLayouts =
     {
-        InputLayout::POSITION,
-        InputLayout::TEXCOORD,
-        InputLayout::COLOR,
-        InputLayout::NORMAL,
-        InputLayout::TANGENT,
-        InputLayout::SKININDEX,
-        InputLayout::SKINWEIGHT
+        InputLayout::MESH_POSITION,
+        InputLayout::MESH_SKININDEX,
+        InputLayout::MESH_SKINWEIGHT
     };
 	renderingSetting.Formats = { DXGI_FORMAT_R32_FLOAT };
 	renderingSetting.RTVCount = 1;
@@ -84,8 +221,8 @@ void Shadow::Init()
 	Shader::Create(L"Shadow", renderingSetting, rangeTypes);
 }
 
-void Shadow::DrawModelInstanced(const std::shared_ptr<ModelData>& modelData,
-    const std::vector<InstanceData>& instanceDataList, const std::vector<ModelWork*>& modelWorks)
+void Shadow::DrawModelInstanced(const std::shared_ptr<ModelData>& modelData, UINT lod,
+    std::span<const InstanceData> instanceDataList, std::span<ModelWork* const> modelWorks)
 {
     if (!modelData || instanceDataList.empty() || modelWorks.size() != instanceDataList.size())
     {
@@ -95,63 +232,16 @@ void Shadow::DrawModelInstanced(const std::shared_ptr<ModelData>& modelData,
     // 全てのメッシュノードを取得
     const auto& dataNodes = modelData->GetNodes();
 
-    // スキンメッシュかどうかの判定
-    bool isSkinMesh = modelData->IsSkinMesh();
+    // スキンメッシュの場合は、SkinningPalette に計算済みのボーン行列を使う
+    // 各インスタンスは InstanceData::BoneOffset でパレット内の位置を持っている
+    const bool isSkinMesh = modelData->IsSkinMesh() && m_bonePalette.IsValid();
 
-    // インスタンスごとのボーンデータを収集
-    std::vector<Math::Matrix> allBoneMatrices;
-    UINT bonesPerInstance = static_cast<UINT>(modelData->GetBoneNodeIdxList().size()); // 1インスタンスあたりのボーン数
-
-    if (isSkinMesh && bonesPerInstance > 0)
+    if (isSkinMesh)
     {
-        // 各インスタンスのボーンデータを収集
-        for (size_t instanceIdx = 0; instanceIdx < instanceDataList.size(); ++instanceIdx)
-        {
-            ModelWork* pModelWork = modelWorks[instanceIdx];
-
-            if (pModelWork->NeedCalcNodeMatrices())
-            {
-                pModelWork->CalcNodeMatrices();
-            }
-
-            const auto& workNodes = pModelWork->WorkNodes();
-
-            // 各インスタンスのボーンデータを計算
-            for (auto&& nodeIdx : modelData->GetBoneNodeIdxList())
-            {
-                if (nodeIdx >= RenderingData::MaxBoneNum)
-                {
-                    break;
-                }
-
-                const auto& dataNode = pModelWork->GetDataNodes()[nodeIdx];
-                const auto& workNode = workNodes[nodeIdx];
-
-                // ボーン行列を計算
-                Math::Matrix boneMatrix = dataNode.Bone.OffsetMatrix * workNode.mWorldTransform;
-
-                allBoneMatrices.push_back(boneMatrix);
-            }
-        }
-
-        // ボーン行列をGPUにアップロード
-        UploadBoneMatrices(
-            allBoneMatrices,
-            bonesPerInstance,
-            m_umModelDataToBoneData[modelData]
-        );
-
-        // SRVをシェーダーにバインド
-        BindBoneMatricesSRV(m_umModelDataToBoneData[modelData].BoneMatrixSRVIndex);
-
-        m_cbObject.Work().IsSkin = true;
-        m_cbObject.Work().BonePerInstance = static_cast<float>(bonesPerInstance);
-    }
-    else
-    {
-        m_cbObject.Work().BonePerInstance = 0.0f;
-        m_cbObject.Work().IsSkin = false;
+        BindBonePalette();
     }
+
+    m_cbObject.Work().IsSkin = isSkinMesh;
     m_cbObject.Bind();
 
     // 描画対象のメッシュノードのインデックスを取得
@@ -164,8 +254,8 @@ void Shadow::DrawModelInstanced(const std::shared_ptr<ModelData>& modelData,
 
         if (!dataNode.spMesh) { continue; }
 
-        // メッシュへのポインタを取得
-        const auto& mesh = dataNode.spMesh;
+        // LOD のメッシュへのポインタを取得
+        const auto& mesh = dataNode.GetMesh(lod);
 
         mesh->UpdateInstanceBuffer(instanceDataList);
 
@@ -178,31 +268,6 @@ void Shadow::DrawModelInstanced(const std::shared_ptr<ModelData>& modelData,
     }
 }
 
-void Shadow::SetCBShadowArea(const Math::Matrix& mProj, float ligHeight)
-{
-    // メインカメラの情報を取得
-    const std::shared_ptr<Camera>& mainCamera = ShaderManager::Instance().FindCameraData(RenderingData::MainCameraName);
-
-    if (!mainCamera)
-    {
-        FNENG_ASSERT_ERROR("カメラ情報が登録されていませんでした");
-        return;
-    }
-
-    // 影生成の開始位置はメインカメラ(今見ている視点)の位置
-    Math::Vector3 ligPos = mainCamera->GetCBData().CamPos;
-
-    auto& cbLidhtData = ShaderManager::Instance().GetAmbientManager()->WorkLightCBData();
-
-    // 影の向きは平行光の向き
-    Math::Vector3 ligDir = cbLidhtData.LigDirection;
-    Math::Vector3 up = (ligDir == Math::Vector3::Up) ? Math::Vector3::Right : Math::Vector3::Up;
-
-    // ライトの位置をカメラの位置から算出
-    cbLidhtData.DirLight_mVP = XMMatrixLookAtLH(ligPos - ligDir * ligHeight, ligPos, up);
-    cbLidhtData.DirLight_mVP *= mProj;
-}
-
 bool Shadow::SetCBShadowAreaData(std::string_view camName)
 {
     //---------------------
@@ -228,86 +293,35 @@ bool Shadow::SetCBShadowAreaData(std::string_view camName)
 bool Shadow::CreateShadowMap()
 {
 	m_spShadowMap = std::make_shared<RenderTarget>();
+	m_spStaticShadowMap = std::make_shared<RenderTarget>();
 
-    // シャドウマップのサイズ
+    // シャドウマップのサイズ : 動かないモデルの影もコピーするので同じ大きさにする
 	constexpr std::pair shadowMapSize = { 4096, 4096 };
-	m_spShadowMap->Create(shadowMapSize.first, shadowMapSize.second,
-	    1, 1,
-	    DXGI_FORMAT_R32_FLOAT,
-	    DXGI_FORMAT_R32_TYPELESS,
-	    Color::Red,
-	    true);
+	for (const std::shared_ptr<RenderTarget>& spMap : { m_spShadowMap, m_spStaticShadowMap })
+	{
+	    if (!spMap->Create(shadowMapSize.first, shadowMapSize.second,
+	        1, 1,
+	        DXGI_FORMAT_R32_FLOAT,
+	        DXGI_FORMAT_R32_TYPELESS,
+	        Color::Red,
+	        true))
+	    {
+	        return false;
+	    }
+	}
 
 	return true;
 }
 
-void Shadow::UploadBoneMatrices(
-    const std::vector<Math::Matrix>& allBoneMatrices,
-    UINT numBonesPerInstance,
-    GPUBoneData& _boneData)
-{
-    // バッファのサイズを計算
-    UINT bufferSize = static_cast<UINT>(allBoneMatrices.size() * sizeof(Math::Matrix));
-
-    // バッファサイズが変更された場合のみ再作成
-    if (bufferSize > _boneData.BoneMatrixBufferSize)
-    {
-        // 古いバッファを解放
-        _boneData.pBoneMatrixBuffer.Reset();
-
-        // ボーン行列用のバッファリソースを作成
-        auto device = GraphicsDevice::Instance().GetDevice();
-        CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-        CD3DX12_RESOURCE_DESC bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-
-        HRESULT hr = device->CreateCommittedResource(
-            &heapProps,
-            D3D12_HEAP_FLAG_NONE,
-            &bufferDesc,
-            D3D12_RESOURCE_STATE_GENERIC_READ,
-            nullptr,
-            IID_PPV_ARGS(&_boneData.pBoneMatrixBuffer));
-
-        if (FAILED(hr))
-        {
-            FNENG_ASSERT_ERROR("ボーン行列バッファの作成に失敗しました");
-            return;
-        }
-
-        _boneData.BoneMatrixBufferSize = bufferSize;
-
-        // ヒープに SRV を作成
-        UINT numElements = static_cast<UINT>(allBoneMatrices.size());
-        UINT structureByteStride = sizeof(Math::Matrix);
-        _boneData.BoneMatrixSRVIndex = GraphicsDevice::Instance().GetCBVSRVUAVHeap()->CreateStructuredBufferSRV(
-            _boneData.pBoneMatrixBuffer.Get(),
-            numElements,
-            structureByteStride,
-            true);
-    }
-
-    // データをコピー
-    void* pData = nullptr;
-    HRESULT hr = _boneData.pBoneMatrixBuffer->Map(0, nullptr, &pData);
-    if (FAILED(hr))
-    {
-        FNENG_ASSERT_ERROR("ボーン行列バッファのマッピングに失敗しました");
-        return;
-    }
-    memcpy(pData, allBoneMatrices.data(), bufferSize);
-    _boneData.pBoneMatrixBuffer->Unmap(0, nullptr);
-}
-
-void Shadow::BindBoneMatricesSRV(UINT _srvIdx)
+void Shadow::BindBonePalette()
 {
-    // SRVのGPUハンドルを取得
-    D3D12_GPU_DESCRIPTOR_HANDLE srvHandle = GraphicsDevice::Instance().GetCBVSRVUAVHeap()->GetGPUHandle(_srvIdx);
-
-    // コマンドリストにSRVをセット
-    auto pCmdList = GraphicsDevice::Instance().GetCmdList();
+    // パス内で同じパレットを使うので、最初のスキンメッシュの描画時に1回だけバインドする
+    if (m_isBonePaletteBound) { return; }
 
     UINT rootParameterIndex = m_cbvCount + 1;
 
-    pCmdList->SetGraphicsRootDescriptorTable(rootParameterIndex,
-        GraphicsDevice::Instance().GetCBVSRVUAVHeap()->GetGPUHandle(_srvIdx));
+    GraphicsDevice::Instance().GetCBufferAllocater()->BindStructuredAllocation(
+        rootParameterIndex, m_bonePalette, sizeof(Math::Matrix));
+
+    m_isBonePaletteBound = true;
 }
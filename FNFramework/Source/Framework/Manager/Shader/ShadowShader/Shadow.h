@@ -1,5 +1,17 @@
 ﻿#pragma once
 
+/**
+* @class Shadow
+* @brief 平行光のカスケードシャドウマップを描画するシェーダー
+* @details
+*   - UpdateCascades でメインカメラの視錐台を分割し、カスケードごとの行列を作る
+*   - シャドウマップは1枚を 2x2 に分け、BeginCascade でカスケードの位置にビューポートを合わせて描画する
+*   - 動かないモデルの影は別のシャドウマップに描いておき、ShadowCacheTracker が描き直すと判定したカスケードだけ描き直す
+*     毎フレームそのシャドウマップを深度ごとコピーし、その上に動くモデルの影だけを描画する
+*
+*   描画の流れ
+*   - Begin -> [BeginStaticCache -> BeginCascade -> ... -> EndStaticCache] -> BeginDynamic -> BeginCascade -> ... -> End
+*/
 class Shadow
     :public Shader
 {
@@ -18,23 +30,69 @@ public:
     const Math::Matrix& GetShadowProj() const { return m_mShadowProj; }
     float GetDirLightHeight() const { return m_dirLigHeight; }
 
+    /* @brief 動かないモデルの影のキャッシュ : 描き直すカスケードを持つ */
+    const ShadowCacheTracker& GetStaticCache() const { return m_staticCache; }
+
+    /* @brief UpdateCascades で作ったカスケード */
+    const std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum>& GetCascades() const { return m_cascades; }
+
+    // カスケードの分割の設定
+    void SetCascadeSplitLambda(float lambda) { m_cascadeSplitLambda = lambda; }
+    float GetCascadeSplitLambda() const { return m_cascadeSplitLambda; }
+    void SetCascadeMaxDistance(float distance) { m_cascadeMaxDistance = distance; }
+    float GetCascadeMaxDistance() const { return m_cascadeMaxDistance; }
+
     //--------------------------------
     // その他関数
     //--------------------------------
+    /**
+    * @brief カスケードの作成 : 更新処理の最後に1フレームに1回呼ぶ
+    * @param[in] spMainCamera - 分割するメインカメラ
+    * @return カスケードが作れたか : 作れなければ影を描画しない
+    */
+    bool UpdateCascades(const std::shared_ptr<Camera>& spMainCamera);
+
+    /**
+    * @brief 動かないモデルの影の描き直し : UpdateCascades の後に呼ぶ
+    * @param[in] min, max - 動いた / 増えた / 消えたモデルのワールド空間の AABB
+    */
+    void InvalidateStaticCache(const Math::Vector3& min, const Math::Vector3& max) { m_staticCache.InvalidateBox(min, max); }
+
+    /* @brief パイプラインと行列の設定 : カスケードがなければ false */
     bool Begin() override;
     void End() override;
 
+    /**
+    * @brief 動かないモデルの影の描画の開始 : 描き直すカスケードだけをクリアする
+    * @return 描き直すカスケードがなければ false
+    */
+    bool BeginStaticCache();
+    /* @brief 描き直したカスケードを ShadowCacheTracker に伝える */
+    void EndStaticCache();
+
+    /* @brief 動くモデルの影の描画の開始 : 動かないモデルの影をコピーして、その上に描く */
+    void BeginDynamic();
+
+    /* @brief カスケードの描画の開始 : ビューポートとカメラの定数バッファを切り替える */
+    void BeginCascade(UINT32 cascadeIdx);
+
+    /* @brief シャドウマップの中のカスケードの範囲 : ピクセル単位 */
+    D3D12_RECT CalcCascadeRect(UINT32 cascadeIdx) const;
+
     void Init();
 
     void DrawModelInstanced(
         const std::shared_ptr<ModelData>& modelData,
-        const std::vector<InstanceData>& instanceDataList,
-        const std::vector<ModelWork*>& modelWorks);
+        UINT lod, // 描画する LOD : GBuffer と同じ LOD を使う
+        std::span<const InstanceData> instanceDataList,
+        std::span<ModelWork* const> modelWorks);
+
+    /* @brief SkinningPalette で計算したボーン行列を使う : Begin の前に呼ぶ */
+    void SetBonePalette(const UploadAllocation& bonePalette) { m_bonePalette = bonePalette; }
+
 
 private:
 
-    /* @biref 影生成エリアの設定 */
-    void SetCBShadowArea(const Math::Matrix& mProj, float ligHeight);
     // 影描画エリアの定数バッファのセット
     bool SetCBShadowAreaData(std::string_view camName);
 
@@ -42,31 +100,39 @@ private:
 
     // 影用レンダーターゲット
     std::shared_ptr<RenderTarget> m_spShadowMap = nullptr;
+    // 動かないモデルの影だけを描いておくレンダーターゲット
+    std::shared_ptr<RenderTarget> m_spStaticShadowMap = nullptr;
+
+    // 動かないモデルの影を描き直すカスケードの管理
+    ShadowCacheTracker m_staticCache;
+    // BeginStaticCache で描き直しているカスケード
+    UINT32 m_staticRedrawMask = 0;
 
     // 影用プロジェクション行列
     Math::Matrix m_mShadowProj;
     // 影のビュー行列をどの高さから作成するか
     float m_dirLigHeight = 0.0f;
 
+    // カスケード
+    std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum> m_cascades = {};
+    bool m_hasCascades = false;
+
+    // カスケードの行列を作った時の平行光の向き : 変わったら球に収まっていても作り直す
+    Math::Vector3 m_cascadeLigDir = Math::Vector3::Zero;
+
+    // 対数分割の割合 : 0 で均等分割、1 で対数分割
+    float m_cascadeSplitLambda = 0.75f;
+    // 影を描画する最も遠い距離
+    float m_cascadeMaxDistance = 200.0f;
+
+    /* @brief SkinningPalette のボーン行列を StructuredBuffer としてバインドする */
+    void BindBonePalette();
+
+    // SkinningPalette で計算したボーン行列
+    UploadAllocation m_bonePalette;
+    bool m_isBonePaletteBound = false;
+
     // 定数バッファ
-    struct GPUBoneData
-    {
-        // ボーン行列バッファ関連
-        ComPtr<ID3D12Resource> pBoneMatrixBuffer;
-        UINT BoneMatrixBufferSize = 0;
-
-        // SRVの登録番号
-        int BoneMatrixSRVIndex = -1;
-    };
-
-    void UploadBoneMatrices(
-        const std::vector<Math::Matrix>& allBoneMatrices,
-        UINT numBonesPerInstance,
-        GPUBoneData& _boneData);
-    void BindBoneMatricesSRV(UINT _srvIdx);
-
-    // メッシュ単位でのボーン情報
-    std::unordered_map<std::shared_ptr<ModelData>, GPUBoneData> m_umModelDataToBoneData;
     ConstantBuffer<CBufferData::cbDeferredObject> m_cbObject;
 
 };
@@ -0,0 +1,35 @@
+﻿#include "ShadowCacheTracker.h"
+
+void ShadowCacheTracker::SetCascades(const std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum>& cascades)
+{
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        const Math::Matrix& mViewProj = cascades[cascadeIdx].mViewProj;
+
+        // 行列はテクセル単位にそろえてあるので、同じ範囲なら値も一致する
+        if (m_viewProjs[cascadeIdx] == mViewProj) { continue; }
+
+        m_viewProjs[cascadeIdx] = mViewProj;
+        m_planes[cascadeIdx] = FrustumCulling::ExtractPlanes(mViewProj);
+
+        m_dirtyMask |= 1u << cascadeIdx;
+    }
+}
+
+void ShadowCacheTracker::InvalidateBox(const Math::Vector3& min, const Math::Vector3& max)
+{
+    const Math::Vector3 center = (min + max) * 0.5f;
+    const Math::Vector3 extents = (max - min) * 0.5f;
+
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        // 描き直すことが決まっているカスケードは判定しない
+        if ((m_dirtyMask & (1u << cascadeIdx)) != 0) { continue; }
+
+        UINT32 planeMask = FrustumCulling::AllPlaneMask;
+        if (FrustumCulling::ClassifyAABB(m_planes[cascadeIdx], center, extents, planeMask))
+        {
+            m_dirtyMask |= 1u << cascadeIdx;
+        }
+    }
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+
+/**
+* @class ShadowCacheTracker
+* @brief 動かないモデルの影を描いておくシャドウマップを、カスケードごとに描き直すかを管理するクラス
+* @details
+*   - GPU は使わず、描き直すカスケードを 1bit = 1カスケードのビットで返すだけ
+*   - カスケードの行列が前回描いた時から変わったカスケードは描き直す : ライトの向きが変わった場合もここに入る
+*   - 動かないモデルが動いた / 増えた / 消えた場合は、そのモデルの AABB に重なるカスケードだけを描き直す
+*   - 描き直したら ClearDirty で伝える : 伝えるまでは描き直す扱いのまま
+*/
+class ShadowCacheTracker
+{
+public:
+    //--------------------------------
+    // その他関数
+    //--------------------------------
+    /**
+    * @brief カスケードの行列の設定 : 1フレームに1回、カスケードを作った後に呼ぶ
+    * @param[in] cascades - 今回のフレームのカスケード
+    */
+    void SetCascades(const std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum>& cascades);
+
+    /**
+    * @brief 範囲に重なるカスケードを描き直す
+    * @details SetCascades の後に呼ぶ : 今回のフレームのカスケードで判定する
+    */
+    void InvalidateBox(const Math::Vector3& min, const Math::Vector3& max);
+
+    /* @brief すべてのカスケードを描き直す : カスケードが作れなかった場合など */
+    void InvalidateAll() { m_dirtyMask = ShadowCascade::AllCascadeMask; }
+
+    /* @brief 描き直したカスケードを伝える */
+    void ClearDirty(UINT32 cascadeMask)
+    {
+        m_dirtyMask &= ~cascadeMask;
+        m_lastRedrawMask = cascadeMask;
+        ++m_redrawNum;
+    }
+
+    //--------------------------------
+    // ゲッター
+    //--------------------------------
+    /* @brief 描き直すカスケード : 1bit = 1カスケード */
+    UINT32 GetDirtyMask() const { return m_dirtyMask; }
+
+    // デバッグ表示用 : 最後に描き直したカスケードと、描き直した回数
+    UINT32 GetLastRedrawMask() const { return m_lastRedrawMask; }
+    UINT32 GetRedrawNum() const { return m_redrawNum; }
+
+private:
+    // 前回のフレームのカスケードの行列と、その視錐台
+    std::array<Math::Matrix, ShadowCascade::CascadeNum> m_viewProjs = {};
+    std::array<FrustumCulling::Planes, ShadowCascade::CascadeNum> m_planes = {};
+
+    // 最初はすべて描き直す
+    UINT32 m_dirtyMask = ShadowCascade::AllCascadeMask;
+
+    UINT32 m_lastRedrawMask = 0;
+    UINT32 m_redrawNum = 0;
+};
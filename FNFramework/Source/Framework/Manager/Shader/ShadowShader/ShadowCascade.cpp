@@ -0,0 +1,107 @@
+﻿#include "ShadowCascade.h"
+
+namespace ShadowCascade
+{
+    std::array<float, CascadeNum + 1> CalcSplitDistances(float nearClip, float farClip, float lambda)
+    {
+        std::array<float, CascadeNum + 1> splits = {};
+
+        splits[0] = nearClip;
+        splits[CascadeNum] = farClip;
+
+        // 近くは対数分割で細かく、遠くは均等分割で粗くなりすぎないように混ぜる
+        for (UINT32 i = 1; i < CascadeNum; ++i)
+        {
+            const float rate = static_cast<float>(i) / CascadeNum;
+
+            const float logSplit = nearClip * std::pow(farClip / nearClip, rate);
+            const float uniformSplit = nearClip + (farClip - nearClip) * rate;
+
+            splits[i] = lambda * logSplit + (1.0f - lambda) * uniformSplit;
+        }
+
+        return splits;
+    }
+
+    void CalcSliceSphere(const Math::Matrix& mProj, float splitNear, float splitFar, float& centerDist, float& radius)
+    {
+        // 射影行列の逆行列で、手前と奥の角のビュー空間での位置を求める
+        const Math::Matrix mProjInv = mProj.Invert();
+
+        const auto calcCorner = [&mProj, &mProjInv](float viewZ)
+        {
+            const Math::Vector3 ndc = Math::Vector3::Transform({ 0.0f, 0.0f, viewZ }, mProj);
+            return Math::Vector3::Transform({ 1.0f, 1.0f, ndc.z }, mProjInv);
+        };
+
+        const Math::Vector3 nearCorner = calcCorner(splitNear);
+        const Math::Vector3 farCorner = calcCorner(splitFar);
+
+        // 角はカメラの軸から見て対称なので、軸上で手前の角と奥の角から同じ距離の点が中心になる
+        const float nearRadiusSq = nearCorner.x * nearCorner.x + nearCorner.y * nearCorner.y;
+        const float farRadiusSq = farCorner.x * farCorner.x + farCorner.y * farCorner.y;
+
+        centerDist = ((splitFar * splitFar + farRadiusSq) - (splitNear * splitNear + nearRadiusSq)) / (2.0f * (splitFar - splitNear));
+        centerDist = std::clamp(centerDist, splitNear, splitFar);
+
+        const float nearDist = std::sqrt((centerDist - splitNear) * (centerDist - splitNear) + nearRadiusSq);
+        const float farDist = std::sqrt((splitFar - centerDist) * (splitFar - centerDist) + farRadiusSq);
+
+        // 計算誤差で毎フレーム大きさが揺れないように、少し大きい方に丸める
+        radius = std::ceil(std::max(nearDist, farDist) * RadiusQuantize) / RadiusQuantize;
+    }
+
+    float CalcSlackRadius(float radius)
+    {
+        return std::ceil(radius * (1.0f + RefitSlackRate) * RadiusQuantize) / RadiusQuantize;
+    }
+
+    bool IsSphereCovered(const Cascade& cascade, const Math::Vector3& center, float radius)
+    {
+        if (cascade.SphereRadius <= 0.0f) { return false; }
+
+        // 分割の範囲を変えて球が小さくなった場合は、解像度を戻すために作り直す
+        if (cascade.SphereRadius > CalcSlackRadius(CalcSlackRadius(radius))) { return false; }
+
+        return Math::Vector3::Distance(cascade.SphereCenter, center) + radius <= cascade.SphereRadius;
+    }
+
+    Math::Matrix CalcLightRotation(const Math::Vector3& ligDir)
+    {
+        const Math::Vector3 up = (ligDir == Math::Vector3::Up) ? Math::Vector3::Right : Math::Vector3::Up;
+        return DirectX::XMMatrixLookAtLH(Math::Vector3::Zero, ligDir, up);
+    }
+
+    Math::Matrix CalcViewProj(const Math::Vector3& sphereCenter, float sphereRadius,
+        const Math::Matrix& mLightRotation, UINT32 resolution, float casterExtrusion)
+    {
+        const Math::Vector3 centerLS = Math::Vector3::Transform(sphereCenter, mLightRotation);
+
+        // 光に垂直な方向の範囲をテクセル単位にそろえる
+        const float texelSize = (sphereRadius * 2.0f) / static_cast<float>(resolution);
+        const float snapX = std::floor(centerLS.x / texelSize) * texelSize;
+        const float snapY = std::floor(centerLS.y / texelSize) * texelSize;
+
+        // 奥行きはライト側にだけ広げる : 球の手前にあるモデルも影を落とす
+        const Math::Matrix mProj = DirectX::XMMatrixOrthographicOffCenterLH(
+            snapX - sphereRadius, snapX + sphereRadius,
+            snapY - sphereRadius, snapY + sphereRadius,
+            centerLS.z - sphereRadius - casterExtrusion, centerLS.z + sphereRadius);
+
+        return mLightRotation * mProj;
+    }
+
+    Math::Matrix CalcAtlasTileMatrix(UINT32 cascadeIdx)
+    {
+        const float column = static_cast<float>(cascadeIdx % AtlasTileNum);
+        const float row = static_cast<float>(cascadeIdx / AtlasTileNum);
+        const float scale = 1.0f / AtlasTileNum;
+
+        // UV の v は下向きなので、行が進むほど射影空間の y は下がる
+        return Math::Matrix::CreateScale(scale, scale, 1.0f) *
+            Math::Matrix::CreateTranslation(
+                (column + 0.5f) * scale * 2.0f - 1.0f,
+                1.0f - (row + 0.5f) * scale * 2.0f,
+                0.0f);
+    }
+}
@@ -0,0 +1,100 @@
+﻿#pragma once
+
+/**
+* @namespace ShadowCascade
+* @brief カスケードシャドウマップの分割と行列の計算
+* @details
+*   - メインカメラの視錐台を奥行き方向に分割し、分割ごとに別のシャドウマップで影を描画する
+*   - 分割距離は対数分割と均等分割を混ぜた方式(practical split scheme)で決める
+*   - 分割した視錐台は包む球で囲むので、カメラが回転しても平行投影の大きさは変わらない
+*   - 平行投影の範囲はライト空間でテクセル単位にずらすので、カメラが動いても影の輪郭がちらつかない
+*   - 球は少し大きめに作り、分割した視錐台が収まっている間は前回の行列を使い続ける
+*     行列が変わらなければ、動かないモデルの影を描いたシャドウマップを描き直さずに済む
+*   - シャドウマップは1枚のテクスチャを 2x2 に分けて使う
+*/
+namespace ShadowCascade
+{
+    // カスケードの数
+    static constexpr UINT32 CascadeNum = 4;
+
+    // シャドウマップの1辺に並べるカスケードの数
+    static constexpr UINT32 AtlasTileNum = 2;
+
+    // すべてのカスケードに描画する場合のビット
+    static constexpr UINT32 AllCascadeMask = (1u << CascadeNum) - 1;
+
+    // 球の半径の丸め単位の逆数 : 行列の計算誤差で毎フレーム大きさが変わらないようにする
+    static constexpr float RadiusQuantize = 16.0f;
+
+    // 球を大きめに作る割合 : 大きいほど行列を作り直す回数が減り、影の解像度が下がる
+    static constexpr float RefitSlackRate = 0.15f;
+
+    /* @brief 1つのカスケード */
+    struct Cascade
+    {
+        Math::Matrix mViewProj;
+
+        // 分割したメインカメラの視錐台の範囲 : カメラからの奥行き
+        float SplitNear = 0.0f;
+        float SplitFar = 0.0f;
+
+        // 分割した視錐台を包む球
+        Math::Vector3 SphereCenter;
+        float SphereRadius = 0.0f;
+    };
+
+    /**
+    * @brief 分割距離の計算
+    * @param[in] nearClip - メインカメラのニアクリップ
+    * @param[in] farClip  - 影を描画する最も遠い距離
+    * @param[in] lambda   - 対数分割の割合 : 0 で均等分割、1 で対数分割
+    * @return 各カスケードの手前と奥 : [i] と [i + 1] が i 番目のカスケード
+    */
+    std::array<float, CascadeNum + 1> CalcSplitDistances(float nearClip, float farClip, float lambda);
+
+    /**
+    * @brief 分割した視錐台を包む最小の球
+    * @param[in]  mProj      - メインカメラの射影行列 : 左右上下が対称なもの
+    * @param[in]  splitNear  - 分割の手前
+    * @param[in]  splitFar   - 分割の奥
+    * @param[out] centerDist - 球の中心のカメラからの奥行き
+    * @param[out] radius     - 球の半径 : カメラの向きに関係なく同じ値になる
+    */
+    void CalcSliceSphere(const Math::Matrix& mProj, float splitNear, float splitFar, float& centerDist, float& radius);
+
+    /* @brief 大きめに作った球の半径 : CalcSliceSphere の半径から作る */
+    float CalcSlackRadius(float radius);
+
+    /**
+    * @brief 前回の球で今回の分割した視錐台を包めるか
+    * @param[in] cascade - 前回のカスケード
+    * @param[in] center  - 今回の分割を包む最小の球の中心
+    * @param[in] radius  - 今回の分割を包む最小の球の半径
+    * @return 包めて、前回の球が大きすぎなければ true : 前回の行列をそのまま使う
+    */
+    bool IsSphereCovered(const Cascade& cascade, const Math::Vector3& center, float radius);
+
+    /**
+    * @brief 平行光の向きだけを持つビュー行列
+    * @param[in] ligDir - 平行光の向き
+    */
+    Math::Matrix CalcLightRotation(const Math::Vector3& ligDir);
+
+    /**
+    * @brief カスケードの行列の作成
+    * @param[in] sphereCenter    - 包む球の中心 : ワールド空間
+    * @param[in] sphereRadius    - 包む球の半径
+    * @param[in] mLightRotation  - CalcLightRotation で作った行列
+    * @param[in] resolution      - カスケード1つ分のシャドウマップの解像度
+    * @param[in] casterExtrusion - 球よりライト側に広げる距離 : 視界の外から影を落とすモデルを含める
+    * @return ライトのビュー行列 * 平行投影行列 : 範囲はテクセル単位にずらしてある
+    */
+    Math::Matrix CalcViewProj(const Math::Vector3& sphereCenter, float sphereRadius,
+        const Math::Matrix& mLightRotation, UINT32 resolution, float casterExtrusion);
+
+    /**
+    * @brief 射影空間をシャドウマップの中のカスケードの位置に移す行列
+    * @details カスケードの行列に掛けると、シャドウマップ全体の UV として読める
+    */
+    Math::Matrix CalcAtlasTileMatrix(UINT32 cascadeIdx);
+}
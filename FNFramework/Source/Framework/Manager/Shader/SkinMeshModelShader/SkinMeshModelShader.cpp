@@ -161,10 +161,10 @@ void SkinMeshModelShader::Init()
     RenderingSetting renderingSetting = {};
     renderingSetting.InputLayouts =
     {
-        InputLayout::POSITION, InputLayout::TEXCOORD,
-        InputLayout::COLOR, InputLayout::NORMAL,
-        InputLayout::TANGENT,
-        InputLayout::SKININDEX, InputLayout::SKINWEIGHT
+        InputLayout::MESH_POSITION, InputLayout::MESH_TEXCOORD,
+        InputLayout::MESH_COLOR, InputLayout::MESH_NORMAL,
+        InputLayout::MESH_TANGENT,
+        InputLayout::MESH_SKININDEX, InputLayout::MESH_SKINWEIGHT
     };
     renderingSetting.Formats = { DXGI_FORMAT_R8G8B8A8_UNORM };
 
@@ -12,7 +12,7 @@ void ModelShader_Unlit::Init()
 	// 描画設定
 	RenderingSetting renderingSetting = {};
 	renderingSetting.InputLayouts =
-	{ InputLayout::POSITION, InputLayout::TEXCOORD, InputLayout::COLOR };
+	{ InputLayout::MESH_POSITION, InputLayout::MESH_TEXCOORD, InputLayout::MESH_COLOR };
 	renderingSetting.Formats = { DXGI_FORMAT_R8G8B8A8_UNORM };
 
 	Shader::Create(L"ModelShader_Unlit", renderingSetting, rangeTypes);
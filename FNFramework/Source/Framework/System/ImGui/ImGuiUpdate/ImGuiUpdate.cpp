@@ -9,6 +9,9 @@ void ImGuiUpdate::Init()
 
 void ImGuiUpdate::Update()
 {
+    // ImGui の初期化前 (描画を行わないテストなど) は何もしない
+    if (!ImGui::GetCurrentContext()) { return; }
+
     if (InputSystem::Instance().IsPressed("ImGui"))
     {
         m_isUpdate = !m_isUpdate;
@@ -111,6 +114,36 @@ void ImGuiUpdate::ApplicationInfoGUI()
             ImGui::TreePop();
         }
     }
+
+    // JobSystem
+    {
+        int flags;
+
+        flags =
+            ImGuiTreeNodeFlags_OpenOnDoubleClick |
+            ImGuiTreeNodeFlags_OpenOnArrow;
+
+        if (ImGui::TreeNodeEx(&flags, flags, "JobSystem"))
+        {
+            JobSystemGUI();
+            ImGui::TreePop();
+        }
+    }
+
+    // FrameAllocator
+    {
+        int flags;
+
+        flags =
+            ImGuiTreeNodeFlags_OpenOnDoubleClick |
+            ImGuiTreeNodeFlags_OpenOnArrow;
+
+        if (ImGui::TreeNodeEx(&flags, flags, "FrameAllocator"))
+        {
+            FrameAllocatorGUI();
+            ImGui::TreePop();
+        }
+    }
 }
 
 void ImGuiUpdate::FPSControllerGUI()
@@ -128,6 +161,102 @@ void ImGuiUpdate::FPSControllerGUI()
 
     ImGui::Text(U8_TEXT("現在のFPS : %d"), fpsController->GetCurrentFPS());
     ImGui::Text(U8_TEXT("デルタタイム : %f"), SceneManager::Instance().FrameDeltaTime());
+
+    // GPU に送っておけるフレーム
+    const FrameContextRing& frameRing = GraphicsDevice::Instance().GetFrameRing();
+    ImGui::Text(U8_TEXT("同時に送るフレーム数 : %u"), frameRing.GetFrameNum());
+    ImGui::Text(U8_TEXT("GPU を待った回数 : %llu"), frameRing.GetWaitNum());
+
+    // アップロード用のページ
+    const FrameUploadAllocator* pUploadAllocator = GraphicsDevice::Instance().GetUploadAllocator();
+    ImGui::Text(U8_TEXT("前フレームのアップロード量 : %llu KB"), pUploadAllocator->GetLastFrameUsedSize() / 1024);
+    ImGui::Text(U8_TEXT("アップロード用のページ数 : %zu (返却待ち %zu / 空き %zu)"),
+        pUploadAllocator->GetPageNum(), pUploadAllocator->GetRetiredPageNum(), pUploadAllocator->GetFreePageNum());
+    ImGui::Text(U8_TEXT("ページを作成した総数 : %llu"), pUploadAllocator->GetCreatePageNum());
+
+    // 定数バッファ : 使い回しを切り替えて、コピーするサイズを比べられるようにする
+    CBufferAllocater* pCBufferAllocater = GraphicsDevice::Instance().GetCBufferAllocater();
+    bool isDedupEnable = pCBufferAllocater->IsDedupEnable();
+    if (ImGui::Checkbox(U8_TEXT("同じ内容の定数バッファを使い回す"), &isDedupEnable))
+    {
+        pCBufferAllocater->SetDedupEnable(isDedupEnable);
+    }
+
+    const CBufferAllocater::FrameStats& cbStats = pCBufferAllocater->GetLastFrameStats();
+    ImGui::Text(U8_TEXT("定数バッファのバインド数 : %llu (使い回し %llu)"), cbStats.BindNum, cbStats.DedupNum);
+    ImGui::Text(U8_TEXT("定数バッファのコピー量 : %llu KB"), cbStats.UploadSize / 1024);
+    ImGui::Text(U8_TEXT("作成したビューの数 : %llu"), cbStats.ViewNum);
+
+    // 描画キュー
+    const RenderQueue& renderQueue = Renderer::Instance().GetRenderQueue();
+    ImGui::Text(U8_TEXT("モデルの描画要求の数 : %zu (インスタンス描画 %zu 回)"),
+        renderQueue.GetLastPacketNum(), renderQueue.GetLastBatchNum());
+    ImGui::Text(U8_TEXT("基数ソートで並べ替えた桁の数 : %u"), renderQueue.GetLastSortPassNum());
+    ImGui::Text(U8_TEXT("描画した三角形の数 : %llu"), renderQueue.GetLastTriangleNum());
+
+    // LOD ごとのインスタンスの数 : 影とGBuffer の合計
+    const std::array<size_t, ModelLOD::MaxLODNum>& lodInstanceNums = renderQueue.GetLastLODInstanceNums();
+    for (UINT lod = 0; lod < ModelLOD::MaxLODNum; ++lod)
+    {
+        ImGui::Text(U8_TEXT("LOD %u のインスタンスの数 : %zu"), lod, lodInstanceNums[lod]);
+    }
+
+    // 読み込んだメッシュの頂点 : 並べ替えと量子化の前後
+    MeshOptimizer::Stats meshBefore;
+    MeshOptimizer::Stats meshAfter;
+    MeshOptimizer::GetTotalStats(meshBefore, meshAfter);
+    ImGui::Text(U8_TEXT("メッシュの頂点の平均サイズ : %.1f -> %.1f byte"),
+        meshBefore.GetBytesPerVertex(), meshAfter.GetBytesPerVertex());
+    ImGui::Text(U8_TEXT("メッシュの ACMR : %.3f -> %.3f"), meshBefore.GetACMR(), meshAfter.GetACMR());
+
+    // GBuffer のクラスターカリング
+    const MeshCluster::Stats& clusterStats = ShaderManager::Instance().GetGBufferPass()->GetLastClusterStats();
+    ImGui::Text(U8_TEXT("クラスターカリング : %llu / %llu 個が見えている (描画 %llu 回)"),
+        clusterStats.VisibleClusterNum, clusterStats.ClusterNum, clusterStats.RangeNum);
+    ImGui::Text(U8_TEXT("クラスターカリングの三角形 : %llu / %llu"), clusterStats.VisibleFaceNum, clusterStats.FaceNum);
+
+    // スキンメッシュのボーン行列
+    const SkinningPalette& skinningPalette = Renderer::Instance().GetSkinningPalette();
+    ImGui::Text(U8_TEXT("ボーン行列を計算したモデルの数 : %zu (ボーン行列 %u 個)"),
+        skinningPalette.GetLastModelNum(), skinningPalette.GetLastBoneNum());
+
+    // 視錐台カリング
+    const CullingSystem& cullingSystem = CullingSystem::Instance();
+    ImGui::Text(U8_TEXT("視錐台カリング : %u / %u 個が見えている (%s)"),
+        cullingSystem.GetLastVisibleNum(), cullingSystem.GetBoxNum(),
+        FrustumCulling::IsAVX2Enable() ? "AVX2" : "SSE");
+    ImGui::Text(U8_TEXT("空間分割の木 : 高さ %d / 判定した節 %u 個 / まとめて判定した葉 %u 個 / 木の変更 %u 回"),
+        cullingSystem.GetTree().GetHeight(), cullingSystem.GetLastVisitNodeNum(), cullingSystem.GetLastLeafTestNum(),
+        cullingSystem.GetLastTreeUpdateNum());
+
+    // 遮蔽カリング
+    bool isOcclusionEnable = cullingSystem.IsOcclusionEnable();
+    if (ImGui::Checkbox(U8_TEXT("遮蔽カリング"), &isOcclusionEnable))
+    {
+        CullingSystem::Instance().SetOcclusionEnable(isOcclusionEnable);
+    }
+    const UINT32 occlusionTestNum = cullingSystem.GetLastOcclusionTestNum();
+    ImGui::Text(U8_TEXT("遮蔽カリング : %u / %u 個が隠れている (%.1f%%)"),
+        cullingSystem.GetLastOccludedNum(), occlusionTestNum,
+        occlusionTestNum > 0 ? 100.0f * static_cast<float>(cullingSystem.GetLastOccludedNum()) / static_cast<float>(occlusionTestNum) : 0.0f);
+    ImGui::Text(U8_TEXT("遮蔽物 : %u 個 / 三角形 %u (深度バッファ %ux%u)"),
+        cullingSystem.GetLastOccluderNum(), cullingSystem.GetLastOccluderTriangleNum(),
+        OcclusionCulling::Width, OcclusionCulling::Height);
+    ImGui::Text(U8_TEXT("影の描画要求 : カリング前 %u / カスケードごとの描画の合計 %u"),
+        cullingSystem.GetLastShadowRequestNum(), cullingSystem.GetLastShadowDrawNum());
+
+    // カスケードシャドウマップ
+    const ShadowCacheTracker& staticCache = ShaderManager::Instance().GetShadowShader()->GetStaticCache();
+    ImGui::Text(U8_TEXT("影のキャッシュ : 動かないモデル %u 個 / 描き直し %u 回 (最後 0x%X)"),
+        cullingSystem.GetStaticCasterNum(), staticCache.GetRedrawNum(), staticCache.GetLastRedrawMask());
+
+    const std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum>& cascades =
+        ShaderManager::Instance().WorkShadowShader()->GetCascades();
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        ImGui::Text(U8_TEXT("カスケード %u : 距離 %.1f - %.1f / 半径 %.2f"), cascadeIdx,
+            cascades[cascadeIdx].SplitNear, cascades[cascadeIdx].SplitFar, cascades[cascadeIdx].SphereRadius);
+    }
 }
 
 void ImGuiUpdate::WindowGUI()
@@ -147,6 +276,30 @@ void ImGuiUpdate::WindowGUI()
     ImGui::Text("MouseWheelVal %d", mouseInfo.MouseWheelVal);
 }
 
+void ImGuiUpdate::JobSystemGUI()
+{
+    const JobSystem& jobSystem = JobSystem::Instance();
+
+    ImGui::Text(U8_TEXT("スレッド数 : %d"), jobSystem.GetThreadNum());
+    ImGui::Text(U8_TEXT("実行したジョブの総数 : %llu"), jobSystem.GetExecutedJobNum());
+    ImGui::Text(U8_TEXT("盗んで実行したジョブの総数 : %llu"), jobSystem.GetStolenJobNum());
+}
+
+void ImGuiUpdate::FrameAllocatorGUI()
+{
+    const FrameAllocator& frameAllocator = FrameAllocator::Instance();
+
+    ImGui::Text(U8_TEXT("確保しているページの総サイズ : %llu KB"),
+        static_cast<UINT64>(frameAllocator.GetReservedSize() / 1024));
+    ImGui::Text(U8_TEXT("前フレームの使用量 : %llu KB"),
+        static_cast<UINT64>(frameAllocator.GetLastFrameUsedSize() / 1024));
+    ImGui::Text(U8_TEXT("前フレームの確保回数 : %llu"), frameAllocator.GetLastFrameAllocateNum());
+
+    // 使用量が落ち着いていれば 0 のままになる
+    ImGui::Text(U8_TEXT("前フレームのヒープ確保回数 : %llu"), frameAllocator.GetLastFrameHeapAllocateNum());
+    ImGui::Text(U8_TEXT("ヒープ確保回数の総数 : %llu"), frameAllocator.GetTotalHeapAllocateNum());
+}
+
 void ImGuiUpdate::AmbientControllerGUI()
 {
 
@@ -208,6 +361,14 @@ void ImGuiUpdate::AmbientControllerGUI()
     const auto& lightData = ShaderManager::Instance().GetAmbientManager()->GetLightCBData();
     ImGui::Text(U8_TEXT("現在有効なポイントライトの数: %d"), lightData.FramePointLightNum);
 
+    // クラスターへの振り分け : 定数バッファに入らないライトも含む
+    const LightCluster::Stats& clusterStats = ShaderManager::Instance().GetAmbientManager()->GetLastLightClusterStats();
+    ImGui::Text(U8_TEXT("クラスターのライト: %u (見えている %u)"), clusterStats.LightNum, clusterStats.VisibleLightNum);
+    ImGui::Text(U8_TEXT("ライトの番号: %u / 使ったクラスター: %u / %u"),
+        clusterStats.IndexNum, clusterStats.UsedClusterNum, LightCluster::ClusterNum);
+    ImGui::Text(U8_TEXT("1クラスターの最大: %u / 上限: %u / 溢れた数: %u"),
+        clusterStats.MaxLightPerCluster, LightCluster::MaxClusterLightNum, clusterStats.OverflowNum);
+
     ImGui::Separator();
 
     //-----------------------
@@ -359,6 +520,35 @@ void ImGuiUpdate::CurrentSceneGUI()
 
     //x------ オブジェクトのImGuiを更新 ------x//
     ImGui::Text(U8_TEXT("オブジェクトの数 : %d"), spNowScene->GetObjectList().size());
+    ImGui::Text(U8_TEXT("前のフレームで破棄したオブジェクトの数 : %d"), spNowScene->GetLastDestroyedObjectNum());
+
+    // 行列の計算が行われたノード数 : 動いていないノードは計算されない
+    const TransformHierarchy& transformHierarchy = spNowScene->GetTransformHierarchy();
+    ImGui::Text(U8_TEXT("Transform : ノード数 %d / 行列を計算した数 %d"),
+        static_cast<int>(transformHierarchy.GetNodeNum()), transformHierarchy.GetUpdatedNodeNum());
+
+    // プール : 使用中のサイズと確保済みのサイズの差が空きブロックの分
+    const utl::PoolArena& poolArena = spNowScene->GetPoolArena();
+    ImGui::Text(U8_TEXT("プール : 使用中 %llu KB / 確保済み %llu KB / チャンク数 %llu"),
+        static_cast<UINT64>(poolArena.GetUsedSize() / 1024),
+        static_cast<UINT64>(poolArena.GetReservedSize() / 1024),
+        static_cast<UINT64>(poolArena.GetChunkNum()));
+
+    // フェーズごとに更新するコンポーネント数 : オーバーライドしていないフェーズは数えない
+    ImGui::Text(U8_TEXT("更新するコンポーネント : PreUpdate %d / Update %d / WorldTransform %d / PostUpdate %d"),
+        spNowScene->GetTickComponentNum(ComponentTick::ePreUpdate),
+        spNowScene->GetTickComponentNum(ComponentTick::eUpdate),
+        spNowScene->GetTickComponentNum(ComponentTick::eUpdateWorldTransform),
+        spNowScene->GetTickComponentNum(ComponentTick::ePostUpdate));
+
+    // 並列更新 : 並列に更新できるコンポーネントを型ごとにまとめて JobSystem で更新する
+    bool isParallelUpdate = spNowScene->IsParallelUpdate();
+    if (ImGui::Checkbox(U8_TEXT("コンポーネントの並列更新"), &isParallelUpdate))
+    {
+        spNowScene->SetParallelUpdate(isParallelUpdate);
+    }
+    ImGui::Text(U8_TEXT("並列更新 : コンポーネント数 %d / 段数 %d"),
+        spNowScene->GetParallelComponentNum(), spNowScene->GetParallelLevelNum());
 
     // 現在のシーンにオブジェクトを追加する処理
     spNowScene->AddObjectImGui();
@@ -370,12 +560,16 @@ void ImGuiUpdate::CurrentSceneGUI()
 
     bool bTreeOpen;
 
-    for (auto&& obj : spNowScene->GetObjectList())
+    // オブジェクトのImGuiからオブジェクトが追加されることがあるため、添え字で走査する
+    const auto& objectList = spNowScene->GetObjectList();
+    for (size_t i = 0; i < objectList.size(); ++i)
     {
+        const std::shared_ptr<GameObject> obj = objectList[i];
+
         // 親オブジェクトのみ表示
         if (obj->GetParent()) { continue; }
 
-        ImGui::PushID(&obj);
+        ImGui::PushID(obj.get());
 
         // オブジェクト全体の有効フラグ更新
         bool isActiveState = obj->GetState() == GameObject::State::eActive;
@@ -385,10 +579,12 @@ void ImGuiUpdate::CurrentSceneGUI()
             obj->SetState(GameObject::State::eActive);
 
             // 子どももポーズ状態にする
-            for (auto&& spChild : obj->GetChildren())
+            for (const GameObjectHandle& hChild : obj->GetChildren())
             {
-                if (spChild.expired()) { continue; }
-                spChild.lock()->SetState(GameObject::State::eActive);
+                if (const std::shared_ptr<GameObject> spChild = obj->ResolveObject(hChild))
+                {
+                    spChild->SetState(GameObject::State::eActive);
+                }
             }
         }
         else
@@ -396,17 +592,19 @@ void ImGuiUpdate::CurrentSceneGUI()
             obj->SetState(GameObject::State::ePaused);
 
             // 子どももポーズ状態にする
-            for (auto&& spChild : obj->GetChildren())
+            for (const GameObjectHandle& hChild : obj->GetChildren())
             {
-                if (spChild.expired()) { continue; }
-                spChild.lock()->SetState(GameObject::State::ePaused);
+                if (const std::shared_ptr<GameObject> spChild = obj->ResolveObject(hChild))
+                {
+                    spChild->SetState(GameObject::State::ePaused);
+                }
             }
         }
         ImGui::SameLine();
 
         // ツリーを開く //
         bTreeOpen =
-            ImGui::TreeNodeEx(&obj, flags, obj->GetName().data());
+            ImGui::TreeNodeEx(obj.get(), flags, obj->GetName().data());
 
         if (bTreeOpen)
         {
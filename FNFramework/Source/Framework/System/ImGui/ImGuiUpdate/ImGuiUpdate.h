@@ -47,6 +47,8 @@ private:
     void FPSControllerGUI();
     void WindowGUI();
     void AmbientControllerGUI();
+    void JobSystemGUI();
+    void FrameAllocatorGUI();
 
     /* @brief SceneManagerUI用UI @return UI情報 */
     void SceneManagerGUI();
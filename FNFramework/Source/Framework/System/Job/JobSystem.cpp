@@ -0,0 +1,314 @@
+﻿#include "JobSystem.h"
+
+thread_local UINT32 JobSystem::s_threadIndex = JobSystem::InvalidThreadIndex;
+
+void JobSystem::Init(UINT32 threadNum)
+{
+    if (!m_upWorkers.empty())
+    {
+        FNENG_ASSERT_LOG("JobSystemはすでに初期化されています", false);
+        return;
+    }
+
+    if (threadNum == 0)
+    {
+        threadNum = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_isStop = false;
+
+    m_upWorkers.reserve(threadNum);
+    for (UINT32 i = 0; i < threadNum; ++i)
+    {
+        auto upWorker = std::make_unique<Worker>();
+        upWorker->upJobPool = std::make_unique<Job[]>(JobPoolSize);
+
+        m_upWorkers.emplace_back(std::move(upWorker));
+    }
+
+    // 呼び出したスレッド(メインスレッド)を 0 番とする
+    s_threadIndex = 0;
+
+    m_threads.reserve(threadNum - 1);
+    for (UINT32 i = 1; i < threadNum; ++i)
+    {
+        m_threads.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+void JobSystem::Release()
+{
+    if (m_upWorkers.empty()) { return; }
+
+    // 残っているジョブを片付けてから終了する
+    while (ExecuteOneJob(0)) {}
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_isStop = true;
+    }
+    m_sleepCV.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        if (thread.joinable()) { thread.join(); }
+    }
+
+    m_threads.clear();
+    m_upWorkers.clear();
+}
+
+void JobSystem::Run(std::function<void()> func, JobCounter* pCounter, const JobCounter* pDependency)
+{
+    if (pCounter) { pCounter->Add(1); }
+
+    const UINT32 threadIndex = s_threadIndex;
+
+    // キューを持たないスレッドからはその場で実行する
+    if (threadIndex == InvalidThreadIndex || m_upWorkers.empty())
+    {
+        if (pDependency) { while (!pDependency->IsDone()) { std::this_thread::yield(); } }
+
+        func();
+        if (pCounter) { NotifyDone(threadIndex, *pCounter); }
+        return;
+    }
+
+    Worker& worker = *m_upWorkers[threadIndex];
+
+    // プールから確保 : 同じ場所のジョブが実行中の場合はその場で実行する
+    Job& job = worker.upJobPool[worker.JobPoolIndex++ & (JobPoolSize - 1)];
+
+    if (job.IsUsed.load(std::memory_order_acquire))
+    {
+        if (pDependency) { Wait(*pDependency); }
+
+        func();
+        if (pCounter) { NotifyDone(threadIndex, *pCounter); }
+        return;
+    }
+
+    job.Func = std::move(func);
+    job.pCounter = pCounter;
+    job.pDependency = pDependency;
+    job.pNextWaiting = nullptr;
+    job.IsUsed.store(true, std::memory_order_relaxed);
+
+    // 依存先が終わっていなければ、依存先が 0 になった時に積まれる
+    if (pDependency && ParkJob(&job)) { return; }
+
+    PushJob(threadIndex, &job);
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    const UINT32 threadIndex = s_threadIndex;
+
+    while (!counter.IsDone())
+    {
+        // 待っている間にほかのジョブを進める
+        if (threadIndex != InvalidThreadIndex && ExecuteOneJob(threadIndex)) { continue; }
+
+        std::this_thread::yield();
+    }
+}
+
+UINT64 JobSystem::GetExecutedJobNum() const
+{
+    UINT64 num = 0;
+    for (const auto& upWorker : m_upWorkers)
+    {
+        num += upWorker->ExecutedJobNum.load(std::memory_order_relaxed);
+    }
+    return num;
+}
+
+UINT64 JobSystem::GetStolenJobNum() const
+{
+    UINT64 num = 0;
+    for (const auto& upWorker : m_upWorkers)
+    {
+        num += upWorker->StolenJobNum.load(std::memory_order_relaxed);
+    }
+    return num;
+}
+
+void JobSystem::WorkerMain(UINT32 threadIndex)
+{
+    s_threadIndex = threadIndex;
+
+    SetThreadDescription(GetCurrentThread(), (L"JobWorker" + std::to_wstring(threadIndex)).c_str());
+
+    // 待機に入る前に空回りする回数 : すぐに次のジョブが積まれる場合に寝起きのコストを避ける
+    constexpr int SpinCount = 64;
+
+    int spin = 0;
+
+    while (!m_isStop.load(std::memory_order_acquire))
+    {
+        if (ExecuteOneJob(threadIndex))
+        {
+            spin = 0;
+            continue;
+        }
+
+        if (++spin < SpinCount)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        spin = 0;
+
+        // 積まれているジョブがなければ待機する
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+
+        m_sleepingWorkerNum.fetch_add(1);
+        m_sleepCV.wait(lock, [this]()
+            {
+                return m_pendingJobNum.load() > 0 || m_isStop.load();
+            });
+        m_sleepingWorkerNum.fetch_sub(1);
+    }
+}
+
+bool JobSystem::ExecuteOneJob(UINT32 threadIndex)
+{
+    Job* pJob = TakeJob(threadIndex);
+
+    if (!pJob) { return false; }
+
+    // キューには依存先が終わったジョブしか積まれていないので、そのまま実行できる
+    ExecuteJob(threadIndex, pJob);
+
+    return true;
+}
+
+Job* JobSystem::TakeJob(UINT32 threadIndex)
+{
+    Worker& worker = *m_upWorkers[threadIndex];
+
+    Job* pJob = worker.Queue.Pop();
+
+    // 自分のキューが空なら、隣のスレッドから順に盗む
+    if (!pJob)
+    {
+        const UINT32 threadNum = GetThreadNum();
+
+        for (UINT32 i = 1; i < threadNum && !pJob; ++i)
+        {
+            pJob = m_upWorkers[(threadIndex + i) % threadNum]->Queue.Steal();
+        }
+
+        if (pJob) { worker.StolenJobNum.fetch_add(1, std::memory_order_relaxed); }
+    }
+
+    if (pJob) { m_pendingJobNum.fetch_sub(1); }
+
+    return pJob;
+}
+
+void JobSystem::PushJob(UINT32 threadIndex, Job* pJob)
+{
+    if (!m_upWorkers[threadIndex]->Queue.Push(pJob))
+    {
+        // キューが満杯の場合はその場で実行する : 積まれるのは依存先が終わったジョブのみ
+        ExecuteJob(threadIndex, pJob);
+        return;
+    }
+
+    m_pendingJobNum.fetch_add(1);
+
+    WakeWorker();
+}
+
+void JobSystem::ExecuteJob(UINT32 threadIndex, Job* pJob)
+{
+    pJob->Func();
+
+    // キャプチャしたものを解放してから返却する
+    pJob->Func = nullptr;
+
+    JobCounter* pCounter = pJob->pCounter;
+
+    pJob->IsUsed.store(false, std::memory_order_release);
+
+    if (pCounter) { NotifyDone(threadIndex, *pCounter); }
+
+    if (threadIndex != InvalidThreadIndex)
+    {
+        m_upWorkers[threadIndex]->ExecutedJobNum.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool JobSystem::ParkJob(Job* pJob)
+{
+    const JobCounter& dependency = *pJob->pDependency;
+
+    // 0 にする処理と同じロックの中で確認するので、確認後に 0 になっても取りこぼさない
+    std::lock_guard<std::mutex> lock(dependency.m_waitMutex);
+
+    if (dependency.IsDone()) { return false; }
+
+    pJob->pNextWaiting = dependency.m_pWaitingJobs;
+    dependency.m_pWaitingJobs = pJob;
+
+    return true;
+}
+
+void JobSystem::NotifyDone(UINT32 threadIndex, JobCounter& counter)
+{
+    // 最後の1つ以外は減らすだけ : 待っているジョブは 0 になった時にしか積まない
+    UINT32 count = counter.m_count.load(std::memory_order_relaxed);
+    while (count > 1)
+    {
+        if (counter.m_count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+
+    // 0 にする処理と待っているジョブの取り出しを同じロックの中で行う
+    // 待っている側が 0 を見てすぐにカウンタを破棄しても、デストラクタがこのロックを待つ
+    Job* pWaitingJob = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(counter.m_waitMutex);
+
+        if (counter.m_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            pWaitingJob = counter.m_pWaitingJobs;
+            counter.m_pWaitingJobs = nullptr;
+        }
+    }
+
+    // ここからはカウンタに触れない : 依存先が終わったジョブを積む
+    while (pWaitingJob)
+    {
+        Job* pNextJob = pWaitingJob->pNextWaiting;
+        pWaitingJob->pNextWaiting = nullptr;
+
+        // キューを持たないスレッドはその場で実行する
+        if (threadIndex == InvalidThreadIndex)
+        {
+            ExecuteJob(threadIndex, pWaitingJob);
+        }
+        else
+        {
+            PushJob(threadIndex, pWaitingJob);
+        }
+
+        pWaitingJob = pNextJob;
+    }
+}
+
+void JobSystem::WakeWorker()
+{
+    // 待機中のワーカーがいなければ何もしない
+    // m_pendingJobNum の加算後に読むので、待機に入ろうとしているワーカーとすれ違うことはない
+    if (m_sleepingWorkerNum.load() == 0) { return; }
+
+    // 待機に入る途中のワーカーが条件を確認し終わるまで待ってから通知する
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_sleepCV.notify_one();
+}
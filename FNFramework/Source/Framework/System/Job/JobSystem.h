@@ -0,0 +1,233 @@
+﻿#pragma once
+
+#include "WorkStealingDeque.h"
+
+struct Job;
+
+/**
+* @class JobCounter
+* @brief ジョブの完了待ち / 依存関係に使うカウンタ
+* @details
+*   - ジョブを積む時に加算され、ジョブが終わると減算される
+*   - 0 になったら、このカウンタに紐づいたジョブはすべて完了している
+*   - このカウンタに依存するジョブは、0 になるまでキューに積まずにここで待たせる
+*/
+class JobCounter
+{
+    // 完了の通知と、完了待ちのジョブの登録は JobSystem が行う
+    friend class JobSystem;
+
+public:
+    JobCounter() = default;
+
+    // 完了を通知しているスレッドが待機中のジョブを取り出し終わるまで待ってから破棄する
+    ~JobCounter()
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+    }
+
+    void Add(UINT32 num) { m_count.fetch_add(num, std::memory_order_relaxed); }
+
+    /* @brief 紐づいたジョブがすべて完了したか */
+    bool IsDone() const { return m_count.load(std::memory_order_acquire) == 0; }
+
+private:
+    std::atomic<UINT32> m_count = 0;
+
+    // このカウンタが 0 になるのを待っているジョブ : 0 にする処理と登録は m_waitMutex の中で行う
+    mutable std::mutex m_waitMutex;
+    mutable Job* m_pWaitingJobs = nullptr;
+};
+
+/* @brief JobSystem に積まれた1つのジョブ : 作成したスレッドのプールから確保される */
+struct Job
+{
+    std::function<void()> Func;
+    JobCounter* pCounter = nullptr;
+    const JobCounter* pDependency = nullptr;
+
+    // 依存先のカウンタで待っている間の、次のジョブ
+    Job* pNextWaiting = nullptr;
+
+    // 使用中か : プールの同じ場所が再利用される前に、実行が終わっていることを確認する
+    std::atomic<bool> IsUsed = false;
+};
+
+/**
+* @class JobSystem
+* @brief ワークスティーリング方式のジョブシステム
+* @details
+*   - ハードウェアのスレッド数に合わせてワーカースレッドを起動する : メインスレッドも 0 番のワーカーとして扱う
+*   - ワーカーごとに Chase-Lev 方式のキューを持ち、自分のキューが空になったらほかのワーカーから盗む
+*   - ジョブの完了は JobCounter で待つ : 待っている間もジョブを実行するので、待ちでスレッドが遊ばない
+*   - 依存先が終わっていないジョブは依存先の JobCounter で待たせ、0 になった時に積む
+*     キューには実行できるジョブだけが並ぶので、取り出しと積み直しの空回りが起こらない
+*   - ジョブを積めるのはメインスレッドとワーカースレッドのみ : それ以外のスレッドから積んだ場合はその場で実行する
+*/
+class JobSystem
+    : public utl::Singleton<JobSystem>
+{
+    friend class utl::Singleton<JobSystem>;
+
+public:
+    // 1スレッドのキューに積めるジョブの数
+    static constexpr size_t QueueCapacity = 4096;
+
+    // スレッド番号 : メインスレッド / ワーカースレッド以外の場合
+    static constexpr UINT32 InvalidThreadIndex = UINT32_MAX;
+
+    //--------------------------------
+    // 初期化 / 解放
+    //--------------------------------
+    /**
+    * @brief 初期化 : ワーカースレッドを起動する
+    * @param[in] threadNum - メインスレッドを含めたスレッド数 : 0 の場合はハードウェアのスレッド数
+    */
+    void Init(UINT32 threadNum = 0);
+
+    /* @brief 解放 : ワーカースレッドを終了する */
+    void Release();
+
+    //--------------------------------
+    // ジョブの実行
+    //--------------------------------
+    /**
+    * @brief ジョブを積む
+    * @param[in] func        - 実行する処理
+    * @param[in] pCounter    - 完了を通知するカウンタ : 不要な場合は nullptr
+    * @param[in] pDependency - 先に完了している必要があるカウンタ : 不要な場合は nullptr
+    */
+    void Run(std::function<void()> func, JobCounter* pCounter = nullptr, const JobCounter* pDependency = nullptr);
+
+    /* @brief カウンタが 0 になるまで、ほかのジョブを実行しながら待つ */
+    void Wait(const JobCounter& counter);
+
+    /**
+    * @brief [0, count) を分割して並列に処理する
+    * @param[in] count     - 処理する要素数
+    * @param[in] grainSize - 1つのジョブで処理する要素数 : 0 の場合はスレッド数から自動で決める
+    * @param[in] func      - 処理 : void(UINT32 begin, UINT32 end) で [begin, end) を処理する
+    * @details 呼び出したスレッドも最初の範囲を処理し、すべての範囲が終わるまで戻らない
+    */
+    template <typename Func>
+    void ParallelFor(UINT32 count, UINT32 grainSize, Func&& func)
+    {
+        if (count == 0) { return; }
+
+        // 各スレッドに数回ずつ行き渡る程度に分割する
+        if (grainSize == 0)
+        {
+            grainSize = std::max(1u, count / (GetThreadNum() * 4));
+        }
+
+        // 分割しても意味がない場合はその場で処理する
+        if (count <= grainSize || GetThreadNum() <= 1 || GetThreadIndex() == InvalidThreadIndex)
+        {
+            func(0u, count);
+            return;
+        }
+
+        JobCounter counter;
+
+        for (UINT32 begin = grainSize; begin < count; begin += grainSize)
+        {
+            const UINT32 end = std::min(begin + grainSize, count);
+            Run([&func, begin, end]() { func(begin, end); }, &counter);
+        }
+
+        // 最初の範囲は自分で処理する
+        func(0u, grainSize);
+
+        Wait(counter);
+    }
+
+    //--------------------------------
+    // ゲッター
+    //--------------------------------
+    /* @brief メインスレッドを含めたスレッド数 : スレッドごとのバッファの確保に使う */
+    UINT32 GetThreadNum() const { return static_cast<UINT32>(m_upWorkers.size()); }
+
+    /* @brief 呼び出したスレッドの番号 : メインスレッドは 0 / それ以外のスレッドは InvalidThreadIndex */
+    static UINT32 GetThreadIndex() { return s_threadIndex; }
+
+    /* @brief 呼び出したスレッドがメインスレッド以外のワーカースレッドか : スレッドごとのバッファへ書き込むかの判定に使う */
+    static bool IsWorkerThread() { return s_threadIndex != 0 && s_threadIndex != InvalidThreadIndex; }
+
+    /* @brief 実行したジョブの総数 */
+    UINT64 GetExecutedJobNum() const;
+
+    /* @brief ほかのスレッドから盗んで実行したジョブの総数 */
+    UINT64 GetStolenJobNum() const;
+
+private:
+    JobSystem()
+    {
+    }
+
+    ~JobSystem() override
+    {
+        Release();
+    }
+
+    // ジョブを作成したスレッドのプールから確保する : 実行が終わったら IsUsed を下げて返却する
+    static constexpr size_t JobPoolSize = QueueCapacity * 2;
+
+    /* @brief スレッドごとのデータ : ほかのスレッドと同じキャッシュラインに乗らないようにする */
+    struct alignas(64) Worker
+    {
+        utl::WorkStealingDeque<Job*, QueueCapacity> Queue;
+
+        std::unique_ptr<Job[]> upJobPool;
+        size_t JobPoolIndex = 0;
+
+        std::atomic<UINT64> ExecutedJobNum = 0;
+        std::atomic<UINT64> StolenJobNum = 0;
+    };
+
+    /* @brief ワーカースレッドのメイン処理 */
+    void WorkerMain(UINT32 threadIndex);
+
+    /* @brief ジョブを1つ取り出して実行する @return 実行できたら true */
+    bool ExecuteOneJob(UINT32 threadIndex);
+
+    /* @brief 自分のキューから取り出し、空ならほかのスレッドから盗む */
+    Job* TakeJob(UINT32 threadIndex);
+
+    /* @brief 自分のキューに積む : 積めなかった場合はその場で実行する */
+    void PushJob(UINT32 threadIndex, Job* pJob);
+
+    /* @brief ジョブを実行して、カウンタへの通知とプールへの返却を行う */
+    void ExecuteJob(UINT32 threadIndex, Job* pJob);
+
+    /**
+    * @brief 依存先が終わっていなければ、依存先のカウンタで待たせる
+    * @return 待たせた場合は true : false の場合はそのまま積んでよい
+    */
+    bool ParkJob(Job* pJob);
+
+    /**
+    * @brief カウンタにジョブの完了を通知する
+    * @details 0 になった場合は、このカウンタで待っていたジョブを呼び出したスレッドのキューに積む
+    */
+    void NotifyDone(UINT32 threadIndex, JobCounter& counter);
+
+    /* @brief 待機中のワーカーを起こす */
+    void WakeWorker();
+
+    std::vector<std::unique_ptr<Worker>> m_upWorkers;
+    std::vector<std::thread> m_threads;
+
+    //x--- 待機関連 ---x//
+    // キューに積まれていて、まだ取り出されていないジョブの数
+    std::atomic<INT32> m_pendingJobNum = 0;
+    // 待機中のワーカー数 : 誰も待機していなければ起こす処理を省略する
+    std::atomic<INT32> m_sleepingWorkerNum = 0;
+
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCV;
+
+    std::atomic<bool> m_isStop = false;
+
+    // 呼び出したスレッドの番号
+    static thread_local UINT32 s_threadIndex;
+};
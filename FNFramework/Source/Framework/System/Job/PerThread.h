@@ -0,0 +1,83 @@
+﻿#pragma once
+
+namespace utl
+{
+    /**
+    * @class PerThread
+    * @brief JobSystem のスレッドごとに1つずつ値を持つコンテナ
+    * @details
+    *   - 並列処理中にグローバルなリストへ書き込む代わりに、自分のスレッドの値へ書き込む
+    *   - 並列処理が終わった後にメインスレッドで ForEach を使ってまとめる
+    *   - 隣のスレッドの値と同じキャッシュラインに乗らないように、1つずつ 64byte 境界に配置する
+    *
+    * @tparam T - スレッドごとに持つ値の型
+    */
+    template <typename T>
+    class PerThread
+    {
+    public:
+        /**
+        * @brief JobSystem のスレッド数に合わせて確保する
+        * @details 並列処理を始める前にメインスレッドから呼ぶ : 確保済みの値は消えない
+        */
+        void Prepare()
+        {
+            const size_t threadNum = std::max<size_t>(1, JobSystem::Instance().GetThreadNum());
+
+            if (m_slots.size() < threadNum)
+            {
+                m_slots.resize(threadNum);
+            }
+        }
+
+        /* @brief 呼び出したスレッドの値を取得 */
+        T& Work()
+        {
+            size_t threadIndex = JobSystem::GetThreadIndex();
+
+            if (threadIndex >= m_slots.size())
+            {
+                FNENG_ASSERT_ERROR("PerThread::Prepare が呼ばれていないか、JobSystem 以外のスレッドから呼ばれました");
+                Prepare();
+                threadIndex = 0;
+            }
+
+            return m_slots[threadIndex].Value;
+        }
+
+        /* @brief 呼び出したスレッドの値を取得 : Prepare の時点で存在しなかったスレッドや JobSystem 以外のスレッドからは nullptr */
+        T* Find()
+        {
+            const size_t threadIndex = JobSystem::GetThreadIndex();
+
+            return threadIndex < m_slots.size() ? &m_slots[threadIndex].Value : nullptr;
+        }
+
+        /* @brief すべてのスレッドの値を走査する : 並列処理中に呼んではいけない */
+        template <typename Func>
+        void ForEach(Func&& func)
+        {
+            for (Slot& slot : m_slots)
+            {
+                func(slot.Value);
+            }
+        }
+
+        template <typename Func>
+        void ForEach(Func&& func) const
+        {
+            for (const Slot& slot : m_slots)
+            {
+                func(slot.Value);
+            }
+        }
+
+    private:
+        struct alignas(64) Slot
+        {
+            T Value{};
+        };
+
+        std::vector<Slot> m_slots;
+    };
+}
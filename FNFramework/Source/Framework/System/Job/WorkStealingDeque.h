@@ -0,0 +1,121 @@
+﻿#pragma once
+
+namespace utl
+{
+    /**
+    * @class WorkStealingDeque
+    * @brief Chase-Lev 方式のワークスティーリング用両端キュー
+    * @details
+    *   - 所有スレッドだけが Push / Pop を行い、末尾(bottom)側から LIFO で取り出す
+    *   - ほかのスレッドは Steal で先頭(top)側から FIFO で盗む
+    *   - 容量は固定 : 満杯の場合 Push は false を返すので、呼び出し側でその場で実行する
+    *
+    * @tparam T        - 格納する型 : ポインタなどのアトミックに読み書きできる型
+    * @tparam Capacity - 容量 : 2のべき乗
+    */
+    template <typename T, size_t Capacity>
+    class WorkStealingDeque
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity は2のべき乗である必要があります");
+
+    public:
+        /**
+        * @brief 末尾に追加 : 所有スレッドのみ
+        * @return 満杯で追加できなかった場合は false
+        */
+        bool Push(T value)
+        {
+            const INT64 bottom = m_bottom.load(std::memory_order_relaxed);
+            const INT64 top = m_top.load(std::memory_order_acquire);
+
+            if (bottom - top >= static_cast<INT64>(Capacity)) { return false; }
+
+            m_buffer[bottom & Mask].store(value, std::memory_order_relaxed);
+
+            // 要素の書き込みを、bottom の更新より先にほかのスレッドから見えるようにする
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+            return true;
+        }
+
+        /**
+        * @brief 末尾から取り出す : 所有スレッドのみ
+        * @return 空の場合は T{}
+        */
+        T Pop()
+        {
+            const INT64 bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+
+            // bottom の更新と top の読み込みの順番を保証する : Steal との競合判定に必要
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            INT64 top = m_top.load(std::memory_order_relaxed);
+
+            // 空だった
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return T{};
+            }
+
+            T value = m_buffer[bottom & Mask].load(std::memory_order_relaxed);
+
+            // 最後の1つは Steal と取り合いになるので、top を進められた方が取得する
+            if (top == bottom)
+            {
+                if (!m_top.compare_exchange_strong(top, top + 1,
+                    std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    value = T{};
+                }
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return value;
+        }
+
+        /**
+        * @brief 先頭から盗む : どのスレッドからでも呼び出せる
+        * @return 空の場合や、ほかのスレッドと取り合いになって負けた場合は T{}
+        */
+        T Steal()
+        {
+            INT64 top = m_top.load(std::memory_order_acquire);
+
+            // top の読み込みと bottom の読み込みの順番を保証する
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            const INT64 bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom) { return T{}; }
+
+            T value = m_buffer[top & Mask].load(std::memory_order_relaxed);
+
+            if (!m_top.compare_exchange_strong(top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return T{};
+            }
+
+            return value;
+        }
+
+        /* @brief おおよその要素数 : ほかのスレッドが操作中の場合は正確ではない */
+        size_t ApproxSize() const
+        {
+            const INT64 size = m_bottom.load(std::memory_order_relaxed) - m_top.load(std::memory_order_relaxed);
+            return size > 0 ? static_cast<size_t>(size) : 0;
+        }
+
+    private:
+        static constexpr INT64 Mask = static_cast<INT64>(Capacity) - 1;
+
+        // top は盗む側、bottom は所有スレッドが頻繁に書き換えるので、キャッシュラインを分けておく
+        alignas(64) std::atomic<INT64> m_top = 0;
+        alignas(64) std::atomic<INT64> m_bottom = 0;
+
+        std::array<std::atomic<T>, Capacity> m_buffer = {};
+    };
+}
@@ -35,12 +35,13 @@ namespace Collider
     * @param[in] negd  - 平面の負の距離
     * @paramin] norm   - 平面の法線
     * @param[out] out  - 交点の位置を相対的に示すパラメータと平面の法線データ
+    * @param[in,out] outNum - out に格納済みの数 : 交差していたら1つ増える
     * @return bool AABBの側面(無限平面)と交差しているかどうか - 当たっている : true / 当たっていない : false
     *
     * @details 平面は無限平面なので、AABBの側面(無効側)と交差している可能性があるのでテスト用のヘルパー関数
     */
     static bool TestSidePlane(float start, float end, float negd, const Math::Vector3& norm,
-                              std::vector<std::pair<float, Math::Vector3>>& out)
+                              std::array<std::pair<float, Math::Vector3>, 6>& out, UINT& outNum)
     {
         // 線分の長さを求める
         float lineSegmentLength = end - start;
@@ -54,7 +55,7 @@ namespace Collider
         // tが線分の範囲内にあるのかを判定する
         if (t >= 0.0f && t <= 1.0f)
         {
-            out.emplace_back(t, norm);
+            out[outNum++] = { t, norm };
             return true;
         }
 
@@ -78,21 +79,22 @@ namespace Collider
         // AABBデータ格納
         const AABB<Math::Vector3>::AABBData& boxData = box.GetAABBData();
 
-        // ヒットする可能性のあるtの値を格納する配列
-        std::vector<std::pair<float, Math::Vector3>> tValues;
+        // ヒットする可能性のあるtの値を格納する配列 : 側面は6つしかないので、ヒープを使わずに固定長で持つ
+        std::array<std::pair<float, Math::Vector3>, 6> tValues;
+        UINT tValueNum = 0;
 
         // X平面
-        TestSidePlane(lineData.Start.x, lineData.End.x, boxData.Min.x, -Math::Vector3::UnitX, tValues);
-        TestSidePlane(lineData.Start.x, lineData.End.x, boxData.Max.x, Math::Vector3::UnitX, tValues);
+        TestSidePlane(lineData.Start.x, lineData.End.x, boxData.Min.x, -Math::Vector3::UnitX, tValues, tValueNum);
+        TestSidePlane(lineData.Start.x, lineData.End.x, boxData.Max.x, Math::Vector3::UnitX, tValues, tValueNum);
         // Y平面
-        TestSidePlane(lineData.Start.y, lineData.End.y, boxData.Min.y, -Math::Vector3::UnitY, tValues);
-        TestSidePlane(lineData.Start.y, lineData.End.y, boxData.Max.y, Math::Vector3::UnitY, tValues);
+        TestSidePlane(lineData.Start.y, lineData.End.y, boxData.Min.y, -Math::Vector3::UnitY, tValues, tValueNum);
+        TestSidePlane(lineData.Start.y, lineData.End.y, boxData.Max.y, Math::Vector3::UnitY, tValues, tValueNum);
         // Z平面
-        TestSidePlane(lineData.Start.z, lineData.End.z, boxData.Min.z, -Math::Vector3::UnitZ, tValues);
-        TestSidePlane(lineData.Start.z, lineData.End.z, boxData.Max.z, Math::Vector3::UnitZ, tValues);
+        TestSidePlane(lineData.Start.z, lineData.End.z, boxData.Min.z, -Math::Vector3::UnitZ, tValues, tValueNum);
+        TestSidePlane(lineData.Start.z, lineData.End.z, boxData.Max.z, Math::Vector3::UnitZ, tValues, tValueNum);
 
         // tの値が小さいもの順にソート
-        std::sort(tValues.begin(), tValues.end(), [](
+        std::sort(tValues.begin(), tValues.begin() + tValueNum, [](
                   const std::pair<float, Math::Vector3>& a,
                   const std::pair<float, Math::Vector3>& b)
                   {
@@ -101,8 +103,10 @@ namespace Collider
 
         // boxに交点が含まれるのかのテスト
         Math::Vector3 point = {};
-        for (std::pair<float, Math::Vector3> t : tValues)
+        for (UINT i = 0; i < tValueNum; ++i)
         {
+            const std::pair<float, Math::Vector3>& t = tValues[i];
+
             point = line.PointOnSegment(t.first);
 
             if (box.Contains(point))
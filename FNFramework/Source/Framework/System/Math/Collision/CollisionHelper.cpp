@@ -9,7 +9,7 @@ void CollisionHelper::Init(
     const std::shared_ptr<TransformComponent>& trans,
     const std::shared_ptr<ModelComponent>& model)
 {
-    m_wpOwner = owner;
+    m_pOwner = owner.get();
     m_spTransformComp = trans;
     m_spModelComp = model;
 }
@@ -17,12 +17,14 @@ void CollisionHelper::Init(
 void CollisionHelper::AddColObj(const std::shared_ptr<GameObject>& obj)
 {
     // すでに登録されている場合は処理を抜ける
-    for(auto& wpTarget : m_wpColTargetList)
-    {
-        if (wpTarget.lock() == obj) { return; }
-    }
+    if (!obj) { return; }
+
+    const GameObjectHandle& hTarget = obj->GetHandle();
+
+    // すでに登録されている場合は処理を抜ける
+    if (std::find(m_colTargetList.begin(), m_colTargetList.end(), hTarget) != m_colTargetList.end()) { return; }
 
-    m_wpColTargetList.emplace_back(obj);
+    m_colTargetList.emplace_back(hTarget);
 }
 
 void CollisionHelper::Update()
@@ -102,20 +104,17 @@ void CollisionHelper::AddCollisionTargetForImGui()
     utl::ImGuiHelper::InputTextWithString(U8_TEXT("当たり判定対象の名前"), m_addColTargetName);
 
     // 自分自身をターゲットに追加しようとしている場合は処理を抜ける
-    if (m_addColTargetName == m_wpOwner.lock()->GetName()) { return; }
+    if (m_addColTargetName == m_pOwner->GetName()) { return; }
 
     if (!ImGui::Button(U8_TEXT("当たり判定対象追加"))) { return; }
 
     // シーンから当たり判定対象のオブジェクトを取得
-    const std::shared_ptr<GameObject>& spTarget = m_wpOwner.lock()->GetScene()->FindObject(m_addColTargetName);
+    const std::shared_ptr<GameObject>& spTarget = m_pOwner->GetScene()->FindObject(m_addColTargetName);
 
     if (!spTarget) { return; }
 
     // すでに登録されている場合は処理を抜ける
-    for (const auto& wpTarget : m_wpColTargetList)
-    {
-        if (wpTarget.lock() == spTarget) { return; }
-    }
+    if (std::find(m_colTargetList.begin(), m_colTargetList.end(), spTarget->GetHandle()) != m_colTargetList.end()) { return; }
 
     std::shared_ptr<CollisionComponent> spColComp = spTarget->GetComponent<CollisionComponent>();
 
@@ -131,11 +130,11 @@ void CollisionHelper::AddCollisionTargetForImGui()
 void CollisionHelper::ShowColTargetsForImGui()
 {
     // 当たり判定対象の名前を表示
-    for (const auto& wpTarget : m_wpColTargetList)
+    for (const GameObjectHandle& hTarget : m_colTargetList)
     {
-        if (wpTarget.expired()) { continue; }
+        const std::shared_ptr<GameObject> spTarget = m_pOwner->ResolveObject(hTarget);
 
-        const std::shared_ptr<GameObject>& spTarget = wpTarget.lock();
+        if (!spTarget) { continue; }
 
         ImGui::Text(spTarget->GetName().data());
     }
@@ -191,29 +190,23 @@ void CollisionHelper::ChangeRayColTypeForImGui()
 void CollisionHelper::DeleteInvalidObjects()
 {
     // 当たり判定オブジェクトが削除されている場合リストからも削除する
-    for (auto it = m_wpColTargetList.begin(); it != m_wpColTargetList.end();)
-    {
-        if (it->expired()) // weak_ptrが無効かチェック
+    std::erase_if(m_colTargetList, [this](const GameObjectHandle& hTarget)
         {
-            it = m_wpColTargetList.erase(it); // 無効ならリストから削除
-        }
-        else
-        {
-            ++it; // 次の要素へ
-        }
-    }
+            return !m_pOwner->GetScenePtr()->IsValidObject(hTarget);
+        });
 }
 
 void CollisionHelper::Serialize(Json& json) const
 {
     // コライダー対象オブジェクトの名前を保存
     Json colTargetNames = Json::array();
-    for (const auto& wpTarget : m_wpColTargetList)
+    for (const GameObjectHandle& hTarget : m_colTargetList)
     {
-        if(wpTarget.expired()) { continue; }
+        const std::shared_ptr<GameObject> spTarget = m_pOwner->ResolveObject(hTarget);
 
+        if (!spTarget) { continue; }
 
-        colTargetNames.push_back(wpTarget.lock()->GetName());
+        colTargetNames.push_back(spTarget->GetName());
     }
 
     using namespace jsonKey::Comp::ColliderHelper;
@@ -284,9 +277,7 @@ void CollisionHelper::Deserialize(const Json& json)
 
 void CollisionHelper::SphereCollision(const float colSize)
 {
-    const std::shared_ptr<GameObject>& Owner = m_wpOwner.lock();
-
-    if (!Owner)
+    if (!m_pOwner)
     {
         FNENG_ASSERT_LOG("Ownerが不正です", false);
         return;
@@ -309,32 +300,32 @@ void CollisionHelper::SphereCollision(const float colSize)
     // 当たり判定処理
     //-------------------------------
     //	球に当たったオブジェクト情報保存
-    std::list<KdCollider::CollisionResult> retSphereList;
+    KdCollider::CollisionResultList retSphereList;
 
-    for (const std::weak_ptr<GameObject>& wpTargetObj : m_wpColTargetList)
+    for (const GameObjectHandle& hTargetObj : m_colTargetList)
     {
-        if (wpTargetObj.expired())
+        const GameObject* pTarget = m_pOwner->ResolveObjectPtr(hTargetObj);
+
+        if (!pTarget)
         {
             FNENG_ASSERT_LOG("Targetが不正です", false)
             continue;
         }
 
-        const std::shared_ptr<GameObject>& spTarget = wpTargetObj.lock();
+        CollisionComponent* pTargetColComp = pTarget->GetComponentPtr<CollisionComponent>();
 
-        const std::shared_ptr<CollisionComponent>& spTargetColComp = spTarget->GetComponent<CollisionComponent>();
-
-        if (!spTargetColComp)
+        if (!pTargetColComp)
         {
             FNENG_ASSERT_LOG("CollisionComponentが設定されていません", false)
             continue;
         }
 
         // ターゲットのコライダーが有効な場合のみあたり判定を行う
-        if (const std::unique_ptr<KdCollider>& collider = spTargetColComp->GetCollider())
+        if (const std::unique_ptr<KdCollider>& collider = pTargetColComp->GetCollider())
         {
             collider->Intersects(
                 m_sphereColliderInfo,
-                spTarget->GetTransformComponent()->GetWorldMatrix(),
+                pTarget->GetTransformComponent()->GetWorldMatrix(),
                 &retSphereList);
         }
         else
@@ -364,9 +355,7 @@ void CollisionHelper::SphereCollision(const float colSize)
 
 void CollisionHelper::RayCollision(const float colSize)
 {
-    const std::shared_ptr<GameObject>& Owner = m_wpOwner.lock();
-
-    if (!Owner)
+    if (!m_pOwner)
     {
         FNENG_ASSERT_LOG("Ownerが不正です", false)
         return;
@@ -398,31 +387,31 @@ void CollisionHelper::RayCollision(const float colSize)
     // あたり判定処理
     //-----------------------
     //	レイに当たったオブジェクト情報
-    std::list<KdCollider::CollisionResult> retRayList;
-    for (const std::weak_ptr<GameObject>& wpTargetObj : m_wpColTargetList)
+    KdCollider::CollisionResultList retRayList;
+    for (const GameObjectHandle& hTargetObj : m_colTargetList)
     {
-        if (wpTargetObj.expired())
+        const GameObject* pTarget = m_pOwner->ResolveObjectPtr(hTargetObj);
+
+        if (!pTarget)
         {
             FNENG_ASSERT_LOG("Targetが不正です", false)
             continue;
         }
 
-        const std::shared_ptr<GameObject>& spTarget = wpTargetObj.lock();
-
-        const std::shared_ptr<CollisionComponent>& spTargetColComp = spTarget->GetComponent<CollisionComponent>();
+        CollisionComponent* pTargetColComp = pTarget->GetComponentPtr<CollisionComponent>();
 
-        if (!spTargetColComp)
+        if (!pTargetColComp)
         {
             FNENG_ASSERT_LOG("CollisionComponentが設定されていません", false)
             continue;
         }
 
         // ターゲットのコライダーが有効な場合のみあたり判定を行う
-        if (const std::unique_ptr<KdCollider>& collider = spTargetColComp->GetCollider())
+        if (const std::unique_ptr<KdCollider>& collider = pTargetColComp->GetCollider())
         {
             collider->Intersects(
                 m_rayColliderInfo,
-                spTarget->GetTransformComponent()->GetWorldMatrix(),
+                pTarget->GetTransformComponent()->GetWorldMatrix(),
                 &retRayList);
         }
         else
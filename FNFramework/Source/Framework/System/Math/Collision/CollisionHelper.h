@@ -1,5 +1,7 @@
 ﻿#pragma once
 
+#include "Application/Object/GameObjectHandle.h"
+
 class GameObject;
 class TransformComponent;
 class ModelComponent;
@@ -65,9 +67,9 @@ public:
     void AddColObj(const std::shared_ptr<GameObject>& obj);
 
     // ターゲットリストを取得
-    const std::list<std::weak_ptr<GameObject>>& GetColTargetList() const
+    const std::vector<GameObjectHandle>& GetColTargetList() const
     {
-        return m_wpColTargetList;
+        return m_colTargetList;
     }
 
     // ターゲット対象のオブジェクトの名前
@@ -125,14 +127,15 @@ private:
     void ChangeRayColTypeForImGui();
 
     // あたり判定データを作成するに当たって必要な情報 //
-    std::weak_ptr<GameObject> m_wpOwner;
+    // 所有者 : CollisionComponent を通して所有されているので生ポインタで保持する
+    GameObject* m_pOwner = nullptr;
 
     std::shared_ptr<TransformComponent> m_spTransformComp = nullptr;
     std::shared_ptr<ModelComponent>     m_spModelComp = nullptr;
 
     //x--- あたり判定関連 ---x//
     //	当たられる対象アドレス保存用 - 当たられる側のオブジェクトを追加する
-    std::list<std::weak_ptr<GameObject>> m_wpColTargetList;
+    std::vector<GameObjectHandle> m_colTargetList;
     std::string m_addColTargetName;
 
     //x--- あたり判定の結果 ---x//
@@ -6,23 +6,29 @@ void DebugWire::AddDebugLine(const Math::Vector3& start, const Math::Vector3& en
 
     if(!m_enable) { return; }
 
+	// ワーカースレッドから呼ばれた場合はスレッドごとの配列に追加する
+	std::vector<MeshVertex>& dstVertices = WorkVertices();
+
 	// 頂点データ作成
 	MeshVertex data;
 	data.Color = color.RGBA().v;
 
 	// 開始位置
 	data.Position = start;
-	m_vertices.push_back(data);
+	dstVertices.push_back(data);
 
 	// 終了位置
 	data.Position = end;
-	m_vertices.push_back(data);
+	dstVertices.push_back(data);
 }
 
 void DebugWire::AddDebugLine(const Math::Vector3& start, const Math::Vector3& dir, float length, const Math::Color& col)
 {
     if(!m_enable) { return; }
 
+	// ワーカースレッドから呼ばれた場合はスレッドごとの配列に追加する
+	std::vector<MeshVertex>& dstVertices = WorkVertices();
+
 	// デバッグラインの始点
 	MeshVertex v1;
 	v1.Color = col.RGBA().v;
@@ -35,57 +41,60 @@ void DebugWire::AddDebugLine(const Math::Vector3& start, const Math::Vector3& di
 	v2.UV = Math::Vector2::Zero;
 	v2.Position = v1.Position + (dir * length);
 
-	m_vertices.push_back(v1);
-	m_vertices.push_back(v2);
+	dstVertices.push_back(v1);
+	dstVertices.push_back(v2);
 }
 
 void DebugWire::AddDebugBox(const Math::Vector3& min, const Math::Vector3& max, const Math::Color& col)
 {
     if(!m_enable) { return; }
 
+	// ワーカースレッドから呼ばれた場合はスレッドごとの配列に追加する
+	std::vector<MeshVertex>& dstVertices = WorkVertices();
+
 	// 頂点データ作成
 	MeshVertex data;
 	data.Color = col.RGBA().v;
 	data.UV = Math::Vector2::Zero;
 
 	// 下面
-	data.Position = min; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ max.x, min.y, min.z }; m_vertices.push_back(data);
+	data.Position = min; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, min.y, min.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ max.x, min.y, min.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ max.x, min.y, max.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, min.y, min.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, min.y, max.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ max.x, min.y, max.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ min.x, min.y, max.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, min.y, max.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, min.y, max.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ min.x, min.y, max.z }; m_vertices.push_back(data);
-	data.Position = min; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, min.y, max.z }; dstVertices.push_back(data);
+	data.Position = min; dstVertices.push_back(data);
 
 	// 上面
-	data.Position = Math::Vector3{ min.x, max.y, min.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ max.x, max.y, min.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, max.y, min.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, max.y, min.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ max.x, max.y, min.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ max.x, max.y, max.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, max.y, min.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, max.y, max.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ max.x, max.y, max.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ min.x, max.y, max.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, max.y, max.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, max.y, max.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ min.x, max.y, max.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ min.x, max.y, min.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, max.y, max.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, max.y, min.z }; dstVertices.push_back(data);
 
 	// 側面
-	data.Position = min; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ min.x, max.y, min.z }; m_vertices.push_back(data);
+	data.Position = min; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, max.y, min.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ max.x, min.y, min.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ max.x, max.y, min.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, min.y, min.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, max.y, min.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ max.x, min.y, max.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ max.x, max.y, max.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, min.y, max.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ max.x, max.y, max.z }; dstVertices.push_back(data);
 
-	data.Position = Math::Vector3{ min.x, min.y, max.z }; m_vertices.push_back(data);
-	data.Position = Math::Vector3{ min.x, max.y, max.z }; m_vertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, min.y, max.z }; dstVertices.push_back(data);
+	data.Position = Math::Vector3{ min.x, max.y, max.z }; dstVertices.push_back(data);
 }
 
 void DebugWire::AddDebugBox(const OBB& obb, const Math::Color& col)
@@ -120,6 +129,9 @@ void DebugWire::AddDebugSphere(const Math::Vector3& centerPos, const Math::Color
 {
     if(!m_enable) { return; }
 
+	// ワーカースレッドから呼ばれた場合はスレッドごとの配列に追加する
+	std::vector<MeshVertex>& dstVertices = WorkVertices();
+
 	// 頂点データ作成
 	MeshVertex data;
 	data.UV = Math::Vector2::Zero;
@@ -132,58 +144,92 @@ void DebugWire::AddDebugSphere(const Math::Vector3& centerPos, const Math::Color
 		data.Position = centerPos;
 		data.Position.x += cos(MathHelper::ConvertToRadians(static_cast<float>(i) * (360.0f / splitCount))) * radius;
 		data.Position.z += sin(MathHelper::ConvertToRadians(static_cast<float>(i) * (360.0f / splitCount))) * radius;
-		m_vertices.push_back(data);
+		dstVertices.push_back(data);
 
 		data.Position = centerPos;
 		data.Position.x += cos(MathHelper::ConvertToRadians(static_cast<float>((i + 1)) * (360.0f / splitCount))) * radius;
 		data.Position.z += sin(MathHelper::ConvertToRadians(static_cast<float>((i + 1)) * (360.0f / splitCount))) * radius;
-		m_vertices.push_back(data);
+		dstVertices.push_back(data);
 
 		// XY面
 		data.Position = centerPos;
 		data.Position.x += cos(MathHelper::ConvertToRadians(static_cast<float>(i) * (360.0f / splitCount))) * radius;
 		data.Position.y += sin(MathHelper::ConvertToRadians(static_cast<float>(i) * (360.0f / splitCount))) * radius;
-		m_vertices.push_back(data);
+		dstVertices.push_back(data);
 
 		data.Position = centerPos;
 		data.Position.x += cos(MathHelper::ConvertToRadians(static_cast<float>((i + 1)) * (360.0f / splitCount))) * radius;
 		data.Position.y += sin(MathHelper::ConvertToRadians(static_cast<float>((i + 1)) * (360.0f / splitCount))) * radius;
-		m_vertices.push_back(data);
+		dstVertices.push_back(data);
 
 		// YZ面
 		data.Position = centerPos;
 		data.Position.y += cos(MathHelper::ConvertToRadians(static_cast<float>(i) * (360.0f / splitCount))) * radius;
 		data.Position.z += sin(MathHelper::ConvertToRadians(static_cast<float>(i) * (360.0f / splitCount))) * radius;
-		m_vertices.push_back(data);
+		dstVertices.push_back(data);
 
 		data.Position = centerPos;
 		data.Position.y += cos(MathHelper::ConvertToRadians(static_cast<float>((i + 1)) * (360.0f / splitCount))) * radius;
 		data.Position.z += sin(MathHelper::ConvertToRadians(static_cast<float>((i + 1)) * (360.0f / splitCount))) * radius;
-		m_vertices.push_back(data);
+		dstVertices.push_back(data);
 	}
 }
 
-void DebugWire::Init()
+std::vector<MeshVertex>& DebugWire::WorkVertices()
+{
+    if (JobSystem::IsWorkerThread())
+    {
+        return m_threadVertices.Work();
+    }
+
+    return m_vertices;
+}
+
+void DebugWire::MergeThreadVertices()
 {
-	// 頂点バッファを作成
-	vertices.Vertices::CreateVertexBuffer(sizeof(MeshVertex), MaxVerticesNum);
+    m_threadVertices.ForEach([this](std::vector<MeshVertex>& threadVertices)
+        {
+            m_vertices.insert(m_vertices.end(), threadVertices.begin(), threadVertices.end());
+            threadVertices.clear();
+        });
 }
 
 void DebugWire::Draw()
 {
     if(!m_enable) { return; }
 
+	// ワーカースレッドから追加された頂点もまとめて描画する
+	MergeThreadVertices();
+
 	// 頂点数が2未満なら描画しない
 	if (m_vertices.size() < 2) { return; }
 
-	// 頂点バッファを作成
-	vertices.UpdateBuffer(m_vertices);
+	// 最大頂点数を超えた分は描画しない
+	const size_t vertexNum = std::min<size_t>(m_vertices.size(), MaxVerticesNum);
+	FNENG_ASSERT_LOG("デバッグワイヤーの頂点数が最大頂点数を超えています", vertexNum < m_vertices.size());
+
+	// 記録中のフレームのアップロード領域に頂点をコピー
+	UploadAllocation allocation = GraphicsDevice::Instance().GetUploadAllocator()->Upload(
+		std::span<const MeshVertex>(m_vertices.data(), vertexNum));
+
+	if (!allocation.IsValid())
+	{
+		ClearVertex();
+		return;
+	}
+
+	D3D12_VERTEX_BUFFER_VIEW vbView = {};
+	vbView.BufferLocation = allocation.GPUAddress;
+	vbView.SizeInBytes = static_cast<UINT>(allocation.Size);
+	vbView.StrideInBytes = sizeof(MeshVertex);
 
 	// シェーダーをセット
 	ShaderManager::Instance().GetGenericShapeShader()->Begin();
 
-	// 描画 : Meshの方のDrawではなく、Verticesの方のDrawを呼び出す
-    vertices.Vertices::DrawInstanced(vertices.GetVertexCount());
+	// 描画
+	const auto& pCmdList = GraphicsDevice::Instance().GetCmdList();
+	pCmdList->IASetVertexBuffers(0, 1, &vbView);
+	pCmdList->DrawInstanced(static_cast<UINT>(vertexNum), 1, 0, 0);
 
 	ClearVertex();
 }
@@ -191,5 +237,4 @@ void DebugWire::Draw()
 void DebugWire::ClearVertex()
 {
     m_vertices.clear();
-    vertices.ClearPositions();
 }
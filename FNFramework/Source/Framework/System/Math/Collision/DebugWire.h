@@ -76,23 +76,28 @@ public:
     void AddDebugSphere(const Math::Vector3& centerPos, const Math::Color& color, float radius = 1.0f,
                         int splitCount = 8);
 
-    /**
-    * @brief デバッグワイヤー初期化
-    */
-    void Init();
-
     /* @brief デバッグワイヤー描画 */
     void Draw();
 
     /* @brief デバッグワイヤー描画用頂点クリア */
     void ClearVertex();
 
+    /* @brief 並列更新の前に、スレッドごとの頂点配列を JobSystem のスレッド数に合わせて確保する */
+    void PrepareThreadVertices() { m_threadVertices.Prepare(); }
+
+    /* @brief スレッドごとの頂点配列を描画用の配列へまとめる : メインスレッドから呼ぶ */
+    void MergeThreadVertices();
+
 private:
     static constexpr UINT MaxVerticesNum = 500000; // 最大頂点数 - 必要に応じて変更してください
 
-    // todo : 座標とColorしか使ってないのにMeshVertexで頂点作成しているのはメモリの無駄になるので今後ほかのMeshを作成することを検討
-    Mesh vertices; // 描画用頂点配列
+    // todo : 座標とColorしか使ってないのにMeshVertexで頂点作成しているのはメモリの無駄になるので今後ほかの頂点形式を作成することを検討
+    // 描画時に FrameUploadAllocator へコピーするので、頂点バッファは持たない
     std::vector<MeshVertex> m_vertices; // 描画用頂点配列
+    utl::PerThread<std::vector<MeshVertex>> m_threadVertices; // ワーカースレッドから追加された頂点配列
+
+    /* @brief 呼び出したスレッドが頂点を追加する配列の取得 */
+    std::vector<MeshVertex>& WorkVertices();
 
     bool m_enable = false; // デバッグワイヤー描画有効かどうか
 };
@@ -0,0 +1,373 @@
+﻿#include "DynamicAABBTree.h"
+
+DynamicAABBTree::ProxyID DynamicAABBTree::CreateProxy(const Box& box, UINT32 userData)
+{
+    const ProxyID proxyID = AllocateNode();
+
+    Node& node = m_nodes[proxyID];
+    node.FatBox = Fatten(box);
+    node.UserData = userData;
+    node.Height = 0;
+
+    InsertLeaf(proxyID);
+
+    ++m_proxyNum;
+
+    return proxyID;
+}
+
+void DynamicAABBTree::DestroyProxy(ProxyID proxyID)
+{
+    if (proxyID < 0 || proxyID >= static_cast<ProxyID>(m_nodes.size())) { return; }
+    if (!m_nodes[proxyID].IsLeaf() || m_nodes[proxyID].Height < 0) { return; }
+
+    RemoveLeaf(proxyID);
+    FreeNode(proxyID);
+
+    --m_proxyNum;
+}
+
+bool DynamicAABBTree::MoveProxy(ProxyID proxyID, const Box& box)
+{
+    Node& node = m_nodes[proxyID];
+
+    // 太らせた AABB に収まっていて、小さくなりすぎていなければそのまま
+    if (node.FatBox.Contains(box))
+    {
+        const Box largeBox = Fatten(Fatten(box));
+        if (largeBox.Contains(node.FatBox)) { return false; }
+    }
+
+    RemoveLeaf(proxyID);
+
+    m_nodes[proxyID].FatBox = Fatten(box);
+
+    InsertLeaf(proxyID);
+
+    return true;
+}
+
+bool DynamicAABBTree::IntersectsRay(const Box& box, const Math::Vector3& origin, const Math::Vector3& invDir, float maxDist)
+{
+    // スラブごとにレイが入る距離と出る距離を求め、全軸で重なる区間があれば交差している
+    float tMin = 0.0f;
+    float tMax = maxDist;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float o = (&origin.x)[axis];
+        const float inv = (&invDir.x)[axis];
+
+        float t1 = ((&box.Min.x)[axis] - o) * inv;
+        float t2 = ((&box.Max.x)[axis] - o) * inv;
+
+        if (t1 > t2) { std::swap(t1, t2); }
+
+        tMin = std::max(tMin, t1);
+        tMax = std::min(tMax, t2);
+
+        if (tMin > tMax) { return false; }
+    }
+
+    return true;
+}
+
+bool DynamicAABBTree::IntersectsSphere(const Box& box, const Math::Vector3& center, float radius)
+{
+    // ボックス上の最も近い点との距離で判定する
+    const Math::Vector3 closest = Math::Vector3::Max(box.Min, Math::Vector3::Min(center, box.Max));
+    return Math::Vector3::DistanceSquared(closest, center) <= radius * radius;
+}
+
+DynamicAABBTree::ProxyID DynamicAABBTree::AllocateNode()
+{
+    // 空き節がなければ配列を伸ばす
+    if (m_freeList == NullNode)
+    {
+        m_nodes.emplace_back();
+        return static_cast<ProxyID>(m_nodes.size() - 1);
+    }
+
+    const ProxyID nodeID = m_freeList;
+    m_freeList = m_nodes[nodeID].Parent;
+
+    m_nodes[nodeID] = Node{};
+
+    return nodeID;
+}
+
+void DynamicAABBTree::FreeNode(ProxyID nodeID)
+{
+    Node& node = m_nodes[nodeID];
+    node.Parent = m_freeList;
+    node.Child1 = NullNode;
+    node.Child2 = NullNode;
+    node.Height = -1;
+
+    m_freeList = nodeID;
+}
+
+void DynamicAABBTree::InsertLeaf(ProxyID leafID)
+{
+    if (m_root == NullNode)
+    {
+        m_root = leafID;
+        m_nodes[leafID].Parent = NullNode;
+        return;
+    }
+
+    //--------------------------------
+    // 兄弟にする節を探す
+    //--------------------------------
+    const Box leafBox = m_nodes[leafID].FatBox;
+
+    ProxyID index = m_root;
+    while (!m_nodes[index].IsLeaf())
+    {
+        const Node& node = m_nodes[index];
+
+        const float area = node.FatBox.GetHalfArea();
+        const float combinedArea = Box::Union(node.FatBox, leafBox).GetHalfArea();
+
+        // この節と新しい親を作る場合のコスト
+        const float cost = 2.0f * combinedArea;
+
+        // 子に降りる場合に、この節の AABB が大きくなる分のコスト
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        const auto childCost = [this, &leafBox, inheritanceCost](ProxyID childID)
+        {
+            const Node& child = m_nodes[childID];
+            const float newArea = Box::Union(child.FatBox, leafBox).GetHalfArea();
+
+            return child.IsLeaf() ? newArea + inheritanceCost : newArea - child.FatBox.GetHalfArea() + inheritanceCost;
+        };
+
+        const float cost1 = childCost(node.Child1);
+        const float cost2 = childCost(node.Child2);
+
+        if (cost < cost1 && cost < cost2) { break; }
+
+        index = cost1 < cost2 ? node.Child1 : node.Child2;
+    }
+
+    const ProxyID siblingID = index;
+
+    //--------------------------------
+    // 新しい親を作って兄弟とつなぐ
+    //--------------------------------
+    // 節の確保で配列が伸びることがあるので、参照は確保の後に取る
+    const ProxyID newParentID = AllocateNode();
+
+    Node& newParent = m_nodes[newParentID];
+    Node& sibling = m_nodes[siblingID];
+
+    const ProxyID oldParentID = sibling.Parent;
+
+    newParent.Parent = oldParentID;
+    newParent.FatBox = Box::Union(leafBox, sibling.FatBox);
+    newParent.Height = sibling.Height + 1;
+    newParent.Child1 = siblingID;
+    newParent.Child2 = leafID;
+
+    sibling.Parent = newParentID;
+    m_nodes[leafID].Parent = newParentID;
+
+    if (oldParentID != NullNode)
+    {
+        Node& oldParent = m_nodes[oldParentID];
+        if (oldParent.Child1 == siblingID)
+        {
+            oldParent.Child1 = newParentID;
+        }
+        else
+        {
+            oldParent.Child2 = newParentID;
+        }
+    }
+    else
+    {
+        m_root = newParentID;
+    }
+
+    Refit(newParentID);
+}
+
+void DynamicAABBTree::RemoveLeaf(ProxyID leafID)
+{
+    if (leafID == m_root)
+    {
+        m_root = NullNode;
+        return;
+    }
+
+    const ProxyID parentID = m_nodes[leafID].Parent;
+    const ProxyID grandParentID = m_nodes[parentID].Parent;
+    const ProxyID siblingID = m_nodes[parentID].Child1 == leafID ? m_nodes[parentID].Child2 : m_nodes[parentID].Child1;
+
+    // 親を消して、兄弟を祖父の子にする
+    if (grandParentID != NullNode)
+    {
+        Node& grandParent = m_nodes[grandParentID];
+        if (grandParent.Child1 == parentID)
+        {
+            grandParent.Child1 = siblingID;
+        }
+        else
+        {
+            grandParent.Child2 = siblingID;
+        }
+
+        m_nodes[siblingID].Parent = grandParentID;
+        FreeNode(parentID);
+
+        Refit(grandParentID);
+    }
+    else
+    {
+        m_root = siblingID;
+        m_nodes[siblingID].Parent = NullNode;
+        FreeNode(parentID);
+    }
+}
+
+void DynamicAABBTree::Refit(ProxyID nodeID)
+{
+    ProxyID index = nodeID;
+    while (index != NullNode)
+    {
+        index = Balance(index);
+
+        Node& node = m_nodes[index];
+        const Node& child1 = m_nodes[node.Child1];
+        const Node& child2 = m_nodes[node.Child2];
+
+        node.Height = 1 + std::max(child1.Height, child2.Height);
+        node.FatBox = Box::Union(child1.FatBox, child2.FatBox);
+
+        index = node.Parent;
+    }
+}
+
+DynamicAABBTree::ProxyID DynamicAABBTree::Balance(ProxyID nodeID)
+{
+    //        A
+    //      /   \
+    //     B     C
+    //    / \   / \
+    //   D   E F   G
+    Node& a = m_nodes[nodeID];
+    if (a.IsLeaf() || a.Height < 2) { return nodeID; }
+
+    const ProxyID bID = a.Child1;
+    const ProxyID cID = a.Child2;
+    Node& b = m_nodes[bID];
+    Node& c = m_nodes[cID];
+
+    const int balance = c.Height - b.Height;
+
+    // 親の子を付け替える
+    const auto replaceChild = [this, nodeID](ProxyID parentID, ProxyID newChildID)
+    {
+        if (parentID == NullNode)
+        {
+            m_root = newChildID;
+            return;
+        }
+
+        Node& parent = m_nodes[parentID];
+        if (parent.Child1 == nodeID)
+        {
+            parent.Child1 = newChildID;
+        }
+        else
+        {
+            parent.Child2 = newChildID;
+        }
+    };
+
+    //x--- C を上げる ---x//
+    if (balance > 1)
+    {
+        const ProxyID fID = c.Child1;
+        const ProxyID gID = c.Child2;
+        Node& f = m_nodes[fID];
+        Node& g = m_nodes[gID];
+
+        c.Child1 = nodeID;
+        c.Parent = a.Parent;
+        a.Parent = cID;
+        replaceChild(c.Parent, cID);
+
+        // 高い方の孫を C に残し、低い方を A に移す
+        if (f.Height > g.Height)
+        {
+            c.Child2 = fID;
+            a.Child2 = gID;
+            g.Parent = nodeID;
+            a.FatBox = Box::Union(b.FatBox, g.FatBox);
+            c.FatBox = Box::Union(a.FatBox, f.FatBox);
+            a.Height = 1 + std::max(b.Height, g.Height);
+            c.Height = 1 + std::max(a.Height, f.Height);
+        }
+        else
+        {
+            c.Child2 = gID;
+            a.Child2 = fID;
+            f.Parent = nodeID;
+            a.FatBox = Box::Union(b.FatBox, f.FatBox);
+            c.FatBox = Box::Union(a.FatBox, g.FatBox);
+            a.Height = 1 + std::max(b.Height, f.Height);
+            c.Height = 1 + std::max(a.Height, g.Height);
+        }
+
+        return cID;
+    }
+
+    //x--- B を上げる ---x//
+    if (balance < -1)
+    {
+        const ProxyID dID = b.Child1;
+        const ProxyID eID = b.Child2;
+        Node& d = m_nodes[dID];
+        Node& e = m_nodes[eID];
+
+        b.Child1 = nodeID;
+        b.Parent = a.Parent;
+        a.Parent = bID;
+        replaceChild(b.Parent, bID);
+
+        if (d.Height > e.Height)
+        {
+            b.Child2 = dID;
+            a.Child1 = eID;
+            e.Parent = nodeID;
+            a.FatBox = Box::Union(c.FatBox, e.FatBox);
+            b.FatBox = Box::Union(a.FatBox, d.FatBox);
+            a.Height = 1 + std::max(c.Height, e.Height);
+            b.Height = 1 + std::max(a.Height, d.Height);
+        }
+        else
+        {
+            b.Child2 = eID;
+            a.Child1 = dID;
+            d.Parent = nodeID;
+            a.FatBox = Box::Union(c.FatBox, d.FatBox);
+            b.FatBox = Box::Union(a.FatBox, e.FatBox);
+            a.Height = 1 + std::max(c.Height, d.Height);
+            b.Height = 1 + std::max(a.Height, e.Height);
+        }
+
+        return bID;
+    }
+
+    return nodeID;
+}
+
+DynamicAABBTree::Box DynamicAABBTree::Fatten(const Box& box)
+{
+    const Math::Vector3 extents = box.GetExtents();
+    const float margin = std::max(std::max(extents.x, extents.y), extents.z) * FatMarginRate + FatMarginMin;
+
+    return { box.Min - Math::Vector3(margin), box.Max + Math::Vector3(margin) };
+}
@@ -0,0 +1,269 @@
+﻿#pragma once
+
+/**
+* @class DynamicAABBTree
+* @brief 動くボックスを登録できる AABB の二分木
+* @details
+*   - 葉は登録されたボックスを少し大きくした AABB(太らせた AABB)を持ち、節は子を包む AABB を持つ
+*   - ボックスが太らせた AABB からはみ出した時だけ木から外して入れ直すので、少しの移動では木を変更しない
+*   - 挿入先は表面積が最も増えない位置を選び、回転で左右の高さの差を 1 以下に保つ
+*   - 視錐台 / ボックス / 球 / レイの判定は、外れた節の子をたどらないので登録数に対して線形にならない
+*/
+class DynamicAABBTree
+{
+public:
+    using ProxyID = INT32;
+    static constexpr ProxyID NullNode = -1;
+
+    // 太らせる量 : 最も長い辺の半分に対する割合と最小値
+    static constexpr float FatMarginRate = 0.1f;
+    static constexpr float FatMarginMin = 0.1f;
+
+    // 判定時にたどる節の最大数 : 高さの差を 1 以下に保つので、登録数が多くても十分に収まる
+    static constexpr UINT32 MaxStackDepth = 256;
+
+    struct Box
+    {
+        Math::Vector3 Min;
+        Math::Vector3 Max;
+
+        Math::Vector3 GetCenter() const { return (Min + Max) * 0.5f; }
+        Math::Vector3 GetExtents() const { return (Max - Min) * 0.5f; }
+
+        bool Contains(const Box& box) const
+        {
+            return Min.x <= box.Min.x && Min.y <= box.Min.y && Min.z <= box.Min.z &&
+                   box.Max.x <= Max.x && box.Max.y <= Max.y && box.Max.z <= Max.z;
+        }
+
+        bool Intersects(const Box& box) const
+        {
+            return Min.x <= box.Max.x && box.Min.x <= Max.x &&
+                   Min.y <= box.Max.y && box.Min.y <= Max.y &&
+                   Min.z <= box.Max.z && box.Min.z <= Max.z;
+        }
+
+        /* @brief 表面積の半分 : 挿入先を選ぶ時の比較にだけ使う */
+        float GetHalfArea() const
+        {
+            const Math::Vector3 size = Max - Min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        static Box Union(const Box& a, const Box& b)
+        {
+            return { Math::Vector3::Min(a.Min, b.Min), Math::Vector3::Max(a.Max, b.Max) };
+        }
+    };
+
+    //--------------------------------
+    // 登録
+    //--------------------------------
+    /**
+    * @brief ボックスの登録
+    * @param[in] box      - ワールド空間の AABB
+    * @param[in] userData - 判定結果として返す値
+    * @return 葉の番号
+    */
+    ProxyID CreateProxy(const Box& box, UINT32 userData);
+
+    /* @brief 登録の解除 */
+    void DestroyProxy(ProxyID proxyID);
+
+    /**
+    * @brief ボックスの移動
+    * @return 木を変更した場合は true : 太らせた AABB に収まっている間は何もしない
+    */
+    bool MoveProxy(ProxyID proxyID, const Box& box);
+
+    UINT32 GetUserData(ProxyID proxyID) const { return m_nodes[proxyID].UserData; }
+    const Box& GetFatBox(ProxyID proxyID) const { return m_nodes[proxyID].FatBox; }
+
+    //--------------------------------
+    // 判定
+    //--------------------------------
+    /**
+    * @brief 視錐台と交差する葉を列挙する
+    * @param[in] func - void(UINT32 userData, UINT32 planeMask) : planeMask が 0 なら太らせた AABB は完全に内側
+    * @return 判定した節の数
+    */
+    template <class Func>
+    UINT32 QueryFrustum(const FrustumCulling::Planes& planes, Func&& func) const;
+
+    /* @brief ボックスと交差する葉を列挙する : func は void(UINT32 userData) */
+    template <class Func>
+    void QueryBox(const Box& box, Func&& func) const;
+
+    /* @brief 球と交差する葉を列挙する : func は void(UINT32 userData) */
+    template <class Func>
+    void QuerySphere(const Math::Vector3& center, float radius, Func&& func) const;
+
+    /**
+    * @brief レイと交差する葉を列挙する : func は void(UINT32 userData)
+    * @param[in] dir     - 正規化した向き
+    * @param[in] maxDist - レイの長さ
+    */
+    template <class Func>
+    void QueryRay(const Math::Vector3& origin, const Math::Vector3& dir, float maxDist, Func&& func) const;
+
+    //--------------------------------
+    // ゲッター : デバッグ表示用
+    //--------------------------------
+    UINT32 GetProxyNum() const { return m_proxyNum; }
+    int GetHeight() const { return m_root == NullNode ? 0 : m_nodes[m_root].Height; }
+
+    //--------------------------------
+    // その他関数
+    //--------------------------------
+    /* @brief ボックスとレイの交差判定 : 交差していれば true */
+    static bool IntersectsRay(const Box& box, const Math::Vector3& origin, const Math::Vector3& invDir, float maxDist);
+
+    /* @brief ボックスと球の交差判定 */
+    static bool IntersectsSphere(const Box& box, const Math::Vector3& center, float radius);
+
+private:
+    struct Node
+    {
+        Box FatBox;
+
+        // 使っていない節では、次の空き節の番号になる
+        ProxyID Parent = NullNode;
+        ProxyID Child1 = NullNode;
+        ProxyID Child2 = NullNode;
+
+        // 葉は 0、使っていない節は -1
+        int Height = -1;
+
+        UINT32 UserData = 0;
+
+        bool IsLeaf() const { return Child1 == NullNode; }
+    };
+
+    /* @brief ボックスの条件を満たす葉を列挙する : test は bool(const Box&) */
+    template <class Test, class Func>
+    void Query(Test&& test, Func&& func) const;
+
+    ProxyID AllocateNode();
+    void FreeNode(ProxyID nodeID);
+
+    void InsertLeaf(ProxyID leafID);
+    void RemoveLeaf(ProxyID leafID);
+
+    /* @brief 親までたどって AABB と高さを計算し直す */
+    void Refit(ProxyID nodeID);
+
+    /* @brief 左右の高さの差が 2 以上なら回転する @return 回転後に nodeID の位置に来た節 */
+    ProxyID Balance(ProxyID nodeID);
+
+    static Box Fatten(const Box& box);
+
+    std::vector<Node> m_nodes;
+
+    ProxyID m_root = NullNode;
+    ProxyID m_freeList = NullNode;
+
+    UINT32 m_proxyNum = 0;
+};
+
+template <class Func>
+UINT32 DynamicAABBTree::QueryFrustum(const FrustumCulling::Planes& planes, Func&& func) const
+{
+    if (m_root == NullNode) { return 0; }
+
+    struct StackEntry
+    {
+        ProxyID NodeID;
+        UINT32 PlaneMask;
+    };
+
+    std::array<StackEntry, MaxStackDepth> stack;
+    UINT32 stackNum = 0;
+    UINT32 visitNum = 0;
+
+    stack[stackNum++] = { m_root, FrustumCulling::AllPlaneMask };
+
+    while (stackNum > 0)
+    {
+        const StackEntry entry = stack[--stackNum];
+        const Node& node = m_nodes[entry.NodeID];
+
+        // 親が完全に内側なら判定せずにそのまま列挙する
+        UINT32 planeMask = entry.PlaneMask;
+        if (planeMask != 0)
+        {
+            ++visitNum;
+            if (!FrustumCulling::ClassifyAABB(planes, node.FatBox.GetCenter(), node.FatBox.GetExtents(), planeMask)) { continue; }
+        }
+
+        if (node.IsLeaf())
+        {
+            func(node.UserData, planeMask);
+            continue;
+        }
+
+        if (stackNum + 2 > MaxStackDepth)
+        {
+            FNENG_ASSERT_ERROR("DynamicAABBTree : 判定用のスタックが足りません");
+            break;
+        }
+
+        stack[stackNum++] = { node.Child1, planeMask };
+        stack[stackNum++] = { node.Child2, planeMask };
+    }
+
+    return visitNum;
+}
+
+template <class Test, class Func>
+void DynamicAABBTree::Query(Test&& test, Func&& func) const
+{
+    if (m_root == NullNode) { return; }
+
+    std::array<ProxyID, MaxStackDepth> stack;
+    UINT32 stackNum = 0;
+
+    stack[stackNum++] = m_root;
+
+    while (stackNum > 0)
+    {
+        const Node& node = m_nodes[stack[--stackNum]];
+
+        if (!test(node.FatBox)) { continue; }
+
+        if (node.IsLeaf())
+        {
+            func(node.UserData);
+            continue;
+        }
+
+        if (stackNum + 2 > MaxStackDepth)
+        {
+            FNENG_ASSERT_ERROR("DynamicAABBTree : 判定用のスタックが足りません");
+            break;
+        }
+
+        stack[stackNum++] = node.Child1;
+        stack[stackNum++] = node.Child2;
+    }
+}
+
+template <class Func>
+void DynamicAABBTree::QueryBox(const Box& box, Func&& func) const
+{
+    Query([&box](const Box& nodeBox) { return nodeBox.Intersects(box); }, std::forward<Func>(func));
+}
+
+template <class Func>
+void DynamicAABBTree::QuerySphere(const Math::Vector3& center, float radius, Func&& func) const
+{
+    Query([&center, radius](const Box& nodeBox) { return IntersectsSphere(nodeBox, center, radius); }, std::forward<Func>(func));
+}
+
+template <class Func>
+void DynamicAABBTree::QueryRay(const Math::Vector3& origin, const Math::Vector3& dir, float maxDist, Func&& func) const
+{
+    // 向きの逆数は1回だけ計算する : 0 の成分は無限大になり、スラブの判定でそのまま扱える
+    const Math::Vector3 invDir = { 1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z };
+
+    Query([&origin, &invDir, maxDist](const Box& nodeBox) { return IntersectsRay(nodeBox, origin, invDir, maxDist); }, std::forward<Func>(func));
+}
@@ -0,0 +1,249 @@
+﻿#include "FrustumCulling.h"
+
+#include <intrin.h>
+
+namespace
+{
+    // 視錐台の外になるボックスの半分のサイズ : どの平面でも外側と判定される
+    constexpr float EmptyExtent = -std::numeric_limits<float>::max();
+
+    // 平面ごとに、全レーンへ広げておく値
+    struct PlaneLanes
+    {
+        float NormalX, NormalY, NormalZ, Distance;
+        float AbsNormalX, AbsNormalY, AbsNormalZ;
+    };
+
+    std::array<PlaneLanes, 6> ToPlaneLanes(const FrustumCulling::Planes& planes)
+    {
+        std::array<PlaneLanes, 6> lanes = {};
+
+        for (size_t i = 0; i < planes.Plane.size(); ++i)
+        {
+            const Math::Vector4& plane = planes.Plane[i];
+            lanes[i] = { plane.x, plane.y, plane.z, plane.w, std::abs(plane.x), std::abs(plane.y), std::abs(plane.z) };
+        }
+
+        return lanes;
+    }
+
+    bool DetectAVX2()
+    {
+        // CPU が AVX / FMA / AVX2 に対応しているか
+        int cpuInfo[4] = {};
+        __cpuid(cpuInfo, 0);
+        if (cpuInfo[0] < 7) { return false; }
+
+        __cpuid(cpuInfo, 1);
+
+        const bool isFMA = (cpuInfo[2] & (1 << 12)) != 0;
+        const bool isOSXSave = (cpuInfo[2] & (1 << 27)) != 0;
+        const bool isAVX = (cpuInfo[2] & (1 << 28)) != 0;
+        if (!isFMA || !isOSXSave || !isAVX) { return false; }
+
+        __cpuidex(cpuInfo, 7, 0);
+
+        const bool isAVX2 = (cpuInfo[1] & (1 << 5)) != 0;
+        if (!isAVX2) { return false; }
+
+        // OS が YMM レジスタを保存するか
+        const unsigned long long xcr0 = _xgetbv(0);
+        return (xcr0 & 0x6) == 0x6;
+    }
+
+    // 判定するボックスの成分ごとの配列の先頭
+    struct BoxLanes
+    {
+        const float* pCX;
+        const float* pCY;
+        const float* pCZ;
+        const float* pEX;
+        const float* pEY;
+        const float* pEZ;
+    };
+
+    /**
+    * @brief AVX2 / FMA で 8 個ずつ判定する
+    * @details
+    *   距離と半径は FMA 6回でまとめて足し、外側かどうかは和の符号ビットで判定する
+    *   半径は 0 以上なので、和が -0 になるのは距離も -0 の場合だけで、比較と同じ結果になる
+    */
+    void TestAABBsAVX2(const std::array<PlaneLanes, 6>& lanes, const BoxLanes& boxes, UINT32 begin, UINT32 end, UINT32* pVisibleBits)
+    {
+        using namespace FrustumCulling;
+
+        for (UINT32 i = begin; i < end; i += LaneNum)
+        {
+            const __m256 cx = _mm256_loadu_ps(boxes.pCX + i);
+            const __m256 cy = _mm256_loadu_ps(boxes.pCY + i);
+            const __m256 cz = _mm256_loadu_ps(boxes.pCZ + i);
+            const __m256 ex = _mm256_loadu_ps(boxes.pEX + i);
+            const __m256 ey = _mm256_loadu_ps(boxes.pEY + i);
+            const __m256 ez = _mm256_loadu_ps(boxes.pEZ + i);
+
+            __m256i outside = _mm256_setzero_si256();
+
+            for (const PlaneLanes& plane : lanes)
+            {
+                __m256 sum = _mm256_set1_ps(plane.Distance);
+                sum = _mm256_fmadd_ps(cx, _mm256_set1_ps(plane.NormalX), sum);
+                sum = _mm256_fmadd_ps(cy, _mm256_set1_ps(plane.NormalY), sum);
+                sum = _mm256_fmadd_ps(cz, _mm256_set1_ps(plane.NormalZ), sum);
+                sum = _mm256_fmadd_ps(ex, _mm256_set1_ps(plane.AbsNormalX), sum);
+                sum = _mm256_fmadd_ps(ey, _mm256_set1_ps(plane.AbsNormalY), sum);
+                sum = _mm256_fmadd_ps(ez, _mm256_set1_ps(plane.AbsNormalZ), sum);
+
+                outside = _mm256_or_si256(outside, _mm256_castps_si256(sum));
+            }
+
+            const UINT32 visibleMask = ~static_cast<UINT32>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xFFu;
+            pVisibleBits[i / BitWordSize] |= visibleMask << (i % BitWordSize);
+        }
+    }
+
+    /* @brief SSE で 4 個ずつ判定する */
+    void TestAABBsSSE(const std::array<PlaneLanes, 6>& lanes, const BoxLanes& boxes, UINT32 begin, UINT32 end, UINT32* pVisibleBits)
+    {
+        using namespace FrustumCulling;
+
+        const __m128 zero = _mm_setzero_ps();
+
+        for (UINT32 i = begin; i < end; i += 4)
+        {
+            const __m128 cx = _mm_loadu_ps(boxes.pCX + i);
+            const __m128 cy = _mm_loadu_ps(boxes.pCY + i);
+            const __m128 cz = _mm_loadu_ps(boxes.pCZ + i);
+            const __m128 ex = _mm_loadu_ps(boxes.pEX + i);
+            const __m128 ey = _mm_loadu_ps(boxes.pEY + i);
+            const __m128 ez = _mm_loadu_ps(boxes.pEZ + i);
+
+            __m128 outside = zero;
+
+            for (const PlaneLanes& plane : lanes)
+            {
+                __m128 dist = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.NormalX)), _mm_mul_ps(cy, _mm_set1_ps(plane.NormalY))),
+                    _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.NormalZ)), _mm_set1_ps(plane.Distance)));
+
+                __m128 radius = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(plane.AbsNormalX)), _mm_mul_ps(ey, _mm_set1_ps(plane.AbsNormalY))),
+                    _mm_mul_ps(ez, _mm_set1_ps(plane.AbsNormalZ)));
+
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(dist, radius), zero));
+            }
+
+            const UINT32 visibleMask = ~static_cast<UINT32>(_mm_movemask_ps(outside)) & 0xFu;
+            pVisibleBits[i / BitWordSize] |= visibleMask << (i % BitWordSize);
+        }
+    }
+}
+
+namespace FrustumCulling
+{
+    Planes ExtractPlanes(const Math::Matrix& mViewProj)
+    {
+        // 行ベクトル * 行列 なので、列から平面を取り出す (深度は 0 ~ 1)
+        const Math::Vector4 col1 = { mViewProj._11, mViewProj._21, mViewProj._31, mViewProj._41 };
+        const Math::Vector4 col2 = { mViewProj._12, mViewProj._22, mViewProj._32, mViewProj._42 };
+        const Math::Vector4 col3 = { mViewProj._13, mViewProj._23, mViewProj._33, mViewProj._43 };
+        const Math::Vector4 col4 = { mViewProj._14, mViewProj._24, mViewProj._34, mViewProj._44 };
+
+        Planes planes;
+        planes.Plane[0] = col4 + col1; // 左
+        planes.Plane[1] = col4 - col1; // 右
+        planes.Plane[2] = col4 + col2; // 下
+        planes.Plane[3] = col4 - col2; // 上
+        planes.Plane[4] = col3;        // 手前
+        planes.Plane[5] = col4 - col3; // 奥
+
+        for (Math::Vector4& plane : planes.Plane)
+        {
+            const float length = Math::Vector3(plane.x, plane.y, plane.z).Length();
+            if (length > 0.0f) { plane /= length; }
+        }
+
+        return planes;
+    }
+
+    bool ClassifyAABB(const Planes& planes, const Math::Vector3& center, const Math::Vector3& extents, UINT32& planeMask)
+    {
+        for (UINT32 i = 0; i < static_cast<UINT32>(planes.Plane.size()); ++i)
+        {
+            const UINT32 bit = 1u << i;
+            if ((planeMask & bit) == 0) { continue; }
+
+            const Math::Vector4& plane = planes.Plane[i];
+
+            const float dist = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            const float radius = std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z;
+
+            // 1つの平面でも外側なら視錐台の外
+            if (dist + radius < 0.0f) { return false; }
+
+            // 平面の内側に収まっていれば、子のボックスもこの平面は判定しなくて良い
+            if (dist - radius >= 0.0f) { planeMask &= ~bit; }
+        }
+
+        return true;
+    }
+
+    void AABBArrays::Resize(UINT32 num)
+    {
+        const UINT32 oldNum = std::min(m_num, GetPaddedNum());
+        const UINT32 paddedNum = (num + LaneNum - 1) / LaneNum * LaneNum;
+
+        m_centerX.resize(paddedNum);
+        m_centerY.resize(paddedNum);
+        m_centerZ.resize(paddedNum);
+        m_extentX.resize(paddedNum);
+        m_extentY.resize(paddedNum);
+        m_extentZ.resize(paddedNum);
+
+        m_num = num;
+
+        // 増えた分と余りは、設定されるまで視錐台の外にしておく
+        for (UINT32 i = std::min(oldNum, num); i < paddedNum; ++i)
+        {
+            SetEmpty(i);
+        }
+    }
+
+    void AABBArrays::SetEmpty(UINT32 index)
+    {
+        Set(index, Math::Vector3::Zero, { EmptyExtent, EmptyExtent, EmptyExtent });
+    }
+
+    bool IsAVX2Enable()
+    {
+        static const bool isAVX2Enable = DetectAVX2();
+        return isAVX2Enable;
+    }
+
+    void TestAABBs(const Planes& planes, const AABBArrays& boxes, UINT32 begin, UINT32 end, UINT32* pVisibleBits, SIMDPath path)
+    {
+        end = std::min(end, boxes.GetPaddedNum());
+        if (begin >= end) { return; }
+
+        // 範囲内のビット配列の要素は、判定する前に消しておく
+        for (UINT32 word = begin / BitWordSize; word < (end + BitWordSize - 1) / BitWordSize; ++word)
+        {
+            pVisibleBits[word] = 0;
+        }
+
+        const std::array<PlaneLanes, 6> lanes = ToPlaneLanes(planes);
+
+        const BoxLanes boxLanes = {
+            boxes.m_centerX.data(), boxes.m_centerY.data(), boxes.m_centerZ.data(),
+            boxes.m_extentX.data(), boxes.m_extentY.data(), boxes.m_extentZ.data() };
+
+        // 中心の平面からの距離 + 半分のサイズを法線に投影した長さ が負なら、その平面の外側にある
+        if (path != SIMDPath::eSSE && IsAVX2Enable())
+        {
+            TestAABBsAVX2(lanes, boxLanes, begin, end, pVisibleBits);
+        }
+        else
+        {
+            TestAABBsSSE(lanes, boxLanes, begin, end, pVisibleBits);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+﻿#pragma once
+
+/**
+* @namespace FrustumCulling
+* @brief 視錐台と多数の AABB をまとめて判定する関数群
+* @details
+*   - 視錐台の6平面は ビュー行列 * 射影行列 から1回だけ取り出す
+*   - AABB は中心と半分のサイズを成分ごとの配列(SoA)で持ち、8個ずつ SIMD で判定する
+*   - AVX2 / FMA が使える CPU では 8 レーン、使えない場合は SSE の 4 レーンを2回で判定する
+*   - 判定結果は 1bit = 1ボックスのビット配列に書き込む
+*/
+namespace FrustumCulling
+{
+    // 1回の判定で扱うボックスの数 : AVX2 の 8 レーンに合わせる
+    static constexpr UINT32 LaneNum = 8;
+
+    // ビット配列の1要素が持つボックスの数
+    static constexpr UINT32 BitWordSize = 32;
+
+    // 6平面すべてを判定する場合の ClassifyAABB の平面のビット
+    static constexpr UINT32 AllPlaneMask = 0x3F;
+
+    // 判定に使う命令
+    enum class SIMDPath
+    {
+        eAuto, // CPU が対応していれば AVX2
+        eSSE,  // SSE の 4 レーン
+        eAVX2, // AVX2 / FMA の 8 レーン : CPU が対応していない場合は SSE
+    };
+
+    /* @brief 視錐台の6平面 : xyz が内向きの法線、w が距離 (内側が正) */
+    struct Planes
+    {
+        std::array<Math::Vector4, 6> Plane;
+    };
+
+    /**
+    * @brief 視錐台の平面の取り出し
+    * @param[in] mViewProj - ビュー行列 * 射影行列
+    * @return 正規化した6平面
+    */
+    Planes ExtractPlanes(const Math::Matrix& mViewProj);
+
+    /**
+    * @brief 1つの AABB の判定 : 木構造をたどって階層的に判定する場合に使う
+    * @param[in]     planes    - 視錐台の平面
+    * @param[in]     center    - 中心
+    * @param[in]     extents   - 半分のサイズ
+    * @param[in,out] planeMask - 判定する平面のビット : 完全に内側にある平面のビットは消す
+    * @return 視錐台の外なら false : planeMask が 0 になれば、子のボックスは判定しなくても内側
+    */
+    bool ClassifyAABB(const Planes& planes, const Math::Vector3& center, const Math::Vector3& extents, UINT32& planeMask);
+
+    /**
+    * @class AABBArrays
+    * @brief AABB を成分ごとの配列で持つ
+    * @details 要素数は LaneNum の倍数に切り上げ、余りには必ず視錐台の外になるボックスを入れておく
+    */
+    class AABBArrays
+    {
+    public:
+        /* @brief 要素数の変更 : 増えた分と余りは視錐台の外になるボックスで埋める */
+        void Resize(UINT32 num);
+
+        void Set(UINT32 index, const Math::Vector3& center, const Math::Vector3& extents)
+        {
+            m_centerX[index] = center.x;
+            m_centerY[index] = center.y;
+            m_centerZ[index] = center.z;
+            m_extentX[index] = extents.x;
+            m_extentY[index] = extents.y;
+            m_extentZ[index] = extents.z;
+        }
+
+        /* @brief 視錐台の外になるボックスにする : 使っていない要素に使う */
+        void SetEmpty(UINT32 index);
+
+        /* @brief 要素数 : Resize で指定した数 */
+        UINT32 GetNum() const { return m_num; }
+
+        /* @brief 確保した要素数 : LaneNum の倍数 */
+        UINT32 GetPaddedNum() const { return static_cast<UINT32>(m_centerX.size()); }
+
+        /* @brief ビット配列に必要な要素数 */
+        UINT32 GetBitWordNum() const { return (GetPaddedNum() + BitWordSize - 1) / BitWordSize; }
+
+    private:
+        friend void TestAABBs(const Planes&, const AABBArrays&, UINT32, UINT32, UINT32*, SIMDPath);
+
+        std::vector<float> m_centerX;
+        std::vector<float> m_centerY;
+        std::vector<float> m_centerZ;
+        std::vector<float> m_extentX;
+        std::vector<float> m_extentY;
+        std::vector<float> m_extentZ;
+
+        UINT32 m_num = 0;
+    };
+
+    /* @brief AVX2 / FMA で判定するか : CPU と OS の対応を1回だけ調べる */
+    bool IsAVX2Enable();
+
+    /**
+    * @brief [begin, end) のボックスを判定して、見えているボックスのビットを立てる
+    * @param[in]  planes        - 視錐台の平面
+    * @param[in]  boxes         - 判定するボックス
+    * @param[in]  begin         - 先頭 : BitWordSize の倍数
+    * @param[in]  end           - 終わり : 最後の範囲以外は BitWordSize の倍数
+    * @param[out] pVisibleBits  - 判定結果 : 範囲内の要素は上書きする
+    * @param[in]  path          - 判定に使う命令 : 計測で SSE と比べる場合以外は eAuto
+    * @details 範囲の境目を BitWordSize の倍数にすると、範囲ごとに別のスレッドから呼んでもビット配列の同じ要素を書き換えない
+    */
+    void TestAABBs(const Planes& planes, const AABBArrays& boxes, UINT32 begin, UINT32 end, UINT32* pVisibleBits,
+        SIMDPath path = SIMDPath::eAuto);
+
+    /* @brief ビット配列から判定結果を取り出す */
+    inline bool IsVisible(const UINT32* pVisibleBits, UINT32 index)
+    {
+        return (pVisibleBits[index / BitWordSize] >> (index % BitWordSize)) & 1u;
+    }
+}
@@ -0,0 +1,261 @@
+﻿#include "LightCluster.h"
+
+#include <intrin.h>
+
+namespace
+{
+    // 射影行列の逆算 : 正規化デバイス座標 ndc に写るビュー空間の座標 (z の位置で)
+    //   ndc = (pos * scale + z * offsetZ + offset) / (z * wZ + w)
+    float ToViewPos(float ndc, float z, float scale, float offsetZ, float offset, float wZ, float w)
+    {
+        return (ndc * (z * wZ + w) - z * offsetZ - offset) / scale;
+    }
+
+    // 範囲 [minPos, maxPos] までの距離 : 中なら 0
+    float DistanceToRange(float pos, float minPos, float maxPos)
+    {
+        return std::max(minPos - pos, 0.0f) + std::max(pos - maxPos, 0.0f);
+    }
+}
+
+namespace LightCluster
+{
+    //===============================
+    // Grid
+    //===============================
+    Grid Grid::Create(const Math::Matrix& mView, const Math::Matrix& mProj, float nearZ, float farZ)
+    {
+        Grid grid;
+        grid.mView = mView;
+        grid.mProj = mProj;
+        grid.Near = std::max(nearZ, std::numeric_limits<float>::min());
+        grid.Far = std::max(farZ, grid.Near * 1.001f);
+
+        // slice = log(z / near) / log(far / near) * SliceNum を、log(z) の1次式にしておく
+        const float logRange = std::log(grid.Far / grid.Near);
+        grid.SliceScale = static_cast<float>(SliceNum) / logRange;
+        grid.SliceBias = -static_cast<float>(SliceNum) * std::log(grid.Near) / logRange;
+
+        return grid;
+    }
+
+    float Grid::GetSliceZ(UINT32 slice) const
+    {
+        if (slice >= SliceNum) { return Far; }
+
+        return Near * std::pow(Far / Near, static_cast<float>(slice) / static_cast<float>(SliceNum));
+    }
+
+    UINT32 Grid::GetSlice(float viewZ) const
+    {
+        if (viewZ <= Near) { return 0; }
+
+        const float slice = std::floor(std::log(viewZ) * SliceScale + SliceBias);
+        return static_cast<UINT32>(std::clamp(slice, 0.0f, static_cast<float>(SliceNum - 1)));
+    }
+
+    //===============================
+    // Builder
+    //===============================
+    Builder::Builder()
+    {
+        m_clusterCounts.assign(ClusterNum, 0);
+        m_clusterLights.assign(ClusterNum * MaxClusterLightNum, 0);
+        m_ranges.assign(ClusterNum, Range{});
+    }
+
+    void Builder::Build(const Grid& grid, std::span<const Math::Vector4> spheres)
+    {
+        m_stats = Stats{};
+
+        UpdateSliceBounds(grid);
+
+        //===============================
+        // ライトをビュー空間に移し、重なる奥行きの範囲を求める
+        //===============================
+        const UINT32 lightNum = static_cast<UINT32>(std::min<size_t>(spheres.size(), MaxLightNum));
+        m_viewSpheres.resize(lightNum);
+        m_minSlices.resize(lightNum);
+        m_maxSlices.resize(lightNum);
+
+        for (UINT32 i = 0; i < lightNum; ++i)
+        {
+            const Math::Vector4& sphere = spheres[i];
+            const Math::Vector3 center = Math::Vector3::Transform(Math::Vector3(sphere.x, sphere.y, sphere.z), grid.mView);
+            m_viewSpheres[i] = { center.x, center.y, center.z, sphere.w };
+
+            // 半径がない / カメラの後ろ / far より奥のライトは、どのクラスターにも入れない
+            const float minZ = center.z - sphere.w;
+            const float maxZ = center.z + sphere.w;
+            if (sphere.w <= 0.0f || maxZ < grid.Near || minZ > grid.Far)
+            {
+                m_minSlices[i] = 1;
+                m_maxSlices[i] = 0;
+                continue;
+            }
+
+            m_minSlices[i] = grid.GetSlice(minZ);
+            m_maxSlices[i] = grid.GetSlice(maxZ);
+        }
+
+        m_stats.LightNum = lightNum;
+
+        //===============================
+        // 奥行きごとに並列に振り分ける
+        //===============================
+        std::fill(m_clusterCounts.begin(), m_clusterCounts.end(), 0);
+
+        JobSystem::Instance().ParallelFor(SliceNum, 1,
+            [this](UINT32 begin, UINT32 end)
+            {
+                for (UINT32 slice = begin; slice < end; ++slice)
+                {
+                    BuildSlice(slice);
+                }
+            });
+
+        //===============================
+        // クラスターの順に詰める
+        //===============================
+        m_lightIndices.clear();
+
+        std::vector<UINT8> isVisibleLights(lightNum, 0);
+        for (UINT32 cluster = 0; cluster < ClusterNum; ++cluster)
+        {
+            const UINT32 count = m_clusterCounts[cluster];
+            m_ranges[cluster] = { static_cast<UINT32>(m_lightIndices.size()), count };
+
+            if (count == 0) { continue; }
+
+            const UINT32* pLights = m_clusterLights.data() + cluster * MaxClusterLightNum;
+            m_lightIndices.insert(m_lightIndices.end(), pLights, pLights + count);
+
+            for (UINT32 i = 0; i < count; ++i)
+            {
+                isVisibleLights[pLights[i]] = 1;
+            }
+
+            ++m_stats.UsedClusterNum;
+            m_stats.MaxLightPerCluster = std::max(m_stats.MaxLightPerCluster, count);
+        }
+
+        for (UINT32 slice = 0; slice < SliceNum; ++slice)
+        {
+            m_stats.OverflowNum += m_sliceOverflowNums[slice];
+        }
+
+        m_stats.IndexNum = static_cast<UINT32>(m_lightIndices.size());
+        m_stats.VisibleLightNum = static_cast<UINT32>(std::count(isVisibleLights.begin(), isVisibleLights.end(), 1));
+    }
+
+    void Builder::UpdateSliceBounds(const Grid& grid)
+    {
+        const Math::Matrix& mProj = grid.mProj;
+
+        for (UINT32 slice = 0; slice <= SliceNum; ++slice)
+        {
+            m_sliceZ[slice] = grid.GetSliceZ(slice);
+        }
+
+        for (UINT32 slice = 0; slice < SliceNum; ++slice)
+        {
+            const float nearZ = m_sliceZ[slice];
+            const float farZ = m_sliceZ[slice + 1];
+
+            // タイルの x は左から、y は上から並べる : シェーダーで UV から求める番号と合わせる
+            for (UINT32 x = 0; x < TileNumX; ++x)
+            {
+                const float ndcMin = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(TileNumX);
+                const float ndcMax = -1.0f + 2.0f * static_cast<float>(x + 1) / static_cast<float>(TileNumX);
+
+                const std::array<float, 4> posX = {
+                    ToViewPos(ndcMin, nearZ, mProj._11, mProj._31, mProj._41, mProj._34, mProj._44),
+                    ToViewPos(ndcMin, farZ, mProj._11, mProj._31, mProj._41, mProj._34, mProj._44),
+                    ToViewPos(ndcMax, nearZ, mProj._11, mProj._31, mProj._41, mProj._34, mProj._44),
+                    ToViewPos(ndcMax, farZ, mProj._11, mProj._31, mProj._41, mProj._34, mProj._44)
+                };
+                m_tileMinX[slice][x] = *std::min_element(posX.begin(), posX.end());
+                m_tileMaxX[slice][x] = *std::max_element(posX.begin(), posX.end());
+            }
+
+            for (UINT32 y = 0; y < TileNumY; ++y)
+            {
+                const float ndcMax = 1.0f - 2.0f * static_cast<float>(y) / static_cast<float>(TileNumY);
+                const float ndcMin = 1.0f - 2.0f * static_cast<float>(y + 1) / static_cast<float>(TileNumY);
+
+                const std::array<float, 4> posY = {
+                    ToViewPos(ndcMin, nearZ, mProj._22, mProj._32, mProj._42, mProj._34, mProj._44),
+                    ToViewPos(ndcMin, farZ, mProj._22, mProj._32, mProj._42, mProj._34, mProj._44),
+                    ToViewPos(ndcMax, nearZ, mProj._22, mProj._32, mProj._42, mProj._34, mProj._44),
+                    ToViewPos(ndcMax, farZ, mProj._22, mProj._32, mProj._42, mProj._34, mProj._44)
+                };
+                m_tileMinY[slice][y] = *std::min_element(posY.begin(), posY.end());
+                m_tileMaxY[slice][y] = *std::max_element(posY.begin(), posY.end());
+            }
+        }
+    }
+
+    void Builder::BuildSlice(UINT32 slice)
+    {
+        const float nearZ = m_sliceZ[slice];
+        const float farZ = m_sliceZ[slice + 1];
+
+        const std::array<float, TileNumX>& tileMinX = m_tileMinX[slice];
+        const std::array<float, TileNumX>& tileMaxX = m_tileMaxX[slice];
+        const __m128 zero = _mm_setzero_ps();
+
+        UINT32 overflowNum = 0;
+
+        for (UINT32 lightIdx = 0; lightIdx < static_cast<UINT32>(m_viewSpheres.size()); ++lightIdx)
+        {
+            if (slice < m_minSlices[lightIdx] || slice > m_maxSlices[lightIdx]) { continue; }
+
+            // 球と AABB の距離は、軸ごとの範囲までの距離の2乗の和 : z から順に半径を使い切っていく
+            const Math::Vector4& sphere = m_viewSpheres[lightIdx];
+            const float distZ = DistanceToRange(sphere.z, nearZ, farZ);
+            const float restZ = sphere.w * sphere.w - distZ * distZ;
+            if (restZ < 0.0f) { continue; }
+
+            const __m128 centerX = _mm_set1_ps(sphere.x);
+
+            for (UINT32 y = 0; y < TileNumY; ++y)
+            {
+                const float distY = DistanceToRange(sphere.y, m_tileMinY[slice][y], m_tileMaxY[slice][y]);
+                const float restY = restZ - distY * distY;
+                if (restY < 0.0f) { continue; }
+
+                const __m128 rest = _mm_set1_ps(restY);
+
+                for (UINT32 x = 0; x < TileNumX; x += LaneNum)
+                {
+                    const __m128 minX = _mm_loadu_ps(tileMinX.data() + x);
+                    const __m128 maxX = _mm_loadu_ps(tileMaxX.data() + x);
+
+                    const __m128 distX = _mm_add_ps(
+                        _mm_max_ps(_mm_sub_ps(minX, centerX), zero),
+                        _mm_max_ps(_mm_sub_ps(centerX, maxX), zero));
+
+                    UINT32 hitMask = static_cast<UINT32>(_mm_movemask_ps(_mm_cmple_ps(_mm_mul_ps(distX, distX), rest)));
+
+                    for (; hitMask != 0; hitMask &= hitMask - 1)
+                    {
+                        const UINT32 cluster = GetClusterIndex(x + static_cast<UINT32>(std::countr_zero(hitMask)), y, slice);
+                        UINT32& count = m_clusterCounts[cluster];
+
+                        // 上限を超えた分は入れない : 先に追加されたライトを残す
+                        if (count >= MaxClusterLightNum)
+                        {
+                            ++overflowNum;
+                            continue;
+                        }
+
+                        m_clusterLights[cluster * MaxClusterLightNum + count] = lightIdx;
+                        ++count;
+                    }
+                }
+            }
+        }
+
+        m_sliceOverflowNums[slice] = overflowNum;
+    }
+}
@@ -0,0 +1,144 @@
+﻿#pragma once
+
+/**
+* @namespace LightCluster
+* @brief ポイントライトをカメラの視錐台を分けた小さな箱(クラスター)に振り分ける
+* @details
+*   - 画面を TileNumX x TileNumY のタイルに、奥行きを SliceNum 枚に分けた箱をクラスターにする
+*     奥行きは手前ほど細かく、near から far まで等比で分ける
+*   - ライトの球とクラスターの AABB(ビュー空間)が重なれば、そのクラスターにライトの番号を入れる
+*     箱の x / y / z の範囲はそれぞれ別に決まるので、x 方向の4つの箱を SSE でまとめて判定する
+*   - 奥行きの1枚ごとにジョブに分ける : 1枚の中のクラスターにしか書き込まない
+*   - 最後にクラスターごとの番号を1つの配列に詰め、クラスターごとの (先頭, 数) を作る
+*   - 1つのクラスターに入れるライトは MaxClusterLightNum までにして、1ピクセルのライティングの重さに上限を付ける
+*   - GPU / シェーダーには依存しない : 入力は球の配列と行列だけなので、描画なしで結果を確かめられる
+*/
+namespace LightCluster
+{
+    // クラスターの分け方 : 画面を 16:9 に合わせて分ける
+    static constexpr UINT32 TileNumX = 16;
+    static constexpr UINT32 TileNumY = 9;
+    static constexpr UINT32 SliceNum = 24;
+    static constexpr UINT32 ClusterNum = TileNumX * TileNumY * SliceNum;
+
+    // 1つのクラスターに入れるライトの上限 : 超えた分は先に追加されたライトを残す
+    static constexpr UINT32 MaxClusterLightNum = 64;
+
+    // 振り分けるライトの上限
+    static constexpr UINT32 MaxLightNum = 4096;
+
+    // x 方向にまとめて判定するクラスターの数
+    static constexpr UINT32 LaneNum = 4;
+    static_assert(TileNumX % LaneNum == 0, "TileNumX は LaneNum の倍数にする");
+
+    /* @brief クラスターの番号 */
+    inline UINT32 GetClusterIndex(UINT32 x, UINT32 y, UINT32 slice)
+    {
+        return (slice * TileNumY + y) * TileNumX + x;
+    }
+
+    /**
+    * @struct Grid
+    * @brief クラスターに分けるカメラ
+    * @details シェーダーでは、ビュー空間の z から Slice = log(z) * SliceScale + SliceBias で奥行きの番号を求める
+    */
+    struct Grid
+    {
+        Math::Matrix mView;
+        Math::Matrix mProj;
+
+        float Near = 0.1f;
+        float Far = 1.0f;
+
+        float SliceScale = 0.0f;
+        float SliceBias = 0.0f;
+
+        /**
+        * @brief 作成
+        * @param[in] mView - ビュー行列 : 左手系で、カメラの前が +z
+        * @param[in] mProj - 射影行列 : 透視投影 / 平行投影のどちらでも良い
+        * @param[in] nearZ - 手前のクリップ距離
+        * @param[in] farZ  - 奥のクリップ距離
+        */
+        static Grid Create(const Math::Matrix& mView, const Math::Matrix& mProj, float nearZ, float farZ);
+
+        /* @brief 奥行きの番号の境目の z : slice = SliceNum なら Far */
+        float GetSliceZ(UINT32 slice) const;
+
+        /* @brief ビュー空間の z が入る奥行きの番号 : 範囲外は端の番号にする */
+        UINT32 GetSlice(float viewZ) const;
+    };
+
+    /* @brief クラスターに入ったライトの範囲 : GPU にはそのまま uint2 で送る */
+    struct Range
+    {
+        UINT32 Offset = 0;
+        UINT32 Count = 0;
+    };
+
+    /* @brief 振り分けの結果 : デバッグ表示用 */
+    struct Stats
+    {
+        UINT32 LightNum = 0;            // 振り分けたライトの数
+        UINT32 VisibleLightNum = 0;     // 1つ以上のクラスターに入ったライトの数
+        UINT32 IndexNum = 0;            // 詰めた番号の数
+        UINT32 UsedClusterNum = 0;      // ライトが1つ以上入ったクラスターの数
+        UINT32 MaxLightPerCluster = 0;  // 1つのクラスターに入ったライトの最大数
+        UINT32 OverflowNum = 0;         // 上限を超えて入れられなかった数
+    };
+
+    /**
+    * @class Builder
+    * @brief クラスターへの振り分けと、番号の配列への詰め込み
+    */
+    class Builder
+    {
+    public:
+        Builder();
+
+        /**
+        * @brief 振り分ける
+        * @param[in] grid    - クラスターに分けるカメラ
+        * @param[in] spheres - ライトの球 : xyz がワールド空間の中心、w が半径 / MaxLightNum を超えた分は使わない
+        * @details JobSystem の ParallelFor で奥行きごとに分ける : ワーカーがなければその場で処理する
+        */
+        void Build(const Grid& grid, std::span<const Math::Vector4> spheres);
+
+        /* @brief クラスターごとの範囲 : ClusterNum 個 */
+        const std::vector<Range>& GetRanges() const { return m_ranges; }
+
+        /* @brief クラスターの順に詰めたライトの番号 */
+        const std::vector<UINT32>& GetLightIndices() const { return m_lightIndices; }
+
+        const Stats& GetStats() const { return m_stats; }
+
+    private:
+        /* @brief 1枚分のクラスターの AABB を作る : x / y の範囲は z の範囲の両端で決まる */
+        void UpdateSliceBounds(const Grid& grid);
+
+        /* @brief 奥行き1枚分のクラスターにライトを入れる */
+        void BuildSlice(UINT32 slice);
+
+        // ビュー空間のライトの球と、重なる奥行きの範囲 : 重ならなければ MinSlice > MaxSlice
+        std::vector<Math::Vector4> m_viewSpheres;
+        std::vector<UINT32> m_minSlices;
+        std::vector<UINT32> m_maxSlices;
+
+        // 奥行きごとのクラスターの AABB : x / y は別々に持つ
+        std::array<std::array<float, TileNumX>, SliceNum> m_tileMinX;
+        std::array<std::array<float, TileNumX>, SliceNum> m_tileMaxX;
+        std::array<std::array<float, TileNumY>, SliceNum> m_tileMinY;
+        std::array<std::array<float, TileNumY>, SliceNum> m_tileMaxY;
+        std::array<float, SliceNum + 1> m_sliceZ;
+
+        // 詰める前のクラスターごとの番号 : クラスターごとに MaxClusterLightNum 個ずつ場所を取る
+        std::vector<UINT32> m_clusterCounts;
+        std::vector<UINT32> m_clusterLights;
+        std::array<UINT32, SliceNum> m_sliceOverflowNums = {};
+
+        std::vector<Range> m_ranges;
+        std::vector<UINT32> m_lightIndices;
+
+        Stats m_stats;
+    };
+}
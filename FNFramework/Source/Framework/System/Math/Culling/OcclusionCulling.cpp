@@ -0,0 +1,268 @@
+﻿#include "OcclusionCulling.h"
+
+#include <intrin.h>
+
+namespace
+{
+    // これより面積が小さい三角形は潰れている扱いにする : ピクセル単位の面積の2倍
+    constexpr float MinTriangleArea = 1.0e-6f;
+
+    // クリップ空間から深度バッファのピクセル座標にする : y は下向き
+    Math::Vector3 ToScreen(const Math::Vector4& clip)
+    {
+        const float invW = 1.0f / clip.w;
+        return {
+            (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(OcclusionCulling::Width),
+            (0.5f - clip.y * invW * 0.5f) * static_cast<float>(OcclusionCulling::Height),
+            invW
+        };
+    }
+
+    // 中心がこの範囲に入るピクセルの番号 : 画面の外は切り詰め、範囲がなければ min > max になる
+    void ToPixelRange(float minPos, float maxPos, UINT32 size, INT32& minPixel, INT32& maxPixel)
+    {
+        const float maxPixelPos = static_cast<float>(size - 1);
+        minPixel = static_cast<INT32>(std::ceil(std::clamp(minPos - 0.5f, 0.0f, maxPixelPos + 1.0f)));
+        maxPixel = static_cast<INT32>(std::floor(std::clamp(maxPos - 0.5f, -1.0f, maxPixelPos)));
+    }
+}
+
+namespace OcclusionCulling
+{
+    bool SetupTriangle(const Math::Vector4& clip0, const Math::Vector4& clip1, const Math::Vector4& clip2, ScreenTriangle& dst)
+    {
+        dst = ScreenTriangle{};
+
+        // 手前のクリップ面をまたぐ三角形は切り分けずに捨てる : 遮蔽物が減るだけで、見えているものは消えない
+        if (clip0.w <= NearW || clip1.w <= NearW || clip2.w <= NearW) { return false; }
+
+        std::array<Math::Vector3, 3> pos = { ToScreen(clip0), ToScreen(clip1), ToScreen(clip2) };
+
+        // 辺の式が内側で正になるように、面積が正の向きにそろえる
+        float area = (pos[1].x - pos[0].x) * (pos[2].y - pos[0].y) - (pos[1].y - pos[0].y) * (pos[2].x - pos[0].x);
+        if (std::abs(area) < MinTriangleArea) { return false; }
+
+        if (area < 0.0f)
+        {
+            std::swap(pos[1], pos[2]);
+            area = -area;
+        }
+
+        //===============================
+        // 描くピクセルの範囲
+        //===============================
+        INT32 minX = 0, maxX = 0, minY = 0, maxY = 0;
+        ToPixelRange(std::min({ pos[0].x, pos[1].x, pos[2].x }), std::max({ pos[0].x, pos[1].x, pos[2].x }), Width, minX, maxX);
+        ToPixelRange(std::min({ pos[0].y, pos[1].y, pos[2].y }), std::max({ pos[0].y, pos[1].y, pos[2].y }), Height, minY, maxY);
+
+        // 画面の外 / ピクセルの中心を1つも含まない
+        if (minX > maxX || minY > maxY) { return false; }
+
+        //===============================
+        // 辺の式と深度の平面
+        //===============================
+        // 辺 i は頂点 i の向かいの辺 : 頂点 i での値が面積になるので、面積で割ると重心座標になる
+        const float invArea = 1.0f / area;
+        for (UINT32 i = 0; i < 3; ++i)
+        {
+            const Math::Vector3& a = pos[(i + 1) % 3];
+            const Math::Vector3& b = pos[(i + 2) % 3];
+
+            dst.EdgeA[i] = a.y - b.y;
+            dst.EdgeB[i] = b.x - a.x;
+            dst.EdgeC[i] = a.x * b.y - a.y * b.x;
+
+            dst.DepthA += dst.EdgeA[i] * pos[i].z * invArea;
+            dst.DepthB += dst.EdgeB[i] * pos[i].z * invArea;
+            dst.DepthC += dst.EdgeC[i] * pos[i].z * invArea;
+        }
+
+        // 4ピクセルずつ描くので、左端を4の倍数にそろえる
+        dst.MinX = minX & ~3;
+        dst.MaxX = maxX;
+        dst.MinY = minY;
+        dst.MaxY = maxY;
+
+        return true;
+    }
+
+    DepthBuffer::DepthBuffer()
+    {
+        for (UINT32 mip = 0; mip < MipNum; ++mip)
+        {
+            m_mips[mip].assign(GetMipWidth(mip) * GetMipHeight(mip), 0.0f);
+        }
+    }
+
+    void DepthBuffer::RenderBand(UINT32 bandIdx, std::span<const ScreenTriangle> triangles)
+    {
+        const INT32 bandMinY = static_cast<INT32>(bandIdx * BandHeight);
+        const INT32 bandMaxY = bandMinY + static_cast<INT32>(BandHeight) - 1;
+
+        float* pDepth = m_mips[0].data();
+        std::fill(pDepth + bandMinY * Width, pDepth + (bandMaxY + 1) * Width, 0.0f);
+
+        // 4ピクセルの中心の x のずれ
+        const __m128 laneOffset = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (const ScreenTriangle& tri : triangles)
+        {
+            if (!tri.IsValid() || tri.MaxY < bandMinY || tri.MinY > bandMaxY) { continue; }
+
+            const INT32 minY = std::max(tri.MinY, bandMinY);
+            const INT32 maxY = std::min(tri.MaxY, bandMaxY);
+
+            // 右に4ピクセル進んだ時の増分
+            const __m128 edgeStep0 = _mm_set1_ps(tri.EdgeA[0] * 4.0f);
+            const __m128 edgeStep1 = _mm_set1_ps(tri.EdgeA[1] * 4.0f);
+            const __m128 edgeStep2 = _mm_set1_ps(tri.EdgeA[2] * 4.0f);
+            const __m128 depthStep = _mm_set1_ps(tri.DepthA * 4.0f);
+
+            const __m128 startX = _mm_add_ps(_mm_set1_ps(static_cast<float>(tri.MinX)), laneOffset);
+            const __m128 edgeX0 = _mm_mul_ps(_mm_set1_ps(tri.EdgeA[0]), startX);
+            const __m128 edgeX1 = _mm_mul_ps(_mm_set1_ps(tri.EdgeA[1]), startX);
+            const __m128 edgeX2 = _mm_mul_ps(_mm_set1_ps(tri.EdgeA[2]), startX);
+            const __m128 depthX = _mm_mul_ps(_mm_set1_ps(tri.DepthA), startX);
+
+            for (INT32 y = minY; y <= maxY; ++y)
+            {
+                const float centerY = static_cast<float>(y) + 0.5f;
+
+                __m128 edge0 = _mm_add_ps(edgeX0, _mm_set1_ps(tri.EdgeB[0] * centerY + tri.EdgeC[0]));
+                __m128 edge1 = _mm_add_ps(edgeX1, _mm_set1_ps(tri.EdgeB[1] * centerY + tri.EdgeC[1]));
+                __m128 edge2 = _mm_add_ps(edgeX2, _mm_set1_ps(tri.EdgeB[2] * centerY + tri.EdgeC[2]));
+                __m128 depth = _mm_add_ps(depthX, _mm_set1_ps(tri.DepthB * centerY + tri.DepthC));
+
+                float* pRow = pDepth + y * Width;
+
+                for (INT32 x = tri.MinX; x <= tri.MaxX; x += 4)
+                {
+                    const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)),
+                        _mm_cmpge_ps(edge2, zero));
+
+                    if (_mm_movemask_ps(inside) != 0)
+                    {
+                        // 手前(1/w が大きい方)を残す
+                        const __m128 prev = _mm_loadu_ps(pRow + x);
+                        const __m128 nearest = _mm_max_ps(prev, depth);
+                        _mm_storeu_ps(pRow + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, prev)));
+                    }
+
+                    edge0 = _mm_add_ps(edge0, edgeStep0);
+                    edge1 = _mm_add_ps(edge1, edgeStep1);
+                    edge2 = _mm_add_ps(edge2, edgeStep2);
+                    depth = _mm_add_ps(depth, depthStep);
+                }
+            }
+        }
+
+        // 帯の行だけから作れる段は、ここで作る
+        for (UINT32 mip = 1; mip < BandMipNum; ++mip)
+        {
+            Downsample(mip, static_cast<UINT32>(bandMinY) >> mip, static_cast<UINT32>(bandMaxY + 1) >> mip);
+        }
+    }
+
+    void DepthBuffer::BuildHiZ()
+    {
+        for (UINT32 mip = BandMipNum; mip < MipNum; ++mip)
+        {
+            Downsample(mip, 0, GetMipHeight(mip));
+        }
+    }
+
+    void DepthBuffer::Downsample(UINT32 dstMip, UINT32 beginY, UINT32 endY)
+    {
+        const std::vector<float>& src = m_mips[dstMip - 1];
+        std::vector<float>& dst = m_mips[dstMip];
+
+        const UINT32 srcWidth = GetMipWidth(dstMip - 1);
+        const UINT32 srcHeight = GetMipHeight(dstMip - 1);
+        const UINT32 dstWidth = GetMipWidth(dstMip);
+
+        for (UINT32 y = beginY; y < endY; ++y)
+        {
+            // 縦か横がすでに 1 の場合は、同じ行 / 列を2回読む
+            const float* pRow0 = src.data() + (y * 2) * srcWidth;
+            const float* pRow1 = src.data() + std::min(y * 2 + 1, srcHeight - 1) * srcWidth;
+
+            for (UINT32 x = 0; x < dstWidth; ++x)
+            {
+                const UINT32 x0 = x * 2;
+                const UINT32 x1 = std::min(x0 + 1, srcWidth - 1);
+
+                // 一番奥(1/w が小さい方)を残す
+                dst[y * dstWidth + x] = std::min({ pRow0[x0], pRow0[x1], pRow1[x0], pRow1[x1] });
+            }
+        }
+    }
+
+    bool DepthBuffer::IsOccluded(const Math::Vector3& center, const Math::Vector3& extents) const
+    {
+        //===============================
+        // 8頂点を射影して、画面の矩形と一番手前の深度を求める
+        //===============================
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        float nearestDepth = 0.0f;
+
+        for (UINT32 i = 0; i < 8; ++i)
+        {
+            const Math::Vector4 corner = {
+                center.x + ((i & 1) ? extents.x : -extents.x),
+                center.y + ((i & 2) ? extents.y : -extents.y),
+                center.z + ((i & 4) ? extents.z : -extents.z),
+                1.0f
+            };
+
+            const Math::Vector4 clip = Math::Vector4::Transform(corner, m_mViewProj);
+
+            // カメラの近くにあるボックスは、隠れていても判定しない
+            if (clip.w <= NearW) { return false; }
+
+            const Math::Vector3 screen = ToScreen(clip);
+            minX = std::min(minX, screen.x);
+            minY = std::min(minY, screen.y);
+            maxX = std::max(maxX, screen.x);
+            maxY = std::max(maxY, screen.y);
+            nearestDepth = std::max(nearestDepth, screen.z);
+        }
+
+        // 画面の外にはみ出したボックスは、画面の中の部分だけで比べる
+        if (maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>(Width) || minY >= static_cast<float>(Height)) { return false; }
+
+        // 中心が矩形の両側の外に出るピクセルまで比べる
+        // 遮蔽物はピクセルの中心で描いているので、遮蔽物の縁と同じピクセルにはみ出したボックスも、縁の外のピクセルと比べられる
+        const INT32 x0 = static_cast<INT32>(std::floor(std::max(minX - 0.5f, 0.0f)));
+        const INT32 y0 = static_cast<INT32>(std::floor(std::max(minY - 0.5f, 0.0f)));
+        const INT32 x1 = static_cast<INT32>(std::ceil(std::min(maxX - 0.5f, static_cast<float>(Width - 1))));
+        const INT32 y1 = static_cast<INT32>(std::ceil(std::min(maxY - 0.5f, static_cast<float>(Height - 1))));
+
+        //===============================
+        // 矩形が 2x2 ピクセル以内に収まる段で比べる
+        //===============================
+        UINT32 mip = 0;
+        while (mip + 1 < MipNum && ((x1 >> mip) - (x0 >> mip) > 1 || (y1 >> mip) - (y0 >> mip) > 1))
+        {
+            ++mip;
+        }
+
+        const std::vector<float>& hiZ = m_mips[mip];
+        const UINT32 mipWidth = GetMipWidth(mip);
+
+        float farthestDepth = std::numeric_limits<float>::max();
+        for (INT32 y = y0 >> mip; y <= (y1 >> mip); ++y)
+        {
+            for (INT32 x = x0 >> mip; x <= (x1 >> mip); ++x)
+            {
+                farthestDepth = std::min(farthestDepth, hiZ[y * mipWidth + x]);
+            }
+        }
+
+        // ボックスの一番手前より、遮蔽物の一番奥の方が手前にあれば隠れている
+        return nearestDepth < farthestDepth;
+    }
+}
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+/**
+* @namespace OcclusionCulling
+* @brief CPU で描いた小さな深度バッファで、手前のモデルに隠れたボックスを判定する関数群
+* @details
+*   - 遮蔽物(オクルーダー)の三角形を、低解像度の深度バッファに SSE で4ピクセルずつ描く
+*   - 深度は 1/w で持つ : 画面上で線形に補間でき、射影行列の深度の向きに左右されない (大きいほど手前)
+*   - 深度バッファは BandHeight 行ごとの帯に分け、帯ごとに別のスレッドから描ける
+*   - 描いた後に、2x2 ピクセルの一番奥の深度を取った縮小バッファ(階層 Z)を作る
+*   - ボックスは8頂点を射影した画面の矩形と一番手前の深度で、矩形を覆う階層 Z の数ピクセルだけと比べる
+*   - 判定を誤って消さないように、迷う場合はすべて見えている扱いにする
+*     - 手前のクリップ面をまたぐ三角形は描かない / 手前のクリップ面をまたぐボックスは見えている
+*/
+namespace OcclusionCulling
+{
+    // 深度バッファのサイズ : 幅は4ピクセルずつ描くので4の倍数
+    static constexpr UINT32 Width = 256;
+    static constexpr UINT32 Height = 128;
+
+    // 1つの帯の行数 : 帯の中で縮小できる段数が決まる
+    static constexpr UINT32 BandHeight = 8;
+    static constexpr UINT32 BandNum = Height / BandHeight;
+
+    // 階層 Z の段数 : 1x1 まで縮小する
+    static constexpr UINT32 MipNum = std::bit_width(std::max(Width, Height));
+
+    // 帯の中だけで作れる段数 : 元の深度バッファを含む
+    static constexpr UINT32 BandMipNum = std::bit_width(BandHeight);
+
+    // これより手前の w は、手前のクリップ面をまたいでいる扱いにする
+    static constexpr float NearW = 1.0e-4f;
+
+    /* @brief 描画する三角形 : 画面のピクセル単位で、辺の式と深度の平面を先に計算しておく */
+    struct ScreenTriangle
+    {
+        // 辺の式 : EdgeA * x + EdgeB * y + EdgeC >= 0 が内側
+        std::array<float, 3> EdgeA;
+        std::array<float, 3> EdgeB;
+        std::array<float, 3> EdgeC;
+
+        // 1/w の平面 : DepthA * x + DepthB * y + DepthC
+        float DepthA = 0.0f;
+        float DepthB = 0.0f;
+        float DepthC = 0.0f;
+
+        // 描くピクセルの範囲 : MinY > MaxY なら描かない
+        INT32 MinX = 0;
+        INT32 MaxX = -1;
+        INT32 MinY = 0;
+        INT32 MaxY = -1;
+
+        bool IsValid() const { return MinY <= MaxY; }
+    };
+
+    /**
+    * @brief クリップ空間の3頂点から、描画する三角形を作る
+    * @details 表裏は区別しない : 片面だけのコリジョンメッシュでも裏から遮蔽する
+    * @return 描かなくて良い三角形なら false : dst は描かない三角形になる
+    */
+    bool SetupTriangle(const Math::Vector4& clip0, const Math::Vector4& clip1, const Math::Vector4& clip2, ScreenTriangle& dst);
+
+    /**
+    * @class DepthBuffer
+    * @brief 遮蔽物を描く深度バッファと階層 Z
+    */
+    class DepthBuffer
+    {
+    public:
+        DepthBuffer();
+
+        /* @brief 遮蔽物を描いたカメラ : IsOccluded でボックスの射影に使う */
+        void SetViewProj(const Math::Matrix& mViewProj) { m_mViewProj = mViewProj; }
+
+        /**
+        * @brief 1つの帯を消してから三角形を描き、帯の中の階層 Z を作る
+        * @details 帯ごとに別のスレッドから呼んで良い : 帯の行にしか書き込まない
+        */
+        void RenderBand(UINT32 bandIdx, std::span<const ScreenTriangle> triangles);
+
+        /* @brief すべての帯を描いた後に、帯をまたぐ階層 Z を作る */
+        void BuildHiZ();
+
+        /**
+        * @brief ワールド空間のボックスが遮蔽物に完全に隠れているか
+        * @details BuildHiZ の後なら、別のスレッドから同時に呼んで良い
+        */
+        bool IsOccluded(const Math::Vector3& center, const Math::Vector3& extents) const;
+
+        /* @brief 階層 Z の1段 : 行ごとに GetMipWidth 個の 1/w が並ぶ */
+        std::span<const float> GetMip(UINT32 mip) const { return m_mips[mip]; }
+
+        UINT32 GetMipWidth(UINT32 mip) const { return std::max(Width >> mip, 1u); }
+        UINT32 GetMipHeight(UINT32 mip) const { return std::max(Height >> mip, 1u); }
+
+    private:
+        /* @brief 1段縮小する : [beginY, endY) は縮小先の行 */
+        void Downsample(UINT32 dstMip, UINT32 beginY, UINT32 endY);
+
+        // [0] が描いた深度バッファ : 各ピクセルは 1/w で、何も描いていなければ 0
+        std::array<std::vector<float>, MipNum> m_mips;
+
+        Math::Matrix m_mViewProj;
+    };
+}
@@ -0,0 +1,150 @@
+﻿#include "FrameAllocator.h"
+
+void FrameAllocator::Init()
+{
+    // スレッドごとの領域を確保して、最初のページを用意しておく
+    m_threadArenas.Prepare();
+
+    m_threadArenas.ForEach([this](Arena& arena)
+        {
+            if (arena.Pages.empty())
+            {
+                AddPage(arena, DefaultPageSize);
+            }
+        });
+
+    // 初期化で確保した分は統計に含めない
+    Reset();
+    m_totalHeapAllocateNum = 0;
+}
+
+void FrameAllocator::Release()
+{
+    m_threadArenas.ForEach([](Arena& arena)
+        {
+            arena = Arena{};
+        });
+
+    m_externalArena = Arena{};
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t align)
+{
+    // JobSystem 以外のスレッドは領域を共有するので、ロックする
+    if (JobSystem::GetThreadIndex() == JobSystem::InvalidThreadIndex)
+    {
+        std::lock_guard<std::mutex> lock(m_externalMutex);
+        return AllocateFromArena(m_externalArena, size, align);
+    }
+
+    return AllocateFromArena(m_threadArenas.Work(), size, align);
+}
+
+void FrameAllocator::Reset()
+{
+    m_lastFrameUsedSize = 0;
+    m_lastFrameAllocateNum = 0;
+    m_lastFrameHeapAllocateNum = 0;
+
+    m_threadArenas.ForEach([this](Arena& arena)
+        {
+            ResetArena(arena);
+        });
+
+    std::lock_guard<std::mutex> lock(m_externalMutex);
+    ResetArena(m_externalArena);
+}
+
+size_t FrameAllocator::GetReservedSize() const
+{
+    size_t reservedSize = 0;
+
+    m_threadArenas.ForEach([&reservedSize](const Arena& arena)
+        {
+            for (const Page& page : arena.Pages)
+            {
+                reservedSize += page.Size;
+            }
+        });
+
+    for (const Page& page : m_externalArena.Pages)
+    {
+        reservedSize += page.Size;
+    }
+
+    return reservedSize;
+}
+
+void* FrameAllocator::AllocateFromArena(Arena& arena, size_t size, size_t align)
+{
+    if (size == 0) { size = 1; }
+
+    ++arena.AllocateNum;
+    arena.UsedSize += size;
+
+    while (true)
+    {
+        if (arena.PageIndex < arena.Pages.size())
+        {
+            Page& page = arena.Pages[arena.PageIndex];
+
+            // ページの先頭アドレスを基準にアライメントを合わせる
+            const uintptr_t base = reinterpret_cast<uintptr_t>(page.upData.get());
+            const uintptr_t alignedAddress = (base + arena.Offset + (align - 1)) & ~(static_cast<uintptr_t>(align) - 1);
+            const size_t alignedOffset = static_cast<size_t>(alignedAddress - base);
+
+            if (alignedOffset + size <= page.Size)
+            {
+                arena.Offset = alignedOffset + size;
+                return reinterpret_cast<void*>(alignedAddress);
+            }
+
+            // このページには収まらないので、次のページへ進む
+            ++arena.PageIndex;
+            arena.Offset = 0;
+            continue;
+        }
+
+        // ページが足りないので追加する : アライメントで詰める分も見込んでおく
+        AddPage(arena, std::max(DefaultPageSize, size + align));
+    }
+}
+
+void FrameAllocator::ResetArena(Arena& arena)
+{
+    m_lastFrameUsedSize += arena.UsedSize;
+    m_lastFrameAllocateNum += arena.AllocateNum;
+    m_lastFrameHeapAllocateNum += arena.HeapAllocateNum;
+
+    // 複数のページを使った場合は、次のフレームで1枚に収まるようにまとめ直す
+    if (arena.Pages.size() > 1)
+    {
+        size_t totalSize = 0;
+        for (const Page& page : arena.Pages)
+        {
+            totalSize += page.Size;
+        }
+
+        arena.Pages.clear();
+        AddPage(arena, totalSize);
+    }
+
+    arena.PageIndex = 0;
+    arena.Offset = 0;
+
+    arena.UsedSize = 0;
+    arena.AllocateNum = 0;
+    arena.HeapAllocateNum = 0;
+}
+
+void FrameAllocator::AddPage(Arena& arena, size_t size)
+{
+    Page page;
+    page.upData = std::make_unique_for_overwrite<std::byte[]>(size);
+    page.Size = size;
+
+    arena.Pages.emplace_back(std::move(page));
+
+    ++arena.HeapAllocateNum;
+    m_totalHeapAllocateNum.fetch_add(1, std::memory_order_relaxed);
+}
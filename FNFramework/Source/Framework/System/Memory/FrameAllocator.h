@@ -0,0 +1,159 @@
+﻿#pragma once
+
+/**
+* @class FrameAllocator
+* @brief 1フレームの間だけ使う一時的なメモリを確保するアロケーター
+* @details
+*   - ページの先頭から順に切り出すだけなので、確保は数命令で終わる
+*   - 個別の解放は行わず、フレームのはじめ(Application::PreUpdate)に Reset でまとめて巻き戻す
+*   - JobSystem のスレッドごとに領域を持つため、ワーカースレッドからもロックなしで確保できる
+*   - 1フレームで足りなかった場合は、次の Reset で1枚の大きなページにまとめ直す
+*     そのため、使用量が落ち着けばヒープからの確保は起こらなくなる
+*
+*   ※ 確保したメモリは次のフレームの Reset で無効になるので、フレームをまたいで保持してはいけない
+*/
+class FrameAllocator
+    : public utl::Singleton<FrameAllocator>
+{
+    friend class utl::Singleton<FrameAllocator>;
+
+public:
+    // 1ページの既定のサイズ
+    static constexpr size_t DefaultPageSize = 1024 * 1024;
+
+    //--------------------------------
+    // 初期化 / 解放
+    //--------------------------------
+    /* @brief 初期化 : JobSystem の初期化後に呼ぶ */
+    void Init();
+
+    /* @brief 解放 : 確保したページをすべて返却する */
+    void Release();
+
+    //--------------------------------
+    // 確保 / リセット
+    //--------------------------------
+    /**
+    * @brief メモリの確保
+    * @param[in] size  - 確保するサイズ
+    * @param[in] align - アライメント
+    * @return 確保したメモリ : 次の Reset まで有効
+    */
+    void* Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    /* @brief フレームのはじめに呼び、すべての確保を巻き戻す : 並列処理中に呼んではいけない */
+    void Reset();
+
+    //--------------------------------
+    // ゲッター : デバッグ表示用
+    //--------------------------------
+    /* @brief 前のフレームで確保したサイズ */
+    size_t GetLastFrameUsedSize() const { return m_lastFrameUsedSize; }
+
+    /* @brief 前のフレームで確保した回数 */
+    UINT64 GetLastFrameAllocateNum() const { return m_lastFrameAllocateNum; }
+
+    /* @brief 前のフレームでページのためにヒープから確保した回数 : 使用量が落ち着いていれば 0 になる */
+    UINT64 GetLastFrameHeapAllocateNum() const { return m_lastFrameHeapAllocateNum; }
+
+    /* @brief ページのためにヒープから確保した総数 */
+    UINT64 GetTotalHeapAllocateNum() const { return m_totalHeapAllocateNum.load(std::memory_order_relaxed); }
+
+    /* @brief 全スレッドで確保しているページの総サイズ */
+    size_t GetReservedSize() const;
+
+private:
+    FrameAllocator()
+    {
+    }
+
+    ~FrameAllocator() override
+    {
+        Release();
+    }
+
+    struct Page
+    {
+        std::unique_ptr<std::byte[]> upData;
+        size_t Size = 0;
+    };
+
+    /* @brief スレッドごとの領域 */
+    struct Arena
+    {
+        std::vector<Page> Pages;
+
+        // 現在切り出しているページと、その中の位置
+        size_t PageIndex = 0;
+        size_t Offset = 0;
+
+        //x--- 今のフレームの統計 ---x//
+        size_t UsedSize = 0;
+        UINT64 AllocateNum = 0;
+        UINT64 HeapAllocateNum = 0;
+    };
+
+    /* @brief 領域から切り出す : 足りない場合は新しいページを追加する */
+    void* AllocateFromArena(Arena& arena, size_t size, size_t align);
+
+    /* @brief 領域の巻き戻し : 複数のページを使った場合は1枚にまとめ直す */
+    void ResetArena(Arena& arena);
+
+    /* @brief ページをヒープから確保して追加する */
+    void AddPage(Arena& arena, size_t size);
+
+    // JobSystem のスレッドごとの領域
+    utl::PerThread<Arena> m_threadArenas;
+
+    // JobSystem 以外のスレッドから呼ばれた場合の領域 : ロックして使う
+    Arena m_externalArena;
+    std::mutex m_externalMutex;
+
+    //x--- 前のフレームの統計 ---x//
+    size_t m_lastFrameUsedSize = 0;
+    UINT64 m_lastFrameAllocateNum = 0;
+    UINT64 m_lastFrameHeapAllocateNum = 0;
+    // ワーカースレッドからも加算される
+    std::atomic<UINT64> m_totalHeapAllocateNum = 0;
+};
+
+namespace utl
+{
+    /**
+    * @class FrameStlAllocator
+    * @brief FrameAllocator から確保する STL コンテナ用のアロケーター
+    * @details
+    *   解放は何もしないので、要素数が分かっている場合は reserve しておくと無駄が少ない
+    *   ※ このアロケーターを使ったコンテナは、そのフレームの中だけで使う
+    */
+    template <typename T>
+    class FrameStlAllocator
+    {
+    public:
+        using value_type = T;
+
+        FrameStlAllocator() noexcept = default;
+
+        template <typename U>
+        FrameStlAllocator(const FrameStlAllocator<U>&) noexcept
+        {
+        }
+
+        T* allocate(size_t num)
+        {
+            return static_cast<T*>(FrameAllocator::Instance().Allocate(num * sizeof(T), alignof(T)));
+        }
+
+        // まとめて巻き戻すので、個別には解放しない
+        void deallocate(T*, size_t) noexcept
+        {
+        }
+
+        template <typename U>
+        bool operator==(const FrameStlAllocator<U>&) const noexcept { return true; }
+    };
+
+    // FrameAllocator から確保する vector : 1フレームの中だけで使う一時的な配列に使う
+    template <typename T>
+    using FrameVector = std::vector<T, FrameStlAllocator<T>>;
+}
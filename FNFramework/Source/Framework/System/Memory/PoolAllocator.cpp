@@ -0,0 +1,250 @@
+﻿#include "PoolAllocator.h"
+
+namespace utl
+{
+    //==================================
+    // FixedBlockPool
+    //==================================
+    FixedBlockPool::FixedBlockPool(size_t blockSize, size_t blockAlign, size_t blocksPerChunk)
+        : m_blockAlign(std::max(blockAlign, alignof(FreeBlock)))
+        , m_blocksPerChunk(std::max<size_t>(1, blocksPerChunk))
+    {
+        // 空きリストのポインタを書き込めるサイズにし、アライメントの倍数に切り上げる
+        const size_t size = std::max(blockSize, sizeof(FreeBlock));
+        m_blockSize = (size + m_blockAlign - 1) / m_blockAlign * m_blockAlign;
+    }
+
+    void* FixedBlockPool::Allocate()
+    {
+        if (!m_pFreeHead)
+        {
+            AddChunk();
+        }
+
+        FreeBlock* pBlock = m_pFreeHead;
+        m_pFreeHead = pBlock->pNext;
+
+        ++m_usedBlockNum;
+
+        return pBlock;
+    }
+
+    void FixedBlockPool::Deallocate(void* pBlock)
+    {
+        if (!pBlock) { return; }
+
+        FreeBlock* pFree = static_cast<FreeBlock*>(pBlock);
+        pFree->pNext = m_pFreeHead;
+        m_pFreeHead = pFree;
+
+        --m_usedBlockNum;
+    }
+
+    void FixedBlockPool::AddChunk()
+    {
+        // 先頭をアライメントに合わせる分だけ多めに確保する
+        auto upChunk = std::make_unique_for_overwrite<std::byte[]>(m_blockSize * m_blocksPerChunk + m_blockAlign);
+
+        const uintptr_t base = reinterpret_cast<uintptr_t>(upChunk.get());
+        std::byte* pFirst = reinterpret_cast<std::byte*>((base + m_blockAlign - 1) & ~(static_cast<uintptr_t>(m_blockAlign) - 1));
+
+        // 先頭のブロックから順に確保されるように、後ろからつないでいく
+        for (size_t i = m_blocksPerChunk; i > 0; --i)
+        {
+            FreeBlock* pFree = reinterpret_cast<FreeBlock*>(pFirst + (i - 1) * m_blockSize);
+            pFree->pNext = m_pFreeHead;
+            m_pFreeHead = pFree;
+        }
+
+        m_upChunks.emplace_back(std::move(upChunk));
+    }
+
+    //==================================
+    // PoolArena
+    //==================================
+    PoolArena::PoolArena()
+    {
+        m_threadCaches.Prepare();
+    }
+
+    void* PoolArena::Allocate(UINT32 poolIndex, size_t size, size_t align)
+    {
+        ThreadCache* pCache = m_threadCaches.Find();
+
+        // スレッドごとの空きリストを持たないスレッドは、ロックしてプールから確保する
+        if (!pCache)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            FixedBlockPool& pool = WorkPool(poolIndex, size, align);
+
+            // 配列などでブロックに収まらない場合は、プールを使わずに確保する
+            if (size > pool.GetBlockSize() || align > pool.GetBlockAlign())
+            {
+                return ::operator new(size, std::align_val_t{ align });
+            }
+
+            return pool.Allocate();
+        }
+
+        ThreadPool& threadPool = WorkThreadPool(*pCache, poolIndex, size, align);
+
+        if (size > threadPool.BlockSize || align > threadPool.BlockAlign)
+        {
+            return ::operator new(size, std::align_val_t{ align });
+        }
+
+        // 空きリストが空の場合だけ、ロックしてプールからまとめて受け取る
+        if (threadPool.Blocks.empty())
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            FixedBlockPool& pool = *m_upPools[poolIndex];
+            for (size_t i = 0; i < BlocksPerBatch; ++i)
+            {
+                threadPool.Blocks.push_back(pool.Allocate());
+            }
+        }
+
+        void* pBlock = threadPool.Blocks.back();
+        threadPool.Blocks.pop_back();
+
+        return pBlock;
+    }
+
+    void PoolArena::Deallocate(UINT32 poolIndex, void* p, size_t size, size_t align)
+    {
+        if (ThreadCache* pCache = m_threadCaches.Find())
+        {
+            ThreadPool& threadPool = WorkThreadPool(*pCache, poolIndex, size, align);
+
+            if (size > threadPool.BlockSize || align > threadPool.BlockAlign)
+            {
+                ::operator delete(p, std::align_val_t{ align });
+                return;
+            }
+
+            // 別のスレッドで確保したブロックでも、解放したスレッドの空きリストに戻す
+            threadPool.Blocks.push_back(p);
+
+            // 溜まりすぎた場合は、ロックしてプールへまとめて返す
+            if (threadPool.Blocks.size() > BlocksPerBatch * 2)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                FixedBlockPool& pool = *m_upPools[poolIndex];
+                for (size_t i = 0; i < BlocksPerBatch; ++i)
+                {
+                    pool.Deallocate(threadPool.Blocks.back());
+                    threadPool.Blocks.pop_back();
+                }
+            }
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        FixedBlockPool* pPool = poolIndex < m_upPools.size() ? m_upPools[poolIndex].get() : nullptr;
+
+        // 確保した時と同じ判定で、プールを使ったかを判断する
+        if (!pPool || size > pPool->GetBlockSize() || align > pPool->GetBlockAlign())
+        {
+            ::operator delete(p, std::align_val_t{ align });
+            return;
+        }
+
+        pPool->Deallocate(p);
+    }
+
+    size_t PoolArena::GetUsedSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t usedSize = 0;
+        for (const std::unique_ptr<FixedBlockPool>& upPool : m_upPools)
+        {
+            if (!upPool) { continue; }
+            usedSize += upPool->GetUsedBlockNum() * upPool->GetBlockSize();
+        }
+
+        // スレッドごとの空きリストにあるブロックは、プールからは使用中に見えるので除く
+        m_threadCaches.ForEach([&usedSize](const ThreadCache& cache)
+            {
+                for (const ThreadPool& threadPool : cache)
+                {
+                    usedSize -= threadPool.Blocks.size() * threadPool.BlockSize;
+                }
+            });
+
+        return usedSize;
+    }
+
+    size_t PoolArena::GetReservedSize() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t reservedSize = 0;
+        for (const std::unique_ptr<FixedBlockPool>& upPool : m_upPools)
+        {
+            if (!upPool) { continue; }
+            reservedSize += upPool->GetCapacityBlockNum() * upPool->GetBlockSize();
+        }
+
+        return reservedSize;
+    }
+
+    size_t PoolArena::GetChunkNum() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        size_t chunkNum = 0;
+        for (const std::unique_ptr<FixedBlockPool>& upPool : m_upPools)
+        {
+            if (!upPool) { continue; }
+            chunkNum += upPool->GetChunkNum();
+        }
+
+        return chunkNum;
+    }
+
+    FixedBlockPool& PoolArena::WorkPool(UINT32 poolIndex, size_t size, size_t align)
+    {
+        if (poolIndex >= m_upPools.size())
+        {
+            m_upPools.resize(poolIndex + 1);
+        }
+
+        std::unique_ptr<FixedBlockPool>& upPool = m_upPools[poolIndex];
+
+        if (!upPool)
+        {
+            upPool = std::make_unique<FixedBlockPool>(size, align, BlocksPerChunk);
+        }
+
+        return *upPool;
+    }
+
+    PoolArena::ThreadPool& PoolArena::WorkThreadPool(ThreadCache& cache, UINT32 poolIndex, size_t size, size_t align)
+    {
+        // スレッドごとの配列なので、ロックせずに伸ばして良い
+        if (poolIndex >= cache.size())
+        {
+            cache.resize(poolIndex + 1);
+        }
+
+        ThreadPool& threadPool = cache[poolIndex];
+
+        // 初めて使うプールは、ロックしてブロックの大きさを写しておく : 以降はプールを参照せずに判定できる
+        if (threadPool.BlockSize == 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            const FixedBlockPool& pool = WorkPool(poolIndex, size, align);
+            threadPool.BlockSize = pool.GetBlockSize();
+            threadPool.BlockAlign = pool.GetBlockAlign();
+            threadPool.Blocks.reserve(BlocksPerBatch * 2 + 1);
+        }
+
+        return threadPool;
+    }
+}
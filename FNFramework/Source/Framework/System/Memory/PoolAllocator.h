@@ -0,0 +1,186 @@
+﻿#pragma once
+
+namespace utl
+{
+    /**
+    * @class FixedBlockPool
+    * @brief 同じサイズのブロックをチャンク単位でまとめて確保し、使い回すプール
+    * @details
+    *   - 1つのチャンクにブロックが隙間なく並ぶため、同じ型のオブジェクトが連続したメモリに配置される
+    *   - 解放されたブロックは空きリストに戻すだけで、チャンクはプールの破棄時にまとめて返却する
+    */
+    class FixedBlockPool
+    {
+    public:
+        /**
+        * @brief コンストラクタ
+        * @param[in] blockSize      - 1ブロックのサイズ
+        * @param[in] blockAlign     - 1ブロックのアライメント
+        * @param[in] blocksPerChunk - 1チャンクに並べるブロック数
+        */
+        FixedBlockPool(size_t blockSize, size_t blockAlign, size_t blocksPerChunk);
+
+        /* @brief ブロックを1つ確保する */
+        void* Allocate();
+
+        /* @brief ブロックを空きリストに戻す */
+        void Deallocate(void* pBlock);
+
+        //--------------------------------
+        // ゲッター
+        //--------------------------------
+        size_t GetBlockSize() const { return m_blockSize; }
+        size_t GetBlockAlign() const { return m_blockAlign; }
+
+        /* @brief 使用中のブロック数 */
+        size_t GetUsedBlockNum() const { return m_usedBlockNum; }
+        /* @brief 確保済みのブロック数 */
+        size_t GetCapacityBlockNum() const { return m_upChunks.size() * m_blocksPerChunk; }
+        /* @brief 確保済みのチャンク数 : ヒープから確保した回数と同じ */
+        size_t GetChunkNum() const { return m_upChunks.size(); }
+
+    private:
+        // 空きブロックの先頭に次の空きブロックへのポインタを書き込んでつなぐ
+        struct FreeBlock
+        {
+            FreeBlock* pNext = nullptr;
+        };
+
+        /* @brief チャンクを追加して、ブロックを空きリストにつなぐ */
+        void AddChunk();
+
+        size_t m_blockSize = 0;
+        size_t m_blockAlign = 0;
+        size_t m_blocksPerChunk = 0;
+
+        std::vector<std::unique_ptr<std::byte[]>> m_upChunks;
+
+        FreeBlock* m_pFreeHead = nullptr;
+        size_t m_usedBlockNum = 0;
+    };
+
+    /**
+    * @class PoolArena
+    * @brief 種類ごとの FixedBlockPool をまとめて持つ領域
+    * @details
+    *   - プールの番号ごとに別のチャンクを使うので、種類の違うオブジェクトが混ざらない
+    *   - プールは初めて確保する時に、その時のサイズで作成する
+    *   - JobSystem のスレッドごとに空きブロックのリストを持ち、確保 / 解放は通常ロックなしで行う
+    *     リストが空になった時と溜まりすぎた時だけ、ロックしてプールと BlocksPerBatch 個ずつ受け渡す
+    *   - JobSystem 以外のスレッドや、作成後に増えたスレッドからはロックしてプールを直接使う
+    *     どちらの場合も、確保したスレッドと別のスレッドから解放して良い
+    *
+    *   ※ 破棄時に返却するのはチャンク単位だが、中のオブジェクトの破棄はまとめて行えない
+    *     shared_ptr ごとにデストラクタと解放が1回ずつ呼ばれるので、シーンの破棄はオブジェクト数に比例する
+    */
+    class PoolArena
+    {
+    public:
+        // 1チャンクに並べるブロック数
+        static constexpr size_t BlocksPerChunk = 64;
+
+        // スレッドごとの空きリストとプールの間で、1回に受け渡すブロック数
+        static constexpr size_t BlocksPerBatch = 32;
+
+        /* @brief コンストラクタ : JobSystem の初期化後に作成したものだけがスレッドごとの空きリストを使う */
+        PoolArena();
+
+        /**
+        * @brief 確保
+        * @param[in] poolIndex - プールの番号
+        * @param[in] size      - 確保するサイズ
+        * @param[in] align     - アライメント
+        */
+        void* Allocate(UINT32 poolIndex, size_t size, size_t align);
+
+        /* @brief 解放 : 確保した時と同じ引数を渡す */
+        void Deallocate(UINT32 poolIndex, void* p, size_t size, size_t align);
+
+        //--------------------------------
+        // ゲッター : デバッグ表示用 : 並列処理中に呼んではいけない
+        //--------------------------------
+        /* @brief 使用中のブロックの総サイズ : スレッドごとの空きリストにあるブロックは含まない */
+        size_t GetUsedSize() const;
+        /* @brief 確保済みのチャンクの総サイズ : 使用中のサイズとの差が空きブロックの分になる */
+        size_t GetReservedSize() const;
+        /* @brief 確保済みのチャンクの総数 */
+        size_t GetChunkNum() const;
+
+    private:
+        /* @brief 1つのスレッドが持つ、1つのプールの空きブロック */
+        struct ThreadPool
+        {
+            std::vector<void*> Blocks;
+
+            // プールのブロックの大きさ : 0 の場合はまだプールと結び付いていない
+            size_t BlockSize = 0;
+            size_t BlockAlign = 0;
+        };
+
+        // 1つのスレッドが持つ空きブロック : 添え字がプールの番号
+        using ThreadCache = std::vector<ThreadPool>;
+
+        /* @brief プールの取得 : 無ければ作成する : ロックしてから呼ぶ */
+        FixedBlockPool& WorkPool(UINT32 poolIndex, size_t size, size_t align);
+
+        /* @brief スレッドの空きブロックの取得 : プールと結び付いていなければロックして結び付ける */
+        ThreadPool& WorkThreadPool(ThreadCache& cache, UINT32 poolIndex, size_t size, size_t align);
+
+        std::vector<std::unique_ptr<FixedBlockPool>> m_upPools;
+
+        // JobSystem のスレッドごとの空きブロック
+        PerThread<ThreadCache> m_threadCaches;
+
+        mutable std::mutex m_mutex;
+    };
+
+    /**
+    * @class PoolAllocator
+    * @brief PoolArena から確保する STL 用のアロケーター
+    * @details
+    *   std::allocate_shared に渡すと、オブジェクトと参照カウントを1つのブロックにまとめてプールから確保する
+    *   アロケーターは PoolArena を shared_ptr で持つため、weak_ptr が残っている間は PoolArena も破棄されない
+    */
+    template <typename T>
+    class PoolAllocator
+    {
+        template <typename U>
+        friend class PoolAllocator;
+
+    public:
+        using value_type = T;
+
+        PoolAllocator(const std::shared_ptr<PoolArena>& spArena, UINT32 poolIndex) noexcept
+            : m_spArena(spArena)
+            , m_poolIndex(poolIndex)
+        {
+        }
+
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>& other) noexcept
+            : m_spArena(other.m_spArena)
+            , m_poolIndex(other.m_poolIndex)
+        {
+        }
+
+        T* allocate(size_t num)
+        {
+            return static_cast<T*>(m_spArena->Allocate(m_poolIndex, num * sizeof(T), alignof(T)));
+        }
+
+        void deallocate(T* p, size_t num) noexcept
+        {
+            m_spArena->Deallocate(m_poolIndex, p, num * sizeof(T), alignof(T));
+        }
+
+        template <typename U>
+        bool operator==(const PoolAllocator<U>& other) const noexcept
+        {
+            return m_spArena == other.m_spArena && m_poolIndex == other.m_poolIndex;
+        }
+
+    private:
+        std::shared_ptr<PoolArena> m_spArena;
+        UINT32 m_poolIndex = 0;
+    };
+}
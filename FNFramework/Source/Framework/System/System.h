@@ -12,6 +12,15 @@
 #include "Framework/System/Utility/Singleton.h"
 // 簡易ステートマシンクラス
 #include "Framework/System/Utility/StateMachine.h"
+// 世代番号付きハンドルで管理するコンテナ
+#include "Framework/System/Utility/SlotMap.h"
+// ワークスティーリング方式のジョブシステム
+#include "Framework/System/Job/JobSystem.h"
+#include "Framework/System/Job/PerThread.h"
+// 1フレームだけ使う一時メモリのアロケーター
+#include "Framework/System/Memory/FrameAllocator.h"
+// 同じサイズのブロックを使い回すプールアロケーター
+#include "Framework/System/Memory/PoolAllocator.h"
 
 //======================
 // Helper
@@ -42,9 +51,25 @@
 // 時間計測クラス
 #include "Framework/System/Math/Timer/Timer.h"
 
+// 視錐台カリング
+#include "Framework/System/Math/Culling/FrustumCulling.h"
+// 空間分割
+#include "Framework/System/Math/Culling/DynamicAABBTree.h"
+// 遮蔽カリング
+#include "Framework/System/Math/Culling/OcclusionCulling.h"
+// ライトのクラスター
+#include "Framework/System/Math/Culling/LightCluster.h"
+
 //======================
 // 描画関係
-//======================// デバイス
+//======================
+// GPU に送っておけるフレームの管理
+#include "Framework/Graphics/Frame/FrameContextRing.h"
+#include "Framework/Graphics/Frame/QueueFence.h"
+// 1フレームだけ GPU に読ませるデータのアロケーター
+#include "Framework/Graphics/Frame/FrameUploadAllocator.h"
+#include "Framework/Graphics/Frame/UploadPage.h"
+// デバイス
 #include "Framework/Graphics/GraphicsDevice.h"
 // ヒープ
 #include "Framework/Graphics/Heap/Heap.h"
@@ -52,9 +77,13 @@
 #include "Framework/Graphics/Heap/CBVSRVUAVHeap/CBVSRVUAVHeap.h"
 #include "Framework/Graphics/Heap/DSVHeap/DSVHeap.h"
 // 定数バッファのアロケーター
+#include "Framework/Graphics/Buffer/CBufferAllocater/ConstantUploadCache.h"
 #include "Framework/Graphics/Buffer/CBufferAllocater/CBufferAllocater.h"
 // 定数バッファラッピング
 #include "Framework/Graphics/Buffer/CBufferAllocater/CBufferData/Constantbuffer.h"
+// カスケードシャドウマップの計算 : ライトの定数バッファがカスケードの数を使う
+#include "Framework/Manager/Shader/ShadowShader/ShadowCascade.h"
+#include "Framework/Manager/Shader/ShadowShader/ShadowCacheTracker.h"
 // 定数バッファデータ
 #include "Framework/Graphics/Buffer/CBufferAllocater/CBufferData/CBufferData.h"
 // デプスステンシル
@@ -66,7 +95,11 @@
 // メッシュ
 #include "Framework/Graphics/Shape/Mesh/Mesh.h"
 #include "Framework/Graphics/Shape/Mesh/SpriteMesh.h"
+#include "Framework/Graphics/Shape/Mesh/MeshSimplifier.h"
+#include "Framework/Graphics/Shape/Mesh/MeshOptimizer.h"
+#include "Framework/Graphics/Shape/Mesh/MeshCluster.h"
 // モデル
+#include "Framework/Graphics/Model/ModelLOD/ModelLOD.h"
 #include "Framework/Graphics/Model/ModelData/Model.h"
 #include "Framework/Graphics/Model/Animation/Animation.h"
 
@@ -88,6 +121,11 @@
 // Manager
 //======================
 
+//------------
+// Culling
+//------------
+// 視錐台カリング
+#include "Application/System/CullingSystem/CullingSystem.h"
 //------------
 // Scene
 //------------
@@ -102,6 +140,10 @@
 //------------
 // Renderer
 //------------
+// 描画キュー
+#include "Application/System/Renderer/RenderQueue.h"
+// スキンメッシュのボーン行列
+#include "Application/System/Renderer/SkinningPalette.h"
 // 描画クラス
 #include "Application/System/Renderer/Renderer.h"
 
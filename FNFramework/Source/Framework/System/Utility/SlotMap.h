@@ -0,0 +1,240 @@
+﻿#pragma once
+
+namespace utl
+{
+    /**
+    * @struct SlotHandle
+    * @brief SlotMap の要素を参照するためのハンドル
+    * @details
+    *   - Index      : SlotMap 内のスロット番号
+    *   - Generation : スロットが再利用されるたびに進む世代番号
+    *   要素が削除されると世代番号が進むため、古いハンドルは自動的に無効になる
+    *
+    * @tparam Tag - ハンドルの種類を区別するための型 : 別の SlotMap のハンドルと混ざらないようにする
+    */
+    template <typename Tag>
+    struct SlotHandle
+    {
+        static constexpr UINT32 InvalidIndex = UINT32_MAX;
+
+        UINT32 Index = InvalidIndex;
+        UINT32 Generation = 0;
+
+        /* @brief 何も指していないハンドルかどうか */
+        bool IsNull() const { return Index == InvalidIndex; }
+
+        /* @brief 何も指していない状態にする */
+        void Reset() { *this = SlotHandle{}; }
+
+        bool operator==(const SlotHandle&) const = default;
+    };
+
+    /**
+    * @class SlotMap
+    * @brief 世代番号付きハンドルで要素を管理するコンテナ
+    * @details
+    *   - 要素は m_dense に隙間なく並んでいるため、全要素の走査はキャッシュ効率が良い
+    *   - ハンドル -> 要素 の解決は スロット参照 + 世代番号比較 のみで行える
+    *   - 削除は挿入順を保ったまま詰めるため、走査順が変わらない
+    *
+    * @tparam T   - 格納する要素の型
+    * @tparam Tag - ハンドルの種類を区別するための型
+    */
+    template <typename T, typename Tag = T>
+    class SlotMap
+    {
+    public:
+        using Handle = SlotHandle<Tag>;
+
+        //--------------------------------
+        // 追加 / 削除
+        //--------------------------------
+        /**
+        * @brief 要素の追加
+        * @param value - 追加する要素
+        * @return 追加した要素を指すハンドル
+        */
+        Handle Insert(T value)
+        {
+            UINT32 slotIndex = 0;
+
+            // 空いているスロットがあれば再利用する
+            if (m_freeHead != Handle::InvalidIndex)
+            {
+                slotIndex = m_freeHead;
+                m_freeHead = m_slots[slotIndex].DenseIndex;
+            }
+            else
+            {
+                slotIndex = static_cast<UINT32>(m_slots.size());
+                m_slots.push_back(Slot{ Handle::InvalidIndex, 1 });
+            }
+
+            Slot& slot = m_slots[slotIndex];
+            slot.DenseIndex = static_cast<UINT32>(m_dense.size());
+
+            m_dense.push_back(std::move(value));
+            m_denseToSlot.push_back(slotIndex);
+
+            return Handle{ slotIndex, slot.Generation };
+        }
+
+        /**
+        * @brief 要素の削除 : 後ろの要素を詰めるため O(N)
+        * @param handle - 削除したい要素のハンドル
+        * @return 削除できたら true
+        */
+        bool Erase(Handle handle)
+        {
+            if (!IsValid(handle)) { return false; }
+
+            const UINT32 denseIndex = m_slots[handle.Index].DenseIndex;
+
+            // 要素の破棄中にこのコンテナが参照されても良いように、先に取り出しておく
+            T removed = std::move(m_dense[denseIndex]);
+
+            m_dense.erase(m_dense.begin() + denseIndex);
+            m_denseToSlot.erase(m_denseToSlot.begin() + denseIndex);
+
+            ReleaseSlot(handle.Index);
+
+            // 詰めた分のスロットの参照先を更新
+            for (UINT32 i = denseIndex; i < m_denseToSlot.size(); ++i)
+            {
+                m_slots[m_denseToSlot[i]].DenseIndex = i;
+            }
+
+            return true;
+        }
+
+        /**
+        * @brief 条件に一致する要素をまとめて削除する : 1回の走査で詰めるため O(N)
+        * @param pred     - 削除する要素なら true を返す関数 : bool(const T&)
+        * @param pRemoved - 削除した要素の受け取り先 : nullptr の場合はこの関数内で破棄する
+        * @return 削除した要素数
+        * @tparam RemovedContainer - 受け取り先の型 : push_back できる T の配列
+        */
+        template <typename Pred, typename RemovedContainer = std::vector<T>>
+        size_t EraseIf(Pred pred, RemovedContainer* pRemoved = nullptr)
+        {
+            RemovedContainer removed;
+            RemovedContainer& removedRef = pRemoved ? *pRemoved : removed;
+
+            const size_t removedBegin = removedRef.size();
+
+            UINT32 writeIndex = 0;
+            for (UINT32 readIndex = 0; readIndex < m_dense.size(); ++readIndex)
+            {
+                if (pred(std::as_const(m_dense[readIndex])))
+                {
+                    removedRef.push_back(std::move(m_dense[readIndex]));
+                    ReleaseSlot(m_denseToSlot[readIndex]);
+                    continue;
+                }
+
+                if (writeIndex != readIndex)
+                {
+                    m_dense[writeIndex] = std::move(m_dense[readIndex]);
+                    m_denseToSlot[writeIndex] = m_denseToSlot[readIndex];
+                }
+
+                m_slots[m_denseToSlot[writeIndex]].DenseIndex = writeIndex;
+                ++writeIndex;
+            }
+
+            m_dense.resize(writeIndex);
+            m_denseToSlot.resize(writeIndex);
+
+            // 管理情報を更新し終えてから破棄する
+            return removedRef.size() - removedBegin;
+        }
+
+        /* @brief 全要素の削除 : 既存のハンドルはすべて無効になる */
+        void Clear()
+        {
+            // 要素の破棄中にこのコンテナが参照されても良いように、先に取り出しておく
+            std::vector<T> removed = std::move(m_dense);
+            m_dense.clear();
+
+            for (UINT32 slotIndex : m_denseToSlot)
+            {
+                ReleaseSlot(slotIndex);
+            }
+            m_denseToSlot.clear();
+        }
+
+        //--------------------------------
+        // 参照
+        //--------------------------------
+        /* @brief ハンドルが有効な要素を指しているか */
+        bool IsValid(Handle handle) const
+        {
+            // 削除時に世代が進むので、世代が一致していれば使用中のスロット
+            return handle.Index < m_slots.size() &&
+                m_slots[handle.Index].Generation == handle.Generation;
+        }
+
+        /* @brief ハンドルから要素の取得 @return 無効なハンドルの場合は nullptr */
+        T* Get(Handle handle)
+        {
+            if (!IsValid(handle)) { return nullptr; }
+            return &m_dense[m_slots[handle.Index].DenseIndex];
+        }
+
+        const T* Get(Handle handle) const
+        {
+            if (!IsValid(handle)) { return nullptr; }
+            return &m_dense[m_slots[handle.Index].DenseIndex];
+        }
+
+        /* @brief 並び順の番号からハンドルを取得 */
+        Handle GetHandle(size_t denseIndex) const
+        {
+            const UINT32 slotIndex = m_denseToSlot[denseIndex];
+            return Handle{ slotIndex, m_slots[slotIndex].Generation };
+        }
+
+        size_t Size() const { return m_dense.size(); }
+        bool Empty() const { return m_dense.empty(); }
+
+        /* @brief 要素が隙間なく並んだ配列 : 走査用 */
+        const std::vector<T>& GetDense() const { return m_dense; }
+
+        T& operator[](size_t denseIndex) { return m_dense[denseIndex]; }
+        const T& operator[](size_t denseIndex) const { return m_dense[denseIndex]; }
+
+        auto begin() { return m_dense.begin(); }
+        auto end() { return m_dense.end(); }
+        auto begin() const { return m_dense.begin(); }
+        auto end() const { return m_dense.end(); }
+
+    private:
+        struct Slot
+        {
+            // 使用中 : m_dense 内の位置 / 未使用 : 次の空きスロット番号
+            UINT32 DenseIndex = Handle::InvalidIndex;
+            // 世代番号 : 0 は未使用のハンドルと区別するため使わない
+            UINT32 Generation = 1;
+        };
+
+        /* @brief スロットを空きリストに戻す */
+        void ReleaseSlot(UINT32 slotIndex)
+        {
+            Slot& slot = m_slots[slotIndex];
+
+            // 世代を進めて古いハンドルを無効にする
+            ++slot.Generation;
+            if (slot.Generation == 0) { slot.Generation = 1; }
+
+            slot.DenseIndex = m_freeHead;
+            m_freeHead = slotIndex;
+        }
+
+        std::vector<T> m_dense;
+        std::vector<UINT32> m_denseToSlot;
+        std::vector<Slot> m_slots;
+
+        // 空きスロットの先頭 : Slot::DenseIndex でつながっている
+        UINT32 m_freeHead = Handle::InvalidIndex;
+    };
+}
@@ -74,6 +74,25 @@ namespace utl
             p = nullptr;
         }
     }
+
+    /**
+    * @brief バイト列のハッシュ値(FNV-1a 64bit)を計算する
+    * @param pData - データの先頭
+    * @param size  - データのサイズ
+    */
+    inline UINT64 HashBytes(const void* pData, size_t size)
+    {
+        const unsigned char* pBytes = static_cast<const unsigned char*>(pData);
+
+        UINT64 hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= pBytes[i];
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
 }
 
 // c++20では char8_t という型が用意されているためchar8_t->char*として利用するには変換が必要
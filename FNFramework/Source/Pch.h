@@ -26,6 +26,7 @@
 #include <string>
 #include <string_view>
 #include <array>
+#include <span>
 #include <vector>
 #include <stack>
 #include <list>
@@ -40,11 +41,13 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <condition_variable>
 #include <future>
 #include <fileSystem>
 #include <chrono>
 #include <source_location>
 #include <bitset>
+#include <bit>
 #include <set>
 #include <stdint.h>
 #include <type_traits>
@@ -0,0 +1,219 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    // 計測用のコンポーネント : 番号ごとに別の型になる
+    template <int N>
+    class BenchComponent : public BaseComponent
+    {
+    public:
+        using BaseComponent::BaseComponent;
+
+        int Value = N;
+    };
+
+    // 1つのオブジェクトに付けるコンポーネント数の上限
+    constexpr int MaxBenchComponentNum = 50;
+
+    /* @brief BenchComponent<0> ~ BenchComponent<num - 1> を追加する */
+    template <int... Ns>
+    void AddBenchComponents(GameObject& obj, int num, std::integer_sequence<int, Ns...>)
+    {
+        ((Ns < num ? (void)obj.AddComponent<BenchComponent<Ns>>() : (void)0), ...);
+    }
+
+    void AddBenchComponents(GameObject& obj, int num)
+    {
+        AddBenchComponents(obj, num, std::make_integer_sequence<int, MaxBenchComponentNum>{});
+    }
+
+    /**
+    * @brief 型IDを導入する前の GetComponent : 型名の文字列を先頭から比較してダウンキャストする
+    * @details 比較のために、当時の実装をそのまま残している
+    */
+    template <typename CompType>
+    std::shared_ptr<CompType> GetComponentByTypeName(const GameObject& obj)
+    {
+        const std::string& compName = typeid(CompType).name();
+
+        for (auto&& comp : obj.GetComponents())
+        {
+            if (comp->GetComponentName() == compName)
+            {
+                return std::dynamic_pointer_cast<CompType>(comp);
+            }
+        }
+        return nullptr;
+    }
+
+    // 型IDの索引の上限を超えるための型 : 番号ごとに別の型になる
+    template <int N>
+    class OverflowComponent : public BaseComponent
+    {
+    public:
+        using BaseComponent::BaseComponent;
+
+        int Value = N;
+    };
+
+    // 索引の上限より多くの型を作る : ほかのテストで発行済みの型IDがあっても、必ず上限を超える
+    constexpr int OverflowComponentNum = static_cast<int>(ComponentTypeID::MaxTypeNum) + 16;
+
+    template <int... Ns>
+    void AddOverflowComponents(GameObject& obj, std::integer_sequence<int, Ns...>)
+    {
+        (obj.AddComponent<OverflowComponent<Ns>>(), ...);
+    }
+
+    /* @brief 全部の OverflowComponent が取得できた数 */
+    template <int... Ns>
+    int CountFoundOverflowComponents(GameObject& obj, std::integer_sequence<int, Ns...>)
+    {
+        const auto isFound = [&]<int N>()
+            {
+                const std::shared_ptr<OverflowComponent<N>> spComp = obj.GetComponent<OverflowComponent<N>>(false);
+                return spComp && spComp->Value == N && obj.HasComponent<OverflowComponent<N>>() &&
+                    obj.GetComponentPtr<OverflowComponent<N>>() == spComp.get();
+            };
+        return (0 + ... + (isFound.template operator()<Ns>() ? 1 : 0));
+    }
+
+    /* @brief コンポーネントを compNum 個付けたオブジェクトを objectNum 個生成する */
+    std::vector<std::shared_ptr<GameObject>> CreateBenchObjects(const std::shared_ptr<Scene>& spScene, int objectNum, int compNum)
+    {
+        std::vector<std::shared_ptr<GameObject>> objects;
+        objects.reserve(objectNum);
+
+        for (int i = 0; i < objectNum; ++i)
+        {
+            std::shared_ptr<GameObject> spObj = spScene->AddObject(GameObject::State::eActive, "BenchObject");
+            AddBenchComponents(*spObj, compNum);
+            objects.push_back(std::move(spObj));
+        }
+        return objects;
+    }
+}
+
+FNTEST_CASE(GameObject, GetComponentMatchesTypeNamePath)
+{
+    auto spScene = std::make_shared<Scene>("GetComponentTest");
+    auto objects = CreateBenchObjects(spScene, 1, 20);
+
+    const GameObject& obj = *objects.front();
+
+    FNTEST_CHECK(objects.front()->GetComponent<BenchComponent<0>>() == GetComponentByTypeName<BenchComponent<0>>(obj));
+    FNTEST_CHECK(objects.front()->GetComponent<BenchComponent<19>>() == GetComponentByTypeName<BenchComponent<19>>(obj));
+    FNTEST_CHECK(objects.front()->GetComponent<BenchComponent<19>>()->Value == 19);
+
+    // 付いていない型は見つからない
+    FNTEST_CHECK(!objects.front()->GetComponent<BenchComponent<20>>(false));
+    FNTEST_CHECK(!obj.HasComponent<BenchComponent<20>>());
+    FNTEST_CHECK(obj.GetComponentPtr<BenchComponent<7>>() == objects.front()->GetComponent<BenchComponent<7>>().get());
+}
+
+/**
+* @brief 型IDが索引の上限を超えたコンポーネントも取得できる
+* @details 上限を超えた型は索引に入らないので、m_spComponents の走査で見つける
+*/
+FNTEST_CASE(GameObject, GetComponentBeyondMaxTypeNum)
+{
+    auto spScene = std::make_shared<Scene>("OverflowComponentTest");
+    std::shared_ptr<GameObject> spObj = spScene->AddObject(GameObject::State::eActive, "OverflowObject");
+
+    constexpr auto Sequence = std::make_integer_sequence<int, OverflowComponentNum>{};
+    AddOverflowComponents(*spObj, Sequence);
+
+    FNTEST_REQUIRE(ComponentTypeID::Get<OverflowComponent<OverflowComponentNum - 1>>() >= ComponentTypeID::MaxTypeNum);
+    FNTEST_CHECK(CountFoundOverflowComponents(*spObj, Sequence) == OverflowComponentNum);
+
+    // 索引の外の型を外すと見つからなくなり、ほかの型はそのまま取得できる
+    using LastComponent = OverflowComponent<OverflowComponentNum - 1>;
+    spObj->RemoveComponent(typeid(LastComponent).name());
+
+    FNTEST_CHECK(!spObj->HasComponent<LastComponent>());
+    FNTEST_CHECK(!spObj->GetComponent<LastComponent>(false));
+    FNTEST_CHECK(spObj->GetComponentPtr<OverflowComponent<OverflowComponentNum - 2>>() != nullptr);
+    FNTEST_CHECK(spObj->GetComponentPtr<OverflowComponent<0>>() != nullptr);
+
+    // 索引の外の型を読み書きする宣言は、どの型とも同時に更新しない
+    const ComponentAccess overflowAccess = ComponentAccess{}.Parallel().Writes<LastComponent>();
+    const ComponentAccess otherAccess = ComponentAccess{}.Parallel().Writes<OverflowComponent<0>>();
+    FNTEST_CHECK(overflowAccess.HasUnindexedType);
+    FNTEST_CHECK(overflowAccess.IsConflict(otherAccess));
+    FNTEST_CHECK(otherAccess.IsConflict(overflowAccess));
+}
+
+/**
+* @brief GetComponent の型ID索引と、以前の型名の文字列比較の比較
+* @details
+*   コンポーネントを 5 / 20 / 50 個付けたオブジェクトで、先頭 / 中央 / 末尾の型を取得する
+*   文字列比較は後ろの型ほど遅くなり、型ID索引は個数に依存しない
+*/
+FNTEST_BENCH(GameObject, GetComponent)
+{
+    const int objectNum = fntest::IsQuick() ? 64 : 1000;
+    const int repeat = fntest::IsQuick() ? 2 : 10;
+
+    for (const int compNum : { 5, 20, 50 })
+    {
+        auto spScene = std::make_shared<Scene>("GetComponentBench");
+        auto objects = CreateBenchObjects(spScene, objectNum, compNum);
+
+        // 1回の計測での取得回数 : 1オブジェクトにつき先頭 / 中央 / 末尾の3回
+        const double lookupNum = objectNum * 3.0;
+
+        UINT64 sum = 0;
+
+        const auto lookupByTypeID = [&]<int First, int Middle, int Last>()
+        {
+            return fntest::MeasureMinMs(repeat, [&]()
+                {
+                    for (const auto& spObj : objects)
+                    {
+                        sum += spObj->GetComponent<BenchComponent<First>>()->Value;
+                        sum += spObj->GetComponent<BenchComponent<Middle>>()->Value;
+                        sum += spObj->GetComponent<BenchComponent<Last>>()->Value;
+                    }
+                });
+        };
+
+        const auto lookupByTypeName = [&]<int First, int Middle, int Last>()
+        {
+            return fntest::MeasureMinMs(repeat, [&]()
+                {
+                    for (const auto& spObj : objects)
+                    {
+                        sum += GetComponentByTypeName<BenchComponent<First>>(*spObj)->Value;
+                        sum += GetComponentByTypeName<BenchComponent<Middle>>(*spObj)->Value;
+                        sum += GetComponentByTypeName<BenchComponent<Last>>(*spObj)->Value;
+                    }
+                });
+        };
+
+        double typeIDMs = 0.0;
+        double typeNameMs = 0.0;
+
+        switch (compNum)
+        {
+        case 5:
+            typeIDMs = lookupByTypeID.operator()<0, 2, 4>();
+            typeNameMs = lookupByTypeName.operator()<0, 2, 4>();
+            break;
+        case 20:
+            typeIDMs = lookupByTypeID.operator()<0, 10, 19>();
+            typeNameMs = lookupByTypeName.operator()<0, 10, 19>();
+            break;
+        default:
+            typeIDMs = lookupByTypeID.operator()<0, 25, 49>();
+            typeNameMs = lookupByTypeName.operator()<0, 25, 49>();
+            break;
+        }
+
+        fntest::DoNotOptimize(sum);
+
+        const std::string prefix = std::to_string(compNum) + " components";
+        fntest::ReportBench(prefix + " / type ID", typeIDMs * 1.0e6 / lookupNum, "ns/lookup");
+        fntest::ReportBench(prefix + " / type name", typeNameMs * 1.0e6 / lookupNum, "ns/lookup");
+        fntest::ReportBench(prefix + " / speedup", typeNameMs / typeIDMs, "x");
+    }
+}
@@ -0,0 +1,388 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /**
+    * @class ScopedBoxes
+    * @brief CullingSystem にボックスを登録し、抜ける時に解除する
+    * @details CullingSystem はシングルトンなので、ほかのテストに登録を残さない
+    */
+    class ScopedBoxes
+    {
+    public:
+        /* @brief カメラの周り 2km 四方にボックスを散らす */
+        explicit ScopedBoxes(UINT32 boxNum)
+            : m_rng(7)
+        {
+            m_handles.reserve(boxNum);
+
+            for (UINT32 i = 0; i < boxNum; ++i)
+            {
+                const CullingSystem::Handle handle = CullingSystem::Instance().Register({});
+                m_handles.push_back(handle);
+
+                if (m_boundsByHandle.size() <= handle) { m_boundsByHandle.resize(handle + 1); }
+                Move(i);
+            }
+        }
+
+        ~ScopedBoxes()
+        {
+            for (const CullingSystem::Handle handle : m_handles)
+            {
+                CullingSystem::Instance().Unregister(handle);
+            }
+        }
+
+        /* @brief index 番目のボックスを別の場所に動かす */
+        void Move(UINT32 index)
+        {
+            std::uniform_real_distribution<float> posDist(-1000.0f, 1000.0f);
+            std::uniform_real_distribution<float> sizeDist(0.1f, 5.0f);
+
+            const Math::Vector3 center = { posDist(m_rng), posDist(m_rng) * 0.1f, posDist(m_rng) };
+            const Math::Vector3 extents = { sizeDist(m_rng), sizeDist(m_rng), sizeDist(m_rng) };
+
+            Set(index, center, extents);
+        }
+
+        /* @brief index 番目のボックスを指定した場所に置く */
+        void Set(UINT32 index, const Math::Vector3& center, const Math::Vector3& extents)
+        {
+            AABB<Math::Vector3> aabb;
+            aabb.SetMin(center - extents);
+            aabb.SetMax(center + extents);
+
+            CullingSystem::Instance().SetBounds(m_handles[index], aabb);
+            m_boundsByHandle[m_handles[index]] = aabb;
+        }
+
+        /* @brief 登録した番号のボックスを ClassifyAABB で判定する */
+        bool Classify(const FrustumCulling::Planes& planes, CullingSystem::Handle handle, UINT32& planeMask) const
+        {
+            const AABB<Math::Vector3>& bounds = m_boundsByHandle[handle];
+            return FrustumCulling::ClassifyAABB(planes, bounds.GetCenter(), bounds.GetSize() * 0.5f, planeMask);
+        }
+
+        /* @brief 番号の順にボックスを並べる : 使っていない番号は視錐台の外になるボックスのまま */
+        void ToArrays(FrustumCulling::AABBArrays& arrays) const
+        {
+            arrays.Resize(static_cast<UINT32>(m_boundsByHandle.size()));
+            for (const CullingSystem::Handle handle : m_handles)
+            {
+                const AABB<Math::Vector3>& bounds = m_boundsByHandle[handle];
+                arrays.Set(handle, bounds.GetCenter(), bounds.GetSize() * 0.5f);
+            }
+        }
+
+        /* @brief 木を使わずに1個ずつ判定する : CullView の結果と比べる基準 */
+        std::vector<UINT32> TestBruteForce(const FrustumCulling::Planes& planes) const
+        {
+            std::vector<UINT32> visibleBits(GetBitWordNum(), 0);
+            for (const CullingSystem::Handle handle : m_handles)
+            {
+                UINT32 planeMask = FrustumCulling::AllPlaneMask;
+                if (Classify(planes, handle, planeMask))
+                {
+                    visibleBits[handle / FrustumCulling::BitWordSize] |= 1u << (handle % FrustumCulling::BitWordSize);
+                }
+            }
+            return visibleBits;
+        }
+
+        /**
+        * @brief 視錐台の中のボックスを、遮蔽物の深度バッファで1個ずつ判定する : CullOccluded の結果と比べる基準
+        * @details CullingSystem と同じく、木に入れたボックスの min / max から中心と大きさを求める
+        */
+        std::vector<UINT32> TestOccludedBruteForce(const OcclusionCulling::DepthBuffer& buffer, const std::vector<UINT32>& frustumBits) const
+        {
+            std::vector<UINT32> occludedBits(frustumBits.size(), 0);
+            for (const CullingSystem::Handle handle : m_handles)
+            {
+                if (!FrustumCulling::IsVisible(frustumBits.data(), handle)) { continue; }
+
+                const AABB<Math::Vector3>& bounds = m_boundsByHandle[handle];
+                if (buffer.IsOccluded((bounds.GetMin() + bounds.GetMax()) * 0.5f, (bounds.GetMax() - bounds.GetMin()) * 0.5f))
+                {
+                    occludedBits[handle / FrustumCulling::BitWordSize] |= 1u << (handle % FrustumCulling::BitWordSize);
+                }
+            }
+            return occludedBits;
+        }
+
+        /* @brief 登録した番号の判定結果が一致するか */
+        bool IsSameResult(const std::vector<UINT32>& expected, const std::vector<UINT32>& actual) const
+        {
+            for (const CullingSystem::Handle handle : m_handles)
+            {
+                const bool isExpected = handle / FrustumCulling::BitWordSize < expected.size() &&
+                    FrustumCulling::IsVisible(expected.data(), handle);
+                const bool isActual = handle / FrustumCulling::BitWordSize < actual.size() &&
+                    FrustumCulling::IsVisible(actual.data(), handle);
+
+                if (isExpected != isActual) { return false; }
+            }
+            return true;
+        }
+
+        UINT32 GetNum() const { return static_cast<UINT32>(m_handles.size()); }
+        CullingSystem::Handle GetHandle(UINT32 index) const { return m_handles[index]; }
+
+        /* @brief 判定結果のビット配列に必要な要素数 */
+        UINT32 GetBitWordNum() const
+        {
+            return static_cast<UINT32>((m_boundsByHandle.size() + FrustumCulling::BitWordSize - 1) / FrustumCulling::BitWordSize);
+        }
+
+    private:
+        std::mt19937 m_rng;
+
+        std::vector<CullingSystem::Handle> m_handles;
+        // 番号ごとの太らせる前の AABB
+        std::vector<AABB<Math::Vector3>> m_boundsByHandle;
+    };
+
+    /* @brief 原点の近くから少し回した向きを見る視錐台 */
+    FrustumCulling::Planes CreatePlanes(float yawDegree)
+    {
+        const Math::Matrix mCamera = Math::Matrix::CreateRotationY(DirectX::XMConvertToRadians(yawDegree)) *
+            Math::Matrix::CreateTranslation(10.0f, 5.0f, -20.0f);
+
+        const Math::Matrix mProj = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+        return FrustumCulling::ExtractPlanes(mCamera.Invert() * mProj);
+    }
+
+    UINT32 CountVisible(const std::vector<UINT32>& visibleBits)
+    {
+        UINT32 visibleNum = 0;
+        for (const UINT32 word : visibleBits) { visibleNum += static_cast<UINT32>(std::popcount(word)); }
+        return visibleNum;
+    }
+
+    /**
+    * @brief 原点から +z を見るカメラの前に置いた、遮蔽物の四角形
+    * @details z = 10 の x が ±40, y が ±4 の板 : 画面の横を覆い、上下に縁が見える
+    */
+    std::vector<OcclusionCulling::ScreenTriangle> CreateOccluderQuad(const Math::Matrix& mViewProj)
+    {
+        const auto toClip = [&mViewProj](float x, float y)
+            {
+                return Math::Vector4::Transform(Math::Vector4(x, y, 10.0f, 1.0f), mViewProj);
+            };
+
+        const std::array<Math::Vector4, 4> corners = { toClip(-40.0f, -4.0f), toClip(40.0f, -4.0f), toClip(40.0f, 4.0f), toClip(-40.0f, 4.0f) };
+
+        std::vector<OcclusionCulling::ScreenTriangle> triangles(2);
+        FNTEST_REQUIRE(OcclusionCulling::SetupTriangle(corners[0], corners[1], corners[2], triangles[0]));
+        FNTEST_REQUIRE(OcclusionCulling::SetupTriangle(corners[0], corners[2], corners[3], triangles[1]));
+        return triangles;
+    }
+}
+
+FNTEST_CASE(CullingSystem, CullViewMatchesBruteForce)
+{
+    ScopedBoxes boxes(5000);
+
+    for (const UINT32 threadNum : { 1u, 4u })
+    {
+        fntest::ScopedJobSystem jobSystem(threadNum);
+
+        for (const float yaw : { 0.0f, 90.0f, 215.0f })
+        {
+            const FrustumCulling::Planes planes = CreatePlanes(yaw);
+
+            std::vector<UINT32> visibleBits;
+            UINT32 leafTestNum = 0;
+            CullingSystem::Instance().CullView(planes, visibleBits, &leafTestNum);
+
+            const std::vector<UINT32> expected = boxes.TestBruteForce(planes);
+
+            FNTEST_CHECK(CountVisible(expected) > 0);
+            FNTEST_CHECK(boxes.IsSameResult(expected, visibleBits));
+
+            // 平面にかかった葉だけをまとめて判定する
+            FNTEST_CHECK(leafTestNum > 0);
+            FNTEST_CHECK(leafTestNum < boxes.GetNum());
+        }
+    }
+
+    // 木を組み替えた後も同じ結果になる
+    for (UINT32 i = 0; i < boxes.GetNum(); i += 3) { boxes.Move(i); }
+
+    fntest::ScopedJobSystem jobSystem(4);
+
+    const FrustumCulling::Planes planes = CreatePlanes(45.0f);
+
+    std::vector<UINT32> visibleBits;
+    CullingSystem::Instance().CullView(planes, visibleBits);
+
+    FNTEST_CHECK(boxes.IsSameResult(boxes.TestBruteForce(planes), visibleBits));
+}
+
+/**
+* @brief ExecuteOcclusion と同じ判定で、遮蔽物の後ろのボックスだけを外す
+* @details
+*   - 帯 / ビット配列の要素ごとにワーカーで分けても、1個ずつ深度バッファで判定した結果と一致する
+*   - 手前 / 縁にかかる / 手前のクリップ面をまたぐボックスは外さない
+*/
+FNTEST_CASE(CullingSystem, CullOccludedMatchesDepthBuffer)
+{
+    ScopedBoxes boxes(5000);
+
+    // 決めた場所に置くボックス : 四角形の縁は z = 20 で y = 8 に見える
+    enum : UINT32 { Behind, InFront, OnEdge, CrossingNear };
+    boxes.Set(Behind, { 0.0f, 0.0f, 20.0f }, { 1.0f, 1.0f, 1.0f });
+    boxes.Set(InFront, { 0.0f, 0.0f, 5.0f }, { 1.0f, 1.0f, 1.0f });
+    boxes.Set(OnEdge, { 0.0f, 8.0f, 20.0f }, { 1.0f, 1.0f, 1.0f });
+    boxes.Set(CrossingNear, { 0.0f, 0.0f, 14.5f }, { 0.2f, 0.2f, 15.5f });
+
+    constexpr float Aspect = static_cast<float>(OcclusionCulling::Width) / static_cast<float>(OcclusionCulling::Height);
+    const Math::Matrix mViewProj = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), Aspect, 0.1f, 500.0f);
+    const FrustumCulling::Planes planes = FrustumCulling::ExtractPlanes(mViewProj);
+    const std::vector<OcclusionCulling::ScreenTriangle> quad = CreateOccluderQuad(mViewProj);
+
+    // 1個ずつ判定する基準
+    OcclusionCulling::DepthBuffer reference;
+    reference.SetViewProj(mViewProj);
+    for (UINT32 bandIdx = 0; bandIdx < OcclusionCulling::BandNum; ++bandIdx)
+    {
+        reference.RenderBand(bandIdx, quad);
+    }
+    reference.BuildHiZ();
+
+    CullingSystem& cullingSystem = CullingSystem::Instance();
+
+    for (const UINT32 threadNum : { 1u, 4u })
+    {
+        fntest::ScopedJobSystem jobSystem(threadNum);
+
+        std::vector<UINT32> frustumBits;
+        cullingSystem.CullView(planes, frustumBits);
+
+        std::vector<UINT32> visibleBits = frustumBits;
+        std::vector<UINT32> occludedBits;
+        UINT32 testNum = 0;
+        const UINT32 occludedNum = cullingSystem.CullOccluded(mViewProj, quad, visibleBits, occludedBits, &testNum);
+
+        const std::vector<UINT32> expected = boxes.TestOccludedBruteForce(reference, frustumBits);
+
+        FNTEST_CHECK(testNum == CountVisible(frustumBits));
+        FNTEST_CHECK(occludedNum == CountVisible(occludedBits));
+        FNTEST_CHECK(occludedNum > 1);
+        FNTEST_CHECK(boxes.IsSameResult(expected, occludedBits));
+
+        // 隠れたボックスは見えているボックスから外れ、視錐台の中のボックスはどちらか一方に入る
+        FNTEST_REQUIRE(visibleBits.size() == frustumBits.size());
+        for (size_t wordIdx = 0; wordIdx < frustumBits.size(); ++wordIdx)
+        {
+            FNTEST_CHECK((visibleBits[wordIdx] & occludedBits[wordIdx]) == 0);
+            FNTEST_CHECK((visibleBits[wordIdx] | occludedBits[wordIdx]) == frustumBits[wordIdx]);
+        }
+
+        const auto isOccluded = [&](UINT32 index) { return FrustumCulling::IsVisible(occludedBits.data(), boxes.GetHandle(index)); };
+        const auto isVisible = [&](UINT32 index) { return FrustumCulling::IsVisible(visibleBits.data(), boxes.GetHandle(index)); };
+
+        FNTEST_CHECK(isOccluded(Behind));
+        FNTEST_CHECK(isVisible(InFront) && !isOccluded(InFront));
+        FNTEST_CHECK(isVisible(OnEdge) && !isOccluded(OnEdge));
+        FNTEST_CHECK(isVisible(CrossingNear) && !isOccluded(CrossingNear));
+    }
+}
+
+/**
+* @brief 100,000 個のボックスをメインカメラの視錐台で判定する
+* @details
+*   - flat SIMD       : 木を使わず、すべてのボックスを TestAABBs で判定する
+*   - tree + scalar   : 木をたどり、平面にかかった葉を ClassifyAABB で1個ずつ判定する (以前の CullView)
+*   - tree + SIMD     : 木をたどり、平面にかかった葉を集めて TestAABBs でまとめて判定する
+*   tree + SIMD はスレッド数ごとに計り、集めた葉をワーカーで分けて判定する
+*/
+FNTEST_BENCH(CullingSystem, CullView100k)
+{
+    const UINT32 boxNum = fntest::IsQuick() ? 10000 : 100000;
+    const int repeat = fntest::IsQuick() ? 3 : 20;
+
+    ScopedBoxes boxes(boxNum);
+
+    const FrustumCulling::Planes planes = CreatePlanes(30.0f);
+    const CullingSystem& cullingSystem = CullingSystem::Instance();
+
+    const UINT32 expectedVisibleNum = CountVisible(boxes.TestBruteForce(planes));
+    const UINT32 hardwareThreadNum = std::max(1u, std::thread::hardware_concurrency());
+
+    const auto report = [&](const std::string& label, double ms, UINT32 visibleNum)
+        {
+            fntest::ReportBench(label, ms, "ms");
+            fntest::ReportBench(label + " matches", visibleNum == expectedVisibleNum ? 1.0 : 0.0, "");
+        };
+
+    fntest::ReportBench("boxes", boxNum, "");
+    fntest::ReportBench("visible", expectedVisibleNum, "");
+
+    //--------------------------------
+    // 木を使わない
+    //--------------------------------
+    {
+        fntest::ScopedJobSystem jobSystem;
+
+        FrustumCulling::AABBArrays flatBoxes;
+        boxes.ToArrays(flatBoxes);
+
+        std::vector<UINT32> visibleBits(flatBoxes.GetBitWordNum(), 0);
+        const double ms = fntest::MeasureMinMs(repeat, [&]()
+            {
+                JobSystem::Instance().ParallelFor(flatBoxes.GetBitWordNum(), 0, [&](UINT32 beginWord, UINT32 endWord)
+                    {
+                        FrustumCulling::TestAABBs(planes, flatBoxes, beginWord * FrustumCulling::BitWordSize,
+                            endWord * FrustumCulling::BitWordSize, visibleBits.data());
+                    });
+            });
+
+        report("flat SIMD (" + std::to_string(JobSystem::Instance().GetThreadNum()) + " threads)", ms, CountVisible(visibleBits));
+    }
+
+    //--------------------------------
+    // 木 + 1個ずつ
+    //--------------------------------
+    {
+        std::vector<UINT32> visibleBits;
+        UINT32 visitNum = 0;
+
+        const double ms = fntest::MeasureMinMs(repeat, [&]()
+            {
+                visibleBits.assign(boxes.GetBitWordNum(), 0);
+
+                visitNum = cullingSystem.GetTree().QueryFrustum(planes,
+                    [&](UINT32 handle, UINT32 planeMask)
+                    {
+                        if (planeMask != 0 && !boxes.Classify(planes, handle, planeMask)) { return; }
+
+                        visibleBits[handle / FrustumCulling::BitWordSize] |= 1u << (handle % FrustumCulling::BitWordSize);
+                    });
+            });
+
+        report("tree + scalar leaves", ms, CountVisible(visibleBits));
+        fntest::ReportBench("tree nodes visited", visitNum, "");
+    }
+
+    //--------------------------------
+    // 木 + まとめて判定
+    //--------------------------------
+    for (UINT32 threadNum = 1; threadNum <= hardwareThreadNum; threadNum *= 2)
+    {
+        fntest::ScopedJobSystem jobSystem(threadNum);
+
+        std::vector<UINT32> visibleBits;
+        UINT32 leafTestNum = 0;
+
+        const double ms = fntest::MeasureMinMs(repeat, [&]()
+            {
+                cullingSystem.CullView(planes, visibleBits, &leafTestNum);
+            });
+
+        report("tree + SIMD leaves (" + std::to_string(threadNum) + " threads)", ms, CountVisible(visibleBits));
+
+        if (threadNum == 1) { fntest::ReportBench("leaves tested in batch", leafTestNum, ""); }
+    }
+}
@@ -0,0 +1,324 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /* @brief 計測用のモデル : メッシュは持たず、描画キューのソートキーに使う番号だけを持つ */
+    struct BenchModels
+    {
+        std::vector<std::shared_ptr<ModelData>> Datas;
+        std::vector<std::shared_ptr<ModelWork>> Works;
+    };
+
+    BenchModels CreateModels(UINT modelNum)
+    {
+        BenchModels models;
+        for (UINT i = 0; i < modelNum; ++i)
+        {
+            models.Datas.push_back(std::make_shared<ModelData>());
+            models.Works.push_back(std::make_shared<ModelWork>(models.Datas.back()));
+        }
+        return models;
+    }
+
+    // 1フレームに積む描画要求
+    struct Submission
+    {
+        UINT ModelIdx = 0;
+        RenderQueue::Pass DrawPass = RenderQueue::Pass::eGBuffer;
+        InstanceData Instance;
+    };
+
+    /**
+    * @brief 描画要求を並べる : 半分を GBuffer、残りをカスケードのシャドウマップに振り分ける
+    * @details モデルと位置は乱数で決めるので、積む順番はモデルごとにまとまっていない
+    */
+    std::vector<Submission> CreateSubmissions(UINT submissionNum, UINT modelNum)
+    {
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<UINT> modelDist(0, modelNum - 1);
+        std::uniform_int_distribution<UINT> cascadeDist(0, ShadowCascade::CascadeNum - 1);
+        std::uniform_real_distribution<float> posDist(-500.0f, 500.0f);
+
+        std::vector<Submission> submissions(submissionNum);
+        for (UINT i = 0; i < submissionNum; ++i)
+        {
+            Submission& submission = submissions[i];
+            submission.ModelIdx = modelDist(rng);
+            submission.DrawPass = (i % 2 == 0) ? RenderQueue::Pass::eGBuffer : RenderQueue::ToShadowPass(cascadeDist(rng));
+            submission.Instance.mWorld = Math::Matrix::CreateTranslation(posDist(rng), 0.0f, posDist(rng) + 500.0f);
+        }
+        return submissions;
+    }
+
+    /**
+    * @brief RenderQueue にする前の描画リスト
+    * @details
+    *   モデルデータをキーにしたマップにインスタンスを足していき、毎フレームマップごと消していた
+    *   比較のためにそのまま残したもの
+    */
+    class LegacyRenderLists
+    {
+    public:
+        struct InstancedRenderEntry
+        {
+            std::vector<InstanceData> InstanceDataList;
+            std::vector<ModelWork*> ModelWorkList;
+        };
+
+        void AddInstance(const std::shared_ptr<ModelWork>& spModelWork, const InstanceData& instanceData, bool isShadow)
+        {
+            auto& renderData = isShadow ? m_ShadowMapRenderData : m_GBufferRenderData;
+
+            auto& instancedRenderEntry = renderData[spModelWork->GetModelData()];
+            instancedRenderEntry.InstanceDataList.emplace_back(instanceData);
+            instancedRenderEntry.ModelWorkList.emplace_back(spModelWork.get());
+        }
+
+        /* @brief 描画と同じ順に走査して、インスタンス描画の回数を返す */
+        size_t CountDraws() const
+        {
+            size_t drawNum = 0;
+            for (const auto* pRenderData : { &m_ShadowMapRenderData, &m_GBufferRenderData })
+            {
+                for (const auto& [spModelData, entry] : *pRenderData)
+                {
+                    if (!spModelData || entry.InstanceDataList.empty()) { continue; }
+                    fntest::DoNotOptimize(entry.InstanceDataList.data());
+                    ++drawNum;
+                }
+            }
+            return drawNum;
+        }
+
+        void Clear()
+        {
+            m_GBufferRenderData.clear();
+            m_ShadowMapRenderData.clear();
+        }
+
+    private:
+        std::unordered_map<std::shared_ptr<ModelData>, InstancedRenderEntry> m_GBufferRenderData;
+        std::unordered_map<std::shared_ptr<ModelData>, InstancedRenderEntry> m_ShadowMapRenderData;
+    };
+
+    /* @brief DrawBatch を描画と同じ順に走査する */
+    size_t CountDraws(const RenderQueue& queue)
+    {
+        for (const RenderQueue::DrawBatch& batch : queue.GetBatches())
+        {
+            fntest::DoNotOptimize(queue.GetInstances(batch).data());
+        }
+        return queue.GetBatches().size();
+    }
+
+    const Math::Vector3 ViewPos = { 0.0f, 0.0f, 0.0f };
+    const Math::Vector3 ViewForward = { 0.0f, 0.0f, 1.0f };
+}
+
+FNTEST_CASE(RenderQueue, SortGroupsByPassAndModel)
+{
+    BenchModels models = CreateModels(3);
+
+    const auto push = [&](RenderQueue& queue, RenderQueue::Pass pass, UINT modelIdx, float z)
+        {
+            InstanceData instance;
+            instance.mWorld = Math::Matrix::CreateTranslation(0.0f, 0.0f, z);
+            queue.Push(pass, models.Works[modelIdx].get(), models.Datas[modelIdx].get(), 0, instance);
+        };
+
+    RenderQueue queue;
+
+    // パスもモデルもばらばらの順で積む
+    push(queue, RenderQueue::Pass::eGBuffer, 0, 30.0f);
+    push(queue, RenderQueue::ToShadowPass(1), 1, 0.0f);
+    push(queue, RenderQueue::Pass::eGBuffer, 1, 5.0f);
+    push(queue, RenderQueue::Pass::eGBuffer, 0, 10.0f);
+    push(queue, RenderQueue::ToStaticShadowPass(0), 2, 0.0f);
+    push(queue, RenderQueue::ToShadowPass(1), 1, 0.0f);
+    push(queue, RenderQueue::Pass::eGBuffer, 0, 20.0f);
+
+    queue.Sort(ViewPos, ViewForward);
+
+    const std::vector<RenderQueue::DrawBatch>& batches = queue.GetBatches();
+    FNTEST_REQUIRE(batches.size() == 4);
+
+    // 動かないモデルの影 -> 動くモデルの影 -> GBuffer の順になる
+    FNTEST_CHECK(batches[0].DrawPass == RenderQueue::ToStaticShadowPass(0));
+    FNTEST_CHECK(batches[1].DrawPass == RenderQueue::ToShadowPass(1));
+    FNTEST_CHECK(batches[1].Count == 2);
+    FNTEST_CHECK(batches[2].DrawPass == RenderQueue::Pass::eGBuffer);
+    FNTEST_CHECK(batches[3].DrawPass == RenderQueue::Pass::eGBuffer);
+
+    // 区間は隙間なく並び、合計は積んだ数になる
+    UINT first = 0;
+    for (const RenderQueue::DrawBatch& batch : batches)
+    {
+        FNTEST_CHECK(batch.First == first);
+        FNTEST_CHECK(queue.GetInstances(batch).size() == batch.Count);
+        FNTEST_CHECK(queue.GetModelWorks(batch).size() == batch.Count);
+        first += batch.Count;
+    }
+    FNTEST_CHECK(first == 7);
+    FNTEST_CHECK(queue.GetLastPacketNum() == 7);
+    FNTEST_CHECK(queue.GetLastBatchNum() == 4);
+
+    // 同じモデルの GBuffer は近い順に並ぶ
+    const RenderQueue::DrawBatch& modelBatch = (batches[2].pModelData == models.Datas[0].get()) ? batches[2] : batches[3];
+    FNTEST_REQUIRE(modelBatch.Count == 3);
+
+    std::span<const InstanceData> instances = queue.GetInstances(modelBatch);
+    FNTEST_CHECK_NEAR(instances[0].mWorld.Translation().z, 10.0f, 1.0e-4f);
+    FNTEST_CHECK_NEAR(instances[1].mWorld.Translation().z, 20.0f, 1.0e-4f);
+    FNTEST_CHECK_NEAR(instances[2].mWorld.Translation().z, 30.0f, 1.0e-4f);
+
+    std::span<ModelWork* const> modelWorks = queue.GetModelWorks(modelBatch);
+    FNTEST_CHECK(std::all_of(modelWorks.begin(), modelWorks.end(),
+        [&](const ModelWork* pModelWork) { return pModelWork == models.Works[0].get(); }));
+
+    // 消した後は空になり、次のフレームも同じ結果になる
+    queue.Clear();
+    FNTEST_CHECK(queue.IsEmpty());
+}
+
+FNTEST_CASE(RenderQueue, WorkerPushesAreMerged)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+
+    constexpr UINT ModelNum = 16;
+    constexpr UINT SubmissionNum = 10000;
+
+    BenchModels models = CreateModels(ModelNum);
+    std::vector<Submission> submissions = CreateSubmissions(SubmissionNum, ModelNum);
+
+    RenderQueue queue;
+    queue.PrepareThreadBuffers();
+
+    JobSystem::Instance().ParallelFor(SubmissionNum, 0, [&](UINT32 begin, UINT32 end)
+        {
+            for (UINT32 i = begin; i < end; ++i)
+            {
+                const Submission& submission = submissions[i];
+                queue.Push(submission.DrawPass, models.Works[submission.ModelIdx].get(),
+                    models.Datas[submission.ModelIdx].get(), 0, submission.Instance);
+            }
+        });
+
+    queue.MergeThreadBuffers();
+    queue.Sort(ViewPos, ViewForward);
+
+    FNTEST_CHECK(queue.GetLastPacketNum() == SubmissionNum);
+
+    // パスとモデルの組み合わせごとに1つの DrawBatch になる
+    std::set<std::pair<UINT, const ModelData*>> keys;
+    for (const Submission& submission : submissions)
+    {
+        keys.emplace(static_cast<UINT>(submission.DrawPass), models.Datas[submission.ModelIdx].get());
+    }
+    FNTEST_CHECK(queue.GetLastBatchNum() == keys.size());
+
+    UINT instanceNum = 0;
+    for (const RenderQueue::DrawBatch& batch : queue.GetBatches()) { instanceNum += batch.Count; }
+    FNTEST_CHECK(instanceNum == SubmissionNum);
+}
+
+/**
+* @brief 1フレームに 50,000 個の描画要求を積んでから描画の単位にまとめるまで
+* @details
+*   - legacy map    : モデルデータをキーにしたマップに積み、毎フレームマップごと消す
+*   - RenderQueue   : 配列に積んで基数ソートし、連続した区間を DrawBatch にする
+*   - worker push   : ワーカースレッドから積み、MergeThreadBuffers でまとめてからソートする
+*   どれも積む / まとめる / 描画順に走査する / 消す までを1フレームとして計る
+*/
+FNTEST_BENCH(RenderQueue, Submit50k)
+{
+    const UINT submissionNum = fntest::IsQuick() ? 5000 : 50000;
+    const int repeat = fntest::IsQuick() ? 3 : 20;
+
+    for (const UINT modelNum : { 64u, 1024u })
+    {
+        BenchModels models = CreateModels(modelNum);
+        std::vector<Submission> submissions = CreateSubmissions(submissionNum, modelNum);
+
+        //--------------------------------
+        // 以前のマップ
+        //--------------------------------
+        LegacyRenderLists legacy;
+        size_t legacyDrawNum = 0;
+
+        const double legacyMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                for (const Submission& submission : submissions)
+                {
+                    legacy.AddInstance(models.Works[submission.ModelIdx], submission.Instance,
+                        submission.DrawPass != RenderQueue::Pass::eGBuffer);
+                }
+                legacyDrawNum = legacy.CountDraws();
+                legacy.Clear();
+            });
+
+        //--------------------------------
+        // RenderQueue
+        //--------------------------------
+        RenderQueue queue;
+        size_t queueDrawNum = 0;
+
+        const double queueMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                for (const Submission& submission : submissions)
+                {
+                    queue.Push(submission.DrawPass, models.Works[submission.ModelIdx].get(),
+                        models.Datas[submission.ModelIdx].get(), 0, submission.Instance);
+                }
+                queue.Sort(ViewPos, ViewForward);
+                queueDrawNum = CountDraws(queue);
+                queue.Clear();
+            });
+
+        const UINT sortPassNum = queue.GetLastSortPassNum();
+
+        //--------------------------------
+        // ワーカースレッドから積む
+        //--------------------------------
+        double workerMs = 0.0;
+        UINT32 threadNum = 0;
+        {
+            fntest::ScopedJobSystem jobSystem;
+            threadNum = JobSystem::Instance().GetThreadNum();
+
+            workerMs = fntest::MeasureMinMs(repeat, [&]()
+                {
+                    queue.PrepareThreadBuffers();
+
+                    JobSystem::Instance().ParallelFor(submissionNum, 0, [&](UINT32 begin, UINT32 end)
+                        {
+                            for (UINT32 i = begin; i < end; ++i)
+                            {
+                                const Submission& submission = submissions[i];
+                                queue.Push(submission.DrawPass, models.Works[submission.ModelIdx].get(),
+                                    models.Datas[submission.ModelIdx].get(), 0, submission.Instance);
+                            }
+                        });
+
+                    queue.MergeThreadBuffers();
+                    queue.Sort(ViewPos, ViewForward);
+                    fntest::DoNotOptimize(CountDraws(queue));
+                    queue.Clear();
+                });
+        }
+
+        const std::string prefix = std::to_string(submissionNum) + " submissions / " + std::to_string(modelNum) + " models";
+
+        fntest::ReportBench(prefix + " / legacy map", legacyMs, "ms/frame");
+        fntest::ReportBench(prefix + " / legacy map", legacyMs * 1.0e6 / submissionNum, "ns/submission");
+        fntest::ReportBench(prefix + " / legacy map draws", static_cast<double>(legacyDrawNum), "");
+
+        fntest::ReportBench(prefix + " / RenderQueue", queueMs, "ms/frame");
+        fntest::ReportBench(prefix + " / RenderQueue", queueMs * 1.0e6 / submissionNum, "ns/submission");
+        fntest::ReportBench(prefix + " / RenderQueue draws", static_cast<double>(queueDrawNum), "");
+        fntest::ReportBench(prefix + " / RenderQueue sort passes", sortPassNum, "");
+        fntest::ReportBench(prefix + " / RenderQueue speedup", legacyMs / queueMs, "x");
+
+        fntest::ReportBench(prefix + " / worker push (" + std::to_string(threadNum) + " threads)", workerMs, "ms/frame");
+        fntest::ReportBench(prefix + " / worker push", workerMs * 1.0e6 / submissionNum, "ns/submission");
+    }
+}
@@ -0,0 +1,121 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /* @brief 並列更新フェーズで更新される計測用のコンポーネント : 自身の行列を読んで数値計算だけを行う */
+    class ParallelWorkComponent : public BaseComponent
+    {
+    public:
+        using BaseComponent::BaseComponent;
+
+        ComponentAccess DeclareUpdateAccess() const override
+        {
+            return ComponentAccess{}.Parallel().Reads<TransformComponent>().Writes<ParallelWorkComponent>();
+        }
+
+        void Update() override
+        {
+            const Math::Vector3 pos = GetOwnerPtr()->GetTransformComponent()->GetWorldPos();
+
+            // 1回あたり数マイクロ秒の計算
+            float v = pos.x + static_cast<float>(UpdateNum);
+            for (int i = 0; i < WorkNum; ++i)
+            {
+                v = std::sqrt(v * v + 1.0f) * 0.5f + std::sin(v);
+            }
+
+            Result = v;
+            ++UpdateNum;
+        }
+
+        // 1回の Update の計算量
+        int WorkNum = 256;
+
+        float Result = 0.0f;
+        UINT32 UpdateNum = 0;
+    };
+
+    /* @brief 計測用のコンポーネントを付けたオブジェクトを objectNum 個並べたシーンを作る */
+    std::shared_ptr<Scene> CreateParallelScene(int objectNum, std::vector<ParallelWorkComponent*>& comps)
+    {
+        auto spScene = std::make_shared<Scene>("ParallelUpdateBench");
+
+        for (int i = 0; i < objectNum; ++i)
+        {
+            auto spObj = spScene->AddObject(GameObject::State::eActive, "Worker");
+            spObj->GetTransformComponent()->SetPosition({ static_cast<float>(i), 0.0f, 0.0f });
+
+            comps.push_back(spObj->AddComponent<ParallelWorkComponent>().get());
+        }
+        return spScene;
+    }
+}
+
+FNTEST_CASE(Scene, ParallelUpdateRunsEachComponentOnce)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+
+    std::vector<ParallelWorkComponent*> comps;
+    auto spScene = CreateParallelScene(1000, comps);
+
+    for (ParallelWorkComponent* pComp : comps) { pComp->WorkNum = 4; }
+
+    constexpr UINT32 FrameNum = 3;
+    for (UINT32 frame = 0; frame < FrameNum; ++frame)
+    {
+        spScene->PreUpdate();
+        spScene->Update();
+        spScene->FlushDestroyedObjects();
+    }
+
+    FNTEST_CHECK(spScene->GetParallelComponentNum() == comps.size());
+    FNTEST_CHECK(std::all_of(comps.begin(), comps.end(),
+        [](const ParallelWorkComponent* pComp) { return pComp->UpdateNum == FrameNum; }));
+}
+
+/**
+* @brief 描画を行わないシーンでの、並列更新フェーズのスケーリング
+* @details
+*   数千個のオブジェクトに並列更新するコンポーネントを付け、Scene::Update 1回の時間をスレッド数ごとに計る
+*   serial は並列更新を切って同じ処理を1スレッドで行ったもの
+*/
+FNTEST_BENCH(Scene, ParallelUpdateScaling)
+{
+    const int objectNum = fntest::IsQuick() ? 500 : 4000;
+    const int repeat = fntest::IsQuick() ? 2 : 10;
+
+    std::vector<ParallelWorkComponent*> comps;
+    auto spScene = CreateParallelScene(objectNum, comps);
+
+    const auto updateFrame = [&]()
+        {
+            spScene->PreUpdate();
+            spScene->Update();
+            spScene->FlushDestroyedObjects();
+        };
+
+    double serialMs = 0.0;
+    {
+        fntest::ScopedJobSystem jobSystem(1);
+
+        spScene->SetParallelUpdate(false);
+        serialMs = fntest::MeasureMinMs(repeat, updateFrame);
+        spScene->SetParallelUpdate(true);
+    }
+
+    fntest::ReportBench(std::to_string(objectNum) + " objects / serial", serialMs, "ms/frame");
+
+    const UINT32 hardwareThreadNum = std::max(1u, std::thread::hardware_concurrency());
+
+    for (UINT32 threadNum = 1; threadNum <= hardwareThreadNum; threadNum *= 2)
+    {
+        fntest::ScopedJobSystem jobSystem(threadNum);
+
+        const double ms = fntest::MeasureMinMs(repeat, updateFrame);
+
+        const std::string label = std::to_string(threadNum) + " threads";
+        fntest::ReportBench(label, ms, "ms/frame");
+        fntest::ReportBench(label + " speedup", serialMs / ms, "x");
+        fntest::ReportBench(label + " efficiency", serialMs / ms / threadNum * 100.0, "%");
+    }
+}
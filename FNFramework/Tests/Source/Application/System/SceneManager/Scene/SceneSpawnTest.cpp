@@ -0,0 +1,265 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /* @brief 破棄されたときに Release の回数を数えるコンポーネント */
+    class SpawnProbeComponent : public BaseComponent
+    {
+    public:
+        using BaseComponent::BaseComponent;
+
+        void Update() override { ++UpdateNum; }
+        void Release() override { ++ReleaseNum; }
+
+        UINT32 UpdateNum = 0;
+
+        static inline UINT32 ReleaseNum = 0;
+    };
+
+    /**
+    * @brief 1フレーム分の生成と破棄を行う
+    * @param[in] spawnNum - 生成するオブジェクト数 : 半分は spParent の子にする
+    * @param[in] live     - 生存しているオブジェクト : 先頭から spawnNum 個ランダムに選んで破棄する
+    */
+    void SpawnDespawnFrame(Scene& scene, const std::shared_ptr<GameObject>& spParent, std::vector<std::shared_ptr<GameObject>>& live,
+                           size_t spawnNum, std::mt19937& rng)
+    {
+        // ランダムに選んだオブジェクトを死亡状態にする
+        for (size_t i = 0; i < spawnNum && !live.empty(); ++i)
+        {
+            const size_t index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(rng);
+
+            live[index]->SetState(GameObject::State::eDead);
+            live[index] = std::move(live.back());
+            live.pop_back();
+        }
+
+        for (size_t i = 0; i < spawnNum; ++i)
+        {
+            std::shared_ptr<GameObject> spObj = scene.AddObject(GameObject::State::eActive, "Spawned");
+            spObj->AddComponent<SpawnProbeComponent>();
+
+            if (i % 2 == 0) { spParent->AddChild(spObj); }
+
+            live.push_back(std::move(spObj));
+        }
+
+        scene.PreUpdate();
+        scene.Update();
+        scene.FlushDestroyedObjects();
+    }
+
+    /* @brief 子の一覧と、子が覚えている親が食い違っていないか */
+    bool IsChildListConsistent(const Scene& scene, const GameObject& parent)
+    {
+        for (const GameObjectHandle& hChild : parent.GetChildren())
+        {
+            const GameObject* pChild = scene.ResolveObjectPtr(hChild);
+
+            if (!pChild) { return false; }
+            if (pChild->GetState() == GameObject::State::eDead) { return false; }
+            if (pChild->GetParentPtr() != &parent) { return false; }
+        }
+        return true;
+    }
+
+    /**
+    * @brief 1つの親の子を childNum 個生成し、すべて破棄するフレームの PreUpdate の時間 (ms)
+    * @param[out] rebuildNum - 破棄したフレームで並び替えを行った回数
+    */
+    double MeasureParentedDespawnMs(size_t childNum, UINT32& rebuildNum)
+    {
+        auto spScene = std::make_shared<Scene>("DespawnTest");
+        TransformHierarchy& hierarchy = spScene->WorkTransformHierarchy();
+
+        const std::shared_ptr<GameObject> spParent = spScene->AddObject(GameObject::State::eActive, "Parent");
+        spParent->GetTransformComponent()->SetPosition({ 10.0f, 0.0f, 0.0f });
+
+        for (size_t i = 0; i < childNum; ++i)
+        {
+            spParent->AddChild(spScene->AddObject(GameObject::State::eActive, "Child"));
+        }
+        spScene->PreUpdate();
+        spScene->Update();
+        spScene->FlushDestroyedObjects();
+
+        for (const auto& spObj : spScene->GetObjectList())
+        {
+            if (spObj != spParent) { spObj->SetState(GameObject::State::eDead); }
+        }
+
+        const UINT32 lastRebuildNum = hierarchy.GetRebuildOrderNum();
+
+        fntest::Timer timer;
+        spScene->PreUpdate();
+        const double ms = timer.ElapsedMs();
+
+        spScene->Update();
+        spScene->FlushDestroyedObjects();
+
+        rebuildNum = hierarchy.GetRebuildOrderNum() - lastRebuildNum;
+
+        return ms;
+    }
+}
+
+/**
+* @brief 生成と破棄を繰り返しても、オブジェクト数と親子関係が崩れない
+* @details 破棄したオブジェクトはフレームの終わりにまとめて Release され、親の子の一覧から外れている
+*/
+FNTEST_CASE(Scene, SpawnDespawnKeepsChildrenConsistent)
+{
+    constexpr size_t LiveNum = 1000;
+    constexpr size_t SpawnNumPerFrame = 167;
+    constexpr int FrameNum = 60;
+
+    auto spScene = std::make_shared<Scene>("SpawnTest");
+    const std::shared_ptr<GameObject> spParent = spScene->AddObject(GameObject::State::eActive, "Parent");
+
+    std::mt19937 rng(42);
+    std::vector<std::shared_ptr<GameObject>> live;
+
+    // 最初の生存数まで生成する : 破棄するものはまだない
+    SpawnDespawnFrame(*spScene, spParent, live, LiveNum, rng);
+    FNTEST_REQUIRE(live.size() == LiveNum);
+
+    SpawnProbeComponent::ReleaseNum = 0;
+
+    for (int frame = 0; frame < FrameNum; ++frame)
+    {
+        SpawnDespawnFrame(*spScene, spParent, live, SpawnNumPerFrame, rng);
+
+        FNTEST_CHECK(spScene->GetLastDestroyedObjectNum() == SpawnNumPerFrame);
+        FNTEST_CHECK(spScene->GetObjectList().size() == LiveNum + 1);
+        FNTEST_CHECK(IsChildListConsistent(*spScene, *spParent));
+    }
+
+    // 破棄したオブジェクトはすべて Release されている
+    FNTEST_CHECK(SpawnProbeComponent::ReleaseNum == SpawnNumPerFrame * FrameNum);
+
+    // 生存しているオブジェクトのうち親を持つものの数と、子の一覧の数が一致する
+    const size_t childNum = std::count_if(live.begin(), live.end(),
+        [&](const std::shared_ptr<GameObject>& spObj) { return spObj->GetParentPtr() == spParent.get(); });
+    FNTEST_CHECK(spParent->GetChildren().size() == childNum);
+
+    // 最後のフレームで生成したオブジェクトも更新されている
+    FNTEST_CHECK(live.back()->GetComponent<SpawnProbeComponent>()->UpdateNum == 1);
+}
+
+/**
+* @brief 親を持つオブジェクトの破棄では、ワールド座標を保たずに親子関係を外す
+* @details
+*   破棄するオブジェクトの座標を保つと、子ごとに親を辿って行列を計算することになる
+*   破棄の時点ではローカル座標がそのまま残り、並び替えはフレームの Update で1回だけ行われる
+*/
+FNTEST_CASE(Scene, DespawnParentedObjectSkipsWorldPosition)
+{
+    auto spScene = std::make_shared<Scene>("DespawnTest");
+
+    const std::shared_ptr<GameObject> spParent = spScene->AddObject(GameObject::State::eActive, "Parent");
+    const std::shared_ptr<GameObject> spDead = spScene->AddObject(GameObject::State::eActive, "Dead");
+    const std::shared_ptr<GameObject> spAlive = spScene->AddObject(GameObject::State::eActive, "Alive");
+
+    spParent->GetTransformComponent()->SetPosition({ 10.0f, 0.0f, 0.0f });
+    spParent->AddChild(spDead);
+    spParent->AddChild(spAlive);
+    spDead->GetTransformComponent()->SetPosition({ 11.0f, 0.0f, 0.0f });
+    spAlive->GetTransformComponent()->SetPosition({ 12.0f, 0.0f, 0.0f });
+
+    spDead->SetState(GameObject::State::eDead);
+    spScene->PreUpdate();
+
+    // 破棄するオブジェクトは親子関係だけ外れ、ローカル座標は親から見た値のまま残る
+    FNTEST_CHECK(spDead->GetParentPtr() == nullptr);
+    FNTEST_CHECK_VECTOR3_NEAR(spDead->GetTransformComponent()->GetLocalPos(), Math::Vector3(1.0f, 0.0f, 0.0f), 1.0e-4f);
+
+    // 生きている子は影響を受けない
+    FNTEST_CHECK(spParent->GetChildren().size() == 1);
+    FNTEST_CHECK_VECTOR3_NEAR(spAlive->GetTransformComponent()->GetWorldPos(), Math::Vector3(12.0f, 0.0f, 0.0f), 1.0e-4f);
+
+    // 生きているオブジェクトの親子外しでは、ワールド座標を保つ
+    spParent->RemoveParentChildRelation(spAlive);
+    FNTEST_CHECK_VECTOR3_NEAR(spAlive->GetTransformComponent()->GetLocalPos(), Math::Vector3(12.0f, 0.0f, 0.0f), 1.0e-4f);
+
+    spScene->Update();
+    spScene->FlushDestroyedObjects();
+}
+
+/**
+* @brief 親を持つオブジェクトをまとめて破棄するフレームの時間が、破棄する数にほぼ比例することの確認
+* @details
+*   1,000 個と 10,000 個の子をまとめて破棄し、PreUpdate の 1 個あたりの時間を比べる
+*   破棄した子ごとに並び替えると 1 個あたりの時間が子の数に比例して伸びる
+*/
+FNTEST_CASE(Scene, ParentedDespawnIsNearLinear)
+{
+    const size_t smallNum = 1000;
+    const size_t largeNum = fntest::IsQuick() ? 5000 : 10000;
+
+    UINT32 smallRebuildNum = 0;
+    UINT32 largeRebuildNum = 0;
+
+    // 最初の1回は確保などの影響が大きいので捨てて、短い方を使う
+    double smallMs = std::numeric_limits<double>::max();
+    double largeMs = std::numeric_limits<double>::max();
+    for (int i = 0; i < 3; ++i)
+    {
+        smallMs = std::min(smallMs, MeasureParentedDespawnMs(smallNum, smallRebuildNum));
+        largeMs = std::min(largeMs, MeasureParentedDespawnMs(largeNum, largeRebuildNum));
+    }
+
+    // 破棄したフレームの並び替えは Update での1回だけ
+    FNTEST_CHECK(smallRebuildNum == 1);
+    FNTEST_CHECK(largeRebuildNum == 1);
+
+    const double smallPerObject = smallMs / smallNum;
+    const double largePerObject = largeMs / largeNum;
+
+    fntest::ReportBench(std::to_string(smallNum) + " parented despawns", smallMs, "ms/frame");
+    fntest::ReportBench(std::to_string(largeNum) + " parented despawns", largeMs, "ms/frame");
+    fntest::ReportBench("time per object ratio", largePerObject / smallPerObject, "x");
+
+    // 2乗で伸びる場合は 10 倍になる : 確保やキャッシュの影響を見込んで 3 倍までを線形とみなす
+    FNTEST_CHECK(largePerObject < smallPerObject * 3.0);
+}
+
+/**
+* @brief 1秒あたり 10,000 個の生成と破棄
+* @details
+*   5,000 個が生存しているシーンで、60 フレームの間に毎フレーム 167 個ずつ生成と破棄を行う
+*   生成したオブジェクトの半分は、1つの親の子にする
+*   破棄の量を増やした場合の、1秒あたりに処理できる生成と破棄の数も出す
+*/
+FNTEST_BENCH(Scene, SpawnDespawn10kPerSecond)
+{
+    const size_t liveNum = fntest::IsQuick() ? 1000 : 5000;
+    const int frameNum = fntest::IsQuick() ? 10 : 60;
+
+    for (const size_t spawnNumPerFrame : { 167u, 1000u, 5000u })
+    {
+        auto spScene = std::make_shared<Scene>("SpawnBench");
+        const std::shared_ptr<GameObject> spParent = spScene->AddObject(GameObject::State::eActive, "Parent");
+
+        std::mt19937 rng(42);
+        std::vector<std::shared_ptr<GameObject>> live;
+
+        SpawnDespawnFrame(*spScene, spParent, live, liveNum, rng);
+
+        double maxFrameMs = 0.0;
+        fntest::Timer totalTimer;
+
+        for (int frame = 0; frame < frameNum; ++frame)
+        {
+            fntest::Timer frameTimer;
+            SpawnDespawnFrame(*spScene, spParent, live, spawnNumPerFrame, rng);
+            maxFrameMs = std::max(maxFrameMs, frameTimer.ElapsedMs());
+        }
+
+        const double totalSec = totalTimer.ElapsedSec();
+
+        const std::string prefix = std::to_string(spawnNumPerFrame) + " spawns+despawns/frame";
+        fntest::ReportBench(prefix + " / average", totalSec * 1000.0 / frameNum, "ms/frame");
+        fntest::ReportBench(prefix + " / worst", maxFrameMs, "ms/frame");
+        fntest::ReportBench(prefix + " / throughput", spawnNumPerFrame * frameNum / totalSec, "spawns+despawns/sec");
+    }
+}
@@ -0,0 +1,265 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /* @brief 同じ名前のオブジェクトを objectNum 個並べたシーンの Json を作る */
+    Json MakeSameNameSceneJson(int objectNum, std::string_view name)
+    {
+        Json json;
+        Json& objectsJson = json[jsonKey::Key_Objects.data()];
+        objectsJson = Json::array();
+
+        for (int i = 0; i < objectNum; ++i)
+        {
+            Json objJson;
+            objJson[jsonKey::Object::Key_Name.data()] = name;
+            objectsJson.push_back(std::move(objJson));
+        }
+        return json;
+    }
+
+    /* @brief 同じ名前のオブジェクトを objectNum 個読み込む時間 (ms) */
+    double MeasureSameNameLoadMs(int objectNum)
+    {
+        const Json json = MakeSameNameSceneJson(objectNum, "Enemy");
+
+        return fntest::MeasureMinMs(3, [&]()
+            {
+                auto spScene = std::make_shared<Scene>("LoadTest");
+                spScene->Deserialize(json);
+            });
+    }
+
+    /* @brief 更新の回数と Release の回数を数えるコンポーネント */
+    class TickCountComponent : public BaseComponent
+    {
+    public:
+        using BaseComponent::BaseComponent;
+
+        void Update() override { ++UpdateNum; }
+        void PostUpdate() override { ++PostUpdateNum; }
+        void Release() override { ++ReleaseNum; }
+
+        UINT32 UpdateNum = 0;
+        UINT32 PostUpdateNum = 0;
+        UINT32 ReleaseNum = 0;
+    };
+
+    /* @brief Start / Update の中でシーンやオブジェクトの構成を変える処理を呼ぶコンポーネント */
+    class StructureChangeComponent : public BaseComponent
+    {
+    public:
+        using BaseComponent::BaseComponent;
+
+        void Start() override
+        {
+            if (OnStart) { OnStart(); }
+        }
+
+        void Update() override
+        {
+            if (OnUpdate) { OnUpdate(); }
+        }
+
+        std::function<void()> OnStart;
+        std::function<void()> OnUpdate;
+    };
+
+    void UpdateFrame(Scene& scene)
+    {
+        scene.PreUpdate();
+        scene.Update();
+        scene.FlushDestroyedObjects();
+    }
+}
+
+FNTEST_CASE(Scene, GenerateUniqueNameForSameNamedObjects)
+{
+    constexpr int ObjectNum = 1000;
+
+    auto spScene = std::make_shared<Scene>("NameTest");
+    spScene->Deserialize(MakeSameNameSceneJson(ObjectNum, "Enemy"));
+
+    FNTEST_REQUIRE(spScene->GetObjectList().size() == ObjectNum);
+
+    // 1つ目はそのまま、2つ目以降は 0 からの連番が付く
+    std::unordered_set<std::string> names;
+    for (const auto& spObj : spScene->GetObjectList())
+    {
+        names.insert(spObj->GetName());
+    }
+    FNTEST_CHECK(names.size() == ObjectNum);
+    FNTEST_CHECK(names.contains("Enemy"));
+    FNTEST_CHECK(names.contains("Enemy0"));
+    FNTEST_CHECK(names.contains("Enemy" + std::to_string(ObjectNum - 2)));
+
+    // 既に連番の名前が使われていても、重複しない名前が生成される
+    spScene->AddObject(GameObject::State::eActive, "Enemy1000");
+    const std::shared_ptr<GameObject> spObj = spScene->AddObject(GameObject::State::eActive, "Enemy");
+    FNTEST_CHECK(spObj->GetName() == "Enemy999");
+    FNTEST_CHECK(spScene->AddObject(GameObject::State::eActive, "Enemy")->GetName() == "Enemy1001");
+}
+
+/**
+* @brief 同じ名前のオブジェクトを読み込む時間が、オブジェクト数にほぼ比例することの確認
+* @details
+*   名前の生成が以前のように既存の連番を先頭から探すと 1 個あたりの時間がオブジェクト数に比例して伸びる
+*   1,000 個と 10,000 個で 1 個あたりの時間を比べ、10 倍にならずにほぼ一定であることを確かめる
+*/
+FNTEST_CASE(Scene, SameNamedObjectLoadIsNearLinear)
+{
+    const int smallNum = 1000;
+    const int largeNum = fntest::IsQuick() ? 5000 : 10000;
+
+    const double smallMs = MeasureSameNameLoadMs(smallNum);
+    const double largeMs = MeasureSameNameLoadMs(largeNum);
+
+    const double smallPerObject = smallMs / smallNum;
+    const double largePerObject = largeMs / largeNum;
+
+    fntest::ReportBench(std::to_string(smallNum) + " objects", smallMs, "ms");
+    fntest::ReportBench(std::to_string(largeNum) + " objects", largeMs, "ms");
+    fntest::ReportBench("time per object ratio", largePerObject / smallPerObject, "x");
+
+    // 2乗で伸びる場合は 10 倍になる : 確保やキャッシュの影響を見込んで 3 倍までを線形とみなす
+    FNTEST_CHECK(largePerObject < smallPerObject * 3.0);
+}
+
+/**
+* @brief 更新中に外されたコンポーネントは、同じフレームの残りの更新で呼ばれず、フレームの終わりに破棄される
+* @details 更新の配列は生ポインタを持つので、外した時点で破棄されると残りのフェーズで破棄済みの領域を指してしまう
+*/
+FNTEST_CASE(Scene, RemoveComponentDuringUpdate)
+{
+    auto spScene = std::make_shared<Scene>("TickTest");
+
+    auto spChanger = spScene->AddObject(GameObject::State::eActive, "Changer");
+    auto spTarget = spScene->AddObject(GameObject::State::eActive, "Target");
+
+    auto spChangeComp = spChanger->AddComponent<StructureChangeComponent>();
+    std::weak_ptr<TickCountComponent> wpCount = spTarget->AddComponent<TickCountComponent>();
+    std::weak_ptr<StructureChangeComponent> wpChange = spChangeComp;
+
+    UpdateFrame(*spScene);
+    FNTEST_REQUIRE(!wpCount.expired());
+    FNTEST_CHECK(wpCount.lock()->UpdateNum == 1);
+
+    const UINT32 updateCompNum = spScene->GetTickComponentNum(ComponentTick::eUpdate);
+
+    // 後ろのオブジェクトのコンポーネントと、自分自身を外す
+    const std::string countName = wpCount.lock()->GetComponentName();
+    const std::string changeName = spChangeComp->GetComponentName();
+
+    spChangeComp->OnUpdate = [&]()
+        {
+            spTarget->RemoveComponent(countName);
+            spChanger->RemoveComponent(changeName);
+        };
+    spChangeComp.reset();
+
+    spScene->PreUpdate();
+    spScene->Update();
+
+    // フレームの終わりまでは破棄されず、外した後の Update と PostUpdate は呼ばれない
+    FNTEST_REQUIRE(!wpCount.expired());
+    FNTEST_CHECK(wpCount.lock()->IsRemoved());
+    FNTEST_CHECK(wpCount.lock()->UpdateNum == 1);
+    FNTEST_CHECK(wpCount.lock()->PostUpdateNum == 1);
+    FNTEST_CHECK(wpCount.lock()->ReleaseNum == 1);
+    FNTEST_CHECK(!wpChange.expired());
+
+    spScene->FlushDestroyedObjects();
+    FNTEST_CHECK(wpCount.expired());
+    FNTEST_CHECK(wpChange.expired());
+    FNTEST_CHECK(!spTarget->HasComponent<TickCountComponent>());
+
+    // 次のフレームでは配列が作り直され、外したコンポーネントは含まれない
+    UpdateFrame(*spScene);
+    FNTEST_CHECK(spScene->GetTickComponentNum(ComponentTick::eUpdate) == updateCompNum - 2);
+}
+
+/**
+* @brief 更新中に ClearObjList でシーンを読み直しても、取り除いたオブジェクトは残りの更新で呼ばれない
+* @details ChangeScene で今のシーンを読み直す場合と同じ流れ : 追加したオブジェクトは次のフレームから更新される
+*/
+FNTEST_CASE(Scene, ClearObjListDuringUpdate)
+{
+    auto spScene = std::make_shared<Scene>("TickTest");
+
+    auto spChanger = spScene->AddObject(GameObject::State::eActive, "Changer");
+    auto spOld = spScene->AddObject(GameObject::State::eActive, "Old");
+
+    auto spChangeComp = spChanger->AddComponent<StructureChangeComponent>();
+    std::weak_ptr<TickCountComponent> wpOldCount = spOld->AddComponent<TickCountComponent>();
+    std::weak_ptr<GameObject> wpOld = spOld;
+
+    spChanger.reset();
+    spOld.reset();
+
+    UpdateFrame(*spScene);
+
+    std::weak_ptr<TickCountComponent> wpNewCount;
+    spChangeComp->OnUpdate = [&]()
+        {
+            spScene->ClearObjList();
+
+            auto spNew = spScene->AddObject(GameObject::State::eActive, "New");
+            wpNewCount = spNew->AddComponent<TickCountComponent>();
+        };
+    spChangeComp.reset();
+
+    spScene->PreUpdate();
+    spScene->Update();
+
+    FNTEST_REQUIRE(!wpOldCount.expired());
+    FNTEST_CHECK(wpOldCount.lock()->UpdateNum == 1);
+    FNTEST_CHECK(wpOldCount.lock()->PostUpdateNum == 1);
+    FNTEST_REQUIRE(!wpNewCount.expired());
+    FNTEST_CHECK(wpNewCount.lock()->UpdateNum == 0);
+
+    spScene->FlushDestroyedObjects();
+    FNTEST_CHECK(wpOld.expired());
+    FNTEST_CHECK(wpOldCount.expired());
+    FNTEST_CHECK(spScene->GetObjectList().size() == 1);
+
+    UpdateFrame(*spScene);
+    FNTEST_REQUIRE(!wpNewCount.expired());
+    FNTEST_CHECK(wpNewCount.lock()->UpdateNum == 1);
+}
+
+/**
+* @brief Start / Update の中で追加されたオブジェクトは、そのフレームでは更新されず次のフレームから更新される
+* @details Start で追加されたオブジェクトは Start が済んでいないので、更新の配列を作り直すときにも並べない
+*/
+FNTEST_CASE(Scene, ObjectsAddedDuringUpdateTickNextFrame)
+{
+    auto spScene = std::make_shared<Scene>("TickTest");
+
+    auto spChangeComp = spScene->AddObject(GameObject::State::eActive, "Spawner")->AddComponent<StructureChangeComponent>();
+
+    std::vector<std::weak_ptr<TickCountComponent>> spawned;
+    const auto spawn = [&]()
+        {
+            spawned.push_back(spScene->AddObject(GameObject::State::eActive, "Spawned")->AddComponent<TickCountComponent>());
+        };
+    spChangeComp->OnStart = spawn;
+    spChangeComp->OnUpdate = spawn;
+    spChangeComp.reset();
+
+    UpdateFrame(*spScene);
+
+    // Start で追加したものは、このフレームの配列に入らない
+    FNTEST_REQUIRE(spawned.size() == 2);
+    FNTEST_CHECK(spawned[0].lock()->UpdateNum == 0);
+    FNTEST_CHECK(spawned[1].lock()->UpdateNum == 0);
+
+    UpdateFrame(*spScene);
+    UpdateFrame(*spScene);
+
+    // 1フレーム目に追加したものは 2, 3 フレーム目の2回、2フレーム目に追加したものは1回
+    FNTEST_REQUIRE(spawned.size() == 4);
+    FNTEST_CHECK(spawned[0].lock()->UpdateNum == 2);
+    FNTEST_CHECK(spawned[1].lock()->UpdateNum == 2);
+    FNTEST_CHECK(spawned[2].lock()->UpdateNum == 1);
+    FNTEST_CHECK(spawned[3].lock()->UpdateNum == 0);
+}
@@ -0,0 +1,281 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    constexpr float Epsilon = 1.0e-4f;
+
+    /**
+    * @brief 深さ depth の親子の列を並べたシーンを作る
+    * @param[in] objectNum - オブジェクト数
+    * @param[in] depth     - 1つの列の深さ : 1 の場合はすべて親を持たない
+    * @param[out] roots    - 各列の先頭のオブジェクト
+    */
+    std::shared_ptr<Scene> CreateChainScene(int objectNum, int depth, std::vector<std::shared_ptr<GameObject>>& roots)
+    {
+        auto spScene = std::make_shared<Scene>("TransformHierarchyBench");
+
+        std::shared_ptr<GameObject> spPrev;
+        for (int i = 0; i < objectNum; ++i)
+        {
+            std::shared_ptr<GameObject> spObj = spScene->AddObject(GameObject::State::eActive, "Node");
+            spObj->GetTransformComponent()->SetPosition({ 1.0f, 0.0f, 0.0f });
+
+            if (i % depth == 0)
+            {
+                roots.push_back(spObj);
+            }
+            else
+            {
+                spPrev->AddChild(spObj);
+            }
+            spPrev = spObj;
+        }
+
+        spScene->WorkTransformHierarchy().Update();
+
+        return spScene;
+    }
+
+    /**
+    * @brief objectNum 個のオブジェクトが4分木状に親子付けされたシーンの Json を作る
+    * @details i 番目のオブジェクトの親は (i - 1) / 4 番目 : 深さはオブジェクト数の対数に収まる
+    */
+    Json MakeTreeSceneJson(int objectNum)
+    {
+        Json json;
+        Json& objectsJson = json[jsonKey::Key_Objects.data()];
+        objectsJson = Json::array();
+
+        for (int i = 0; i < objectNum; ++i)
+        {
+            Json objJson;
+            objJson[jsonKey::Object::Key_Name.data()] = "Node" + std::to_string(i);
+            if (i > 0)
+            {
+                objJson[jsonKey::Object::Key_ParentName.data()] = "Node" + std::to_string((i - 1) / 4);
+            }
+            objectsJson.push_back(std::move(objJson));
+        }
+        return json;
+    }
+
+    /* @brief 4分木状に親子付けされた objectNum 個のオブジェクトを読み込み、行列を更新するまでの時間 (ms) */
+    double MeasureTreeLoadMs(int objectNum)
+    {
+        const Json json = MakeTreeSceneJson(objectNum);
+
+        return fntest::MeasureMinMs(3, [&]()
+            {
+                auto spScene = std::make_shared<Scene>("LoadTest");
+                spScene->Deserialize(json);
+                spScene->WorkTransformHierarchy().Update();
+            });
+    }
+}
+
+FNTEST_CASE(TransformHierarchy, SetPositionAppliesWorldPosition)
+{
+    auto spScene = std::make_shared<Scene>("TransformHierarchyTest");
+
+    auto spParent = spScene->AddObject(GameObject::State::eActive, "Parent");
+    auto spChild = spScene->AddObject(GameObject::State::eActive, "Child");
+
+    auto spParentTrans = spParent->GetTransformComponent();
+    auto spChildTrans = spChild->GetTransformComponent();
+
+    spParentTrans->SetPosition({ 10.0f, 0.0f, 0.0f });
+    spParentTrans->SetScale(2.0f);
+    spChildTrans->SetPosition({ 3.0f, 2.0f, 1.0f });
+
+    // 参照する前に続けて設定しても、最後の値が反映される
+    spChildTrans->SetPosition({ 4.0f, 2.0f, 1.0f });
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetWorldPos(), Math::Vector3(4.0f, 2.0f, 1.0f), Epsilon);
+
+    // 親子関係を結んでもワールド座標は変わらない
+    spParent->AddChild(spChild);
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetWorldPos(), Math::Vector3(4.0f, 2.0f, 1.0f), Epsilon);
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetLocalPos(), Math::Vector3(-3.0f, 1.0f, 0.5f), Epsilon);
+
+    // 親がいる状態でワールド座標を設定する
+    spChildTrans->SetPosition({ 0.0f, 6.0f, 0.0f });
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetWorldPos(), Math::Vector3(0.0f, 6.0f, 0.0f), Epsilon);
+
+    // 親が動くと子も動く
+    spParentTrans->SetPositionX(20.0f);
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetWorldPos(), Math::Vector3(10.0f, 6.0f, 0.0f), Epsilon);
+
+    // 親子関係を解消してもワールド座標は変わらない
+    spParent->RemoveParentChildRelation(spChild);
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetWorldPos(), Math::Vector3(10.0f, 6.0f, 0.0f), Epsilon);
+    FNTEST_CHECK_VECTOR3_NEAR(spChildTrans->GetLocalPos(), Math::Vector3(10.0f, 6.0f, 0.0f), Epsilon);
+}
+
+FNTEST_CASE(TransformHierarchy, ReparentKeepsWorldPosition)
+{
+    auto spScene = std::make_shared<Scene>("TransformHierarchyTest");
+
+    auto spParentA = spScene->AddObject(GameObject::State::eActive, "ParentA");
+    auto spParentB = spScene->AddObject(GameObject::State::eActive, "ParentB");
+    auto spChild = spScene->AddObject(GameObject::State::eActive, "Child");
+    auto spGrandChild = spScene->AddObject(GameObject::State::eActive, "GrandChild");
+
+    spParentA->GetTransformComponent()->SetPosition({ 5.0f, 0.0f, 0.0f });
+    spParentB->GetTransformComponent()->SetPosition({ 0.0f, 0.0f, -8.0f });
+    spParentB->GetTransformComponent()->SetRotation({ 0.0f, 90.0f, 0.0f });
+    spChild->GetTransformComponent()->SetPosition({ 1.0f, 1.0f, 1.0f });
+    spGrandChild->GetTransformComponent()->SetPosition({ 2.0f, 3.0f, 4.0f });
+
+    spChild->AddChild(spGrandChild);
+    spParentA->AddChild(spChild);
+
+    // 行列の計算を挟まずに付け替える : 並び替えは行わず、親を辿って SetPosition の中で計算する
+    spParentB->AddChild(spChild);
+
+    // 並び替え前でも、付け替え後の親子関係でワールド座標が求まる
+    FNTEST_CHECK_VECTOR3_NEAR(spChild->GetTransformComponent()->GetWorldPos(), Math::Vector3(1.0f, 1.0f, 1.0f), Epsilon);
+    FNTEST_CHECK_VECTOR3_NEAR(spGrandChild->GetTransformComponent()->GetWorldPos(), Math::Vector3(2.0f, 3.0f, 4.0f), Epsilon);
+
+    // 並び替え前に親を動かすと、子孫も付いてくる
+    spParentB->GetTransformComponent()->SetPositionX(3.0f);
+    FNTEST_CHECK_VECTOR3_NEAR(spGrandChild->GetTransformComponent()->GetWorldPos(), Math::Vector3(5.0f, 3.0f, 4.0f), Epsilon);
+
+    spScene->WorkTransformHierarchy().Update();
+
+    FNTEST_CHECK_VECTOR3_NEAR(spChild->GetTransformComponent()->GetWorldPos(), Math::Vector3(4.0f, 1.0f, 1.0f), Epsilon);
+    FNTEST_CHECK_VECTOR3_NEAR(spGrandChild->GetTransformComponent()->GetWorldPos(), Math::Vector3(5.0f, 3.0f, 4.0f), Epsilon);
+}
+
+/**
+* @brief 親子付けのたびに並び替えず、Update で1回だけ並び替えることの確認
+* @details 親子付けのたびに並び替えると、読み込み時に O(親子付けの数 × ノード数) かかる
+*/
+FNTEST_CASE(TransformHierarchy, ReparentDefersRebuildOrder)
+{
+    constexpr int ChildNum = 100;
+
+    auto spScene = std::make_shared<Scene>("TransformHierarchyTest");
+    TransformHierarchy& hierarchy = spScene->WorkTransformHierarchy();
+
+    auto spRoot = spScene->AddObject(GameObject::State::eActive, "Root");
+    spRoot->GetTransformComponent()->SetPosition({ 0.0f, 10.0f, 0.0f });
+
+    std::vector<std::shared_ptr<GameObject>> children;
+    for (int i = 0; i < ChildNum; ++i)
+    {
+        auto spChild = spScene->AddObject(GameObject::State::eActive, "Child");
+        spChild->GetTransformComponent()->SetPosition({ static_cast<float>(i), 0.0f, 0.0f });
+        children.push_back(spChild);
+    }
+
+    hierarchy.Update();
+    const UINT32 rebuildNum = hierarchy.GetRebuildOrderNum();
+
+    // 半分は根に、残りは手前の子に親子付けする
+    for (int i = 0; i < ChildNum; ++i)
+    {
+        const auto& spParent = i < ChildNum / 2 ? spRoot : children[i - ChildNum / 2];
+        spParent->AddChild(children[i]);
+    }
+
+    FNTEST_CHECK(hierarchy.GetRebuildOrderNum() == rebuildNum);
+
+    // 並び替え前でもワールド座標は保たれる
+    for (int i = 0; i < ChildNum; ++i)
+    {
+        FNTEST_CHECK_VECTOR3_NEAR(children[i]->GetTransformComponent()->GetWorldPos(),
+            Math::Vector3(static_cast<float>(i), 0.0f, 0.0f), Epsilon);
+    }
+    FNTEST_CHECK(hierarchy.GetRebuildOrderNum() == rebuildNum);
+
+    hierarchy.Update();
+    FNTEST_CHECK(hierarchy.GetRebuildOrderNum() == rebuildNum + 1);
+
+    // 並び替え後は根を動かすと子孫がすべて動く
+    spRoot->GetTransformComponent()->SetPositionY(20.0f);
+    hierarchy.Update();
+
+    for (int i = 0; i < ChildNum; ++i)
+    {
+        FNTEST_CHECK_VECTOR3_NEAR(children[i]->GetTransformComponent()->GetWorldPos(),
+            Math::Vector3(static_cast<float>(i), 10.0f, 0.0f), Epsilon);
+    }
+    FNTEST_CHECK(hierarchy.GetRebuildOrderNum() == rebuildNum + 1);
+}
+
+/**
+* @brief 親子付けされたオブジェクトを読み込む時間が、オブジェクト数にほぼ比例することの確認
+* @details
+*   親子付けのたびに並び替えると 1 個あたりの時間がオブジェクト数に比例して伸びる
+*   1,000 個と 10,000 個で 1 個あたりの時間を比べ、10 倍にならずにほぼ一定であることを確かめる
+*/
+FNTEST_CASE(TransformHierarchy, ParentedLoadIsNearLinear)
+{
+    const int smallNum = 1000;
+    const int largeNum = fntest::IsQuick() ? 5000 : 10000;
+
+    const double smallMs = MeasureTreeLoadMs(smallNum);
+    const double largeMs = MeasureTreeLoadMs(largeNum);
+
+    const double smallPerObject = smallMs / smallNum;
+    const double largePerObject = largeMs / largeNum;
+
+    fntest::ReportBench(std::to_string(smallNum) + " objects", smallMs, "ms");
+    fntest::ReportBench(std::to_string(largeNum) + " objects", largeMs, "ms");
+    fntest::ReportBench("time per object ratio", largePerObject / smallPerObject, "x");
+
+    // 深さは対数で伸びるだけなので、確保やキャッシュの影響を見込んで 3 倍までを線形とみなす
+    FNTEST_CHECK(largePerObject < smallPerObject * 3.0);
+}
+
+/**
+* @brief 10,000 ノードの行列の更新
+* @details
+*   深さ 1 / 4 / 16 の親子の列を並べ、毎フレームすべての列の先頭を動かす
+*   - Update       : フレームの終わりに先頭から1回走査して計算する
+*   - lazy access  : 子から順に GetWorldMatrix を呼び、参照されたノードと祖先だけを計算する
+*/
+FNTEST_BENCH(TransformHierarchy, Update10k)
+{
+    const int objectNum = fntest::IsQuick() ? 2000 : 10000;
+    const int repeat = fntest::IsQuick() ? 3 : 20;
+
+    for (const int depth : { 1, 4, 16 })
+    {
+        std::vector<std::shared_ptr<GameObject>> roots;
+        auto spScene = CreateChainScene(objectNum, depth, roots);
+
+        TransformHierarchy& hierarchy = spScene->WorkTransformHierarchy();
+        const std::vector<std::shared_ptr<GameObject>>& objects = spScene->GetObjectList();
+
+        float x = 0.0f;
+        const auto moveRoots = [&]()
+            {
+                x += 0.01f;
+                for (const auto& spRoot : roots)
+                {
+                    spRoot->GetTransformComponent()->SetPositionX(x);
+                }
+            };
+
+        const double updateMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                moveRoots();
+                hierarchy.Update();
+            });
+
+        const double lazyMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                moveRoots();
+                for (size_t i = objects.size(); i > 0; --i)
+                {
+                    fntest::DoNotOptimize(objects[i - 1]->GetTransformComponent()->GetWorldMatrix());
+                }
+            });
+
+        const std::string prefix = "depth " + std::to_string(depth);
+        fntest::ReportBench(prefix + " / Update", updateMs, "ms/frame");
+        fntest::ReportBench(prefix + " / Update", updateMs * 1.0e6 / objectNum, "ns/node");
+        fntest::ReportBench(prefix + " / lazy access", lazyMs, "ms/frame");
+        fntest::ReportBench(prefix + " / lazy access", lazyMs * 1.0e6 / objectNum, "ns/node");
+    }
+}
@@ -0,0 +1,238 @@
+﻿#include "TestFramework/Test.h"
+
+#include "Framework/Graphics/Frame/FakeUploadPageFactory.h"
+
+namespace
+{
+    /* @brief 1フレーム分の定数バッファのバインドを再現する時の規模 */
+    struct FrameTraceDesc
+    {
+        int MeshNum = 0;        // 描画するメッシュ数
+        int SubsetNum = 0;      // 1メッシュあたりのサブセット数
+        int MaterialNum = 0;    // 使われているマテリアルの種類
+    };
+
+    /**
+    * @brief 描画パスが1フレームで行う BindAttachData を、同じ型と同じ重複の仕方で upload に渡す
+    * @details
+    *   - Shadow           : カスケードごとにカメラ、メッシュごとに cbDeferredObject (IsSkin のみ)、最後にライト
+    *   - GBuffer          : カメラ、メッシュごとに cbDeferredObject
+    *   - ModelShader      : カメラ / ライト / フォグ、メッシュごとに cbObject、サブセットごとにマテリアル
+    *   - LightingPass     : スプライトの射影行列 / カメラ / ライト / フォグ / コースティクス / ライトクラスター
+    *   - PostProcess      : 射影行列を 3 パス
+    */
+    template <typename UploadFunc>
+    void ReplayFrame(const FrameTraceDesc& desc, UploadFunc&& upload)
+    {
+        const auto bind = [&](const auto& data) { upload(&data, sizeof(data)); };
+
+        // ConstantBuffer と同じく、メッシュごとのデータは同じ変数を書き換えてからバインドする
+        CBufferData::cbDeferredObject deferredObject;
+        CBufferData::cbObject object;
+        CBufferData::cbMaterial material;
+
+        CBufferData::Camera camera;
+        camera.mViewProj = Math::Matrix::CreateTranslation(1.0f, 2.0f, 3.0f);
+        camera.CamPos = { 1.0f, 2.0f, 3.0f };
+
+        CBufferData::Light light;
+        light.FramePointLightNum = 64;
+
+        const CBufferData::cbFog fog;
+        const CBufferData::cbCousticsData coustics;
+        const CBufferData::cbLightCluster lightCluster;
+        const Math::Matrix spriteProj = Math::Matrix::CreateScale(2.0f);
+
+        //x--- Shadow ---x//
+        for (UINT cascade = 0; cascade < ShadowCascade::CascadeNum; ++cascade)
+        {
+            CBufferData::Camera cascadeCamera;
+            cascadeCamera.mViewProj = Math::Matrix::CreateRotationY(static_cast<float>(cascade));
+            bind(cascadeCamera);
+
+            for (int mesh = 0; mesh < desc.MeshNum; ++mesh)
+            {
+                deferredObject.IsSkin = mesh % 8 == 0;
+                bind(deferredObject);
+            }
+        }
+        bind(light);
+
+        //x--- GBuffer ---x//
+        bind(camera);
+        for (int mesh = 0; mesh < desc.MeshNum; ++mesh)
+        {
+            deferredObject.IsSkin = mesh % 8 == 0;
+            bind(deferredObject);
+        }
+
+        //x--- ModelShader ---x//
+        bind(camera);
+        bind(light);
+        bind(fog);
+        for (int mesh = 0; mesh < desc.MeshNum; ++mesh)
+        {
+            object.mWorld = Math::Matrix::CreateTranslation(static_cast<float>(mesh), 0.0f, 0.0f);
+            bind(object);
+
+            for (int subset = 0; subset < desc.SubsetNum; ++subset)
+            {
+                material.Roughness = static_cast<float>((mesh * desc.SubsetNum + subset) % desc.MaterialNum) / desc.MaterialNum;
+                bind(material);
+            }
+        }
+
+        //x--- LightingPass ---x//
+        bind(spriteProj);
+        bind(camera);
+        bind(light);
+        bind(fog);
+        bind(coustics);
+        bind(lightCluster);
+
+        //x--- PostProcess ---x//
+        for (int pass = 0; pass < 3; ++pass)
+        {
+            bind(spriteProj);
+        }
+    }
+
+    constexpr UINT64 ConstantAlign = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+}
+
+FNTEST_CASE(ConstantUploadCache, IdenticalContentReusesAddress)
+{
+    FakeUploadPageFactory factory;
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory);
+
+    ConstantUploadCache cache;
+
+    CBufferData::cbFog fog;
+    const UINT64 first = cache.Upload(allocator, &fog, sizeof(fog));
+    const UINT64 second = cache.Upload(allocator, &fog, sizeof(fog));
+
+    FNTEST_CHECK(first != 0);
+    FNTEST_CHECK(first % ConstantAlign == 0);
+    FNTEST_CHECK(first == second);
+
+    // 内容が変われば別の領域にコピーする
+    fog.FogEnable = 1;
+    const UINT64 third = cache.Upload(allocator, &fog, sizeof(fog));
+    FNTEST_CHECK(third != first);
+    FNTEST_CHECK(third % ConstantAlign == 0);
+
+    // 先頭が同じでも、大きさが違えば別のもの
+    const UINT64 prefix = cache.Upload(allocator, &fog, sizeof(fog) - sizeof(float));
+    FNTEST_CHECK(prefix != third);
+
+    const ConstantUploadCache::Stats& stats = cache.GetStats();
+    FNTEST_CHECK(stats.RequestNum == 4);
+    FNTEST_CHECK(stats.DedupNum == 1);
+    FNTEST_CHECK(stats.UploadSize == ConstantAlign * 3);
+}
+
+/* @brief Reset の後は前のフレームの領域を使い回さない : GPU が読み終わる前に返却されるため */
+FNTEST_CASE(ConstantUploadCache, ResetForgetsPreviousFrame)
+{
+    FakeUploadPageFactory factory;
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory);
+
+    ConstantUploadCache cache;
+
+    const CBufferData::cbCousticsData coustics;
+    const UINT64 frame1 = cache.Upload(allocator, &coustics, sizeof(coustics));
+    allocator.FinishFrame(1);
+
+    cache.Reset();
+    FNTEST_CHECK(cache.GetStats().RequestNum == 0);
+
+    const UINT64 frame2 = cache.Upload(allocator, &coustics, sizeof(coustics));
+    FNTEST_CHECK(frame2 != frame1);
+    FNTEST_CHECK(cache.GetStats().DedupNum == 0);
+}
+
+/* @brief 使い回しを切ると、同じ内容でも毎回コピーする */
+FNTEST_CASE(ConstantUploadCache, DedupDisabledAlwaysUploads)
+{
+    FakeUploadPageFactory factory;
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory);
+
+    ConstantUploadCache cache;
+    cache.SetDedupEnable(false);
+
+    const CBufferData::Camera camera;
+    const UINT64 first = cache.Upload(allocator, &camera, sizeof(camera));
+    const UINT64 second = cache.Upload(allocator, &camera, sizeof(camera));
+
+    FNTEST_CHECK(first != second);
+    FNTEST_CHECK(cache.GetStats().DedupNum == 0);
+    FNTEST_CHECK(cache.GetStats().UploadSize == ((sizeof(camera) + 0xff) & ~UINT64{ 0xff }) * 2);
+}
+
+/**
+* @brief 1フレームで作成するビューの数と、コピーするサイズの比較
+* @details
+*   描画パスの BindAttachData を同じ型と同じ重複の仕方で再現し、次の3つを比べる
+*   - descriptor table : 以前の実装 : バインドごとに CBV を1つ作り、毎回コピーする
+*   - root CBV         : GPU アドレスを直接バインドする : ビューは作らないが、毎回コピーする
+*   - root CBV + dedup : 同じフレームで同じ内容のものは1回だけコピーする
+*   ビューの数は、以前の実装がバインドごとに CreateConstantBufferView を1回呼んでいたことから数える
+*   実機のフレームの値は、デバッグ表示の FPS のパネルで確認できる
+*/
+FNTEST_BENCH(ConstantUploadCache, PerFrameDescriptorsAndBytes)
+{
+    const int repeat = fntest::IsQuick() ? 3 : 20;
+
+    for (const int meshNum : { 50, 500 })
+    {
+        const FrameTraceDesc desc = { meshNum, 2, 16 };
+
+        FakeUploadPageFactory factory;
+        FrameUploadAllocator allocator;
+        allocator.Init(&factory);
+
+        ConstantUploadCache cache;
+        UINT64 fence = 0;
+
+        const auto measure = [&](bool isDedup)
+            {
+                cache.SetDedupEnable(isDedup);
+
+                const double ms = fntest::MeasureMinMs(repeat, [&]()
+                    {
+                        // フレームの始めと同じく、GPU が終わったページを戻してから使い回しを忘れる
+                        allocator.Recycle(fence);
+                        cache.Reset();
+
+                        ReplayFrame(desc, [&](const void* pData, size_t size) { cache.Upload(allocator, pData, size); });
+
+                        allocator.FinishFrame(++fence);
+                    });
+
+                return std::make_pair(ms, cache.GetStats());
+            };
+
+        const auto [copyMs, copyStats] = measure(false);
+        const auto [dedupMs, dedupStats] = measure(true);
+
+        const std::string prefix = std::to_string(meshNum) + " meshes";
+        const double bindNum = static_cast<double>(copyStats.RequestNum);
+
+        fntest::ReportBench(prefix + " / binds", bindNum, "binds/frame");
+
+        fntest::ReportBench(prefix + " / descriptor table / descriptors", bindNum, "views/frame");
+        fntest::ReportBench(prefix + " / descriptor table / uploaded", copyStats.UploadSize / 1024.0, "KB/frame");
+
+        fntest::ReportBench(prefix + " / root CBV / descriptors", 0.0, "views/frame");
+        fntest::ReportBench(prefix + " / root CBV / uploaded", copyStats.UploadSize / 1024.0, "KB/frame");
+        fntest::ReportBench(prefix + " / root CBV / CPU", copyMs * 1000.0, "us/frame");
+
+        fntest::ReportBench(prefix + " / root CBV + dedup / descriptors", 0.0, "views/frame");
+        fntest::ReportBench(prefix + " / root CBV + dedup / uploaded", dedupStats.UploadSize / 1024.0, "KB/frame");
+        fntest::ReportBench(prefix + " / root CBV + dedup / reused", static_cast<double>(dedupStats.DedupNum), "binds/frame");
+        fntest::ReportBench(prefix + " / root CBV + dedup / CPU", dedupMs * 1000.0, "us/frame");
+    }
+}
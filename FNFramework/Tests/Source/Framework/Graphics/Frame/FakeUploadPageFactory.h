@@ -0,0 +1,47 @@
+﻿#pragma once
+
+/**
+* @class FakeUploadPage
+* @brief CPU のメモリだけを持つページ : GPU のアドレスはページごとに離れた値を割り当てる
+*/
+class FakeUploadPage : public BaseUploadPage
+{
+public:
+    FakeUploadPage(UINT64 size, UINT64 gpuAddress, UINT32& liveNum)
+        : m_datas(size)
+        , m_gpuAddress(gpuAddress)
+        , m_liveNum(liveNum)
+    {
+        ++m_liveNum;
+    }
+
+    ~FakeUploadPage() override { --m_liveNum; }
+
+    std::byte* GetCPUAddress() const override { return const_cast<std::byte*>(m_datas.data()); }
+    UINT64 GetGPUAddress() const override { return m_gpuAddress; }
+    UINT64 GetSize() const override { return m_datas.size(); }
+
+private:
+    std::vector<std::byte> m_datas;
+    UINT64 m_gpuAddress = 0;
+    UINT32& m_liveNum;
+};
+
+/* @brief FakeUploadPage を作成するファクトリー : 作成数と生存数を数える */
+class FakeUploadPageFactory : public BaseUploadPageFactory
+{
+public:
+    std::unique_ptr<BaseUploadPage> CreatePage(UINT64 size) override
+    {
+        // D3D12 と同じく GPU のアドレスは 64KB 単位で始まる
+        const UINT64 gpuAddress = NextGPUAddress;
+        NextGPUAddress += (size + 0xFFFF) / 0x10000 * 0x10000 + 0x10000;
+
+        ++CreateNum;
+        return std::make_unique<FakeUploadPage>(size, gpuAddress, LiveNum);
+    }
+
+    UINT64 NextGPUAddress = 0x10000;
+    UINT32 CreateNum = 0;
+    UINT32 LiveNum = 0;
+};
@@ -0,0 +1,241 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /**
+    * @class FakeQueueFence
+    * @brief GPU の進み具合をテストから操作できるキュー
+    * @details Signal と WaitForValue の呼び出しを順に記録し、Signal していない値を待つ(デッドロック)と記録する
+    */
+    class FakeQueueFence : public BaseQueueFence
+    {
+    public:
+        // 記録した呼び出し
+        struct Event
+        {
+            enum class Type { eSignal, eWait };
+
+            Type   Kind;
+            UINT64 Value;
+        };
+
+        void Signal(UINT64 value) override
+        {
+            // Signal する値は増え続けなければならない
+            if (value <= m_lastSignaledValue) { ++BadSignalNum; }
+
+            m_lastSignaledValue = value;
+            Events.push_back({ Event::Type::eSignal, value });
+
+            if (IsImmediate) { m_completedValue = value; }
+        }
+
+        UINT64 GetCompletedValue() const override { return m_completedValue; }
+
+        void WaitForValue(UINT64 value) override
+        {
+            Events.push_back({ Event::Type::eWait, value });
+
+            // Signal していない値は GPU がいつまでも到達しない
+            if (value > m_lastSignaledValue)
+            {
+                ++DeadlockNum;
+                return;
+            }
+
+            // 待っている間に GPU がその値まで進む
+            m_completedValue = std::max(m_completedValue, value);
+        }
+
+        /* @brief GPU を value まで進める : Signal 済みの値を超えない */
+        void CompleteUpTo(UINT64 value)
+        {
+            m_completedValue = std::max(m_completedValue, std::min(value, m_lastSignaledValue));
+        }
+
+        UINT64 GetLastSignaledValue() const { return m_lastSignaledValue; }
+
+        /* @brief 待った値の一覧 */
+        std::vector<UINT64> GetWaitValues() const
+        {
+            std::vector<UINT64> values;
+            for (const Event& event : Events)
+            {
+                if (event.Kind == Event::Type::eWait) { values.push_back(event.Value); }
+            }
+            return values;
+        }
+
+        std::vector<Event> Events;
+
+        // true の場合は Signal した時点で GPU が終わる
+        bool IsImmediate = false;
+
+        UINT32 BadSignalNum = 0;
+        UINT32 DeadlockNum = 0;
+
+    private:
+        UINT64 m_lastSignaledValue = 0;
+        UINT64 m_completedValue = 0;
+    };
+
+    /* @brief BeginFrame の後に、今のスロットを前に使ったフレームが GPU で終わっているか */
+    bool IsSlotReusable(const FrameContextRing& ring, const FakeQueueFence& fence)
+    {
+        return fence.GetCompletedValue() >= ring.GetFrameFenceValue(ring.GetFrameIndex());
+    }
+}
+
+/**
+* @brief GPU が止まっている場合、フレーム数だけ先に進んだところで最も古いフレームを待つ
+* @details 3 フレームの場合、4 フレーム目はスロット 0 のフェンス(1)を、5 フレーム目はスロット 1 のフェンス(2)を待つ
+*/
+FNTEST_CASE(FrameContextRing, WaitsForOldestFrameWhenGpuStalls)
+{
+    FakeQueueFence fence;
+
+    FrameContextRing ring;
+    ring.Init(&fence, 3);
+
+    for (UINT frame = 0; frame < 5; ++frame)
+    {
+        ring.BeginFrame();
+
+        FNTEST_CHECK(ring.GetFrameIndex() == frame % 3);
+        FNTEST_CHECK(IsSlotReusable(ring, fence));
+
+        ring.EndFrame();
+    }
+
+    FNTEST_CHECK(fence.GetWaitValues() == std::vector<UINT64>({ 1, 2 }));
+    FNTEST_CHECK(ring.GetWaitNum() == 2);
+    FNTEST_CHECK(ring.GetLastSignaledValue() == 5);
+
+    // 各フレームの Signal は、そのフレームの BeginFrame の待ちより後に行われる
+    using Type = FakeQueueFence::Event::Type;
+    const std::vector<FakeQueueFence::Event>& events = fence.Events;
+    FNTEST_REQUIRE(events.size() == 7);
+    FNTEST_CHECK(events[3].Kind == Type::eWait && events[3].Value == 1);
+    FNTEST_CHECK(events[4].Kind == Type::eSignal && events[4].Value == 4);
+    FNTEST_CHECK(events[5].Kind == Type::eWait && events[5].Value == 2);
+    FNTEST_CHECK(events[6].Kind == Type::eSignal && events[6].Value == 5);
+
+    FNTEST_CHECK(fence.BadSignalNum == 0);
+    FNTEST_CHECK(fence.DeadlockNum == 0);
+}
+
+/* @brief GPU が遅れずについてきている場合は CPU を待たせない */
+FNTEST_CASE(FrameContextRing, NoWaitWhenGpuKeepsUp)
+{
+    for (const UINT frameNum : { 1u, 2u, 3u })
+    {
+        FakeQueueFence fence;
+        fence.IsImmediate = true;
+
+        FrameContextRing ring;
+        ring.Init(&fence, frameNum);
+
+        for (int frame = 0; frame < 100; ++frame)
+        {
+            ring.BeginFrame();
+            ring.EndFrame();
+        }
+
+        FNTEST_CHECK(ring.GetWaitNum() == 0);
+        FNTEST_CHECK(fence.GetWaitValues().empty());
+    }
+}
+
+/**
+* @brief GPU が フレーム数 - 1 だけ遅れている場合も待たない
+* @details 2 フレームの場合、GPU が1つ前のフレームまで終わっていれば次のフレームを始められる
+*/
+FNTEST_CASE(FrameContextRing, NoWaitWhenGpuLagsLessThanRing)
+{
+    FakeQueueFence fence;
+
+    FrameContextRing ring;
+    ring.Init(&fence, 2);
+
+    for (int frame = 0; frame < 100; ++frame)
+    {
+        ring.BeginFrame();
+        FNTEST_CHECK(IsSlotReusable(ring, fence));
+        ring.EndFrame();
+
+        // 1つ前のフレームまで終わらせる
+        fence.CompleteUpTo(ring.GetLastSignaledValue() - 1);
+    }
+
+    FNTEST_CHECK(ring.GetWaitNum() == 0);
+}
+
+/**
+* @brief GPU の進み方をランダムに変えても、順序の決まりが崩れない
+* @details
+*   - BeginFrame の後は、今のスロットを前に使ったフレームが終わっている
+*   - GPU で終わっていないフレームは フレーム数 を超えない
+*   - Signal する値は増え続け、Signal していない値は待たない
+*/
+FNTEST_CASE(FrameContextRing, RandomGpuProgressKeepsInvariants)
+{
+    std::mt19937 rng(7);
+
+    for (const UINT frameNum : { 1u, 2u, 3u })
+    {
+        FakeQueueFence fence;
+
+        FrameContextRing ring;
+        ring.Init(&fence, frameNum);
+
+        for (int frame = 0; frame < 1000; ++frame)
+        {
+            ring.BeginFrame();
+
+            FNTEST_CHECK(IsSlotReusable(ring, fence));
+
+            // これから送るフレームを含めて、終わっていないフレームはフレーム数まで
+            FNTEST_CHECK(ring.GetLastSignaledValue() - fence.GetCompletedValue() + 1 <= frameNum);
+
+            ring.EndFrame();
+
+            // GPU を 0 ~ 2 フレーム分進める
+            const UINT64 advance = std::uniform_int_distribution<UINT64>(0, 2)(rng);
+            fence.CompleteUpTo(fence.GetCompletedValue() + advance);
+        }
+
+        FNTEST_CHECK(fence.BadSignalNum == 0);
+        FNTEST_CHECK(fence.DeadlockNum == 0);
+    }
+}
+
+/* @brief WaitIdle は送ったすべてのフレームが終わるまで待ち、その後のフレームは待たずに始められる */
+FNTEST_CASE(FrameContextRing, WaitIdleDrainsAllFrames)
+{
+    FakeQueueFence fence;
+
+    FrameContextRing ring;
+    ring.Init(&fence, 3);
+
+    for (int frame = 0; frame < 2; ++frame)
+    {
+        ring.BeginFrame();
+        ring.EndFrame();
+    }
+
+    ring.WaitIdle();
+
+    FNTEST_CHECK(fence.GetCompletedValue() == fence.GetLastSignaledValue());
+    FNTEST_CHECK(fence.GetWaitValues() == std::vector<UINT64>({ 3 }));
+
+    const UINT64 waitNum = ring.GetWaitNum();
+    for (int frame = 0; frame < 3; ++frame)
+    {
+        ring.BeginFrame();
+        ring.EndFrame();
+    }
+    FNTEST_CHECK(ring.GetWaitNum() == waitNum);
+
+    FNTEST_CHECK(fence.BadSignalNum == 0);
+    FNTEST_CHECK(fence.DeadlockNum == 0);
+}
@@ -0,0 +1,243 @@
+﻿#include "TestFramework/Test.h"
+
+#include "FakeUploadPageFactory.h"
+
+namespace
+{
+    constexpr UINT64 PageSize = 4096;
+}
+
+/* @brief ページの先頭からの位置と GPU のアドレスがアライメントに合い、領域が重ならない */
+FNTEST_CASE(FrameUploadAllocator, AllocationsAreAlignedAndDisjoint)
+{
+    FakeUploadPageFactory factory;
+
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory, PageSize);
+
+    // 2のべき乗でないアライメントも含める
+    constexpr std::array<UINT64, 8> Aligns = { 1, 4, 16, 256, 3, 48, 256, 7 };
+
+    std::vector<UploadAllocation> allocations;
+    for (int i = 0; i < 64; ++i)
+    {
+        const UINT64 align = Aligns[i % Aligns.size()];
+        const UINT64 size = 1 + (i * 37) % 200;
+
+        const UploadAllocation allocation = allocator.Allocate(size, align);
+        FNTEST_REQUIRE(allocation.IsValid());
+
+        FNTEST_CHECK(allocation.Size == size);
+        FNTEST_CHECK(allocation.Offset % align == 0);
+
+        // ページの GPU のアドレスは 64KB 単位なので、2のべき乗のアライメントは GPU のアドレスでも合う
+        if ((align & (align - 1)) == 0) { FNTEST_CHECK(allocation.GPUAddress % align == 0); }
+
+        FNTEST_CHECK(allocation.Offset + size <= PageSize);
+        FNTEST_CHECK(allocation.pCPU == allocation.pPage->GetCPUAddress() + allocation.Offset);
+        FNTEST_CHECK(allocation.GPUAddress == allocation.pPage->GetGPUAddress() + allocation.Offset);
+
+        allocations.push_back(allocation);
+    }
+
+    // 同じページの中で領域が重ならない
+    for (size_t i = 0; i < allocations.size(); ++i)
+    {
+        for (size_t j = i + 1; j < allocations.size(); ++j)
+        {
+            const UploadAllocation& a = allocations[i];
+            const UploadAllocation& b = allocations[j];
+            if (a.pPage != b.pPage) { continue; }
+
+            FNTEST_CHECK(a.Offset + a.Size <= b.Offset || b.Offset + b.Size <= a.Offset);
+        }
+    }
+
+    // 大きさ 0 は切り出さない
+    FNTEST_CHECK(!allocator.Allocate(0, 16).IsValid());
+}
+
+/* @brief ページに収まらなくなったら次のページの先頭に移り、Upload はデータをコピーする */
+FNTEST_CASE(FrameUploadAllocator, MovesToNextPageWhenFull)
+{
+    FakeUploadPageFactory factory;
+
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory, PageSize);
+
+    const UploadAllocation first = allocator.Allocate(3000, 256);
+    const UploadAllocation second = allocator.Allocate(3000, 256);
+
+    FNTEST_CHECK(first.pPage != second.pPage);
+    FNTEST_CHECK(second.Offset == 0);
+    FNTEST_CHECK(allocator.GetPageNum() == 2);
+
+    // 残りに収まるものは今のページから切り出す
+    const std::array<float, 4> values = { 1.0f, 2.0f, 3.0f, 4.0f };
+    const UploadAllocation third = allocator.Upload<float>(values, 16);
+
+    FNTEST_CHECK(third.pPage == second.pPage);
+    FNTEST_CHECK(third.Offset == 3008);
+    FNTEST_CHECK(std::memcmp(third.pCPU, values.data(), sizeof(values)) == 0);
+
+    allocator.FinishFrame(1);
+    FNTEST_CHECK(allocator.GetLastFrameUsedSize() == 6000 + sizeof(values));
+    FNTEST_CHECK(allocator.GetRetiredPageNum() == 2);
+}
+
+/**
+* @brief GPU がフェンスの値まで終わるまで、そのフレームで使ったページを使い回さない
+* @details フレーム 1 で書き込んだ内容は、Recycle(1) までのフレームで上書きされない
+*/
+FNTEST_CASE(FrameUploadAllocator, PagesAreGatedByFence)
+{
+    FakeUploadPageFactory factory;
+
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory, PageSize);
+
+    // フレーム 1
+    const UploadAllocation frame1 = allocator.Allocate(PageSize, 1);
+    std::memset(frame1.pCPU, 0xAB, PageSize);
+    allocator.FinishFrame(1);
+
+    // フレーム 2 : GPU はまだ何も終えていない
+    allocator.Recycle(0);
+    const UploadAllocation frame2 = allocator.Allocate(PageSize, 1);
+    std::memset(frame2.pCPU, 0xCD, PageSize);
+    allocator.FinishFrame(2);
+
+    FNTEST_CHECK(frame2.pPage != frame1.pPage);
+    FNTEST_CHECK(factory.CreateNum == 2);
+
+    const std::vector<std::byte> frame1Datas(frame1.pCPU, frame1.pCPU + PageSize);
+    FNTEST_CHECK(std::all_of(frame1Datas.begin(), frame1Datas.end(), [](std::byte b) { return b == std::byte{ 0xAB }; }));
+
+    // フレーム 3 : GPU がフレーム 1 を終えたので、フレーム 1 のページだけが空きに戻る
+    allocator.Recycle(1);
+    FNTEST_CHECK(allocator.GetFreePageNum() == 1);
+    FNTEST_CHECK(allocator.GetRetiredPageNum() == 1);
+
+    const UploadAllocation frame3 = allocator.Allocate(16, 16);
+    FNTEST_CHECK(frame3.pPage == frame1.pPage);
+    FNTEST_CHECK(factory.CreateNum == 2);
+
+    allocator.FinishFrame(3);
+
+    // 途中までしか終わっていない場合は、終わったフェンスのページだけが戻る
+    allocator.Recycle(2);
+    FNTEST_CHECK(allocator.GetFreePageNum() == 1);
+    FNTEST_CHECK(allocator.GetRetiredPageNum() == 1);
+}
+
+/* @brief 1ページに収まらない大きさは専用のページを作り、返却時に使い回さずに破棄する */
+FNTEST_CASE(FrameUploadAllocator, OversizedAllocationUsesDedicatedPage)
+{
+    FakeUploadPageFactory factory;
+
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory, PageSize);
+
+    const UploadAllocation allocation = allocator.Allocate(PageSize * 3, 256);
+    FNTEST_REQUIRE(allocation.IsValid());
+    FNTEST_CHECK(allocation.pPage->GetSize() == PageSize * 3);
+    FNTEST_CHECK(allocation.Offset == 0);
+
+    allocator.FinishFrame(1);
+    allocator.Recycle(1);
+
+    FNTEST_CHECK(factory.LiveNum == 0);
+    FNTEST_CHECK(allocator.GetFreePageNum() == 0);
+}
+
+/**
+* @brief 3 フレームを同時に送る場合の、ページの使い回し
+* @details
+*   毎フレーム 1.5 ページ分を切り出し、GPU は 2 フレーム遅れて終わる
+*   最初の数フレームでページが揃った後は、新しいページを作らずにリングのように使い回す
+*/
+FNTEST_CASE(FrameUploadAllocator, PagesCycleAsRingInSteadyState)
+{
+    constexpr UINT64 FrameLatency = 2;
+
+    FakeUploadPageFactory factory;
+
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory, PageSize);
+
+    UINT32 warmUpCreateNum = 0;
+
+    for (UINT64 fence = 1; fence <= 100; ++fence)
+    {
+        allocator.Recycle(fence > FrameLatency ? fence - FrameLatency - 1 : 0);
+
+        for (int i = 0; i < 6; ++i)
+        {
+            FNTEST_REQUIRE(allocator.Allocate(1024, 256).IsValid());
+        }
+
+        allocator.FinishFrame(fence);
+
+        if (fence == 10) { warmUpCreateNum = factory.CreateNum; }
+    }
+
+    FNTEST_CHECK(factory.CreateNum == warmUpCreateNum);
+
+    // 同時に使うのは 3 フレーム分 : 1 フレームで 2 ページを使う
+    FNTEST_CHECK(allocator.GetPageNum() <= 2 * (FrameLatency + 2));
+
+    allocator.Release();
+    FNTEST_CHECK(factory.LiveNum == 0);
+}
+
+/**
+* @brief 大きさとアライメントと GPU の進み方をランダムに変えても、GPU が読んでいるページに切り出さない
+* @details ページごとに最後に使ったフレームのフェンスを覚え、切り出すたびに Recycle した値以下であることを確かめる
+*/
+FNTEST_CASE(FrameUploadAllocator, RandomFramesNeverReuseInFlightPages)
+{
+    std::mt19937 rng(3);
+
+    FakeUploadPageFactory factory;
+
+    FrameUploadAllocator allocator;
+    allocator.Init(&factory, PageSize);
+
+    std::unordered_map<const BaseUploadPage*, UINT64> pageToFence;
+
+    UINT64 completedFence = 0;
+    UINT32 reuseInFlightNum = 0;
+
+    for (UINT64 fence = 1; fence <= 500; ++fence)
+    {
+        allocator.Recycle(completedFence);
+
+        const int allocateNum = std::uniform_int_distribution<int>(0, 12)(rng);
+        for (int i = 0; i < allocateNum; ++i)
+        {
+            const UINT64 size = std::uniform_int_distribution<UINT64>(1, PageSize + PageSize / 2)(rng);
+            const UINT64 align = UINT64{ 1 } << std::uniform_int_distribution<int>(0, 8)(rng);
+
+            const UploadAllocation allocation = allocator.Allocate(size, align);
+            FNTEST_REQUIRE(allocation.IsValid());
+
+            // 前に使ったフレームが GPU で終わっていないページは使わない
+            const auto it = pageToFence.find(allocation.pPage);
+            if (it != pageToFence.end() && it->second != fence && it->second > completedFence)
+            {
+                ++reuseInFlightNum;
+            }
+            pageToFence[allocation.pPage] = fence;
+        }
+
+        allocator.FinishFrame(fence);
+
+        // GPU を 0 ~ 2 フレーム分進める : 送ったフレームは超えない
+        completedFence = std::min(fence, completedFence + std::uniform_int_distribution<UINT64>(0, 2)(rng));
+
+        // 破棄された専用のページと同じアドレスが使われることがあるので、返却されたものは忘れる
+        std::erase_if(pageToFence, [&](const auto& pair) { return pair.second <= completedFence; });
+    }
+
+    FNTEST_CHECK(reuseInFlightNum == 0);
+}
@@ -0,0 +1,169 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    constexpr float ScreenHeight = 1080.0f;
+
+    // LOD ごとの誤差 : モデル空間の距離
+    constexpr std::array<float, ModelLOD::MaxLODNum> LODErrors = { 0.0f, 0.01f, 0.04f };
+
+    ModelLOD::View CreateTestView()
+    {
+        const Math::Matrix mProj = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+        return ModelLOD::CreateView(Math::Vector3::Zero, mProj, ScreenHeight);
+    }
+
+    /* @brief LOD 1 の誤差が画面上で pixel ピクセルになる pixelPerError */
+    float PixelPerErrorForLOD1(float pixel)
+    {
+        return pixel / LODErrors[1];
+    }
+
+    /**
+    * @brief 距離を変えながら毎フレーム LOD を選び、切り替わった回数を数える
+    * @param[in] distances - フレームごとの、カメラから球の中心までの距離
+    */
+    UINT CountSwitches(const std::vector<float>& distances, float hysteresisRate, UINT& lod)
+    {
+        const ModelLOD::View view = CreateTestView();
+
+        UINT switchNum = 0;
+        for (const float distance : distances)
+        {
+            const float pixelPerError = ModelLOD::CalcPixelPerError(view, { 0.0f, 0.0f, distance }, 1.0f, 1.0f);
+            const UINT nextLOD = ModelLOD::SelectLOD(LODErrors, pixelPerError, lod, ModelLOD::DefaultErrorPixel, hysteresisRate);
+
+            if (nextLOD != lod) { ++switchNum; }
+            lod = nextLOD;
+        }
+        return switchNum;
+    }
+}
+
+FNTEST_CASE(ModelLOD, PixelPerErrorUsesNearestPointOfSphere)
+{
+    const ModelLOD::View view = CreateTestView();
+    FNTEST_REQUIRE(view.IsValid());
+
+    // 距離 1 で画面の縦幅の半分が tan(fovY / 2) になる
+    const float expectedScale = ScreenHeight * 0.5f / std::tan(DirectX::XMConvertToRadians(30.0f));
+    FNTEST_CHECK_NEAR(view.PixelScale, expectedScale, expectedScale * 1.0e-5f);
+
+    // 中心まで 10、半径 2 なら一番近い点までは 8
+    const float pixelPerError = ModelLOD::CalcPixelPerError(view, { 0.0f, 0.0f, 10.0f }, 2.0f, 1.0f);
+    FNTEST_CHECK_NEAR(pixelPerError, view.PixelScale / 8.0f, view.PixelScale * 1.0e-6f);
+
+    // 拡大したモデルは誤差も拡大される
+    FNTEST_CHECK_NEAR(ModelLOD::CalcPixelPerError(view, { 0.0f, 0.0f, 10.0f }, 2.0f, 3.0f), pixelPerError * 3.0f, pixelPerError * 1.0e-5f);
+
+    // 球の中にカメラが入っても 0 で割らない
+    FNTEST_CHECK_NEAR(ModelLOD::CalcPixelPerError(view, { 0.0f, 0.0f, 1.0f }, 5.0f, 1.0f),
+        view.PixelScale / ModelLOD::MinDistance, view.PixelScale * 1.0e-3f);
+
+    // カメラが無効なら LOD を下げない
+    FNTEST_CHECK(ModelLOD::CalcPixelPerError(ModelLOD::View{}, { 0.0f, 0.0f, 10.0f }, 2.0f, 1.0f) == 0.0f);
+}
+
+FNTEST_CASE(ModelLOD, SelectsCoarsestLODWithinError)
+{
+    // LOD 1 が 0.5 ピクセル / LOD 2 が 2 ピクセル : LOD 1 を選ぶ
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(0.5f), 0) == 1);
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(0.5f), 2) == 1);
+
+    // 十分遠ければ1回で LOD 2 まで下げ、十分近ければ1回で LOD 0 まで戻す
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(0.05f), 0) == 2);
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(10.0f), 2) == 0);
+
+    // 誤差を大きく許容すると粗い LOD になる : LOD 2 は 8 ピクセル
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(2.0f), 0, 20.0f) == 2);
+
+    // LOD が1つしかない / カメラが無効 / 前回の LOD が範囲外
+    FNTEST_CHECK(ModelLOD::SelectLOD(std::span<const float>(LODErrors).first(1), PixelPerErrorForLOD1(0.01f), 0) == 0);
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, 0.0f, 2) == 0);
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(0.05f), 7) == 2);
+}
+
+FNTEST_CASE(ModelLOD, HysteresisBandKeepsCurrentLOD)
+{
+    // 閾値の幅は 0.75 ~ 1.25 ピクセル : この中では前回の LOD のまま
+    for (const float pixel : { 0.8f, 1.0f, 1.2f })
+    {
+        FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(pixel), 0) == 0);
+        FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(pixel), 1) == 1);
+    }
+
+    // 幅を出たら切り替わる
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(0.7f), 0) == 1);
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(1.3f), 1) == 0);
+
+    // 幅を 0 にすると閾値ちょうどで切り替わる
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(0.99f), 0, 1.0f, 0.0f) == 1);
+    FNTEST_CHECK(ModelLOD::SelectLOD(LODErrors, PixelPerErrorForLOD1(1.01f), 1, 1.0f, 0.0f) == 0);
+}
+
+FNTEST_CASE(ModelLOD, NoFlickerAroundSwitchDistance)
+{
+    const ModelLOD::View view = CreateTestView();
+
+    // LOD 1 の誤差がちょうど 1 ピクセルになる距離 : 半径 1 の球なので、中心まではそれより 1 遠い
+    const float switchDistance = view.PixelScale * LODErrors[1] / ModelLOD::DefaultErrorPixel + 1.0f;
+
+    // 切り替わる距離の前後 5% を行き来する
+    std::vector<float> distances;
+    for (int frame = 0; frame < 120; ++frame)
+    {
+        distances.push_back(switchDistance * (frame % 2 == 0 ? 0.95f : 1.05f));
+    }
+
+    UINT lod = 0;
+    FNTEST_CHECK(CountSwitches(distances, ModelLOD::HysteresisRate, lod) == 0);
+
+    lod = 1;
+    FNTEST_CHECK(CountSwitches(distances, ModelLOD::HysteresisRate, lod) == 0);
+
+    // 幅がないと、近い側から始めて2フレーム目から毎フレーム切り替わる
+    lod = 0;
+    FNTEST_CHECK(CountSwitches(distances, 0.0f, lod) == distances.size() - 1);
+}
+
+FNTEST_CASE(ModelLOD, MovingAwayOnlyCoarsens)
+{
+    const ModelLOD::View view = CreateTestView();
+
+    std::vector<float> awayDistances;
+    for (float distance = 2.0f; distance < 200.0f; distance *= 1.02f) { awayDistances.push_back(distance); }
+
+    std::vector<float> nearDistances(awayDistances.rbegin(), awayDistances.rend());
+
+    // 離れる間は粗くなるだけ、近づく間は細かくなるだけ
+    const auto collectSwitchDistances = [&](const std::vector<float>& distances, bool isAway)
+        {
+            std::vector<float> switchDistances;
+            UINT lod = isAway ? 0 : ModelLOD::MaxLODNum - 1;
+
+            for (const float distance : distances)
+            {
+                const float pixelPerError = ModelLOD::CalcPixelPerError(view, { 0.0f, 0.0f, distance }, 1.0f, 1.0f);
+                const UINT nextLOD = ModelLOD::SelectLOD(LODErrors, pixelPerError, lod);
+
+                FNTEST_CHECK(isAway ? nextLOD >= lod : nextLOD <= lod);
+                if (nextLOD != lod) { switchDistances.push_back(distance); }
+                lod = nextLOD;
+            }
+
+            FNTEST_CHECK(lod == (isAway ? ModelLOD::MaxLODNum - 1 : 0u));
+            return switchDistances;
+        };
+
+    const std::vector<float> awaySwitches = collectSwitchDistances(awayDistances, true);
+    std::vector<float> nearSwitches = collectSwitchDistances(nearDistances, false);
+    std::reverse(nearSwitches.begin(), nearSwitches.end());
+
+    // 粗くする距離は、細かくする距離より遠い
+    FNTEST_REQUIRE(awaySwitches.size() == ModelLOD::MaxLODNum - 1);
+    FNTEST_REQUIRE(nearSwitches.size() == ModelLOD::MaxLODNum - 1);
+    for (size_t i = 0; i < awaySwitches.size(); ++i)
+    {
+        FNTEST_CHECK(awaySwitches[i] > nearSwitches[i]);
+    }
+}
@@ -0,0 +1,473 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    // クラスターを作るメッシュ
+    struct TestMesh
+    {
+        std::vector<Math::Vector3> Positions;
+        std::vector<MeshFace> Faces;
+        std::vector<MeshCluster::Cluster> Clusters;
+    };
+
+    /**
+    * @brief 半径 1 の正二十面体を分割した球 : 面は外向き、分割した面は続けて並ぶので近くの面がまとまる
+    * @param[in] subdivNum - 分割の回数 : 面の数は 20 * 4^subdivNum
+    */
+    TestMesh CreateIcoSphere(int subdivNum)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+        TestMesh mesh;
+        mesh.Positions = {
+            { -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+            { 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+            { t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f },
+        };
+        for (Math::Vector3& pos : mesh.Positions) { pos.Normalize(); }
+
+        mesh.Faces = {
+            { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+            { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+            { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+            { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+        };
+
+        for (int subdiv = 0; subdiv < subdivNum; ++subdiv)
+        {
+            std::map<std::pair<UINT, UINT>, UINT> midpoints;
+            const auto getMidpoint = [&](UINT a, UINT b)
+                {
+                    const std::pair<UINT, UINT> key = { std::min(a, b), std::max(a, b) };
+                    auto [it, isInserted] = midpoints.try_emplace(key, static_cast<UINT>(mesh.Positions.size()));
+                    if (isInserted)
+                    {
+                        Math::Vector3 mid = (mesh.Positions[a] + mesh.Positions[b]) * 0.5f;
+                        mid.Normalize();
+                        mesh.Positions.push_back(mid);
+                    }
+                    return it->second;
+                };
+
+            std::vector<MeshFace> subdivFaces;
+            subdivFaces.reserve(mesh.Faces.size() * 4);
+            for (const MeshFace& face : mesh.Faces)
+            {
+                const UINT a = getMidpoint(face.Idx[0], face.Idx[1]);
+                const UINT b = getMidpoint(face.Idx[1], face.Idx[2]);
+                const UINT c = getMidpoint(face.Idx[2], face.Idx[0]);
+
+                subdivFaces.push_back({ face.Idx[0], a, c });
+                subdivFaces.push_back({ face.Idx[1], b, a });
+                subdivFaces.push_back({ face.Idx[2], c, b });
+                subdivFaces.push_back({ a, b, c });
+            }
+            mesh.Faces.swap(subdivFaces);
+        }
+
+        MeshCluster::Build(mesh.Faces, 0, mesh.Positions, mesh.Clusters);
+        return mesh;
+    }
+
+    // 面の法線 : MeshCluster と同じく巻き順から求める
+    Math::Vector3 CalcFaceNormal(const TestMesh& mesh, const MeshFace& face)
+    {
+        const Math::Vector3& p0 = mesh.Positions[face.Idx[0]];
+        Math::Vector3 normal = (mesh.Positions[face.Idx[1]] - p0).Cross(mesh.Positions[face.Idx[2]] - p0);
+        normal.Normalize();
+        return normal;
+    }
+
+    // カメラから面の表が見えるか
+    bool IsFrontFace(const TestMesh& mesh, const MeshFace& face, const Math::Vector3& cameraPos)
+    {
+        return CalcFaceNormal(mesh, face).Dot(cameraPos - mesh.Positions[face.Idx[0]]) > 0.0f;
+    }
+
+    /* @brief 裏向きの判定だけを行うカメラ : 平面はどの球も内側にする */
+    MeshCluster::CullView CreateConeOnlyView(const Math::Vector3& cameraPos)
+    {
+        MeshCluster::CullView view;
+        for (Math::Vector4& plane : view.Planes.Plane) { plane = { 0.0f, 0.0f, 0.0f, 1.0f }; }
+        view.CameraPos = cameraPos;
+        view.UseCone = true;
+        return view;
+    }
+
+    Math::Matrix CreateViewProj(const Math::Vector3& cameraPos, float yawDegree)
+    {
+        const Math::Matrix mCamera = Math::Matrix::CreateRotationY(DirectX::XMConvertToRadians(yawDegree)) *
+            Math::Matrix::CreateTranslation(cameraPos);
+
+        const Math::Matrix mProj = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+
+        return mCamera.Invert() * mProj;
+    }
+
+    // 単位球の上に散らしたカメラの向き
+    std::vector<Math::Vector3> CreateDirections(UINT num)
+    {
+        std::mt19937 rng(11);
+        std::normal_distribution<float> dist(0.0f, 1.0f);
+
+        std::vector<Math::Vector3> dirs(num);
+        for (Math::Vector3& dir : dirs)
+        {
+            dir = { dist(rng), dist(rng), dist(rng) };
+            dir.Normalize();
+        }
+        return dirs;
+    }
+}
+
+FNTEST_CASE(MeshCluster, BuildCoversFacesInOrder)
+{
+    const TestMesh mesh = CreateIcoSphere(4);
+
+    FNTEST_REQUIRE(mesh.Clusters.size() >= MeshCluster::MinCullClusterNum);
+
+    UINT nextFace = 0;
+    for (const MeshCluster::Cluster& cluster : mesh.Clusters)
+    {
+        // 面の並びを変えずに、前から詰めている
+        FNTEST_CHECK(cluster.FaceStart == nextFace);
+        FNTEST_CHECK(cluster.FaceCount > 0);
+        FNTEST_CHECK(cluster.FaceCount <= MeshCluster::MaxFaceNum);
+        nextFace = cluster.FaceStart + cluster.FaceCount;
+
+        std::set<UINT> vertexIndices;
+        for (UINT faceIdx = cluster.FaceStart; faceIdx < cluster.FaceStart + cluster.FaceCount; ++faceIdx)
+        {
+            vertexIndices.insert(std::begin(mesh.Faces[faceIdx].Idx), std::end(mesh.Faces[faceIdx].Idx));
+        }
+        FNTEST_CHECK(vertexIndices.size() <= MeshCluster::MaxVertexNum);
+    }
+    FNTEST_CHECK(nextFace == mesh.Faces.size());
+
+    // faceStart はメッシュの面の番号として足される
+    std::vector<MeshCluster::Cluster> offsetClusters;
+    MeshCluster::Build(mesh.Faces, 1000, mesh.Positions, offsetClusters);
+
+    FNTEST_REQUIRE(offsetClusters.size() == mesh.Clusters.size());
+    FNTEST_CHECK(offsetClusters.front().FaceStart == 1000);
+    FNTEST_CHECK(offsetClusters.back().FaceStart == mesh.Clusters.back().FaceStart + 1000);
+}
+
+FNTEST_CASE(MeshCluster, BoundsContainClusterFaces)
+{
+    const TestMesh mesh = CreateIcoSphere(4);
+
+    UINT coneNum = 0;
+    for (const MeshCluster::Cluster& cluster : mesh.Clusters)
+    {
+        const bool hasCone = cluster.ConeCutoff < 1.0f;
+
+        // コーンの軸と法線の内積の最小値 : 広がりの角度の cos
+        const float minDot = std::sqrt(std::max(0.0f, 1.0f - cluster.ConeCutoff * cluster.ConeCutoff));
+
+        float maxDistance = 0.0f;
+        for (UINT faceIdx = cluster.FaceStart; faceIdx < cluster.FaceStart + cluster.FaceCount; ++faceIdx)
+        {
+            const MeshFace& face = mesh.Faces[faceIdx];
+            for (UINT idx : face.Idx)
+            {
+                maxDistance = std::max(maxDistance, Math::Vector3::Distance(cluster.Center, mesh.Positions[idx]));
+            }
+
+            if (hasCone)
+            {
+                FNTEST_CHECK(CalcFaceNormal(mesh, face).Dot(cluster.ConeAxis) >= minDot - 1.0e-4f);
+            }
+        }
+
+        // 全部の頂点を包み、一番遠い頂点で接している
+        FNTEST_CHECK(maxDistance <= cluster.Radius + 1.0e-5f);
+        FNTEST_CHECK_NEAR(maxDistance, cluster.Radius, 1.0e-5f);
+
+        if (!hasCone) { continue; }
+
+        // 面は外向きなので、コーンの軸も外を向く
+        ++coneNum;
+        FNTEST_CHECK(cluster.ConeAxis.Dot(cluster.Center) > 0.0f);
+    }
+
+    // 球の小さな部分なので、ほとんどのクラスターは法線の広がりが狭い
+    FNTEST_CHECK(coneNum * 10 > mesh.Clusters.size() * 9);
+}
+
+FNTEST_CASE(MeshCluster, ConeCullingNeverRemovesFrontFaces)
+{
+    const TestMesh mesh = CreateIcoSphere(5);
+
+    UINT64 culledNum = 0;
+    UINT64 testedNum = 0;
+
+    // 近くから遠くまで、いろいろな向きから見る
+    for (const float distance : { 1.05f, 1.5f, 3.0f, 20.0f })
+    {
+        for (const Math::Vector3& dir : CreateDirections(64))
+        {
+            const MeshCluster::CullView view = CreateConeOnlyView(dir * distance);
+
+            for (const MeshCluster::Cluster& cluster : mesh.Clusters)
+            {
+                ++testedNum;
+                if (MeshCluster::IsVisible(cluster, view)) { continue; }
+
+                ++culledNum;
+
+                // 外したクラスターには、表が見える面が1つもない
+                bool hasFrontFace = false;
+                for (UINT faceIdx = cluster.FaceStart; faceIdx < cluster.FaceStart + cluster.FaceCount; ++faceIdx)
+                {
+                    hasFrontFace |= IsFrontFace(mesh, mesh.Faces[faceIdx], view.CameraPos);
+                }
+                FNTEST_CHECK(!hasFrontFace);
+            }
+        }
+    }
+
+    // 判定は球とコーンの広がりの分だけ控えめだが、裏を向いた面の半分近くは外れる
+    FNTEST_CHECK(culledNum * 5 > testedNum);
+}
+
+FNTEST_CASE(MeshCluster, ConeCullingRemovesBackOfSphere)
+{
+    const TestMesh mesh = CreateIcoSphere(5);
+
+    const MeshCluster::CullView view = CreateConeOnlyView({ 0.0f, 0.0f, -20.0f });
+
+    for (const MeshCluster::Cluster& cluster : mesh.Clusters)
+    {
+        const float facing = cluster.ConeAxis.Dot(Math::Vector3(0.0f, 0.0f, -1.0f));
+
+        // カメラの方を向いたクラスターは残り、反対側の法線の広がりが狭いクラスターは外れる
+        if (facing > 0.5f) { FNTEST_CHECK(MeshCluster::IsVisible(cluster, view)); }
+        if (facing < -0.7f && cluster.ConeCutoff < 0.5f) { FNTEST_CHECK(!MeshCluster::IsVisible(cluster, view)); }
+    }
+
+    // 球の中から見ると全部の面が裏を向いている : 中心の近くから見ても半分以上は外れる
+    const MeshCluster::CullView insideView = CreateConeOnlyView(Math::Vector3::Zero);
+    const auto visibleNum = std::count_if(mesh.Clusters.begin(), mesh.Clusters.end(),
+        [&](const MeshCluster::Cluster& cluster) { return MeshCluster::IsVisible(cluster, insideView); });
+    FNTEST_CHECK(static_cast<size_t>(visibleNum) * 2 < mesh.Clusters.size());
+}
+
+FNTEST_CASE(MeshCluster, FrustumCullingUsesModelSpace)
+{
+    const TestMesh mesh = CreateIcoSphere(4);
+
+    // 半径 10 の球を (0, 0, 30) に置き、球の中心から +Z を見る : 後ろ半分は視錐台の外
+    const Math::Matrix mWorld = Math::Matrix::CreateScale(10.0f) * Math::Matrix::CreateTranslation(0.0f, 0.0f, 30.0f);
+    const Math::Vector3 cameraPos = { 0.0f, 0.0f, 30.0f };
+
+    MeshCluster::CullView view = MeshCluster::CreateCullView(mWorld, CreateViewProj(cameraPos, 0.0f), cameraPos);
+    FNTEST_CHECK_VECTOR3_NEAR(view.CameraPos, Math::Vector3::Zero, 1.0e-4f);
+    FNTEST_CHECK(view.UseCone);
+
+    // 中からは全部裏向きなので、視錐台だけで判定する
+    view.UseCone = false;
+
+    UINT visibleNum = 0;
+    for (const MeshCluster::Cluster& cluster : mesh.Clusters)
+    {
+        // 頂点が1つでも視錐台の中にあれば、外してはいけない
+        bool isInside = false;
+        for (UINT faceIdx = cluster.FaceStart; faceIdx < cluster.FaceStart + cluster.FaceCount; ++faceIdx)
+        {
+            for (UINT idx : mesh.Faces[faceIdx].Idx)
+            {
+                const Math::Vector3& pos = mesh.Positions[idx];
+                isInside |= std::all_of(view.Planes.Plane.begin(), view.Planes.Plane.end(), [&](const Math::Vector4& plane)
+                    {
+                        return plane.x * pos.x + plane.y * pos.y + plane.z * pos.z + plane.w >= 0.0f;
+                    });
+            }
+        }
+
+        const bool isVisible = MeshCluster::IsVisible(cluster, view);
+        if (isInside) { FNTEST_CHECK(isVisible); }
+
+        // カメラの後ろのクラスターは外れる
+        if (cluster.Center.z < -cluster.Radius) { FNTEST_CHECK(!isVisible); }
+
+        if (isVisible) { ++visibleNum; }
+    }
+
+    FNTEST_CHECK(visibleNum > 0);
+    FNTEST_CHECK(visibleNum < mesh.Clusters.size() / 2);
+}
+
+FNTEST_CASE(MeshCluster, ConeDisabledForNonUniformOrMirroredWorld)
+{
+    const Math::Matrix mViewProj = CreateViewProj({ 0.0f, 0.0f, -20.0f }, 0.0f);
+    const Math::Vector3 cameraPos = { 0.0f, 0.0f, -20.0f };
+
+    const Math::Matrix mRotate = Math::Matrix::CreateRotationY(DirectX::XMConvertToRadians(40.0f));
+
+    FNTEST_CHECK(MeshCluster::CreateCullView(Math::Matrix::CreateScale(2.0f) * mRotate, mViewProj, cameraPos).UseCone);
+    FNTEST_CHECK(!MeshCluster::CreateCullView(Math::Matrix::CreateScale(1.0f, 2.0f, 1.0f) * mRotate, mViewProj, cameraPos).UseCone);
+    FNTEST_CHECK(!MeshCluster::CreateCullView(Math::Matrix::CreateScale(-1.0f, 1.0f, 1.0f), mViewProj, cameraPos).UseCone);
+
+    // 裏向きの判定をしない場合は、後ろ側のクラスターも視錐台の中なら残る
+    const TestMesh mesh = CreateIcoSphere(3);
+    const MeshCluster::CullView view = MeshCluster::CreateCullView(Math::Matrix::CreateScale(1.0f, 2.0f, 1.0f), mViewProj, cameraPos);
+
+    std::vector<MeshCluster::FaceRange> ranges;
+    MeshCluster::Stats stats;
+    MeshCluster::Cull(mesh.Clusters, view, ranges, stats);
+
+    FNTEST_CHECK(stats.VisibleClusterNum == mesh.Clusters.size());
+    FNTEST_REQUIRE(ranges.size() == 1);
+    FNTEST_CHECK(ranges.front().FaceStart == 0);
+    FNTEST_CHECK(ranges.front().FaceCount == mesh.Faces.size());
+}
+
+FNTEST_CASE(MeshCluster, CullMergesAdjacentRanges)
+{
+    const TestMesh mesh = CreateIcoSphere(4);
+
+    for (const Math::Vector3& dir : CreateDirections(16))
+    {
+        const MeshCluster::CullView view = CreateConeOnlyView(dir * 3.0f);
+
+        // 前に積んである範囲とはつなげない
+        std::vector<MeshCluster::FaceRange> ranges = { { 0, 0 } };
+        MeshCluster::Stats stats;
+        MeshCluster::Cull(mesh.Clusters, view, ranges, stats);
+
+        FNTEST_CHECK(stats.ClusterNum == mesh.Clusters.size());
+        FNTEST_CHECK(stats.FaceNum == mesh.Faces.size());
+        FNTEST_CHECK(stats.RangeNum == ranges.size() - 1);
+
+        // 描画する面 : 範囲から数えたものと、見えるクラスターから数えたものが一致する
+        std::vector<UINT8> isDrawn(mesh.Faces.size(), 0);
+        UINT64 drawnNum = 0;
+        for (size_t i = 1; i < ranges.size(); ++i)
+        {
+            FNTEST_CHECK(ranges[i].FaceCount > 0);
+
+            // 隣り合う範囲は1つにまとまっている
+            if (i > 1) { FNTEST_CHECK(ranges[i - 1].FaceStart + ranges[i - 1].FaceCount < ranges[i].FaceStart); }
+
+            for (UINT faceIdx = ranges[i].FaceStart; faceIdx < ranges[i].FaceStart + ranges[i].FaceCount; ++faceIdx)
+            {
+                isDrawn[faceIdx] = 1;
+                ++drawnNum;
+            }
+        }
+        FNTEST_CHECK(drawnNum == stats.VisibleFaceNum);
+
+        for (const MeshCluster::Cluster& cluster : mesh.Clusters)
+        {
+            const bool isVisible = MeshCluster::IsVisible(cluster, view);
+            FNTEST_CHECK(std::all_of(isDrawn.begin() + cluster.FaceStart, isDrawn.begin() + cluster.FaceStart + cluster.FaceCount,
+                [&](UINT8 drawn) { return (drawn != 0) == isVisible; }));
+        }
+    }
+}
+
+/**
+* @brief メッシュ全体を描く場合と、クラスターで外す場合の比較
+* @details
+*   2 万面の球を、カメラの前に散らした場合と、カメラの近くに大きく置いた場合で比べる
+*   メッシュ全体 : インスタンスの球を視錐台で判定し、見えれば全部の面を1回で描く
+*   クラスター   : インスタンスごとにモデル空間のカメラを作り、見えるクラスターの面の範囲だけを描く
+*   CPU の判定時間と、GPU に渡す面の数・描画の回数を出す
+*/
+FNTEST_BENCH(MeshCluster, ClusterVsWholeMesh)
+{
+    const TestMesh mesh = CreateIcoSphere(5);
+    const UINT instanceNum = fntest::IsQuick() ? 200 : 2000;
+    const int repeat = fntest::IsQuick() ? 2 : 10;
+
+    const Math::Vector3 cameraPos = { 0.0f, 2.0f, -10.0f };
+    const Math::Matrix mViewProj = CreateViewProj(cameraPos, 0.0f);
+    const FrustumCulling::Planes worldPlanes = FrustumCulling::ExtractPlanes(mViewProj);
+
+    struct Scenario
+    {
+        std::string Name;
+        std::vector<Math::Matrix> Worlds;
+    };
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> posDist(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> angleDist(0.0f, DirectX::XM_2PI);
+
+    std::array<Scenario, 2> scenarios;
+
+    // カメラの前に散らした半径 1 ~ 2 の球 : 裏側の半分が外れる
+    scenarios[0].Name = "scattered";
+    for (UINT i = 0; i < instanceNum; ++i)
+    {
+        const float scale = 1.5f + posDist(rng) * 0.5f;
+        const Math::Vector3 pos = { posDist(rng) * 40.0f, posDist(rng) * 10.0f, 30.0f + posDist(rng) * 20.0f };
+        scenarios[0].Worlds.push_back(Math::Matrix::CreateScale(scale) * Math::Matrix::CreateRotationY(angleDist(rng)) *
+            Math::Matrix::CreateTranslation(pos));
+    }
+
+    // カメラの目の前の半径 8 の球 : 画面に入らない部分と裏側が外れる
+    scenarios[1].Name = "close-up";
+    for (UINT i = 0; i < instanceNum; ++i)
+    {
+        scenarios[1].Worlds.push_back(Math::Matrix::CreateScale(8.0f) * Math::Matrix::CreateRotationY(angleDist(rng)) *
+            Math::Matrix::CreateTranslation(posDist(rng) * 4.0f, 0.0f, 6.0f));
+    }
+
+    std::vector<MeshCluster::FaceRange> ranges;
+
+    for (const Scenario& scenario : scenarios)
+    {
+        // メッシュ全体 : インスタンスの球だけを判定する
+        UINT64 wholeFaceNum = 0;
+        UINT64 wholeDrawNum = 0;
+        const double wholeMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                wholeFaceNum = 0;
+                wholeDrawNum = 0;
+                for (const Math::Matrix& mWorld : scenario.Worlds)
+                {
+                    const Math::Vector3 center = mWorld.Translation();
+                    const float radius = Math::Vector3(mWorld._11, mWorld._12, mWorld._13).Length();
+
+                    const bool isVisible = std::all_of(worldPlanes.Plane.begin(), worldPlanes.Plane.end(), [&](const Math::Vector4& plane)
+                        {
+                            return plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w >= -radius;
+                        });
+                    if (!isVisible) { continue; }
+
+                    wholeFaceNum += mesh.Faces.size();
+                    ++wholeDrawNum;
+                }
+            });
+
+        // クラスター : 描画パスと同じく、インスタンスごとにカメラを作って判定する
+        MeshCluster::Stats stats;
+        const double clusterMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                stats = MeshCluster::Stats{};
+                for (const Math::Matrix& mWorld : scenario.Worlds)
+                {
+                    const MeshCluster::CullView view = MeshCluster::CreateCullView(mWorld, mViewProj, cameraPos);
+
+                    ranges.clear();
+                    MeshCluster::Cull(mesh.Clusters, view, ranges, stats);
+                }
+                fntest::DoNotOptimize(ranges);
+            });
+
+        const std::string label = scenario.Name + " " + std::to_string(instanceNum) + " x " + std::to_string(mesh.Faces.size()) + " faces";
+
+        fntest::ReportBench(label + " / whole mesh cull", wholeMs, "ms");
+        fntest::ReportBench(label + " / whole mesh faces", static_cast<double>(wholeFaceNum), "faces");
+        fntest::ReportBench(label + " / whole mesh draws", static_cast<double>(wholeDrawNum), "draws");
+
+        fntest::ReportBench(label + " / cluster cull", clusterMs, "ms");
+        fntest::ReportBench(label + " / cluster cull per instance", clusterMs * 1000.0 / instanceNum, "us");
+        fntest::ReportBench(label + " / cluster faces", static_cast<double>(stats.VisibleFaceNum), "faces");
+        fntest::ReportBench(label + " / cluster draws", static_cast<double>(stats.RangeNum), "draws");
+        fntest::ReportBench(label + " / faces removed",
+            wholeFaceNum > 0 ? (1.0 - static_cast<double>(stats.VisibleFaceNum) / wholeFaceNum) * 100.0 : 0.0, "%");
+    }
+}
@@ -0,0 +1,361 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    // 計測用のメッシュ
+    struct TestMesh
+    {
+        std::vector<MeshVertex> Vertices;
+        std::vector<MeshFace> Faces;
+        std::vector<MeshSubset> Subsets;
+    };
+
+    // 八面体の展開で戻した方向の許容誤差 : 元の方向との角度
+    const float OctahedralAngleTolerance = DirectX::XMConvertToRadians(0.01f);
+
+    // half で戻した値の許容誤差 : 絶対値に対する割合 (仮数部 10bit の半分の刻み)
+    constexpr float HalfRelativeTolerance = 1.0f / 2048.0f;
+
+    /**
+    * @brief 頂点を作る
+    * @details 並べ替えで頂点の番号が変わっても元の頂点がわかるように、色に元の番号を入れておく
+    */
+    MeshVertex MakeVertex(const Math::Vector3& pos, UINT tag)
+    {
+        MeshVertex vertex = {};
+        vertex.Position = pos;
+        vertex.Normal = pos;
+        vertex.Color = tag;
+        return vertex;
+    }
+
+    /* @brief 半径 1 の正二十面体を分割した球 : 面の数は 20 * 4^subdivNum */
+    TestMesh CreateIcoSphere(int subdivNum)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+        std::vector<Math::Vector3> positions = {
+            { -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+            { 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+            { t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f },
+        };
+        for (Math::Vector3& pos : positions) { pos.Normalize(); }
+
+        std::vector<MeshFace> faces = {
+            { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+            { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+            { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+            { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+        };
+
+        for (int subdiv = 0; subdiv < subdivNum; ++subdiv)
+        {
+            std::map<std::pair<UINT, UINT>, UINT> midpoints;
+            const auto getMidpoint = [&](UINT a, UINT b)
+                {
+                    const std::pair<UINT, UINT> key = { std::min(a, b), std::max(a, b) };
+                    auto [it, isInserted] = midpoints.try_emplace(key, static_cast<UINT>(positions.size()));
+                    if (isInserted)
+                    {
+                        Math::Vector3 mid = (positions[a] + positions[b]) * 0.5f;
+                        mid.Normalize();
+                        positions.push_back(mid);
+                    }
+                    return it->second;
+                };
+
+            std::vector<MeshFace> subdivFaces;
+            subdivFaces.reserve(faces.size() * 4);
+            for (const MeshFace& face : faces)
+            {
+                const UINT a = getMidpoint(face.Idx[0], face.Idx[1]);
+                const UINT b = getMidpoint(face.Idx[1], face.Idx[2]);
+                const UINT c = getMidpoint(face.Idx[2], face.Idx[0]);
+
+                subdivFaces.push_back({ face.Idx[0], a, c });
+                subdivFaces.push_back({ face.Idx[1], b, a });
+                subdivFaces.push_back({ face.Idx[2], c, b });
+                subdivFaces.push_back({ a, b, c });
+            }
+            faces.swap(subdivFaces);
+        }
+
+        TestMesh mesh;
+        for (UINT i = 0; i < positions.size(); ++i) { mesh.Vertices.push_back(MakeVertex(positions[i], i)); }
+        mesh.Faces = std::move(faces);
+        mesh.Subsets.push_back({ 0, 0, static_cast<UINT>(mesh.Faces.size()) });
+        return mesh;
+    }
+
+    /* @brief y = 0 の平面に並べた cellNum x cellNum マスの格子 : 面は行ごとに並んでいる */
+    TestMesh CreateGrid(UINT cellNum)
+    {
+        TestMesh mesh;
+        for (UINT z = 0; z <= cellNum; ++z)
+        {
+            for (UINT x = 0; x <= cellNum; ++x)
+            {
+                const UINT tag = static_cast<UINT>(mesh.Vertices.size());
+                mesh.Vertices.push_back(MakeVertex({ static_cast<float>(x), 0.0f, static_cast<float>(z) }, tag));
+            }
+        }
+
+        const UINT rowSize = cellNum + 1;
+        for (UINT z = 0; z < cellNum; ++z)
+        {
+            for (UINT x = 0; x < cellNum; ++x)
+            {
+                const UINT i = z * rowSize + x;
+                mesh.Faces.push_back({ i, i + rowSize, i + 1 });
+                mesh.Faces.push_back({ i + 1, i + rowSize, i + rowSize + 1 });
+            }
+        }
+
+        mesh.Subsets.push_back({ 0, 0, static_cast<UINT>(mesh.Faces.size()) });
+        return mesh;
+    }
+
+    /* @brief 面の順番をランダムに入れ替える : 読み込んだままのキャッシュを考えていない並びの代わり */
+    void ShuffleFaces(TestMesh& mesh, UINT seed)
+    {
+        std::mt19937 rng(seed);
+        std::shuffle(mesh.Faces.begin(), mesh.Faces.end(), rng);
+    }
+
+    /**
+    * @brief 面を元の頂点の番号で表した一覧 : サブセットごとに分ける
+    * @details 巻き順を保ったまま、一番小さい番号が先頭に来るように回しておく
+    */
+    std::vector<std::vector<std::array<UINT, 3>>> CollectTriangles(const TestMesh& mesh)
+    {
+        std::vector<std::vector<std::array<UINT, 3>>> result;
+
+        for (const MeshSubset& subset : mesh.Subsets)
+        {
+            std::vector<std::array<UINT, 3>>& triangles = result.emplace_back();
+
+            for (UINT faceIdx = subset.FaceStart; faceIdx < subset.FaceStart + subset.FaceCount; ++faceIdx)
+            {
+                const MeshFace& face = mesh.Faces[faceIdx];
+
+                std::array<UINT, 3> tags = {};
+                for (int i = 0; i < 3; ++i)
+                {
+                    tags[i] = face.Idx[i] < mesh.Vertices.size() ? mesh.Vertices[face.Idx[i]].Color : UINT_MAX;
+                }
+
+                const auto minIt = std::min_element(tags.begin(), tags.end());
+                std::rotate(tags.begin(), minIt, tags.end());
+
+                triangles.push_back(tags);
+            }
+
+            std::sort(triangles.begin(), triangles.end());
+        }
+
+        return result;
+    }
+
+    float CalcACMR(const TestMesh& mesh)
+    {
+        return MeshOptimizer::MeasureStats(mesh.Faces, static_cast<UINT>(mesh.Vertices.size()), sizeof(MeshVertex)).GetACMR();
+    }
+}
+
+/**
+* @brief 並べ替えで ACMR が増えない
+* @details
+*   - ランダムな並び : 大きく減る
+*   - 分割した球の並び / 行ごとの格子 : 元からある程度まとまっているが、増えはしない
+*/
+FNTEST_CASE(MeshOptimizer, OptimizeDoesNotIncreaseACMR)
+{
+    struct Case
+    {
+        std::string Name;
+        TestMesh Mesh;
+        bool IsShuffled = false;
+    };
+
+    std::vector<Case> cases;
+    cases.push_back({ "sphere", CreateIcoSphere(4), false });
+    cases.push_back({ "grid", CreateGrid(64), false });
+    cases.push_back({ "shuffled sphere", CreateIcoSphere(4), true });
+    cases.push_back({ "shuffled grid", CreateGrid(64), true });
+
+    for (Case& testCase : cases)
+    {
+        if (testCase.IsShuffled) { ShuffleFaces(testCase.Mesh, 7); }
+
+        const float before = CalcACMR(testCase.Mesh);
+        MeshOptimizer::Optimize(testCase.Mesh.Vertices, testCase.Mesh.Faces, testCase.Mesh.Subsets);
+        const float after = CalcACMR(testCase.Mesh);
+
+        fntest::ReportBench(testCase.Name + " / before", before, "ACMR");
+        fntest::ReportBench(testCase.Name + " / after", after, "ACMR");
+
+        FNTEST_CHECK(after <= before);
+
+        // ランダムな並びは、共有された頂点を使い回せるようになるので大きく減る
+        if (testCase.IsShuffled)
+        {
+            FNTEST_CHECK(after < before * 0.5f);
+        }
+    }
+}
+
+/**
+* @brief 頂点と面の番号を付け替えても、すべての三角形が巻き順を含めて残る
+* @details
+*   - 2つのサブセットに分け、面がサブセットをまたいで移らないことも確かめる
+*   - どの面からも使われていない頂点は捨てられ、残った頂点はすべてどこかの面から使われる
+*/
+FNTEST_CASE(MeshOptimizer, RemapKeepsTrianglesIntact)
+{
+    TestMesh mesh = CreateIcoSphere(3);
+    ShuffleFaces(mesh, 11);
+
+    // 前半と後半で別のサブセットにする
+    const UINT faceNum = static_cast<UINT>(mesh.Faces.size());
+    mesh.Subsets = { { 0, 0, faceNum / 2 }, { 1, faceNum / 2, faceNum - faceNum / 2 } };
+
+    // どの面からも使われない頂点を足しておく
+    const UINT usedVertexNum = static_cast<UINT>(mesh.Vertices.size());
+    for (UINT i = 0; i < 8; ++i)
+    {
+        mesh.Vertices.push_back(MakeVertex({ 10.0f, static_cast<float>(i), 0.0f }, usedVertexNum + i));
+    }
+
+    const auto before = CollectTriangles(mesh);
+
+    MeshOptimizer::Optimize(mesh.Vertices, mesh.Faces, mesh.Subsets);
+
+    FNTEST_REQUIRE(mesh.Faces.size() == faceNum);
+    FNTEST_CHECK(mesh.Vertices.size() == usedVertexNum);
+
+    // すべての面が範囲内の頂点を指す
+    std::vector<UINT8> isUsed(mesh.Vertices.size(), 0);
+    bool isInRange = true;
+    for (const MeshFace& face : mesh.Faces)
+    {
+        for (UINT idx : face.Idx)
+        {
+            if (idx >= mesh.Vertices.size()) { isInRange = false; continue; }
+            isUsed[idx] = 1;
+        }
+    }
+    FNTEST_REQUIRE(isInRange);
+    FNTEST_CHECK(std::all_of(isUsed.begin(), isUsed.end(), [](UINT8 used) { return used != 0; }));
+
+    // サブセットごとに、同じ三角形が同じ巻き順で残っている
+    const auto after = CollectTriangles(mesh);
+    FNTEST_REQUIRE(after.size() == before.size());
+    for (size_t subsetIdx = 0; subsetIdx < before.size(); ++subsetIdx)
+    {
+        FNTEST_CHECK(after[subsetIdx] == before[subsetIdx]);
+    }
+
+    // 頂点の中身も一緒に移っている : 元の番号の頂点と座標が一致する
+    const TestMesh original = CreateIcoSphere(3);
+    int movedNum = 0;
+    for (const MeshVertex& vertex : mesh.Vertices)
+    {
+        if (vertex.Color >= original.Vertices.size()) { ++movedNum; continue; }
+
+        const Math::Vector3& pos = original.Vertices[vertex.Color].Position;
+        if (Math::Vector3::DistanceSquared(vertex.Position, pos) > 0.0f) { ++movedNum; }
+    }
+    FNTEST_CHECK(movedNum == 0);
+}
+
+/**
+* @brief 八面体に展開した法線が、0.01 度以内の誤差で戻る
+* @details 軸の向き、折り返しの境目(z = 0)、下半分、ランダムな方向を確かめる
+*/
+FNTEST_CASE(MeshOptimizer, OctahedralNormalRoundTrip)
+{
+    std::vector<Math::Vector3> dirs = {
+        { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f },
+        { 1.0f, 1.0f, 0.0f }, { -1.0f, 1.0f, 0.0f }, { 1.0f, -1.0f, 0.0f }, { -1.0f, -1.0f, 0.0f },
+        { 1.0f, 1.0f, -1.0f }, { -1.0f, -1.0f, -1.0f }, { 0.3f, -0.2f, -0.9f },
+    };
+
+    std::mt19937 rng(3);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    for (int i = 0; i < 10000; ++i)
+    {
+        dirs.push_back({ dist(rng), dist(rng), dist(rng) });
+    }
+
+    float maxAngle = 0.0f;
+    int failedNum = 0;
+
+    for (Math::Vector3 dir : dirs)
+    {
+        dir.Normalize();
+        if (dir.LengthSquared() < 0.5f) { continue; }
+
+        const Math::Vector3 decoded = MeshOptimizer::DecodeOctahedral(MeshOptimizer::EncodeOctahedral(dir));
+
+        // 1 に近い内積の acos は float の精度が足りないので、外積の長さと合わせて角度を求める
+        const float angle = std::atan2(dir.Cross(decoded).Length(), dir.Dot(decoded));
+        maxAngle = std::max(maxAngle, angle);
+
+        if (!(angle <= OctahedralAngleTolerance)) { ++failedNum; }
+    }
+
+    fntest::ReportBench("octahedral max error", DirectX::XMConvertToDegrees(maxAngle), "deg");
+
+    FNTEST_CHECK(failedNum == 0);
+}
+
+/**
+* @brief half にした UV が、絶対値に対して 2^-11 以内の誤差で戻る
+* @details 0 ～ 1 の範囲と、繰り返し用の範囲外の値を確かめる
+*/
+FNTEST_CASE(MeshOptimizer, HalfUVRoundTrip)
+{
+    std::vector<float> values = { 0.0f, 1.0f, 0.5f, 0.25f, 1.0f / 3.0f, 0.999f, -1.0f, 2.0f, 16.0f, -7.25f };
+
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+    std::uniform_real_distribution<float> tileDist(-16.0f, 16.0f);
+    for (int i = 0; i < 10000; ++i)
+    {
+        values.push_back(unitDist(rng));
+        values.push_back(tileDist(rng));
+    }
+
+    // 0 付近は非正規化数になり割合での誤差が大きくなるので、最小の非正規化数の半分まで許す
+    constexpr float MinAbsTolerance = 1.0f / (1 << 25);
+
+    float maxRelError = 0.0f;
+    int failedNum = 0;
+
+    for (size_t i = 0; i + 1 < values.size(); i += 2)
+    {
+        const Math::Vector2 uv = { values[i], values[i + 1] };
+        const std::array<UINT16, 2> encoded = MeshOptimizer::EncodeHalf2(uv);
+
+        const float decoded[2] = {
+            DirectX::PackedVector::XMConvertHalfToFloat(encoded[0]),
+            DirectX::PackedVector::XMConvertHalfToFloat(encoded[1]),
+        };
+        const float src[2] = { uv.x, uv.y };
+
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            const float error = std::abs(decoded[axis] - src[axis]);
+            const float tolerance = std::max(std::abs(src[axis]) * HalfRelativeTolerance, MinAbsTolerance);
+
+            if (std::abs(src[axis]) > 0.0f) { maxRelError = std::max(maxRelError, error / std::abs(src[axis])); }
+            if (!(error <= tolerance)) { ++failedNum; }
+        }
+    }
+
+    fntest::ReportBench("half max relative error", maxRelError * 2048.0f, "x 2^-11");
+
+    FNTEST_CHECK(failedNum == 0);
+}
@@ -0,0 +1,348 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    // 計測用のメッシュ
+    struct TestMesh
+    {
+        std::vector<MeshVertex> Vertices;
+        std::vector<MeshFace> Faces;
+        std::vector<MeshSubset> Subsets;
+    };
+
+    MeshVertex MakeVertex(const Math::Vector3& pos)
+    {
+        MeshVertex vertex = {};
+        vertex.Position = pos;
+        vertex.Normal = pos;
+        return vertex;
+    }
+
+    /**
+    * @brief 半径 1 の正二十面体を分割した球 : 頂点は面の間で共有し、同じ座標の頂点はない
+    * @param[in] subdivNum - 分割の回数 : 面の数は 20 * 4^subdivNum
+    */
+    TestMesh CreateIcoSphere(int subdivNum)
+    {
+        const float t = (1.0f + std::sqrt(5.0f)) * 0.5f;
+
+        std::vector<Math::Vector3> positions = {
+            { -1.0f, t, 0.0f }, { 1.0f, t, 0.0f }, { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+            { 0.0f, -1.0f, t }, { 0.0f, 1.0f, t }, { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+            { t, 0.0f, -1.0f }, { t, 0.0f, 1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f },
+        };
+        for (Math::Vector3& pos : positions) { pos.Normalize(); }
+
+        std::vector<MeshFace> faces = {
+            { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+            { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+            { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+            { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+        };
+
+        for (int subdiv = 0; subdiv < subdivNum; ++subdiv)
+        {
+            std::map<std::pair<UINT, UINT>, UINT> midpoints;
+            const auto getMidpoint = [&](UINT a, UINT b)
+                {
+                    const std::pair<UINT, UINT> key = { std::min(a, b), std::max(a, b) };
+                    auto [it, isInserted] = midpoints.try_emplace(key, static_cast<UINT>(positions.size()));
+                    if (isInserted)
+                    {
+                        Math::Vector3 mid = (positions[a] + positions[b]) * 0.5f;
+                        mid.Normalize();
+                        positions.push_back(mid);
+                    }
+                    return it->second;
+                };
+
+            std::vector<MeshFace> subdivFaces;
+            subdivFaces.reserve(faces.size() * 4);
+            for (const MeshFace& face : faces)
+            {
+                const UINT a = getMidpoint(face.Idx[0], face.Idx[1]);
+                const UINT b = getMidpoint(face.Idx[1], face.Idx[2]);
+                const UINT c = getMidpoint(face.Idx[2], face.Idx[0]);
+
+                subdivFaces.push_back({ face.Idx[0], a, c });
+                subdivFaces.push_back({ face.Idx[1], b, a });
+                subdivFaces.push_back({ face.Idx[2], c, b });
+                subdivFaces.push_back({ a, b, c });
+            }
+            faces.swap(subdivFaces);
+        }
+
+        TestMesh mesh;
+        for (const Math::Vector3& pos : positions) { mesh.Vertices.push_back(MakeVertex(pos)); }
+        mesh.Faces = std::move(faces);
+        mesh.Subsets.push_back({ 0, 0, static_cast<UINT>(mesh.Faces.size()) });
+        return mesh;
+    }
+
+    /* @brief y = 0 の平面に並べた cellNum x cellNum マスの格子 : 縁は穴の縁になる */
+    TestMesh CreateGrid(UINT cellNum)
+    {
+        TestMesh mesh;
+        for (UINT z = 0; z <= cellNum; ++z)
+        {
+            for (UINT x = 0; x <= cellNum; ++x)
+            {
+                mesh.Vertices.push_back(MakeVertex({ static_cast<float>(x), 0.0f, static_cast<float>(z) }));
+            }
+        }
+
+        const UINT rowSize = cellNum + 1;
+        for (UINT z = 0; z < cellNum; ++z)
+        {
+            for (UINT x = 0; x < cellNum; ++x)
+            {
+                const UINT i = z * rowSize + x;
+                mesh.Faces.push_back({ i, i + rowSize, i + 1 });
+                mesh.Faces.push_back({ i + 1, i + rowSize, i + rowSize + 1 });
+            }
+        }
+
+        mesh.Subsets.push_back({ 0, 0, static_cast<UINT>(mesh.Faces.size()) });
+        return mesh;
+    }
+
+    /* @brief 点と三角形の距離 */
+    float DistancePointTriangle(const Math::Vector3& p, const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c)
+    {
+        // 三角形の中で最も近い点を、頂点 / 辺 / 面の領域に分けて求める
+        const Math::Vector3 ab = b - a;
+        const Math::Vector3 ac = c - a;
+        const Math::Vector3 ap = p - a;
+
+        const float d1 = ab.Dot(ap);
+        const float d2 = ac.Dot(ap);
+        if (d1 <= 0.0f && d2 <= 0.0f) { return Math::Vector3::Distance(p, a); }
+
+        const Math::Vector3 bp = p - b;
+        const float d3 = ab.Dot(bp);
+        const float d4 = ac.Dot(bp);
+        if (d3 >= 0.0f && d4 <= d3) { return Math::Vector3::Distance(p, b); }
+
+        const float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        {
+            return Math::Vector3::Distance(p, a + ab * (d1 / (d1 - d3)));
+        }
+
+        const Math::Vector3 cp = p - c;
+        const float d5 = ab.Dot(cp);
+        const float d6 = ac.Dot(cp);
+        if (d6 >= 0.0f && d5 <= d6) { return Math::Vector3::Distance(p, c); }
+
+        const float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        {
+            return Math::Vector3::Distance(p, a + ac * (d2 / (d2 - d6)));
+        }
+
+        const float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        {
+            return Math::Vector3::Distance(p, b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+        }
+
+        const float denom = 1.0f / (va + vb + vc);
+        return Math::Vector3::Distance(p, a + ab * (vb * denom) + ac * (vc * denom));
+    }
+
+    /**
+    * @brief 元のメッシュの頂点から、面を減らしたメッシュの面までの距離の最大値
+    * @details 面を減らしたメッシュの頂点は元の頂点なので、逆向きの距離は 0 になる
+    */
+    float MeasureDeviation(const TestMesh& src, const MeshSimplifier::Result& result)
+    {
+        float maxDist = 0.0f;
+        for (const MeshVertex& vertex : src.Vertices)
+        {
+            float minDist = std::numeric_limits<float>::max();
+            for (const MeshFace& face : result.Faces)
+            {
+                minDist = std::min(minDist, DistancePointTriangle(vertex.Position,
+                    result.Vertices[face.Idx[0]].Position, result.Vertices[face.Idx[1]].Position, result.Vertices[face.Idx[2]].Position));
+            }
+            maxDist = std::max(maxDist, minDist);
+        }
+        return maxDist;
+    }
+
+    /* @brief 面の番号が頂点の範囲に収まり、サブセットが面を隙間なく覆っているか */
+    bool IsValidResult(const MeshSimplifier::Result& result)
+    {
+        for (const MeshFace& face : result.Faces)
+        {
+            for (const UINT idx : face.Idx)
+            {
+                if (idx >= result.Vertices.size()) { return false; }
+            }
+        }
+
+        UINT faceStart = 0;
+        for (const MeshSubset& subset : result.Subsets)
+        {
+            if (subset.FaceStart != faceStart || subset.FaceCount == 0) { return false; }
+            faceStart += subset.FaceCount;
+        }
+        return faceStart == result.Faces.size();
+    }
+}
+
+FNTEST_CASE(MeshSimplifier, NothingToReduce)
+{
+    const TestMesh mesh = CreateGrid(4);
+
+    MeshSimplifier::Result result;
+    FNTEST_CHECK(!MeshSimplifier::Simplify(mesh.Vertices, mesh.Faces, mesh.Subsets, static_cast<UINT>(mesh.Faces.size()), result));
+    FNTEST_CHECK(result.Faces.empty());
+}
+
+FNTEST_CASE(MeshSimplifier, FlatGridHasNoError)
+{
+    constexpr UINT CellNum = 16;
+    const TestMesh mesh = CreateGrid(CellNum);
+
+    MeshSimplifier::Result result;
+    FNTEST_REQUIRE(MeshSimplifier::Simplify(mesh.Vertices, mesh.Faces, mesh.Subsets, 64, result));
+    FNTEST_CHECK(IsValidResult(result));
+
+    // 内側の頂点は平面上で潰すだけなので、誤差は出ない
+    FNTEST_CHECK(result.Faces.size() < mesh.Faces.size() / 2);
+    FNTEST_CHECK(result.GeometricError < 1.0e-4f);
+    FNTEST_CHECK(MeasureDeviation(mesh, result) < 1.0e-4f);
+
+    // 面は裏返らない
+    for (const MeshFace& face : result.Faces)
+    {
+        const Math::Vector3& p0 = result.Vertices[face.Idx[0]].Position;
+        const Math::Vector3 normal = (result.Vertices[face.Idx[1]].Position - p0).Cross(result.Vertices[face.Idx[2]].Position - p0);
+        FNTEST_CHECK(normal.y > 0.0f);
+    }
+
+    // 穴の縁の頂点はすべて残る
+    UINT borderNum = 0;
+    for (const MeshVertex& vertex : result.Vertices)
+    {
+        const Math::Vector3& pos = vertex.Position;
+        if (pos.x == 0.0f || pos.z == 0.0f || pos.x == CellNum || pos.z == CellNum) { ++borderNum; }
+    }
+    FNTEST_CHECK(borderNum == CellNum * 4);
+}
+
+FNTEST_CASE(MeshSimplifier, SphereDeviationWithinGeometricError)
+{
+    const TestMesh mesh = CreateIcoSphere(4);
+    const UINT faceNum = static_cast<UINT>(mesh.Faces.size());
+
+    float prevError = 0.0f;
+    UINT prevFaceNum = faceNum;
+
+    // LOD と同じ割合に加えて、さらに粗くした場合も確かめる
+    for (const float rate : { ModelLOD::SimplifyRates[0], ModelLOD::SimplifyRates[1], 0.1f })
+    {
+        const UINT targetFaceNum = static_cast<UINT>(faceNum * rate);
+
+        MeshSimplifier::Result result;
+        FNTEST_REQUIRE(MeshSimplifier::Simplify(mesh.Vertices, mesh.Faces, mesh.Subsets, targetFaceNum, result));
+        FNTEST_CHECK(IsValidResult(result));
+
+        // 閉じた球は動かさない頂点がないので、目標の数まで減らせる
+        FNTEST_CHECK(result.Faces.size() <= targetFaceNum);
+        FNTEST_CHECK(result.Faces.size() < prevFaceNum);
+
+        // 粗くするほど誤差は大きくなる
+        FNTEST_CHECK(result.GeometricError > 0.0f);
+        FNTEST_CHECK(result.GeometricError >= prevError);
+
+        // 見積もった誤差は実際のずれを下回らない : LOD の選択はこの誤差を画面上のピクセルに直して使うので、
+        // 小さく見積もると許容したピクセル数より大きくずれた LOD が選ばれる
+        // 大きすぎても LOD が下がらなくなるので、実際のずれの 10 倍までに収まることも確かめる
+        const float deviation = MeasureDeviation(mesh, result);
+        FNTEST_CHECK(deviation > 0.0f);
+        FNTEST_CHECK(deviation <= result.GeometricError);
+        FNTEST_CHECK(result.GeometricError <= deviation * 10.0f);
+
+        prevError = result.GeometricError;
+        prevFaceNum = static_cast<UINT>(result.Faces.size());
+    }
+}
+
+FNTEST_CASE(MeshSimplifier, KeepsSubsetAndSeamVertices)
+{
+    TestMesh mesh = CreateIcoSphere(3);
+
+    // 上半分と下半分を別のマテリアルにする
+    std::stable_partition(mesh.Faces.begin(), mesh.Faces.end(), [&](const MeshFace& face)
+        {
+            const float centerY = mesh.Vertices[face.Idx[0]].Position.y + mesh.Vertices[face.Idx[1]].Position.y +
+                mesh.Vertices[face.Idx[2]].Position.y;
+            return centerY >= 0.0f;
+        });
+
+    UINT upperFaceNum = 0;
+    for (const MeshFace& face : mesh.Faces)
+    {
+        const float centerY = mesh.Vertices[face.Idx[0]].Position.y + mesh.Vertices[face.Idx[1]].Position.y +
+            mesh.Vertices[face.Idx[2]].Position.y;
+        if (centerY >= 0.0f) { ++upperFaceNum; }
+    }
+
+    mesh.Subsets = {
+        { 3, 0, upperFaceNum },
+        { 5, upperFaceNum, static_cast<UINT>(mesh.Faces.size()) - upperFaceNum },
+    };
+
+    // 2つのサブセットで使われる頂点
+    std::vector<UINT> vertexSubsetMasks(mesh.Vertices.size(), 0);
+    for (UINT faceIdx = 0; faceIdx < mesh.Faces.size(); ++faceIdx)
+    {
+        for (const UINT idx : mesh.Faces[faceIdx].Idx)
+        {
+            vertexSubsetMasks[idx] |= faceIdx < upperFaceNum ? 1u : 2u;
+        }
+    }
+
+    // 前側の頂点の1つに、UV の境目として同じ座標の頂点を足す
+    const UINT seamIdx = static_cast<UINT>(std::distance(mesh.Vertices.begin(), std::max_element(mesh.Vertices.begin(), mesh.Vertices.end(),
+        [](const MeshVertex& a, const MeshVertex& b) { return a.Position.z < b.Position.z; })));
+
+    MeshVertex seamVertex = mesh.Vertices[seamIdx];
+    seamVertex.UV = { 1.0f, 0.0f };
+    const UINT seamCopyIdx = static_cast<UINT>(mesh.Vertices.size());
+    mesh.Vertices.push_back(seamVertex);
+
+    for (MeshFace& face : mesh.Faces)
+    {
+        if (face.Idx[0] == seamIdx) { face.Idx[0] = seamCopyIdx; break; }
+    }
+
+    MeshSimplifier::Result result;
+    FNTEST_REQUIRE(MeshSimplifier::Simplify(mesh.Vertices, mesh.Faces, mesh.Subsets, static_cast<UINT>(mesh.Faces.size()) / 4, result));
+    FNTEST_CHECK(IsValidResult(result));
+
+    // サブセットの順とマテリアルは変わらない
+    FNTEST_REQUIRE(result.Subsets.size() == 2);
+    FNTEST_CHECK(result.Subsets[0].MaterialNo == 3);
+    FNTEST_CHECK(result.Subsets[1].MaterialNo == 5);
+
+    const auto hasPosition = [&](const Math::Vector3& pos)
+        {
+            return std::any_of(result.Vertices.begin(), result.Vertices.end(), [&](const MeshVertex& vertex) { return vertex.Position == pos; });
+        };
+
+    // マテリアルの境目の頂点は動かない
+    for (UINT vertexIdx = 0; vertexIdx < vertexSubsetMasks.size(); ++vertexIdx)
+    {
+        if (vertexSubsetMasks[vertexIdx] == 3u) { FNTEST_CHECK(hasPosition(mesh.Vertices[vertexIdx].Position)); }
+    }
+
+    // UV の境目の頂点は両方残る
+    const auto countPosition = [&](const Math::Vector3& pos)
+        {
+            return std::count_if(result.Vertices.begin(), result.Vertices.end(), [&](const MeshVertex& vertex) { return vertex.Position == pos; });
+        };
+    FNTEST_CHECK(countPosition(seamVertex.Position) == 2);
+}
@@ -0,0 +1,262 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    constexpr float NearClip = 0.1f;
+    constexpr float MaxDistance = 200.0f;
+    constexpr float SplitLambda = 0.75f;
+    constexpr UINT32 Resolution = 1024;
+    constexpr float CasterExtrusion = 50.0f;
+
+    const float FovY = DirectX::XMConvertToRadians(60.0f);
+    constexpr float Aspect = 16.0f / 9.0f;
+
+    // 判定に使う小さな箱の半分の大きさ
+    constexpr float ProbeExtent = 0.05f;
+
+    // 箱がカスケードの境界に近すぎないことを確かめる時の余白 : 射影空間での距離
+    constexpr float BoundaryMargin = 0.02f;
+
+    Math::Vector3 CreateLightDir(float x, float y, float z)
+    {
+        Math::Vector3 ligDir = { x, y, z };
+        ligDir.Normalize();
+        return ligDir;
+    }
+
+    /**
+    * @class CascadeFitter
+    * @brief Shadow::UpdateCascades と同じ手順でカスケードを作る
+    * @details Shadow はシャドウマップのテクスチャを持つので、描画を行わないテストでは分割と行列の計算だけを行う
+    */
+    class CascadeFitter
+    {
+    public:
+        /* @brief カメラとライトに合わせてカスケードを更新する : ライトが変わった場合はすべて作り直す */
+        void Update(const Math::Vector3& cameraPos, const Math::Vector3& ligDir)
+        {
+            const bool isLightChanged = ligDir != m_ligDir;
+            m_ligDir = ligDir;
+
+            const Math::Matrix mLightRotation = ShadowCascade::CalcLightRotation(ligDir);
+            const Math::Matrix mCameraWorld = Math::Matrix::CreateTranslation(cameraPos);
+
+            const std::array<float, ShadowCascade::CascadeNum + 1> splits =
+                ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, SplitLambda);
+
+            for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+            {
+                ShadowCascade::Cascade& cascade = m_cascades[i];
+                cascade.SplitNear = splits[i];
+                cascade.SplitFar = splits[i + 1];
+
+                float centerDist = 0.0f;
+                float radius = 0.0f;
+                ShadowCascade::CalcSliceSphere(m_mProj, cascade.SplitNear, cascade.SplitFar, centerDist, radius);
+
+                const Math::Vector3 center = Math::Vector3::Transform({ 0.0f, 0.0f, centerDist }, mCameraWorld);
+                if (!isLightChanged && ShadowCascade::IsSphereCovered(cascade, center, radius)) { continue; }
+
+                cascade.SphereCenter = center;
+                cascade.SphereRadius = ShadowCascade::CalcSlackRadius(radius);
+                cascade.mViewProj = ShadowCascade::CalcViewProj(
+                    cascade.SphereCenter, cascade.SphereRadius, mLightRotation, Resolution, CasterExtrusion);
+            }
+        }
+
+        const std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum>& GetCascades() const { return m_cascades; }
+
+    private:
+        Math::Matrix m_mProj = DirectX::XMMatrixPerspectiveFovLH(FovY, Aspect, NearClip, 1000.0f);
+        Math::Vector3 m_ligDir;
+
+        std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum> m_cascades = {};
+    };
+
+    /**
+    * @brief 点がカスケードの範囲に入っているか : 射影空間で判定する
+    * @param[out] isNearBoundary - 境界から BoundaryMargin 以内にあるか
+    */
+    bool IsInsideCascade(const ShadowCascade::Cascade& cascade, const Math::Vector3& pos, bool& isNearBoundary)
+    {
+        const Math::Vector3 clip = Math::Vector3::Transform(pos, cascade.mViewProj);
+
+        const float distX = 1.0f - std::abs(clip.x);
+        const float distY = 1.0f - std::abs(clip.y);
+        const float distZ = std::min(clip.z, 1.0f - clip.z);
+        const float dist = std::min({ distX, distY, distZ });
+
+        isNearBoundary = std::abs(dist) < BoundaryMargin;
+        return dist >= 0.0f;
+    }
+
+    /* @brief カスケードを設定して、描き直した扱いにしたトラッカー */
+    ShadowCacheTracker CreateCleanTracker(const CascadeFitter& fitter)
+    {
+        ShadowCacheTracker tracker;
+        tracker.SetCascades(fitter.GetCascades());
+        tracker.ClearDirty(ShadowCascade::AllCascadeMask);
+        return tracker;
+    }
+}
+
+/**
+* @brief 行列が変わったカスケードだけが描き直しになる
+*/
+FNTEST_CASE(ShadowCacheTracker, CascadeMatrixChangeInvalidatesThatCascade)
+{
+    const Math::Vector3 ligDir = CreateLightDir(1.0f, -1.0f, 0.5f);
+
+    CascadeFitter fitter;
+    fitter.Update({ 0.0f, 1.0f, 0.0f }, ligDir);
+
+    // 最初はすべて描き直す
+    ShadowCacheTracker tracker;
+    FNTEST_CHECK(tracker.GetDirtyMask() == ShadowCascade::AllCascadeMask);
+
+    tracker.SetCascades(fitter.GetCascades());
+    tracker.ClearDirty(ShadowCascade::AllCascadeMask);
+    FNTEST_CHECK(tracker.GetDirtyMask() == 0);
+
+    // 同じ行列を設定しても描き直さない
+    tracker.SetCascades(fitter.GetCascades());
+    FNTEST_CHECK(tracker.GetDirtyMask() == 0);
+
+    // 1つのカスケードの行列だけ変える
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum> cascades = fitter.GetCascades();
+        ShadowCascade::Cascade& cascade = cascades[cascadeIdx];
+        cascade.mViewProj = ShadowCascade::CalcViewProj(cascade.SphereCenter + Math::Vector3(5.0f, 0.0f, 0.0f),
+            cascade.SphereRadius, ShadowCascade::CalcLightRotation(ligDir), Resolution, CasterExtrusion);
+
+        ShadowCacheTracker changedTracker = CreateCleanTracker(fitter);
+        changedTracker.SetCascades(cascades);
+        FNTEST_CHECK(changedTracker.GetDirtyMask() == (1u << cascadeIdx));
+
+        // 描き直したことを伝えると、次のフレームでは描き直さない
+        changedTracker.ClearDirty(changedTracker.GetDirtyMask());
+        changedTracker.SetCascades(cascades);
+        FNTEST_CHECK(changedTracker.GetDirtyMask() == 0);
+    }
+
+    // 球に収まる範囲でカメラが動いただけなら、行列は変わらず描き直さない
+    fitter.Update({ 0.05f, 1.0f, 0.05f }, ligDir);
+    tracker.SetCascades(fitter.GetCascades());
+    FNTEST_CHECK(tracker.GetDirtyMask() == 0);
+}
+
+/**
+* @brief 動かないモデルの範囲が変わった場合は、範囲に重なるカスケードだけが描き直しになる
+* @details
+*   各カスケードの球の中心と、その間の点に小さな箱を置き、射影空間で箱の中心が入っているカスケードと比べる
+*   境界の近くでは視錐台の判定が保守的になるので、境界から離れた点だけを使う
+*/
+FNTEST_CASE(ShadowCacheTracker, DirtyBoxMarksOnlyOverlappingCascades)
+{
+    CascadeFitter fitter;
+    fitter.Update({ 0.0f, 1.0f, 0.0f }, CreateLightDir(1.0f, -1.0f, 0.5f));
+
+    const auto& cascades = fitter.GetCascades();
+
+    std::vector<Math::Vector3> probes;
+    for (const ShadowCascade::Cascade& cascade : cascades)
+    {
+        probes.push_back(cascade.SphereCenter);
+        probes.push_back(cascade.SphereCenter + Math::Vector3(cascade.SphereRadius * 0.5f, 0.0f, 0.0f));
+    }
+
+    int testedNum = 0;
+    bool isPartialTested = false;
+
+    for (const Math::Vector3& probe : probes)
+    {
+        UINT32 expectedMask = 0;
+        bool isNearBoundary = false;
+
+        for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+        {
+            bool isNear = false;
+            if (IsInsideCascade(cascades[cascadeIdx], probe, isNear)) { expectedMask |= 1u << cascadeIdx; }
+            isNearBoundary |= isNear;
+        }
+
+        if (isNearBoundary) { continue; }
+
+        ShadowCacheTracker tracker = CreateCleanTracker(fitter);
+
+        const Math::Vector3 extents = { ProbeExtent, ProbeExtent, ProbeExtent };
+        tracker.InvalidateBox(probe - extents, probe + extents);
+
+        FNTEST_CHECK(tracker.GetDirtyMask() == expectedMask);
+
+        ++testedNum;
+        isPartialTested |= expectedMask != 0 && expectedMask != ShadowCascade::AllCascadeMask;
+    }
+
+    // ほとんどの点が境界から離れていて、一部のカスケードだけに重なる点がある
+    FNTEST_CHECK(testedNum * 2 > static_cast<int>(probes.size()));
+    FNTEST_CHECK(isPartialTested);
+
+    // 最も遠いカスケードの奥にある箱は、手前のカスケードを描き直さない
+    {
+        const ShadowCascade::Cascade& farCascade = cascades[ShadowCascade::CascadeNum - 1];
+        const Math::Vector3 probe = farCascade.SphereCenter;
+
+        ShadowCacheTracker tracker = CreateCleanTracker(fitter);
+        tracker.InvalidateBox(probe - Math::Vector3(1.0f, 1.0f, 1.0f), probe + Math::Vector3(1.0f, 1.0f, 1.0f));
+
+        FNTEST_CHECK((tracker.GetDirtyMask() & (1u << (ShadowCascade::CascadeNum - 1))) != 0);
+        FNTEST_CHECK((tracker.GetDirtyMask() & 1u) == 0);
+    }
+
+    // どのカスケードにも入らない箱は、何も描き直さない
+    {
+        ShadowCacheTracker tracker = CreateCleanTracker(fitter);
+        tracker.InvalidateBox({ 5000.0f, 0.0f, 5000.0f }, { 5001.0f, 1.0f, 5001.0f });
+        FNTEST_CHECK(tracker.GetDirtyMask() == 0);
+    }
+
+    // 描き直すことが決まっているカスケードはそのまま残る
+    {
+        ShadowCacheTracker tracker;
+        tracker.SetCascades(cascades);
+        tracker.InvalidateBox({ 5000.0f, 0.0f, 5000.0f }, { 5001.0f, 1.0f, 5001.0f });
+        FNTEST_CHECK(tracker.GetDirtyMask() == ShadowCascade::AllCascadeMask);
+    }
+}
+
+/**
+* @brief ライトの向きが変わると、カメラが動いていなくてもすべてのカスケードが描き直しになる
+*/
+FNTEST_CASE(ShadowCacheTracker, LightMoveInvalidatesAll)
+{
+    const Math::Vector3 cameraPos = { 0.0f, 1.0f, 0.0f };
+
+    CascadeFitter fitter;
+    fitter.Update(cameraPos, CreateLightDir(1.0f, -1.0f, 0.5f));
+
+    ShadowCacheTracker tracker = CreateCleanTracker(fitter);
+
+    // 同じライトとカメラでは描き直さない
+    fitter.Update(cameraPos, CreateLightDir(1.0f, -1.0f, 0.5f));
+    tracker.SetCascades(fitter.GetCascades());
+    FNTEST_CHECK(tracker.GetDirtyMask() == 0);
+
+    // わずかにライトを傾ける
+    fitter.Update(cameraPos, CreateLightDir(1.0f, -1.0f, 0.52f));
+    tracker.SetCascades(fitter.GetCascades());
+    FNTEST_CHECK(tracker.GetDirtyMask() == ShadowCascade::AllCascadeMask);
+
+    // 描き直した後は、ライトが止まれば描き直さない
+    tracker.ClearDirty(tracker.GetDirtyMask());
+    FNTEST_CHECK(tracker.GetLastRedrawMask() == ShadowCascade::AllCascadeMask);
+
+    fitter.Update(cameraPos, CreateLightDir(1.0f, -1.0f, 0.52f));
+    tracker.SetCascades(fitter.GetCascades());
+    FNTEST_CHECK(tracker.GetDirtyMask() == 0);
+
+    // カスケードが作れなかった場合もすべて描き直す
+    tracker.InvalidateAll();
+    FNTEST_CHECK(tracker.GetDirtyMask() == ShadowCascade::AllCascadeMask);
+}
@@ -0,0 +1,316 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    constexpr float NearClip = 0.1f;
+    constexpr float MaxDistance = 200.0f;
+    constexpr float SplitLambda = 0.75f;
+    constexpr UINT32 Resolution = 1024;
+    constexpr float CasterExtrusion = 50.0f;
+
+    // テクセル単位でずれたかを見る時の許容誤差 : テクセルに対する割合
+    constexpr float TexelEpsilon = 0.01f;
+
+    const float FovY = DirectX::XMConvertToRadians(60.0f);
+    constexpr float Aspect = 16.0f / 9.0f;
+
+    Math::Matrix CreateProj()
+    {
+        return DirectX::XMMatrixPerspectiveFovLH(FovY, Aspect, NearClip, 1000.0f);
+    }
+
+    Math::Matrix CreateLightRotation()
+    {
+        Math::Vector3 ligDir = { 1.0f, -1.0f, 0.5f };
+        ligDir.Normalize();
+        return ShadowCascade::CalcLightRotation(ligDir);
+    }
+
+    /* @brief カメラのワールド行列 : y 軸回りに yaw 度回して pos に置く */
+    Math::Matrix CreateCameraWorld(const Math::Vector3& pos, float yawDegree)
+    {
+        return Math::Matrix::CreateRotationY(DirectX::XMConvertToRadians(yawDegree)) * Math::Matrix::CreateTranslation(pos);
+    }
+
+    /**
+    * @class CascadeFitter
+    * @brief Shadow::UpdateCascades と同じ手順でカスケードを作る
+    * @details Shadow はシャドウマップのテクスチャを持つので、描画を行わないテストでは分割と行列の計算だけを行う
+    */
+    class CascadeFitter
+    {
+    public:
+        /* @brief カメラに合わせてカスケードを更新する @return 行列を作り直したカスケードのビット */
+        UINT32 Update(const Math::Matrix& mCameraWorld)
+        {
+            const std::array<float, ShadowCascade::CascadeNum + 1> splits =
+                ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, SplitLambda);
+
+            UINT32 rebuildMask = 0;
+            for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+            {
+                ShadowCascade::Cascade& cascade = m_cascades[i];
+                cascade.SplitNear = splits[i];
+                cascade.SplitFar = splits[i + 1];
+
+                float centerDist = 0.0f;
+                float radius = 0.0f;
+                ShadowCascade::CalcSliceSphere(m_mProj, cascade.SplitNear, cascade.SplitFar, centerDist, radius);
+
+                const Math::Vector3 center = Math::Vector3::Transform({ 0.0f, 0.0f, centerDist }, mCameraWorld);
+                if (ShadowCascade::IsSphereCovered(cascade, center, radius)) { continue; }
+
+                cascade.SphereCenter = center;
+                cascade.SphereRadius = ShadowCascade::CalcSlackRadius(radius);
+                cascade.mViewProj = ShadowCascade::CalcViewProj(
+                    cascade.SphereCenter, cascade.SphereRadius, m_mLightRotation, Resolution, CasterExtrusion);
+
+                rebuildMask |= 1u << i;
+            }
+            return rebuildMask;
+        }
+
+        const ShadowCascade::Cascade& GetCascade(UINT32 cascadeIdx) const { return m_cascades[cascadeIdx]; }
+
+    private:
+        Math::Matrix m_mProj = CreateProj();
+        Math::Matrix m_mLightRotation = CreateLightRotation();
+
+        std::array<ShadowCascade::Cascade, ShadowCascade::CascadeNum> m_cascades = {};
+    };
+
+    /* @brief ワールド座標のシャドウマップ上のテクセル座標 */
+    Math::Vector2 ToTexel(const Math::Matrix& mViewProj, const Math::Vector3& worldPos)
+    {
+        const Math::Vector3 ndc = Math::Vector3::Transform(worldPos, mViewProj);
+        return { (ndc.x * 0.5f + 0.5f) * Resolution, (0.5f - ndc.y * 0.5f) * Resolution };
+    }
+
+    /* @brief テクセル座標の差が整数か : 影の輪郭がテクセル単位でしか動かなければちらつかない */
+    bool IsWholeTexelShift(const Math::Vector2& a, const Math::Vector2& b)
+    {
+        const float dx = b.x - a.x;
+        const float dy = b.y - a.y;
+        return std::abs(dx - std::round(dx)) < TexelEpsilon && std::abs(dy - std::round(dy)) < TexelEpsilon;
+    }
+
+    /* @brief ビュー空間で奥行き viewZ の位置にある、視錐台の角 */
+    Math::Vector3 CalcViewCorner(float viewZ, float signX, float signY)
+    {
+        const float halfHeight = std::tan(FovY * 0.5f) * viewZ;
+        return { signX * halfHeight * Aspect, signY * halfHeight, viewZ };
+    }
+
+    // 影の輪郭の位置を見るワールド座標 : 最も近いカスケードに入るようにカメラの前に置く
+    const std::array<Math::Vector3, 3> ProbePoints = { {
+        { 0.3f, 0.0f, 4.0f },
+        { -1.7f, 0.5f, 6.0f },
+        { 2.1f, -0.4f, 3.0f },
+    } };
+}
+
+FNTEST_CASE(ShadowCascade, SplitDistancesBlendLogAndUniform)
+{
+    const auto uniform = ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, 0.0f);
+    const auto logarithmic = ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, 1.0f);
+    const auto practical = ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, SplitLambda);
+
+    for (const auto* pSplits : { &uniform, &logarithmic, &practical })
+    {
+        FNTEST_CHECK_NEAR((*pSplits)[0], NearClip, 1.0e-6f);
+        FNTEST_CHECK_NEAR((*pSplits)[ShadowCascade::CascadeNum], MaxDistance, 1.0e-4f);
+
+        for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+        {
+            FNTEST_CHECK((*pSplits)[i] < (*pSplits)[i + 1]);
+        }
+    }
+
+    const float uniformStep = (MaxDistance - NearClip) / ShadowCascade::CascadeNum;
+    const float logRatio = std::pow(MaxDistance / NearClip, 1.0f / ShadowCascade::CascadeNum);
+
+    for (UINT32 i = 1; i < ShadowCascade::CascadeNum; ++i)
+    {
+        // 均等分割は等差、対数分割は等比になる
+        FNTEST_CHECK_NEAR(uniform[i] - uniform[i - 1], uniformStep, 1.0e-3f);
+        FNTEST_CHECK_NEAR(logarithmic[i] / logarithmic[i - 1], logRatio, logRatio * 1.0e-4f);
+
+        // 混ぜた分割は2つの間に入る
+        const float expected = SplitLambda * logarithmic[i] + (1.0f - SplitLambda) * uniform[i];
+        FNTEST_CHECK_NEAR(practical[i], expected, 1.0e-3f);
+        FNTEST_CHECK(logarithmic[i] < practical[i] && practical[i] < uniform[i]);
+    }
+}
+
+FNTEST_CASE(ShadowCascade, SliceSphereTightlyBoundsSlice)
+{
+    const Math::Matrix mProj = CreateProj();
+    const auto splits = ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, SplitLambda);
+
+    for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+    {
+        float centerDist = 0.0f;
+        float radius = 0.0f;
+        ShadowCascade::CalcSliceSphere(mProj, splits[i], splits[i + 1], centerDist, radius);
+
+        FNTEST_CHECK(splits[i] <= centerDist && centerDist <= splits[i + 1]);
+
+        // 半径は丸め単位の倍数になる
+        const float quantized = radius * ShadowCascade::RadiusQuantize;
+        FNTEST_CHECK_NEAR(quantized, std::round(quantized), 1.0e-3f);
+
+        // 分割した視錐台の8つの角がすべて入り、最も遠い角との差は丸め単位より小さい
+        const Math::Vector3 center = { 0.0f, 0.0f, centerDist };
+        float maxCornerDist = 0.0f;
+        for (const float viewZ : { splits[i], splits[i + 1] })
+        {
+            for (const float signX : { -1.0f, 1.0f })
+            {
+                for (const float signY : { -1.0f, 1.0f })
+                {
+                    maxCornerDist = std::max(maxCornerDist, Math::Vector3::Distance(center, CalcViewCorner(viewZ, signX, signY)));
+                }
+            }
+        }
+
+        const float tolerance = splits[i + 1] * 1.0e-4f;
+        FNTEST_CHECK(maxCornerDist <= radius + tolerance);
+        FNTEST_CHECK(radius - maxCornerDist <= 1.0f / ShadowCascade::RadiusQuantize + tolerance);
+    }
+}
+
+FNTEST_CASE(ShadowCascade, SphereCoverRequiresContainmentAndLimitsSlack)
+{
+    ShadowCascade::Cascade cascade;
+
+    // まだ作っていないカスケードは使えない
+    FNTEST_CHECK(!ShadowCascade::IsSphereCovered(cascade, Math::Vector3::Zero, 1.0f));
+
+    cascade.SphereCenter = Math::Vector3::Zero;
+    cascade.SphereRadius = ShadowCascade::CalcSlackRadius(10.0f);
+
+    // 余裕の範囲で動いた球は包める
+    FNTEST_CHECK(ShadowCascade::IsSphereCovered(cascade, { 1.0f, 0.0f, 0.0f }, 10.0f));
+
+    // はみ出した球は包めない
+    FNTEST_CHECK(!ShadowCascade::IsSphereCovered(cascade, { cascade.SphereRadius, 0.0f, 0.0f }, 10.0f));
+
+    // 球が小さくなりすぎた場合は、解像度を戻すために作り直す
+    FNTEST_CHECK(!ShadowCascade::IsSphereCovered(cascade, Math::Vector3::Zero, 5.0f));
+}
+
+FNTEST_CASE(ShadowCascade, TranslationMovesShadowByWholeTexels)
+{
+    const Math::Matrix mLightRotation = CreateLightRotation();
+    constexpr float Radius = 12.5f;
+
+    const Math::Matrix mBase = ShadowCascade::CalcViewProj(Math::Vector3::Zero, Radius, mLightRotation, Resolution, CasterExtrusion);
+
+    // テクセルより細かい移動も含めて球の中心をずらす : 行列を作り直しても、点はテクセル単位でしか動かない
+    const float texelSize = Radius * 2.0f / Resolution;
+    for (int step = 1; step <= 64; ++step)
+    {
+        const Math::Vector3 center = { step * texelSize * 0.37f, step * 0.011f, -step * texelSize * 0.73f };
+        const Math::Matrix mMoved = ShadowCascade::CalcViewProj(center, Radius, mLightRotation, Resolution, CasterExtrusion);
+
+        for (const Math::Vector3& probe : ProbePoints)
+        {
+            FNTEST_CHECK(IsWholeTexelShift(ToTexel(mBase, probe), ToTexel(mMoved, probe)));
+        }
+    }
+}
+
+FNTEST_CASE(ShadowCascade, RotationKeepsTexelSizeAndSnapping)
+{
+    const Math::Matrix mProj = CreateProj();
+    const Math::Matrix mLightRotation = CreateLightRotation();
+    const auto splits = ShadowCascade::CalcSplitDistances(NearClip, MaxDistance, SplitLambda);
+
+    float centerDist = 0.0f;
+    float radius = 0.0f;
+    ShadowCascade::CalcSliceSphere(mProj, splits[0], splits[1], centerDist, radius);
+    radius = ShadowCascade::CalcSlackRadius(radius);
+
+    Math::Matrix mFirst;
+    float firstTexelSize = 0.0f;
+
+    // その場で一周回す : 球の中心は動くが、半径は向きに関係ないのでテクセルの大きさは変わらない
+    for (int yaw = 0; yaw < 360; yaw += 7)
+    {
+        const Math::Matrix mCameraWorld = CreateCameraWorld({ 3.0f, 1.5f, -2.0f }, static_cast<float>(yaw));
+        const Math::Vector3 center = Math::Vector3::Transform({ 0.0f, 0.0f, centerDist }, mCameraWorld);
+
+        const Math::Matrix mViewProj = ShadowCascade::CalcViewProj(center, radius, mLightRotation, Resolution, CasterExtrusion);
+
+        // ライトの右方向に 1m 離れた2点の、テクセル上の距離
+        const Math::Vector3 lightRight = Math::Vector3::TransformNormal(Math::Vector3::Right, mLightRotation.Invert());
+        const float texelSize = 1.0f / (ToTexel(mViewProj, lightRight).x - ToTexel(mViewProj, Math::Vector3::Zero).x);
+
+        if (yaw == 0)
+        {
+            mFirst = mViewProj;
+            firstTexelSize = texelSize;
+            continue;
+        }
+
+        FNTEST_CHECK_NEAR(texelSize, firstTexelSize, firstTexelSize * 1.0e-4f);
+
+        for (const Math::Vector3& probe : ProbePoints)
+        {
+            FNTEST_CHECK(IsWholeTexelShift(ToTexel(mFirst, probe), ToTexel(mViewProj, probe)));
+        }
+    }
+}
+
+FNTEST_CASE(ShadowCascade, SmallCameraMotionKeepsMatrices)
+{
+    CascadeFitter fitter;
+
+    FNTEST_CHECK(fitter.Update(CreateCameraWorld(Math::Vector3::Zero, 0.0f)) == ShadowCascade::AllCascadeMask);
+
+    std::array<Math::Matrix, ShadowCascade::CascadeNum> mInitials;
+    for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i) { mInitials[i] = fitter.GetCascade(i).mViewProj; }
+
+    // 少しの移動と回転では、どのカスケードも前回の行列を使い続ける
+    FNTEST_CHECK(fitter.Update(CreateCameraWorld({ 0.01f, 0.0f, 0.01f }, 0.5f)) == 0);
+    for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+    {
+        FNTEST_CHECK(fitter.GetCascade(i).mViewProj == mInitials[i]);
+    }
+
+    // 振り向くと、奥のカスケードほど球の中心が大きく動くので作り直す
+    const UINT32 turnMask = fitter.Update(CreateCameraWorld(Math::Vector3::Zero, 180.0f));
+    FNTEST_CHECK((turnMask & (1u << (ShadowCascade::CascadeNum - 1))) != 0);
+
+    // 作り直したカスケードも、作り直す前とはテクセル単位でしかずれない
+    for (UINT32 i = 0; i < ShadowCascade::CascadeNum; ++i)
+    {
+        if ((turnMask & (1u << i)) == 0) { continue; }
+
+        for (const Math::Vector3& probe : ProbePoints)
+        {
+            FNTEST_CHECK(IsWholeTexelShift(ToTexel(mInitials[i], probe), ToTexel(fitter.GetCascade(i).mViewProj, probe)));
+        }
+    }
+}
+
+FNTEST_CASE(ShadowCascade, AtlasTileMapsIntoQuadrant)
+{
+    for (UINT32 cascadeIdx = 0; cascadeIdx < ShadowCascade::CascadeNum; ++cascadeIdx)
+    {
+        const Math::Matrix mTile = ShadowCascade::CalcAtlasTileMatrix(cascadeIdx);
+
+        const float column = static_cast<float>(cascadeIdx % ShadowCascade::AtlasTileNum);
+        const float row = static_cast<float>(cascadeIdx / ShadowCascade::AtlasTileNum);
+
+        // 射影空間の角は、シャドウマップ全体の UV でタイルの角になる
+        const Math::Vector3 topLeft = Math::Vector3::Transform({ -1.0f, 1.0f, 0.5f }, mTile);
+        const Math::Vector3 bottomRight = Math::Vector3::Transform({ 1.0f, -1.0f, 0.5f }, mTile);
+
+        FNTEST_CHECK_NEAR(topLeft.x * 0.5f + 0.5f, column / ShadowCascade::AtlasTileNum, 1.0e-5f);
+        FNTEST_CHECK_NEAR(0.5f - topLeft.y * 0.5f, row / ShadowCascade::AtlasTileNum, 1.0e-5f);
+        FNTEST_CHECK_NEAR(bottomRight.x * 0.5f + 0.5f, (column + 1.0f) / ShadowCascade::AtlasTileNum, 1.0e-5f);
+        FNTEST_CHECK_NEAR(0.5f - bottomRight.y * 0.5f, (row + 1.0f) / ShadowCascade::AtlasTileNum, 1.0e-5f);
+        FNTEST_CHECK_NEAR(topLeft.z, 0.5f, 1.0e-6f);
+    }
+}
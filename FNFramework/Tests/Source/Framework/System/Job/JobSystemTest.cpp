@@ -0,0 +1,207 @@
+﻿#include "TestFramework/Test.h"
+
+FNTEST_CASE(JobSystem, DependentJobsRunAfterDependency)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+    JobSystem& jobs = JobSystem::Instance();
+
+    constexpr int JobNum = 256;
+
+    std::atomic<int> firstDoneNum = 0;
+    std::atomic<int> earlyNum = 0;
+    std::atomic<int> secondDoneNum = 0;
+
+    JobCounter firstCounter;
+    JobCounter secondCounter;
+
+    for (int i = 0; i < JobNum; ++i)
+    {
+        jobs.Run([&]() { firstDoneNum.fetch_add(1); }, &firstCounter);
+    }
+
+    for (int i = 0; i < JobNum; ++i)
+    {
+        jobs.Run([&]()
+            {
+                if (firstDoneNum.load() != JobNum) { earlyNum.fetch_add(1); }
+                secondDoneNum.fetch_add(1);
+            }, &secondCounter, &firstCounter);
+    }
+
+    jobs.Wait(secondCounter);
+
+    FNTEST_CHECK(firstDoneNum.load() == JobNum);
+    FNTEST_CHECK(secondDoneNum.load() == JobNum);
+    FNTEST_CHECK(earlyNum.load() == 0);
+}
+
+FNTEST_CASE(JobSystem, DependencyChain)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+    JobSystem& jobs = JobSystem::Instance();
+
+    // 前の段に依存する段を並べる : 各段は前の段が終わってから順に実行される
+    constexpr int StageNum = 64;
+
+    std::array<JobCounter, StageNum> counters;
+    std::vector<int> order;
+    std::mutex orderMutex;
+
+    for (int stage = 0; stage < StageNum; ++stage)
+    {
+        const JobCounter* pDependency = stage > 0 ? &counters[stage - 1] : nullptr;
+
+        jobs.Run([&, stage]()
+            {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                order.push_back(stage);
+            }, &counters[stage], pDependency);
+    }
+
+    jobs.Wait(counters[StageNum - 1]);
+
+    FNTEST_REQUIRE(order.size() == StageNum);
+    for (int stage = 0; stage < StageNum; ++stage)
+    {
+        FNTEST_CHECK(order[stage] == stage);
+    }
+}
+
+/**
+* @brief 依存先が終わっていないジョブは、キューの取り出しと積み直しを繰り返さない
+* @details
+*   以前は依存先を待つジョブをキューに積み直していたため、待機中のワーカーが
+*   同じジョブを盗んでは積み直す空回りを続けていた
+*   依存先のカウンタで待たせるようになったので、待っている間に盗まれるジョブはない
+*/
+FNTEST_CASE(JobSystem, BlockedJobDoesNotSpin)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+    JobSystem& jobs = JobSystem::Instance();
+
+    std::atomic<bool> isRelease = false;
+    std::atomic<bool> isDependentDone = false;
+
+    JobCounter blockerCounter;
+    JobCounter dependentCounter;
+
+    // ワーカーの1つを止めておくジョブ
+    jobs.Run([&]()
+        {
+            while (!isRelease.load()) { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+        }, &blockerCounter);
+
+    jobs.Run([&]() { isDependentDone = true; }, &dependentCounter, &blockerCounter);
+
+    // ワーカーが止めるジョブを盗むのを待ってから、待機中の取り出し回数を数える
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    const UINT64 stolenNum = jobs.GetStolenJobNum();
+    const UINT64 executedNum = jobs.GetExecutedJobNum();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    FNTEST_CHECK(jobs.GetStolenJobNum() == stolenNum);
+    FNTEST_CHECK(jobs.GetExecutedJobNum() == executedNum);
+    FNTEST_CHECK(!isDependentDone.load());
+
+    isRelease = true;
+    jobs.Wait(dependentCounter);
+
+    FNTEST_CHECK(isDependentDone.load());
+}
+
+FNTEST_CASE(JobSystem, ParallelForCoversRange)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+
+    constexpr UINT32 Count = 100000;
+    std::vector<UINT8> visited(Count, 0);
+
+    JobSystem::Instance().ParallelFor(Count, 0, [&](UINT32 begin, UINT32 end)
+        {
+            for (UINT32 i = begin; i < end; ++i) { ++visited[i]; }
+        });
+
+    FNTEST_CHECK(std::all_of(visited.begin(), visited.end(), [](UINT8 v) { return v == 1; }));
+}
+
+/**
+* @brief 空のジョブを積んで実行するまでのスループット
+* @details メインスレッドから一定数ずつ積み、完了を待つ
+*/
+FNTEST_BENCH(JobSystem, EmptyJobThroughput)
+{
+    const UINT32 totalJobNum = fntest::IsQuick() ? 100000 : 2000000;
+    constexpr UINT32 BatchNum = 2048;
+
+    fntest::ScopedJobSystem jobSystem;
+    JobSystem& jobs = JobSystem::Instance();
+
+    const auto submit = [&]()
+        {
+            for (UINT32 submitted = 0; submitted < totalJobNum; submitted += BatchNum)
+            {
+                JobCounter counter;
+                for (UINT32 i = 0; i < BatchNum; ++i)
+                {
+                    jobs.Run([]() {}, &counter);
+                }
+                jobs.Wait(counter);
+            }
+        };
+
+    const double ms = fntest::MeasureMinMs(3, submit);
+
+    fntest::ReportBench("threads", jobs.GetThreadNum(), "");
+    fntest::ReportBench("empty jobs", totalJobNum / (ms / 1000.0), "jobs/sec");
+    fntest::ReportBench("per job", ms * 1.0e6 / totalJobNum, "ns");
+}
+
+/**
+* @brief スレッド数ごとの ParallelFor のスケーリング
+* @details
+*   1 ~ 32 スレッドで同じ計算を行い、1 スレッドに対する速度を出す
+*   ハードウェアのスレッド数を超える場合は、参考値として(oversubscribed)を付ける
+*/
+FNTEST_BENCH(JobSystem, Scaling)
+{
+    const UINT32 count = fntest::IsQuick() ? (1u << 18) : (1u << 22);
+    const UINT32 hardwareThreadNum = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<float> values(count);
+    for (UINT32 i = 0; i < count; ++i) { values[i] = static_cast<float>(i % 1024) * 0.01f; }
+
+    std::vector<float> results(count);
+
+    double singleMs = 0.0;
+
+    for (const UINT32 threadNum : { 1u, 2u, 4u, 8u, 16u, 32u })
+    {
+        fntest::ScopedJobSystem jobSystem(threadNum);
+
+        const double ms = fntest::MeasureMinMs(fntest::IsQuick() ? 2 : 5, [&]()
+            {
+                JobSystem::Instance().ParallelFor(count, 0, [&](UINT32 begin, UINT32 end)
+                    {
+                        for (UINT32 i = begin; i < end; ++i)
+                        {
+                            // 1要素あたり数十サイクルの計算
+                            float v = values[i];
+                            for (int k = 0; k < 8; ++k) { v = std::sqrt(v * v + 1.0f) * 0.5f + std::sin(v); }
+                            results[i] = v;
+                        }
+                    });
+            });
+
+        fntest::DoNotOptimize(results);
+
+        if (threadNum == 1) { singleMs = ms; }
+
+        std::string label = std::to_string(threadNum) + " threads";
+        if (threadNum > hardwareThreadNum) { label += " (oversubscribed)"; }
+
+        fntest::ReportBench(label, ms, "ms");
+        fntest::ReportBench(label + " speedup", singleMs / ms, "x");
+    }
+}
@@ -0,0 +1,221 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /* @brief 計測用のカメラ : 原点から少し回した向きを見る */
+    struct BenchCamera
+    {
+        Math::Matrix mView;
+        Math::Matrix mProj;
+    };
+
+    BenchCamera CreateCamera()
+    {
+        BenchCamera camera;
+
+        const Math::Matrix mCamera = Math::Matrix::CreateRotationY(DirectX::XMConvertToRadians(30.0f)) *
+            Math::Matrix::CreateTranslation(10.0f, 5.0f, -20.0f);
+
+        camera.mView = mCamera.Invert();
+        camera.mProj = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        return camera;
+    }
+
+    // 判定するボックス : 比較用に同じ値を AABBArrays と DirectX::BoundingBox の両方で持つ
+    struct BenchBoxes
+    {
+        FrustumCulling::AABBArrays Arrays;
+        std::vector<DirectX::BoundingBox> Boxes;
+    };
+
+    /* @brief カメラの周り 2km 四方にボックスを散らす : 視錐台に入るのは一部だけになる */
+    BenchBoxes CreateBoxes(UINT32 boxNum)
+    {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> posDist(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> sizeDist(0.1f, 5.0f);
+
+        BenchBoxes boxes;
+        boxes.Arrays.Resize(boxNum);
+        boxes.Boxes.resize(boxNum);
+
+        for (UINT32 i = 0; i < boxNum; ++i)
+        {
+            const Math::Vector3 center = { posDist(rng), posDist(rng) * 0.1f, posDist(rng) };
+            const Math::Vector3 extents = { sizeDist(rng), sizeDist(rng), sizeDist(rng) };
+
+            boxes.Arrays.Set(i, center, extents);
+            boxes.Boxes[i] = DirectX::BoundingBox(center, extents);
+        }
+        return boxes;
+    }
+
+    /* @brief ClassifyAABB で1個ずつ判定する : SIMD の結果と比べる基準 */
+    std::vector<UINT32> TestScalar(const FrustumCulling::Planes& planes, const BenchBoxes& boxes)
+    {
+        std::vector<UINT32> visibleBits(boxes.Arrays.GetBitWordNum(), 0);
+
+        for (UINT32 i = 0; i < static_cast<UINT32>(boxes.Boxes.size()); ++i)
+        {
+            const DirectX::BoundingBox& box = boxes.Boxes[i];
+
+            UINT32 planeMask = FrustumCulling::AllPlaneMask;
+            if (FrustumCulling::ClassifyAABB(planes, box.Center, box.Extents, planeMask))
+            {
+                visibleBits[i / FrustumCulling::BitWordSize] |= 1u << (i % FrustumCulling::BitWordSize);
+            }
+        }
+        return visibleBits;
+    }
+
+    UINT32 CountVisible(const std::vector<UINT32>& visibleBits)
+    {
+        UINT32 visibleNum = 0;
+        for (const UINT32 word : visibleBits) { visibleNum += static_cast<UINT32>(std::popcount(word)); }
+        return visibleNum;
+    }
+}
+
+FNTEST_CASE(FrustumCulling, SIMDPathsMatchScalar)
+{
+    // 8 の倍数でない数にして、余りの要素が見えない扱いになることも確かめる
+    constexpr UINT32 BoxNum = 10003;
+
+    const BenchCamera camera = CreateCamera();
+    const FrustumCulling::Planes planes = FrustumCulling::ExtractPlanes(camera.mView * camera.mProj);
+    const BenchBoxes boxes = CreateBoxes(BoxNum);
+
+    const std::vector<UINT32> expected = TestScalar(planes, boxes);
+    FNTEST_REQUIRE(CountVisible(expected) > 0);
+    FNTEST_REQUIRE(CountVisible(expected) < BoxNum);
+
+    for (const FrustumCulling::SIMDPath path : { FrustumCulling::SIMDPath::eSSE, FrustumCulling::SIMDPath::eAVX2 })
+    {
+        std::vector<UINT32> visibleBits(boxes.Arrays.GetBitWordNum(), 0xFFFFFFFFu);
+        FrustumCulling::TestAABBs(planes, boxes.Arrays, 0, boxes.Arrays.GetPaddedNum(), visibleBits.data(), path);
+
+        FNTEST_CHECK(visibleBits == expected);
+    }
+}
+
+FNTEST_CASE(FrustumCulling, WordAlignedRangesMatchWholeRange)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+
+    constexpr UINT32 BoxNum = 4099;
+
+    const BenchCamera camera = CreateCamera();
+    const FrustumCulling::Planes planes = FrustumCulling::ExtractPlanes(camera.mView * camera.mProj);
+    const BenchBoxes boxes = CreateBoxes(BoxNum);
+
+    std::vector<UINT32> wholeBits(boxes.Arrays.GetBitWordNum(), 0);
+    FrustumCulling::TestAABBs(planes, boxes.Arrays, 0, boxes.Arrays.GetPaddedNum(), wholeBits.data());
+
+    // ビット配列の要素ごとに分けて、ワーカーから同時に書き込む
+    std::vector<UINT32> splitBits(boxes.Arrays.GetBitWordNum(), 0xFFFFFFFFu);
+    JobSystem::Instance().ParallelFor(boxes.Arrays.GetBitWordNum(), 1, [&](UINT32 beginWord, UINT32 endWord)
+        {
+            FrustumCulling::TestAABBs(planes, boxes.Arrays, beginWord * FrustumCulling::BitWordSize,
+                endWord * FrustumCulling::BitWordSize, splitBits.data());
+        });
+
+    FNTEST_CHECK(splitBits == wholeBits);
+}
+
+/**
+* @brief 100,000 個のボックスの視錐台カリング
+* @details
+*   - BoundingFrustum : 以前の ModelComponent と同じく、ボックスごとに視錐台を作ってワールドへ変換して判定する
+*   - ClassifyAABB    : 平面は1回だけ取り出し、1個ずつ判定する
+*   - SSE / AVX2      : 成分ごとの配列を 4 / 8 個ずつ判定する
+*   - AVX2 workers    : ビット配列の要素の境目で分けて、JobSystem のワーカーで判定する
+*/
+FNTEST_BENCH(FrustumCulling, Cull100k)
+{
+    const UINT32 boxNum = fntest::IsQuick() ? 10000 : 100000;
+    const int repeat = fntest::IsQuick() ? 3 : 20;
+
+    const BenchCamera camera = CreateCamera();
+    const FrustumCulling::Planes planes = FrustumCulling::ExtractPlanes(camera.mView * camera.mProj);
+    const BenchBoxes boxes = CreateBoxes(boxNum);
+
+    std::vector<UINT32> visibleBits(boxes.Arrays.GetBitWordNum(), 0);
+
+    const auto report = [&](const std::string& label, double ms)
+        {
+            fntest::ReportBench(label, ms, "ms");
+            fntest::ReportBench(label, ms * 1.0e6 / boxNum, "ns/box");
+        };
+
+    //--------------------------------
+    // ボックスごとに視錐台を作る
+    //--------------------------------
+    UINT32 frustumVisibleNum = 0;
+    const double frustumMs = fntest::MeasureMinMs(repeat, [&]()
+        {
+            frustumVisibleNum = 0;
+            const Math::Matrix mViewInv = camera.mView.Invert();
+
+            for (const DirectX::BoundingBox& box : boxes.Boxes)
+            {
+                DirectX::BoundingFrustum frustum(camera.mProj);
+                frustum.Transform(frustum, mViewInv);
+
+                if (frustum.Intersects(box)) { ++frustumVisibleNum; }
+            }
+        });
+
+    //--------------------------------
+    // 1個ずつ
+    //--------------------------------
+    std::vector<UINT32> scalarBits;
+    const double scalarMs = fntest::MeasureMinMs(repeat, [&]() { scalarBits = TestScalar(planes, boxes); });
+
+    //--------------------------------
+    // SSE / AVX2
+    //--------------------------------
+    const double sseMs = fntest::MeasureMinMs(repeat, [&]()
+        {
+            FrustumCulling::TestAABBs(planes, boxes.Arrays, 0, boxes.Arrays.GetPaddedNum(), visibleBits.data(),
+                FrustumCulling::SIMDPath::eSSE);
+        });
+
+    const double avx2Ms = fntest::MeasureMinMs(repeat, [&]()
+        {
+            FrustumCulling::TestAABBs(planes, boxes.Arrays, 0, boxes.Arrays.GetPaddedNum(), visibleBits.data(),
+                FrustumCulling::SIMDPath::eAVX2);
+        });
+
+    //--------------------------------
+    // ワーカーで分けて判定する
+    //--------------------------------
+    double workerMs = 0.0;
+    UINT32 threadNum = 0;
+    {
+        fntest::ScopedJobSystem jobSystem;
+        threadNum = JobSystem::Instance().GetThreadNum();
+
+        workerMs = fntest::MeasureMinMs(repeat, [&]()
+            {
+                JobSystem::Instance().ParallelFor(boxes.Arrays.GetBitWordNum(), 0, [&](UINT32 beginWord, UINT32 endWord)
+                    {
+                        FrustumCulling::TestAABBs(planes, boxes.Arrays, beginWord * FrustumCulling::BitWordSize,
+                            endWord * FrustumCulling::BitWordSize, visibleBits.data());
+                    });
+            });
+    }
+
+    fntest::ReportBench("boxes", boxNum, "");
+    fntest::ReportBench("visible (BoundingFrustum)", frustumVisibleNum, "");
+    fntest::ReportBench("visible (SIMD)", CountVisible(visibleBits), "");
+    fntest::ReportBench("AVX2 available", FrustumCulling::IsAVX2Enable() ? 1.0 : 0.0, "");
+
+    report("BoundingFrustum per box", frustumMs);
+    report("ClassifyAABB", scalarMs);
+    report("SSE", sseMs);
+    report("AVX2", avx2Ms);
+    report("AVX2 workers (" + std::to_string(threadNum) + " threads)", workerMs);
+
+    fntest::ReportBench("AVX2 speedup vs BoundingFrustum", frustumMs / avx2Ms, "x");
+    fntest::ReportBench("AVX2 speedup vs SSE", sseMs / avx2Ms, "x");
+}
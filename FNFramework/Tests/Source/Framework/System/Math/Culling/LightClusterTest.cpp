@@ -0,0 +1,424 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    constexpr float TestNear = 0.1f;
+    constexpr float TestFar = 100.0f;
+
+    Math::Matrix CreateProj()
+    {
+        return DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), 16.0f / 9.0f, TestNear, TestFar);
+    }
+
+    /* @brief 原点から +z を見るカメラ : ビュー空間とワールド空間が同じなので、境目に正確に置ける */
+    LightCluster::Grid CreateAxisGrid()
+    {
+        return LightCluster::Grid::Create(Math::Matrix::Identity, CreateProj(), TestNear, TestFar);
+    }
+
+    /* @brief 回して動かしたカメラ : ビュー行列での変換も確かめる */
+    LightCluster::Grid CreateRotatedGrid()
+    {
+        const Math::Matrix mCamera = Math::Matrix::CreateRotationY(DirectX::XMConvertToRadians(30.0f)) *
+            Math::Matrix::CreateTranslation(5.0f, 2.0f, -10.0f);
+
+        return LightCluster::Grid::Create(mCamera.Invert(), CreateProj(), TestNear, TestFar);
+    }
+
+    /**
+    * @brief ワールド空間の点が入るクラスター : LightingPass_PS の CalculateClusterIndex と同じ求め方
+    * @return 画面の外 / near より手前なら false
+    */
+    bool FindCluster(const LightCluster::Grid& grid, const Math::Vector3& worldPos, UINT32& cluster)
+    {
+        const Math::Vector3 viewPos = Math::Vector3::Transform(worldPos, grid.mView);
+        if (viewPos.z < grid.Near || viewPos.z > grid.Far) { return false; }
+
+        const Math::Matrix& mProj = grid.mProj;
+        const float clipW = viewPos.x * mProj._14 + viewPos.y * mProj._24 + viewPos.z * mProj._34 + mProj._44;
+        const float ndcX = (viewPos.x * mProj._11 + viewPos.y * mProj._21 + viewPos.z * mProj._31 + mProj._41) / clipW;
+        const float ndcY = (viewPos.x * mProj._12 + viewPos.y * mProj._22 + viewPos.z * mProj._32 + mProj._42) / clipW;
+        if (std::abs(ndcX) > 1.0f || std::abs(ndcY) > 1.0f) { return false; }
+
+        // UV は左上が原点
+        const float u = ndcX * 0.5f + 0.5f;
+        const float v = 0.5f - ndcY * 0.5f;
+        const UINT32 x = std::min(static_cast<UINT32>(u * LightCluster::TileNumX), LightCluster::TileNumX - 1);
+        const UINT32 y = std::min(static_cast<UINT32>(v * LightCluster::TileNumY), LightCluster::TileNumY - 1);
+
+        cluster = LightCluster::GetClusterIndex(x, y, grid.GetSlice(viewPos.z));
+        return true;
+    }
+
+    bool HasLight(const LightCluster::Builder& builder, UINT32 cluster, UINT32 lightIdx)
+    {
+        const LightCluster::Range& range = builder.GetRanges()[cluster];
+        const auto begin = builder.GetLightIndices().begin() + range.Offset;
+        return std::find(begin, begin + range.Count, lightIdx) != begin + range.Count;
+    }
+
+    // ライトが入ったクラスターの一覧
+    std::vector<UINT32> FindClusters(const LightCluster::Builder& builder, UINT32 lightIdx)
+    {
+        std::vector<UINT32> clusters;
+        for (UINT32 cluster = 0; cluster < LightCluster::ClusterNum; ++cluster)
+        {
+            if (HasLight(builder, cluster, lightIdx)) { clusters.push_back(cluster); }
+        }
+        return clusters;
+    }
+
+    /* @brief カメラの前に散らしたライト */
+    std::vector<Math::Vector4> CreateLights(const LightCluster::Grid& grid, UINT32 lightNum, UINT32 seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unitDist(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> radiusDist(0.2f, 4.0f);
+
+        const Math::Matrix mInvView = grid.mView.Invert();
+
+        std::vector<Math::Vector4> lights(lightNum);
+        for (Math::Vector4& light : lights)
+        {
+            // 近くに多めに置く : 手前の細かい奥行きにもライトが入る
+            const float z = 0.5f + (unitDist(rng) * 0.5f + 0.5f) * (unitDist(rng) * 0.5f + 0.5f) * 60.0f;
+            const Math::Vector3 viewPos = { unitDist(rng) * z * 1.2f, unitDist(rng) * z * 0.7f, z };
+            const Math::Vector3 pos = Math::Vector3::Transform(viewPos, mInvView);
+            light = { pos.x, pos.y, pos.z, radiusDist(rng) };
+        }
+        return lights;
+    }
+}
+
+FNTEST_CASE(LightCluster, SliceBoundsAreExponential)
+{
+    const LightCluster::Grid grid = CreateAxisGrid();
+
+    FNTEST_CHECK_NEAR(grid.GetSliceZ(0), TestNear, 1.0e-6f);
+    FNTEST_CHECK_NEAR(grid.GetSliceZ(LightCluster::SliceNum), TestFar, 1.0e-6f);
+
+    const float ratio = std::pow(TestFar / TestNear, 1.0f / static_cast<float>(LightCluster::SliceNum));
+    for (UINT32 slice = 0; slice < LightCluster::SliceNum; ++slice)
+    {
+        const float nearZ = grid.GetSliceZ(slice);
+        const float farZ = grid.GetSliceZ(slice + 1);
+        FNTEST_CHECK_NEAR(farZ / nearZ, ratio, 1.0e-3f);
+
+        // 境目の少し奥は次の番号、少し手前は前の番号 : シェーダーと同じ log の式で求める
+        FNTEST_CHECK(grid.GetSlice(nearZ * 1.001f) == slice);
+        FNTEST_CHECK(grid.GetSlice(farZ * 0.999f) == slice);
+        FNTEST_CHECK(grid.GetSlice(std::sqrt(nearZ * farZ)) == slice);
+    }
+
+    // 範囲外は端の番号
+    FNTEST_CHECK(grid.GetSlice(-5.0f) == 0);
+    FNTEST_CHECK(grid.GetSlice(TestNear * 0.5f) == 0);
+    FNTEST_CHECK(grid.GetSlice(TestFar * 2.0f) == LightCluster::SliceNum - 1);
+}
+
+FNTEST_CASE(LightCluster, LightOnSliceEdgeGoesToBothSlices)
+{
+    const LightCluster::Grid grid = CreateAxisGrid();
+    auto upBuilder = std::make_unique<LightCluster::Builder>();
+
+    // 画面の中央のタイルの真ん中で、奥行きの境目に中心を置く
+    const UINT32 centerX = LightCluster::TileNumX / 2;
+    const UINT32 centerY = LightCluster::TileNumY / 2;
+    const float tileCenterX = 1.0f / static_cast<float>(LightCluster::TileNumX) / grid.mProj._11;
+
+    std::vector<Math::Vector4> lights;
+    std::vector<UINT32> edgeSlices;
+    for (UINT32 slice = 4; slice < LightCluster::SliceNum; slice += 5)
+    {
+        const float z = grid.GetSliceZ(slice);
+        lights.push_back({ tileCenterX * z, 0.0f, z, z * 0.01f });
+        edgeSlices.push_back(slice);
+
+        // 境目に届かないライト : 手前の奥行きにだけ入る
+        const float beforeZ = z * 0.97f;
+        lights.push_back({ tileCenterX * beforeZ, 0.0f, beforeZ, beforeZ * 0.01f });
+    }
+
+    upBuilder->Build(grid, lights);
+
+    for (size_t i = 0; i < edgeSlices.size(); ++i)
+    {
+        const UINT32 slice = edgeSlices[i];
+
+        const std::vector<UINT32> edgeClusters = FindClusters(*upBuilder, static_cast<UINT32>(i * 2));
+        FNTEST_CHECK(edgeClusters == std::vector<UINT32>({
+            LightCluster::GetClusterIndex(centerX, centerY, slice - 1),
+            LightCluster::GetClusterIndex(centerX, centerY, slice) }));
+
+        const std::vector<UINT32> beforeClusters = FindClusters(*upBuilder, static_cast<UINT32>(i * 2 + 1));
+        FNTEST_CHECK(beforeClusters == std::vector<UINT32>({ LightCluster::GetClusterIndex(centerX, centerY, slice - 1) }));
+    }
+
+    FNTEST_CHECK(upBuilder->GetStats().VisibleLightNum == lights.size());
+}
+
+FNTEST_CASE(LightCluster, LightOnTileEdgeGoesToBothTiles)
+{
+    const LightCluster::Grid grid = CreateAxisGrid();
+    auto upBuilder = std::make_unique<LightCluster::Builder>();
+
+    // 奥行き1枚の真ん中に置く
+    const UINT32 slice = 12;
+    const float z = std::sqrt(grid.GetSliceZ(slice) * grid.GetSliceZ(slice + 1));
+    const float radius = z * 0.01f;
+
+    // x : 画面の中央の縦の境目 / y : 中央のタイルの上の横の境目
+    const float edgeY = 1.0f / static_cast<float>(LightCluster::TileNumY) * z / grid.mProj._22;
+    const std::vector<Math::Vector4> lights = {
+        { 0.0f, 0.0f, z, radius },
+        { 0.0f, edgeY, z, radius },
+    };
+
+    upBuilder->Build(grid, lights);
+
+    const UINT32 centerX = LightCluster::TileNumX / 2;
+    const UINT32 centerY = LightCluster::TileNumY / 2;
+
+    FNTEST_CHECK(FindClusters(*upBuilder, 0) == std::vector<UINT32>({
+        LightCluster::GetClusterIndex(centerX - 1, centerY, slice),
+        LightCluster::GetClusterIndex(centerX, centerY, slice) }));
+
+    // 角には4つのタイルが接する : y は上から並ぶので、上のタイルの番号が小さい
+    FNTEST_CHECK(FindClusters(*upBuilder, 1) == std::vector<UINT32>({
+        LightCluster::GetClusterIndex(centerX - 1, centerY - 1, slice),
+        LightCluster::GetClusterIndex(centerX, centerY - 1, slice),
+        LightCluster::GetClusterIndex(centerX - 1, centerY, slice),
+        LightCluster::GetClusterIndex(centerX, centerY, slice) }));
+}
+
+FNTEST_CASE(LightCluster, LightBehindNearPlane)
+{
+    const LightCluster::Grid grid = CreateAxisGrid();
+    auto upBuilder = std::make_unique<LightCluster::Builder>();
+
+    const std::vector<Math::Vector4> lights = {
+        { 0.0f, 0.0f, -3.0f, 2.0f },           // 全部カメラの後ろ
+        { 0.0f, 0.0f, TestNear - 1.0f, 0.95f }, // near の少し手前で止まる
+        { 0.0f, 0.0f, -0.5f, 2.0f },            // 中心は後ろだが、near を越えて前に出ている
+        { 0.0f, 0.0f, TestFar + 3.0f, 2.0f },   // far より奥
+        { 0.0f, 0.0f, 5.0f, 0.0f },             // 半径がない
+    };
+
+    upBuilder->Build(grid, lights);
+
+    FNTEST_CHECK(FindClusters(*upBuilder, 0).empty());
+    FNTEST_CHECK(FindClusters(*upBuilder, 1).empty());
+    FNTEST_CHECK(FindClusters(*upBuilder, 3).empty());
+    FNTEST_CHECK(FindClusters(*upBuilder, 4).empty());
+
+    // 前に出ている部分 (z < 1.5) の奥行きにだけ入る : 一番手前の奥行きは画面全体を覆う
+    const std::vector<UINT32> clusters = FindClusters(*upBuilder, 2);
+    FNTEST_REQUIRE(!clusters.empty());
+
+    for (UINT32 y = 0; y < LightCluster::TileNumY; ++y)
+    {
+        for (UINT32 x = 0; x < LightCluster::TileNumX; ++x)
+        {
+            FNTEST_CHECK(HasLight(*upBuilder, LightCluster::GetClusterIndex(x, y, 0), 2));
+        }
+    }
+
+    const UINT32 lastSlice = grid.GetSlice(1.5f);
+    for (const UINT32 cluster : clusters)
+    {
+        FNTEST_CHECK(cluster / (LightCluster::TileNumX * LightCluster::TileNumY) <= lastSlice);
+    }
+    FNTEST_CHECK(HasLight(*upBuilder, LightCluster::GetClusterIndex(LightCluster::TileNumX / 2, LightCluster::TileNumY / 2, lastSlice), 2));
+
+    FNTEST_CHECK(upBuilder->GetStats().LightNum == lights.size());
+    FNTEST_CHECK(upBuilder->GetStats().VisibleLightNum == 1);
+}
+
+/**
+* @brief ライトの球の中の点が入るクラスターには、必ずそのライトが入っている
+* @details シェーダーはピクセルの位置からクラスターを求めるので、ここで抜けるとライトが欠ける
+*/
+FNTEST_CASE(LightCluster, PointsInsideLightFindTheLight)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+
+    const LightCluster::Grid grid = CreateRotatedGrid();
+    const std::vector<Math::Vector4> lights = CreateLights(grid, 200, 3);
+
+    auto upBuilder = std::make_unique<LightCluster::Builder>();
+    upBuilder->Build(grid, lights);
+
+    // 上限を超えて落ちたライトは抜けて当然なので、落ちない数にしておく
+    FNTEST_CHECK(upBuilder->GetStats().OverflowNum == 0);
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> unitDist(-1.0f, 1.0f);
+
+    UINT32 testedNum = 0;
+    UINT32 missedNum = 0;
+    for (UINT32 lightIdx = 0; lightIdx < lights.size(); ++lightIdx)
+    {
+        const Math::Vector4& light = lights[lightIdx];
+
+        for (int sample = 0; sample < 256; ++sample)
+        {
+            // 球の中の点 : 表面の近くも多めに選ぶ
+            Math::Vector3 offset = { unitDist(rng), unitDist(rng), unitDist(rng) };
+            if (offset.LengthSquared() > 1.0f) { continue; }
+            if (sample % 2 == 0) { offset.Normalize(); }
+
+            const Math::Vector3 pos = Math::Vector3(light.x, light.y, light.z) + offset * (light.w * 0.999f);
+
+            UINT32 cluster = 0;
+            if (!FindCluster(grid, pos, cluster)) { continue; }
+
+            ++testedNum;
+            if (!HasLight(*upBuilder, cluster, lightIdx)) { ++missedNum; }
+        }
+    }
+
+    FNTEST_CHECK(testedNum > 10000);
+    FNTEST_CHECK(missedNum == 0);
+}
+
+/**
+* @brief 振り分けが、クラスターの AABB と球の重なりを1つずつ調べた結果と一致する
+* @details AABB は射影行列の逆行列で、クラスターの角の8点を戻して作る
+*/
+FNTEST_CASE(LightCluster, AssignmentMatchesBruteForce)
+{
+    const LightCluster::Grid grid = CreateRotatedGrid();
+    const std::vector<Math::Vector4> lights = CreateLights(grid, 300, 5);
+
+    auto upBuilder = std::make_unique<LightCluster::Builder>();
+    upBuilder->Build(grid, lights);
+
+    std::vector<Math::Vector4> viewLights;
+    for (const Math::Vector4& light : lights)
+    {
+        const Math::Vector3 viewPos = Math::Vector3::Transform(Math::Vector3(light.x, light.y, light.z), grid.mView);
+        viewLights.push_back({ viewPos.x, viewPos.y, viewPos.z, light.w });
+    }
+
+    const Math::Matrix mInvProj = grid.mProj.Invert();
+    const auto unproject = [&](float ndcX, float ndcY, float viewZ)
+        {
+            // ビュー空間の z を深度に直してから、逆行列で戻す
+            const float depth = (viewZ * grid.mProj._33 + grid.mProj._43) / viewZ;
+            const Math::Vector3 ndc = { ndcX, ndcY, depth };
+
+            const float w = ndc.x * mInvProj._14 + ndc.y * mInvProj._24 + ndc.z * mInvProj._34 + mInvProj._44;
+            return Math::Vector3::Transform(ndc, mInvProj) / w;
+        };
+
+    UINT32 mismatchNum = 0;
+    UINT32 pairNum = 0;
+    for (UINT32 slice = 0; slice < LightCluster::SliceNum; ++slice)
+    {
+        for (UINT32 y = 0; y < LightCluster::TileNumY; ++y)
+        {
+            for (UINT32 x = 0; x < LightCluster::TileNumX; ++x)
+            {
+                const float maxFloat = std::numeric_limits<float>::max();
+                Math::Vector3 minPos = { maxFloat, maxFloat, maxFloat };
+                Math::Vector3 maxPos = -minPos;
+                for (UINT32 corner = 0; corner < 8; ++corner)
+                {
+                    const float ndcX = -1.0f + 2.0f * static_cast<float>(x + (corner & 1)) / LightCluster::TileNumX;
+                    const float ndcY = 1.0f - 2.0f * static_cast<float>(y + ((corner >> 1) & 1)) / LightCluster::TileNumY;
+                    const Math::Vector3 pos = unproject(ndcX, ndcY, grid.GetSliceZ(slice + (corner >> 2)));
+
+                    minPos = Math::Vector3::Min(minPos, pos);
+                    maxPos = Math::Vector3::Max(maxPos, pos);
+                }
+
+                const UINT32 cluster = LightCluster::GetClusterIndex(x, y, slice);
+                for (UINT32 lightIdx = 0; lightIdx < viewLights.size(); ++lightIdx)
+                {
+                    const Math::Vector4& light = viewLights[lightIdx];
+                    const Math::Vector3 center = { light.x, light.y, light.z };
+                    const float distanceSq = Math::Vector3::DistanceSquared(center, Math::Vector3::Min(Math::Vector3::Max(center, minPos), maxPos));
+                    const float radiusSq = light.w * light.w;
+
+                    // 境目ちょうどは計算の誤差でどちらにもなりうるので数えない
+                    if (std::abs(distanceSq - radiusSq) <= radiusSq * 1.0e-3f) { continue; }
+
+                    ++pairNum;
+                    if ((distanceSq < radiusSq) != HasLight(*upBuilder, cluster, lightIdx)) { ++mismatchNum; }
+                }
+            }
+        }
+    }
+
+    FNTEST_CHECK(pairNum > 0);
+    FNTEST_CHECK(mismatchNum == 0);
+}
+
+FNTEST_CASE(LightCluster, RangesArePackedInClusterOrder)
+{
+    const LightCluster::Grid grid = CreateRotatedGrid();
+    const std::vector<Math::Vector4> lights = CreateLights(grid, 1000, 7);
+
+    // 並列に振り分けても、1スレッドと同じ結果になる
+    std::array<std::unique_ptr<LightCluster::Builder>, 2> builders;
+    for (size_t i = 0; i < builders.size(); ++i)
+    {
+        fntest::ScopedJobSystem jobSystem(i == 0 ? 1 : 4);
+        builders[i] = std::make_unique<LightCluster::Builder>();
+        builders[i]->Build(grid, lights);
+    }
+
+    const LightCluster::Builder& builder = *builders[1];
+    FNTEST_CHECK(builder.GetLightIndices() == builders[0]->GetLightIndices());
+
+    UINT32 offset = 0;
+    UINT32 usedNum = 0;
+    UINT32 maxCount = 0;
+    for (UINT32 cluster = 0; cluster < LightCluster::ClusterNum; ++cluster)
+    {
+        const LightCluster::Range& range = builder.GetRanges()[cluster];
+        FNTEST_CHECK(range.Offset == offset);
+        FNTEST_CHECK(range.Count == builders[0]->GetRanges()[cluster].Count);
+        FNTEST_CHECK(range.Count <= LightCluster::MaxClusterLightNum);
+
+        offset += range.Count;
+        if (range.Count > 0) { ++usedNum; }
+        maxCount = std::max(maxCount, range.Count);
+    }
+
+    const LightCluster::Stats& stats = builder.GetStats();
+    FNTEST_CHECK(stats.IndexNum == offset);
+    FNTEST_CHECK(stats.IndexNum == builder.GetLightIndices().size());
+    FNTEST_CHECK(stats.UsedClusterNum == usedNum);
+    FNTEST_CHECK(stats.MaxLightPerCluster == maxCount);
+    FNTEST_CHECK(stats.LightNum == lights.size());
+}
+
+FNTEST_CASE(LightCluster, OverflowKeepsFirstLights)
+{
+    const LightCluster::Grid grid = CreateAxisGrid();
+    auto upBuilder = std::make_unique<LightCluster::Builder>();
+
+    // 同じ場所に上限より多く置く : どのクラスターも先に追加された番号だけを持つ
+    constexpr UINT32 LightNum = LightCluster::MaxClusterLightNum + 20;
+    const std::vector<Math::Vector4> lights(LightNum, Math::Vector4(0.3f, 0.2f, 10.0f, 0.5f));
+
+    upBuilder->Build(grid, lights);
+
+    const LightCluster::Stats& stats = upBuilder->GetStats();
+    FNTEST_CHECK(stats.MaxLightPerCluster == LightCluster::MaxClusterLightNum);
+    FNTEST_CHECK(stats.OverflowNum == stats.UsedClusterNum * (LightNum - LightCluster::MaxClusterLightNum));
+    FNTEST_CHECK(stats.VisibleLightNum == LightCluster::MaxClusterLightNum);
+
+    for (UINT32 cluster = 0; cluster < LightCluster::ClusterNum; ++cluster)
+    {
+        const LightCluster::Range& range = upBuilder->GetRanges()[cluster];
+        if (range.Count == 0) { continue; }
+
+        FNTEST_CHECK(range.Count == LightCluster::MaxClusterLightNum);
+        for (UINT32 i = 0; i < range.Count; ++i)
+        {
+            FNTEST_CHECK(upBuilder->GetLightIndices()[range.Offset + i] == i);
+        }
+    }
+}
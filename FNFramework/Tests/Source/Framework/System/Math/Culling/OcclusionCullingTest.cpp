@@ -0,0 +1,356 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    // 原点から +z を見るカメラ : ビュー空間とワールド空間が同じなので、遮蔽物の縁に正確に置ける
+    Math::Matrix CreateViewProj()
+    {
+        constexpr float Aspect = static_cast<float>(OcclusionCulling::Width) / static_cast<float>(OcclusionCulling::Height);
+        return DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(60.0f), Aspect, 0.1f, 100.0f);
+    }
+
+    // 遮蔽物の四角形 : z = QuadZ に置いた x, y が ±QuadHalfX, ±QuadHalfY の板で、画面の中に縁が見える
+    constexpr float QuadZ = 10.0f;
+    constexpr float QuadHalfX = 4.0f;
+    constexpr float QuadHalfY = 2.0f;
+
+    Math::Vector4 ToClip(const Math::Vector3& pos, const Math::Matrix& mViewProj)
+    {
+        return Math::Vector4::Transform(Math::Vector4(pos.x, pos.y, pos.z, 1.0f), mViewProj);
+    }
+
+    /* @brief 四角形の遮蔽物を2枚の三角形にする : halfX を変えると、右の縁がピクセルの中で動く */
+    std::vector<OcclusionCulling::ScreenTriangle> CreateQuad(const Math::Matrix& mViewProj, float halfX = QuadHalfX)
+    {
+        const std::array<Math::Vector4, 4> corners = {
+            ToClip({ -halfX, -QuadHalfY, QuadZ }, mViewProj),
+            ToClip({  halfX, -QuadHalfY, QuadZ }, mViewProj),
+            ToClip({  halfX,  QuadHalfY, QuadZ }, mViewProj),
+            ToClip({ -halfX,  QuadHalfY, QuadZ }, mViewProj),
+        };
+
+        std::vector<OcclusionCulling::ScreenTriangle> triangles(2);
+        FNTEST_REQUIRE(OcclusionCulling::SetupTriangle(corners[0], corners[1], corners[2], triangles[0]));
+        FNTEST_REQUIRE(OcclusionCulling::SetupTriangle(corners[0], corners[2], corners[3], triangles[1]));
+        return triangles;
+    }
+
+    /* @brief CullingSystem と同じく、すべての帯を描いてから帯をまたぐ階層 Z を作る */
+    void Render(OcclusionCulling::DepthBuffer& buffer, const Math::Matrix& mViewProj,
+        std::span<const OcclusionCulling::ScreenTriangle> triangles)
+    {
+        buffer.SetViewProj(mViewProj);
+        for (UINT32 bandIdx = 0; bandIdx < OcclusionCulling::BandNum; ++bandIdx)
+        {
+            buffer.RenderBand(bandIdx, triangles);
+        }
+        buffer.BuildHiZ();
+    }
+
+    /* @brief ボックスの8頂点がすべて四角形の真後ろにあるか : 原点から見て四角形に重なり、四角形より奥にある */
+    bool IsBehindQuad(const Math::Vector3& center, const Math::Vector3& extents, float halfX)
+    {
+        for (UINT32 i = 0; i < 8; ++i)
+        {
+            const float x = center.x + ((i & 1) ? extents.x : -extents.x);
+            const float y = center.y + ((i & 2) ? extents.y : -extents.y);
+            const float z = center.z + ((i & 4) ? extents.z : -extents.z);
+            if (z <= QuadZ) { return false; }
+
+            // 四角形の面まで縮めた位置
+            const float scale = QuadZ / z;
+            if (std::abs(x * scale) > halfX || std::abs(y * scale) > QuadHalfY) { return false; }
+        }
+        return true;
+    }
+
+    /**
+    * @brief ランダムな三角形 : 帯をまたぐ大きさで、一部は画面からはみ出す
+    * @details 描かない三角形 (SetupTriangle が false) も詰めずに残す : CullingSystem と同じ並び
+    */
+    std::vector<OcclusionCulling::ScreenTriangle> CreateRandomTriangles(UINT32 triangleNum, UINT32 seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> ndcDist(-1.3f, 1.3f);
+        std::uniform_real_distribution<float> offsetDist(-0.6f, 0.6f);
+        std::uniform_real_distribution<float> wDist(1.0f, 50.0f);
+
+        std::vector<OcclusionCulling::ScreenTriangle> triangles(triangleNum);
+        for (OcclusionCulling::ScreenTriangle& tri : triangles)
+        {
+            const float baseX = ndcDist(rng);
+            const float baseY = ndcDist(rng);
+
+            std::array<Math::Vector4, 3> clips;
+            for (Math::Vector4& clip : clips)
+            {
+                const float w = wDist(rng);
+                clip = Math::Vector4((baseX + offsetDist(rng)) * w, (baseY + offsetDist(rng)) * w, 0.0f, w);
+            }
+
+            OcclusionCulling::SetupTriangle(clips[0], clips[1], clips[2], tri);
+        }
+        return triangles;
+    }
+
+    /**
+    * @brief 帯に分けずに、画面全体を1ピクセルずつ描いた深度バッファ
+    * @details 辺の式をピクセルの中心で直接求める : 辺の上に近いピクセルは SIMD の加算の誤差で変わり得るので、ambiguous に印を付ける
+    */
+    std::vector<float> RenderReference(std::span<const OcclusionCulling::ScreenTriangle> triangles, std::vector<bool>& ambiguous)
+    {
+        constexpr UINT32 Width = OcclusionCulling::Width;
+        constexpr UINT32 Height = OcclusionCulling::Height;
+
+        std::vector<float> depths(Width * Height, 0.0f);
+        ambiguous.assign(Width * Height, false);
+
+        for (const OcclusionCulling::ScreenTriangle& tri : triangles)
+        {
+            if (!tri.IsValid()) { continue; }
+
+            for (INT32 y = tri.MinY; y <= tri.MaxY; ++y)
+            {
+                for (INT32 x = tri.MinX; x <= tri.MaxX; ++x)
+                {
+                    const double centerX = x + 0.5;
+                    const double centerY = y + 0.5;
+
+                    bool isInside = true;
+                    bool isNearEdge = false;
+                    for (UINT32 i = 0; i < 3; ++i)
+                    {
+                        const double edge = tri.EdgeA[i] * centerX + tri.EdgeB[i] * centerY + tri.EdgeC[i];
+                        const double margin = 1.0e-2 * std::max(std::abs(tri.EdgeA[i]), std::abs(tri.EdgeB[i]));
+
+                        if (edge < -margin) { isInside = false; }
+                        if (std::abs(edge) <= margin) { isNearEdge = true; }
+                    }
+
+                    if (!isInside) { continue; }
+
+                    const UINT32 pixel = y * Width + x;
+                    if (isNearEdge) { ambiguous[pixel] = true; }
+
+                    const double depth = tri.DepthA * centerX + tri.DepthB * centerY + tri.DepthC;
+                    depths[pixel] = std::max(depths[pixel], static_cast<float>(depth));
+                }
+            }
+        }
+
+        return depths;
+    }
+
+    /* @brief 1段縮小する : 縮小先の各ピクセルは、元の 2x2 ピクセルの一番奥 */
+    std::vector<float> DownsampleReference(std::span<const float> src, UINT32 srcWidth, UINT32 srcHeight)
+    {
+        const UINT32 dstWidth = std::max(srcWidth / 2, 1u);
+        const UINT32 dstHeight = std::max(srcHeight / 2, 1u);
+
+        std::vector<float> dst(dstWidth * dstHeight);
+        for (UINT32 y = 0; y < dstHeight; ++y)
+        {
+            for (UINT32 x = 0; x < dstWidth; ++x)
+            {
+                const UINT32 x0 = x * 2, x1 = std::min(x * 2 + 1, srcWidth - 1);
+                const UINT32 y0 = y * 2, y1 = std::min(y * 2 + 1, srcHeight - 1);
+                dst[y * dstWidth + x] = std::min({ src[y0 * srcWidth + x0], src[y0 * srcWidth + x1],
+                    src[y1 * srcWidth + x0], src[y1 * srcWidth + x1] });
+            }
+        }
+        return dst;
+    }
+}
+
+/* @brief 大きな四角形の真後ろにあるボックスは隠れている */
+FNTEST_CASE(OcclusionCulling, QuadHidesBoxBehind)
+{
+    const Math::Matrix mViewProj = CreateViewProj();
+    const std::vector<OcclusionCulling::ScreenTriangle> quad = CreateQuad(mViewProj);
+
+    OcclusionCulling::DepthBuffer buffer;
+    Render(buffer, mViewProj, quad);
+
+    FNTEST_CHECK(buffer.IsOccluded({ 0.0f, 0.0f, 20.0f }, { 1.0f, 1.0f, 1.0f }));
+    FNTEST_CHECK(buffer.IsOccluded({ -3.0f, 1.0f, 30.0f }, { 0.5f, 0.5f, 5.0f }));
+
+    // 遠くの大きなボックス : 階層 Z の粗い段で比べる
+    FNTEST_CHECK(buffer.IsOccluded({ 0.0f, 0.0f, 80.0f }, { 6.0f, 3.0f, 10.0f }));
+
+    // 何も描いていない所にあるボックスは見えている
+    FNTEST_CHECK(!buffer.IsOccluded({ 30.0f, 0.0f, 40.0f }, { 1.0f, 1.0f, 1.0f }));
+}
+
+/**
+* @brief 四角形の手前にあるボックス / 四角形の縁にかかるボックスは、隠れている扱いにならない
+* @details
+*   縁をまたいで細かく動かし、隠れていると判定したボックスがすべて四角形の真後ろにあることを確かめる
+*   遮蔽物はピクセルの中心で描くので、縁がピクセルの中のどこにあってもはみ出したボックスを隠さないように、四角形の幅も少しずつ変える
+*/
+FNTEST_CASE(OcclusionCulling, BoxInFrontOrOnEdgeIsNeverOccluded)
+{
+    const Math::Matrix mViewProj = CreateViewProj();
+    const std::vector<OcclusionCulling::ScreenTriangle> quad = CreateQuad(mViewProj);
+
+    OcclusionCulling::DepthBuffer buffer;
+    Render(buffer, mViewProj, quad);
+
+    // 手前 / 四角形を貫く
+    FNTEST_CHECK(!buffer.IsOccluded({ 0.0f, 0.0f, 5.0f }, { 1.0f, 1.0f, 1.0f }));
+    FNTEST_CHECK(!buffer.IsOccluded({ 0.0f, 0.0f, QuadZ }, { 0.5f, 0.5f, 0.5f }));
+
+    // 四角形の右の縁 / 上の縁にかかる : 奥の z = 20 では縁が2倍の位置に見える
+    FNTEST_CHECK(!buffer.IsOccluded({ QuadHalfX * 2.0f, 0.0f, 20.0f }, { 1.0f, 1.0f, 1.0f }));
+    FNTEST_CHECK(!buffer.IsOccluded({ 0.0f, QuadHalfY * 2.0f, 20.0f }, { 1.0f, 1.0f, 1.0f }));
+
+    // 縁をまたいで、ピクセルより細かい間隔で動かす : z = QuadZ で1ピクセルは 0.09 ほど
+    constexpr float Depth = 20.0f;
+    constexpr float Step = 0.005f;
+
+    UINT32 occludedNum = 0;
+    UINT32 wrongNum = 0;
+    for (UINT32 offset = 0; offset < 10; ++offset)
+    {
+        const float halfX = QuadHalfX + static_cast<float>(offset) * 0.01f;
+        Render(buffer, mViewProj, CreateQuad(mViewProj, halfX));
+
+        for (const float extent : { 0.05f, 0.3f })
+        {
+            const Math::Vector3 extents = { extent, extent, extent };
+
+            for (float x = halfX * 2.0f - 1.0f; x < halfX * 2.0f + 1.0f; x += Step)
+            {
+                for (const float y : { 0.0f, QuadHalfY * 2.0f - 0.5f, QuadHalfY * 2.0f - 0.3f, QuadHalfY * 2.0f })
+                {
+                    const Math::Vector3 center = { x, y, Depth };
+                    if (!buffer.IsOccluded(center, extents)) { continue; }
+
+                    ++occludedNum;
+                    if (!IsBehindQuad(center, extents, halfX)) { ++wrongNum; }
+                }
+            }
+        }
+    }
+
+    FNTEST_CHECK(occludedNum > 0);
+    FNTEST_CHECK(wrongNum == 0);
+}
+
+/**
+* @brief 手前のクリップ面をまたぐボックスは、隠れている扱いにならない
+* @details
+*   カメラの後ろから四角形の奥まで伸びる細いボックス : 後ろの頂点を射影すると画面の中心付近に来るので、
+*   clip.w <= NearW で打ち切らなければ、奥の頂点の深度で隠れていると判定してしまう
+*/
+FNTEST_CASE(OcclusionCulling, BoxCrossingNearPlaneIsNeverOccluded)
+{
+    const Math::Matrix mViewProj = CreateViewProj();
+    const std::vector<OcclusionCulling::ScreenTriangle> quad = CreateQuad(mViewProj);
+
+    OcclusionCulling::DepthBuffer buffer;
+    Render(buffer, mViewProj, quad);
+
+    // 同じ幅で奥だけにあるボックスは隠れている
+    FNTEST_CHECK(buffer.IsOccluded({ 0.0f, 0.0f, 25.0f }, { 0.2f, 0.2f, 5.0f }));
+
+    // カメラの後ろ z = -1 から z = 30 まで
+    FNTEST_CHECK(!buffer.IsOccluded({ 0.0f, 0.0f, 14.5f }, { 0.2f, 0.2f, 15.5f }));
+
+    // 手前の頂点の w が NearW 以下になる
+    FNTEST_CHECK(!buffer.IsOccluded({ 0.0f, 0.0f, 15.0f }, { 0.2f, 0.2f, 15.0f }));
+
+    // カメラを囲む
+    FNTEST_CHECK(!buffer.IsOccluded({ 0.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f }));
+}
+
+/**
+* @brief 帯ごとに描いた深度バッファと階層 Z が、画面全体を一度に描いた結果と一致する
+* @details
+*   - 帯の順番やスレッドを変えても、同じ深度バッファになる
+*   - 帯の中で作った段も、帯をまたいで作った段も、画面全体を縮小した結果と同じになる
+*/
+FNTEST_CASE(OcclusionCulling, BandedRenderMatchesSingleBand)
+{
+    const Math::Matrix mViewProj = CreateViewProj();
+    const std::vector<OcclusionCulling::ScreenTriangle> triangles = CreateRandomTriangles(300, 11);
+
+    // 帯を上から順に描く
+    OcclusionCulling::DepthBuffer buffer;
+    Render(buffer, mViewProj, triangles);
+
+    //--------------------------------
+    // 画面全体を1ピクセルずつ描いた結果と比べる
+    //--------------------------------
+    std::vector<bool> ambiguous;
+    const std::vector<float> reference = RenderReference(triangles, ambiguous);
+    const std::span<const float> depths = buffer.GetMip(0);
+
+    UINT32 coveredNum = 0;
+    UINT32 mismatchNum = 0;
+    for (size_t pixel = 0; pixel < reference.size(); ++pixel)
+    {
+        if (ambiguous[pixel]) { continue; }
+
+        if (reference[pixel] > 0.0f) { ++coveredNum; }
+        if (std::abs(depths[pixel] - reference[pixel]) > 1.0e-4f * std::max(reference[pixel], 1.0f)) { ++mismatchNum; }
+    }
+
+    FNTEST_CHECK(coveredNum > reference.size() / 2);
+    FNTEST_CHECK(mismatchNum == 0);
+
+    // 縮小は誤差なく一致する
+    std::vector<float> mip(depths.begin(), depths.end());
+    for (UINT32 level = 1; level < OcclusionCulling::MipNum; ++level)
+    {
+        mip = DownsampleReference(mip, buffer.GetMipWidth(level - 1), buffer.GetMipHeight(level - 1));
+
+        const std::span<const float> hiZ = buffer.GetMip(level);
+        FNTEST_REQUIRE(hiZ.size() == mip.size());
+        FNTEST_CHECK(std::equal(hiZ.begin(), hiZ.end(), mip.begin()));
+    }
+
+    //--------------------------------
+    // 帯を逆の順番 / 複数のスレッドで描いても変わらない
+    //--------------------------------
+    const auto isSameBuffer = [&buffer](const OcclusionCulling::DepthBuffer& other)
+        {
+            for (UINT32 level = 0; level < OcclusionCulling::MipNum; ++level)
+            {
+                const std::span<const float> a = buffer.GetMip(level);
+                const std::span<const float> b = other.GetMip(level);
+                if (!std::equal(a.begin(), a.end(), b.begin(), b.end())) { return false; }
+            }
+            return true;
+        };
+
+    {
+        OcclusionCulling::DepthBuffer reversed;
+        for (UINT32 bandIdx = OcclusionCulling::BandNum; bandIdx-- > 0;)
+        {
+            reversed.RenderBand(bandIdx, triangles);
+        }
+        reversed.BuildHiZ();
+
+        FNTEST_CHECK(isSameBuffer(reversed));
+    }
+
+    {
+        fntest::ScopedJobSystem jobSystem(4);
+
+        // 前のフレームの深度が残っていても、帯ごとに消してから描く
+        OcclusionCulling::DepthBuffer parallel;
+        Render(parallel, mViewProj, CreateRandomTriangles(300, 12));
+
+        JobSystem::Instance().ParallelFor(OcclusionCulling::BandNum, 1,
+            [&parallel, &triangles](UINT32 begin, UINT32 end)
+            {
+                for (UINT32 bandIdx = begin; bandIdx < end; ++bandIdx)
+                {
+                    parallel.RenderBand(bandIdx, triangles);
+                }
+            });
+        parallel.BuildHiZ();
+
+        FNTEST_CHECK(isSameBuffer(parallel));
+    }
+}
@@ -0,0 +1,146 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    // メインスレッドが1フレームで確保する量 : 既定のページに収まらず、最初のフレームでページが増える
+    constexpr size_t MainChunkSize = 64 * 1024;
+    constexpr int MainChunkNum = 48;
+
+    // ジョブの数と、1ジョブで確保する量
+    // 1つのスレッドがすべてのジョブを実行しても既定のページに収まる量にしておく
+    constexpr UINT32 JobNum = 32;
+    constexpr size_t JobBlockSize = 256;
+    constexpr int JobElementNum = 1000;
+
+    // ワーカースレッドにもジョブが行き渡るように、1ジョブで行う計算の回数
+    constexpr int JobSpinNum = 200;
+
+    /* @brief 1フレームの処理の結果 */
+    struct FrameResult
+    {
+        // 他のスレッドの確保と重なって書き換えられたブロックの数
+        int BrokenBlockNum = 0;
+
+        // ジョブを実行したスレッドの番号のビット
+        UINT64 ThreadMask = 0;
+    };
+
+    /**
+    * @brief 1フレーム分の確保を行う : Reset はフレームのはじめに呼び出し側で行う
+    * @details
+    *   - メインスレッドは大きなブロックを続けて確保する
+    *   - 各ジョブは FrameVector を伸ばしながら要素を追加し、ブロックに自身の番号を書き込む
+    *   - 全ジョブの終了後に、ブロックが他の確保で上書きされていないかを確かめる
+    */
+    FrameResult RunFrame(FrameAllocator& allocator, JobSystem& jobs)
+    {
+        FrameResult result;
+
+        for (int i = 0; i < MainChunkNum; ++i)
+        {
+            auto* pChunk = static_cast<std::byte*>(allocator.Allocate(MainChunkSize));
+            pChunk[0] = std::byte{ 1 };
+            pChunk[MainChunkSize - 1] = std::byte{ 1 };
+        }
+
+        std::array<UINT32*, JobNum> blocks = {};
+        std::atomic<UINT64> threadMask = 0;
+        JobCounter counter;
+
+        for (UINT32 job = 0; job < JobNum; ++job)
+        {
+            jobs.Run([&, job]()
+                {
+                    threadMask.fetch_or(1ull << (JobSystem::GetThreadIndex() % 64), std::memory_order_relaxed);
+
+                    utl::FrameVector<int> values;
+                    for (int i = 0; i < JobElementNum; ++i)
+                    {
+                        values.push_back(i);
+                    }
+
+                    // 確保とは関係のない計算 : メインスレッドだけですべて実行されないように時間をかける
+                    int sum = 0;
+                    for (int spin = 0; spin < JobSpinNum; ++spin)
+                    {
+                        for (const int value : values) { sum += value; }
+                    }
+                    fntest::DoNotOptimize(sum);
+
+                    auto* pBlock = static_cast<UINT32*>(allocator.Allocate(JobBlockSize, 64));
+                    std::fill_n(pBlock, JobBlockSize / sizeof(UINT32), job);
+                    blocks[job] = pBlock;
+                }, &counter);
+        }
+
+        jobs.Wait(counter);
+
+        for (UINT32 job = 0; job < JobNum; ++job)
+        {
+            const UINT32* pBlock = blocks[job];
+            if (!std::all_of(pBlock, pBlock + JobBlockSize / sizeof(UINT32), [job](UINT32 v) { return v == job; }))
+            {
+                ++result.BrokenBlockNum;
+            }
+        }
+
+        result.ThreadMask = threadMask.load();
+        return result;
+    }
+}
+
+/**
+* @brief 複数のスレッドから確保を続けても、使用量が落ち着いた後はヒープから確保しない
+* @details
+*   最初のフレームはメインスレッドのページが足りずにページを追加するが、次の Reset で1枚にまとめ直される
+*   ジョブの振り分けはフレームごとに変わっても、各スレッドの使用量は最初のページに収まる
+*/
+FNTEST_CASE(FrameAllocator, NoHeapAllocationAfterWarmUp)
+{
+    fntest::ScopedJobSystem jobSystem(4);
+    JobSystem& jobs = JobSystem::Instance();
+
+    FrameAllocator& allocator = FrameAllocator::Instance();
+    allocator.Init();
+
+    constexpr int WarmUpFrameNum = 2;
+    constexpr int FrameNum = 16;
+
+    UINT64 threadMask = 0;
+
+    for (int frame = 0; frame <= FrameNum; ++frame)
+    {
+        // Application::PreUpdate と同じくフレームのはじめに巻き戻す : 前のフレームの統計はここで確定する
+        allocator.Reset();
+
+        const int lastFrame = frame - 1;
+
+        // 最初のフレームはメインスレッドのページが足りずに追加している
+        if (lastFrame == 0)
+        {
+            FNTEST_CHECK(allocator.GetLastFrameHeapAllocateNum() > 0);
+        }
+
+        if (lastFrame >= WarmUpFrameNum)
+        {
+            FNTEST_CHECK(allocator.GetLastFrameHeapAllocateNum() == 0);
+            FNTEST_CHECK(allocator.GetLastFrameAllocateNum() >= MainChunkNum + JobNum * 2);
+            FNTEST_CHECK(allocator.GetLastFrameUsedSize() >= MainChunkSize * MainChunkNum);
+        }
+
+        if (frame == FrameNum) { break; }
+
+        const FrameResult result = RunFrame(allocator, jobs);
+        threadMask |= result.ThreadMask;
+
+        FNTEST_CHECK(result.BrokenBlockNum == 0);
+    }
+
+    // ワーカースレッドの領域からも確保されている
+    FNTEST_CHECK(std::popcount(threadMask) > 1);
+
+    fntest::ReportBench("job threads", static_cast<double>(std::popcount(threadMask)), "threads");
+    fntest::ReportBench("reserved", static_cast<double>(allocator.GetReservedSize()) / (1024.0 * 1024.0), "MB");
+
+    allocator.Release();
+}
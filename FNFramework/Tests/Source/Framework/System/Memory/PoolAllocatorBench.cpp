@@ -0,0 +1,351 @@
+﻿#include "TestFramework/Test.h"
+
+namespace
+{
+    /* @brief 計測用の確保対象 : オブジェクトとコンポーネントに近い大きさのデータを持つ */
+    template <size_t Size>
+    struct BenchPayload
+    {
+        float Value = 1.0f;
+        std::byte Padding[Size - sizeof(float)] = {};
+    };
+
+    using SmallPayload = BenchPayload<sizeof(TransformComponent)>;
+    using LargePayload = BenchPayload<sizeof(GameObject)>;
+
+    // 計測で使うプールの番号
+    constexpr UINT32 SmallPoolIndex = 0;
+    constexpr UINT32 LargePoolIndex = 1;
+
+    /* @brief 確保の方法 : 以前の make_shared と、PoolArena からの allocate_shared */
+    struct HeapFactory
+    {
+        template <typename T>
+        std::shared_ptr<T> Create(UINT32) { return std::make_shared<T>(); }
+    };
+
+    struct PoolFactory
+    {
+        template <typename T>
+        std::shared_ptr<T> Create(UINT32 poolIndex)
+        {
+            return std::allocate_shared<T>(utl::PoolAllocator<T>(spArena, poolIndex));
+        }
+
+        std::shared_ptr<utl::PoolArena> spArena = std::make_shared<utl::PoolArena>();
+    };
+
+    /* @brief 生成と破棄を繰り返した後の生存オブジェクト */
+    struct ChurnResult
+    {
+        std::vector<std::shared_ptr<SmallPayload>> Smalls;
+        std::vector<std::shared_ptr<LargePayload>> Larges;
+    };
+
+    /**
+    * @brief 2種類の大きさのオブジェクトを交互に生成し、ランダムに半分を破棄して作り直すことを繰り返す
+    * @param[in] objectNum - 種類ごとの生存数
+    * @param[in] roundNum  - 破棄と生成を繰り返す回数
+    */
+    template <typename Factory>
+    ChurnResult Churn(Factory& factory, size_t objectNum, int roundNum)
+    {
+        ChurnResult result;
+        result.Smalls.reserve(objectNum);
+        result.Larges.reserve(objectNum);
+
+        std::mt19937 rng(1234);
+
+        for (int round = 0; round <= roundNum; ++round)
+        {
+            if (round > 0)
+            {
+                // 順番を崩して半分を破棄する
+                std::shuffle(result.Smalls.begin(), result.Smalls.end(), rng);
+                std::shuffle(result.Larges.begin(), result.Larges.end(), rng);
+                result.Smalls.resize(objectNum / 2);
+                result.Larges.resize(objectNum / 2);
+            }
+
+            while (result.Smalls.size() < objectNum)
+            {
+                result.Smalls.push_back(factory.template Create<SmallPayload>(SmallPoolIndex));
+                result.Larges.push_back(factory.template Create<LargePayload>(LargePoolIndex));
+            }
+        }
+        return result;
+    }
+
+    /**
+    * @brief 同じ型のオブジェクトがどれだけ散らばっているか
+    * @return 生存しているオブジェクトが乗っている 4KB ページの合計 / 詰めて並べたときの大きさ
+    *         1 に近いほど密に並んでいて、他の型や解放済みの領域と混ざるほど大きくなる
+    */
+    template <typename T>
+    double MeasureSpread(const std::vector<std::shared_ptr<T>>& objects)
+    {
+        constexpr uintptr_t PageSize = 4096;
+
+        std::unordered_set<uintptr_t> pages;
+        for (const auto& sp : objects)
+        {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(sp.get());
+            pages.insert(address / PageSize);
+            pages.insert((address + sizeof(T) - 1) / PageSize);
+        }
+
+        const double packedSize = static_cast<double>(objects.size() * sizeof(T));
+        return static_cast<double>(pages.size() * PageSize) / packedSize;
+    }
+}
+
+FNTEST_CASE(PoolAllocator, FixedBlockPoolReusesBlocks)
+{
+    utl::FixedBlockPool pool(24, 16, 4);
+
+    // ブロックの大きさはアライメントの倍数に切り上げられる
+    FNTEST_CHECK(pool.GetBlockSize() == 32);
+
+    std::array<void*, 5> blocks = {};
+    for (void*& p : blocks)
+    {
+        p = pool.Allocate();
+        FNTEST_CHECK(reinterpret_cast<uintptr_t>(p) % 16 == 0);
+    }
+
+    // 4 個を超えたので 2 つ目のチャンクが確保される
+    FNTEST_CHECK(pool.GetChunkNum() == 2);
+    FNTEST_CHECK(pool.GetUsedBlockNum() == 5);
+    FNTEST_CHECK(pool.GetCapacityBlockNum() == 8);
+
+    // 解放したブロックが次の確保で再利用され、チャンクは増えない
+    pool.Deallocate(blocks[2]);
+    FNTEST_CHECK(pool.Allocate() == blocks[2]);
+    FNTEST_CHECK(pool.GetChunkNum() == 2);
+
+    for (void* p : blocks) { pool.Deallocate(p); }
+    FNTEST_CHECK(pool.GetUsedBlockNum() == 0);
+}
+
+FNTEST_CASE(PoolAllocator, ArenaKeepsReservedSizeAfterChurn)
+{
+    constexpr size_t ObjectNum = 1000;
+
+    PoolFactory factory;
+    {
+        ChurnResult result = Churn(factory, ObjectNum, 8);
+
+        // 破棄された分は再利用されるので、チャンクは生存数の分しか確保されない
+        const size_t chunkNum = (ObjectNum + utl::PoolArena::BlocksPerChunk - 1) / utl::PoolArena::BlocksPerChunk;
+        FNTEST_CHECK(factory.spArena->GetChunkNum() <= chunkNum * 2 + 2);
+        FNTEST_CHECK(factory.spArena->GetUsedSize() >= ObjectNum * (sizeof(SmallPayload) + sizeof(LargePayload)));
+        FNTEST_CHECK(factory.spArena->GetUsedSize() <= factory.spArena->GetReservedSize());
+    }
+
+    // すべて破棄すると使用中のサイズは 0 に戻る
+    FNTEST_CHECK(factory.spArena->GetUsedSize() == 0);
+}
+
+/**
+* @brief 複数のスレッドから確保し、別のスレッドから解放しても、ブロックが重ならず使用量が 0 に戻る
+* @details
+*   ワーカースレッドは自身の空きリストから確保し、解放されたブロックは解放したスレッドの空きリストに入る
+*   半分はメインスレッドで、残りは確保したものと別のジョブで解放する
+*/
+FNTEST_CASE(PoolAllocator, ArenaSharedAcrossThreads)
+{
+    constexpr UINT32 ThreadNum = 4;
+    constexpr size_t ObjectNumPerJob = 5000;
+
+    fntest::ScopedJobSystem jobSystem(ThreadNum);
+    JobSystem& jobs = JobSystem::Instance();
+
+    // JobSystem の初期化後に作成して、スレッドごとの空きリストを使わせる
+    PoolFactory factory;
+
+    std::array<std::vector<std::shared_ptr<SmallPayload>>, ThreadNum> objects;
+
+    for (int round = 0; round < 4; ++round)
+    {
+        jobs.ParallelFor(ThreadNum, 1, [&](UINT32 begin, UINT32 end)
+            {
+                for (UINT32 i = begin; i < end; ++i)
+                {
+                    for (size_t n = 0; n < ObjectNumPerJob; ++n)
+                    {
+                        auto sp = factory.Create<SmallPayload>(SmallPoolIndex);
+                        sp->Value = static_cast<float>(i);
+                        objects[i].push_back(std::move(sp));
+                    }
+                }
+            });
+
+        // 生存しているオブジェクトのアドレスは重ならず、値も書き換えられていない
+        std::unordered_set<const void*> addresses;
+        int brokenNum = 0;
+        for (UINT32 i = 0; i < ThreadNum; ++i)
+        {
+            for (const auto& sp : objects[i])
+            {
+                addresses.insert(sp.get());
+                if (sp->Value != static_cast<float>(i)) { ++brokenNum; }
+            }
+        }
+        FNTEST_CHECK(addresses.size() == ThreadNum * ObjectNumPerJob);
+        FNTEST_CHECK(brokenNum == 0);
+
+        // 半分はメインスレッドで破棄する
+        for (auto& list : objects)
+        {
+            list.resize(ObjectNumPerJob / 2);
+        }
+
+        // 後半は隣のジョブが確保したものを破棄する
+        jobs.ParallelFor(ThreadNum, 1, [&](UINT32 begin, UINT32 end)
+            {
+                for (UINT32 i = begin; i < end; ++i)
+                {
+                    objects[(i + 1) % ThreadNum].clear();
+                }
+            });
+    }
+
+    FNTEST_CHECK(factory.spArena->GetUsedSize() == 0);
+
+    // 空きリストに残る分を除けば、チャンクは1ラウンドの生存数の分しか確保されない
+    const size_t chunkNum = (ThreadNum * ObjectNumPerJob) / utl::PoolArena::BlocksPerChunk;
+    FNTEST_CHECK(factory.spArena->GetChunkNum() <= chunkNum * 2);
+}
+
+/**
+* @brief オブジェクトの生成のスループット
+* @details
+*   GameObject と TransformComponent と同じ大きさのオブジェクトを交互に生成して破棄する
+*   - heap : 以前の make_shared
+*   - pool : PoolArena からの allocate_shared
+*/
+FNTEST_BENCH(PoolAllocator, CreationThroughput)
+{
+    const size_t objectNum = fntest::IsQuick() ? 10000 : 100000;
+    const int repeat = fntest::IsQuick() ? 2 : 10;
+
+    const auto measure = [&](auto& factory)
+        {
+            return fntest::MeasureMinMs(repeat, [&]()
+                {
+                    // 1回目で確保したチャンクを、2回目以降は使い回す
+                    ChurnResult result = Churn(factory, objectNum, 0);
+                    fntest::DoNotOptimize(result.Smalls.back()->Value);
+                });
+        };
+
+    HeapFactory heap;
+    PoolFactory pool;
+
+    const double heapMs = measure(heap);
+    const double poolMs = measure(pool);
+
+    // 1回の計測で生成するのは種類ごとに objectNum 個
+    const double createNum = objectNum * 2.0;
+
+    fntest::ReportBench("heap (make_shared)", createNum / (heapMs / 1000.0), "objects/sec");
+    fntest::ReportBench("pool (allocate_shared)", createNum / (poolMs / 1000.0), "objects/sec");
+    fntest::ReportBench("speedup", heapMs / poolMs, "x");
+}
+
+/**
+* @brief 複数のスレッドから同じ PoolArena に生成と破棄を行った時のスループット
+* @details
+*   PoolArena はスレッドごとの空きリストから確保するので、ロックを取るのはプールとまとめて受け渡す時だけになる
+*   スレッド数ごとに、各スレッドが objectNum / スレッド数 個ずつ生成して破棄する時間を計測する
+*   - heap : make_shared : スレッドごとのキャッシュを持つヒープの参考値
+*   - pool : 1つの PoolArena からの allocate_shared : スレッドが増えても heap と同じように伸びることを確かめる
+*/
+FNTEST_BENCH(PoolAllocator, MultiThreadCreationThroughput)
+{
+    const size_t objectNum = fntest::IsQuick() ? 20000 : 200000;
+    const int repeat = fntest::IsQuick() ? 2 : 10;
+
+    for (const UINT32 threadNum : { 1u, 2u, 4u, 8u })
+    {
+        fntest::ScopedJobSystem jobSystem(threadNum);
+        JobSystem& jobs = JobSystem::Instance();
+
+        const size_t objectNumPerThread = objectNum / threadNum;
+
+        const auto measure = [&](auto& factory)
+            {
+                return fntest::MeasureMinMs(repeat, [&]()
+                    {
+                        // 1スレッドに1つずつ割り当てる
+                        jobs.ParallelFor(threadNum, 1, [&](UINT32 begin, UINT32 end)
+                            {
+                                for (UINT32 i = begin; i < end; ++i)
+                                {
+                                    ChurnResult result = Churn(factory, objectNumPerThread, 0);
+                                    fntest::DoNotOptimize(result.Smalls.back()->Value);
+                                }
+                            });
+                    });
+            };
+
+        HeapFactory heap;
+        PoolFactory pool;
+
+        const double heapMs = measure(heap);
+        const double poolMs = measure(pool);
+
+        const double createNum = objectNumPerThread * threadNum * 2.0;
+
+        const std::string prefix = std::to_string(threadNum) + " threads";
+        fntest::ReportBench(prefix + " / heap (make_shared)", createNum / (heapMs / 1000.0), "objects/sec");
+        fntest::ReportBench(prefix + " / pool (allocate_shared)", createNum / (poolMs / 1000.0), "objects/sec");
+        fntest::ReportBench(prefix + " / speedup", heapMs / poolMs, "x");
+    }
+}
+
+/**
+* @brief 生成と破棄を繰り返した後の断片化
+* @details
+*   2種類の大きさのオブジェクトを交互に生成し、半分をランダムに破棄して作り直すことを繰り返した後に
+*   - spread    : 同じ型のオブジェクトが乗っているページの合計 / 詰めて並べたときの大きさ
+*   - iterate   : 生存しているオブジェクトを1周して値を読む時間
+*   - reserved  : プールが確保しているメモリ / 使用中のメモリ (pool のみ)
+*/
+FNTEST_BENCH(PoolAllocator, Fragmentation)
+{
+    const size_t objectNum = fntest::IsQuick() ? 10000 : 100000;
+    const int roundNum = fntest::IsQuick() ? 4 : 16;
+    const int repeat = fntest::IsQuick() ? 3 : 20;
+
+    const auto report = [&](const std::string& prefix, const ChurnResult& result)
+        {
+            const double iterateMs = fntest::MeasureMinMs(repeat, [&]()
+                {
+                    float sum = 0.0f;
+                    for (const auto& sp : result.Smalls) { sum += sp->Value; }
+                    for (const auto& sp : result.Larges) { sum += sp->Value; }
+                    fntest::DoNotOptimize(sum);
+                });
+
+            fntest::ReportBench(prefix + " / small spread", MeasureSpread(result.Smalls), "x");
+            fntest::ReportBench(prefix + " / large spread", MeasureSpread(result.Larges), "x");
+            fntest::ReportBench(prefix + " / iterate", iterateMs * 1.0e6 / (objectNum * 2.0), "ns/object");
+        };
+
+    {
+        HeapFactory heap;
+        const ChurnResult result = Churn(heap, objectNum, roundNum);
+        report("heap", result);
+    }
+
+    {
+        PoolFactory pool;
+        const ChurnResult result = Churn(pool, objectNum, roundNum);
+        report("pool", result);
+
+        const utl::PoolArena& arena = *pool.spArena;
+        fntest::ReportBench("pool / reserved / used", static_cast<double>(arena.GetReservedSize()) / arena.GetUsedSize(), "x");
+        fntest::ReportBench("pool / chunks", static_cast<double>(arena.GetChunkNum()), "");
+    }
+}
@@ -0,0 +1,46 @@
+﻿#include "Test.h"
+
+namespace fntest
+{
+    namespace
+    {
+        // 実行中のテストの失敗数
+        int s_failureNum = 0;
+
+        bool s_isQuick = false;
+    }
+
+    std::vector<TestCase>& GetTestCases()
+    {
+        static std::vector<TestCase> s_testCases;
+        return s_testCases;
+    }
+
+    void ReportFailure(const char* expr, const char* file, int line)
+    {
+        ++s_failureNum;
+        std::printf("    FAILED : %s\n      at %s(%d)\n", expr, file, line);
+    }
+
+    void ReportBench(const std::string& label, double value, const char* unit)
+    {
+        std::printf("    %-48s : %14.3f %s\n", label.c_str(), value, unit);
+    }
+
+    bool IsQuick()
+    {
+        return s_isQuick;
+    }
+
+    void SetQuick(bool isQuick)
+    {
+        s_isQuick = isQuick;
+    }
+
+    int TakeFailureNum()
+    {
+        const int num = s_failureNum;
+        s_failureNum = 0;
+        return num;
+    }
+}
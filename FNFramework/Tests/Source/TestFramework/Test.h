@@ -0,0 +1,147 @@
+﻿#pragma once
+
+//============================================
+// テスト / ベンチマーク用の最小限のフレームワーク
+// - FNTEST_CASE  : 常に実行する単体テスト
+// - FNTEST_BENCH : --bench を指定した時だけ実行する計測
+//============================================
+
+namespace fntest
+{
+    using TestFunc = void(*)();
+
+    /* @brief 登録されたテスト1件 */
+    struct TestCase
+    {
+        const char* Suite = nullptr;
+        const char* Name = nullptr;
+        TestFunc Func = nullptr;
+        bool IsBench = false;
+    };
+
+    /* @brief 登録されているテストの一覧 : 静的初期化の順番に依存しないよう関数内の static で持つ */
+    std::vector<TestCase>& GetTestCases();
+
+    /* @brief 静的変数の初期化でテストを登録する */
+    struct Registrar
+    {
+        Registrar(const char* suite, const char* name, TestFunc func, bool isBench)
+        {
+            GetTestCases().push_back({ suite, name, func, isBench });
+        }
+    };
+
+    /* @brief FNTEST_REQUIRE が失敗した時に投げて、そのテストだけを中断する */
+    struct RequireFailure {};
+
+    /* @brief 失敗の記録 : 実行中のテストを失敗扱いにしてメッセージを出力する */
+    void ReportFailure(const char* expr, const char* file, int line);
+
+    /* @brief ベンチマーク結果の出力 : 「名前 : 値 単位」の形式で揃えて表示する */
+    void ReportBench(const std::string& label, double value, const char* unit);
+
+    /* @brief 実行ファイルに --quick が指定されているか : 計測の回数を減らして動作確認だけ行う */
+    bool IsQuick();
+    void SetQuick(bool isQuick);
+
+    /* @brief 実行中のテストの失敗数を取得して 0 に戻す : ランナーがテストごとに呼び出す */
+    int TakeFailureNum();
+
+    /**
+    * @class Timer
+    * @brief 経過時間の計測
+    */
+    class Timer
+    {
+    public:
+        Timer() : m_begin(std::chrono::steady_clock::now()) {}
+
+        void Reset() { m_begin = std::chrono::steady_clock::now(); }
+
+        double ElapsedSec() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_begin).count();
+        }
+
+        double ElapsedMs() const { return ElapsedSec() * 1000.0; }
+
+    private:
+        std::chrono::steady_clock::time_point m_begin;
+    };
+
+    /**
+    * @class ScopedJobSystem
+    * @brief テストの間だけ JobSystem を起動する
+    */
+    class ScopedJobSystem
+    {
+    public:
+        /* @param[in] threadNum - メインスレッドを含めたスレッド数 : 0 の場合はハードウェアのスレッド数 */
+        explicit ScopedJobSystem(UINT32 threadNum = 0) { JobSystem::Instance().Init(threadNum); }
+        ~ScopedJobSystem() { JobSystem::Instance().Release(); }
+
+        ScopedJobSystem(const ScopedJobSystem&) = delete;
+        ScopedJobSystem& operator=(const ScopedJobSystem&) = delete;
+    };
+
+    // DoNotOptimize の書き込み先
+    inline const volatile void* g_pSink = nullptr;
+
+    /* @brief 計測対象の結果が最適化で消されないようにする */
+    template <typename T>
+    void DoNotOptimize(const T& value)
+    {
+        g_pSink = &value;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+
+    /**
+    * @brief 処理を繰り返して、1回あたりの最短時間を返す
+    * @param[in] repeat - 計測の回数 : 最初の1回はウォームアップとして捨てる
+    * @param[in] func   - 計測する処理
+    * @return 1回あたりの最短時間 (ms)
+    */
+    template <typename Func>
+    double MeasureMinMs(int repeat, Func&& func)
+    {
+        func();
+
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < repeat; ++i)
+        {
+            Timer timer;
+            func();
+            best = std::min(best, timer.ElapsedMs());
+        }
+        return best;
+    }
+}
+
+#define FNTEST_CONCAT_IMPL(a, b) a##b
+#define FNTEST_CONCAT(a, b) FNTEST_CONCAT_IMPL(a, b)
+
+#define FNTEST_REGISTER(suite, name, isBench)                                          \
+    static void FNTEST_CONCAT(suite, FNTEST_CONCAT(_, name))();                         \
+    static ::fntest::Registrar FNTEST_CONCAT(s_registrar_, FNTEST_CONCAT(suite, FNTEST_CONCAT(_, name)))( \
+        #suite, #name, &FNTEST_CONCAT(suite, FNTEST_CONCAT(_, name)), isBench);         \
+    static void FNTEST_CONCAT(suite, FNTEST_CONCAT(_, name))()
+
+#define FNTEST_CASE(suite, name) FNTEST_REGISTER(suite, name, false)
+#define FNTEST_BENCH(suite, name) FNTEST_REGISTER(suite, name, true)
+
+// 失敗してもテストを続ける
+#define FNTEST_CHECK(expr) \
+    do { if (!(expr)) { ::fntest::ReportFailure(#expr, __FILE__, __LINE__); } } while (false)
+
+#define FNTEST_CHECK_NEAR(a, b, eps) \
+    do { if (!(std::abs(static_cast<double>(a) - static_cast<double>(b)) <= static_cast<double>(eps))) { \
+        ::fntest::ReportFailure(#a " ~= " #b, __FILE__, __LINE__); } } while (false)
+
+#define FNTEST_CHECK_VECTOR3_NEAR(a, b, eps) \
+    do { const Math::Vector3 fntestA = (a); const Math::Vector3 fntestB = (b); \
+        if (!(std::abs(fntestA.x - fntestB.x) <= (eps) && std::abs(fntestA.y - fntestB.y) <= (eps) && std::abs(fntestA.z - fntestB.z) <= (eps))) { \
+        ::fntest::ReportFailure(#a " ~= " #b, __FILE__, __LINE__); } } while (false)
+
+// 失敗したらそのテストを中断する : 以降の処理が前提を満たさない場合に使う
+#define FNTEST_REQUIRE(expr) \
+    do { if (!(expr)) { ::fntest::ReportFailure(#expr, __FILE__, __LINE__); throw ::fntest::RequireFailure{}; } } while (false)
@@ -0,0 +1,59 @@
+﻿#include "TestFramework/Test.h"
+
+/**
+* @brief テスト / ベンチマークの実行
+* @details
+*   引数なし           : 単体テストのみ実行する
+*   --bench            : ベンチマークも実行する
+*   --quick            : ベンチマークの規模と回数を減らす
+*   --filter <文字列>  : 「Suite.Name」に文字列を含むものだけ実行する
+* @return 失敗したテストがあれば 1
+*/
+int main(int argc, char** argv)
+{
+    bool isBench = false;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg = argv[i];
+
+        if (arg == "--bench") { isBench = true; }
+        else if (arg == "--quick") { fntest::SetQuick(true); }
+        else if (arg == "--filter" && i + 1 < argc) { filter = argv[++i]; }
+    }
+
+    int runNum = 0;
+    int failedNum = 0;
+
+    for (const fntest::TestCase& testCase : fntest::GetTestCases())
+    {
+        if (testCase.IsBench && !isBench) { continue; }
+
+        const std::string fullName = std::string(testCase.Suite) + "." + testCase.Name;
+        if (!filter.empty() && fullName.find(filter) == std::string::npos) { continue; }
+
+        std::printf("[ RUN      ] %s\n", fullName.c_str());
+
+        fntest::Timer timer;
+        try
+        {
+            testCase.Func();
+        }
+        catch (const fntest::RequireFailure&)
+        {
+            // 失敗は ReportFailure で記録済み
+        }
+
+        const bool isFailed = fntest::TakeFailureNum() > 0;
+
+        std::printf("[ %s ] %s (%.1f ms)\n", isFailed ? " FAILED " : "      OK", fullName.c_str(), timer.ElapsedMs());
+
+        ++runNum;
+        if (isFailed) { ++failedNum; }
+    }
+
+    std::printf("\n%d tests run, %d failed\n", runNum, failedNum);
+
+    return failedNum > 0 ? 1 : 0;
+}